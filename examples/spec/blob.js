@@ -1,4 +1,5 @@
 import { test, testThrows, summary } from './helpers.js';
+import fs from 'ant:fs';
 
 console.log('Blob constructor\n');
 
@@ -131,6 +132,73 @@ console.log('\nBlob.stream()\n');
   test('empty blob stream closes immediately', done, true);
 }
 
+console.log('\nAnt.file()\n');
+
+{
+  const dir = '/tmp/ant-spec-blob';
+  fs.mkdirSync(dir, { recursive: true });
+  fs.writeFileSync(`${dir}/page.html`, '<p>hello file</p>');
+
+  const file = Ant.file(`${dir}/page.html`);
+  test('file size from stat', file.size, 17);
+  test('file type from extension', file.type, 'text/html;charset=utf-8');
+  test('file name is basename', file.name, 'page.html');
+  test('file is a File', file instanceof File, true);
+  test('file lastModified set', file.lastModified > 0, true);
+  test('file text()', await file.text(), '<p>hello file</p>');
+
+  const part = file.slice(3, 13);
+  test('slice of file size', part.size, 10);
+  test('slice of file text', await part.text(), 'hello file');
+  test('slice of slice text', await part.slice(6).text(), 'file');
+
+  test('type option wins', Ant.file(`${dir}/page.html`, { type: 'text/plain' }).type, 'text/plain');
+  test('file as Blob part', await new Blob(['[', part, ']']).text(), '[hello file]');
+
+  const bytes = await file.bytes();
+  test('file bytes()', bytes[0], 60);
+
+  fs.writeFileSync(`${dir}/big.bin`, new Uint8Array(200000).fill(7));
+  const reader = Ant.file(`${dir}/big.bin`).stream().getReader();
+  let total = 0, chunks = 0;
+  for (;;) {
+    const { value, done } = await reader.read();
+    if (done) break;
+    total += value.length;
+    chunks++;
+  }
+  test('file stream reads every byte', total, 200000);
+  test('file stream reads in chunks', chunks > 1, true);
+
+  const seq = new Uint8Array(150000);
+  for (let i = 0; i < seq.length; i++) seq[i] = i % 251;
+  fs.writeFileSync(`${dir}/seq.bin`, seq);
+
+  const sliced = Ant.file(`${dir}/seq.bin`).slice(1000, 140000).stream().getReader();
+  const first = await sliced.read();
+  fs.unlinkSync(`${dir}/seq.bin`);
+  let next = 1000, intact = first.value[0] === 1000 % 251, seen = first.value.length;
+  next += first.value.length;
+  for (;;) {
+    const { value, done } = await sliced.read();
+    if (done) break;
+    intact = intact && value[0] === next % 251 && value[value.length - 1] === (next + value.length - 1) % 251;
+    next += value.length;
+    seen += value.length;
+  }
+  test('file stream keeps its descriptor open', seen, 139000);
+  test('file stream of a slice reads at the offset', intact, true);
+
+  const cancelled = Ant.file(`${dir}/big.bin`).stream().getReader();
+  await cancelled.read();
+  await cancelled.cancel();
+  test('file stream cancel ends reads', (await cancelled.read().catch(() => ({ done: true }))).done, true);
+
+  testThrows('missing file throws', () => Ant.file(`${dir}/missing.txt`));
+  testThrows('directory throws', () => Ant.file(dir));
+  test('Response from file', await new Response(file).text(), '<p>hello file</p>');
+}
+
 console.log('\nSymbol.toStringTag\n');
 
 test('Blob toStringTag', Object.prototype.toString.call(b1), '[object Blob]');
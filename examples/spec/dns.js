@@ -0,0 +1,43 @@
+import { test, testDeep, testThrows, summary } from './helpers.js';
+import dns from 'ant:dns';
+
+console.log('DNS Tests\n');
+
+const first = await dns.promises.lookup('localhost');
+test('lookup family', first.family === 4 || first.family === 6, true);
+test('lookup address', first.address === '127.0.0.1' || first.address === '::1', true);
+
+const [a, b, c] = await Promise.all([
+  dns.promises.lookup('localhost'),
+  dns.promises.lookup('LOCALHOST'),
+  dns.promises.lookup('localhost')
+]);
+testDeep('concurrent lookups agree', [b, c], [a, a]);
+
+const before = Ant.stats().dns;
+const again = await dns.promises.lookup('LocalHost');
+const after = Ant.stats().dns;
+testDeep('cached lookup', again, a);
+test('cached lookup is a cache hit', after.hits - before.hits, 1);
+test('cached lookup starts no request', after.misses - before.misses, 0);
+
+const all = await dns.promises.lookup('localhost', { all: true });
+test('lookup all returns an array', Array.isArray(all), true);
+test('lookup all has entries', all.length > 0, true);
+test('lookup all entry shape', typeof all[0].address === 'string' && typeof all[0].family === 'number', true);
+
+const v4 = await dns.promises.lookup('localhost', 4).catch(() => null);
+test('lookup family 4', v4 === null || v4.family === 4, true);
+
+testThrows('lookup rejects a bad family', () => dns.promises.lookup('localhost', { family: 5 }));
+testThrows('lookup requires a hostname', () => dns.promises.lookup());
+
+let failed = null;
+try { await dns.promises.lookup('ant-does-not-exist.invalid'); } catch (e) { failed = e; }
+test('lookup of an unknown name rejects', failed instanceof Error, true);
+
+let badType = null;
+try { await dns.promises.resolve('localhost', 'MX'); } catch (e) { badType = e; }
+test('resolve rejects unsupported types', badType instanceof Error, true);
+
+summary();
@@ -0,0 +1,33 @@
+import fs from 'ant:fs';
+
+const port = Number(process.argv[2] || 32189);
+const dir = '/tmp/ant-spec-file-server';
+
+fs.mkdirSync(dir, { recursive: true });
+fs.writeFileSync(`${dir}/alphabet.txt`, 'abcdefghijklmnopqrstuvwxyz');
+fs.writeFileSync(`${dir}/large.bin`, new Uint8Array(4 * 1024 * 1024).map((_, i) => i & 0xff));
+
+export default {
+  hostname: '127.0.0.1',
+  port,
+  fetch(request) {
+    const url = new URL(request.url);
+
+    if (url.pathname === '/alphabet') return new Response(Ant.file(`${dir}/alphabet.txt`));
+    if (url.pathname === '/large') return new Response(Ant.file(`${dir}/large.bin`));
+    if (url.pathname === '/slice') return new Response(Ant.file(`${dir}/alphabet.txt`).slice(10, 20));
+    if (url.pathname === '/bytes') return new Response(new Uint8Array(300000).map((_, i) => i % 251));
+    if (url.pathname === '/stream') {
+      const parts = ['alpha', '', new TextEncoder().encode('beta'), 'x'.repeat(70000)];
+      return new Response(new ReadableStream({
+        pull(controller) {
+          if (parts.length) controller.enqueue(parts.shift());
+          else controller.close();
+        }
+      }));
+    }
+    if (url.pathname === '/teapot') return new Response(Ant.file(`${dir}/alphabet.txt`), { status: 418 });
+
+    return new Response('not found', { status: 404 });
+  }
+};
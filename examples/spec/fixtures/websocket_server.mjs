@@ -12,6 +12,19 @@ export default {
   },
   fetch(request, ctx) {
     const url = new URL(request.url);
+    if (url.pathname === '/room') {
+      const { socket, response } = ctx.upgradeWebSocket(request);
+      socket.subscribe('room');
+      socket.onmessage = event => {
+        if (event.data === 'count') socket.send(`count:${ctx.subscriberCount('room')}`);
+        else if (event.data === 'leave') {
+          socket.unsubscribe('room');
+          socket.send(`left:${socket.isSubscribed('room')}`);
+        } else if (event.data === 'all') socket.send(`all:${ctx.publish('room', 'everyone')}`);
+        else socket.send(`sent:${socket.publish('room', event.data)}`);
+      };
+      return response;
+    }
     if (url.pathname !== '/ws') return new Response('not found', { status: 404 });
 
     const { socket, response } = ctx.upgradeWebSocket(request);
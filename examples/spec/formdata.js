@@ -137,4 +137,68 @@ const multipartReq = new Request('https://example.com/', {
 const multipartFd = await multipartReq.formData();
 test('multipart boundary lookup skips longer prefix match', multipartFd.get('field'), 'value');
 
+console.log('\nstreamed multipart parsing\n');
+
+const enc = new TextEncoder();
+const streamedBody = enc.encode(
+  `preamble\r\n--${boundary}\r\n` +
+  `Content-Disposition: form-data; name="a"\r\n\r\n` +
+  `one\r\n--spec-bound not a delimiter\r\n` +
+  `--${boundary}\r\n` +
+  `Content-Disposition: form-data; name="f"; filename="f.txt"\r\nContent-Type: text/plain\r\n\r\n` +
+  `file body\r\n` +
+  `--${boundary}--\r\nepilogue`
+);
+
+function chunkedResponse(bytes, size, type) {
+  let offset = 0;
+  const body = new ReadableStream({
+    pull(controller) {
+      if (offset >= bytes.length) return controller.close();
+      controller.enqueue(bytes.slice(offset, offset + size));
+      offset += size;
+    },
+  });
+  return new Response(body, { headers: { 'Content-Type': type } });
+}
+
+const multipartType = `multipart/form-data; boundary=${boundary}`;
+for (const size of [1, 7, 64]) {
+  const fd = await chunkedResponse(streamedBody, size, multipartType).formData();
+  test(`chunks of ${size}: text field`, fd.get('a'), 'one\r\n--spec-bound not a delimiter');
+  test(`chunks of ${size}: file name`, fd.get('f').name, 'f.txt');
+  test(`chunks of ${size}: file body`, await fd.get('f').text(), 'file body');
+}
+
+let truncatedError = null;
+try {
+  await chunkedResponse(streamedBody.slice(0, 120), 16, multipartType).formData();
+} catch (e) {
+  truncatedError = e;
+}
+test('truncated multipart body rejects', truncatedError instanceof TypeError, true);
+
+const big = new Uint8Array(3 * 1024 * 1024);
+for (let i = 0; i < big.length; i++) big[i] = i & 0xff;
+const bigHead = enc.encode(
+  `--${boundary}\r\nContent-Disposition: form-data; name="big"; filename="big.bin"\r\n` +
+  `Content-Type: application/octet-stream\r\n\r\n`
+);
+const bigTail = enc.encode(`\r\n--${boundary}--\r\n`);
+const bigBody = new Uint8Array(bigHead.length + big.length + bigTail.length);
+bigBody.set(bigHead, 0);
+bigBody.set(big, bigHead.length);
+bigBody.set(bigTail, bigHead.length + big.length);
+
+const bigFd = await chunkedResponse(bigBody, 64 * 1024, multipartType).formData();
+const bigFile = bigFd.get('big');
+test('large file part size', bigFile.size, big.length);
+test('large file part type', bigFile.type, 'application/octet-stream');
+const bigBytes = new Uint8Array(await bigFile.arrayBuffer());
+test('large file part bytes', bigBytes[0] === 0 && bigBytes[255] === 255 && bigBytes[big.length - 1] === ((big.length - 1) & 0xff), true);
+test('large file part slice', new Uint8Array(await bigFile.slice(256, 259).arrayBuffer()).join(), '0,1,2');
+
+const reparsed = await new Response(bigFd).formData();
+test('large file part survives re-serialization', reparsed.get('big').size, big.length);
+
 summary();
@@ -105,6 +105,43 @@ const all = [];
 for (const e of { [Symbol.iterator]: () => iter }) all.push(e[0]);
 test('live iterator sees added key', all.includes('x-b'), true);
 
+console.log('\nmany headers\n');
+
+const hm = new Headers();
+for (let i = 0; i < 40; i++) hm.append(`X-Trace-${i % 10}`, String(i));
+hm.append('Accept', 'text/html');
+hm.append('ACCEPT', 'application/json');
+test('indexed get combines duplicates', hm.get('x-trace-3'), '3, 13, 23, 33');
+test('indexed get well-known name', hm.get('accept'), 'text/html, application/json');
+test('indexed has', hm.has('X-TRACE-9'), true);
+test('indexed has missing', hm.has('x-trace-10'), false);
+hm.delete('x-trace-3');
+test('indexed delete', hm.get('x-trace-3'), null);
+test('neighbours survive delete', hm.get('x-trace-4'), '4, 14, 24, 34');
+hm.set('X-Trace-4', 'only');
+test('indexed set replaces all', hm.get('x-trace-4'), 'only');
+test('indexed key count', [...hm.keys()].length, 10);
+
+console.log('\ncopy-on-write sharing\n');
+
+const base = new Request('https://example.com/', { headers: { 'x-a': '1', cookie: 'c=1' } });
+const derived = new Request(base);
+const cloned = base.clone();
+derived.headers.set('x-a', '2');
+cloned.headers.append('x-b', '3');
+test('original untouched by derived write', base.headers.get('x-a'), '1');
+test('derived sees its write', derived.headers.get('x-a'), '2');
+test('clone sees its write', cloned.headers.get('x-b'), '3');
+test('original untouched by clone write', base.headers.has('x-b'), false);
+test('shared entries still readable', cloned.headers.get('cookie'), 'c=1');
+
+const liveSrc = new Headers({ 'x-a': '1' });
+const liveReq = new Request('https://example.com/', { headers: liveSrc });
+const liveIter = liveReq.headers.keys();
+liveReq.headers.append('x-z', '1');
+test('iterator follows a list unshared by a write', [...{ [Symbol.iterator]: () => liveIter }].join(), 'x-a,x-z');
+test('source untouched by request write', liveSrc.has('x-z'), false);
+
 console.log('\niterator prototype chain\n');
 
 const it = new Headers().entries();
@@ -52,6 +52,73 @@ const info = env.info();
 test('env.stat entries number', typeof stat.entries, 'number');
 test('env.info mapSize number', typeof info.mapSize, 'number');
 
+const batched = [];
+for (let i = 0; i < 50; i++) batched.push(db.putAsync(`batch-${i}`, `value-${i}`));
+test('db.putAsync returns promise', batched[0] instanceof Promise, true);
+const batchedResults = await Promise.all(batched);
+test('db.putAsync resolves true', batchedResults.every((r) => r === true), true);
+test('db.putAsync committed', db.getString('batch-49'), 'value-49');
+
+test('db.putAsync noOverwrite existing', await db.putAsync('batch-0', 'other', { noOverwrite: true }), false);
+test('db.putAsync noOverwrite kept value', db.getString('batch-0'), 'value-0');
+test('db.delAsync resolves true', await db.delAsync('batch-1'), true);
+test('db.delAsync missing resolves false', await db.delAsync('batch-1'), false);
+test('db.delAsync committed', db.get('batch-1'), undefined);
+
+env.setFlags({ noSync: true });
+const unsynced = db.putAsync('nosync', 'fast');
+await env.flush();
+test('env.flush waits for queued writes', db.getString('nosync'), 'fast');
+test('queued write resolved before flush', await unsynced, true);
+env.setFlags({ noSync: false });
+env.sync();
+
+const scan = env.openDB('scan', { create: true });
+for (let i = 0; i < 20; i++) scan.put(`k${String(i).padStart(2, '0')}`, `v${i}`);
+
+const forward = [...scan.getRange({ start: 'k05', end: 'k10', encoding: 'utf8', batchSize: 2 })];
+test('getRange forward count', forward.length, 5);
+test('getRange forward first key', forward[0].key, 'k05');
+test('getRange forward last value', forward[4].value, 'v9');
+
+const backward = [...scan.getRange({ start: 'k10', end: 'k05', reverse: true, encoding: 'utf8' })];
+test('getRange reverse count', backward.length, 5);
+test('getRange reverse first key', backward[0].key, 'k10');
+test('getRange reverse last key', backward[4].key, 'k06');
+
+test('getRange limit', [...scan.getRange({ limit: 3 })].length, 3);
+test('getRange whole db', [...scan.getRange()].length, 20);
+
+const batches = scan.getRange({ batchSize: 8 });
+test('nextBatch size', batches.nextBatch().length, 8);
+test('next after nextBatch', batches.next().value.key, 'k08');
+test('nextBatch returns cached rest', batches.nextBatch().length, 7);
+test('nextBatch tail', batches.nextBatch().length, 4);
+test('nextBatch exhausted', batches.nextBatch().length, 0);
+
+let visited = 0;
+for (const entry of scan.getRange({ start: 'k15' })) {
+  visited++;
+  test('db.get inside a range scan', scan.getString(entry.key), `v${Number(entry.key.slice(1))}`);
+  break;
+}
+test('break out of range scan', visited, 1);
+
+const bufIter = scan.getRange({ start: 'k03', limit: 1, batchBuffer: true });
+const bufEntry = bufIter.next().value;
+test('batchBuffer value is Uint8Array', bufEntry.value instanceof Uint8Array, true);
+test('batchBuffer value contents', String.fromCharCode(...bufEntry.value), 'v3');
+bufEntry.value[0] = 0x56;
+test('batchBuffer value accepts writes', String.fromCharCode(...bufEntry.value), 'V3');
+test('batchBuffer write leaves the store alone', scan.getString('k03'), 'v3');
+bufIter.close();
+test('batchBuffer value readable after close', String.fromCharCode(...bufEntry.value), 'V3');
+
+const batchValues = scan.getRange({ start: 'k01', limit: 3, batchBuffer: true }).nextBatch();
+test('batch values share one buffer', batchValues[0].value.buffer === batchValues[2].value.buffer, true);
+test('batch values keep their own bytes', batchValues.map((e) => String.fromCharCode(...e.value)).join(), 'v1,v2,v3');
+scan.close();
+
 db.close();
 env.close();
 
@@ -0,0 +1,97 @@
+import { test, summary } from './helpers.js';
+import { startServer } from './fixtures/server_ready.mjs';
+
+console.log('Server File Response Tests\n');
+
+const port = 32189;
+const base = `http://127.0.0.1:${port}`;
+const serverPath = new URL('./fixtures/file_server.mjs', import.meta.url).pathname;
+const server = await startServer(serverPath, port);
+
+{
+  const res = await fetch(`${base}/alphabet`);
+  test('file response status', res.status, 200);
+  test('file response body', await res.text(), 'abcdefghijklmnopqrstuvwxyz');
+  test('file response content-type', res.headers.get('content-type'), 'text/plain;charset=utf-8');
+  test('file response content-length', res.headers.get('content-length'), '26');
+  test('file response accept-ranges', res.headers.get('accept-ranges'), 'bytes');
+}
+
+{
+  const res = await fetch(`${base}/alphabet`, { headers: { range: 'bytes=2-5' } });
+  test('range status', res.status, 206);
+  test('range body', await res.text(), 'cdef');
+  test('range content-range', res.headers.get('content-range'), 'bytes 2-5/26');
+}
+
+{
+  const res = await fetch(`${base}/alphabet`, { headers: { range: 'bytes=20-' } });
+  test('open range body', await res.text(), 'uvwxyz');
+}
+
+{
+  const res = await fetch(`${base}/alphabet`, { headers: { range: 'bytes=-3' } });
+  test('suffix range body', await res.text(), 'xyz');
+  test('suffix range content-range', res.headers.get('content-range'), 'bytes 23-25/26');
+}
+
+{
+  const res = await fetch(`${base}/alphabet`, { headers: { range: 'bytes=40-50' } });
+  test('unsatisfiable range status', res.status, 416);
+  test('unsatisfiable content-range', res.headers.get('content-range'), 'bytes */26');
+  test('unsatisfiable body empty', await res.text(), '');
+}
+
+{
+  const res = await fetch(`${base}/alphabet`, { headers: { range: 'bytes=0-1,4-5' } });
+  test('multiple ranges serve the whole file', res.status, 200);
+  test('multiple ranges body', (await res.text()).length, 26);
+}
+
+{
+  const res = await fetch(`${base}/slice`, { headers: { range: 'bytes=1-3' } });
+  test('range inside a sliced file', await res.text(), 'lmn');
+}
+
+{
+  const res = await fetch(`${base}/teapot`, { headers: { range: 'bytes=0-1' } });
+  test('non-200 status ignores range', res.status, 418);
+  test('non-200 status body', (await res.text()).length, 26);
+}
+
+{
+  const res = await fetch(`${base}/large`);
+  const body = new Uint8Array(await res.arrayBuffer());
+  let ok = body.length === 4 * 1024 * 1024;
+  for (let i = 0; ok && i < body.length; i += 4093) ok = body[i] === (i & 0xff);
+  test('large file arrives intact', ok, true);
+}
+
+{
+  const [a, b] = await Promise.all([
+    fetch(`${base}/large`).then(r => r.arrayBuffer()),
+    fetch(`${base}/alphabet`).then(r => r.text())
+  ]);
+  test('concurrent large file', a.byteLength, 4 * 1024 * 1024);
+  test('concurrent small file', b, 'abcdefghijklmnopqrstuvwxyz');
+}
+
+{
+  const res = await fetch(`${base}/bytes`);
+  const body = new Uint8Array(await res.arrayBuffer());
+  let ok = body.length === 300000;
+  for (let i = 0; ok && i < body.length; i += 997) ok = body[i] === i % 251;
+  test('buffered body after head', ok, true);
+  test('buffered body content-length', res.headers.get('content-length'), '300000');
+}
+
+{
+  const res = await fetch(`${base}/stream`);
+  const text = await res.text();
+  test('streamed chunks in order', text.slice(0, 9), 'alphabeta');
+  test('streamed empty chunk skipped', text.length, 9 + 70000);
+}
+
+server.kill('SIGTERM');
+
+summary();
@@ -336,6 +336,100 @@ testThrows('pipeThrough locked writable throws', () => {
   new ReadableStream().pipeThrough({ writable: ws, readable: new ReadableStream() });
 });
 
+async function collect(readable) {
+  const reader = readable.getReader();
+  const chunks = [];
+  while (true) {
+    const { done, value } = await reader.read();
+    if (done) break;
+    chunks.push(value);
+  }
+  return chunks;
+}
+
+async function testPipeNativeEndpoints() {
+  const parts = Array.from({ length: 200 }, (_, i) => `chunk${i};`);
+  const source = new Response(parts.join('')).body;
+  const ts = new TextDecoderStream();
+  const [piped, chunks] = await Promise.all([source.pipeTo(ts.writable), collect(ts.readable)]);
+  const text = chunks.join('');
+  test('native pipeTo resolves', piped, undefined);
+  test('native pipeTo moves all bytes', text, parts.join(''));
+
+  let n = 0;
+  const chained = Array.from({ length: 3 }, () => new TransformStream({
+    transform(chunk, c) { c.enqueue(chunk + 1); }
+  }));
+  const counted = new ReadableStream({
+    start(c) { for (let i = 0; i < 100; i++) c.enqueue(i); c.close(); }
+  }).pipeThrough(chained[0]).pipeThrough(chained[1]).pipeThrough(chained[2]);
+  for (const v of await collect(counted)) n += v;
+  test('chained transforms keep every chunk', n, 4950 + 300);
+
+  const failing = new TransformStream({
+    transform(chunk) { if (chunk === 3) throw new Error('boom'); }
+  });
+  const upstream = new TransformStream();
+  const writer = upstream.writable.getWriter();
+  for (let i = 0; i < 5; i++) writer.write(i).catch(() => {});
+  writer.close().catch(() => {});
+  try {
+    await upstream.readable.pipeTo(failing.writable);
+    test('native pipeTo rejects on sink error', false, true);
+  } catch (e) {
+    test('native pipeTo rejects on sink error', e.message, 'boom');
+  }
+}
+
+async function testPipeNativePreventCloseWaits() {
+  const parts = Array.from({ length: 200 }, (_, i) => `slow${i};`);
+  const source = new Response(parts.join('')).body;
+  const ts = new TextDecoderStream();
+  const received = [];
+  const reading = (async () => {
+    const reader = ts.readable.getReader();
+    for (;;) {
+      await new Promise(r => setTimeout(r, 5));
+      const { done, value } = await reader.read();
+      if (done) break;
+      received.push(value);
+    }
+  })();
+
+  await source.pipeTo(ts.writable, { preventClose: true });
+  const writer = ts.writable.getWriter();
+  test('native pipeTo with preventClose waits for its writes', writer.desiredSize, 1);
+  await writer.close();
+  await reading;
+  test('slow native sink sees every chunk', received.join(''), parts.join(''));
+}
+
+async function testPipeUserTransformWaits() {
+  const events = [];
+  let pulls = 0, transformed = 0, ahead = 0;
+  const source = new ReadableStream({
+    pull(c) {
+      pulls++;
+      ahead = Math.max(ahead, pulls - transformed);
+      if (pulls > 10) c.close();
+      else c.enqueue(pulls);
+    }
+  }, { highWaterMark: 0 });
+  const slow = new TransformStream({
+    async transform(chunk, c) {
+      events.push(`start ${chunk}`);
+      await new Promise(r => setTimeout(r, 1));
+      events.push(`end ${chunk}`);
+      transformed++;
+      c.enqueue(chunk);
+    }
+  });
+  const out = await collect(source.pipeThrough(slow));
+  testDeep('user transform keeps order', out, [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]);
+  test('user transform calls do not overlap', events.every((e, i) => e.startsWith(i % 2 ? 'end' : 'start')), true);
+  test('pipe into a user transform waits on its writes', ahead <= 3, true);
+}
+
 await testTeeBasic();
 await testTeePullBased();
 await testTeeCancelOne();
@@ -352,5 +446,8 @@ await testPipeToAlreadyAbortedSignal();
 await testPipeToRejectsLocked();
 
 await testPipeThroughBasic();
+await testPipeNativeEndpoints();
+await testPipeNativePreventCloseWaits();
+await testPipeUserTransformWaits();
 
 summary();
@@ -14,6 +14,51 @@ test('CloseEvent global exists', typeof CloseEvent, 'function');
 
 const server = await startServer(serverPath, port);
 
+function openSocket(path) {
+  return new Promise((resolve, reject) => {
+    const socket = new WebSocket(`ws://127.0.0.1:${port}${path}`);
+    const inbox = [];
+    const waiters = [];
+    socket.onmessage = event => {
+      const waiter = waiters.shift();
+      if (waiter) waiter(event.data);
+      else inbox.push(event.data);
+    };
+    socket.next = () => inbox.length
+      ? Promise.resolve(inbox.shift())
+      : new Promise(res => waiters.push(res));
+    socket.onopen = () => resolve(socket);
+    socket.onerror = reject;
+  });
+}
+
+{
+  const a = await openSocket('/room');
+  const b = await openSocket('/room');
+  const long = 'x'.repeat(50);
+
+  a.send(long);
+  test('publish reaches other subscribers', await b.next(), long);
+  test('publish skips the sender', await a.next(), 'sent:1');
+
+  a.send('count');
+  test('subscriberCount', await a.next(), 'count:2');
+
+  b.send('all');
+  const [fromA, fromB] = [await a.next(), await b.next()];
+  test('server.publish reaches every subscriber', fromA, 'everyone');
+  test('server.publish includes the caller', fromB, 'everyone');
+  test('server.publish count', await b.next(), 'all:2');
+
+  b.send('leave');
+  test('unsubscribe', await b.next(), 'left:false');
+  a.send('count');
+  test('subscriberCount after unsubscribe', await a.next(), 'count:1');
+
+  a.close();
+  b.close();
+}
+
 const result = await new Promise(resolve => {
   const seen = [];
   const socket = new WebSocket(`ws://127.0.0.1:${port}/ws`);
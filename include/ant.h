@@ -240,12 +240,15 @@ typedef ant_value_t (*js_keys_fn)(ant_t *js, ant_value_t obj);
 typedef bool (*js_setter_fn)(ant_t *js, ant_value_t obj, const char *key, size_t key_len, ant_value_t value);
 typedef bool (*js_deleter_fn)(ant_t *js, ant_value_t obj, const char *key, size_t key_len);
 typedef void (*js_finalizer_fn)(ant_t *js, ant_object_t *obj);
+typedef ant_value_t (*js_materializer_fn)(ant_t *js, ant_value_t obj);
 
 void js_set_getter(ant_value_t obj, js_getter_fn getter);
 void js_set_setter(ant_value_t obj, js_setter_fn setter);
 void js_set_deleter(ant_value_t obj, js_deleter_fn deleter);
 void js_set_keys(ant_value_t obj, js_keys_fn keys);
 void js_set_finalizer(ant_value_t obj, js_finalizer_fn fn);
+void js_set_materializer(ant_value_t obj, js_materializer_fn fn);
+void js_clear_materializer(ant_value_t obj);
 
 ant_value_t js_get_slot(ant_value_t obj, internal_slot_t slot);
 ant_value_t js_promise_assimilate_awaitable(ant_t *js, ant_value_t value);
@@ -10,6 +10,7 @@ typedef enum {
   SV_DEBUG_PARSE         = 1u << 3,
   SV_DEBUG_COMPILE       = 1u << 4,
   SV_DEBUG_DUMP_SHELL    = 1u << 5,
+  SV_DEBUG_JIT_SYNC      = 1u << 6,
 } sv_debug_flag_t;
 
 bool sv_debug_enabled(sv_debug_flag_t flag);
@@ -6,6 +6,8 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+extern bool esm_resolve_index_enabled;
+
 typedef enum {
   MODULE_EVAL_FORMAT_UNKNOWN = 0,
   MODULE_EVAL_FORMAT_ESM,
@@ -21,6 +23,7 @@ typedef struct ant_module_t {
 } ant_module_t;
 
 void js_esm_cleanup_module_cache(ant_t *js);
+void js_esm_flush_resolve_index(ant_t *js);
 
 ant_value_t js_esm_make_file_url(ant_t *js, const char *path);
 ant_value_t js_esm_import_sync(ant_t *js, ant_value_t specifier);
@@ -10,6 +10,9 @@ void gc_mark_cron(ant_t *js, gc_mark_fn mark);
 void gc_mark_atomics(ant_t *js, gc_mark_fn mark);
 void gc_mark_fetch(ant_t *js, gc_mark_fn mark);
 void gc_mark_fs(ant_t *js, gc_mark_fn mark);
+void gc_mark_blob(ant_t *js, gc_mark_fn mark);
+void gc_mark_dns(ant_t *js, gc_mark_fn mark);
+void gc_mark_multipart(ant_t *js, gc_mark_fn mark);
 void gc_mark_child_process(ant_t *js, gc_mark_fn mark);
 void gc_mark_readline(ant_t *js, gc_mark_fn mark);
 void gc_mark_process(ant_t *js, gc_mark_fn mark);
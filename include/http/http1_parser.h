@@ -23,9 +23,18 @@ typedef struct {
   uint8_t http_minor;
   bool absolute_target;
   bool keep_alive;
+  bool body_streamed;
 } ant_http1_parsed_request_t;
 
-typedef struct {
+typedef struct ant_http1_parser_ctx_s ant_http1_parser_ctx_t;
+
+// on_headers runs once the request headers are in and may set body_sink to
+// take the body chunks as they arrive instead of gathering them in req.body;
+// a false return from the sink fails the parse
+typedef void (*ant_http1_headers_cb_t)(llhttp_t *parser, ant_http1_parser_ctx_t *ctx, void *data);
+typedef bool (*ant_http1_body_sink_t)(void *data, const uint8_t *chunk, size_t len);
+
+struct ant_http1_parser_ctx_s {
   ant_http1_parsed_request_t req;
   ant_http1_buffer_t method;
   ant_http1_buffer_t target;
@@ -33,8 +42,12 @@ typedef struct {
   ant_http1_buffer_t header_value;
   ant_http1_buffer_t body;
   ant_http_header_t **header_tail;
+  ant_http1_headers_cb_t on_headers;
+  void *on_headers_data;
+  ant_http1_body_sink_t body_sink;
+  void *body_sink_data;
   bool message_complete;
-} ant_http1_parser_ctx_t;
+};
 
 typedef struct {
   llhttp_t parser;
@@ -62,6 +75,11 @@ ant_http1_parse_result_t ant_http1_parse_request(
   const char **error_code
 );
 
+// once execute has returned INCOMPLETE the parser keeps nothing pointing
+// into the bytes fed so far; returns their count so the caller can drop
+// them, and the next execute starts at the front of what is left
+size_t ant_http1_conn_parser_drop_fed(ant_http1_conn_parser_t *cp);
+
 ant_http1_parse_result_t ant_http1_conn_parser_execute(
   ant_http1_conn_parser_t *cp,
   const char *data,
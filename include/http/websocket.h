@@ -42,6 +42,7 @@ const char *ant_ws_find_header(const ant_http_header_t *headers, const char *nam
 
 char *ant_ws_accept_key(const char *client_key);
 void ant_ws_frame_clear(ant_ws_frame_t *frame);
+void ant_ws_mask(uint8_t *data, size_t len, const uint8_t mask[4]);
 
 ant_ws_frame_result_t ant_ws_parse_frame(
   const uint8_t *data,
@@ -10,6 +10,7 @@
 #include "silver/ast.h"
 #include "descriptors.h"
 #include "esm/loader.h"
+#include "simd.h"
 
 #include <assert.h>
 #include <string.h>
@@ -110,8 +111,16 @@ enum: uint64_t {
   STR_HEAP_TAG_FLAT    = 0x0,
   STR_HEAP_TAG_ROPE    = 0x1,
   STR_HEAP_TAG_BUILDER = 0x2,
+  STR_HEAP_TAG_SLICE   = 0x3,
 };
 
+// slices shorter than this are copied; a slice header costs about as much
+static constexpr size_t STR_SLICE_MIN_LEN = 32;
+
+// at major GC, slices that pin a parent this many times their own size
+// are copied out so the parent can be collected
+static constexpr size_t STR_SLICE_WASTE_RATIO = 8;
+
 static constexpr uint64_t STR_META_FIELD_MASK   = 0x3;
 static constexpr uint64_t STR_META_UTF16_MASK   = (UINT64_C(1) << STR_META_ASCII_SHIFT) - 1;
 static constexpr uint64_t STR_META_ASCII_MASK   = STR_META_FIELD_MASK << STR_META_ASCII_SHIFT;
@@ -195,6 +204,7 @@ enum: ant_value_t {
   SV_JIT_BAILOUT      = ANT_SENTINEL(0xBA110ULL), // JIT -> interpreter bailout
   SV_AITER_ARRAY_TAG  = ANT_SENTINEL(0xFA1ULL),   // for-await plain-array mode
   SV_AITER_AWAIT_MARK = ANT_SENTINEL(0xFA2ULL),   // for-await element await resume
+  SV_JIT_SCALAR_OBJ   = ANT_SENTINEL(0x5CA00ULL), // JIT scalar-replaced object (+ 2 * id)
 };
 
 typedef struct {
@@ -230,7 +240,7 @@ struct ant_isolate_t {
   ant_events_state_t *events_state;
   ant_regex_state_t *regex_state;
 
-  ant_fixed_arena_t obj_arena;
+  ant_fixed_arena_t obj_arenas[ANT_OBJ_SIZE_CLASSES];
   ant_fixed_arena_t closure_arena;
   ant_fixed_arena_t upvalue_arena;
 
@@ -492,9 +502,52 @@ struct ant_isolate_t {
     ant_string_builder_t **remembered_builders;
     size_t remembered_builder_len;
     size_t remembered_builder_cap;
+    
+    struct ant_slice_heap **wasteful_slices;
+    size_t wasteful_slice_len;
+    size_t wasteful_slice_cap;
   } rope_gc;
 };
 
+static inline ant_fixed_arena_t *js_obj_arena_for(ant_t *js, const ant_object_t *obj) {
+  return &js->obj_arenas[ant_object_size_class(obj->inobj_limit)];
+}
+
+static inline bool js_obj_arena_contains(const ant_t *js, const void *ptr) {
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++)
+    if (fixed_arena_contains(&js->obj_arenas[i], ptr)) return true;
+  return false;
+}
+
+static inline size_t js_obj_live_count(const ant_t *js) {
+  size_t live = 0;
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) live += js->obj_arenas[i].live_count;
+  return live;
+}
+
+static inline size_t js_obj_live_bytes(const ant_t *js) {
+  size_t bytes = 0;
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++)
+    bytes += js->obj_arenas[i].live_count * js->obj_arenas[i].elem_size;
+  return bytes;
+}
+
+static inline size_t js_obj_committed_bytes(const ant_t *js) {
+  size_t bytes = 0;
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) bytes += js->obj_arenas[i].committed;
+  return bytes;
+}
+
+static inline size_t js_obj_reserved_bytes(const ant_t *js) {
+  size_t bytes = 0;
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) bytes += js->obj_arenas[i].reserved;
+  return bytes;
+}
+
+static inline void js_obj_arenas_destroy(ant_t *js) {
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) fixed_arena_destroy(&js->obj_arenas[i]);
+}
+
 static inline void ant_prototype_write_epoch_bump(ant_t *js) {
   if (++js->prototype_write_epoch == 0) {
     ant_ic_epoch_bump();
@@ -558,6 +611,16 @@ struct ant_string_builder {
   char tail[STR_BUILDER_TAIL_CAP];
 };
 
+typedef struct ant_slice_heap {
+  ant_offset_t len;
+  ant_offset_t offset;
+  ant_offset_t utf16_len;
+  ant_value_t parent;
+  ant_value_t cached;
+  uint8_t ascii_state;
+  uint8_t pending_flatten;
+} ant_slice_heap_t;
+
 typedef struct {
   const char *ptr;
   size_t len;
@@ -720,6 +783,17 @@ ant_prop_loc_t lkp_interned(ant_value_t obj, const char *search_intern);
 ant_prop_loc_t lkp(ant_t *js, ant_value_t obj, const char *buf, size_t len);
 ant_prop_loc_t lkp_proto(ant_t *js, ant_value_t obj, const char *buf, size_t len);
 
+// objects with a materializer (lazy JSON.parse) fill in their own properties
+// on first touch; own-property lookups and key enumeration call this first.
+// returns an error if filling failed, lookups that cannot throw ignore it
+static inline ant_value_t js_obj_materialize(ant_t *js, ant_value_t obj) {
+  ant_object_t *ptr = js_obj_ptr(obj);
+  if (__builtin_expect(!ptr || !ptr->flags.is_exotic, 1)) return js_mkundef();
+  if (ptr->exotic_ops && ptr->exotic_ops->materialize)
+    return ptr->exotic_ops->materialize(js, obj);
+  return js_mkundef();
+}
+
 ant_prop_loc_t lkp_sym(ant_value_t obj, ant_offset_t sym_off);
 ant_prop_loc_t lkp_sym_proto(ant_t *js, ant_value_t obj, ant_offset_t sym_off);
 
@@ -733,6 +807,7 @@ ant_value_t mkobj(ant_t *js, ant_offset_t parent);
 ant_value_t js_mkobj_with_inobj_limit(ant_t *js, uint8_t inobj_limit);
 ant_value_t rope_flatten(ant_t *js, ant_value_t rope);
 ant_value_t str_materialize(ant_t *js, ant_value_t value);
+ant_value_t js_mkstr_slice(ant_t *js, ant_value_t src, const char *ptr, size_t len);
 
 ant_value_t js_for_in_keys(ant_t *js, ant_value_t obj);
 ant_value_t js_own_property_keys(ant_t *js, ant_value_t obj, bool include_symbols, bool enumerable_only);
@@ -895,6 +970,10 @@ static inline bool str_is_heap_builder(ant_value_t value) {
   return vtype(value) == T_STR && ((vdata(value) & STR_HEAP_TAG_MASK) == STR_HEAP_TAG_BUILDER);
 }
 
+static inline bool str_is_heap_slice(ant_value_t value) {
+  return vtype(value) == T_STR && ((vdata(value) & STR_HEAP_TAG_MASK) == STR_HEAP_TAG_SLICE);
+}
+
 static inline ant_rope_heap_t *ant_str_rope_ptr(ant_value_t value) {
   return (ant_rope_heap_t *)(uintptr_t)(vdata(value) & ~STR_HEAP_TAG_MASK);
 }
@@ -903,6 +982,10 @@ static inline ant_string_builder_t *ant_str_builder_ptr(ant_value_t value) {
   return (ant_string_builder_t *)(uintptr_t)(vdata(value) & ~STR_HEAP_TAG_MASK);
 }
 
+static inline ant_slice_heap_t *ant_str_slice_ptr(ant_value_t value) {
+  return (ant_slice_heap_t *)(uintptr_t)(vdata(value) & ~STR_HEAP_TAG_MASK);
+}
+
 static inline ant_value_t ant_mkrope_value(ant_rope_heap_t *rope) {
   return mkval(T_STR, ((uintptr_t)rope) | STR_HEAP_TAG_ROPE);
 }
@@ -911,6 +994,10 @@ static inline ant_value_t ant_mkbuilder_value(ant_string_builder_t *builder) {
   return mkval(T_STR, ((uintptr_t)builder) | STR_HEAP_TAG_BUILDER);
 }
 
+static inline ant_value_t ant_mkslice_value(ant_slice_heap_t *slice) {
+  return mkval(T_STR, ((uintptr_t)slice) | STR_HEAP_TAG_SLICE);
+}
+
 static inline int js_brand_id(ant_value_t obj) {
   if (!is_object_type(obj)) return BRAND_NONE;
   ant_value_t brand = js_get_slot(obj, SLOT_BRAND);
@@ -970,6 +1057,25 @@ static inline ant_flat_string_t *ant_str_flat_ptr(ant_value_t value) {
   return (ant_flat_string_t *)(uintptr_t)vdata(value);
 }
 
+// bytes of a flat string or a slice without materializing; slice views are
+// not NUL-terminated and must not reach helpers that use str_flat_from_bytes
+static inline const char *str_flat_view(ant_value_t value, ant_offset_t *len) {
+  if (str_is_heap_slice(value)) {
+    ant_slice_heap_t *slice = ant_str_slice_ptr(value);
+    ant_flat_string_t *base = ant_str_flat_ptr(
+      vtype(slice->cached) == T_STR ? slice->cached : slice->parent
+    );
+    if (!base) return NULL;
+    if (len) *len = slice->len;
+    return vtype(slice->cached) == T_STR ? base->bytes : base->bytes + slice->offset;
+  }
+
+  ant_flat_string_t *flat = ant_str_flat_ptr(value);
+  if (!flat) return NULL;
+  if (len) *len = flat->len;
+  return flat->bytes;
+}
+
 static inline ant_flat_string_t *large_string_flat_ptr(ant_large_string_alloc_t *alloc) {
   return alloc ? (ant_flat_string_t *)&alloc->len : NULL;
 }
@@ -979,11 +1085,7 @@ static inline ant_large_string_alloc_t *large_string_alloc_from_flat(ant_flat_st
 }
 
 static inline uint8_t str_detect_ascii_bytes(const char *str, size_t len) {
-  const unsigned char *s = (const unsigned char *)str;
-  for (size_t i = 0; i < len; i++) {
-    if (s[i] >= 0x80) return STR_ASCII_NO;
-  }
-  return STR_ASCII_YES;
+  return simd_is_ascii(str, len) ? STR_ASCII_YES : STR_ASCII_NO;
 }
 
 static inline uint8_t str_flat_ascii_state(const ant_flat_string_t *flat) {
@@ -1,15 +1,20 @@
 #ifndef BLOB_H
 #define BLOB_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include "types.h"
 
+// a file-backed blob has a path and reads its bytes on first use,
+// data stays NULL until blob_load() fills it
 typedef struct {
   uint8_t *data;
   size_t size;
   char *type;
   char *name;
+  char *path;
+  uint64_t offset;
   int64_t last_modified;
 } blob_data_t;
 
@@ -17,6 +22,13 @@ void init_blob_module(ant_t *js);
 bool blob_is_blob(ant_t *js, ant_value_t obj);
 
 blob_data_t *blob_get_data(ant_value_t obj);
+bool blob_load(blob_data_t *bd);
 ant_value_t blob_create(ant_t *js, const uint8_t *data, size_t size, const char *type);
 
+// paths of file-backed blobs are copied and freed through these so that
+// temp files handed over with blob_path_own_temp() are unlinked once unused
+bool blob_path_own_temp(const char *path);
+char *blob_path_dup(const char *path);
+void blob_path_free(char *path);
+
 #endif
@@ -4,6 +4,7 @@
 #include "types.h"
 
 void init_json_module(ant_t *js);
+void cleanup_json_module(void);
 
 ant_value_t js_json_parse(ant_t *js, ant_value_t *args, int nargs);
 ant_value_t js_json_stringify(ant_t *js, ant_value_t *args, int nargs);
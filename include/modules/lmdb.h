@@ -6,10 +6,14 @@
 typedef struct lmdb_env_handle lmdb_env_handle_t;
 typedef struct lmdb_db_handle lmdb_db_handle_t;
 typedef struct lmdb_txn_handle lmdb_txn_handle_t;
+typedef struct lmdb_range_handle lmdb_range_handle_t;
+typedef struct lmdb_writer lmdb_writer_t;
+typedef struct lmdb_write_op lmdb_write_op_t;
 
 typedef struct lmdb_env_ref lmdb_env_ref_t;
 typedef struct lmdb_db_ref lmdb_db_ref_t;
 typedef struct lmdb_txn_ref lmdb_txn_ref_t;
+typedef struct lmdb_range_ref lmdb_range_ref_t;
 
 typedef struct {
   ant_value_t env_ctor;
@@ -18,6 +22,7 @@ typedef struct {
   ant_value_t env_proto;
   ant_value_t db_proto;
   ant_value_t txn_proto;
+  ant_value_t range_proto;
   bool ready;
 } lmdb_js_types_t;
 
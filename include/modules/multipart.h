@@ -11,9 +11,32 @@ uint8_t *formdata_serialize_multipart(
   size_t *out_size, char **out_boundary
 );
 
-ant_value_t formdata_parse_body(
-  ant_t *js, const uint8_t *data, size_t size,
-  const char *body_type, bool has_body
+#define MULTIPART_SPILL_DEFAULT (1024 * 1024)
+
+// resolves promise with the FormData for a fully buffered body; file parts
+// spilled to disk are written on the threadpool before it settles
+void formdata_resolve_body(
+  ant_t *js, ant_value_t promise,
+  const uint8_t *data, size_t size,
+  const char *body_type, bool has_body, size_t spill_threshold
 );
 
+// incremental multipart/form-data parser, fed body chunks as they arrive;
+// file parts larger than spill_threshold (0 disables it) are written to a
+// temp file and surface as file-backed File objects
+typedef struct multipart_parser multipart_parser_t;
+
+multipart_parser_t *multipart_parser_new(const char *body_type, size_t spill_threshold);
+bool multipart_parser_feed(multipart_parser_t *mp, const uint8_t *data, size_t len);
+void multipart_parser_free(multipart_parser_t *mp);
+
+// takes ownership of mp and settles promise with the parsed FormData once
+// every spill write is on disk; a NULL parser rejects it
+void multipart_parser_resolve(ant_t *js, multipart_parser_t *mp, ant_value_t promise);
+
+// ties a parser's lifetime to a JS object, take hands it back unbound
+void multipart_parser_bind(ant_value_t owner, multipart_parser_t *mp);
+multipart_parser_t *multipart_parser_bound(ant_value_t owner);
+multipart_parser_t *multipart_parser_take(ant_value_t owner);
+
 #endif
@@ -26,6 +26,8 @@ typedef struct {
   bool body_is_stream;
   bool has_body;
   bool body_used;
+  size_t multipart_spill;
+  struct multipart_parser *multipart;
 } request_data_t;
 
 void init_request_module(ant_t *js);
@@ -58,10 +60,16 @@ ant_value_t request_create_server(
   const char *host,
   const char *server_hostname,
   int server_port,
+  bool secure,
   ant_value_t headers,
   const uint8_t *body,
   size_t body_len,
-  const char *body_type
+  const char *body_type,
+  size_t multipart_spill
 );
 
+// hands the request a multipart parser the server fed the body into while
+// it arrived; formData() takes its result, the raw bytes are gone
+void request_set_multipart_body(ant_value_t req_obj, struct multipart_parser *mp);
+
 #endif
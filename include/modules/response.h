@@ -14,6 +14,8 @@ typedef struct {
   uint8_t *body_data;
   size_t body_size;
   char *body_type;
+  char *body_file;
+  uint64_t body_file_offset;
   ant_value_t websocket;
   int url_list_size;
   int status;
@@ -11,6 +11,7 @@
 
 typedef struct {
   size_t max_payload_len;
+  size_t backpressure_limit;
   bool per_message_deflate;
 } ant_websocket_server_options_t;
 
@@ -28,4 +29,7 @@ void ant_websocket_server_open(ant_t *js, ant_value_t socket_obj);
 void ant_websocket_server_on_close(ant_t *js, ant_value_t socket_obj);
 void ant_websocket_server_on_read(ant_t *js, ant_value_t socket_obj, ant_conn_t *conn);
 
+ant_value_t ant_websocket_publish(ant_t *js, ant_value_t topic, ant_value_t data, ant_value_t exclude);
+ant_value_t ant_websocket_subscriber_count(ant_t *js, ant_value_t topic);
+
 #endif
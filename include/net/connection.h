@@ -8,6 +8,9 @@
 
 typedef struct ant_listener_s ant_listener_t;
 typedef struct ant_conn_s ant_conn_t;
+typedef struct ant_conn_sendfile_s ant_conn_sendfile_t;
+typedef struct ant_conn_race_s ant_conn_race_t;
+typedef struct ant_tls_conn_s ant_tls_conn_t;
 
 typedef enum {
   ANT_CONN_KIND_TCP = 0,
@@ -24,6 +27,9 @@ struct ant_conn_s {
   
   uv_timer_t timer;
   ant_listener_t *listener;
+  ant_conn_sendfile_t *sendfile;
+  ant_conn_race_t *race;
+  ant_tls_conn_t *tls;
   
   void *user_data;
   char *buffer;
@@ -37,10 +43,12 @@ struct ant_conn_s {
   uint64_t bytes_written;
   
   int close_handles;
+  unsigned int writes_in_flight;
   bool resolving;
   bool closing;
   bool read_paused;
   bool read_eof;
+  bool tls_established;
   bool has_local_addr;
   bool has_remote_addr;
   
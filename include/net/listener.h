@@ -8,12 +8,15 @@
 
 typedef struct ant_listener_s ant_listener_t;
 typedef struct ant_conn_s ant_conn_t;
+typedef struct ant_tls_server_s ant_tls_server_t;
 
 typedef enum {
   ANT_LISTENER_KIND_TCP = 0,
   ANT_LISTENER_KIND_PIPE,
 } ant_listener_kind_t;
 
+#define ANT_CONN_WRITEV_MAX 4
+
 typedef void (*ant_conn_write_cb)(
   ant_conn_t *conn,
   int status,
@@ -41,6 +44,7 @@ struct ant_listener_s {
   
   ant_conn_t *connections;
   ant_listener_callbacks_t callbacks;
+  ant_tls_server_t *tls;
   
   void *user_data;
   uint64_t idle_timeout_ms;
@@ -84,6 +88,8 @@ int ant_listener_listen_pipe(
   void *user_data
 );
 
+// accepted connections terminate tls with server, the listener borrows it
+void ant_listener_set_tls(ant_listener_t *listener, ant_tls_server_t *server);
 void ant_listener_stop(ant_listener_t *listener, bool force);
 void *ant_listener_get_user_data(const ant_listener_t *listener);
 void ant_listener_ref(ant_listener_t *listener);
@@ -95,12 +101,16 @@ int ant_conn_remote_port(const ant_conn_t *conn);
 int ant_conn_set_no_delay(ant_conn_t *conn, bool enable);
 int ant_conn_set_keep_alive(ant_conn_t *conn, bool enable, unsigned int delay_secs);
 int ant_conn_write(ant_conn_t *conn, char *data, size_t len, ant_conn_write_cb cb, void *user_data);
+int ant_conn_writev(ant_conn_t *conn, const uv_buf_t *bufs, unsigned int nbufs, unsigned int owned, ant_conn_write_cb cb, void *user_data);
+int ant_conn_start_tls(ant_conn_t *conn, ant_tls_server_t *server);
+int ant_conn_sendfile(ant_conn_t *conn, uv_file file, int64_t offset, size_t len, ant_conn_write_cb cb, void *user_data);
 
 bool ant_listener_has_connections(const ant_listener_t *listener);
 bool ant_listener_is_closed(const ant_listener_t *listener);
 bool ant_conn_is_closing(const ant_conn_t *conn);
 bool ant_conn_has_local_addr(const ant_conn_t *conn);
 bool ant_conn_has_remote_addr(const ant_conn_t *conn);
+bool ant_conn_is_secure(const ant_conn_t *conn);
 
 void ant_conn_set_user_data(ant_conn_t *conn, void *user_data);
 void *ant_conn_get_user_data(const ant_conn_t *conn);
@@ -121,6 +131,7 @@ const char *ant_conn_remote_family(const ant_conn_t *conn);
 const char *ant_listener_path(const ant_listener_t *listener);
 
 size_t ant_conn_buffer_len(const ant_conn_t *conn);
+size_t ant_conn_write_queue_size(ant_conn_t *conn);
 ant_listener_t *ant_conn_listener(const ant_conn_t *conn);
 
 uint64_t ant_conn_timeout_ms(const ant_conn_t *conn);
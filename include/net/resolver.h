@@ -0,0 +1,77 @@
+#ifndef ANT_NET_RESOLVER_H
+#define ANT_NET_RESOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <uv.h>
+
+#define ANT_RESOLVE_MAX_ADDRS 16
+
+typedef struct {
+  struct sockaddr_storage addrs[ANT_RESOLVE_MAX_ADDRS];
+  size_t count;
+} ant_addr_list_t;
+
+// status is a libuv error code, ports in the list are zero
+typedef void (*ant_resolve_lookup_cb)(
+  int status,
+  const ant_addr_list_t *list,
+  void *user_data
+);
+
+// status is an ares status, abuf is the raw answer and only valid during the call
+typedef void (*ant_resolve_query_cb)(
+  int status,
+  const unsigned char *abuf,
+  int alen,
+  void *user_data
+);
+
+// returns 0 and fills out on a cache hit, a negative cached status, or
+// UV_EAGAIN when the caller has to go through ant_resolve_lookup.
+// a stale hit is still returned and refreshes the entry in the background
+int ant_resolve_lookup_cached(
+  uv_loop_t *loop,
+  const char *host,
+  int family,
+  ant_addr_list_t *out
+);
+
+// getaddrinfo on the threadpool, concurrent lookups of the same name share
+// one request. cb always runs from the loop, never before this returns
+int ant_resolve_lookup(
+  uv_loop_t *loop,
+  const char *host,
+  int family,
+  ant_resolve_lookup_cb cb,
+  void *user_data
+);
+
+// c-ares query driven by the loop, answers are cached for their smallest ttl.
+// cb may run before this returns when the answer is cached
+int ant_resolve_query(
+  uv_loop_t *loop,
+  const char *name,
+  int rrtype,
+  ant_resolve_query_cb cb,
+  void *user_data
+);
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t shared;
+  uint32_t entries;
+} ant_resolve_stats_t;
+
+// hits are answers served from the cache, misses started a request and
+// shared callers joined one already in flight
+ant_resolve_stats_t ant_resolve_stats(void);
+
+void ant_resolve_set_port(ant_addr_list_t *list, int port);
+
+// interleaves address families, starting with the family of the first entry (rfc 8305)
+void ant_resolve_interleave(ant_addr_list_t *list);
+
+#endif
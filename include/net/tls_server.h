@@ -0,0 +1,72 @@
+#ifndef ANT_NET_TLS_SERVER_H
+#define ANT_NET_TLS_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <uv.h>
+
+typedef struct ant_tls_server_s ant_tls_server_t;
+typedef struct ant_tls_conn_s ant_tls_conn_t;
+
+typedef struct {
+  const char *cert;
+  size_t cert_len;
+  const char *key;
+  size_t key_len;
+  const char *passphrase;
+  uint32_t session_timeout_secs;
+  bool session_tickets;
+  bool kernel_tx;
+} ant_tls_server_options_t;
+
+// runs on the loop once a private key operation queued on the threadpool is done
+typedef void (*ant_tls_resume_cb)(void *user_data);
+
+// error points at a static message on failure
+int ant_tls_server_new(
+  const ant_tls_server_options_t *opts,
+  ant_tls_server_t **out,
+  const char **error
+);
+
+void ant_tls_server_retain(ant_tls_server_t *server);
+void ant_tls_server_release(ant_tls_server_t *server);
+
+ant_tls_conn_t *ant_tls_conn_new(
+  ant_tls_server_t *server,
+  uv_loop_t *loop,
+  ant_tls_resume_cb resume,
+  void *user_data
+);
+
+// safe with a key operation in flight, its result is dropped
+void ant_tls_conn_free(ant_tls_conn_t *tls);
+
+int ant_tls_conn_input(ant_tls_conn_t *tls, const char *data, size_t len);
+
+// 0 once established, UV_EAGAIN while waiting on the peer or a key operation
+int ant_tls_conn_handshake(ant_tls_conn_t *tls);
+
+// UV_EAGAIN when no full record is buffered, UV_EOF after close_notify
+int ant_tls_conn_read(ant_tls_conn_t *tls, char *out, size_t cap, size_t *nread);
+
+// hands over pending ciphertext, *out is malloc'd and NULL when there is none
+int ant_tls_conn_take_output(ant_tls_conn_t *tls, char **out, size_t *len);
+
+int ant_tls_conn_seal(
+  ant_tls_conn_t *tls,
+  const uv_buf_t *bufs,
+  unsigned int nbufs,
+  char **out,
+  size_t *len
+);
+
+int ant_tls_conn_close_notify(ant_tls_conn_t *tls, char **out, size_t *len);
+
+// once the kernel owns the write side, plaintext goes straight to the socket
+bool ant_tls_conn_kernel_tx(const ant_tls_conn_t *tls);
+bool ant_tls_conn_wants_kernel_tx(const ant_tls_conn_t *tls);
+int ant_tls_conn_enable_kernel_tx(ant_tls_conn_t *tls, int fd);
+
+#endif
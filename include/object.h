@@ -15,6 +15,7 @@ typedef struct {
   ant_value_t (*getter)(ant_t *, ant_value_t, const char *, size_t);
   bool (*setter)(ant_t *, ant_value_t, const char *, size_t, ant_value_t);
   bool (*deleter)(ant_t *, ant_value_t, const char *, size_t);
+  ant_value_t (*materialize)(ant_t *, ant_value_t);
 } ant_exotic_ops_t;
 
 typedef struct promise_handler {
@@ -77,6 +78,9 @@ typedef struct {
   uint32_t tag;
 } ant_native_entry_t;
 
+typedef ant_value_t (*ant_object_keys_fn)(ant_t *, ant_value_t);
+typedef void (*ant_object_finalizer_fn)(ant_t *, struct ant_object *);
+
 typedef struct {
   ant_extra_slot_t *extra_slots;
   ant_native_entry_t *native_entries;
@@ -84,6 +88,9 @@ typedef struct {
   ant_proxy_state_t *proxy_state;
   sv_eval_env_state_t *eval_env_state;
   
+  ant_object_keys_fn exotic_keys;
+  ant_object_finalizer_fn finalizer;
+  
   uint8_t native_count;
   uint8_t native_cap;
   uint8_t extra_count;
@@ -132,13 +139,8 @@ typedef struct ant_object {
   ant_value_t *overflow_prop;
   
   const ant_exotic_ops_t *exotic_ops;
-  ant_value_t (*exotic_keys)(ant_t *, ant_value_t);
-  
   ant_promise_state_t *promise_state;
   ant_extra_slot_t *extra_slots;
-  
-  void (*finalizer)(ant_t *, struct ant_object *);
-  ant_value_t inobj[ANT_INOBJ_MAX_SLOTS];
   ant_native_entry_t native;
 
   union {
@@ -157,8 +159,33 @@ typedef struct ant_object {
 
   ant_object_flags_t flags;
   uint32_t ic_identity;
+  
+  // sized by the arena class the object was allocated from, see ant_object_class_slots()
+  ant_value_t inobj[];
 } ant_object_t;
 
+// objects live in one fixed arena per size class; the class only adds in-object slots
+static constexpr uint32_t ANT_OBJ_SIZE_CLASSES = 3;
+
+static inline uint32_t ant_object_size_class(uint32_t inobj_limit) {
+  if (inobj_limit <= ANT_INOBJ_DEFAULT_SLOTS) return 0;
+  if (inobj_limit <= ANT_INOBJ_DEFAULT_SLOTS * 2) return 1;
+  return 2;
+}
+
+static inline uint32_t ant_object_class_slots(uint32_t size_class) {
+  return ANT_INOBJ_DEFAULT_SLOTS << size_class;
+}
+
+static inline size_t ant_object_class_size(uint32_t size_class) {
+  return sizeof(ant_object_t) + ant_object_class_slots(size_class) * sizeof(ant_value_t);
+}
+
+static_assert(
+  ANT_INOBJ_DEFAULT_SLOTS << (ANT_OBJ_SIZE_CLASSES - 1) == ANT_INOBJ_MAX_SLOTS,
+  "largest object size class must hold ANT_INOBJ_MAX_SLOTS"
+);
+
 static inline bool ant_object_has_sidecar(const ant_object_t *obj) {
   return obj && (((uintptr_t)obj->extra_slots & ant_sidecar) != 0);
 }
@@ -260,8 +287,18 @@ static inline ant_private_table_t *ant_object_private_table(const ant_object_t *
   return sidecar ? (ant_private_table_t *)&sidecar->private_table : NULL;
 }
 
+static inline ant_object_finalizer_fn ant_object_finalizer(const ant_object_t *obj) {
+  ant_object_sidecar_t *sidecar = ant_object_sidecar(obj);
+  return sidecar ? sidecar->finalizer : NULL;
+}
+
+static inline ant_object_keys_fn ant_object_exotic_keys(const ant_object_t *obj) {
+  ant_object_sidecar_t *sidecar = ant_object_sidecar(obj);
+  return sidecar ? sidecar->exotic_keys : NULL;
+}
+
 static inline uint32_t ant_object_inobj_limit(const ant_object_t *obj) {
-  if (!obj) return ANT_INOBJ_MAX_SLOTS;
+  if (!obj) return ANT_INOBJ_DEFAULT_SLOTS;
   uint32_t limit = obj->inobj_limit;
   return (limit > ANT_INOBJ_MAX_SLOTS) ? ANT_INOBJ_MAX_SLOTS : limit;
 }
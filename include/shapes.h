@@ -6,8 +6,12 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifndef ANT_INOBJ_DEFAULT_SLOTS
+#define ANT_INOBJ_DEFAULT_SLOTS 4u
+#endif
+
 #ifndef ANT_INOBJ_MAX_SLOTS
-#define ANT_INOBJ_MAX_SLOTS 4u
+#define ANT_INOBJ_MAX_SLOTS 16u
 #endif
 
 // TODO: constexpr
@@ -109,6 +109,7 @@ enum {
   FN_DERIVED_CTOR     = 1 << 17,
   FN_CLASS_DECL       = 1 << 18,
   FN_CLASS_CTOR       = 1 << 19,
+  FN_PREPARSED        = 1 << 20,
 };
 
 enum {
@@ -168,5 +169,11 @@ bool ast_contains_own_yield(const sv_ast_t *node, const sv_ast_t **out_offender)
 
 sv_ast_t *sv_ast_new(sv_node_type_t type);
 sv_ast_t *sv_parse(ant_t *js, const char *code, ant_offset_t clen, bool strict);
+sv_ast_t *sv_parse_lazy(ant_t *js, const char *code, ant_offset_t clen, bool strict);
+
+sv_ast_t *sv_parse_function_at(
+  ant_t *js, const char *code, ant_offset_t clen,
+  ant_offset_t off, bool strict, bool lazy
+);
 
 #endif
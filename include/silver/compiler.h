@@ -87,8 +87,29 @@ typedef struct const_dedup_entry {
 typedef struct sv_line_table {
   uint32_t *offsets;
   int count;
+  bool retained;
 } sv_line_table_t;
 
+typedef struct {
+  const char *name;
+  uint32_t len;
+  bool is_const;
+  sv_binding_meta_t binding;
+} sv_lazy_capture_t;
+
+typedef struct sv_lazy_func {
+  const char *source;
+  const char *filename;
+  sv_line_table_t *line_table;
+  sv_lazy_capture_t *captures;
+  ant_offset_t source_len;
+  uint32_t src_off;
+  uint32_t src_end;
+  int capture_count;
+  bool is_strict;
+  bool in_module;
+} sv_lazy_func_t;
+
 typedef struct {
   const char *name;
   uint32_t len;
@@ -170,6 +191,8 @@ typedef struct sv_compiler {
   sv_compile_mode_t mode;
 
   bool is_tla;
+  bool allow_lazy;
+  bool eager_children;
   bool regexp_exec_write_seen;
   bool regexp_replace_write_seen;
   
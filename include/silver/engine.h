@@ -50,20 +50,50 @@ typedef enum {
 
 typedef enum {
 #define OP_DEF(name, size, n_pop, n_push, f) OP_##name,
+#include "silver/opcode.h"
+#define OP_FUSED(name, head, next) OP_##name,
 #include "silver/opcode.h"
   OP__COUNT
 } sv_op_t;
 
+enum {
+#define OP_DEF(name, size, n_pop, n_push, f) SV_OP_SIZE_##name = (size),
+#include "silver/opcode.h"
+};
+
+enum {
+#define OP_FLAG(name, flags) SV_OP_FLAGS_##name = (flags),
+#include "silver/opcode.h"
+};
+
 static const uint8_t sv_op_size[OP__COUNT] = {
 #define OP_DEF(name, size, n_pop, n_push, f) [OP_##name] = (size),
 #include "silver/opcode.h"
+#define OP_FUSED(name, head, next) [OP_##name] = SV_OP_SIZE_##head,
+#include "silver/opcode.h"
 };
 
 static const uint16_t sv_op_flags[OP__COUNT] = {
 #define OP_FLAG(name, flags) [OP_##name] = (flags),
 #include "silver/opcode.h"
+#define OP_FUSED(name, head, next) [OP_##name] = SV_OP_FLAGS_##head,
+#include "silver/opcode.h"
 };
 
+static const uint8_t sv_op_base_ops[OP__COUNT] = {
+#define OP_DEF(name, size, n_pop, n_push, f) [OP_##name] = OP_##name,
+#include "silver/opcode.h"
+#define OP_FUSED(name, head, next) [OP_##name] = OP_##head,
+#include "silver/opcode.h"
+};
+
+static_assert(OP__COUNT <= 256, "opcodes are encoded in one byte");
+
+// superinstructions decode as their head op everywhere but the interpreter
+static inline sv_op_t sv_op_base(sv_op_t op) {
+  return (unsigned)op < OP__COUNT ? (sv_op_t)sv_op_base_ops[op] : op;
+}
+
 static const bool sv_op_ic_slots[OP__COUNT] = {
 #define OP_IC_SLOT(name) [OP_##name] = true,
 #include "silver/opcode.h"
@@ -205,6 +235,19 @@ typedef struct {
   sv_func_t  *target;
 } sv_call_target_fb_t;
 
+// a loop compiled on its own and entered only through OSR at its header;
+// code stays NULL and failed is set for a header whose loop cannot be
+// compiled, start is -1 for a free slot
+typedef struct {
+  void *code;
+  void *owner;
+  int start;
+  int end;
+  bool failed;
+} sv_jit_loop_unit_t;
+
+#define SV_JIT_LOOP_UNITS 4
+
 typedef struct {
   uint64_t samples;
   uint64_t hist[SV_TFB_CTOR_PROP_BINS];
@@ -214,6 +257,7 @@ typedef struct {
 
 typedef struct {
   uint8_t *type_feedback;
+  uint8_t *elem_kinds;
   sv_ctor_prop_fb_t ctor_prop_fb;
 } sv_func_sidecar_t;
 
@@ -280,6 +324,7 @@ struct sv_func {
   sv_obj_site_cache_t *obj_sites;
   sv_upval_desc_t *upval_descs;
   sv_func_debug_t *debug;
+  struct sv_lazy_func *lazy;
 
   union {
     sv_type_info_t *local_types;
@@ -288,9 +333,11 @@ struct sv_func {
 
 #ifdef ANT_JIT
   void *jit_code;
+  void *jit_owner;
   uint8_t *type_feedback;
   uint8_t *local_type_feedback;
   sv_call_target_fb_t *call_target_fb;
+  sv_jit_loop_unit_t *jit_loops;
 #endif
 
   uint64_t gc_epoch;
@@ -327,6 +374,7 @@ struct sv_func {
   bool jit_compile_failed: 1;
   bool jit_compiling: 1;
   bool jit_loop_hot: 1;
+  bool jit_loop_failed: 1;
 #endif
 
 #ifdef ANT_JIT
@@ -337,7 +385,10 @@ struct sv_func {
   uint32_t jit_compiled_tfb_ver;
 
   uint8_t jit_bailout_count;
+  uint8_t jit_loop_bailout_count;
+  uint8_t jit_loop_next;
   uint8_t call_target_fb_count;
+  uint8_t jit_used;
 #endif
 };
 
@@ -370,6 +421,20 @@ static inline sv_func_metadata_t *sv_func_metadata(sv_func_t *func) {
   return func->type_data.metadata;
 }
 
+typedef struct {
+  uint32_t deferred;
+  uint32_t compiled;
+  uint64_t deferred_bytes;
+  uint64_t compiled_bytes;
+} sv_lazy_stats_t;
+
+sv_lazy_stats_t sv_lazy_stats(void);
+bool sv_func_compile_lazy(ant_t *js, sv_func_t *func);
+
+static inline bool sv_func_ensure_compiled(ant_t *js, sv_func_t *func) {
+  return __builtin_expect(func->lazy == NULL, 1) || sv_func_compile_lazy(js, func);
+}
+
 static inline sv_type_info_t *sv_func_local_types(sv_func_t *func) {
   if (!func) return NULL;
   if (!func->has_dynamic_eval) return func->type_data.local_types;
@@ -509,19 +574,28 @@ static inline sv_upvalue_t *js_upvalue_alloc(ant_t *js) {
 #define SV_CALL_BORROWED_UPVALS  (1u << 4)
 #define SV_CALL_HAS_EVAL_ENV     (1u << 5)
 #define SV_CALL_HAS_BOUND_THIS   (1u << 6)
+#define SV_CALL_HAS_NATIVE_STUB  (1u << 7)
 
 static constexpr char SV_CLASS_CTOR_CALL_ERROR[] =
   "Class constructor cannot be invoked without 'new'";
 
 #define SV_CLOSURE_INLINE_UPVALS 4
 
+typedef ant_value_t (*sv_native_stub_t)(ant_t *js, ant_value_t *args, int nargs);
+
 typedef struct sv_closure {
   uint32_t call_flags;
   int bound_argc;
   
   sv_func_t *func;
   sv_upvalue_t **upvalues;
-  sv_upvalue_t *inline_upvals[SV_CLOSURE_INLINE_UPVALS];
+  
+  // native closures (func == NULL) never own upvalues, so the inline
+  // storage doubles as the JIT-callable entry for SV_CALL_HAS_NATIVE_STUB
+  union {
+    sv_upvalue_t *inline_upvals[SV_CLOSURE_INLINE_UPVALS];
+    sv_native_stub_t native_stub;
+  };
   
   ant_value_t bound_this;
   ant_value_t super_val;
@@ -645,6 +719,7 @@ typedef struct {
   ant_value_t *locals;
   int n_locals;
   ant_value_t *lp;
+  ant_value_t *bp;
 } sv_jit_osr_t;
 #endif
 
@@ -1247,6 +1322,10 @@ static inline ant_value_t sv_call_closure(
 #define SV_TFB_BOOL  (1 << 2)
 #define SV_TFB_OTHER (1 << 3)
 
+#define SV_TFB_ELEM_NONE    0x00
+#define SV_TFB_ELEM_GENERIC 0xFE
+#define SV_TFB_ELEM_MEGA    0xFF
+
 #define SV_TFB_INOBJ_SLACK_ALLOCATIONS 32
 #define SV_TFB_INOBJ_P90_NUMERATOR 9
 #define SV_TFB_INOBJ_P90_DENOMINATOR 10
@@ -1260,6 +1339,7 @@ static inline ant_value_t sv_call_closure(
 #define SV_CALL_FB_MISS_DISABLE 4
 
 #define SV_JIT_RETRY_INTERP    mkval(T_ERR, 1)
+#define SV_JIT_LOOP_EXIT       mkval(T_ERR, 2)
   
 extern const char *const sv_op_names[OP__COUNT];
   
@@ -1326,6 +1406,34 @@ static inline void sv_jit_on_bailout(sv_func_t *fn) {
   sv_jit_on_bailout_at(fn, "direct", -1);
 }
 
+// a bailout inside a loop unit frees its slot so the loop compiles again
+// against fresher feedback; loop units have their own limit since they
+// also serve functions the whole-function compiler has given up on
+static inline void sv_jit_on_loop_bailout(sv_func_t *fn, int loop_start, int bc_off) {
+  if (!fn || !fn->jit_loops) return;
+  
+  for (int i = 0; i < SV_JIT_LOOP_UNITS; i++) {
+    sv_jit_loop_unit_t *unit = &fn->jit_loops[i];
+    if (unit->start != loop_start) continue;
+    unit->code = NULL;
+    unit->start = -1;
+    unit->failed = false;
+  }
+  
+  fn->back_edge_count = 0;
+  if (fn->jit_loop_bailout_count < UINT8_MAX)
+    fn->jit_loop_bailout_count++;
+  
+  if (sv_jit_warn_unlikely) fprintf(
+    stderr, "jit: loop bailout %u/%u func=%s loop=%d bc=%d\n",
+    (unsigned)fn->jit_loop_bailout_count, (unsigned)SV_JIT_BAILOUT_LIMIT,
+    fn->debug->name ? fn->debug->name : "<anonymous>", loop_start, bc_off
+  );
+  
+  if (fn->jit_loop_bailout_count >= SV_JIT_BAILOUT_LIMIT)
+    fn->jit_loop_failed = true;
+}
+
 typedef ant_value_t (*sv_jit_func_t)(
   sv_vm_t *,
   ant_value_t,
@@ -1340,6 +1448,10 @@ ant_value_t sv_jit_try_compile_and_call(sv_vm_t *vm, ant_t *js,
   sv_call_ctx_t *ctx, ant_value_t *out_this
 );
 
+// picks up code the compiler thread has finished; the call and back-edge
+// paths poll it while a function is queued so it runs as soon as it is ready
+void sv_jit_install_ready(ant_t *js);
+
 static inline uint8_t sv_tfb_classify(ant_value_t v) {
   if (vtype(v) == T_NUM) return SV_TFB_NUM;
   if (vtype(v) == T_STR) return SV_TFB_STR;
@@ -1460,6 +1572,38 @@ static inline sv_func_t *sv_tfb_get_call_target(sv_func_t *func, int bc_off) {
   return NULL;
 }
 
+// element kind per GET_ELEM/PUT_ELEM site: TypedArrayType + 1 when only
+// one typed array kind has been seen, GENERIC for anything else
+static inline void sv_tfb_record_elem_kind(sv_func_t *func, uint8_t *ip, uint8_t kind) {
+  if (!func || !ip || !sv_func_type_feedback(func)) return;
+  sv_func_sidecar_t *sidecar = kind != SV_TFB_ELEM_GENERIC
+    ? sv_func_ensure_sidecar(func)
+    : sv_func_sidecar(func);
+  if (!sidecar) return;
+
+  if (!sidecar->elem_kinds) {
+    if (kind == SV_TFB_ELEM_GENERIC) return;
+    sidecar->elem_kinds = calloc((size_t)func->code_len, 1);
+    if (!sidecar->elem_kinds) return;
+  }
+
+  int off = (int)(ip - func->code);
+  uint8_t old = sidecar->elem_kinds[off];
+  uint8_t neu = (old == SV_TFB_ELEM_NONE || old == kind) ? kind : SV_TFB_ELEM_MEGA;
+
+  if (neu != old) {
+    sidecar->elem_kinds[off] = neu;
+    func->tfb_version++;
+  }
+}
+
+static inline uint8_t sv_tfb_elem_kind(const sv_func_t *func, int bc_off) {
+  sv_func_sidecar_t *sidecar = sv_func_sidecar(func);
+  if (!sidecar || !sidecar->elem_kinds) return SV_TFB_ELEM_NONE;
+  if (bc_off < 0 || bc_off >= func->code_len) return SV_TFB_ELEM_NONE;
+  return sidecar->elem_kinds[bc_off];
+}
+
 static inline void sv_tfb_record_local(sv_func_t *func, int idx, ant_value_t v) {
   if (func->local_type_feedback && idx >= 0 && idx < func->max_locals) {
     uint8_t old = func->local_type_feedback[idx];
@@ -1490,9 +1634,9 @@ static inline uint64_t sv_tfb_ctor_prop_bin(const sv_func_t *func, uint32_t bin)
 }
 
 static inline uint8_t sv_tfb_infer_inobj_limit(const sv_func_t *func, uint64_t samples) {
-  if (!func || samples == 0) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  if (!func || samples == 0) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
   sv_ctor_prop_fb_t *fb = sv_tfb_ctor_prop_fb((sv_func_t *)func, false);
-  if (!fb) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  if (!fb) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
 
   uint64_t target = (
     (samples * SV_TFB_INOBJ_P90_NUMERATOR)
@@ -1508,7 +1652,7 @@ static inline uint8_t sv_tfb_infer_inobj_limit(const sv_func_t *func, uint64_t s
     return sv_tfb_clamp_inobj_limit(i);
   }
 
-  return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
 }
 
 static inline void sv_tfb_record_ctor_prop_count(ant_value_t ctor_func, ant_value_t instance) {
@@ -1540,14 +1684,14 @@ static inline void sv_tfb_record_ctor_prop_count(ant_value_t ctor_func, ant_valu
 }
 
 static inline uint8_t sv_tfb_ctor_inobj_limit(ant_value_t ctor_func) {
-  if (vtype(ctor_func) != T_FUNC) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  if (vtype(ctor_func) != T_FUNC) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
   sv_closure_t *closure = js_func_closure(ctor_func);
-  if (!closure || !closure->func) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  if (!closure || !closure->func) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
 
   sv_func_t *func = closure->func;
   sv_ctor_prop_fb_t *fb = sv_tfb_ctor_prop_fb(func, false);
   
-  if (!fb || !fb->inobj_frozen) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  if (!fb || !fb->inobj_frozen) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
   return sv_tfb_clamp_inobj_limit(fb->inobj_limit);
 }
 
@@ -1582,7 +1726,7 @@ static inline void sv_tfb_record_ctor_prop_count(ant_value_t ctor_func, ant_valu
 
 static inline uint8_t sv_tfb_ctor_inobj_limit(ant_value_t ctor_func) {
   (void)ctor_func;
-  return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
 }
 
 static inline bool sv_tfb_ctor_inobj_limit_frozen(ant_value_t ctor_func) {
@@ -1607,6 +1751,7 @@ static inline ant_value_t sv_call_resolve_closure(
 #ifdef ANT_JIT
   if (!closure->func->is_generator) {
     sv_func_t *fn = closure->func;
+    if (__builtin_expect(fn->jit_compiling, 0)) sv_jit_install_ready(js);
     if (fn->jit_code) {
       sv_jit_enter(js);
       ant_value_t result = ((sv_jit_func_t)fn->jit_code)(
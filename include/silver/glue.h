@@ -166,6 +166,14 @@ ant_value_t jit_helper_bailout_resume(
   int64_t bc_offset
 );
 
+ant_value_t jit_helper_loop_exit(
+  sv_vm_t *vm, sv_closure_t *closure,
+  ant_value_t *vstack, int64_t vstack_sp,
+  ant_value_t *params, int64_t n_params,
+  ant_value_t *locals, int64_t n_locals,
+  int64_t bc_offset, int64_t loop_start, int64_t loop_end
+);
+
 void jit_helper_close_upval(
   sv_vm_t *vm, int32_t slot_idx,
   ant_value_t *locals, int n_locals,
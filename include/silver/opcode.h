@@ -284,6 +284,33 @@ op_def(  COL_NUM,           5,   0,   0, u32)       /* source column for debug i
 #undef op_def
 #endif
 
+/* superinstructions: OP_FUSED(name, head, next) is `head` (same operands,
+ * same size) whose handler falls straight into `next` without a dispatch.
+ * the next instruction is left intact in the stream, so jump targets and
+ * bytecode scans are unaffected; `next` may itself be fused, forming a chain.
+ *
+ * the set is picked by hand from `ant --profile-opcodes` over loop-heavy
+ * code (examples/jit, examples/spec): the hottest pairs and triples whose
+ * head always falls through. the report tags each n-gram an entry below
+ * already covers with `<- NAME` and prints uncovered hot pairs as ready-made
+ * OP_FUSED lines; adding one also takes an L_<name> handler in engine.c. */
+#ifdef OP_FUSED
+OP_FUSED(  LT_JMP_FALSE,                      LT,          JMP_FALSE)
+OP_FUSED(  LT_JMP_FALSE8,                     LT,          JMP_FALSE8)
+OP_FUSED(  CONST_I8_LT_JMP_FALSE,             CONST_I8,    LT_JMP_FALSE)
+OP_FUSED(  CONST_I8_LT_JMP_FALSE8,            CONST_I8,    LT_JMP_FALSE8)
+OP_FUSED(  GET_LOCAL8_LT_JMP_FALSE,           GET_LOCAL8,  LT_JMP_FALSE)
+OP_FUSED(  GET_LOCAL8_LT_JMP_FALSE8,          GET_LOCAL8,  LT_JMP_FALSE8)
+OP_FUSED(  GET_LOCAL8_CONST_I8_LT_JMP_FALSE,  GET_LOCAL8,  CONST_I8_LT_JMP_FALSE)
+OP_FUSED(  GET_LOCAL8_CONST_I8_LT_JMP_FALSE8, GET_LOCAL8,  CONST_I8_LT_JMP_FALSE8)
+OP_FUSED(  GET_LOCAL8_GET_FIELD,              GET_LOCAL8,  GET_FIELD)
+OP_FUSED(  GET_LOCAL8_GET_LENGTH,             GET_LOCAL8,  GET_LENGTH)
+OP_FUSED(  GET_LOCAL8_GET_LOCAL8,             GET_LOCAL8,  GET_LOCAL8)
+OP_FUSED(  GET_ARG_GET_FIELD,                 GET_ARG,     GET_FIELD)
+OP_FUSED(  THIS_GET_FIELD,                    THIS,        GET_FIELD)
+#undef OP_FUSED
+#endif
+
 #ifdef OP_FLAG
 OP_FLAG(CONST                 , SV_OPF_JIT_ELIGIBLE | SV_OPF_JIT_INLINEABLE)
 OP_FLAG(CONST_I8              , SV_OPF_JIT_ELIGIBLE | SV_OPF_JIT_INLINEABLE)
@@ -0,0 +1,60 @@
+#ifndef SILVER_PREPARSE_H
+#define SILVER_PREPARSE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "lexer.h"
+
+// nested function bodies shorter than this are parsed eagerly; a stub and a
+// later reparse cost more than they save on small bodies
+#define SV_LAZY_MIN_SOURCE_BYTES 256u
+
+typedef struct {
+  const char *str;
+  uint32_t len;
+} sv_preparse_name_t;
+
+typedef struct {
+  sv_preparse_name_t name;
+  int scope;
+} sv_preparse_decl_t;
+
+typedef struct {
+  int ref_start;
+  int decl_start;
+  uint8_t flags;
+} sv_preparse_scope_t;
+
+typedef struct {
+  sv_lexer_t *lx;
+
+  sv_preparse_name_t *refs;
+  int ref_count;
+  int ref_cap;
+
+  sv_preparse_decl_t *decls;
+  int decl_count;
+  int decl_cap;
+
+  sv_preparse_scope_t *scopes;
+  int scope_count;
+  int scope_cap;
+
+  int depth;
+  bool failed;
+  bool uses_arguments;
+  bool uses_new_target;
+} sv_preparse_t;
+
+// skims a function from its parameter list to the end of its body without
+// building an AST; only the bracket structure, the scopes and the names the
+// function reads from outside itself are kept. anything the skim is not sure
+// about fails it, and the caller parses that function in full instead
+void sv_preparse_init(sv_preparse_t *pp, sv_lexer_t *lx, bool is_generator);
+void sv_preparse_free(sv_preparse_t *pp);
+
+bool sv_preparse_params(sv_preparse_t *pp);
+bool sv_preparse_body(sv_preparse_t *pp);
+
+#endif
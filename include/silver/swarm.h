@@ -6,9 +6,45 @@
 
 #define SV_JIT_OSR_THRESHOLD 500
 
+typedef struct {
+  uint64_t queued;
+  uint64_t installed;
+  uint64_t failed;
+  uint64_t compile_ns;
+  uint64_t max_compile_ns;
+  uint32_t depth;
+  bool background;
+} sv_jit_stats_t;
+
+typedef struct {
+  uint64_t evicted;
+  uint64_t collected;
+  uint64_t reclaimed_spaces;
+  uint64_t reclaimed_bytes;
+  uint64_t scalar_objects;
+  size_t code_bytes;
+  size_t peak_code_bytes;
+  size_t resident_bytes;
+  size_t budget;
+  uint32_t functions;
+  uint32_t spaces;
+} sv_jit_code_stats_t;
+
 void sv_jit_init(ant_t *js);
 void sv_jit_destroy(ant_t *js);
 
+// background compiler counters; all zero when compiling on the JS thread
+sv_jit_stats_t sv_jit_stats(ant_t *js);
+
+// code sizes are estimated from the MIR instruction count of each function,
+// scalar_objects counts object literals compiled into registers
+sv_jit_code_stats_t sv_jit_code_stats(ant_t *js);
+
+// after a full collection: drops code of functions the marker did not reach
+void sv_jit_gc_sweep(ant_t *js, uint64_t gc_epoch);
+
+struct MIR_context *sv_jit_stub_context(ant_t *js);
+
 sv_jit_func_t sv_jit_compile(
   ant_t *js, sv_func_t *func, 
   sv_closure_t *hint_closure
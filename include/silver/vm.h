@@ -8,6 +8,9 @@ typedef struct sv_func sv_func_t;
 size_t os_thread_stack_size(void);
 
 extern int sv_user_stack_size_kb;
+extern int sv_jit_code_budget_kb;
+extern bool sv_lazy_functions;
+extern bool sv_profile_opcodes;
 sv_vm_t *sv_vm_create(ant_t *js);
 
 void sv_vm_destroy(sv_vm_t *vm);
@@ -15,6 +18,7 @@ void sv_vm_limits(int *out_stack_size, int *out_max_frames);
 
 void sv_vm_visit_frame_funcs(sv_vm_t *vm, void (*visitor)(void *, sv_func_t *), void *ctx);
 void sv_disasm(ant_t *js, sv_func_t *func, const char *label);
+void sv_opcode_profile_report(void);
 
 ant_value_t sv_execute_frame(
   sv_vm_t *vm, sv_func_t *func,
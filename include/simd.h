@@ -0,0 +1,36 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// byte-scanning kernels shared by the string, JSON, Buffer and text codec
+// paths. the first call picks the widest implementation the running CPU
+// supports (AVX2 on x86-64, otherwise 128-bit SSE2/NEON through simde)
+
+// number of leading bytes below 0x80
+size_t simd_ascii_prefix(const void *data, size_t len);
+
+// number of leading bytes a JSON string quoter can copy verbatim: no control
+// characters, quotes or backslashes, and no 0xED lead (a WTF-8 surrogate)
+size_t simd_json_safe_prefix(const void *data, size_t len);
+
+// first occurrence of needle in haystack, or NULL; an empty needle matches at 0
+const void *simd_find(
+  const void *haystack, size_t haystack_len,
+  const void *needle, size_t needle_len
+);
+
+// writes 2 * len lowercase hex digits to dst (no terminator)
+void simd_hex_encode(const uint8_t *src, size_t len, char *dst);
+
+// decodes hex pairs until the first invalid digit or a trailing odd digit,
+// returning the number of bytes written to dst
+size_t simd_hex_decode(const char *src, size_t len, uint8_t *dst);
+
+static inline bool simd_is_ascii(const void *data, size_t len) {
+  return simd_ascii_prefix(data, len) == len;
+}
+
+#endif
@@ -24,6 +24,7 @@ typedef struct {
   bool pull_again;
   bool pulling;
   bool started;
+  bool native;
 } rs_controller_t;
 
 typedef struct {
@@ -77,6 +78,8 @@ void readable_stream_close(ant_t *js, ant_value_t stream_obj);
 void readable_stream_error(ant_t *js, ant_value_t stream_obj, ant_value_t e);
 
 bool rs_reader_has_reqs(ant_t *js, ant_value_t reader_obj);
+bool rs_stream_has_native_source(ant_t *js, ant_value_t stream_obj);
+bool rs_default_reader_take(ant_t *js, ant_value_t reader_obj, ant_value_t *chunk_out);
 bool rs_default_controller_can_close_or_enqueue(rs_controller_t *ctrl, rs_stream_t *stream);
 
 #endif
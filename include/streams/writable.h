@@ -20,6 +20,7 @@ typedef struct {
   double strategy_hwm;
   bool close_requested;
   bool started;
+  bool native;
 } ws_controller_t;
 
 typedef struct {
@@ -53,6 +54,7 @@ ant_value_t ws_writer_write(ant_t *js, ant_value_t writer_obj, ant_value_t chunk
 ant_value_t writable_stream_close(ant_t *js, ant_value_t stream_obj);
 ant_value_t writable_stream_abort(ant_t *js, ant_value_t stream_obj, ant_value_t reason);
 
+bool ws_stream_has_native_sink(ant_value_t stream_obj);
 bool writable_stream_close_queued_or_in_flight(ant_value_t stream_obj);
 void writable_stream_finish_erroring(ant_t *js, ant_value_t stream_obj);
 void ws_default_controller_error(ant_t *js, ant_value_t ctrl_obj, ant_value_t error);
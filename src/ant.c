@@ -14,6 +14,7 @@
 #include "utils.h"
 #include "sugar.h"
 #include "base64.h"
+#include "simd.h"
 #include "runtime.h"
 #include "internal.h"
 #include "errors.h"
@@ -71,6 +72,7 @@
 #include "modules/collections.h"
 #include "modules/cron.h"
 #include "modules/lmdb.h"
+#include "modules/json.h"
 #include "modules/regex.h"
 #include "modules/globals.h"
 #include "modules/rpc.h"
@@ -397,9 +399,12 @@ static ant_exotic_ops_t *obj_ensure_exotic_ops(ant_object_t *obj) {
 
 static ant_object_t *obj_alloc(ant_t *js, uint8_t type_tag, uint8_t inobj_limit) {
   size_t threshold = gc_live_major_threshold(js);
-  if (js->obj_arena.live_count >= threshold) gc_maybe(js);
+  if (js_obj_live_count(js) >= threshold) gc_maybe(js);
 
-  ant_object_t *obj = (ant_object_t *)fixed_arena_alloc(&js->obj_arena);
+  if (inobj_limit > ANT_INOBJ_MAX_SLOTS) inobj_limit = (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  ant_fixed_arena_t *arena = &js->obj_arenas[ant_object_size_class(inobj_limit)];
+  
+  ant_object_t *obj = (ant_object_t *)fixed_arena_alloc(arena);
   if (!obj) return NULL;
 
   obj->type_tag = type_tag;
@@ -409,26 +414,24 @@ static ant_object_t *obj_alloc(ant_t *js, uint8_t type_tag, uint8_t inobj_limit)
   obj->shape = ant_shape_new_with_inobj_limit(inobj_limit);
   if (!obj->shape) {
     obj->mark_epoch = ANT_GC_DEAD;
-    fixed_arena_free_elem(&js->obj_arena, obj);
+    fixed_arena_free_elem(arena, obj);
     return NULL;
   }
-  obj->inobj_limit = ant_shape_get_inobj_limit(obj->shape);
+  obj->inobj_limit = inobj_limit;
   
   obj->overflow_prop = NULL;
   obj->overflow_cap = 0;
   obj->prop_count = 0;
   
-  for (uint32_t i = 0; i < ANT_INOBJ_MAX_SLOTS; i++) 
+  for (uint32_t i = 0; i < inobj_limit; i++) 
     obj->inobj[i] = js_mkundef();
   
   obj->exotic_ops = NULL;
-  obj->exotic_keys = NULL;
   obj->promise_state = NULL;
   obj->extra_slots = NULL;
   obj->extra_count = 0;
   obj->extra_cap = 0;
   
-  obj->finalizer = NULL;
   obj->native.ptr = NULL;
   obj->native.tag = 0;
   
@@ -575,6 +578,10 @@ ant_offset_t vstrlen(ant_t *js, ant_value_t v) {
     ant_string_builder_t *builder = ant_str_builder_ptr(v);
     return builder ? builder->len : 0;
   }
+  if (str_is_heap_slice(v)) {
+    ant_slice_heap_t *slice = ant_str_slice_ptr(v);
+    return slice ? slice->len : 0;
+  }
   ant_flat_string_t *flat = ant_str_flat_ptr(v);
   return flat ? flat->len : 0;
 }
@@ -1182,6 +1189,7 @@ static size_t strkey_interned(ant_t *js, const char *key, size_t klen, char *buf
 static bool is_small_object(ant_t *js, ant_value_t obj, int *prop_count) {
   int count = 0;
   bool has_nested = false;
+  js_obj_materialize(js, obj);
 
   ant_value_t as_obj = js_as_obj(obj);
   ant_object_t *ptr = js_obj_ptr(as_obj);
@@ -1538,6 +1546,7 @@ bool js_inspect_object_body(js_inspect_builder_t *builder, ant_value_t obj) {
 
   bool first = builder->first;
   ant_t *js = builder->js;
+  js_obj_materialize(js, obj);
   ant_value_t tag_sym = get_toStringTag_sym();
   ant_value_t as_obj = js_as_obj(obj);
   ant_object_t *ptr = js_obj_ptr(as_obj);
@@ -2059,6 +2068,92 @@ static inline void builder_set_cached_flat(ant_value_t builder, ant_value_t flat
   ptr->cached = flat;
 }
 
+static inline ant_slice_heap_t *assert_slice_ptr(ant_value_t value) {
+  assert(vtype(value) == T_STR);
+  assert(str_is_heap_slice(value));
+  
+  ant_slice_heap_t *ptr = ant_str_slice_ptr(value);
+  assert(ptr != NULL);
+  
+  return ptr;
+}
+
+static inline ant_offset_t slice_len(ant_value_t value) {
+  ant_slice_heap_t *ptr = assert_slice_ptr(value);
+  return ptr->len;
+}
+
+static ant_value_t slice_flatten(ant_t *js, ant_value_t slice) {
+  assert(vtype(slice) == T_STR);
+  if (!str_is_heap_slice(slice)) return slice;
+
+  ant_slice_heap_t *ptr = assert_slice_ptr(slice);
+  if (vtype(ptr->cached) == T_STR) return ptr->cached;
+
+  GC_ROOT_SAVE(root_mark, js);
+  GC_ROOT_PIN(js, slice);
+  
+  ant_value_t flat = js_mkstr(js, NULL, (size_t)ptr->len);
+  GC_ROOT_PIN(js, flat);
+  
+  if (is_err(flat)) {
+    GC_ROOT_RESTORE(js, root_mark);
+    return flat;
+  }
+
+  ant_flat_string_t *flat_ptr = ant_str_flat_ptr(flat);
+  ant_flat_string_t *parent = ant_str_flat_ptr(ptr->parent);
+  memcpy(flat_ptr->bytes, parent->bytes + ptr->offset, (size_t)ptr->len);
+  flat_ptr->bytes[ptr->len] = '\0';
+  
+  str_flat_init_meta(
+    flat_ptr, ptr->ascii_state != STR_ASCII_UNKNOWN 
+      ? ptr->ascii_state
+      : str_detect_ascii_bytes(flat_ptr->bytes, (size_t)ptr->len)
+  );
+  
+  if (ptr->utf16_len != STR_UTF16_LEN_UNKNOWN)
+    str_flat_set_utf16_len(flat_ptr, ptr->utf16_len);
+
+  ptr->cached = flat;
+  ptr->parent = js_mkundef();
+  GC_ROOT_RESTORE(js, root_mark);
+  
+  return flat;
+}
+
+ant_value_t js_mkstr_slice(ant_t *js, ant_value_t src, const char *ptr, size_t len) {
+  ant_value_t base = src;
+  if (str_is_heap_slice(src)) {
+    ant_slice_heap_t *slice = ant_str_slice_ptr(src);
+    base = vtype(slice->cached) == T_STR ? slice->cached : slice->parent;
+  }
+
+  ant_flat_string_t *root = ant_str_flat_ptr(base);
+  if (
+    !root || len < STR_SLICE_MIN_LEN ||
+    ptr < root->bytes || ptr + len > root->bytes + root->len
+  ) return js_mkstr(js, ptr, len);
+  
+  if (len == (size_t)root->len) return base;
+
+  ant_slice_heap_t *slice = (ant_slice_heap_t *)js_type_alloc(
+    js, ANT_ALLOC_ROPE, sizeof(*slice), _Alignof(ant_slice_heap_t)
+  );
+  if (!slice) return js_mkstr(js, ptr, len);
+
+  slice->len = (ant_offset_t)len;
+  slice->offset = (ant_offset_t)(ptr - root->bytes);
+  slice->utf16_len = STR_UTF16_LEN_UNKNOWN;
+  slice->parent = base;
+  slice->cached = js_mkundef();
+  slice->ascii_state = str_flat_ascii_state(root) == STR_ASCII_YES
+    ? STR_ASCII_YES : STR_ASCII_UNKNOWN;
+  slice->pending_flatten = 0;
+  
+  return ant_mkslice_value(slice);
+}
+
 static bool rope_flatten_into(ant_value_t str, char *dest, ant_offset_t total_len) {
   assert(vtype(str) == T_STR);
 
@@ -2087,8 +2182,9 @@ static bool rope_flatten_into(ant_value_t str, char *dest, ant_offset_t total_le
       }
     }
 
-    const char *src;
-    ant_offset_t len = assert_flat_string_len(current, &src);
+    ant_offset_t len = 0;
+    const char *src = str_flat_view(current, &len);
+    assert(src != NULL);
     if (len > pos) {
       if (stack != local) free(stack);
       return false;
@@ -2158,7 +2254,7 @@ static ant_value_t builder_flatten(ant_t *js, ant_value_t builder) {
   ant_value_t cached = builder_cached_flat(builder);
   GC_ROOT_PIN(js, cached);
   
-  if (vtype(cached) == T_STR && !str_is_heap_rope(cached) && !str_is_heap_builder(cached)) {
+  if (vtype(cached) == T_STR && ant_str_flat_ptr(cached)) {
     GC_ROOT_RESTORE(js, root_mark);
     return cached;
   }
@@ -2193,7 +2289,7 @@ static ant_value_t builder_flatten(ant_t *js, ant_value_t builder) {
   
   for (ant_builder_chunk_t *chunk = ptr->head; chunk; chunk = chunk->next) {
     ant_value_t chunk_value = chunk->value;
-    if (str_is_heap_rope(chunk_value) || str_is_heap_builder(chunk_value)) {
+    if (str_is_heap_rope(chunk_value) || str_is_heap_builder(chunk_value) || str_is_heap_slice(chunk_value)) {
     chunk_value = str_materialize(js, chunk_value);
     if (is_err(chunk_value)) {
       GC_ROOT_RESTORE(js, root_mark);
@@ -2229,11 +2325,12 @@ ant_value_t str_materialize(ant_t *js, ant_value_t value) {
   if (vtype(value) != T_STR) return value;
   if (str_is_heap_rope(value)) return rope_flatten(js, value);
   if (str_is_heap_builder(value)) return builder_flatten(js, value);
+  if (str_is_heap_slice(value)) return slice_flatten(js, value);
   return value;
 }
 
 ant_offset_t vstr(ant_t *js, ant_value_t value, ant_offset_t *len) {
-  if (str_is_heap_rope(value) || str_is_heap_builder(value)) {
+  if (str_is_heap_rope(value) || str_is_heap_builder(value) || str_is_heap_slice(value)) {
     ant_value_t flat = str_materialize(js, value);
     assert(!is_err(flat));
     value = flat;
@@ -2245,6 +2342,13 @@ ant_offset_t vstr(ant_t *js, ant_value_t value, ant_offset_t *len) {
   return (ant_offset_t)(uintptr_t)ptr;
 }
 
+// like vstr, but reads slices in place; only for byte-wise consumers
+static inline const char *vstr_view(ant_t *js, ant_value_t value, ant_offset_t *len) {
+  const char *view = str_flat_view(value, len);
+  if (view) return view;
+  return (const char *)(uintptr_t)vstr(js, value, len);
+}
+
 static bool strstring_has_template(const char *str, size_t slen) {
   for (const char *p = str; (p = memchr(p, '$', (size_t)(str + slen - p))); p++)
     if (p + 1 < str + slen && p[1] == '{') return true;
@@ -3206,7 +3310,7 @@ static ant_value_t mkobj_with_inobj_limit(ant_t *js, ant_offset_t parent, uint8_
 }
 
 ant_value_t mkobj(ant_t *js, ant_offset_t parent) {
-  return mkobj_with_inobj_limit(js, parent, (uint8_t)ANT_INOBJ_MAX_SLOTS);
+  return mkobj_with_inobj_limit(js, parent, (uint8_t)ANT_INOBJ_DEFAULT_SLOTS);
 }
 
 ant_value_t js_mkobj_with_inobj_limit(ant_t *js, uint8_t inobj_limit) {
@@ -3214,7 +3318,7 @@ ant_value_t js_mkobj_with_inobj_limit(ant_t *js, uint8_t inobj_limit) {
 }
 
 static ant_value_t alloc_array_with_proto(ant_t *js, ant_value_t proto) {
-  ant_object_t *obj = obj_alloc(js, T_ARR, (uint8_t)ANT_INOBJ_MAX_SLOTS);
+  ant_object_t *obj = obj_alloc(js, T_ARR, (uint8_t)ANT_INOBJ_DEFAULT_SLOTS);
   if (!obj) return js_mkerr(js, "oom");
   
   ant_value_t arr = mkval(T_ARR, (uintptr_t)obj);
@@ -3541,13 +3645,14 @@ double js_to_number(ant_t *js, ant_value_t arg) {
   if (vtype(arg) == T_BIGINT) return bigint_to_double(js, arg);
 
   if (vtype(arg) == T_STR) {
-    ant_flat_string_t *flat = ant_str_flat_ptr(arg);
+    ant_offset_t view_len = 0;
+    const char *view = str_flat_view(arg, &view_len);
     const char *base = NULL;
     const char *end = NULL;
 
-    if (flat) {
-      base = flat->bytes;
-      end = base + flat->len;
+    if (view) {
+      base = view;
+      end = base + view_len;
     } else {
       ant_offset_t len = 0;
       ant_offset_t off = vstr(js, arg, &len);
@@ -4556,6 +4661,7 @@ ant_prop_loc_t lkp_interned(ant_value_t obj, const char *search_intern) {
 }
 
 inline ant_prop_loc_t lkp(ant_t *js, ant_value_t obj, const char *buf, size_t len) {
+  js_obj_materialize(js, obj);
   const char *search_intern = intern_find(buf, len);
   if (!search_intern) return ANT_PROP_LOC_NONE;
   return lkp_interned(obj, search_intern);
@@ -4795,6 +4901,7 @@ ant_value_t js_primitive_prototype(ant_t *js, uint8_t type) {
 
 ant_prop_loc_t lkp_proto(ant_t *js, ant_value_t obj, const char *key, size_t len) {
   uint8_t t = vtype(obj);
+  js_obj_materialize(js, obj);
   const char *key_intern = intern_find(key, len);
   if (!key_intern) return ANT_PROP_LOC_NONE;
 
@@ -5034,6 +5141,7 @@ ant_offset_t str_len_fast(ant_t *js, ant_value_t str) {
   if (vtype(str) != T_STR) return 0;
   if (str_is_heap_rope(str)) return rope_len(str);
   if (str_is_heap_builder(str)) return builder_len(str);
+  if (str_is_heap_slice(str)) return slice_len(str);
   return assert_flat_string_len(str, NULL);
 }
 
@@ -5078,6 +5186,22 @@ static ant_offset_t builder_utf16_len_lazy(ant_t *js, ant_value_t value) {
   return total;
 }
 
+static ant_offset_t slice_utf16_len(ant_value_t value) {
+  ant_slice_heap_t *slice = assert_slice_ptr(value);
+  if (vtype(slice->cached) == T_STR) return flat_utf16_len(ant_str_flat_ptr(slice->cached));
+  if (slice->utf16_len != STR_UTF16_LEN_UNKNOWN) return slice->utf16_len;
+
+  ant_offset_t len = 0;
+  const char *bytes = str_flat_view(value, &len);
+  if (slice->ascii_state == STR_ASCII_UNKNOWN)
+    slice->ascii_state = str_detect_ascii_bytes(bytes, (size_t)len);
+  
+  slice->utf16_len = slice->ascii_state == STR_ASCII_YES
+    ? len : (ant_offset_t)utf16_strlen(bytes, (size_t)len);
+    
+  return slice->utf16_len;
+}
+
 typedef struct {
   ant_rope_heap_t *rope;
   ant_offset_t left_len;
@@ -5164,6 +5288,7 @@ ant_offset_t str_utf16_len(ant_t *js, ant_value_t str) {
   }
   
   if (str_is_heap_builder(str)) return builder_utf16_len_lazy(js, str);
+  if (str_is_heap_slice(str)) return slice_utf16_len(str);
   return flat_utf16_len(ant_str_flat_ptr(str));
 }
 
@@ -5196,10 +5321,8 @@ ant_value_t do_string_op(ant_t *js, uint8_t op, ant_value_t l, ant_value_t r) {
       ant_value_t flat = js_mkstr(js, NULL, (size_t)total_len);
       if (!is_err(flat)) {
         ant_flat_string_t *out = ant_str_flat_ptr(flat);
-        ant_flat_string_t *left = ant_str_flat_ptr(l);
-        ant_flat_string_t *right = ant_str_flat_ptr(r);
-        memcpy(out->bytes, left->bytes, (size_t)n1);
-        memcpy(out->bytes + n1, right->bytes, (size_t)n2);
+        memcpy(out->bytes, str_flat_view(l, NULL), (size_t)n1);
+        memcpy(out->bytes + n1, str_flat_view(r, NULL), (size_t)n2);
         out->bytes[total_len] = '\0';
         str_flat_init_meta(
           out, str_detect_ascii_bytes(out->bytes, (size_t)total_len)
@@ -5218,8 +5341,9 @@ ant_value_t do_string_op(ant_t *js, uint8_t op, ant_value_t l, ant_value_t r) {
     return js_mkrope(js, l, r, total_len, (uint16_t)new_depth);
   }
   
-  ant_offset_t n1, off1 = vstr(js, l, &n1);
-  ant_offset_t n2, off2 = vstr(js, r, &n2);
+  ant_offset_t n1, n2;
+  ant_offset_t off1 = (ant_offset_t)(uintptr_t)vstr_view(js, l, &n1);
+  ant_offset_t off2 = (ant_offset_t)(uintptr_t)vstr_view(js, r, &n2);
   
   if (op == TOK_EQ) {
     bool eq = n1 == n2 &&
@@ -5416,9 +5540,10 @@ bool strict_eq_values(ant_t *js, ant_value_t l, ant_value_t r) {
   uint8_t t = vtype(l);
   if (t != vtype(r)) return false;
   if (t == T_STR) {
-    ant_offset_t n1, n2, off1 = vstr(js, l, &n1), off2 = vstr(js, r, &n2);
-    return n1 == n2 &&
-      memcmp((const void *)(uintptr_t)off1, (const void *)(uintptr_t)off2, n1) == 0;
+    ant_offset_t n1, n2;
+    const char *p1 = vstr_view(js, l, &n1);
+    const char *p2 = vstr_view(js, r, &n2);
+    return n1 == n2 && memcmp(p1, p2, n1) == 0;
   }
   if (t == T_NUM) return tod(l) == tod(r);
   if (t == T_BIGINT) return bigint_compare(js, l, r) == 0;
@@ -5514,6 +5639,7 @@ ant_value_t js_delete_prop(ant_t *js, ant_value_t obj, const char *key, size_t l
     ant_value_t result = proxy_delete(js, obj, key, len);
     return is_err(result) ? result : js_bool(js_truthy(js, result));
   }
+  js_obj_materialize(js, obj);
 
   ant_value_t err = check_frozen_sealed(js, obj, "delete");
   if (vtype(err) != T_UNDEF) return err;
@@ -6443,7 +6569,7 @@ static ant_value_t builtin_function_bind(ant_t *js, ant_value_t *args, int nargs
   if (!bound_closure) return js_mkerr(js, "oom");
   
   bound_closure->func = orig->func;
-  bound_closure->call_flags = orig->call_flags;
+  bound_closure->call_flags = orig->call_flags & ~SV_CALL_HAS_NATIVE_STUB;
   bound_closure->upvalues = NULL;
   
   bound_closure->bound_this = 
@@ -7044,8 +7170,8 @@ typedef ant_value_t (*dynamic_kv_mapper_fn)(
 
 static ant_value_t iterate_dynamic_keys(ant_t *js, ant_value_t obj, dynamic_kv_mapper_fn mapper) {
   ant_object_t *ptr = js_obj_ptr(obj);
-  if (!ptr || !ptr->exotic_keys || !ptr->exotic_ops || !ptr->exotic_ops->getter) return mkarr(js);
-  ant_value_t keys_arr = ptr->exotic_keys(js, obj);
+  if (!ptr || !ant_object_exotic_keys(ptr) || !ptr->exotic_ops || !ptr->exotic_ops->getter) return mkarr(js);
+  ant_value_t keys_arr = ant_object_exotic_keys(ptr)(js, obj);
   ant_value_t arr = mkarr(js);
   ant_offset_t len = get_array_length(js, keys_arr);
   
@@ -7064,14 +7190,14 @@ static ant_value_t iterate_dynamic_keys(ant_t *js, ant_value_t obj, dynamic_kv_m
 bool js_copy_exotic_own_props(ant_t *js, ant_value_t dst, ant_value_t src) {
   if (!is_object_type(src) || !is_object_type(dst)) return false;
   ant_object_t *ptr = js_obj_ptr(js_as_obj(src));
-  if (!ptr || !ptr->flags.is_exotic || !ptr->exotic_keys ||
+  if (!ptr || !ptr->flags.is_exotic || !ant_object_exotic_keys(ptr) ||
       !ptr->exotic_ops || !ptr->exotic_ops->getter) return false;
 
   GC_ROOT_SAVE(root_mark, js);
   GC_ROOT_PIN(js, src);
   GC_ROOT_PIN(js, dst);
 
-  ant_value_t keys = ptr->exotic_keys(js, src);
+  ant_value_t keys = ant_object_exotic_keys(ptr)(js, src);
   GC_ROOT_PIN(js, keys);
   ant_offset_t len = get_array_length(js, keys);
 
@@ -7111,6 +7237,7 @@ static ant_value_t map_to_entry(ant_t *js, ant_value_t key, ant_value_t val) {
 }
 
 static ant_value_t object_enum(ant_t *js, ant_value_t obj, enum obj_enum_mode mode) {
+  js_obj_materialize(js, obj);
   if (vtype(obj) == T_CFUNC) {
     ant_value_t promoted = js_cfunc_lookup_promoted(js, obj);
     if (vtype(promoted) != T_FUNC) return mkarr(js);
@@ -7121,8 +7248,8 @@ static ant_value_t object_enum(ant_t *js, ant_value_t obj, enum obj_enum_mode mo
 
   ant_object_t *ptr = js_obj_ptr(obj);
   if (!ptr || !ptr->shape) return mkarr(js);
-  if (ptr->flags.is_exotic && ptr->exotic_keys) {
-    if (mode == OBJ_ENUM_KEYS) return ptr->exotic_keys(js, obj);
+  if (ptr->flags.is_exotic && ant_object_exotic_keys(ptr)) {
+    if (mode == OBJ_ENUM_KEYS) return ant_object_exotic_keys(ptr)(js, obj);
     if (ptr->exotic_ops && ptr->exotic_ops->getter) {
       dynamic_kv_mapper_fn mapper = (mode == OBJ_ENUM_ENTRIES) ? map_to_entry : NULL;
       return iterate_dynamic_keys(js, obj, mapper);
@@ -7268,6 +7395,7 @@ static inline ant_value_t js_object_view(ant_value_t v) {
 
 ant_value_t js_own_property_keys(ant_t *js, ant_value_t obj, bool include_symbols, bool enumerable_only) {
   obj = js_object_view(obj);
+  js_obj_materialize(js, obj);
   GC_ROOT_SAVE(root_mark, js);
   GC_ROOT_PIN(js, obj);
 
@@ -7304,8 +7432,8 @@ ant_value_t js_own_property_keys(ant_t *js, ant_value_t obj, bool include_symbol
   }
 
   if (!ptr || !ptr->shape) goto done;
-  if (ptr->flags.is_exotic && ptr->exotic_keys) {
-    ant_value_t keys = ptr->exotic_keys(js, obj);
+  if (ptr->flags.is_exotic && ant_object_exotic_keys(ptr)) {
+    ant_value_t keys = ant_object_exotic_keys(ptr)(js, obj);
     GC_ROOT_RESTORE(js, root_mark);
     return keys;
   }
@@ -8031,10 +8159,11 @@ static inline ant_value_t for_in_keys_collect_chain(
     ant_value_t key, r, proto;
     
     if (!cur_ptr) goto next_proto;
-    if (!cur_ptr->flags.is_exotic || !cur_ptr->exotic_keys) goto shape_props;
+    js_obj_materialize(js, as_cur);
+    if (!cur_ptr->flags.is_exotic || !ant_object_exotic_keys(cur_ptr)) goto shape_props;
 
     {
-      ant_value_t ekeys = cur_ptr->exotic_keys(js, as_cur);
+      ant_value_t ekeys = ant_object_exotic_keys(cur_ptr)(js, as_cur);
       GC_ROOT_PIN(js, ekeys);
       if (vtype(ekeys) != T_ARR) goto next_proto;
       ant_offset_t elen = js_arr_len(js, ekeys);
@@ -9304,6 +9433,7 @@ static ant_value_t object_assign_fast_ordinary_source(
 ) {
   *handled = false;
   if (vtype(source) != T_OBJ) return js_mkundef();
+  js_obj_materialize(js, source);
 
   ant_value_t source_obj = js_as_obj(source);
   ant_object_t *source_ptr = js_obj_ptr(source_obj);
@@ -9531,6 +9661,9 @@ ant_value_t builtin_object_freeze(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t as_obj = js_as_obj(obj);
   if (is_proxy(as_obj)) return proxy_set_integrity_level(js, as_obj, true);
 
+  ant_value_t filled = js_obj_materialize(js, as_obj);
+  if (is_err(filled)) return filled;
+
   ant_object_t *ptr = js_obj_ptr(as_obj);
   if (!ptr || !ptr->shape) return obj;
   if (!js_obj_ensure_unique_shape(ptr)) return js_mkerr(js, "oom");
@@ -9581,6 +9714,9 @@ static ant_value_t builtin_object_seal(ant_t *js, ant_value_t *args, int nargs)
   ant_value_t as_obj = js_as_obj(obj);
   if (is_proxy(as_obj)) return proxy_set_integrity_level(js, as_obj, false);
   
+  ant_value_t filled = js_obj_materialize(js, as_obj);
+  if (is_err(filled)) return filled;
+
   ant_object_t *ptr = js_obj_ptr(as_obj);
   if (!ptr || !ptr->shape) return obj;
   if (!js_obj_ensure_unique_shape(ptr)) return js_mkerr(js, "oom");
@@ -9764,6 +9900,7 @@ static ant_value_t builtin_object_getOwnPropertyDescriptor(ant_t *js, ant_value_
   if (is_proxy(as_obj)) {
     return proxy_get_own_property_descriptor(js, as_obj, key);
   }
+  js_obj_materialize(js, as_obj);
 
   bool is_arr_obj = array_obj_ptr(as_obj) != NULL;
   bool is_arr_length = !is_sym && is_arr_obj && is_length_key(key_str, key_len);
@@ -10065,6 +10202,9 @@ static ant_value_t builtin_object_preventExtensions(ant_t *js, ant_value_t *args
     return obj;
   }
   
+  ant_value_t filled = js_obj_materialize(js, as_obj);
+  if (is_err(filled)) return filled;
+
   ant_object_t *ptr = js_obj_ptr(as_obj);
   if (ptr) ptr->flags.extensible = 0;
   return obj;
@@ -10560,7 +10700,7 @@ static ant_value_t builtin_array_join(ant_t *js, ant_value_t *args, int nargs) {
     
     switch (vtype(elem)) {
       case T_STR:
-        if (str_is_heap_rope(elem) || str_is_heap_builder(elem)) {
+        if (str_is_heap_rope(elem) || str_is_heap_builder(elem) || str_is_heap_slice(elem)) {
           fast_primitives = false;
           continue;
         }
@@ -12765,7 +12905,7 @@ static ant_value_t builtin_Array_from(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t iter_sym = get_iterator_sym();
 
   if (vtype(src) == T_STR) {
-    if (str_is_heap_rope(src) || str_is_heap_builder(src)) {
+    if (str_is_heap_rope(src) || str_is_heap_builder(src) || str_is_heap_slice(src)) {
       src = str_materialize(js, src);
       if (is_err(src)) return src;
     }
@@ -12914,23 +13054,17 @@ static ant_value_t builtin_string_indexOf(ant_t *js, ant_value_t *args, int narg
 
   if (byte_start + search_len > (size_t)str_len) return tov(-1);
 
-  const char *p = str_ptr + byte_start;
-  const char *last = str_ptr + str_len - search_len;
+  const char *p = simd_find(
+    str_ptr + byte_start, (size_t)str_len - byte_start,
+    search_ptr, (size_t)search_len
+  );
 
-  while (p <= last) {
-    p = memchr(p, search_ptr[0], (size_t)(last - p) + 1);
-    if (!p) return tov(-1);
-    if (search_len == 1 || memcmp(p + 1, search_ptr + 1, (size_t)search_len - 1) == 0) {
-      size_t i = (size_t)(p - str_ptr);
-      return tov(D(byte_offset_to_utf16(str_ptr, i)));
-    }
-    p++;
-  }
-  return tov(-1);
+  if (!p) return tov(-1);
+  return tov(D(byte_offset_to_utf16(str_ptr, (size_t)(p - str_ptr))));
 }
 
 static ant_value_t js_mkstr_utf16_range(
-  ant_t *js, const char *str, size_t byte_len,
+  ant_t *js, ant_value_t src, const char *str, size_t byte_len,
   size_t utf16_start, size_t utf16_end
 ) {
   size_t byte_start, byte_end;
@@ -12939,7 +13073,7 @@ static ant_value_t js_mkstr_utf16_range(
   );
 
   if (!splits.prefix_surrogate && !splits.suffix_surrogate)
-    return js_mkstr(js, str + byte_start, byte_end - byte_start);
+    return js_mkstr_slice(js, src, str + byte_start, byte_end - byte_start);
 
   string_builder_t sb;
   char static_buf[64]; char encoded[4];
@@ -13031,7 +13165,7 @@ static ant_value_t builtin_string_substring(ant_t *js, ant_value_t *args, int na
     end = tmp;
   }
   
-  return js_mkstr_utf16_range(js, str_ptr, byte_len, start, end);
+  return js_mkstr_utf16_range(js, str, str_ptr, byte_len, start, end);
 }
 
 static ant_value_t builtin_string_substr(ant_t *js, ant_value_t *args, int nargs) {
@@ -13061,7 +13195,7 @@ static ant_value_t builtin_string_substr(ant_t *js, ant_value_t *args, int nargs
   }
   if (start + len > (ant_offset_t)utf16_len) len = (ant_offset_t)utf16_len - start;
   
-  return js_mkstr_utf16_range(js, str_ptr, byte_len, start, start + len);
+  return js_mkstr_utf16_range(js, str, str_ptr, byte_len, start, start + len);
 }
 
 static ant_value_t string_split_impl(ant_t *js, ant_value_t str, ant_value_t *args, int nargs) {
@@ -13170,7 +13304,7 @@ static ant_value_t string_split_impl(ant_t *js, ant_value_t str, ant_value_t *ar
       
       had_any_split = true;
 
-      ant_value_t part = js_mkstr(js, str_ptr + segment_start, match_start - segment_start);
+      ant_value_t part = js_mkstr_slice(js, str, str_ptr + segment_start, match_start - segment_start);
       arr_set(js, arr, idx, part);
       idx++;
 
@@ -13180,7 +13314,7 @@ static ant_value_t string_split_impl(ant_t *js, ant_value_t str, ant_value_t *ar
         if (cap_start == PCRE2_UNSET) {
           arr_set(js, arr, idx, js_mkundef());
         } else {
-          part = js_mkstr(js, str_ptr + cap_start, cap_end - cap_start);
+          part = js_mkstr_slice(js, str, str_ptr + cap_start, cap_end - cap_start);
           arr_set(js, arr, idx, part);
         }
         idx++;
@@ -13203,7 +13337,7 @@ static ant_value_t string_split_impl(ant_t *js, ant_value_t str, ant_value_t *ar
     }
 
     if (idx < limit) {
-      ant_value_t part = js_mkstr(js, str_ptr + segment_start, str_len - segment_start);
+      ant_value_t part = js_mkstr_slice(js, str, str_ptr + segment_start, str_len - segment_start);
       arr_set(js, arr, idx, part);
       idx++;
     }
@@ -13229,16 +13363,20 @@ split_string_separator:;
     return mkval(T_ARR, vdata(arr));
   }
 
-  for (ant_offset_t i = 0; i + sep_len <= str_len && idx < limit; i++) {
-    if (memcmp(str_ptr + i, sep_ptr, sep_len) != 0) continue;
-    ant_value_t part = js_mkstr(js, str_ptr + start, i - start);
+  while (idx < limit) {
+    const char *hit = simd_find(
+      str_ptr + start, (size_t)(str_len - start),
+      sep_ptr, (size_t)sep_len
+    );
+    if (!hit) break;
+    ant_offset_t i = (ant_offset_t)(hit - str_ptr);
+    ant_value_t part = js_mkstr_slice(js, str, str_ptr + start, i - start);
     arr_set(js, arr, idx, part);
     idx++;
     start = i + sep_len;
-    i += sep_len - 1;
   }
   if (idx < limit && start <= str_len) {
-    ant_value_t part = js_mkstr(js, str_ptr + start, str_len - start);
+    ant_value_t part = js_mkstr_slice(js, str, str_ptr + start, str_len - start);
     arr_set(js, arr, idx, part);
     idx++;
   }
@@ -13301,7 +13439,7 @@ static ant_value_t builtin_string_slice(ant_t *js, ant_value_t *args, int nargs)
   }
   
   if (start > end) start = end;
-  return js_mkstr_utf16_range(js, str_ptr, byte_len, start, end);
+  return js_mkstr_utf16_range(js, str, str_ptr, byte_len, start, end);
 }
 
 static ant_value_t builtin_string_includes(ant_t *js, ant_value_t *args, int nargs) {
@@ -13332,11 +13470,11 @@ static ant_value_t builtin_string_includes(ant_t *js, ant_value_t *args, int nar
   
   if (search_len == 0) return mkval(T_BOOL, 1);
   if (start + search_len > str_len) return mkval(T_BOOL, 0);
-  for (ant_offset_t i = start; i <= str_len - search_len; i++) {
-    if (memcmp(str_ptr + i, search_ptr, search_len) == 0) return mkval(T_BOOL, 1);
-  }
   
-  return mkval(T_BOOL, 0);
+  return mkval(T_BOOL, simd_find(
+    str_ptr + start, (size_t)(str_len - start),
+    search_ptr, (size_t)search_len
+  ) ? 1 : 0);
 }
 
 static inline ant_offset_t string_clamped_position(ant_t *js, ant_value_t value, ant_offset_t len) {
@@ -17773,15 +17911,20 @@ static ant_t *isolate_init(void *buf, size_t len) {
   js->rope_gc.old.block_size = ANT_POOL_ROPE_BLOCK_SIZE;
   js->gc_use_nursery_major_floor = true;
   
-  if (!fixed_arena_init(&js->obj_arena, sizeof(ant_object_t), offsetof(ant_object_t, mark_epoch), ANT_ARENA_MAX)) return NULL;
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) {
+    if (fixed_arena_init(&js->obj_arenas[i], ant_object_class_size(i), offsetof(ant_object_t, mark_epoch), ANT_ARENA_MAX >> i)) continue;
+    while (i-- > 0) fixed_arena_destroy(&js->obj_arenas[i]);
+    return NULL;
+  }
+  
   if (!fixed_arena_init(&js->closure_arena, sizeof(sv_closure_t), offsetof(sv_closure_t, gc_epoch), ANT_CLOSURE_ARENA_MAX)) {
-    fixed_arena_destroy(&js->obj_arena);
+    js_obj_arenas_destroy(js);
     return NULL;
   }
   
   if (!fixed_arena_init(&js->upvalue_arena, sizeof(sv_upvalue_t), offsetof(sv_upvalue_t, gc_epoch), ANT_CLOSURE_ARENA_MAX)) {
     fixed_arena_destroy(&js->closure_arena);
-    fixed_arena_destroy(&js->obj_arena);
+    js_obj_arenas_destroy(js);
     return NULL;
   }
 
@@ -17792,7 +17935,7 @@ static ant_t *isolate_init(void *buf, size_t len) {
   if (!js->c_roots) {
     fixed_arena_destroy(&js->upvalue_arena);
     fixed_arena_destroy(&js->closure_arena);
-    fixed_arena_destroy(&js->obj_arena);
+    js_obj_arenas_destroy(js);
     return NULL;
   }
 
@@ -18339,6 +18482,7 @@ void js_destroy(ant_t *js) {
   code_arena_reset();
   cleanup_rpc_module();
   cleanup_lmdb_module();
+  cleanup_json_module();
 
   ant_object_t *lists[] = { js->objects, js->objects_old, js->permanent_objects };
   for (int i = 0; i < 3; i++) for (ant_object_t *obj = lists[i]; obj;) {
@@ -18356,7 +18500,7 @@ void js_destroy(ant_t *js) {
   cleanup_events_module(js);
   cleanup_regex_module(js);
 
-  fixed_arena_destroy(&js->obj_arena);
+  js_obj_arenas_destroy(js);
   fixed_arena_destroy(&js->closure_arena);
   fixed_arena_destroy(&js->upvalue_arena);
   
@@ -18379,6 +18523,10 @@ void js_destroy(ant_t *js) {
   free(js->rope_gc.remembered_builders);
   js->rope_gc.remembered_builders = NULL;
   js->rope_gc.remembered_builder_len = js->rope_gc.remembered_builder_cap = 0;
+  
+  free(js->rope_gc.wasteful_slices);
+  js->rope_gc.wasteful_slices = NULL;
+  js->rope_gc.wasteful_slice_len = js->rope_gc.wasteful_slice_cap = 0;
 
   free(js->rope_gc.marks);
   js->rope_gc.marks = NULL;
@@ -19400,7 +19548,9 @@ static inline js_eval_result_t js_eval_bytecode_mode_result(
   if (len == (size_t)~0U) len = strlen(buf);
 
   code_arena_mark_t parse_mark = parse_arena_mark();
-  sv_ast_t *program = sv_parse(js, buf, (ant_offset_t)len, parse_strict);
+  sv_ast_t *program = (mode == SV_COMPILE_SCRIPT || mode == SV_COMPILE_MODULE)
+    ? sv_parse_lazy(js, buf, (ant_offset_t)len, parse_strict)
+    : sv_parse(js, buf, (ant_offset_t)len, parse_strict);
 
   if (!program) {
     parse_arena_rewind(parse_mark);
@@ -19559,6 +19709,7 @@ ant_iter_t js_prop_iter_begin(ant_t *js, ant_value_t obj) {
   ant_iter_t iter = {.ctx = NULL, .off = 0};
   uint8_t t = vtype(obj);
   if (t != T_OBJ && t != T_ARR && t != T_FUNC) return iter;
+  js_obj_materialize(js, obj);
 
   prop_iter_ctx_t *ctx = calloc(1, sizeof(*ctx));
   if (!ctx) return iter;
@@ -19721,7 +19872,30 @@ void js_set_finalizer(ant_value_t obj, js_finalizer_fn fn) {
   if (vtype(obj) != T_OBJ) obj = js_as_obj(obj);
   ant_object_t *ptr = js_obj_ptr(obj);
   if (!ptr) return;
-  ptr->finalizer = fn;
+  ant_object_sidecar_t *sidecar = ant_object_ensure_sidecar(ptr);
+  if (sidecar) sidecar->finalizer = fn;
+}
+
+void js_set_materializer(ant_value_t obj, js_materializer_fn fn) {
+  if (!is_object_type(obj)) return;
+  if (vtype(obj) != T_OBJ) obj = js_as_obj(obj);
+  ant_object_t *ptr = js_obj_ptr(obj);
+  if (!ptr) return;
+  ant_exotic_ops_t *ops = obj_ensure_exotic_ops(ptr);
+  if (!ops) return;
+  ptr->flags.is_exotic = 1;
+  ops->materialize = fn;
+}
+
+void js_clear_materializer(ant_value_t obj) {
+  ant_object_t *ptr = js_obj_ptr(obj);
+  if (!ptr || !ptr->exotic_ops) return;
+  ant_exotic_ops_t *ops = (ant_exotic_ops_t *)(void *)ptr->exotic_ops;
+  ops->materialize = NULL;
+  if (ops->getter || ops->setter || ops->deleter) return;
+  free(ops);
+  ptr->exotic_ops = NULL;
+  if (!ant_object_exotic_keys(ptr)) ptr->flags.is_exotic = 0;
 }
 
 void js_set_keys(ant_value_t obj, js_keys_fn keys) {
@@ -19729,6 +19903,8 @@ void js_set_keys(ant_value_t obj, js_keys_fn keys) {
   if (vtype(obj) != T_OBJ) obj = js_as_obj(obj);
   ant_object_t *ptr = js_obj_ptr(obj);
   if (!ptr) return;
+  ant_object_sidecar_t *sidecar = ant_object_ensure_sidecar(ptr);
+  if (!sidecar) return;
   ptr->flags.is_exotic = 1;
-  ptr->exotic_keys = keys;
+  sidecar->exotic_keys = keys;
 }
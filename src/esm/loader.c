@@ -8,6 +8,8 @@
 #include "esm/builtin_bundle.h"
 #include "loader_cache.h"
 #include "loader_internal.h"
+#include "loader_prefetch.h"
+#include "resolve_index.h"
 
 #include "modules/json.h"
 #include "modules/napi.h"
@@ -267,6 +269,7 @@ char *esm_make_absolute_path(const char *path) {
 }
 
 static bool esm_lstat_path(const char *path, struct stat *st) {
+  esm_resolve_index_note_path(path);
 #ifdef _WIN32
   return stat(path, st) == 0;
 #else
@@ -282,6 +285,7 @@ static char *esm_resolve_existing_regular_path(const char *path) {
   if (S_ISLNK(st.st_mode)) {
     char *resolved = realpath(path, NULL);
     if (!resolved) return NULL;
+    esm_resolve_index_note_path(resolved);
     if (stat(resolved, &st) == 0 && S_ISREG(st.st_mode)) return resolved;
     free(resolved);
     return NULL;
@@ -299,6 +303,7 @@ static char *esm_resolve_existing_directory_path(const char *path) {
   if (S_ISLNK(st.st_mode)) {
     char *resolved = realpath(path, NULL);
     if (!resolved) return NULL;
+    esm_resolve_index_note_path(resolved);
     if (stat(resolved, &st) == 0 && S_ISDIR(st.st_mode)) return resolved;
     free(resolved);
     return NULL;
@@ -584,6 +589,7 @@ static char *esm_get_base_dir(ant_t *js, const char *base_path) {
 
   char *resolved = realpath(candidate, NULL);
   const char *resolved_or_candidate = resolved ? resolved : candidate;
+  esm_resolve_index_note_path(resolved_or_candidate);
 
   struct stat st;
   if (stat(resolved_or_candidate, &st) == 0 && S_ISDIR(st.st_mode)) {
@@ -1096,6 +1102,13 @@ static char *esm_resolve_path_cond(ant_t *js, const char *specifier, const char
     return cached;
   }
 
+  cached = esm_resolve_index_get(js, key);
+  if (cached) {
+    esm_resolve_cache_put(js, key, cached);
+    free(key);
+    return cached;
+  }
+
   char *resolved = esm_resolve_path_cond_uncached(js, specifier, base_path, prefer_require);
   if (!resolved) {
     free(key);
@@ -1103,6 +1116,7 @@ static char *esm_resolve_path_cond(ant_t *js, const char *specifier, const char
   }
 
   esm_resolve_cache_put(js, key, resolved);
+  esm_resolve_index_put(js, key, resolved);
   free(key);
 
   return resolved;
@@ -1112,6 +1126,10 @@ char *esm_resolve_path(ant_t *js, const char *specifier, const char *base_path)
   return esm_resolve_path_cond(js, specifier, base_path, false);
 }
 
+char *esm_resolve_path_offthread(const char *specifier, const char *base_path) {
+  return esm_resolve_path_cond_uncached(NULL, specifier, base_path, false);
+}
+
 char *esm_resolve_path_require(ant_t *js, const char *specifier, const char *base_path) {
   return esm_resolve_path_cond(js, specifier, base_path, true);
 }
@@ -1216,7 +1234,7 @@ static ant_value_t esm_eval_ambiguous_js_source(
   ant_value_t saved_thrown_value = js->thrown_value;
   ant_value_t saved_thrown_stack = js->thrown_stack;
   code_arena_mark_t parse_mark = parse_arena_mark();
-  sv_ast_t *program = sv_parse(js, js_code, (ant_offset_t)js_len, false);
+  sv_ast_t *program = sv_parse_lazy(js, js_code, (ant_offset_t)js_len, false);
 
   if (!program) {
     parse_arena_rewind(parse_mark);
@@ -1395,6 +1413,10 @@ static esm_module_t *esm_create_module(
   return mod;
 }
 
+void js_esm_flush_resolve_index(ant_t *js) {
+  esm_resolve_index_flush(js);
+}
+
 void js_esm_cleanup_module_cache(ant_t *js) {
   ant_esm_state_t *st = js ? js->esm.state : NULL;
   if (st) {
@@ -1412,29 +1434,41 @@ void js_esm_cleanup_module_cache(ant_t *js) {
     st->last_tla_module = NULL;
   }
 
+  esm_prefetch_cleanup(js);
+  esm_resolve_index_flush(js);
   esm_loader_cache_cleanup(js);
 }
 
-ant_value_t esm_read_file(ant_t *js, const char *path, const char *kind, esm_file_data_t *out) {
+esm_read_status_t esm_read_file_bytes(const char *path, esm_file_data_t *out) {
   FILE *fp = fopen(path, "rb");
-  if (!fp) return js_mkerr(js, "Cannot open %s: %s", kind, path);
+  if (!fp) return ESM_READ_OPEN_FAILED;
 
   fseek(fp, 0, SEEK_END);
   long fsize = ftell(fp);
   fseek(fp, 0, SEEK_SET);
+  if (fsize < 0) fsize = 0;
 
   char *buf = (char *)malloc((size_t)fsize + 1);
   if (!buf) {
     fclose(fp);
-    return js_mkerr(js, "OOM loading %s", kind);
+    return ESM_READ_OOM;
   }
 
-  fread(buf, 1, (size_t)fsize, fp);
+  size_t nread = fread(buf, 1, (size_t)fsize, fp);
   fclose(fp);
-  buf[fsize] = '\0';
+  buf[nread] = '\0';
 
   out->data = buf;
-  out->size = (size_t)fsize;
+  out->size = nread;
+  return ESM_READ_OK;
+}
+
+ant_value_t esm_read_file(ant_t *js, const char *path, const char *kind, esm_file_data_t *out) {
+  switch (esm_read_file_bytes(path, out)) {
+    case ESM_READ_OPEN_FAILED: return js_mkerr(js, "Cannot open %s: %s", kind, path);
+    case ESM_READ_OOM:         return js_mkerr(js, "OOM loading %s", kind);
+    case ESM_READ_OK:          break;
+  }
   return js_mkundef();
 }
 
@@ -1531,7 +1565,7 @@ static ant_value_t esm_parse_module_record(
   ant_value_t saved_thrown_value = js->thrown_value;
   ant_value_t saved_thrown_stack = js->thrown_stack;
 
-  sv_ast_t *program = sv_parse(js, js_code, (ant_offset_t)js_len, false);
+  sv_ast_t *program = sv_parse_lazy(js, js_code, (ant_offset_t)js_len, false);
   if (!program) {
     if (*format == MODULE_EVAL_FORMAT_UNKNOWN) {
       js->thrown_exists = saved_thrown_exists;
@@ -1675,6 +1709,35 @@ static ant_value_t esm_load_static_dependency(
   return result;
 }
 
+static void esm_prefetch_static_dependency(ant_t *js, esm_module_t *parent, sv_ast_t *spec) {
+  if (!spec || spec->type != N_STRING || !spec->str) return;
+
+  char *specifier = strndup(spec->str, spec->len);
+  if (!specifier) return;
+
+  char *file_url_path = esm_file_url_to_path(js, specifier);
+  if (file_url_path) {
+    free(specifier);
+    specifier = file_url_path;
+  }
+
+  if (esm_lookup_builtin_alias(specifier, strlen(specifier))) {
+    free(specifier);
+    return;
+  }
+
+  char *resolved_path = esm_resolve(js, specifier, parent->resolved_path, esm_resolve_path);
+  free(specifier);
+  if (!resolved_path) return;
+
+  esm_module_t *dep = esm_find_module(js, resolved_path);
+  bool wanted = (!dep || (!dep->is_loaded && !dep->is_loading && !dep->embedded_code))
+    && esm_classify_module_kind(resolved_path) == ESM_MODULE_KIND_CODE;
+
+  if (wanted) esm_prefetch_source(js, parent, resolved_path);
+  free(resolved_path);
+}
+
 static ant_value_t esm_instantiate_static_dependencies(
   ant_t *js,
   esm_module_t *mod,
@@ -1685,14 +1748,32 @@ static ant_value_t esm_instantiate_static_dependencies(
 
   esm_predeclare_exports(js, program, ns);
 
+  // resolve every static import up front and hand the reads and TypeScript
+  // stripping to the threadpool, whose workers follow each file's own
+  // imports in turn; the loop below links them depth-first and picks the
+  // sources up as it reaches each one
+  if (!esm_hooks_present(js) && !js_esm_bundle_active(js)) {
+    for (int i = 0; i < program->args.count; i++) {
+      sv_ast_t *spec = NULL;
+      if (esm_static_dependency_specifier(program->args.items[i], &spec))
+        esm_prefetch_static_dependency(js, mod, spec);
+    }
+  }
+
   for (int i = 0; i < program->args.count; i++) {
     sv_ast_t *spec = NULL;
     if (!esm_static_dependency_specifier(program->args.items[i], &spec)) continue;
 
     ant_value_t dep = esm_load_static_dependency(js, mod, spec);
-    if (is_err(dep)) return dep;
+    if (is_err(dep)) {
+      esm_prefetch_release(js, mod);
+      return dep;
+    }
   }
 
+  // whatever is still queued was already loaded some other way by the time
+  // the loop got to it, so nobody is going to take it
+  esm_prefetch_release(js, mod);
   return js_mkundef();
 }
 
@@ -1734,6 +1815,8 @@ static ant_value_t esm_load_module(ant_t *js, esm_module_t *mod) {
 
   char *content = NULL;
   size_t size = 0;
+  esm_prefetched_source_t prefetched = {0};
+  bool have_prefetched = false;
 
   if (mod->embedded_code) {
     content = (char *)malloc(mod->embedded_code_len + 1);
@@ -1765,6 +1848,10 @@ static ant_value_t esm_load_module(ant_t *js, esm_module_t *mod) {
       mod->url_content = strdup(content);
       mod->url_content_len = size;
     }
+  } else if (esm_prefetch_take(js, mod->resolved_path, &prefetched)) {
+    content = prefetched.content;
+    size = prefetched.size;
+    have_prefetched = true;
   } else {
     esm_file_data_t file;
     ant_value_t err = esm_read_file(js, mod->resolved_path, "module", &file);
@@ -1775,13 +1862,17 @@ static ant_value_t esm_load_module(ant_t *js, esm_module_t *mod) {
     content = file.data;
     size = file.size;
   }
-  content[size] = '\0';
+  if (!have_prefetched) content[size] = '\0';
 
   size_t js_len = size;
   const char *strip_detail = NULL;
 
   if (!mod->embedded_code) {
-  int strip_result = strip_typescript_inplace(
+  int strip_result = have_prefetched ? prefetched.strip_result : 0;
+  if (have_prefetched) {
+    js_len = prefetched.js_len;
+    strip_detail = prefetched.strip_detail;
+  } else strip_result = strip_typescript_inplace(
     &content, size, mod->resolved_path, 
     &js_len, &strip_detail
   );
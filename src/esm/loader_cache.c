@@ -1,5 +1,6 @@
 #include <compat.h> // IWYU pragma: keep
 #include "loader_cache.h"
+#include "resolve_index.h"
 
 #include "internal.h"
 
@@ -48,6 +49,8 @@ ant_esm_state_t *esm_state(ant_t *js) {
   if (!st) return NULL;
 
   js->esm.state = st;
+  esm_resolve_index_open(js);
+
   return st;
 }
 
@@ -262,6 +265,7 @@ yyjson_doc *esm_package_json_cache_read(ant_t *js, const char *pkg_json_path, bo
     return yyjson_read_file(pkg_json_path, 0, NULL, NULL);
   }
 
+  esm_resolve_index_note_package_json(pkg_json_path);
   entry->doc = yyjson_read_file(pkg_json_path, 0, NULL, NULL);
   HASH_ADD_STR(st->package_json_cache, path, entry);
 
@@ -46,6 +46,12 @@ typedef struct {
   size_t size;
 } esm_file_data_t;
 
+typedef enum {
+  ESM_READ_OK = 0,
+  ESM_READ_OPEN_FAILED,
+  ESM_READ_OOM,
+} esm_read_status_t;
+
 bool esm_hooks_present(ant_t *js);
 bool esm_is_json(const char *path);
 
@@ -57,10 +63,16 @@ char *esm_file_url_to_path(ant_t *js, const char *specifier);
 char *esm_resolve_path(ant_t *js, const char *specifier, const char *base_path);
 char *esm_resolve_path_require(ant_t *js, const char *specifier, const char *base_path);
 
+// import resolution without an ant_t: no caches, no bundle and no custom
+// conditions, so a threadpool worker can call it
+char *esm_resolve_path_offthread(const char *specifier, const char *base_path);
+
 ant_module_format_t esm_decide_module_format(ant_t *js, const char *resolved_path);
 esm_module_kind_t esm_classify_kind_for_path(const char *resolved_path);
 esm_module_t *esm_find_module(ant_t *js, const char *module_key);
 
+esm_read_status_t esm_read_file_bytes(const char *path, esm_file_data_t *out);
+
 ant_value_t esm_read_file(
   ant_t *js,
   const char *path,
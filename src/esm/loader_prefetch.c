@@ -0,0 +1,568 @@
+#include <compat.h> // IWYU pragma: keep
+#include "loader_prefetch.h"
+#include "loader_cache.h"
+#include "loader_internal.h"
+
+#include "esm/builtin_bundle.h"
+#include "esm/remote.h"
+#include "internal.h"
+#include "utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <uthash.h>
+#include <uv.h>
+
+typedef struct esm_prefetch_job {
+  char *path;
+  const void *owner;
+  struct esm_prefetch_job *next_pending;
+
+  esm_prefetched_source_t src;
+  esm_read_status_t read_status;
+
+  // held by the table, the pending queue and whoever takes the job out of
+  // the table; the pending queue's reference passes to the thread running it
+  int refs;
+  bool claimed;
+  bool done;
+  bool taken;
+  bool dropped;
+
+  UT_hash_handle hh;
+} esm_prefetch_job_t;
+
+typedef struct esm_prefetch_seen {
+  char *path;
+  UT_hash_handle hh;
+} esm_prefetch_seen_t;
+
+// shared with the threadpool and guarded by `lock`. The isolate holds one
+// reference and every queued drain request another, so a worker that is
+// still busy at teardown finishes against live memory
+typedef struct esm_prefetch_set {
+  uv_mutex_t lock;
+  uv_cond_t ready;
+
+  esm_prefetch_job_t *jobs;
+  esm_prefetch_job_t *pending_head;
+  esm_prefetch_job_t *pending_tail;
+  esm_prefetch_seen_t *seen;
+
+  int refs;
+  bool closed;
+} esm_prefetch_set_t;
+
+typedef struct {
+  uv_work_t req;
+  esm_prefetch_set_t *set;
+} esm_prefetch_drain_t;
+
+typedef struct {
+  char **items;
+  int count;
+  int cap;
+} esm_prefetch_paths_t;
+
+typedef struct {
+  const char *src;
+  size_t len;
+  size_t pos;
+} esm_scan_t;
+
+static bool esm_scan_is_ident(unsigned char c) {
+  return
+    (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+    (c >= '0' && c <= '9') || c == '_' || c == '$' || c >= 0x80;
+}
+
+static bool esm_scan_word_is(const esm_scan_t *s, size_t start, const char *word) {
+  size_t n = strlen(word);
+  return s->pos - start == n && memcmp(s->src + start, word, n) == 0;
+}
+
+static bool esm_scan_skip_space(esm_scan_t *s) {
+  while (s->pos < s->len) {
+    char c = s->src[s->pos];
+    char next = s->pos + 1 < s->len ? s->src[s->pos + 1] : '\0';
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
+      s->pos++;
+    } else if (c == '/' && next == '/') {
+      while (s->pos < s->len && s->src[s->pos] != '\n') s->pos++;
+    } else if (c == '/' && next == '*') {
+      s->pos += 2;
+      while (s->pos + 1 < s->len && !(s->src[s->pos] == '*' && s->src[s->pos + 1] == '/')) s->pos++;
+      s->pos = s->pos + 1 < s->len ? s->pos + 2 : s->len;
+    } else return true;
+  }
+  return false;
+}
+
+static void esm_scan_skip_ident(esm_scan_t *s) {
+  while (s->pos < s->len && esm_scan_is_ident((unsigned char)s->src[s->pos])) s->pos++;
+}
+
+// true when the literal ended at its closing quote
+static bool esm_scan_skip_quoted(esm_scan_t *s) {
+  char quote = s->src[s->pos++];
+  while (s->pos < s->len) {
+    char c = s->src[s->pos];
+    if (c == '\\') { s->pos += 2; continue; }
+    s->pos++;
+    if (c == quote) return true;
+    if (c == '\n') return false;
+  }
+  return false;
+}
+
+static void esm_scan_skip_template(esm_scan_t *s) {
+  s->pos++;
+  while (s->pos < s->len) {
+    char c = s->src[s->pos];
+    if (c == '\\') { s->pos += 2; continue; }
+    if (c == '`') { s->pos++; return; }
+    if (c == '$' && s->pos + 1 < s->len && s->src[s->pos + 1] == '{') {
+      int depth = 1;
+      s->pos += 2;
+      while (depth > 0 && esm_scan_skip_space(s)) {
+        c = s->src[s->pos];
+        if (c == '\'' || c == '"') esm_scan_skip_quoted(s);
+        else if (c == '`') esm_scan_skip_template(s);
+        else {
+          if (c == '{') depth++;
+          else if (c == '}') depth--;
+          s->pos++;
+        }
+      }
+      continue;
+    }
+    s->pos++;
+  }
+}
+
+static void esm_scan_skip_regex(esm_scan_t *s) {
+  bool in_class = false;
+  s->pos++;
+  while (s->pos < s->len) {
+    char c = s->src[s->pos];
+    if (c == '\\') { s->pos += 2; continue; }
+    if (c == '\n') return;
+    s->pos++;
+    if (c == '[') in_class = true;
+    else if (c == ']') in_class = false;
+    else if (c == '/' && !in_class) break;
+  }
+  esm_scan_skip_ident(s);
+}
+
+// a '/' after one of these starts a regular expression, anywhere else it
+// divides; wrong guesses only cost a prefetch, never correctness
+static bool esm_scan_regex_allowed(char prev) {
+  return prev == '\0' || strchr("(,=:[!&|?{};+-*%<>~^", prev) != NULL;
+}
+
+static bool esm_scan_keyword_before_expr(const esm_scan_t *s, size_t start) {
+  static const char *const words[] = {
+    "return", "typeof", "case", "do", "else", "in", "of", "new",
+    "delete", "void", "throw", "instanceof", "yield", "await", NULL
+  };
+  for (const char *const *w = words; *w; w++)
+    if (esm_scan_word_is(s, start, *w)) return true;
+  return false;
+}
+
+static void esm_prefetch_paths_push(esm_prefetch_paths_t *paths, char *path) {
+  if (paths->count == paths->cap) {
+    int cap = paths->cap ? paths->cap * 2 : 8;
+    char **items = realloc(paths->items, (size_t)cap * sizeof(*items));
+    if (!items) { free(path); return; }
+    paths->items = items;
+    paths->cap = cap;
+  }
+  paths->items[paths->count++] = path;
+}
+
+static void esm_prefetch_resolve_into(
+  esm_prefetch_paths_t *out, const char *parent_path,
+  const char *spec, size_t spec_len
+) {
+  if (spec_len == 0 || spec_len >= PATH_MAX || memchr(spec, '\\', spec_len)) return;
+
+  char specifier[PATH_MAX];
+  memcpy(specifier, spec, spec_len);
+  specifier[spec_len] = '\0';
+
+  if (esm_has_builtin_scheme(specifier) || esm_lookup_builtin_alias(specifier, spec_len)) return;
+  if (esm_is_url(specifier) || esm_is_data_url(specifier) || strncmp(specifier, "file:", 5) == 0) return;
+
+  char *resolved = esm_resolve_path_offthread(specifier, parent_path);
+  if (!resolved) return;
+  if (esm_classify_kind_for_path(resolved) != ESM_MODULE_KIND_CODE) free(resolved);
+  else esm_prefetch_paths_push(out, resolved);
+}
+
+// reads the clause after a top-level `import` or `export` up to its `from`
+// string; declarations and dynamic import() fall out at their first token
+static void esm_scan_module_clause(esm_scan_t *s, esm_prefetch_paths_t *out, const char *parent_path, bool is_import) {
+  bool brace_ok = true;
+
+  for (int tokens = 0; tokens < 64 && esm_scan_skip_space(s); tokens++) {
+    char c = s->src[s->pos];
+
+    if (c == '\'' || c == '"') {
+      if (!is_import || tokens > 0) return;
+      size_t start = s->pos + 1;
+      if (esm_scan_skip_quoted(s))
+        esm_prefetch_resolve_into(out, parent_path, s->src + start, s->pos - start - 1);
+      return;
+    }
+
+    if (c == '{' && brace_ok) {
+      while (s->pos < s->len && s->src[s->pos] != '}') {
+        if (s->src[s->pos] == '\'' || s->src[s->pos] == '"') esm_scan_skip_quoted(s);
+        else s->pos++;
+      }
+      if (s->pos >= s->len) return;
+      s->pos++;
+      brace_ok = false;
+      continue;
+    }
+
+    if (c == ',' || c == '*') {
+      s->pos++;
+      brace_ok = c == ',';
+      continue;
+    }
+
+    if (!esm_scan_is_ident((unsigned char)c)) return;
+    size_t start = s->pos;
+    esm_scan_skip_ident(s);
+
+    if (esm_scan_word_is(s, start, "from")) {
+      if (!esm_scan_skip_space(s)) return;
+      char q = s->src[s->pos];
+      if (q != '\'' && q != '"') return;
+      size_t spec_start = s->pos + 1;
+      if (esm_scan_skip_quoted(s))
+        esm_prefetch_resolve_into(out, parent_path, s->src + spec_start, s->pos - spec_start - 1);
+      return;
+    }
+
+    brace_ok = esm_scan_word_is(s, start, "type");
+  }
+}
+
+// pulls the static import and re-export specifiers out of a stripped module
+// without a parse, so the worker that read it can queue its dependencies
+static void esm_prefetch_scan_imports(const char *src, size_t len, const char *path, esm_prefetch_paths_t *out) {
+  esm_scan_t s = { .src = src, .len = len, .pos = 0 };
+  int depth = 0;
+  char prev = '\0';
+
+  while (esm_scan_skip_space(&s)) {
+    char c = src[s.pos];
+
+    if (c == '\'' || c == '"') {
+      esm_scan_skip_quoted(&s);
+      prev = 'a';
+    } else if (c == '`') {
+      esm_scan_skip_template(&s);
+      prev = 'a';
+    } else if (c == '/' && esm_scan_regex_allowed(prev)) {
+      esm_scan_skip_regex(&s);
+      prev = 'a';
+    } else if (esm_scan_is_ident((unsigned char)c)) {
+      size_t start = s.pos;
+      esm_scan_skip_ident(&s);
+      bool is_import = esm_scan_word_is(&s, start, "import");
+      if (depth == 0 && prev != '.' && (is_import || esm_scan_word_is(&s, start, "export"))) {
+        size_t after = s.pos;
+        if (esm_scan_skip_space(&s) && (src[s.pos] == '(' || src[s.pos] == '.')) s.pos = after;
+        else esm_scan_module_clause(&s, out, path, is_import);
+        prev = 'a';
+      } else prev = esm_scan_keyword_before_expr(&s, start) ? '(' : 'a';
+    } else {
+      if (c == '{') depth++;
+      else if (c == '}' && depth > 0) depth--;
+      s.pos++;
+      prev = c;
+    }
+  }
+}
+
+static void esm_prefetch_job_unref(esm_prefetch_job_t *job) {
+  if (--job->refs > 0) return;
+  if (!job->taken) free(job->src.content);
+  free(job->path);
+  free(job);
+}
+
+static bool esm_prefetch_mark_seen(esm_prefetch_set_t *set, const char *path) {
+  esm_prefetch_seen_t *seen = NULL;
+  HASH_FIND_STR(set->seen, path, seen);
+  if (seen) return false;
+
+  seen = (esm_prefetch_seen_t *)calloc(1, sizeof(*seen));
+  if (!seen) return false;
+  seen->path = strdup(path);
+  if (!seen->path) {
+    free(seen);
+    return false;
+  }
+
+  HASH_ADD_KEYPTR(hh, set->seen, seen->path, strlen(seen->path), seen);
+  return true;
+}
+
+static esm_prefetch_job_t *esm_prefetch_add_job(esm_prefetch_set_t *set, const void *owner, const char *path) {
+  esm_prefetch_job_t *job = (esm_prefetch_job_t *)calloc(1, sizeof(*job));
+  if (!job) return NULL;
+
+  job->path = strdup(path);
+  if (!job->path) {
+    free(job);
+    return NULL;
+  }
+
+  job->owner = owner;
+  job->refs = 2;
+  HASH_ADD_KEYPTR(hh, set->jobs, job->path, strlen(job->path), job);
+
+  if (set->pending_tail) set->pending_tail->next_pending = job;
+  else set->pending_head = job;
+  set->pending_tail = job;
+
+  return job;
+}
+
+static esm_prefetch_job_t *esm_prefetch_claim_next(esm_prefetch_set_t *set) {
+  esm_prefetch_job_t *job;
+  while ((job = set->pending_head)) {
+    set->pending_head = job->next_pending;
+    if (!set->pending_head) set->pending_tail = NULL;
+    job->next_pending = NULL;
+
+    if (!job->claimed) {
+      job->claimed = true;
+      return job;
+    }
+    esm_prefetch_job_unref(job);
+  }
+  return NULL;
+}
+
+// reads and strips one module, then queues whatever it imports that nobody
+// has asked for yet under the same owner; returns how many it queued
+static int esm_prefetch_run(esm_prefetch_set_t *set, esm_prefetch_job_t *job) {
+  esm_file_data_t file = {0};
+  esm_prefetched_source_t src = {0};
+  esm_prefetch_paths_t deps = {0};
+  esm_read_status_t status = esm_read_file_bytes(job->path, &file);
+
+  if (status == ESM_READ_OK) {
+    src.content = file.data;
+    src.size = file.size;
+    src.strip_result = strip_typescript_inplace(
+      &src.content, src.size, job->path,
+      &src.js_len, &src.strip_detail
+    );
+    if (src.strip_result >= 0) esm_prefetch_scan_imports(src.content, src.js_len, job->path, &deps);
+  }
+
+  int queued = 0;
+  uv_mutex_lock(&set->lock);
+  job->src = src;
+  job->read_status = status;
+  job->done = true;
+
+  for (int i = 0; i < deps.count; i++) {
+    const char *path = deps.items[i];
+    esm_prefetch_job_t *existing = NULL;
+    HASH_FIND_STR(set->jobs, path, existing);
+    bool wanted = !set->closed && !job->dropped && !existing && esm_prefetch_mark_seen(set, path);
+    if (wanted && esm_prefetch_add_job(set, job->owner, path)) queued++;
+    free(deps.items[i]);
+  }
+
+  uv_cond_broadcast(&set->ready);
+  uv_mutex_unlock(&set->lock);
+  free(deps.items);
+
+  return queued;
+}
+
+static void esm_prefetch_set_release(esm_prefetch_set_t *set) {
+  uv_mutex_lock(&set->lock);
+  bool last = --set->refs == 0;
+  uv_mutex_unlock(&set->lock);
+  if (!last) return;
+
+  uv_cond_destroy(&set->ready);
+  uv_mutex_destroy(&set->lock);
+  free(set);
+}
+
+// a drain request keeps claiming pending jobs until the queue is empty, so
+// the dependencies a worker discovers are read by that worker or a sibling
+// without a round trip through the isolate thread
+static void esm_prefetch_drain_work_cb(uv_work_t *req) {
+  esm_prefetch_drain_t *drain = (esm_prefetch_drain_t *)req->data;
+  esm_prefetch_set_t *set = drain->set;
+
+  for (;;) {
+    uv_mutex_lock(&set->lock);
+    esm_prefetch_job_t *job = esm_prefetch_claim_next(set);
+    uv_mutex_unlock(&set->lock);
+    if (!job) break;
+
+    esm_prefetch_run(set, job);
+
+    uv_mutex_lock(&set->lock);
+    esm_prefetch_job_unref(job);
+    uv_mutex_unlock(&set->lock);
+  }
+
+  esm_prefetch_set_release(set);
+}
+
+static void esm_prefetch_drain_after_cb(uv_work_t *req, int status) {
+  (void)status;
+  free(req->data);
+}
+
+static void esm_prefetch_dispatch(esm_prefetch_set_t *set, int count) {
+  for (int i = 0; i < count; i++) {
+    esm_prefetch_drain_t *drain = (esm_prefetch_drain_t *)calloc(1, sizeof(*drain));
+    if (!drain) return;
+
+    drain->set = set;
+    drain->req.data = drain;
+
+    uv_mutex_lock(&set->lock);
+    set->refs++;
+    uv_mutex_unlock(&set->lock);
+
+    if (uv_queue_work(uv_default_loop(), &drain->req, esm_prefetch_drain_work_cb, esm_prefetch_drain_after_cb) != 0) {
+      esm_prefetch_set_release(set);
+      free(drain);
+      return;
+    }
+  }
+}
+
+static esm_prefetch_set_t *esm_prefetch_set(ant_t *js) {
+  ant_esm_state_t *st = esm_state(js);
+  if (!st) return NULL;
+  if (st->prefetch) return st->prefetch;
+
+  esm_prefetch_set_t *set = (esm_prefetch_set_t *)calloc(1, sizeof(*set));
+  if (!set) return NULL;
+
+  uv_mutex_init(&set->lock);
+  uv_cond_init(&set->ready);
+  set->refs = 1;
+
+  st->prefetch = set;
+  return set;
+}
+
+void esm_prefetch_source(ant_t *js, const void *owner, const char *resolved_path) {
+  esm_prefetch_set_t *set = resolved_path ? esm_prefetch_set(js) : NULL;
+  if (!set) return;
+
+  uv_mutex_lock(&set->lock);
+  esm_prefetch_job_t *job = NULL;
+  HASH_FIND_STR(set->jobs, resolved_path, job);
+
+  // a job a worker queued on its own still needs a thread to pick it up
+  bool dispatch = job && !job->claimed;
+  if (!job) {
+    esm_prefetch_mark_seen(set, resolved_path);
+    dispatch = esm_prefetch_add_job(set, owner, resolved_path) != NULL;
+  }
+  uv_mutex_unlock(&set->lock);
+
+  if (dispatch) esm_prefetch_dispatch(set, 1);
+}
+
+bool esm_prefetch_take(ant_t *js, const char *resolved_path, esm_prefetched_source_t *out) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  esm_prefetch_set_t *set = st ? st->prefetch : NULL;
+  if (!set || !resolved_path) return false;
+
+  uv_mutex_lock(&set->lock);
+  esm_prefetch_job_t *job = NULL;
+  HASH_FIND_STR(set->jobs, resolved_path, job);
+  if (!job) {
+    uv_mutex_unlock(&set->lock);
+    return false;
+  }
+
+  HASH_DEL(set->jobs, job);
+  bool run_here = !job->claimed;
+  job->claimed = true;
+  uv_mutex_unlock(&set->lock);
+
+  // a job no worker has reached yet is cheaper to run here than to wait
+  // behind whatever is occupying the pool; its dependencies go to the pool
+  if (run_here) esm_prefetch_dispatch(set, esm_prefetch_run(set, job));
+
+  uv_mutex_lock(&set->lock);
+  while (!job->done) uv_cond_wait(&set->ready, &set->lock);
+
+  bool ok = job->read_status == ESM_READ_OK;
+  if (ok) {
+    *out = job->src;
+    job->taken = true;
+  }
+
+  esm_prefetch_job_unref(job);
+  uv_mutex_unlock(&set->lock);
+  return ok;
+}
+
+// a pending job is skipped when a worker reaches it, one already running
+// finishes and its buffer goes away with the runner's reference
+static void esm_prefetch_drop(esm_prefetch_set_t *set, esm_prefetch_job_t *job) {
+  HASH_DEL(set->jobs, job);
+  job->claimed = true;
+  job->dropped = true;
+  esm_prefetch_job_unref(job);
+}
+
+void esm_prefetch_release(ant_t *js, const void *owner) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  esm_prefetch_set_t *set = st ? st->prefetch : NULL;
+  if (!set) return;
+
+  uv_mutex_lock(&set->lock);
+  esm_prefetch_job_t *current, *tmp;
+  HASH_ITER(hh, set->jobs, current, tmp)
+    if (current->owner == owner) esm_prefetch_drop(set, current);
+  uv_mutex_unlock(&set->lock);
+}
+
+void esm_prefetch_cleanup(ant_t *js) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  esm_prefetch_set_t *set = st ? st->prefetch : NULL;
+  if (!set) return;
+
+  uv_mutex_lock(&set->lock);
+  set->closed = true;
+
+  esm_prefetch_job_t *current, *tmp;
+  HASH_ITER(hh, set->jobs, current, tmp) esm_prefetch_drop(set, current);
+  while (esm_prefetch_claim_next(set));
+
+  esm_prefetch_seen_t *seen, *seen_tmp;
+  HASH_ITER(hh, set->seen, seen, seen_tmp) {
+    HASH_DEL(set->seen, seen);
+    free(seen->path);
+    free(seen);
+  }
+  uv_mutex_unlock(&set->lock);
+
+  st->prefetch = NULL;
+  esm_prefetch_set_release(set);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// source of a module read (and TypeScript-stripped) off the isolate thread
+typedef struct {
+  char *content;
+  size_t size;
+  size_t js_len;
+  int strip_result;
+  const char *strip_detail;
+} esm_prefetched_source_t;
+
+void esm_prefetch_source(ant_t *js, const void *owner, const char *resolved_path);
+bool esm_prefetch_take(ant_t *js, const char *resolved_path, esm_prefetched_source_t *out);
+
+// drops every source queued for `owner` that nobody took
+void esm_prefetch_release(ant_t *js, const void *owner);
+void esm_prefetch_cleanup(ant_t *js);
@@ -0,0 +1,436 @@
+#include <compat.h> // IWYU pragma: keep
+#include "resolve_index.h"
+#include "loader_cache.h"
+#include "loader_internal.h"
+
+#include "esm/loader.h"
+#include "download.h"
+#include "hash.h"
+#include "internal.h"
+#include "utils.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include <uthash.h>
+
+#define ESM_INDEX_MAGIC   "ant-resolve-index"
+#define ESM_INDEX_VERSION 1
+#define ESM_INDEX_FIELDS  7
+
+#if defined(__APPLE__)
+#define ESM_INDEX_MTIME_NSEC(st) ((int64_t)(st)->st_mtimespec.tv_nsec)
+#elif defined(_WIN32)
+#define ESM_INDEX_MTIME_NSEC(st) ((int64_t)0)
+#else
+#define ESM_INDEX_MTIME_NSEC(st) ((int64_t)(st)->st_mtim.tv_nsec)
+#endif
+
+bool esm_resolve_index_enabled = false;
+
+typedef struct {
+  int64_t mtime_sec;
+  int64_t mtime_nsec;
+  uint64_t ino;
+  uint64_t size;
+} esm_index_sig_t;
+
+// a directory the resolver probed (its listing decides which candidates
+// exist) or a package.json it read (its contents decide exports/main)
+typedef struct esm_index_witness {
+  char *path;
+  esm_index_sig_t sig;
+  uint64_t content_hash;
+  bool is_file;
+  UT_hash_handle hh;
+} esm_index_witness_t;
+
+typedef struct esm_index_entry {
+  char *key;
+  char *resolved_path;
+  UT_hash_handle hh;
+} esm_index_entry_t;
+
+typedef struct esm_resolve_index {
+  char *file;
+  char *cwd;
+  esm_index_entry_t *entries;
+  esm_index_witness_t *witnesses;
+  bool dirty;
+} esm_resolve_index_t;
+
+// the probe helpers in loader.c have no ant_t in hand, so the one index
+// that is open records every filesystem fact the resolver looks at; it is
+// per thread so the prefetch workers' probes never touch it
+static _Thread_local esm_resolve_index_t *esm_index_recording = NULL;
+
+static bool esm_index_is_sep(char c) {
+  return c == '/' || c == '\\';
+}
+
+static bool esm_index_storable(const char *s) {
+  return s && s[0] && !strpbrk(s, "\t\r\n");
+}
+
+static bool esm_index_stat(const char *path, esm_index_sig_t *sig, bool *is_dir) {
+  struct stat st;
+  if (stat(path, &st) != 0) return false;
+
+  sig->mtime_sec = (int64_t)st.st_mtime;
+  sig->mtime_nsec = ESM_INDEX_MTIME_NSEC(&st);
+  sig->ino = (uint64_t)st.st_ino;
+  sig->size = (uint64_t)st.st_size;
+  *is_dir = S_ISDIR(st.st_mode);
+
+  return true;
+}
+
+static bool esm_index_sig_equal(const esm_index_sig_t *a, const esm_index_sig_t *b) {
+  return
+    a->mtime_sec == b->mtime_sec && a->mtime_nsec == b->mtime_nsec &&
+    a->ino == b->ino && a->size == b->size;
+}
+
+static bool esm_index_hash_file(const char *path, uint64_t *out) {
+  esm_file_data_t file = {0};
+  if (esm_read_file_bytes(path, &file) != ESM_READ_OK) return false;
+  *out = hash_key(file.data, file.size);
+  free(file.data);
+  return true;
+}
+
+static bool esm_index_parent(char *path) {
+  size_t len = strlen(path);
+  while (len > 1 && esm_index_is_sep(path[len - 1])) path[--len] = '\0';
+
+  char *sep = NULL;
+  for (char *p = path; *p; p++) if (esm_index_is_sep(*p)) sep = p;
+  if (!sep) return false;
+
+  if (sep == path) {
+    if (path[1] == '\0') return false;
+    path[1] = '\0';
+    return true;
+  }
+
+  *sep = '\0';
+  return true;
+}
+
+static void esm_index_add_witness(
+  esm_resolve_index_t *idx, const char *path,
+  const esm_index_sig_t *sig, bool is_file, uint64_t content_hash
+) {
+  if (!esm_index_storable(path)) return;
+
+  esm_index_witness_t *w = (esm_index_witness_t *)calloc(1, sizeof(*w));
+  if (!w) return;
+
+  w->path = strdup(path);
+  if (!w->path) {
+    free(w);
+    return;
+  }
+
+  w->sig = *sig;
+  w->is_file = is_file;
+  w->content_hash = content_hash;
+  HASH_ADD_KEYPTR(hh, idx->witnesses, w->path, strlen(w->path), w);
+}
+
+static void esm_index_add_entry(esm_resolve_index_t *idx, const char *key, const char *resolved_path) {
+  esm_index_entry_t *entry = (esm_index_entry_t *)calloc(1, sizeof(*entry));
+  if (!entry) return;
+
+  entry->key = strdup(key);
+  entry->resolved_path = strdup(resolved_path);
+
+  if (!entry->key || !entry->resolved_path) {
+    free(entry->key);
+    free(entry->resolved_path);
+    free(entry);
+    return;
+  }
+
+  HASH_ADD_KEYPTR(hh, idx->entries, entry->key, strlen(entry->key), entry);
+}
+
+static void esm_index_clear(esm_resolve_index_t *idx) {
+  esm_index_entry_t *entry, *entry_tmp;
+  HASH_ITER(hh, idx->entries, entry, entry_tmp) {
+    HASH_DEL(idx->entries, entry);
+    free(entry->key);
+    free(entry->resolved_path);
+    free(entry);
+  }
+
+  esm_index_witness_t *w, *w_tmp;
+  HASH_ITER(hh, idx->witnesses, w, w_tmp) {
+    HASH_DEL(idx->witnesses, w);
+    free(w->path);
+    free(w);
+  }
+}
+
+// a witness holds when the directory is untouched, or when a package.json
+// was rewritten with identical bytes (editors and installers love to do that)
+static bool esm_index_witness_holds(
+  esm_resolve_index_t *idx, const char *path,
+  esm_index_sig_t *sig, bool is_file, uint64_t content_hash
+) {
+  esm_index_sig_t now;
+  bool is_dir = false;
+
+  if (!esm_index_stat(path, &now, &is_dir) || is_dir == is_file) return false;
+  if (esm_index_sig_equal(&now, sig)) return true;
+  if (!is_file) return false;
+
+  uint64_t hash = 0;
+  if (!esm_index_hash_file(path, &hash) || hash != content_hash) return false;
+
+  *sig = now;
+  idx->dirty = true;
+
+  return true;
+}
+
+static int esm_index_split(char *line, char **fields) {
+  int n = 0;
+  fields[n++] = line;
+
+  for (char *p = line; *p && n < ESM_INDEX_FIELDS; p++) {
+    if (*p != '\t') continue;
+    *p = '\0';
+    fields[n++] = p + 1;
+  }
+
+  return n;
+}
+
+static bool esm_index_parse(esm_resolve_index_t *idx, char *data) {
+  bool have_header = false;
+  char *line = data;
+
+  while (line && *line) {
+    char *nl = strchr(line, '\n');
+    if (nl) *nl = '\0';
+
+    char *f[ESM_INDEX_FIELDS];
+    int n = esm_index_split(line, f);
+
+    if (!have_header) {
+      if (n != 3 || strcmp(f[0], ESM_INDEX_MAGIC) != 0) return false;
+      if (atoi(f[1]) != ESM_INDEX_VERSION || strcmp(f[2], idx->cwd) != 0) return false;
+      have_header = true;
+    } else if ((f[0][0] == 'D' && n == 6) || (f[0][0] == 'F' && n == 7)) {
+      bool is_file = f[0][0] == 'F';
+      const char *path = f[n - 1];
+      esm_index_sig_t sig = {
+        .mtime_sec = strtoll(f[1], NULL, 10),
+        .mtime_nsec = strtoll(f[2], NULL, 10),
+        .ino = strtoull(f[3], NULL, 10),
+        .size = strtoull(f[4], NULL, 10),
+      };
+      uint64_t content_hash = is_file ? strtoull(f[5], NULL, 16) : 0;
+      if (!esm_index_witness_holds(idx, path, &sig, is_file, content_hash)) return false;
+      esm_index_add_witness(idx, path, &sig, is_file, content_hash);
+    } else if (f[0][0] == 'R' && n == 3) {
+      esm_index_add_entry(idx, f[1], f[2]);
+    } else return false;
+
+    line = nl ? nl + 1 : NULL;
+  }
+
+  return have_header;
+}
+
+static void esm_index_load(esm_resolve_index_t *idx) {
+  esm_file_data_t file = {0};
+  if (esm_read_file_bytes(idx->file, &file) != ESM_READ_OK) return;
+
+  // all or nothing: any moved witness may have changed any answer
+  if (!esm_index_parse(idx, file.data)) {
+    esm_index_clear(idx);
+    idx->dirty = true;
+  }
+
+  free(file.data);
+}
+
+static void esm_index_save(esm_resolve_index_t *idx) {
+  char tmp_path[4096];
+  if ((size_t)snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%ld", idx->file, (long)getpid()) >= sizeof(tmp_path)) return;
+
+  FILE *fp = fopen(tmp_path, "wb");
+  if (!fp) return;
+
+  fprintf(fp, "%s\t%d\t%s\n", ESM_INDEX_MAGIC, ESM_INDEX_VERSION, idx->cwd);
+
+  esm_index_witness_t *w, *w_tmp;
+  HASH_ITER(hh, idx->witnesses, w, w_tmp) {
+    if (w->is_file) fprintf(
+      fp, "F\t%lld\t%lld\t%llu\t%llu\t%016llx\t%s\n",
+      (long long)w->sig.mtime_sec, (long long)w->sig.mtime_nsec,
+      (unsigned long long)w->sig.ino, (unsigned long long)w->sig.size,
+      (unsigned long long)w->content_hash, w->path
+    ); else fprintf(
+      fp, "D\t%lld\t%lld\t%llu\t%llu\t%s\n",
+      (long long)w->sig.mtime_sec, (long long)w->sig.mtime_nsec,
+      (unsigned long long)w->sig.ino, (unsigned long long)w->sig.size, w->path
+    );
+  }
+
+  esm_index_entry_t *entry, *entry_tmp;
+  HASH_ITER(hh, idx->entries, entry, entry_tmp) {
+    fprintf(fp, "R\t%s\t%s\n", entry->key, entry->resolved_path);
+  }
+
+  bool write_err = ferror(fp) != 0;
+  if (fclose(fp) != 0 || write_err) {
+    remove(tmp_path);
+    return;
+  }
+
+#ifdef _WIN32
+  remove(idx->file);
+#endif
+  if (rename(tmp_path, idx->file) != 0) remove(tmp_path);
+}
+
+void esm_resolve_index_open(ant_t *js) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  if (!esm_resolve_index_enabled || !st || st->resolve_index || esm_index_recording) return;
+
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd))) return;
+
+  char suffix[128];
+  char dir[4096];
+  char file[4096];
+
+  if ((size_t)snprintf(suffix, sizeof(suffix), "resolve/%s", ANT_GIT_LONGHASH) >= sizeof(suffix)) return;
+  if (ant_xdg_cache_path(dir, sizeof(dir), suffix) != 0) return;
+
+  if ((size_t)snprintf(
+    file, sizeof(file), "%s/%016llx.idx", dir,
+    (unsigned long long)hash_key(cwd, strlen(cwd))
+  ) >= sizeof(file)) return;
+
+  esm_resolve_index_t *idx = (esm_resolve_index_t *)calloc(1, sizeof(*idx));
+  if (!idx) return;
+
+  idx->file = strdup(file);
+  idx->cwd = strdup(cwd);
+  if (!idx->file || !idx->cwd) {
+    free(idx->file);
+    free(idx->cwd);
+    free(idx);
+    return;
+  }
+
+  esm_index_load(idx);
+  st->resolve_index = idx;
+  esm_index_recording = idx;
+}
+
+char *esm_resolve_index_get(ant_t *js, const char *key) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  if (!st || !st->resolve_index || st->bundle || !key) return NULL;
+
+  esm_index_entry_t *entry = NULL;
+  HASH_FIND_STR(st->resolve_index->entries, key, entry);
+  return entry ? strdup(entry->resolved_path) : NULL;
+}
+
+void esm_resolve_index_put(ant_t *js, const char *key, const char *resolved_path) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  if (!st || !st->resolve_index || st->bundle) return;
+  if (!esm_index_storable(key) || !esm_index_storable(resolved_path)) return;
+
+  esm_resolve_index_t *idx = st->resolve_index;
+  esm_index_entry_t *existing = NULL;
+  HASH_FIND_STR(idx->entries, key, existing);
+  if (existing) return;
+
+  esm_index_add_entry(idx, key, resolved_path);
+  idx->dirty = true;
+}
+
+void esm_resolve_index_note_path(const char *path) {
+  esm_resolve_index_t *idx = esm_index_recording;
+  if (!idx || !path || !path[0]) return;
+
+  char dir[PATH_MAX];
+  if ((size_t)snprintf(dir, sizeof(dir), "%s", path) >= sizeof(dir)) return;
+
+  // a probe for a missing entry is answered by the nearest directory that
+  // does exist; creating anything below it bumps that directory's mtime
+  while (esm_index_parent(dir)) {
+    esm_index_witness_t *w = NULL;
+    HASH_FIND_STR(idx->witnesses, dir, w);
+    if (w) return;
+
+    esm_index_sig_t sig;
+    bool is_dir = false;
+
+    if (esm_index_stat(dir, &sig, &is_dir) && is_dir) {
+      esm_index_add_witness(idx, dir, &sig, false, 0);
+      idx->dirty = true;
+      return;
+    }
+  }
+}
+
+void esm_resolve_index_note_package_json(const char *pkg_json_path) {
+  esm_resolve_index_t *idx = esm_index_recording;
+  if (!idx || !pkg_json_path || !pkg_json_path[0]) return;
+
+  esm_resolve_index_note_path(pkg_json_path);
+
+  esm_index_witness_t *w = NULL;
+  HASH_FIND_STR(idx->witnesses, pkg_json_path, w);
+  if (w) return;
+
+  esm_index_sig_t sig;
+  bool is_dir = false;
+  uint64_t content_hash = 0;
+
+  if (!esm_index_stat(pkg_json_path, &sig, &is_dir) || is_dir) return;
+  if (!esm_index_hash_file(pkg_json_path, &content_hash)) return;
+
+  esm_index_add_witness(idx, pkg_json_path, &sig, true, content_hash);
+  idx->dirty = true;
+}
+
+void esm_resolve_index_flush(ant_t *js) {
+  ant_esm_state_t *st = js ? js->esm.state : NULL;
+  esm_resolve_index_t *idx = st ? st->resolve_index : NULL;
+  if (!idx) return;
+
+  if (idx->dirty) {
+    char dir[4096];
+    char suffix[128];
+
+    if (
+      (size_t)snprintf(suffix, sizeof(suffix), "resolve/%s", ANT_GIT_LONGHASH) < sizeof(suffix) &&
+      ant_xdg_cache_path(dir, sizeof(dir), suffix) == 0 && ant_mkdir_p(dir) == 0
+    ) {
+      esm_index_save(idx);
+      ant_cache_prune_revisions("resolve", ANT_GIT_LONGHASH);
+    }
+  }
+
+  if (esm_index_recording == idx) esm_index_recording = NULL;
+  esm_index_clear(idx);
+
+  free(idx->file);
+  free(idx->cwd);
+  free(idx);
+
+  st->resolve_index = NULL;
+}
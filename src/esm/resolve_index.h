@@ -0,0 +1,15 @@
+#pragma once
+
+#include "types.h"
+
+#include <stdbool.h>
+
+// on-disk resolve cache shared across runs, see --resolve-cache
+void esm_resolve_index_open(ant_t *js);
+char *esm_resolve_index_get(ant_t *js, const char *key);
+void esm_resolve_index_put(ant_t *js, const char *key, const char *resolved_path);
+
+void esm_resolve_index_note_path(const char *path);
+void esm_resolve_index_note_package_json(const char *pkg_json_path);
+
+void esm_resolve_index_flush(ant_t *js);
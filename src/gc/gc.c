@@ -120,11 +120,43 @@ static void gc_adapt_major_interval(size_t live_before, size_t live_after) {
   }
 }
 
+static void gc_note_wasteful_slice(ant_t *js, ant_slice_heap_t *slice) {
+  ant_flat_string_t *parent = ant_str_flat_ptr(slice->parent);
+  if (!parent || slice->pending_flatten) return;
+  if ((size_t)parent->len / STR_SLICE_WASTE_RATIO < (size_t)slice->len) return;
+
+  if (js->rope_gc.wasteful_slice_len >= js->rope_gc.wasteful_slice_cap) {
+    size_t cap = js->rope_gc.wasteful_slice_cap
+      ? js->rope_gc.wasteful_slice_cap * 2u : 64u;
+    ant_slice_heap_t **items = (ant_slice_heap_t **)realloc(
+      js->rope_gc.wasteful_slices, cap * sizeof(*items)
+    );
+    if (!items) return;
+    js->rope_gc.wasteful_slices = items;
+    js->rope_gc.wasteful_slice_cap = cap;
+  }
+  
+  slice->pending_flatten = 1;
+  js->rope_gc.wasteful_slices[js->rope_gc.wasteful_slice_len++] = slice;
+}
+
+// copies out slices that were the only reason to keep a much larger parent
+// alive; the parent itself is reclaimed by the next major if unreferenced
+static void gc_flatten_wasteful_slices(ant_t *js) {
+  for (size_t i = 0; i < js->rope_gc.wasteful_slice_len; i++) {
+    ant_slice_heap_t *slice = js->rope_gc.wasteful_slices[i];
+    slice->pending_flatten = 0;
+    str_materialize(js, ant_mkslice_value(slice));
+  }
+  js->rope_gc.wasteful_slice_len = 0;
+}
+
 static void gc_mark_str(ant_t *js, ant_value_t root) {
   static const void *dispatch[] = {
     [STR_HEAP_TAG_FLAT] = &&l_flat,
     [STR_HEAP_TAG_ROPE] = &&l_rope,
     [STR_HEAP_TAG_BUILDER] = &&l_builder,
+    [STR_HEAP_TAG_SLICE] = &&l_slice,
   };
 
   ant_value_t local[32];
@@ -179,6 +211,21 @@ static void gc_mark_str(ant_t *js, ant_value_t root) {
     goto l_pop;
   }
 
+  l_slice: {
+    ant_slice_heap_t *slice = (ant_slice_heap_t *)(data & ~STR_HEAP_TAG_MASK);
+    if (!gc_ropes_contains(js, slice, sizeof(*slice), _Alignof(ant_slice_heap_t))) goto l_pop;
+    if (!gc_ropes_mark(js, slice)) goto l_pop;
+
+    if (vtype(slice->cached) == T_STR) {
+      v = slice->cached;
+      goto l_next;
+    }
+
+    if (!js->rope_gc.minor_marking) gc_note_wasteful_slice(js, slice);
+    v = slice->parent;
+    goto l_next;
+  }
+
   l_flat:
     if (data && !js->rope_gc.minor_marking)
       gc_strings_mark(js, (const void *)data);
@@ -232,7 +279,7 @@ void gc_run(ant_t *js) {
     "major rope marking cannot request another major"
   );
 
-  size_t live_before = js->obj_arena.live_count;
+  size_t live_before = js_obj_live_count(js);
 
   gc_bigints_begin(js);
   gc_strings_begin(js);
@@ -251,8 +298,8 @@ void gc_run(ant_t *js) {
   gc_strings_sweep(js);
   gc_ropes_sweep(js, false);
 
-  js->gc_last_live = js->obj_arena.live_count;
-  js->old_live_count = js->obj_arena.live_count;
+  js->gc_last_live = js_obj_live_count(js);
+  js->old_live_count = js_obj_live_count(js);
   js->minor_gc_count = 0;
 
   js->gc_pool_last_live = gc_pool_live_bytes(js);
@@ -265,7 +312,8 @@ void gc_run(ant_t *js) {
   js->gc_closure_promoted_since_major = 0;
   js->gc_remember_overflow = false;
 
-  gc_adapt_major_interval(live_before, js->obj_arena.live_count);
+  gc_flatten_wasteful_slices(js);
+  gc_adapt_major_interval(live_before, js_obj_live_count(js));
   gc_last_run_ms = gc_now_ms();
   gc_last_major_ms = gc_last_run_ms;
 }
@@ -283,7 +331,7 @@ void gc_run_minor(ant_t *js) {
   }
 
   size_t old_before   = js->old_live_count;
-  size_t live_before  = js->obj_arena.live_count;
+  size_t live_before  = js_obj_live_count(js);
   size_t young_before = live_before > old_before ? live_before - old_before : 0;
 
   for (size_t i = 0; i < js->rope_gc.remembered_builder_len; i++)
@@ -294,12 +342,12 @@ void gc_run_minor(ant_t *js) {
 
   ant_ic_obj_epoch_bump();
 
-  js->gc_last_live = js->obj_arena.live_count;
-  js->old_live_count = js->obj_arena.live_count;
+  js->gc_last_live = js_obj_live_count(js);
+  js->old_live_count = js_obj_live_count(js);
   js->minor_gc_count++;
 
-  size_t survivors = js->obj_arena.live_count > old_before
-    ? js->obj_arena.live_count - old_before : 0;
+  size_t survivors = js_obj_live_count(js) > old_before
+    ? js_obj_live_count(js) - old_before : 0;
 
   js->gc_closure_at_minor = js->gc_closure_alloc;
   gc_adapt_nursery(young_before, survivors);
@@ -316,7 +364,7 @@ void gc_maybe(ant_t *js) {
   if (__builtin_expect(gc_disabled, 0)) return;
   if (++gc_tick < GC_MIN_TICK) return;
   
-  size_t live = js->obj_arena.live_count;
+  size_t live = js_obj_live_count(js);
   size_t young_count = live > js->old_live_count ? live - js->old_live_count : 0;
   size_t closure_young = js->gc_closure_alloc > js->gc_closure_at_minor
     ? js->gc_closure_alloc - js->gc_closure_at_minor : 0;
@@ -325,7 +373,7 @@ void gc_maybe(ant_t *js) {
       js->rope_gc.young_alloc >= GC_ROPE_NURSERY_THRESHOLD ||
       closure_young >= GC_CLOSURE_NURSERY_THRESHOLD) {
     gc_tick = 0;
-    size_t live_before_minor = js->obj_arena.live_count;
+    size_t live_before_minor = js_obj_live_count(js);
     size_t major_threshold = gc_live_major_threshold(js);
     size_t pool_threshold = gc_pool_major_threshold(js);
 
@@ -353,7 +401,7 @@ void gc_maybe(ant_t *js) {
     gc_tick = 0;
     if (young_count >= live / 4) {
       gc_run_minor(js);
-      if (js->obj_arena.live_count < threshold) return;
+      if (js_obj_live_count(js) < threshold) return;
     }
     gc_run(js);
     return;
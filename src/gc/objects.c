@@ -4,6 +4,7 @@
 #include "internal.h"
 
 #include "silver/engine.h"
+#include "silver/swarm.h"
 #include "silver/eval_env.h"
 #include "modules/regex.h"
 #include "modules/generator.h"
@@ -347,7 +348,7 @@ static void gc_mark_stack_push(ant_object_t *obj) {
 }
 
 static inline void gc_grey_obj(ant_t *js, ant_object_t *obj) {
-  if (!obj || !fixed_arena_contains(&js->obj_arena, obj)) return;
+  if (!obj || !js_obj_arena_contains(js, obj)) return;
   if (obj->mark_epoch == gc_obj_epoch || obj->mark_epoch == ANT_GC_DEAD) return;
   if (g_minor_gc && obj->flags.generation == 1) return;
   obj->mark_epoch = gc_obj_epoch;
@@ -586,7 +587,7 @@ static bool gc_weak_key_alive(ant_t *js, ant_value_t key) {
   
   if (((1u << type) & GC_OBJ_TYPE_MASK) == 0) return false;
   ant_object_t *obj = js_obj_ptr(key);
-  if (!obj || !fixed_arena_contains(&js->obj_arena, obj) ||
+  if (!obj || !js_obj_arena_contains(js, obj) ||
       obj->mark_epoch == ANT_GC_DEAD) return false;
   
   return (g_minor_gc && obj->flags.generation == 1) ||
@@ -667,7 +668,7 @@ static void gc_scan_range(ant_t *js, uintptr_t lo, uintptr_t hi) {
     memcpy(&w, (void *)addr, sizeof(w));
     
     ant_object_t *raw_obj = (ant_object_t *)(uintptr_t)w;
-    if (fixed_arena_contains(&js->obj_arena, raw_obj))
+    if (js_obj_arena_contains(js, raw_obj))
       gc_grey_obj(js, raw_obj);
       
     sv_closure_t *raw_closure = (sv_closure_t *)(uintptr_t)w;
@@ -831,6 +832,9 @@ static void gc_mark_roots(ant_t *js) {
   gc_mark_atomics(js, gc_mark_value);
   gc_mark_fetch(js, gc_mark_value);
   gc_mark_fs(js, gc_mark_value);
+  gc_mark_blob(js, gc_mark_value);
+  gc_mark_dns(js, gc_mark_value);
+  gc_mark_multipart(js, gc_mark_value);
   gc_mark_child_process(js, gc_mark_value);
   gc_mark_readline(js, gc_mark_value);
   gc_mark_process(js, gc_mark_value);
@@ -877,7 +881,7 @@ static void gc_mark_roots(ant_t *js) {
 void gc_object_free(ant_t *js, ant_object_t *obj) {
   if (!obj) return;
 
-  if ((((uintptr_t)obj->finalizer | (uintptr_t)obj->promise_state |
+  if ((((uintptr_t)obj->promise_state |
         (uintptr_t)obj->extra_slots | (uintptr_t)obj->overflow_prop |
         (uintptr_t)obj->exotic_ops) | obj->native.tag) == 0 &&
       (((1u << obj->type_tag) & GC_FREE_PAYLOAD_MASK) == 0)) {
@@ -886,11 +890,12 @@ void gc_object_free(ant_t *js, ant_object_t *obj) {
       ant_shape_release(obj->shape);
       obj->shape = NULL;
     }
-    fixed_arena_free_elem(&js->obj_arena, obj);
+    fixed_arena_free_elem(js_obj_arena_for(js, obj), obj);
     return;
   }
 
-  if (obj->finalizer) obj->finalizer(js, obj);
+  ant_object_finalizer_fn finalizer = ant_object_finalizer(obj);
+  if (finalizer) finalizer(js, obj);
   
   if (obj->native.tag != 0 || ant_object_has_sidecar(obj))
     gc_finalize_events_object(js, js_obj_from_ptr(obj));
@@ -984,7 +989,7 @@ void gc_object_free(ant_t *js, ant_object_t *obj) {
   obj->overflow_prop = NULL;
   free((void *)obj->exotic_ops);
   obj->exotic_ops = NULL;
-  fixed_arena_free_elem(&js->obj_arena, obj);
+  fixed_arena_free_elem(js_obj_arena_for(js, obj), obj);
 }
 
 static void gc_sweep_young_and_promote(ant_t *js) {
@@ -1119,6 +1124,10 @@ void gc_objects_run(
   
   if (ant_gc_shapes_sweep()) ant_ic_epoch_bump();
   gc_promote_survivors(js);
+  
+#ifdef ANT_JIT
+  sv_jit_gc_sweep(js, gc_epoch);
+#endif
 
   ant_fixed_arena_t *ca = &js->closure_arena;
   ca->free_list = NULL;
@@ -1156,31 +1165,33 @@ void gc_objects_run(
   js->young_upvalue_len = 0;
   js->young_closure_trigger = GC_CLOSURE_NURSERY_THRESHOLD;
 
-  ant_fixed_arena_t *oa = &js->obj_arena;
-  size_t new_wm = 0;
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) {
+    ant_fixed_arena_t *oa = &js->obj_arenas[i];
+    size_t new_wm = 0;
 
-  for (size_t off = oa->watermark; off >= oa->elem_size; off -= oa->elem_size) {
-    ant_object_t *slot = (ant_object_t *)(oa->base + off - oa->elem_size);
-    if (slot->mark_epoch != ANT_GC_DEAD) { new_wm = off; break; }
-  }
+    for (size_t off = oa->watermark; off >= oa->elem_size; off -= oa->elem_size) {
+      ant_object_t *slot = (ant_object_t *)(oa->base + off - oa->elem_size);
+      if (slot->mark_epoch != ANT_GC_DEAD) { new_wm = off; break; }
+    }
 
-  if (new_wm < oa->watermark) {
-    oa->free_list = NULL;
-    
-    for (size_t off = 0; off < new_wm; off += oa->elem_size) {
-    ant_object_t *slot = (ant_object_t *)(oa->base + off);
-    if (slot->mark_epoch == ANT_GC_DEAD) {
-      *(void **)slot = oa->free_list;
-      oa->free_list = slot;
-    }}
-    
-    ant_arena_decommit(oa->base, oa->committed, new_wm);
-    oa->committed = new_wm;
-    oa->watermark = new_wm;
+    if (new_wm < oa->watermark) {
+      oa->free_list = NULL;
+      
+      for (size_t off = 0; off < new_wm; off += oa->elem_size) {
+      ant_object_t *slot = (ant_object_t *)(oa->base + off);
+      if (slot->mark_epoch == ANT_GC_DEAD) {
+        *(void **)slot = oa->free_list;
+        oa->free_list = slot;
+      }}
+      
+      ant_arena_decommit(oa->base, oa->committed, new_wm);
+      oa->committed = new_wm;
+      oa->watermark = new_wm;
+    }
   }
 
   if (gc_mark_cap > GC_MARK_STACK_INIT) {
-    size_t target = js->obj_arena.live_count * 2;
+    size_t target = js_obj_live_count(js) * 2;
     if (target < GC_MARK_STACK_INIT) target = GC_MARK_STACK_INIT;
     if (target < gc_mark_cap / 2) {
       ant_object_t **ns = realloc(gc_mark_stack, target * sizeof(*ns));
@@ -85,11 +85,13 @@ static int parser_on_headers_complete(llhttp_t *parser) {
   if (ctx->header_field.len > 0 || ctx->header_value.len > 0) {
     if (!parser_copy_header(ctx)) return -1;
   }
+  if (ctx->on_headers) ctx->on_headers(parser, ctx, ctx->on_headers_data);
   return 0;
 }
 
 static int parser_on_body(llhttp_t *parser, const char *at, size_t length) {
   parser_ctx_t *ctx = (parser_ctx_t *)parser->data;
+  if (ctx->body_sink) return ctx->body_sink(ctx->body_sink_data, (const uint8_t *)at, length) ? 0 : -1;
   return ant_http1_buffer_append(&ctx->body, at, length) ? 0 : -1;
 }
 
@@ -197,6 +199,8 @@ void ant_http1_conn_parser_init(ant_http1_conn_parser_t *cp) {
 }
 
 void ant_http1_conn_parser_reset(ant_http1_conn_parser_t *cp) {
+  ant_http1_headers_cb_t on_headers = NULL;
+  void *on_headers_data = NULL;
   if (!cp) return;
 
   ant_http1_buffer_free(&cp->ctx.method);
@@ -205,8 +209,12 @@ void ant_http1_conn_parser_reset(ant_http1_conn_parser_t *cp) {
   ant_http1_buffer_free(&cp->ctx.header_value);
   ant_http1_buffer_free(&cp->ctx.body);
   
+  on_headers = cp->ctx.on_headers;
+  on_headers_data = cp->ctx.on_headers_data;
   memset(&cp->ctx, 0, sizeof(cp->ctx));
   cp->ctx.header_tail = &cp->ctx.req.headers;
+  cp->ctx.on_headers = on_headers;
+  cp->ctx.on_headers_data = on_headers_data;
   cp->fed_len = 0;
   llhttp_reset(&cp->parser);
   cp->parser.data = &cp->ctx;
@@ -223,6 +231,12 @@ void ant_http1_conn_parser_free(ant_http1_conn_parser_t *cp) {
   ant_http1_free_parsed_request(&cp->ctx.req);
 }
 
+size_t ant_http1_conn_parser_drop_fed(ant_http1_conn_parser_t *cp) {
+  size_t fed = cp ? cp->fed_len : 0;
+  if (cp) cp->fed_len = 0;
+  return fed;
+}
+
 ant_http1_parse_result_t ant_http1_conn_parser_execute(
   ant_http1_conn_parser_t *cp,
   const char *data,
@@ -275,6 +289,7 @@ ant_http1_parse_result_t ant_http1_conn_parser_execute(
     strncmp(cp->ctx.req.target, "https://", 8) == 0;
     
   cp->ctx.req.keep_alive = llhttp_should_keep_alive(&cp->parser) == 1;
+  cp->ctx.req.body_streamed = cp->ctx.body_sink != NULL;
   cp->ctx.req.http_major = cp->parser.http_major;
   cp->ctx.req.http_minor = cp->parser.http_minor;
 
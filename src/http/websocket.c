@@ -118,6 +118,26 @@ void ant_ws_frame_clear(ant_ws_frame_t *frame) {
   memset(frame, 0, sizeof(*frame));
 }
 
+// xors eight bytes per step, the mask repeats every four so a doubled
+// mask word lines up with any 8-byte aligned offset into the payload
+void ant_ws_mask(uint8_t *data, size_t len, const uint8_t mask[4]) {
+  uint32_t mask32 = 0;
+  uint64_t mask64 = 0;
+  size_t i = 0;
+
+  memcpy(&mask32, mask, sizeof(mask32));
+  mask64 = ((uint64_t)mask32 << 32) | mask32;
+
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word = 0;
+    memcpy(&word, data + i, sizeof(word));
+    word ^= mask64;
+    memcpy(data + i, &word, sizeof(word));
+  }
+
+  for (; i < len; i++) data[i] ^= mask[i & 3];
+}
+
 static uint64_t ant_ws_read_u64_be(const uint8_t *data) {
   uint64_t value = 0;
   for (int i = 0; i < 8; i++) value = (value << 8) | data[i];
@@ -173,9 +193,7 @@ ant_ws_frame_result_t ant_ws_parse_frame(
   if (!out->payload) return ANT_WS_FRAME_PROTOCOL_ERROR;
   if (payload_len > 0) memcpy(out->payload, data + pos, (size_t)payload_len);
   out->payload[payload_len] = 0;
-  if (masked) {
-    for (size_t i = 0; i < (size_t)payload_len; i++) out->payload[i] ^= out->mask[i % 4];
-  }
+  if (masked) ant_ws_mask(out->payload, (size_t)payload_len, out->mask);
 
   out->fin = (data[0] & 0x80u) != 0;
   out->rsv1 = (data[0] & 0x40u) != 0;
@@ -235,10 +253,9 @@ uint8_t *ant_ws_encode_frame(
     pos += sizeof(masking_key);
   }
 
-  for (size_t i = 0; i < payload_len; i++) {
-    uint8_t byte = payload ? payload[i] : 0;
-    out[pos + i] = mask ? (byte ^ masking_key[i % 4]) : byte;
-  }
+  if (payload && payload_len > 0) memcpy(out + pos, payload, payload_len);
+  else if (payload_len > 0) memset(out + pos, 0, payload_len);
+  if (mask) ant_ws_mask(out + pos, payload_len, masking_key);
 
   if (out_len) *out_len = pos + payload_len;
   return out;
@@ -529,7 +529,7 @@ static size_t inspector_heap_used(ant_t *js) {
   ant_pool_stats_t permanent = js_pool_stats(&js->pool.permanent);
   ant_pool_stats_t bigints = js_class_pool_stats(&js->pool.bigint);
   return
-    js->obj_arena.live_count * js->obj_arena.elem_size +
+    js_obj_live_bytes(js) +
     js->closure_arena.live_count * js->closure_arena.elem_size +
     js->upvalue_arena.live_count * js->upvalue_arena.elem_size +
     strings.total.used + ropes.used + symbols.used + permanent.used + bigints.used +
@@ -544,7 +544,7 @@ static size_t inspector_heap_total(ant_t *js) {
   ant_pool_stats_t permanent = js_pool_stats(&js->pool.permanent);
   ant_pool_stats_t bigints = js_class_pool_stats(&js->pool.bigint);
   return
-    js->obj_arena.committed +
+    js_obj_committed_bytes(js) +
     js->closure_arena.committed +
     js->upvalue_arena.committed +
     strings.total.capacity + ropes.capacity + symbols.capacity + permanent.capacity + bigints.capacity +
@@ -111,6 +111,10 @@ static void ant_debug_apply(const char *key, const char *val) {
     if (strcmp(val, "op-warn") == 0  || strcmp(val, "all") == 0) sv_debug_enable(SV_DEBUG_JIT_WARN);
   }
 
+  else if (strcmp(key, "jit") == 0) {
+    if (strcmp(val, "sync") == 0) sv_debug_enable(SV_DEBUG_JIT_SYNC);
+  }
+
   else if (strcmp(key, "sandbox") == 0) {
     if (strcmp(val, "bypass-manifest") == 0) ant_sandbox_assets_bypass_manifest = true;
   }
@@ -567,6 +571,10 @@ int main(int argc, char *argv[]) {
     else if (strcmp(arg, "--force") == 0) pkg_force = true;
     else if (strcmp(arg, "--no-color") == 0) { crprintf_set_color(false); io_no_color = true; }
     else if (strncmp(arg, "--stack-size=", 13) == 0) sv_user_stack_size_kb = atoi(arg + 13);
+    else if (strncmp(arg, "--jit-code-budget=", 18) == 0) sv_jit_code_budget_kb = atoi(arg + 18);
+    else if (strcmp(arg, "--no-lazy") == 0) sv_lazy_functions = false;
+    else if (strcmp(arg, "--profile-opcodes") == 0) sv_profile_opcodes = true;
+    else if (strcmp(arg, "--resolve-cache") == 0) esm_resolve_index_enabled = true;
     else if (strcmp(arg, "--sandbox-daemon") == 0) sandbox_daemon = true;
     else if (strcmp(arg, "--inspect") == 0) inspector.enabled = true;
     
@@ -591,6 +599,7 @@ int main(int argc, char *argv[]) {
   
   argc = filtered_argc; 
   argv = filtered_argv;
+  if (sv_profile_opcodes) atexit(sv_opcode_profile_report);
   
   argv_split_t script_tail = split_script_args(&argc, argv);
   argv_split_t proc_argv = { 0, NULL };
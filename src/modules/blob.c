@@ -5,6 +5,11 @@
 #include <time.h>
 #include <ctype.h>
 #include <stdio.h>
+#include <strings.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <uv.h>
+#include <uthash.h>
 
 #include "ant.h"
 #include "ptr.h"
@@ -12,12 +17,18 @@
 #include "internal.h"
 #include "descriptors.h"
 
+#include "gc/modules.h"
 #include "modules/blob.h"
 #include "modules/buffer.h"
 #include "modules/symbol.h"
 #include "streams/readable.h"
 
-enum { BLOB_NATIVE_TAG = 0x424c4f42u }; // BLOB
+enum { 
+  BLOB_NATIVE_TAG = 0x424c4f42u,       // BLOB
+  BLOB_STREAM_NATIVE_TAG = 0x424c5354u // BLST
+};
+
+#define BLOB_FILE_CHUNK (64 * 1024)
 
 bool blob_is_blob(ant_t *js, ant_value_t obj) {
   int id = js_brand_id(obj);
@@ -28,6 +39,97 @@ blob_data_t *blob_get_data(ant_value_t obj) {
   return (blob_data_t *)js_get_native(obj, BLOB_NATIVE_TAG);
 }
 
+// temp files (spilled uploads) are shared by every blob sliced or cloned
+// from them and unlinked when the last path referencing them is freed
+typedef struct {
+  char *path;
+  size_t refs;
+  UT_hash_handle hh;
+} blob_temp_path_t;
+
+static blob_temp_path_t *blob_temp_paths = NULL;
+
+bool blob_path_own_temp(const char *path) {
+  blob_temp_path_t *tp = calloc(1, sizeof(*tp));
+  if (!tp) return false;
+  
+  tp->path = strdup(path);
+  if (!tp->path) { free(tp); return false; }
+  
+  HASH_ADD_KEYPTR(hh, blob_temp_paths, tp->path, strlen(tp->path), tp);
+  return true;
+}
+
+char *blob_path_dup(const char *path) {
+  blob_temp_path_t *tp = NULL;
+  char *copy = path ? strdup(path) : NULL;
+  if (!copy) return NULL;
+
+  HASH_FIND(hh, blob_temp_paths, path, strlen(path), tp);
+  if (tp) tp->refs++;
+  
+  return copy;
+}
+
+void blob_path_free(char *path) {
+  blob_temp_path_t *tp = NULL;
+  if (!path) return;
+
+  HASH_FIND(hh, blob_temp_paths, path, strlen(path), tp);
+  if (tp && --tp->refs == 0) {
+    uv_fs_t req;
+    uv_fs_unlink(NULL, &req, tp->path, NULL);
+    uv_fs_req_cleanup(&req);
+    HASH_DEL(blob_temp_paths, tp);
+    free(tp->path);
+    free(tp);
+  }
+  
+  free(path);
+}
+
+static bool blob_file_read(const blob_data_t *bd, uint64_t pos, uint8_t *out, size_t len) {
+  uv_fs_t req;
+  uv_file file;
+  size_t done = 0;
+  int rc = uv_fs_open(NULL, &req, bd->path, O_RDONLY, 0, NULL);
+
+  uv_fs_req_cleanup(&req);
+  if (rc < 0) return false;
+  file = rc;
+
+  while (done < len) {
+    size_t want = len - done;
+    if (want > (1u << 30)) want = 1u << 30;
+    uv_buf_t buf = uv_buf_init((char *)out + done, (unsigned int)want);
+    rc = uv_fs_read(NULL, &req, file, &buf, 1, (int64_t)(bd->offset + pos + done), NULL);
+    uv_fs_req_cleanup(&req);
+    if (rc <= 0) break;
+    done += (size_t)rc;
+  }
+
+  uv_fs_close(NULL, &req, file, NULL);
+  uv_fs_req_cleanup(&req);
+  
+  return done == len;
+}
+
+bool blob_load(blob_data_t *bd) {
+  uint8_t *data = NULL;
+
+  if (!bd || bd->data || !bd->path || bd->size == 0) return true;
+  data = malloc(bd->size);
+  if (!data) return false;
+  
+  if (!blob_file_read(bd, 0, data, bd->size)) {
+    free(data);
+    return false;
+  }
+
+  bd->data = data;
+  return true;
+}
+
 static blob_data_t *blob_data_new(const uint8_t *data, size_t size, const char *type) {
   blob_data_t *bd = calloc(1, sizeof(blob_data_t));
   
@@ -108,6 +210,7 @@ static ant_value_t process_blob_part(ant_t *js, byte_buf_t *buf, ant_value_t par
     }
     blob_data_t *bd = blob_get_data(part);
     if (bd && bd->size > 0) {
+      if (!blob_load(bd)) return js_mkerr(js, "Failed to read '%s'", bd->path);
       if (!byte_buf_append(buf, bd->data, bd->size)) return js_mkerr(js, "out of memory");
       return js_mkundef();
     }
@@ -149,7 +252,7 @@ static ant_value_t process_blob_parts(ant_t *js, byte_buf_t *buf, ant_value_t pa
 static void blob_finalize(ant_t *js, ant_object_t *obj) {
   ant_value_t value = js_obj_from_ptr(obj);
   blob_data_t *bd = (blob_data_t *)js_get_native(value, BLOB_NATIVE_TAG);
-  if (bd) { free(bd->data); free(bd->type); free(bd->name); free(bd); }
+  if (bd) { free(bd->data); free(bd->type); free(bd->name); blob_path_free(bd->path); free(bd); }
   js_clear_native(value, BLOB_NATIVE_TAG);
 }
 
@@ -196,6 +299,10 @@ static ant_value_t js_blob_text(ant_t *js, ant_value_t *args, int nargs) {
   (void)args; (void)nargs;
   blob_data_t *bd = blob_get_data(js->this_val);
   ant_value_t promise = js_mkpromise(js);
+  if (!blob_load(bd)) {
+    js_reject_promise(js, promise, js_mkerr(js, "Failed to read '%s'", bd->path));
+    return promise;
+  }
   ant_value_t str = (!bd || bd->size == 0)
     ? js_mkstr(js, "", 0)
     : js_mkstr(js, (const char *)bd->data, bd->size);
@@ -207,6 +314,10 @@ static ant_value_t js_blob_array_buffer(ant_t *js, ant_value_t *args, int nargs)
   (void)args; (void)nargs;
   blob_data_t *bd = blob_get_data(js->this_val);
   ant_value_t promise = js_mkpromise(js);
+  if (!blob_load(bd)) {
+    js_reject_promise(js, promise, js_mkerr(js, "Failed to read '%s'", bd->path));
+    return promise;
+  }
 
   size_t sz = (bd && bd->data) ? bd->size : 0;
   ArrayBufferData *abd = create_array_buffer_data(sz);
@@ -221,6 +332,10 @@ static ant_value_t js_blob_bytes(ant_t *js, ant_value_t *args, int nargs) {
   (void)args; (void)nargs;
   blob_data_t *bd = blob_get_data(js->this_val);
   ant_value_t promise = js_mkpromise(js);
+  if (!blob_load(bd)) {
+    js_reject_promise(js, promise, js_mkerr(js, "Failed to read '%s'", bd->path));
+    return promise;
+  }
 
   size_t sz = (bd && bd->data) ? bd->size : 0;
   ArrayBufferData *abd = create_array_buffer_data(sz);
@@ -257,7 +372,8 @@ static ant_value_t js_blob_slice(ant_t *js, ant_value_t *args, int nargs) {
   if (end < start) end = start;
 
   size_t new_size = (size_t)(end - start);
-  const uint8_t *src = (bd && bd->data && new_size > 0) ? (bd->data + start) : NULL;
+  bool from_file = bd && bd->path;
+  const uint8_t *src = (!from_file && bd && bd->data && new_size > 0) ? (bd->data + start) : NULL;
 
   const char *new_type = (bd && bd->type) ? bd->type : "";
   char *type_owned = NULL;
@@ -270,9 +386,239 @@ static ant_value_t js_blob_slice(ant_t *js, ant_value_t *args, int nargs) {
 
   ant_value_t result = blob_create(js, src, new_size, new_type);
   free(type_owned);
+  
+  blob_data_t *nbd = from_file && !is_err(result) ? blob_get_data(result) : NULL;
+  if (nbd) {
+    nbd->path = blob_path_dup(bd->path);
+    nbd->offset = bd->offset + (uint64_t)start;
+    if (!nbd->path) return js_mkerr(js, "out of memory");
+  }
+  
   return result;
 }
 
+// file-backed blobs are streamed a chunk per pull through one descriptor
+// that stays open until the end of the file, an error or a cancel. reads go
+// through the threadpool and the pull promise settles from the callback
+typedef struct blob_file_stream_s {
+  uv_fs_t req;
+  ant_t *js;
+  char *path;
+  uint64_t offset;
+  uint64_t size;
+  uint64_t pos;
+  uv_file file;
+  ArrayBufferData *chunk;
+  size_t chunk_len;
+  size_t want;
+  ant_value_t obj;
+  ant_value_t ctrl;
+  ant_value_t promise;
+  bool busy;
+  bool cancelled;
+  bool orphaned;
+  struct blob_file_stream_s *next_active;
+} blob_file_stream_t;
+
+static blob_file_stream_t *blob_active_streams = NULL;
+
+static void blob_file_stream_unlink(blob_file_stream_t *st) {
+  blob_file_stream_t **it = NULL;
+  for (it = &blob_active_streams; *it; it = &(*it)->next_active)
+    if (*it == st) { *it = st->next_active; return; }
+}
+
+static void blob_file_stream_close_fd(blob_file_stream_t *st) {
+  uv_fs_t req;
+  if (st->file < 0) return;
+  uv_fs_close(NULL, &req, st->file, NULL);
+  uv_fs_req_cleanup(&req);
+  st->file = -1;
+}
+
+static void blob_file_stream_free(blob_file_stream_t *st) {
+  blob_file_stream_close_fd(st);
+  blob_path_free(st->path);
+  free(st);
+}
+
+static void blob_file_stream_finalize(ant_t *js, ant_object_t *obj) {
+  ant_value_t value = js_obj_from_ptr(obj);
+  blob_file_stream_t *st = (blob_file_stream_t *)js_get_native(value, BLOB_STREAM_NATIVE_TAG);
+  
+  js_clear_native(value, BLOB_STREAM_NATIVE_TAG);
+  if (!st) return;
+  if (st->busy) { st->orphaned = true; return; }
+  
+  blob_file_stream_free(st);
+}
+
+static void blob_file_stream_done(blob_file_stream_t *st, int status) {
+  ant_t *js = st->js;
+  ant_value_t promise = st->promise;
+  ant_value_t ctrl = st->ctrl;
+  ArrayBufferData *ab = st->chunk;
+  size_t len = st->chunk_len;
+
+  blob_file_stream_unlink(st);
+  st->busy = false;
+  st->chunk = NULL;
+  st->chunk_len = 0;
+  st->ctrl = js_mkundef();
+  st->promise = js_mkundef();
+
+  if (st->orphaned) {
+    if (ab) free_array_buffer_data(ab);
+    blob_file_stream_free(st);
+    return;
+  }
+
+  if (st->cancelled || status < 0) {
+    if (ab) free_array_buffer_data(ab);
+    blob_file_stream_close_fd(st);
+  }
+
+  if (st->cancelled) {
+    js_resolve_promise(js, promise, js_mkundef());
+    return;
+  }
+
+  if (status < 0) {
+    char msg[512];
+    snprintf(msg, sizeof(msg), "Failed to read '%s'", st->path);
+    js_reject_promise(js, promise, js_make_error_silent(js, JS_ERR_GENERIC, msg));
+    return;
+  }
+
+  st->pos += len;
+  if (st->pos >= st->size) blob_file_stream_close_fd(st);
+  
+  rs_controller_enqueue(js, ctrl, create_typed_array(js, TYPED_ARRAY_UINT8, ab, 0, len, "Uint8Array"));
+  if (st->pos >= st->size) rs_controller_close(js, ctrl);
+  js_resolve_promise(js, promise, js_mkundef());
+}
+
+static void blob_file_stream_on_read(uv_fs_t *req);
+
+static int blob_file_stream_read(blob_file_stream_t *st) {
+  uv_buf_t buf = uv_buf_init((char *)st->chunk->data + st->chunk_len, (unsigned int)(st->want - st->chunk_len));
+  int64_t at = (int64_t)(st->offset + st->pos + st->chunk_len);
+  return uv_fs_read(uv_default_loop(), &st->req, st->file, &buf, 1, at, blob_file_stream_on_read);
+}
+
+static void blob_file_stream_on_read(uv_fs_t *req) {
+  blob_file_stream_t *st = (blob_file_stream_t *)req->data;
+  ssize_t n = req->result;
+  int rc = 0;
+
+  uv_fs_req_cleanup(req);
+  if (st->orphaned || st->cancelled) { blob_file_stream_done(st, 0); return; }
+  
+  // a file that shrank under the blob is an error, not a short stream
+  if (n <= 0) { blob_file_stream_done(st, n < 0 ? (int)n : UV_EIO); return; }
+
+  st->chunk_len += (size_t)n;
+  if (st->chunk_len >= st->want) { blob_file_stream_done(st, 0); return; }
+
+  rc = blob_file_stream_read(st);
+  if (rc < 0) blob_file_stream_done(st, rc);
+}
+
+static void blob_file_stream_on_open(uv_fs_t *req) {
+  blob_file_stream_t *st = (blob_file_stream_t *)req->data;
+  int rc = (int)req->result;
+
+  uv_fs_req_cleanup(req);
+  if (rc >= 0) st->file = rc;
+  if (rc < 0 || st->orphaned || st->cancelled) { blob_file_stream_done(st, rc < 0 ? rc : 0); return; }
+
+  rc = blob_file_stream_read(st);
+  if (rc < 0) blob_file_stream_done(st, rc);
+}
+
+static blob_file_stream_t *blob_file_stream_get(ant_t *js) {
+  ant_value_t state = js_get_slot(js->current_func, SLOT_DATA);
+  return (blob_file_stream_t *)js_get_native(state, BLOB_STREAM_NATIVE_TAG);
+}
+
+static ant_value_t blob_stream_pull_file(ant_t *js, ant_value_t *args, int nargs) {
+  blob_file_stream_t *st = blob_file_stream_get(js);
+  ant_value_t ctrl = (nargs > 0) ? args[0] : js_mkundef();
+  ant_value_t promise;
+  int rc = 0;
+
+  if (!st || st->pos >= st->size) {
+    if (st) blob_file_stream_close_fd(st);
+    rs_controller_close(js, ctrl);
+    return js_mkundef();
+  }
+
+  st->want = (size_t)(st->size - st->pos);
+  if (st->want > BLOB_FILE_CHUNK) st->want = BLOB_FILE_CHUNK;
+  st->chunk = create_array_buffer_data(st->want);
+  if (!st->chunk) return js_mkerr(js, "out of memory");
+
+  promise = js_mkpromise(js);
+  st->chunk_len = 0;
+  st->ctrl = ctrl;
+  st->promise = promise;
+  st->busy = true;
+  st->req.data = st;
+  st->next_active = blob_active_streams;
+  blob_active_streams = st;
+
+  rc = st->file < 0
+    ? uv_fs_open(uv_default_loop(), &st->req, st->path, O_RDONLY, 0, blob_file_stream_on_open)
+    : blob_file_stream_read(st);
+  if (rc < 0) blob_file_stream_done(st, rc);
+
+  return promise;
+}
+
+static ant_value_t blob_stream_cancel_file(ant_t *js, ant_value_t *args, int nargs) {
+  blob_file_stream_t *st = blob_file_stream_get(js);
+  if (!st) return js_mkundef();
+  
+  st->cancelled = true;
+  if (!st->busy) blob_file_stream_close_fd(st);
+  else uv_cancel((uv_req_t *)&st->req);
+  
+  return js_mkundef();
+}
+
+static ant_value_t blob_file_stream_create(ant_t *js, const blob_data_t *bd) {
+  blob_file_stream_t *st = calloc(1, sizeof(*st));
+  if (!st) return js_mkerr(js, "out of memory");
+
+  st->path = blob_path_dup(bd->path);
+  if (!st->path) { free(st); return js_mkerr(js, "out of memory"); }
+  
+  st->js = js;
+  st->offset = bd->offset;
+  st->size = bd->size;
+  st->file = -1;
+  st->ctrl = js_mkundef();
+  st->promise = js_mkundef();
+
+  ant_value_t state = js_mkobj(js);
+  js_set_native(state, st, BLOB_STREAM_NATIVE_TAG);
+  js_set_finalizer(state, blob_file_stream_finalize);
+  st->obj = state;
+
+  ant_value_t pull_fn = js_heavy_mkfun(js, blob_stream_pull_file, state);
+  ant_value_t cancel_fn = js_heavy_mkfun(js, blob_stream_cancel_file, state);
+  
+  return rs_create_stream(js, pull_fn, cancel_fn, 1);
+}
+
+void gc_mark_blob(ant_t *js, gc_mark_fn mark) {
+  for (blob_file_stream_t *st = blob_active_streams; st; st = st->next_active) {
+    mark(js, st->obj);
+    mark(js, st->ctrl);
+    mark(js, st->promise);
+  }
+}
+
 static ant_value_t blob_stream_pull(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t blob_obj = js_get_slot(js->current_func, SLOT_DATA);
   blob_data_t *bd = blob_get_data(blob_obj);
@@ -290,6 +636,9 @@ static ant_value_t blob_stream_pull(ant_t *js, ant_value_t *args, int nargs) {
 }
 
 static ant_value_t js_blob_stream(ant_t *js, ant_value_t *args, int nargs) {
+  blob_data_t *bd = blob_get_data(js->this_val);
+  if (bd && bd->path && !bd->data) return blob_file_stream_create(js, bd);
+
   ant_value_t pull_fn = js_heavy_mkfun(js, blob_stream_pull, js->this_val);
   return rs_create_stream(js, pull_fn, js_mkundef(), 1);
 }
@@ -418,6 +767,119 @@ static ant_value_t js_file_ctor(ant_t *js, ant_value_t *args, int nargs) {
   return obj;
 }
 
+static const struct { const char *ext; const char *type; } blob_mime_types[] = {
+  { "html",  "text/html;charset=utf-8" },
+  { "htm",   "text/html;charset=utf-8" },
+  { "css",   "text/css;charset=utf-8" },
+  { "js",    "text/javascript;charset=utf-8" },
+  { "mjs",   "text/javascript;charset=utf-8" },
+  { "cjs",   "text/javascript;charset=utf-8" },
+  { "json",  "application/json;charset=utf-8" },
+  { "txt",   "text/plain;charset=utf-8" },
+  { "md",    "text/markdown;charset=utf-8" },
+  { "csv",   "text/csv;charset=utf-8" },
+  { "xml",   "application/xml" },
+  { "svg",   "image/svg+xml" },
+  { "png",   "image/png" },
+  { "jpg",   "image/jpeg" },
+  { "jpeg",  "image/jpeg" },
+  { "gif",   "image/gif" },
+  { "webp",  "image/webp" },
+  { "avif",  "image/avif" },
+  { "ico",   "image/x-icon" },
+  { "wasm",  "application/wasm" },
+  { "pdf",   "application/pdf" },
+  { "zip",   "application/zip" },
+  { "gz",    "application/gzip" },
+  { "mp3",   "audio/mpeg" },
+  { "wav",   "audio/wav" },
+  { "mp4",   "video/mp4" },
+  { "webm",  "video/webm" },
+  { "woff",  "font/woff" },
+  { "woff2", "font/woff2" },
+};
+
+static const char *blob_path_basename(const char *path) {
+  const char *name = strrchr(path, '/');
+#ifdef _WIN32
+  const char *alt = strrchr(path, '\\');
+  if (!name || (alt && alt > name)) name = alt;
+#endif
+  return name ? name + 1 : path;
+}
+
+static const char *blob_guess_type(const char *name) {
+  const char *dot = strrchr(name, '.');
+  if (!dot || dot == name) return "";
+  for (size_t i = 0; i < sizeof(blob_mime_types) / sizeof(blob_mime_types[0]); i++)
+    if (strcasecmp(dot + 1, blob_mime_types[i].ext) == 0) return blob_mime_types[i].type;
+  return "";
+}
+
+static ant_value_t blob_stat_error(ant_t *js, const char *path, int rc) {
+  ant_value_t props = js_mkobj(js);
+  const char *code = uv_err_name(rc);
+
+  if (code) js_set(js, props, "code", js_mkstr(js, code, strlen(code)));
+  js_set(js, props, "errno", js_mknum((double)rc));
+  js_set(js, props, "syscall", js_mkstr(js, "stat", 4));
+  js_set(js, props, "path", js_mkstr(js, path, strlen(path)));
+  
+  return js_mkerr_props(js, JS_ERR_GENERIC, props, "%s: %s, stat '%s'", code ? code : "UNKNOWN", uv_strerror(rc), path);
+}
+
+// Ant.file(path, { type }) is a File whose bytes stay on disk until read
+static ant_value_t js_ant_file(ant_t *js, ant_value_t *args, int nargs) {
+  if (nargs < 1) return js_mkerr_typed(js, JS_ERR_TYPE, "Ant.file() requires a path");
+
+  ant_value_t path_v = args[0];
+  if (vtype(path_v) != T_STR) {
+    path_v = js_tostring_val(js, path_v);
+    if (is_err(path_v)) return path_v;
+  }
+  const char *path = js_getstr(js, path_v, NULL);
+
+  uv_fs_t req;
+  int rc = uv_fs_stat(NULL, &req, path, NULL);
+  uv_stat_t st = req.statbuf;
+  uv_fs_req_cleanup(&req);
+  
+  if (rc < 0) return blob_stat_error(js, path, rc);
+  if ((st.st_mode & S_IFMT) == S_IFDIR) return blob_stat_error(js, path, UV_EISDIR);
+
+  const char *name = blob_path_basename(path);
+  const char *type_str = blob_guess_type(name);
+  char *type_owned = NULL;
+
+  if (nargs >= 2 && is_object_type(args[1])) {
+    ant_value_t type_v = js_get(js, args[1], "type");
+    if (vtype(type_v) != T_UNDEF) {
+      if (vtype(type_v) != T_STR) {
+        type_v = js_tostring_val(js, type_v);
+        if (is_err(type_v)) return type_v;
+      }
+      type_owned = normalize_mime_type(js_getstr(js, type_v, NULL));
+      type_str = type_owned;
+    }
+  }
+
+  blob_data_t *bd = blob_data_new(NULL, (size_t)st.st_size, type_str);
+  free(type_owned);
+  if (!bd) return js_mkerr(js, "out of memory");
+
+  bd->path = strdup(path);
+  bd->name = strdup(name);
+  bd->last_modified = (int64_t)st.st_mtim.tv_sec * 1000LL + (int64_t)(st.st_mtim.tv_nsec / 1000000);
+
+  ant_value_t obj = js_mkobj(js);
+  js_set_proto_init(obj, js->builtins.file_proto);
+  js_set_slot(obj, SLOT_BRAND, js_mknum(BRAND_FILE));
+  js_set_native(obj, bd, BLOB_NATIVE_TAG);
+  js_set_finalizer(obj, blob_finalize);
+
+  return obj;
+}
+
 void init_blob_module(ant_t *js) {
   ant_value_t g = js_glob(js);
   js->builtins.blob_proto  = js_mkobj(js);
@@ -448,4 +910,6 @@ void init_blob_module(ant_t *js) {
   
   js_set(js, g, "File", file_ctor);
   js_set_descriptor(js, g, "File", 4, JS_DESC_W | JS_DESC_C);
+  
+  js_set(js, js->Ant, "file", js_mkfun(js_ant_file));
 }
@@ -10,6 +10,7 @@
 #include "utils.h"
 #include "errors.h"
 #include "base64.h"
+#include "simd.h"
 #include "internal.h"
 #include "gc/roots.h"
 #include "descriptors.h"
@@ -587,6 +588,10 @@ static ant_value_t typedarray_write_value(ant_t *js, TypedArrayData *ta_data, si
   }
 }
 
+ant_value_t buffer_typedarray_data_write_index(ant_t *js, TypedArrayData *ta_data, size_t index, ant_value_t value) {
+  return typedarray_write_value(js, ta_data, index, value);
+}
+
 static ant_value_t typedarray_index_getter(ant_t *js, ant_value_t obj, const char *key, size_t key_len) {
   if (key_len == 0 || key_len > 10) return js_mkundef();
   
@@ -2269,39 +2274,13 @@ static uint8_t *hex_decode(const char *data, size_t len, size_t *out_len) {
   uint8_t *decoded = malloc(alloc_len);
   if (!decoded) return NULL;
   
-  for (size_t i = 0; i < decoded_len; i++) {
-    unsigned char hi_ch = (unsigned char)data[i * 2];
-    unsigned char lo_ch = (unsigned char)data[i * 2 + 1];
-    int hi; int lo;
-    
-    if (hi_ch >= '0' && hi_ch <= '9') { hi = hi_ch - '0'; goto have_hi; }
-    if (hi_ch >= 'a' && hi_ch <= 'f') { hi = hi_ch - 'a' + 10; goto have_hi; }
-    if (hi_ch >= 'A' && hi_ch <= 'F') { hi = hi_ch - 'A' + 10; goto have_hi; }
-    goto fail;
-    
-  have_hi:
-    if (lo_ch >= '0' && lo_ch <= '9') { lo = lo_ch - '0'; goto have_lo; }
-    if (lo_ch >= 'a' && lo_ch <= 'f') { lo = lo_ch - 'a' + 10; goto have_lo; }
-    if (lo_ch >= 'A' && lo_ch <= 'F') { lo = lo_ch - 'A' + 10; goto have_lo; }
-    goto fail;
-    
-  have_lo:
-    decoded[i] = (uint8_t)((hi << 4) | lo);
+  if (simd_hex_decode(data, len, decoded) != decoded_len) {
+    free(decoded);
+    return NULL;
   }
   
   *out_len = decoded_len;
   return decoded;
-
-fail:
-  free(decoded);
-  return NULL;
-}
-
-static int hex_nibble(unsigned char ch) {
-  if (ch >= '0' && ch <= '9') return ch - '0';
-  if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
-  if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
-  return -1;
 }
 
 static uint8_t *hex_decode_node_prefix(const char *data, size_t len, size_t *out_len) {
@@ -2309,15 +2288,7 @@ static uint8_t *hex_decode_node_prefix(const char *data, size_t len, size_t *out
   uint8_t *decoded = malloc(max_len == 0 ? 1 : max_len);
   if (!decoded) return NULL;
 
-  size_t count = 0;
-  for (size_t i = 0; i + 1 < len; i += 2) {
-    int hi = hex_nibble((unsigned char)data[i]);
-    int lo = hex_nibble((unsigned char)data[i + 1]);
-    if (hi < 0 || lo < 0) break;
-    decoded[count++] = (uint8_t)((hi << 4) | lo);
-  }
-
-  *out_len = count;
+  *out_len = simd_hex_decode(data, len, decoded);
   return decoded;
 }
 
@@ -2376,7 +2347,7 @@ static ant_value_t js_uint8array_toHex(ant_t *js, ant_value_t *args, int nargs)
   char *hex = malloc(len * 2 + 1);
   
   if (!hex) return js_mkerr(js, "Failed to allocate hex string");
-  for (size_t i = 0; i < len; i++) snprintf(hex + i * 2, 3, "%02x", data[i]);
+  simd_hex_encode(data, len, hex);
 
   ant_value_t result = js_mkstr(js, hex, len * 2);
   free(hex);
@@ -2952,10 +2923,7 @@ static ant_value_t js_buffer_toString(ant_t *js, ant_value_t *args, int nargs) {
   } else if (encoding == ENC_HEX) {
     char *hex = malloc(len * 2 + 1);
     if (!hex) return js_mkerr(js, "Failed to allocate hex string");
-    
-    for (size_t i = 0; i < len; i++) {
-      snprintf(hex + i * 2, 3, "%02x", data[i]);
-    }
+    simd_hex_encode(data, len, hex);
     
     ant_value_t result = js_mkstr(js, hex, len * 2);
     free(hex);
@@ -3144,10 +3112,8 @@ static ant_value_t js_buffer_indexOf(ant_t *js, ant_value_t *args, int nargs) {
   if (vtype(search) == T_NUM) {
     if (start >= haystack_len) return js_mknum(-1);
     uint8_t needle = (uint8_t)js_to_uint32(js_getnum(search));
-    for (size_t i = start; i < haystack_len; i++) {
-      if (haystack[i] == needle) return js_mknum((double)i);
-    }
-    return js_mknum(-1);
+    const uint8_t *hit = memchr(haystack + start, needle, haystack_len - start);
+    return js_mknum(hit ? (double)(hit - haystack) : -1);
   }
 
   const uint8_t *needle = NULL;
@@ -3171,17 +3137,9 @@ static ant_value_t js_buffer_indexOf(ant_t *js, ant_value_t *args, int nargs) {
     return js_mknum(-1);
   }
 
-  size_t limit = haystack_len - needle_len;
-  uint8_t first = needle[0];
-  for (size_t i = start; i <= limit; i++) {
-    if (haystack[i] == first && (needle_len == 1 || memcmp(haystack + i, needle, needle_len) == 0)) {
-      if (owned_needle) free(owned_needle);
-      return js_mknum((double)i);
-    }
-  }
-
+  const uint8_t *hit = simd_find(haystack + start, haystack_len - start, needle, needle_len);
   if (owned_needle) free(owned_needle);
-  return js_mknum(-1);
+  return js_mknum(hit ? (double)(hit - haystack) : -1);
 }
 
 // Buffer.prototype.write(string, offset, length, encoding)
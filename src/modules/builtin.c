@@ -24,11 +24,13 @@
 #include "descriptors.h"
 
 #include "silver/engine.h"
+#include "silver/swarm.h"
 #include "modules/builtin.h"
 #include "modules/buffer.h"
 #include "modules/cjit.h"
 #include "modules/server.h"
 #include "modules/symbol.h"
+#include "net/resolver.h"
 
 static struct {
   ant_t *js;
@@ -254,7 +256,7 @@ static ant_value_t js_stats_fn(ant_t *js, ant_value_t *args, int nargs) {
     ant_object_t *head = pass == 0 ? js->objects : pass == 1 ? js->objects_old : js->permanent_objects;
     for (ant_object_t *obj = head; obj; obj = obj->next) {
       obj_count++;
-      obj_bytes += sizeof(ant_object_t);
+      obj_bytes += ant_object_class_size(ant_object_size_class(obj->inobj_limit));
       uint32_t inobj_limit = ant_object_inobj_limit(obj);
       if (obj->overflow_prop && obj->prop_count > inobj_limit)
         overflow_bytes += (obj->prop_count - inobj_limit) * sizeof(ant_value_t);
@@ -277,6 +279,16 @@ static ant_value_t js_stats_fn(ant_t *js, ant_value_t *args, int nargs) {
   js_set(js, alloc, "proxies", js_mknum((double)proxy_bytes));
   js_set(js, alloc, "exotic", js_mknum((double)exotic_bytes));
   js_set(js, alloc, "arrays", js_mknum((double)js->alloc_bytes.arrays));
+
+  ant_value_t obj_classes = js_mkarr(js);
+  for (uint32_t i = 0; i < ANT_OBJ_SIZE_CLASSES; i++) {
+    ant_value_t cls = js_newobj(js);
+    js_set(js, cls, "slots", js_mknum((double)ant_object_class_slots(i)));
+    js_set(js, cls, "live", js_mknum((double)js->obj_arenas[i].live_count));
+    js_set(js, cls, "committed", js_mknum((double)js->obj_arenas[i].committed));
+    js_arr_push(js, obj_classes, cls);
+  }
+  js_set(js, alloc, "objectClasses", obj_classes);
   
   size_t shape_bytes = ant_shape_total_bytes();
   js_set(js, alloc, "shapes", js_mknum((double)shape_bytes));
@@ -308,6 +320,51 @@ static ant_value_t js_stats_fn(ant_t *js, ant_value_t *args, int nargs) {
   js_set(js, intern, "count", js_mknum((double)intern_stats.count));
   js_set(js, intern, "bytes", js_mknum((double)intern_stats.bytes));
   js_set(js, result, "intern", intern);
+
+  ant_resolve_stats_t dns_stats = ant_resolve_stats();
+  ant_value_t dns = js_newobj(js);
+  
+  js_set(js, dns, "hits", js_mknum((double)dns_stats.hits));
+  js_set(js, dns, "misses", js_mknum((double)dns_stats.misses));
+  js_set(js, dns, "shared", js_mknum((double)dns_stats.shared));
+  js_set(js, dns, "entries", js_mknum((double)dns_stats.entries));
+  js_set(js, result, "dns", dns);
+
+  sv_lazy_stats_t lazy_stats = sv_lazy_stats();
+  ant_value_t lazy = js_newobj(js);
+  
+  js_set(js, lazy, "deferred", js_mknum((double)lazy_stats.deferred));
+  js_set(js, lazy, "compiled", js_mknum((double)lazy_stats.compiled));
+  js_set(js, lazy, "deferredBytes", js_mknum((double)lazy_stats.deferred_bytes));
+  js_set(js, lazy, "compiledBytes", js_mknum((double)lazy_stats.compiled_bytes));
+  js_set(js, result, "lazy", lazy);
+
+#ifdef ANT_JIT
+  sv_jit_stats_t jit_stats = sv_jit_stats(js);
+  ant_value_t jit = js_newobj(js);
+  
+  js_set(js, jit, "background", js_bool(jit_stats.background));
+  js_set(js, jit, "queueDepth", js_mknum((double)jit_stats.depth));
+  js_set(js, jit, "queued", js_mknum((double)jit_stats.queued));
+  js_set(js, jit, "installed", js_mknum((double)jit_stats.installed));
+  js_set(js, jit, "failed", js_mknum((double)jit_stats.failed));
+  js_set(js, jit, "compileMs", js_mknum((double)jit_stats.compile_ns / 1e6));
+  js_set(js, jit, "maxCompileMs", js_mknum((double)jit_stats.max_compile_ns / 1e6));
+  
+  sv_jit_code_stats_t code_stats = sv_jit_code_stats(js);
+  js_set(js, jit, "functions", js_mknum((double)code_stats.functions));
+  js_set(js, jit, "codeBytes", js_mknum((double)code_stats.code_bytes));
+  js_set(js, jit, "peakCodeBytes", js_mknum((double)code_stats.peak_code_bytes));
+  js_set(js, jit, "residentBytes", js_mknum((double)code_stats.resident_bytes));
+  js_set(js, jit, "budget", js_mknum((double)code_stats.budget));
+  js_set(js, jit, "spaces", js_mknum((double)code_stats.spaces));
+  js_set(js, jit, "evicted", js_mknum((double)code_stats.evicted));
+  js_set(js, jit, "collected", js_mknum((double)code_stats.collected));
+  js_set(js, jit, "reclaimedSpaces", js_mknum((double)code_stats.reclaimed_spaces));
+  js_set(js, jit, "reclaimedBytes", js_mknum((double)code_stats.reclaimed_bytes));
+  js_set(js, jit, "scalarObjects", js_mknum((double)code_stats.scalar_objects));
+  js_set(js, result, "jit", jit);
+#endif
   
   sv_vm_t *vm = sv_vm_get_active(js);
   if (vm) {
@@ -11,19 +11,112 @@
 #include <sys/socket.h>
 #include <netdb.h>
 #include <arpa/inet.h>
-#include <sys/select.h>
 #include <strings.h>
 #define dns_strncasecmp strncasecmp
 #endif
 
 #include "internal.h"
+#include "gc/modules.h"
+#include "net/resolver.h"
 
-#define DNS_CLASS_IN 1
 #define DNS_TYPE_A 1
 #define DNS_TYPE_TXT 16
 #define DNS_TYPE_AAAA 28
 #define DNS_TYPE_SRV 33
 
+typedef struct dns_request_s {
+  ant_t *js;
+  ant_value_t promise;
+  char *hostname;
+  int rrtype;
+  bool all;
+  struct dns_request_s *next;
+} dns_request_t;
+
+static dns_request_t *pending_requests = NULL;
+
+static dns_request_t *dns_request_new(ant_t *js, ant_value_t promise, const char *hostname) {
+  dns_request_t *req = calloc(1, sizeof(*req));
+  if (!req) return NULL;
+
+  req->hostname = strdup(hostname);
+  if (!req->hostname) {
+    free(req);
+    return NULL;
+  }
+
+  req->js = js;
+  req->promise = promise;
+  req->next = pending_requests;
+  pending_requests = req;
+
+  return req;
+}
+
+static void dns_request_free(dns_request_t *req) {
+  for (dns_request_t **it = &pending_requests; *it; it = &(*it)->next)
+    if (*it == req) { *it = req->next; break; }
+  free(req->hostname);
+  free(req);
+}
+
+static ant_value_t dns_address_object(ant_t *js, const struct sockaddr_storage *ss) {
+  char addr_str[INET6_ADDRSTRLEN];
+  ant_value_t result = js_mkobj(js);
+
+  if (ss->ss_family == AF_INET6) uv_ip6_name((const struct sockaddr_in6 *)ss, addr_str, sizeof(addr_str));
+  else uv_ip4_name((const struct sockaddr_in *)ss, addr_str, sizeof(addr_str));
+
+  js_set(js, result, "address", js_mkstr(js, addr_str, strlen(addr_str)));
+  js_set(js, result, "family", js_mknum(ss->ss_family == AF_INET6 ? 6 : 4));
+
+  return result;
+}
+
+static void dns_settle_lookup(ant_t *js, ant_value_t promise, const char *hostname, bool all, int status, const ant_addr_list_t *addrs) {
+  ant_value_t result = js_mkundef();
+
+  if (status != 0 || !addrs || addrs->count == 0) {
+    js_reject_promise(js, promise, js_mkerr(js, "getaddrinfo failed for '%s'", hostname));
+    return;
+  }
+
+  if (!all) {
+    js_resolve_promise(js, promise, dns_address_object(js, &addrs->addrs[0]));
+    return;
+  }
+
+  result = js_mkarr(js);
+  for (size_t i = 0; i < addrs->count; i++)
+    js_arr_push(js, result, dns_address_object(js, &addrs->addrs[i]));
+  js_resolve_promise(js, promise, result);
+}
+
+static void dns_lookup_cb(int status, const ant_addr_list_t *addrs, void *user_data) {
+  dns_request_t *req = (dns_request_t *)user_data;
+  dns_settle_lookup(req->js, req->promise, req->hostname, req->all, status, addrs);
+  dns_request_free(req);
+}
+
+static bool dns_lookup_options(ant_t *js, ant_value_t options, int *family, bool *all) {
+  ant_value_t family_v = options;
+
+  if (is_object_type(options)) {
+    family_v = js_get(js, options, "family");
+    *all = js_truthy(js, js_get(js, options, "all"));
+  }
+
+  if (vtype(family_v) == T_UNDEF || vtype(family_v) == T_NULL) return true;
+  if (vtype(family_v) != T_NUM) return false;
+
+  switch ((int)js_getnum(family_v)) {
+    case 0: *family = AF_UNSPEC; return true;
+    case 4: *family = AF_INET; return true;
+    case 6: *family = AF_INET6; return true;
+    default: return false;
+  }
+}
+
 static ant_value_t dns_promises_lookup(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 1) return js_mkerr(js, "hostname is required");
 
@@ -31,62 +124,37 @@ static ant_value_t dns_promises_lookup(ant_t *js, ant_value_t *args, int nargs)
   const char *hostname = js_getstr(js, args[0], &len);
   if (!hostname) return js_mkerr(js, "hostname must be a string");
 
-  struct addrinfo hints = {0}, *res = NULL;
-  hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_STREAM;
+  int family = AF_UNSPEC;
+  bool all = false;
+  if (nargs >= 2 && !dns_lookup_options(js, args[1], &family, &all))
+    return js_mkerr(js, "family must be 0, 4 or 6");
 
-  int err = getaddrinfo(hostname, NULL, &hints, &res);
-  if (err != 0 || !res) {
-    return js_mkerr(js, "getaddrinfo failed for '%s'", hostname);
-  }
+  uv_loop_t *loop = uv_default_loop();
+  ant_value_t promise = js_mkpromise(js);
+  ant_addr_list_t addrs;
 
-  char addr_str[INET6_ADDRSTRLEN];
-  int family = 0;
-
-  if (res->ai_family == AF_INET) {
-    struct sockaddr_in *sa = (struct sockaddr_in *)res->ai_addr;
-    inet_ntop(AF_INET, &sa->sin_addr, addr_str, sizeof(addr_str));
-    family = 4;
-  } else if (res->ai_family == AF_INET6) {
-    struct sockaddr_in6 *sa6 = (struct sockaddr_in6 *)res->ai_addr;
-    inet_ntop(AF_INET6, &sa6->sin6_addr, addr_str, sizeof(addr_str));
-    family = 6;
-  } else {
-    freeaddrinfo(res);
-    return js_mkerr(js, "unsupported address family");
+  int rc = ant_resolve_lookup_cached(loop, hostname, family, &addrs);
+  if (rc != UV_EAGAIN) {
+    dns_settle_lookup(js, promise, hostname, all, rc, &addrs);
+    return promise;
   }
 
-  freeaddrinfo(res);
+  dns_request_t *req = dns_request_new(js, promise, hostname);
+  if (!req) {
+    js_reject_promise(js, promise, js_mkerr(js, "Out of memory"));
+    return promise;
+  }
 
-  ant_value_t result = js_mkobj(js);
-  js_set(js, result, "address", js_mkstr(js, addr_str, strlen(addr_str)));
-  js_set(js, result, "family", js_mknum(family));
+  req->all = all;
+  rc = ant_resolve_lookup(loop, hostname, family, dns_lookup_cb, req);
+  if (rc != 0) {
+    dns_request_free(req);
+    dns_settle_lookup(js, promise, hostname, all, rc, NULL);
+  }
 
-  ant_value_t promise = js_mkpromise(js);
-  js_resolve_promise(js, promise, result);
   return promise;
 }
 
-typedef struct {
-  int done;
-  int status;
-  unsigned char *abuf;
-  int alen;
-} dns_query_result_t;
-
-static void dns_query_cb(void *arg, int status, int timeouts, unsigned char *abuf, int alen) {
-  (void)timeouts;
-  dns_query_result_t *result = (dns_query_result_t *)arg;
-  result->done = 1;
-  result->status = status;
-  result->alen = alen;
-  if (abuf && alen > 0) {
-    result->abuf = malloc((size_t)alen);
-    if (result->abuf) memcpy(result->abuf, abuf, (size_t)alen);
-    else result->status = ARES_ENOMEM;
-  }
-}
-
 static int dns_rrtype_from_value(ant_t *js, ant_value_t value) {
   if (vtype(value) == T_UNDEF) return DNS_TYPE_A;
   size_t len = 0;
@@ -105,22 +173,6 @@ static ant_value_t dns_rejected_promise(ant_t *js, const char *message) {
   return promise;
 }
 
-static bool dns_process_query(ares_channel_t *channel, dns_query_result_t *result) {
-  while (!result->done) {
-    fd_set read_fds, write_fds;
-    FD_ZERO(&read_fds);
-    FD_ZERO(&write_fds);
-    int nfds = ares_fds(channel, &read_fds, &write_fds);
-    if (nfds == 0) break;
-
-    struct timeval tv, *tvp = ares_timeout(channel, NULL, &tv);
-    int rc = select(nfds, &read_fds, &write_fds, NULL, tvp);
-    if (rc < 0) return false;
-    ares_process(channel, &read_fds, &write_fds);
-  }
-  return result->done;
-}
-
 static ant_value_t dns_parse_a(ant_t *js, const unsigned char *abuf, int alen) {
   struct hostent *host = NULL;
   int status = ares_parse_a_reply(abuf, alen, &host, NULL, NULL);
@@ -184,6 +236,28 @@ static ant_value_t dns_parse_txt(ant_t *js, const unsigned char *abuf, int alen)
   return arr;
 }
 
+static ant_value_t dns_parse_records(ant_t *js, int rrtype, const unsigned char *abuf, int alen) {
+  if (rrtype == DNS_TYPE_A) return dns_parse_a(js, abuf, alen);
+  if (rrtype == DNS_TYPE_AAAA) return dns_parse_aaaa(js, abuf, alen);
+  if (rrtype == DNS_TYPE_SRV) return dns_parse_srv(js, abuf, alen);
+  return dns_parse_txt(js, abuf, alen);
+}
+
+static void dns_query_cb(int status, const unsigned char *abuf, int alen, void *user_data) {
+  dns_request_t *req = (dns_request_t *)user_data;
+  ant_t *js = req->js;
+
+  if (status != ARES_SUCCESS) {
+    js_reject_promise(js, req->promise, js_mkerr(js, "%s", ares_strerror(status)));
+  } else {
+    ant_value_t records = dns_parse_records(js, req->rrtype, abuf, alen);
+    if (is_err(records)) js_reject_promise(js, req->promise, records);
+    else js_resolve_promise(js, req->promise, records);
+  }
+
+  dns_request_free(req);
+}
+
 static ant_value_t dns_promises_resolve(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 1) return dns_rejected_promise(js, "hostname is required");
 
@@ -194,43 +268,29 @@ static ant_value_t dns_promises_resolve(ant_t *js, ant_value_t *args, int nargs)
   int rrtype = dns_rrtype_from_value(js, nargs >= 2 ? args[1] : js_mkundef());
   if (rrtype < 0) return dns_rejected_promise(js, "unsupported DNS record type");
 
-  int init_status = ares_library_init(ARES_LIB_INIT_ALL);
-  if (init_status != ARES_SUCCESS)
-    return dns_rejected_promise(js, ares_strerror(init_status));
-
-  ares_channel_t *channel = NULL;
-  int status = ares_init(&channel);
-  if (status != ARES_SUCCESS) {
-    ares_library_cleanup();
-    return dns_rejected_promise(js, ares_strerror(status));
+  ant_value_t promise = js_mkpromise(js);
+  dns_request_t *req = dns_request_new(js, promise, hostname);
+  if (!req) {
+    js_reject_promise(js, promise, js_mkerr(js, "Out of memory"));
+    return promise;
   }
 
-  dns_query_result_t result = {0};
-  ares_query(channel, hostname, DNS_CLASS_IN, rrtype, dns_query_cb, &result);
-  if (!dns_process_query(channel, &result) && result.status == ARES_SUCCESS)
-    result.status = ARES_ETIMEOUT;
-
-  ant_value_t promise = js_mkpromise(js);
-  if (result.status != ARES_SUCCESS) {
-    js_reject_promise(js, promise, js_mkerr(js, "%s", ares_strerror(result.status)));
-  } else {
-    ant_value_t records;
-    if (rrtype == DNS_TYPE_A) records = dns_parse_a(js, result.abuf, result.alen);
-    else if (rrtype == DNS_TYPE_AAAA) records = dns_parse_aaaa(js, result.abuf, result.alen);
-    else if (rrtype == DNS_TYPE_SRV) records = dns_parse_srv(js, result.abuf, result.alen);
-    else records = dns_parse_txt(js, result.abuf, result.alen);
-
-    if (is_err(records)) js_reject_promise(js, promise, records);
-    else js_resolve_promise(js, promise, records);
+  // a cached answer settles the promise before ant_resolve_query returns
+  req->rrtype = rrtype;
+  int status = ant_resolve_query(uv_default_loop(), hostname, rrtype, dns_query_cb, req);
+  if (status != ARES_SUCCESS) {
+    dns_request_free(req);
+    js_reject_promise(js, promise, js_mkerr(js, "%s", ares_strerror(status)));
   }
 
-  free(result.abuf);
-  ares_destroy(channel);
-  ares_library_cleanup();
-  
   return promise;
 }
 
+void gc_mark_dns(ant_t *js, gc_mark_fn mark) {
+  for (dns_request_t *req = pending_requests; req; req = req->next)
+    mark(js, req->promise);
+}
+
 ant_value_t dns_library(ant_t *js) {
   ant_value_t lib = js_mkobj(js);
   ant_value_t promises = js_mkobj(js);
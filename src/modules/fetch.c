@@ -696,7 +696,7 @@ static bool fetch_handle_blob_url(fetch_request_t *req) {
   ant_value_t blob = url_resolve_object_url(js, url);
   blob_data_t *data = blob_is_blob(js, blob) ? blob_get_data(blob) : NULL;
   
-  if (!data) {
+  if (!data || !blob_load(data)) {
     free(url);
     fetch_reject(req, fetch_type_error(js, "Failed to fetch blob URL"));
     fetch_request_release(req);
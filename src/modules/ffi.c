@@ -28,6 +28,16 @@
 #include "modules/ffi.h"
 #include "modules/symbol.h"
 
+#ifdef ANT_JIT
+#include "silver/swarm.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmacro-redefined"
+#include <mir.h>
+#include <mir-gen.h>
+#pragma GCC diagnostic pop
+#endif
+
 enum {
   FFI_LIBRARY_NATIVE_TAG  = 0x4646494cu, // FFIL
   FFI_FUNCTION_NATIVE_TAG = 0x46464946u, // FFIF
@@ -80,6 +90,11 @@ typedef struct {
   ffi_cif cif;
   void *func_ptr;
   char *symbol_name;
+#ifdef ANT_JIT
+  uint32_t call_count;
+  bool stub_failed;
+  ant_cfunc_meta_t stub_meta;
+#endif
 } ffi_function_handle_t;
 
 typedef struct ffi_pointer_region_s {
@@ -1054,6 +1069,335 @@ ant_value_t ffi_library_call(ant_t *js, ant_value_t *args, int nargs) {
   return sv_vm_call(js->vm, js, fn, js_mkundef(), args + 1, nargs - 1, NULL, false);
 }
 
+#ifdef ANT_JIT
+static constexpr uint32_t FFI_STUB_THRESHOLD = 32;
+static constexpr size_t FFI_STUB_MAX_ARGS = 16;
+
+static const char *const ffi_stub_arg_names[FFI_STUB_MAX_ARGS] = {
+  "a0", "a1", "a2",  "a3",  "a4",  "a5",  "a6",  "a7",
+  "a8", "a9", "a10", "a11", "a12", "a13", "a14", "a15",
+};
+
+static int64_t ffi_stub_unbox_pointer(ant_t *js, ant_value_t value, void **out) {
+  return ffi_pointer_from_js(js, value, out, NULL) ? 1 : 0;
+}
+
+static ant_value_t ffi_stub_box_pointer(ant_t *js, void *ptr) {
+  return ffi_make_pointer_or_null(js, ptr);
+}
+
+static ant_value_t ffi_stub_box_string(ant_t *js, const char *str) {
+  return str ? js_mkstr(js, str, strlen(str)) : js_mknull();
+}
+
+static bool ffi_stub_supported(const ffi_function_handle_t *function) {
+  if (function->signature.variadic) return false;
+  if (function->signature.arg_count > FFI_STUB_MAX_ARGS) return false;
+  
+  for (size_t i = 0; i < function->signature.arg_count; i++) switch (function->signature.args[i].id) {
+    case FFI_VALUE_STRING:
+    case FFI_VALUE_VOID:
+    case FFI_VALUE_SPREAD:
+    case FFI_VALUE_UNKNOWN: return false;
+    default: break;
+  }
+
+  ffi_value_type_id_t ret = function->signature.returns.id;
+  return ret != FFI_VALUE_SPREAD && ret != FFI_VALUE_UNKNOWN;
+}
+
+static MIR_type_t ffi_stub_mir_type(ffi_value_type_id_t id) {
+  switch (id) {
+    case FFI_VALUE_FLOAT:   return MIR_T_F;
+    case FFI_VALUE_DOUBLE:  return MIR_T_D;
+    case FFI_VALUE_POINTER:
+    case FFI_VALUE_STRING:  return MIR_T_P;
+    default:                return MIR_T_I64;
+  }
+}
+
+static MIR_insn_code_t ffi_stub_ext_insn(ffi_value_type_id_t id) {
+  switch (id) {
+    case FFI_VALUE_INT8:   return MIR_EXT8;
+    case FFI_VALUE_INT16:  return MIR_EXT16;
+    case FFI_VALUE_INT:    return MIR_EXT32;
+    case FFI_VALUE_UINT8:  return MIR_UEXT8;
+    case FFI_VALUE_UINT16: return MIR_UEXT16;
+    default:               return MIR_MOV;
+  }
+}
+
+// compiles a direct-call trampoline with the cfunc ABI for one FFIFunction:
+// numeric and pointer arguments are unboxed inline and the native symbol is
+// called without libffi; anything unexpected falls back to ffi_function_call
+static ant_cfunc_t ffi_compile_stub(ant_t *js, ffi_function_handle_t *function) {
+  MIR_context_t ctx = sv_jit_stub_context(js);
+  if (!ctx) return NULL;
+
+  size_t argc = function->signature.arg_count;
+  ffi_value_type_id_t ret_id = function->signature.returns.id;
+  char name[64];
+
+  snprintf(name, sizeof(name), "ffi_stub_%p", (void *)function);
+  MIR_module_t mod = MIR_new_module(ctx, name);
+
+  MIR_type_t jsval_ret = MIR_T_I64;
+  MIR_item_t slow_proto = MIR_new_proto(ctx, "ffi_slow_proto",
+    1, &jsval_ret, 3, MIR_T_I64, "js", MIR_T_P, "args", MIR_T_I32, "argc");
+  MIR_item_t unbox_proto = MIR_new_proto(ctx, "ffi_unbox_proto",
+    1, &jsval_ret, 3, MIR_T_I64, "js", MIR_T_I64, "value", MIR_T_P, "out");
+  MIR_item_t box_proto = MIR_new_proto(ctx, "ffi_box_proto",
+    1, &jsval_ret, 2, MIR_T_I64, "js", MIR_T_P, "ptr");
+
+  MIR_var_t native_vars[FFI_STUB_MAX_ARGS];
+  for (size_t i = 0; i < argc; i++) native_vars[i] = (MIR_var_t){
+    .type = ffi_stub_mir_type(function->signature.args[i].id),
+    .name = ffi_stub_arg_names[i],
+  };
+  
+  MIR_type_t native_ret = ffi_stub_mir_type(ret_id);
+  MIR_item_t native_proto = MIR_new_proto_arr(ctx, "ffi_native_proto",
+    ret_id == FFI_VALUE_VOID ? 0 : 1, &native_ret, argc, native_vars);
+
+  MIR_item_t imp_slow = MIR_new_import(ctx, "ffi_function_call");
+  MIR_item_t imp_unbox = MIR_new_import(ctx, "ffi_stub_unbox_pointer");
+  MIR_item_t imp_box = MIR_new_import(ctx, 
+    ret_id == FFI_VALUE_STRING ? "ffi_stub_box_string" : "ffi_stub_box_pointer");
+
+  MIR_item_t stub = MIR_new_func(ctx, "ffi_stub",
+    1, &jsval_ret, 3, MIR_T_I64, "js", MIR_T_P, "args", MIR_T_I32, "argc");
+  MIR_func_t f = stub->u.func;
+
+  MIR_reg_t r_js = MIR_reg(ctx, "js", f);
+  MIR_reg_t r_args = MIR_reg(ctx, "args", f);
+  MIR_reg_t r_argc = MIR_reg(ctx, "argc", f);
+  MIR_reg_t r_raw = MIR_new_func_reg(ctx, f, MIR_T_I64, "raw");
+  MIR_reg_t r_d = MIR_new_func_reg(ctx, f, MIR_T_D, "dbl");
+  MIR_reg_t r_slot = MIR_new_func_reg(ctx, f, MIR_T_I64, "slot");
+  MIR_reg_t r_out = MIR_new_func_reg(ctx, f, MIR_T_I64, "out");
+  MIR_reg_t r_fn = MIR_new_func_reg(ctx, f, MIR_T_I64, "fn");
+  MIR_label_t slow = MIR_new_label(ctx);
+
+  MIR_op_t call_ops[FFI_STUB_MAX_ARGS + 3];
+  size_t nops = 0;
+
+  MIR_append_insn(ctx, stub,
+    MIR_new_insn(ctx, MIR_BNES,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, r_argc),
+      MIR_new_int_op(ctx, (int64_t)argc)));
+  MIR_append_insn(ctx, stub,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_raw),
+      MIR_new_int_op(ctx, (int64_t)(uintptr_t)&function->library->closed)));
+  MIR_append_insn(ctx, stub,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_raw),
+      MIR_new_mem_op(ctx, MIR_T_U8, 0, r_raw, 0, 1)));
+  MIR_append_insn(ctx, stub,
+    MIR_new_insn(ctx, MIR_BNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, r_raw),
+      MIR_new_int_op(ctx, 0)));
+  MIR_append_insn(ctx, stub,
+    MIR_new_insn(ctx, MIR_ALLOCA,
+      MIR_new_reg_op(ctx, r_slot),
+      MIR_new_int_op(ctx, 8)));
+
+  call_ops[nops++] = MIR_new_ref_op(ctx, native_proto);
+  call_ops[nops++] = MIR_new_reg_op(ctx, r_fn);
+  
+  MIR_reg_t r_ret = 0;
+  if (ret_id != FFI_VALUE_VOID) {
+    r_ret = MIR_new_func_reg(ctx, f, native_ret == MIR_T_P ? MIR_T_I64 : native_ret, "ret");
+    call_ops[nops++] = MIR_new_reg_op(ctx, r_ret);
+  }
+
+  for (size_t i = 0; i < argc; i++) {
+    ffi_value_type_id_t id = function->signature.args[i].id;
+    MIR_type_t reg_type = ffi_stub_mir_type(id);
+    MIR_reg_t r_arg = MIR_new_func_reg(ctx, f, 
+      reg_type == MIR_T_P ? MIR_T_I64 : reg_type, ffi_stub_arg_names[i]);
+    MIR_disp_t disp = (MIR_disp_t)(i * sizeof(ant_value_t));
+
+    MIR_append_insn(ctx, stub,
+      MIR_new_insn(ctx, MIR_MOV,
+        MIR_new_reg_op(ctx, r_raw),
+        MIR_new_mem_op(ctx, MIR_T_I64, disp, r_args, 0, 1)));
+
+    if (id == FFI_VALUE_POINTER) {
+      MIR_append_insn(ctx, stub,
+        MIR_new_call_insn(ctx, 6,
+          MIR_new_ref_op(ctx, unbox_proto),
+          MIR_new_ref_op(ctx, imp_unbox),
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_reg_op(ctx, r_js),
+          MIR_new_reg_op(ctx, r_raw),
+          MIR_new_reg_op(ctx, r_slot)));
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_BEQ,
+          MIR_new_label_op(ctx, slow),
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_int_op(ctx, 0)));
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_MOV,
+          MIR_new_reg_op(ctx, r_arg),
+          MIR_new_mem_op(ctx, MIR_T_P, 0, r_slot, 0, 1)));
+      call_ops[nops++] = MIR_new_reg_op(ctx, r_arg);
+      continue;
+    }
+
+    MIR_append_insn(ctx, stub,
+      MIR_new_insn(ctx, MIR_UBGT,
+        MIR_new_label_op(ctx, slow),
+        MIR_new_reg_op(ctx, r_raw),
+        MIR_new_uint_op(ctx, NANBOX_PREFIX)));
+    MIR_append_insn(ctx, stub,
+      MIR_new_insn(ctx, MIR_DMOV,
+        MIR_new_reg_op(ctx, id == FFI_VALUE_DOUBLE ? r_arg : r_d),
+        MIR_new_mem_op(ctx, MIR_T_D, disp, r_args, 0, 1)));
+
+    if (id == FFI_VALUE_FLOAT) MIR_append_insn(ctx, stub,
+      MIR_new_insn(ctx, MIR_D2F,
+        MIR_new_reg_op(ctx, r_arg),
+        MIR_new_reg_op(ctx, r_d)));
+    else if (id != FFI_VALUE_DOUBLE) {
+      if (id == FFI_VALUE_UINT64) MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_DBGE,
+          MIR_new_label_op(ctx, slow),
+          MIR_new_reg_op(ctx, r_d),
+          MIR_new_double_op(ctx, 9223372036854775808.0)));
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_D2I,
+          MIR_new_reg_op(ctx, r_arg),
+          MIR_new_reg_op(ctx, r_d)));
+      MIR_insn_code_t ext = ffi_stub_ext_insn(id);
+      if (ext != MIR_MOV) MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, ext,
+          MIR_new_reg_op(ctx, r_arg),
+          MIR_new_reg_op(ctx, r_arg)));
+    }
+    
+    call_ops[nops++] = MIR_new_reg_op(ctx, r_arg);
+  }
+
+  MIR_append_insn(ctx, stub,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_fn),
+      MIR_new_int_op(ctx, (int64_t)(uintptr_t)function->func_ptr)));
+  MIR_append_insn(ctx, stub, MIR_new_insn_arr(ctx, MIR_CALL, nops, call_ops));
+
+  switch (ret_id) {
+    case FFI_VALUE_VOID:
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_MOV,
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_uint_op(ctx, js_mkundef())));
+      break;
+    case FFI_VALUE_POINTER:
+    case FFI_VALUE_STRING:
+      MIR_append_insn(ctx, stub,
+        MIR_new_call_insn(ctx, 5,
+          MIR_new_ref_op(ctx, box_proto),
+          MIR_new_ref_op(ctx, imp_box),
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_reg_op(ctx, r_js),
+          MIR_new_reg_op(ctx, r_ret)));
+      break;
+    default: {
+      if (ret_id == FFI_VALUE_FLOAT) MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_F2D,
+          MIR_new_reg_op(ctx, r_d),
+          MIR_new_reg_op(ctx, r_ret)));
+      else if (ret_id == FFI_VALUE_DOUBLE) MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_DMOV,
+          MIR_new_reg_op(ctx, r_d),
+          MIR_new_reg_op(ctx, r_ret)));
+      else {
+        MIR_insn_code_t ext = ffi_stub_ext_insn(ret_id);
+        if (ext != MIR_MOV) MIR_append_insn(ctx, stub,
+          MIR_new_insn(ctx, ext,
+            MIR_new_reg_op(ctx, r_ret),
+            MIR_new_reg_op(ctx, r_ret)));
+        MIR_append_insn(ctx, stub,
+          MIR_new_insn(ctx, ret_id == FFI_VALUE_UINT64 ? MIR_UI2D : MIR_I2D,
+            MIR_new_reg_op(ctx, r_d),
+            MIR_new_reg_op(ctx, r_ret)));
+      }
+      
+      MIR_label_t boxed = MIR_new_label(ctx);
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_DMOV,
+          MIR_new_mem_op(ctx, MIR_T_D, 0, r_slot, 0, 1),
+          MIR_new_reg_op(ctx, r_d)));
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_MOV,
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_mem_op(ctx, MIR_T_I64, 0, r_slot, 0, 1)));
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_UBLE,
+          MIR_new_label_op(ctx, boxed),
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_uint_op(ctx, NANBOX_PREFIX)));
+      MIR_append_insn(ctx, stub,
+        MIR_new_insn(ctx, MIR_MOV,
+          MIR_new_reg_op(ctx, r_out),
+          MIR_new_uint_op(ctx, 0x7FF8000000000000ull)));
+      MIR_append_insn(ctx, stub, boxed);
+      break;
+    }
+  }
+  
+  MIR_append_insn(ctx, stub, MIR_new_ret_insn(ctx, 1, MIR_new_reg_op(ctx, r_out)));
+
+  MIR_append_insn(ctx, stub, slow);
+  MIR_append_insn(ctx, stub,
+    MIR_new_call_insn(ctx, 6,
+      MIR_new_ref_op(ctx, slow_proto),
+      MIR_new_ref_op(ctx, imp_slow),
+      MIR_new_reg_op(ctx, r_out),
+      MIR_new_reg_op(ctx, r_js),
+      MIR_new_reg_op(ctx, r_args),
+      MIR_new_reg_op(ctx, r_argc)));
+  MIR_append_insn(ctx, stub, MIR_new_ret_insn(ctx, 1, MIR_new_reg_op(ctx, r_out)));
+
+  MIR_finish_func(ctx);
+  MIR_finish_module(ctx);
+
+  MIR_load_external(ctx, "ffi_function_call", (void *)ffi_function_call);
+  MIR_load_external(ctx, "ffi_stub_unbox_pointer", (void *)ffi_stub_unbox_pointer);
+  MIR_load_external(ctx, "ffi_stub_box_pointer", (void *)ffi_stub_box_pointer);
+  MIR_load_external(ctx, "ffi_stub_box_string", (void *)ffi_stub_box_string);
+
+  MIR_load_module(ctx, mod);
+  MIR_link(ctx, MIR_set_gen_interface, NULL);
+  
+  return (ant_cfunc_t)MIR_gen(ctx, stub);
+}
+
+static void ffi_install_stub(ant_t *js, ffi_function_handle_t *function, ant_value_t fn) {
+  if (vtype(fn) != T_FUNC || !function->library || !ffi_stub_supported(function)) {
+    function->stub_failed = true;
+    return;
+  }
+
+  ant_cfunc_t stub = ffi_compile_stub(js, function);
+  if (!stub) {
+    function->stub_failed = true;
+    return;
+  }
+
+  function->stub_meta.fn = stub;
+  js_set_slot(js_func_obj(fn), SLOT_CFUNC, js_mkfun_meta(&function->stub_meta));
+
+  sv_closure_t *closure = js_func_closure(fn);
+  if (closure && !closure->func) {
+    closure->native_stub = stub;
+    closure->call_flags |= SV_CALL_HAS_NATIVE_STUB;
+  }
+}
+#endif
+
 ant_value_t ffi_function_call(ant_t *js, ant_value_t *args, int nargs) {
   ffi_function_handle_t *function = ffi_function_data(js->current_func);
   ffi_type **call_types = NULL;
@@ -1077,6 +1421,13 @@ ant_value_t ffi_function_call(ant_t *js, ant_value_t *args, int nargs) {
     return js_mkerr_typed(js, JS_ERR_TYPE, "FFIFunction '%s' belongs to a closed library", function->symbol_name);
   }
 
+#ifdef ANT_JIT
+  if (
+    !function->stub_meta.fn && !function->stub_failed &&
+    ++function->call_count >= FFI_STUB_THRESHOLD
+  ) ffi_install_stub(js, function, js->current_func);
+#endif
+
   if (!function->signature.variadic && nargs != (int)function->signature.arg_count) return js_mkerr_typed(
     js, JS_ERR_TYPE,
     "FFIFunction '%s' expects %zu arguments, got %d",
@@ -205,6 +205,7 @@ static ant_value_t extract_file_entry(
     if (nbd) {
       nbd->name = strdup(fname);
       nbd->last_modified = last_modified;
+      if (bd->path) { nbd->path = blob_path_dup(bd->path); nbd->offset = bd->offset; }
     }
     
     free(fname_owned);
@@ -13,25 +13,45 @@
 #include "modules/headers.h"
 #include "modules/symbol.h"
 
-typedef struct hdr_entry {
-  char *name;
+// entries stay in insertion order, entries sharing a name are chained
+// from the first one and the first ones are hashed once the list grows
+// past HDR_INDEX_MIN; lists are shared copy-on-write between Headers
+typedef struct {
+  const char *name;
   char *value;
-  struct hdr_entry *next;
+  size_t name_len;
+  uint32_t hash;
+  int32_t next;
+  int32_t tail;
+  bool known;
 } hdr_entry_t;
 
 typedef struct {
-  hdr_entry_t  *head;
-  hdr_entry_t **tail;
+  hdr_entry_t *entries;
+  uint32_t *index;
   size_t count;
+  size_t cap;
+  size_t index_cap;
+  size_t refs;
 } hdr_list_t;
 
+// a lowercased header name with its hash, well-known names resolve to
+// the interned strings below so entries never allocate for them
+typedef struct {
+  const char *name;
+  size_t len;
+  uint32_t hash;
+  bool known;
+  char *heap;
+  char buf[64];
+} hdr_key_t;
+
 typedef struct {
   char *name;
   char *value;
 } sorted_pair_t;
 
 typedef struct {
-  hdr_list_t *list;
   size_t index;
   int kind;
 } hdr_iter_t;
@@ -47,32 +67,241 @@ enum {
   HEADERS_ITER_NATIVE_TAG = 0x48444954u // HDIT
 };
 
+#define HDR_INDEX_MIN 8
+#define HDR_HASH_SEED 0x811ca6cau
+
+static const char *const hdr_known_names[] = {
+  "accept", "accept-charset", "accept-encoding", "accept-language", "accept-ranges",
+  "access-control-allow-credentials", "access-control-allow-headers",
+  "access-control-allow-methods", "access-control-allow-origin",
+  "access-control-expose-headers", "access-control-max-age",
+  "access-control-request-headers", "access-control-request-method", "age", "allow",
+  "alt-svc", "authorization", "baggage", "cache-control", "cdn-cache-control",
+  "connection", "content-disposition", "content-encoding", "content-language",
+  "content-length", "content-location", "content-range", "content-security-policy",
+  "content-security-policy-report-only", "content-type", "cookie",
+  "cross-origin-embedder-policy", "cross-origin-opener-policy",
+  "cross-origin-resource-policy", "date", "dnt", "early-data", "etag", "expect",
+  "expires", "forwarded", "from", "host", "if-match", "if-modified-since",
+  "if-none-match", "if-range", "if-unmodified-since", "keep-alive", "last-modified",
+  "link", "location", "max-forwards", "origin", "pragma", "priority",
+  "proxy-authenticate", "proxy-authorization", "range", "referer", "referrer-policy",
+  "refresh", "retry-after", "sec-fetch-dest", "sec-fetch-mode", "sec-fetch-site",
+  "sec-fetch-user", "sec-websocket-accept", "sec-websocket-extensions",
+  "sec-websocket-key", "sec-websocket-protocol", "sec-websocket-version", "server",
+  "server-timing", "set-cookie", "strict-transport-security", "te",
+  "timing-allow-origin", "traceparent", "tracestate", "trailer", "transfer-encoding",
+  "upgrade", "upgrade-insecure-requests", "user-agent", "vary", "via",
+  "www-authenticate", "x-content-type-options", "x-forwarded-for", "x-forwarded-host",
+  "x-forwarded-proto", "x-frame-options", "x-request-id", "x-requested-with"
+};
+
+// slot -> 1 + index into hdr_known_names, collision free for seed 0x811ca6ca
+static const uint8_t hdr_known_slots[512] = {
+   0, 62,  0,  0,  0,  0,  0,  0,  0, 72, 15, 11,  0, 49,  0, 83,
+   0,  0,  0,  0, 89,  0,  0,  0,  0,  0,  0,  0, 56, 43,  0, 81,
+   0, 55, 80,  0, 45,  0,  0,  0, 29, 86,  0,  0,  0,  0,  0, 51,
+   0,  0,  0,  0,  0,  0,  0, 59,  0,  0,  0,  0,  0,  0, 74,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 47,  0,  0,  0,  0,  0,
+   0,  0, 69,  0, 26, 39, 22,  0,  0,  8,  0,  0,  0,  0, 77,  0,
+   0,  0,  0, 32,  0, 20,  0,  0,  0, 40,  0,  0,  0,  0,  0,  0,
+  75,  0, 33,  9,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 79,  0,
+   0, 57,  0,  0,  0,  0,  0, 67,  0,  0,  0,  0, 66,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0, 13, 38,  0,  0,  0,  0,  0, 41,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0, 90,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0, 63,  0,  0,  0,  0,  0,  0,  0,  0, 82,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0, 44,  0,  0,  0,  0, 31,  0,  0,
+   0, 60,  0, 73,  0,  0,  0, 24,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0, 52,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 36,
+   0, 10,  0,  0,  0, 91,  0,  0,  0,  0, 25,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  5,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0, 19,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+  70, 85,  0,  0,  0,  0,  0,  0, 87,  0, 76,  0, 12,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0,  0, 95, 54, 64,  0,  0,  0,  0,  0,
+   0,  0,  0,  0,  0,  0,  0, 30,  0,  0, 48,  0,  0, 93,  0,  0,
+   0,  0,  0,  0,  0, 65, 50,  0,  0,  0,  0,  7,  0,  0,  0,  0,
+   0,  0,  0, 18,  0,  0,  0,  0,  0,  0,  0, 61,  0,  2,  0,  0,
+   0,  0,  0, 88,  3,  0,  0,  0,  0,  0,  0, 94,  0,  0,  0,  0,
+  71,  6,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+   0,  0, 17,  0,  0,  0, 21,  0,  0,  0,  0,  0, 53, 34, 37,  0,
+   0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  4,  0,  0,  0,
+   0,  0,  0,  0,  0, 58, 84,  0,  0,  0,  0, 78,  0,  0,  0,  0,
+  28,  0,  0,  0,  0,  0,  0, 92, 68,  0,  0,  0,  0,  0, 46, 16,
+   0,  0, 23,  0, 35,  0,  0,  0,  0, 42,  0,  0,  0,  0, 14,  0,
+   0,  0,  0,  0,  0,  1,  0,  0,  0, 27,  0,  0,  0,  0,  0,  0
+};
+
+static bool hdr_key_init(hdr_key_t *k, const char *name) {
+  size_t len = name ? strlen(name) : 0;
+  char *out = k->buf;
+  uint32_t h = HDR_HASH_SEED;
+
+  k->heap = NULL;
+  if (len >= sizeof(k->buf) && !(out = k->heap = malloc(len + 1))) return false;
+
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = (unsigned char)tolower((unsigned char)name[i]);
+    out[i] = (char)c;
+    h = (h ^ c) * 16777619u;
+  }
+  out[len] = '\0';
+
+  uint8_t id = hdr_known_slots[(h ^ (h >> 16)) & 511];
+  k->known = id && strcmp(hdr_known_names[id - 1], out) == 0;
+  k->name = k->known ? hdr_known_names[id - 1] : out;
+  k->len = len;
+  k->hash = h;
+  
+  return true;
+}
+
+static void hdr_key_clear(hdr_key_t *k) {
+  free(k->heap);
+}
+
+static bool hdr_key_is(const hdr_key_t *k, const char *lower) {
+  return strcmp(k->name, lower) == 0;
+}
+
 static hdr_list_t *list_new(void) {
   hdr_list_t *l = ant_calloc(sizeof(hdr_list_t));
   if (!l) return NULL;
-  l->head = NULL;
-  l->tail = &l->head;
+  l->refs = 1;
   return l;
 }
 
+static void entry_free(hdr_entry_t *e) {
+  if (!e->known) free((char *)e->name);
+  free(e->value);
+}
+
 static void list_free(hdr_list_t *l) {
   if (!l) return;
-  for (hdr_entry_t *e = l->head; e; ) {
-    hdr_entry_t *n = e->next;
-    free(e->name); free(e->value); free(e);
-    e = n;
-  }
+  for (size_t i = 0; i < l->count; i++) entry_free(&l->entries[i]);
+  free(l->entries);
+  free(l->index);
   free(l);
 }
 
+static void list_release(hdr_list_t *l) {
+  if (l && --l->refs == 0) list_free(l);
+}
+
+static inline bool entry_matches(const hdr_entry_t *e, const hdr_key_t *k) {
+  return 
+    e->hash == k->hash && e->name_len == k->len &&
+    (e->name == k->name || memcmp(e->name, k->name, k->len) == 0);
+}
+
+// index of the first entry with this name, or -1
+static int32_t list_find(const hdr_list_t *l, const hdr_key_t *k) {
+  if (!l->index) {
+    for (size_t i = 0; i < l->count; i++)
+      if (entry_matches(&l->entries[i], k)) return (int32_t)i;
+    return -1;
+  }
+
+  size_t mask = l->index_cap - 1;
+  for (size_t s = k->hash & mask; l->index[s]; s = (s + 1) & mask) {
+    const hdr_entry_t *e = &l->entries[l->index[s] - 1];
+    if (entry_matches(e, k)) return (int32_t)(l->index[s] - 1);
+  }
+  
+  return -1;
+}
+
+static void list_index_insert(hdr_list_t *l, size_t i) {
+  size_t mask = l->index_cap - 1;
+  size_t s = l->entries[i].hash & mask;
+  while (l->index[s]) s = (s + 1) & mask;
+  l->index[s] = (uint32_t)i + 1;
+}
+
+static void list_reindex(hdr_list_t *l) {
+  free(l->index);
+  l->index = NULL;
+  l->index_cap = 0;
+
+  if (l->count > HDR_INDEX_MIN) {
+    size_t cap = 16;
+    while (cap < l->count * 2) cap *= 2;
+    l->index = calloc(cap, sizeof(uint32_t));
+    if (l->index) l->index_cap = cap;
+  }
+
+  for (size_t i = 0; i < l->count; i++) {
+    hdr_entry_t *e = &l->entries[i];
+    hdr_key_t k = { .name = e->name, .len = e->name_len, .hash = e->hash };
+    int32_t head = list_find(l, &k);
+    
+    e->next = -1;
+    e->tail = (int32_t)i;
+    
+    if (head < 0 || head == (int32_t)i) {
+      if (l->index) list_index_insert(l, i);
+      continue;
+    }
+    
+    l->entries[l->entries[head].tail].next = (int32_t)i;
+    l->entries[head].tail = (int32_t)i;
+  }
+}
+
+static hdr_list_t *list_clone(const hdr_list_t *src) {
+  hdr_list_t *l = list_new();
+  if (!l) return NULL;
+  if (src->count == 0) return l;
+
+  l->entries = malloc(src->count * sizeof(hdr_entry_t));
+  if (!l->entries) goto fail;
+  l->cap = src->count;
+
+  for (size_t i = 0; i < src->count; i++) {
+    hdr_entry_t e = src->entries[i];
+    char *value = strdup(e.value);
+    char *name = e.known ? NULL : strndup(e.name, e.name_len);
+    
+    if (!value || (!e.known && !name)) {
+      free(value);
+      free(name);
+      goto fail;
+    }
+    
+    e.value = value;
+    if (!e.known) e.name = name;
+    l->entries[l->count++] = e;
+  }
+
+  list_reindex(l);
+  return l;
+
+fail:
+  list_free(l);
+  return NULL;
+}
+
 static hdr_list_t *get_list(ant_value_t obj) {
   return (hdr_list_t *)js_get_native(obj, HEADERS_NATIVE_TAG);
 }
 
+// the list of a Headers object about to be written, unshared first
+static hdr_list_t *get_list_mut(ant_value_t obj) {
+  hdr_list_t *l = get_list(obj);
+  if (!l || l->refs == 1) return l;
+
+  hdr_list_t *copy = list_clone(l);
+  if (!copy) return NULL;
+  
+  l->refs--;
+  js_set_native(obj, copy, HEADERS_NATIVE_TAG);
+  
+  return copy;
+}
+
 static void headers_finalize(ant_t *js, ant_object_t *obj) {
   ant_value_t value = js_obj_from_ptr(obj);
-  hdr_list_t *list = get_list(value);
-  list_free(list);
+  list_release(get_list(value));
   js_clear_native(value, HEADERS_NATIVE_TAG);
 }
 
@@ -132,44 +361,91 @@ static char *normalize_value(const char *s) {
   return out;
 }
 
-static char *lowercase_dup(const char *s) {
-  if (!s) return strdup("");
-  size_t len = strlen(s);
-  char *out = malloc(len + 1);
-  if (!out) return NULL;
-  for (size_t i = 0; i <= len; i++)
-    out[i] = (char)tolower((unsigned char)s[i]);
-  return out;
-}
-
 static ant_value_t headers_require_mutable(ant_t *js, ant_value_t headers) {
   if (!headers_is_immutable(headers)) return js_mkundef();
   return js_mkerr_typed(js, JS_ERR_TYPE, "Headers are immutable");
 }
 
-static void list_append_raw(hdr_list_t *l, const char *lower_name, const char *value) {
-  hdr_entry_t *e = ant_calloc(sizeof(hdr_entry_t));
-  if (!e) return;
-  e->name  = strdup(lower_name);
-  e->value = strdup(value);
-  *l->tail = e;
-  l->tail  = &e->next;
-  l->count++;
-}
-
-static void list_delete_name(hdr_list_t *l, const char *lower_name) {
-  hdr_entry_t **pp = &l->head;
-  l->tail = &l->head;
-  while (*pp) {
-  if (strcmp((*pp)->name, lower_name) == 0) {
-    hdr_entry_t *dead = *pp;
-    *pp = dead->next;
-    free(dead->name); free(dead->value); free(dead);
-    l->count--;
-  } else {
-    l->tail = &(*pp)->next;
-    pp = &(*pp)->next;
-  }}
+static bool list_append_raw(hdr_list_t *l, const hdr_key_t *k, const char *value) {
+  if (l->count == l->cap) {
+    size_t nc = l->cap ? l->cap * 2 : 8;
+    hdr_entry_t *ne = realloc(l->entries, nc * sizeof(hdr_entry_t));
+    if (!ne) return false;
+    l->entries = ne;
+    l->cap = nc;
+  }
+
+  hdr_entry_t e = {
+    .name = k->known ? k->name : strndup(k->name, k->len),
+    .value = strdup(value),
+    .name_len = k->len,
+    .hash = k->hash,
+    .next = -1,
+    .tail = (int32_t)l->count,
+    .known = k->known,
+  };
+  
+  if (!e.name || !e.value) {
+    entry_free(&e);
+    return false;
+  }
+
+  int32_t head = list_find(l, k);
+  size_t i = l->count++;
+  l->entries[i] = e;
+
+  if (head >= 0) {
+    l->entries[l->entries[head].tail].next = (int32_t)i;
+    l->entries[head].tail = (int32_t)i;
+  } else if (l->count > HDR_INDEX_MIN && l->count * 2 > l->index_cap) list_reindex(l);
+  else if (l->index) list_index_insert(l, i);
+  
+  return true;
+}
+
+static void list_delete_name(hdr_list_t *l, const hdr_key_t *k) {
+  int32_t head = list_find(l, k);
+  if (head < 0) return;
+
+  size_t w = (size_t)head;
+  for (size_t i = (size_t)head; i < l->count; i++) {
+    hdr_entry_t *e = &l->entries[i];
+    if (entry_matches(e, k)) entry_free(e);
+    else l->entries[w++] = *e;
+  }
+  
+  l->count = w;
+  list_reindex(l);
+}
+
+// the combined value for a name, set-cookie is never combined per Fetch spec
+static ant_value_t list_get_value(ant_t *js, const hdr_list_t *l, const hdr_key_t *k) {
+  int32_t head = list_find(l, k);
+  if (head < 0) return js_mknull();
+
+  const hdr_entry_t *first = &l->entries[head];
+  if (first->next < 0 || hdr_key_is(k, "set-cookie"))
+    return js_mkstr(js, first->value, strlen(first->value));
+
+  size_t total = 0;
+  for (int32_t i = head; i >= 0; i = l->entries[i].next)
+    total += strlen(l->entries[i].value) + 2;
+
+  char *combined = malloc(total);
+  if (!combined) return js_mkerr(js, "out of memory");
+
+  size_t pos = 0;
+  for (int32_t i = head; i >= 0; i = l->entries[i].next) {
+    if (pos > 0) { combined[pos++] = ','; combined[pos++] = ' '; }
+    size_t vl = strlen(l->entries[i].value);
+    memcpy(combined + pos, l->entries[i].value, vl);
+    pos += vl;
+  }
+
+  ant_value_t ret = js_mkstr(js, combined, pos);
+  free(combined);
+  
+  return ret;
 }
 
 static int cmp_pairs(const void *a, const void *b) {
@@ -184,9 +460,9 @@ static sorted_pair_t *build_sorted_view(hdr_list_t *l, size_t *out) {
   if (!raw) return NULL;
 
   size_t n = 0;
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    raw[n].name  = e->name;
-    raw[n].value = e->value;
+  for (size_t i = 0; i < l->count; i++) {
+    raw[n].name  = (char *)l->entries[i].name;
+    raw[n].value = l->entries[i].value;
     n++;
   }
   
@@ -245,46 +521,49 @@ static ant_value_t headers_append_name_value(ant_t *js, hdr_list_t *l, const cha
     return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid header value");
   }
 
-  char *lower = lowercase_dup(name);
-  if (!lower) { free(norm); return js_mkerr(js, "out of memory"); }
+  hdr_key_t key;
+  if (!hdr_key_init(&key, name)) { free(norm); return js_mkerr(js, "out of memory"); }
 
-  list_append_raw(l, lower, norm);
-  free(lower); free(norm);
-  return js_mkundef();
+  bool ok = list_append_raw(l, &key, norm);
+  hdr_key_clear(&key);
+  free(norm);
+  
+  return ok ? js_mkundef() : js_mkerr(js, "out of memory");
 }
 
-static ant_value_t headers_append_pair(ant_t *js, hdr_list_t *l, ant_value_t name_v, ant_value_t value_v) {
-  const char *name = NULL;
-  const char *value = NULL;
-
-  if (vtype(name_v) != T_STR) {
-    name_v = js_tostring_val(js, name_v);
-    if (is_err(name_v)) return name_v;
+static ant_value_t headers_pair_strings(ant_t *js, ant_value_t *name_v, ant_value_t *value_v) {
+  if (vtype(*name_v) != T_STR) {
+    *name_v = js_tostring_val(js, *name_v);
+    if (is_err(*name_v)) return *name_v;
   }
   
-  if (vtype(value_v) != T_STR) {
-    value_v = js_tostring_val(js, value_v);
-    if (is_err(value_v)) return value_v;
+  if (vtype(*value_v) != T_STR) {
+    *value_v = js_tostring_val(js, *value_v);
+    if (is_err(*value_v)) return *value_v;
   }
+  
+  return js_mkundef();
+}
 
-  name = js_getstr(js, name_v, NULL);
-  value = js_getstr(js, value_v, NULL);
-  return headers_append_name_value(js, l, name, value);
+static ant_value_t headers_append_pair(ant_t *js, hdr_list_t *l, ant_value_t name_v, ant_value_t value_v) {
+  ant_value_t r = headers_pair_strings(js, &name_v, &value_v);
+  if (is_err(r)) return r;
+  return headers_append_name_value(js, l, js_getstr(js, name_v, NULL), js_getstr(js, value_v, NULL));
 }
 
 ant_value_t headers_append_value(ant_t *js, ant_value_t hdrs, ant_value_t name_v, ant_value_t value_v) {
-  hdr_list_t *l = get_list(hdrs);
-  ant_value_t r = 0;
+  ant_value_t r = headers_pair_strings(js, &name_v, &value_v);
+  if (is_err(r)) return r;
 
+  // resolved after the conversions, they may run code that shares the list
+  hdr_list_t *l = get_list_mut(hdrs);
   if (!l) return js_mkerr(js, "Invalid Headers object");
-  r = headers_append_pair(js, l, name_v, value_v);
   
-  if (is_err(r)) return r;
-  return js_mkundef();
+  return headers_append_name_value(js, l, js_getstr(js, name_v, NULL), js_getstr(js, value_v, NULL));
 }
 
 ant_value_t headers_append_literal(ant_t *js, ant_value_t hdrs, const char *name, const char *value) {
-  hdr_list_t *l = get_list(hdrs);
+  hdr_list_t *l = get_list_mut(hdrs);
   ant_value_t r = 0;
 
   if (!l) return js_mkerr(js, "Invalid Headers object");
@@ -338,7 +617,8 @@ bool advance_headers(ant_t *js, js_iter_t *it, ant_value_t *out) {
   if (!st) return false;
 
   size_t count = 0;
-  sorted_pair_t *view = build_sorted_view(st->list, &count);
+  hdr_list_t *l = get_list(js_get_slot(it->iterator, SLOT_AUX));
+  sorted_pair_t *view = build_sorted_view(l, &count);
 
   if (st->index >= count) {
     free_sorted_view(view, count);
@@ -376,8 +656,7 @@ static ant_value_t make_headers_iter(ant_t *js, ant_value_t headers_obj, int kin
   hdr_iter_t *st = ant_calloc(sizeof(hdr_iter_t));
   if (!st) return js_mkerr(js, "out of memory");
   
-  st->list  = l;
-  st->kind  = kind;
+  st->kind = kind;
 
   ant_value_t iter = js_mkobj(js);
   js_set_proto_init(iter, js->builtins.headers_iter_proto);
@@ -390,13 +669,11 @@ static ant_value_t make_headers_iter(ant_t *js, ant_value_t headers_obj, int kin
 
 static ant_value_t js_headers_append(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 2) return js_mkerr_typed(js, JS_ERR_TYPE, "Headers.append requires 2 arguments");
-  hdr_list_t *l = get_list(js->this_val);
+  if (!get_list(js->this_val)) return js_mkerr(js, "Invalid Headers object");
   
-  if (!l) return js_mkerr(js, "Invalid Headers object");
   ant_value_t guard_err = headers_require_mutable(js, js->this_val);
-  
   if (is_err(guard_err)) return guard_err;
-  ant_value_t r = headers_append_pair(js, l, args[0], args[1]);
+  ant_value_t r = headers_append_value(js, js->this_val, args[0], args[1]);
   
   if (is_err(r)) return r;
   return js_mkundef();
@@ -404,9 +681,7 @@ static ant_value_t js_headers_append(ant_t *js, ant_value_t *args, int nargs) {
 
 static ant_value_t js_headers_set(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 2) return js_mkerr_typed(js, JS_ERR_TYPE, "Headers.set requires 2 arguments");
-  hdr_list_t *l = get_list(js->this_val);
-  
-  if (!l) return js_mkerr(js, "Invalid Headers object");
+  if (!get_list(js->this_val)) return js_mkerr(js, "Invalid Headers object");
   ant_value_t guard_err = headers_require_mutable(js, js->this_val);
   if (is_err(guard_err)) return guard_err;
 
@@ -425,104 +700,60 @@ static ant_value_t js_headers_set(ant_t *js, ant_value_t *args, int nargs) {
   if (!norm) return js_mkerr(js, "out of memory");
   if (!is_valid_value(norm)) { free(norm); return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid header value"); }
 
-  char *lower = lowercase_dup(name);
-  if (!lower) { free(norm); return js_mkerr(js, "out of memory"); }
+  hdr_key_t key;
+  hdr_list_t *l = get_list_mut(js->this_val);
+  if (!l || !hdr_key_init(&key, name)) { free(norm); return js_mkerr(js, "out of memory"); }
 
-  list_delete_name(l, lower);
-  list_append_raw(l, lower, norm);
+  list_delete_name(l, &key);
+  bool ok = list_append_raw(l, &key, norm);
   
-  free(lower); 
+  hdr_key_clear(&key);
   free(norm);
   
-  return js_mkundef();
+  return ok ? js_mkundef() : js_mkerr(js, "out of memory");
 }
 
 static ant_value_t js_headers_get(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 1) return js_mkerr_typed(js, JS_ERR_TYPE, "Headers.get requires 1 argument");
-  hdr_list_t *l = get_list(js->this_val);
-  if (!l) return js_mknull();
+  if (!get_list(js->this_val)) return js_mknull();
 
   ant_value_t name_v = args[0];
   if (vtype(name_v) != T_STR) { name_v = js_tostring_val(js, name_v); if (is_err(name_v)) return name_v; }
   const char *name = js_getstr(js, name_v, NULL);
   if (!is_valid_name(name)) return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid header name");
 
-  char *lower = lowercase_dup(name);
-  if (!lower) return js_mkerr(js, "out of memory");
-
-  // set-cookie is never combined per Fetch spec
-  if (strcmp(lower, "set-cookie") == 0) {
-    for (hdr_entry_t *e = l->head; e; e = e->next) {
-      if (strcmp(e->name, lower) == 0) {
-        ant_value_t ret = js_mkstr(js, e->value, strlen(e->value));
-        free(lower);
-        return ret;
-      }
-    }
-    free(lower);
-    return js_mknull();
-  }
-
-  size_t total = 0;
-  int count = 0;
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, lower) == 0) {
-      if (count > 0) total += 2;
-      total += strlen(e->value);
-      count++;
-    }
-  }
-
-  if (count == 0) { free(lower); return js_mknull(); }
-
-  char *combined = malloc(total + 1);
-  if (!combined) { free(lower); return js_mkerr(js, "out of memory"); }
-
-  size_t pos = 0;
-  int seen = 0;
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, lower) == 0) {
-      if (seen > 0) { combined[pos++] = ','; combined[pos++] = ' '; }
-      size_t vl = strlen(e->value);
-      memcpy(combined + pos, e->value, vl);
-      pos += vl;
-      seen++;
-    }
-  }
-  combined[pos] = '\0';
-  free(lower);
-
-  ant_value_t ret = js_mkstr(js, combined, pos);
-  free(combined);
+  hdr_key_t key;
+  hdr_list_t *l = get_list(js->this_val);
+  if (!hdr_key_init(&key, name)) return js_mkerr(js, "out of memory");
+  
+  ant_value_t ret = list_get_value(js, l, &key);
+  hdr_key_clear(&key);
+  
   return ret;
 }
 
 static ant_value_t js_headers_has(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 1) return js_mkerr_typed(js, JS_ERR_TYPE, "Headers.has requires 1 argument");
-  hdr_list_t *l = get_list(js->this_val);
-  if (!l) return js_false;
+  if (!get_list(js->this_val)) return js_false;
 
   ant_value_t name_v = args[0];
   if (vtype(name_v) != T_STR) { name_v = js_tostring_val(js, name_v); if (is_err(name_v)) return name_v; }
   const char *name = js_getstr(js, name_v, NULL);
   if (!is_valid_name(name)) return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid header name");
 
-  char *lower = lowercase_dup(name);
-  if (!lower) return js_mkerr(js, "out of memory");
+  hdr_key_t key;
+  hdr_list_t *l = get_list(js->this_val);
+  if (!hdr_key_init(&key, name)) return js_mkerr(js, "out of memory");
 
-  bool found = false;
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, lower) == 0) { found = true; break; }
-  }
-  free(lower);
+  bool found = list_find(l, &key) >= 0;
+  hdr_key_clear(&key);
+  
   return js_bool(found);
 }
 
 static ant_value_t js_headers_delete(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 1) return js_mkerr_typed(js, JS_ERR_TYPE, "Headers.delete requires 1 argument");
-  hdr_list_t *l = get_list(js->this_val);
-  
-  if (!l) return js_mkundef();
+  if (!get_list(js->this_val)) return js_mkundef();
   ant_value_t guard_err = headers_require_mutable(js, js->this_val);
   if (is_err(guard_err)) return guard_err;
 
@@ -531,10 +762,12 @@ static ant_value_t js_headers_delete(ant_t *js, ant_value_t *args, int nargs) {
   const char *name = js_getstr(js, name_v, NULL);
   if (!is_valid_name(name)) return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid header name");
 
-  char *lower = lowercase_dup(name);
-  if (!lower) return js_mkerr(js, "out of memory");
-  list_delete_name(l, lower);
-  free(lower);
+  hdr_key_t key;
+  if (!hdr_key_init(&key, name)) return js_mkerr(js, "out of memory");
+  
+  hdr_list_t *l = get_list(js->this_val);
+  if (list_find(l, &key) >= 0 && (l = get_list_mut(js->this_val))) list_delete_name(l, &key);
+  hdr_key_clear(&key);
   
   return js_mkundef();
 }
@@ -542,11 +775,12 @@ static ant_value_t js_headers_delete(ant_t *js, ant_value_t *args, int nargs) {
 static ant_value_t js_headers_get_set_cookie(ant_t *js, ant_value_t *args, int nargs) {
   hdr_list_t *l = get_list(js->this_val);
   ant_value_t arr = js_mkarr(js);
-  if (!l) return arr;
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, "set-cookie") == 0)
-      js_arr_push(js, arr, js_mkstr(js, e->value, strlen(e->value)));
-  }
+  hdr_key_t key;
+  
+  if (!l || !hdr_key_init(&key, "set-cookie")) return arr;
+  for (int32_t i = list_find(l, &key); i >= 0; i = l->entries[i].next)
+    js_arr_push(js, arr, js_mkstr(js, l->entries[i].value, strlen(l->entries[i].value)));
+  
   return arr;
 }
 
@@ -621,7 +855,8 @@ static ant_value_t headers_inspect(ant_t *js, ant_value_t *args, int nargs) {
 
   if (!list) return js_mkerr(js, "Invalid Headers object");
 
-  for (hdr_entry_t *e = list->head; e; e = e->next) {
+  for (size_t i = 0; i < list->count; i++) {
+    const hdr_entry_t *e = &list->entries[i];
     ant_value_t existing = js_get(js, out, e->name);
     if (vtype(existing) == T_UNDEF) {
       js_set(js, out, e->name, js_mkstr(js, e->value, strlen(e->value)));
@@ -705,10 +940,23 @@ bool headers_copy_from(ant_t *js, ant_value_t dst, ant_value_t src) {
   hdr_list_t *dst_list = get_list(dst);
   
   if (!dst_list) return false;
-  if (!src_list) return true;
+  if (!src_list || src_list == dst_list) return true;
+
+  // an empty destination just shares the source until either is written
+  if (dst_list->count == 0) {
+    src_list->refs++;
+    list_release(dst_list);
+    js_set_native(dst, src_list, HEADERS_NATIVE_TAG);
+    return true;
+  }
+
+  if (!(dst_list = get_list_mut(dst))) return false;
+  for (size_t i = 0; i < src_list->count; i++) {
+    const hdr_entry_t *e = &src_list->entries[i];
+    hdr_key_t key = { .name = e->name, .len = e->name_len, .hash = e->hash, .known = e->known };
+    if (!list_append_raw(dst_list, &key, e->value)) return false;
+  }
   
-  for (hdr_entry_t *e = src_list->head; e; e = e->next)
-    list_append_raw(dst_list, e->name, e->value);
   return true;
 }
 
@@ -716,14 +964,16 @@ size_t headers_find_literal(ant_value_t hdrs, const char *lower_name, const char
   hdr_list_t *l = get_list(hdrs);
   size_t count = 0;
 
+  hdr_key_t key;
+
   if (first_value) *first_value = NULL;
-  if (!l || !lower_name) return 0;
+  if (!l || !lower_name || !hdr_key_init(&key, lower_name)) return 0;
 
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, lower_name) != 0) continue;
-    if (count == 0 && first_value) *first_value = e->value;
-    count++;
-  }
+  int32_t head = list_find(l, &key);
+  hdr_key_clear(&key);
+  
+  if (head >= 0 && first_value) *first_value = l->entries[head].value;
+  for (int32_t i = head; i >= 0; i = l->entries[i].next) count++;
 
   return count;
 }
@@ -734,26 +984,24 @@ void headers_set_immutable(ant_value_t hdrs, bool immutable) {
 
 void headers_append_if_missing(ant_value_t hdrs, const char *name, const char *value) {
   hdr_list_t *l = get_list(hdrs);
-  if (!l || !name || !value) return;
-  char *lower = lowercase_dup(name);
-  if (!lower) return;
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, lower) == 0) { free(lower); return; }
-  }
-  list_append_raw(l, lower, value);
-  free(lower);
+  hdr_key_t key;
+  
+  if (!l || !name || !value || !hdr_key_init(&key, name)) return;
+  if (list_find(l, &key) < 0 && (l = get_list_mut(hdrs))) list_append_raw(l, &key, value);
+  hdr_key_clear(&key);
 }
 
 void headers_for_each(ant_value_t hdrs, headers_foreach_cb cb, void *ctx) {
   hdr_list_t *l = get_list(hdrs);
   if (!l || !cb) return;
-  for (hdr_entry_t *e = l->head; e; e = e->next) cb(e->name, e->value, ctx);
+  for (size_t i = 0; i < l->count; i++) cb(l->entries[i].name, l->entries[i].value, ctx);
 }
 
 bool headers_set_literal(ant_t *js, ant_value_t hdrs, const char *name, const char *value) {
   hdr_list_t *l = get_list(hdrs);
   char *norm = NULL;
-  char *lower = NULL;
+  hdr_key_t key;
+  bool ok = false;
 
   if (!l || !name || !value) return false;
   if (!is_valid_name(name)) return false;
@@ -765,24 +1013,17 @@ bool headers_set_literal(ant_t *js, ant_value_t hdrs, const char *name, const ch
     return false;
   }
 
-  lower = lowercase_dup(name);
-  if (!lower) {
+  if (headers_is_immutable(hdrs) || !(l = get_list_mut(hdrs)) || !hdr_key_init(&key, name)) {
     free(norm);
     return false;
   }
 
-  if (headers_is_immutable(hdrs)) {
-    free(lower);
-    free(norm);
-    return false;
-  }
-
-  list_delete_name(l, lower);
-  list_append_raw(l, lower, norm);
-  free(lower);
+  list_delete_name(l, &key);
+  ok = list_append_raw(l, &key, norm);
+  hdr_key_clear(&key);
   free(norm);
   
-  return true;
+  return ok;
 }
 
 ant_value_t headers_init_from(ant_t *js, ant_value_t hdrs, ant_value_t init) {
@@ -893,58 +1134,11 @@ ant_value_t headers_get_value(ant_t *js, ant_value_t hdrs, const char *name) {
   if (!l) return js_mknull();
   if (!is_valid_name(name)) return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid header name");
 
-  char *lower = lowercase_dup(name);
-  if (!lower) return js_mkerr(js, "out of memory");
-
-  if (strcmp(lower, "set-cookie") == 0) {
-    for (hdr_entry_t *e = l->head; e; e = e->next) {
-    if (strcmp(e->name, lower) == 0) {
-      ant_value_t ret = js_mkstr(js, e->value, strlen(e->value));
-      free(lower);
-      return ret;
-    }}
-    free(lower);
-    return js_mknull();
-  }
-
-  size_t total = 0;
-  int count = 0;
-  
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-  if (strcmp(e->name, lower) == 0) {
-    if (count > 0) total += 2;
-    total += strlen(e->value);
-    count++;
-  }}
-
-  if (count == 0) {
-    free(lower);
-    return js_mknull();
-  }
-
-  char *combined = malloc(total + 1);
-  if (!combined) {
-    free(lower);
-    return js_mkerr(js, "out of memory");
-  }
-
-  size_t pos = 0;
-  int seen = 0;
+  hdr_key_t key;
+  if (!hdr_key_init(&key, name)) return js_mkerr(js, "out of memory");
   
-  for (hdr_entry_t *e = l->head; e; e = e->next) {
-  if (strcmp(e->name, lower) == 0) {
-    if (seen > 0) { combined[pos++] = ','; combined[pos++] = ' '; }
-    size_t vl = strlen(e->value);
-    memcpy(combined + pos, e->value, vl);
-    pos += vl;
-    seen++;
-  }}
-  
-  combined[pos] = '\0';
-  free(lower);
-
-  ant_value_t ret = js_mkstr(js, combined, pos);
-  free(combined);
+  ant_value_t ret = list_get_value(js, l, &key);
+  hdr_key_clear(&key);
   
   return ret;
 }
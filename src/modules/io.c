@@ -1165,6 +1165,47 @@ static void inspect_string_value(
     return;
   }
 
+  if (tag == STR_HEAP_TAG_SLICE) {
+    ant_slice_heap_t *slice = ant_str_slice_ptr(val);
+    fprintf(
+      stream,
+      "<String slice value=0x%016" PRIx64 " data=0x%012" PRIx64 " ptr=%p",
+      raw_value,
+      raw_data,
+      (void *)slice
+    );
+    if (!slice) {
+      fprintf(stream, ">");
+      return;
+    }
+
+    fprintf(
+      stream,
+      " len=%" PRIu64 " offset=%" PRIu64 " ascii=%s> {\n",
+      (uint64_t)slice->len,
+      (uint64_t)slice->offset,
+      inspect_ascii_state(slice->ascii_state)
+    );
+
+    inspect_print_indent(stream, depth + 1);
+    fprintf(stream, "cached: ");
+    if (vtype(slice->cached) == T_UNDEF) fprintf(stream, "undefined");
+    else if (depth > 10) fprintf(stream, "<String ...>");
+    else inspect_value(js, slice->cached, stream, depth + 1, visited);
+    fprintf(stream, "\n");
+
+    inspect_print_indent(stream, depth + 1);
+    fprintf(stream, "parent: ");
+    if (vtype(slice->parent) == T_UNDEF) fprintf(stream, "undefined");
+    else if (depth > 10) fprintf(stream, "<String ...>");
+    else inspect_value(js, slice->parent, stream, depth + 1, visited);
+    fprintf(stream, "\n");
+
+    inspect_print_indent(stream, depth);
+    fprintf(stream, "}");
+    return;
+  }
+
   fprintf(stream, "<String unknown-tag=%" PRIuPTR " value=0x%016" PRIx64 " data=0x%012" PRIx64 ">", tag, raw_value, raw_data);
 }
 
@@ -7,9 +7,11 @@
 
 #include "gc/roots.h"
 #include "utf8.h"
+#include "simd.h"
 #include "numbers.h"
 #include "errors.h"
 #include "internal.h"
+#include "ptr.h"
 
 #include "silver/engine.h"
 #include "modules/json.h"
@@ -53,7 +55,137 @@ static inline ant_value_t json_stringify_oom(ant_t *js) {
   return js_mkerr(js, "JSON.stringify() failed: out of memory");
 }
 
-static ant_value_t yyjson_to_jsval(ant_t *js, yyjson_val *val, gc_temp_root_scope_t *roots) {
+// lazy mode keeps the yyjson document alive and hands out plain objects
+// that fill in one level of properties the first time anything looks at them
+typedef struct {
+  yyjson_doc *doc;
+  size_t refs;
+} json_lazy_doc_t;
+
+typedef struct {
+  json_lazy_doc_t *doc;
+  yyjson_val *val;
+} json_lazy_node_t;
+
+static constexpr uint32_t JSON_LAZY_NATIVE_TAG = 0x4a4c5a59u; // JLZY
+
+static void json_lazy_doc_release(json_lazy_doc_t *doc) {
+  if (!doc || --doc->refs > 0) return;
+  yyjson_doc_free(doc->doc);
+  free(doc);
+}
+
+static void json_lazy_node_free(json_lazy_node_t *node) {
+  if (!node) return;
+  json_lazy_doc_release(node->doc);
+  free(node);
+}
+
+static void json_lazy_finalize(ant_t *js, ant_object_t *obj) {
+  ant_value_t value = js_obj_from_ptr(obj);
+  json_lazy_node_free(js_get_native(value, JSON_LAZY_NATIVE_TAG));
+  js_clear_native(value, JSON_LAZY_NATIVE_TAG);
+}
+
+static ant_value_t yyjson_to_jsval(ant_t *js, yyjson_val *val, json_lazy_doc_t *lazy, gc_temp_root_scope_t *roots);
+static ant_value_t json_lazy_materialize(ant_t *js, ant_value_t obj);
+
+static ant_value_t json_lazy_object(ant_t *js, yyjson_val *val, json_lazy_doc_t *lazy, gc_temp_root_scope_t *roots) {
+  ant_value_t obj = js_newobj(js);
+  if (is_err(obj)) return obj;
+  if (!json_temp_pin(roots, obj)) return json_parse_oom(js);
+  if (yyjson_obj_size(val) == 0) return obj;
+
+  json_lazy_node_t *node = malloc(sizeof(*node));
+  if (!node) return json_parse_oom(js);
+  
+  node->doc = lazy;
+  node->val = val;
+  lazy->refs++;
+
+  js_set_native(obj, node, JSON_LAZY_NATIVE_TAG);
+  js_set_finalizer(obj, json_lazy_finalize);
+  js_set_materializer(obj, json_lazy_materialize);
+  
+  return obj;
+}
+
+static ant_value_t json_fill_object(
+  ant_t *js, ant_value_t obj, yyjson_val *val,
+  json_lazy_doc_t *lazy, gc_temp_root_scope_t *roots
+) {
+  size_t idx, max; yyjson_val *key, *item;
+  json_key_entry_t *hash = NULL, *entry;
+
+  yyjson_obj_foreach(val, idx, max, key, item) {
+  const char *k = yyjson_get_str(key);
+
+  size_t klen = yyjson_get_len(key);
+  ant_value_t v = yyjson_to_jsval(js, item, lazy, roots);
+  if (is_err(v)) {
+    json_key_hash_free(&hash);
+    return v;
+  }
+
+  HASH_FIND(hh, hash, k, klen, entry);
+  if (entry) {
+    const char *interned = intern_string(k, klen);
+    ant_prop_loc_t loc = interned ? lkp_interned(obj, interned) : ANT_PROP_LOC_NONE;
+
+    if (!loc.obj || !js_prop_store(js, loc, v)) {
+      ant_value_t key_str = js_mkstr(js, k, klen);
+      if (is_err(key_str)) {
+        json_key_hash_free(&hash);
+        return key_str;
+      }
+      ant_value_t set = js_setprop(js, obj, key_str, v);
+      if (is_err(set)) {
+        json_key_hash_free(&hash);
+        return set;
+      }
+    }
+  } else {
+    ant_value_t set = js_mkprop_fast(js, obj, k, klen, v);
+    if (is_err(set)) {
+      json_key_hash_free(&hash);
+      return set;
+    }
+    entry = malloc(sizeof(json_key_entry_t));
+    if (!entry) {
+      json_key_hash_free(&hash);
+      return json_parse_oom(js);
+    }
+    entry->key = k; entry->key_len = klen;
+    HASH_ADD_KEYPTR(hh, hash, entry->key, entry->key_len, entry);
+  }}
+
+  json_key_hash_free(&hash);
+  return obj;
+}
+
+static ant_value_t json_lazy_materialize(ant_t *js, ant_value_t obj) {
+  json_lazy_node_t *node = js_get_native(obj, JSON_LAZY_NATIVE_TAG);
+  js_clear_materializer(obj);
+  js_set_finalizer(obj, NULL);
+  js_clear_native(obj, JSON_LAZY_NATIVE_TAG);
+  if (!node) return js_mkundef();
+
+  // this runs inside property lookups whose callers may hold unrooted
+  // values, so one level is filled with collection held off
+  bool gc_was_disabled = gc_disabled;
+  gc_disabled = true;
+
+  gc_temp_root_scope_t roots;
+  gc_temp_root_scope_begin(js, &roots);
+  ant_value_t filled = json_fill_object(js, obj, node->val, node->doc, &roots);
+  gc_temp_root_scope_end(&roots);
+
+  gc_disabled = gc_was_disabled;
+  json_lazy_node_free(node);
+  return is_err(filled) ? filled : js_mkundef();
+}
+
+static ant_value_t yyjson_to_jsval(ant_t *js, yyjson_val *val, json_lazy_doc_t *lazy, gc_temp_root_scope_t *roots) {
   if (!val) return js_mkundef();
   
   switch (yyjson_get_type(val)) {
@@ -81,7 +213,7 @@ static ant_value_t yyjson_to_jsval(ant_t *js, yyjson_val *val, gc_temp_root_scop
     yyjson_val *item;
     
     yyjson_arr_foreach(val, idx, max, item) {
-      ant_value_t elem = yyjson_to_jsval(js, item, roots);
+      ant_value_t elem = yyjson_to_jsval(js, item, lazy, roots);
       if (is_err(elem)) return elem;
       js_arr_push(js, arr, elem);
     }
@@ -90,57 +222,11 @@ static ant_value_t yyjson_to_jsval(ant_t *js, yyjson_val *val, gc_temp_root_scop
   }
   
   case YYJSON_TYPE_OBJ: {
+    if (lazy) return json_lazy_object(js, val, lazy, roots);
     ant_value_t obj = js_newobj(js);
     if (is_err(obj)) return obj;
     if (!json_temp_pin(roots, obj)) return json_parse_oom(js);
-    
-    size_t idx, max; yyjson_val *key, *item;
-    json_key_entry_t *hash = NULL, *entry;
-
-    yyjson_obj_foreach(val, idx, max, key, item) {
-    const char *k = yyjson_get_str(key);
-
-    size_t klen = yyjson_get_len(key);
-    ant_value_t v = yyjson_to_jsval(js, item, roots);
-    if (is_err(v)) {
-      json_key_hash_free(&hash);
-      return v;
-    }
-
-    HASH_FIND(hh, hash, k, klen, entry);
-    if (entry) {
-      const char *interned = intern_string(k, klen);
-      ant_prop_loc_t loc = interned ? lkp_interned(obj, interned) : ANT_PROP_LOC_NONE;
-
-      if (loc.obj) js_prop_store(js, loc, v);
-      else {
-        ant_value_t key_str = js_mkstr(js, k, klen);
-        if (is_err(key_str)) {
-          json_key_hash_free(&hash);
-          return key_str;
-        }
-        ant_value_t set = js_setprop(js, obj, key_str, v);
-        if (is_err(set)) {
-          json_key_hash_free(&hash);
-          return set;
-        }
-      }
-    } else {
-      if (is_err(js_mkprop_fast(js, obj, k, klen, v))) {
-        json_key_hash_free(&hash);
-        return json_parse_oom(js);
-      }
-      entry = malloc(sizeof(json_key_entry_t));
-      if (!entry) {
-        json_key_hash_free(&hash);
-        return json_parse_oom(js);
-      }
-      entry->key = k; entry->key_len = klen;
-      HASH_ADD_KEYPTR(hh, hash, entry->key, entry->key_len, entry);
-    }}
-
-    json_key_hash_free(&hash);
-    return obj;
+    return json_fill_object(js, obj, val, NULL, roots);
   }
   
   default: return js_mkundef(); }
@@ -251,14 +337,7 @@ static bool json_out_char(json_out_t *o, char c) {
 }
 
 static bool json_out_quoted_raw(json_out_t *o, const char *str, size_t byte_len) {
-  size_t i = 0;
-  while (i < byte_len) {
-    unsigned char c = (unsigned char)str[i];
-    if (c < 0x20 || c == '"' || c == '\\' || c >= 0x80) break;
-    i++;
-  }
-
-  if (i == byte_len) {
+  if (simd_json_safe_prefix(str, byte_len) == byte_len) {
     if (!json_out_reserve(o, byte_len + 2)) return false;
     o->buf[o->len++] = '"';
     memcpy(o->buf + o->len, str, byte_len);
@@ -315,6 +394,126 @@ static bool json_out_number(json_out_t *o, double num) {
   return true;
 }
 
+static bool json_key_is_index(const char *key) {
+  if (!key || !*key) return false;
+  if (key[0] == '0') return key[1] == '\0';
+  for (const char *p = key; *p; p++) if (*p < '0' || *p > '9') return false;
+  return true;
+}
+
+// per-shape stringify plans: the enumerable string keys in order, each
+// pre-quoted as `"key":`, and whether the shape itself carries toJSON.
+// a cached shape is retained, which makes it copy-on-write, so the slots
+// stay valid for every object that still points at it
+typedef struct {
+  const char *key;
+  uint32_t slot;
+  uint32_t quoted_off;
+  uint32_t quoted_len;
+  bool accessor;
+} json_plan_entry_t;
+
+typedef struct {
+  ant_shape_t *shape;
+  char *quoted;
+  uint32_t refs;
+  uint32_t count;
+  bool has_tojson;
+  bool has_index_key;
+  json_plan_entry_t entries[];
+} json_shape_plan_t;
+
+static constexpr size_t JSON_PLAN_CACHE_SIZE = 256;
+static _Thread_local json_shape_plan_t *json_plan_cache[JSON_PLAN_CACHE_SIZE];
+
+static inline size_t json_plan_hash(const ant_shape_t *shape) {
+  uintptr_t p = (uintptr_t)shape;
+  return (size_t)((p >> 4) ^ (p >> 13)) & (JSON_PLAN_CACHE_SIZE - 1);
+}
+
+static void json_plan_release(json_shape_plan_t *plan) {
+  if (!plan || --plan->refs > 0) return;
+  ant_shape_release(plan->shape);
+  free(plan->quoted);
+  free(plan);
+}
+
+static json_shape_plan_t *json_plan_build(ant_shape_t *shape, const char *tojson_key) {
+  uint32_t count = ant_shape_count(shape);
+  json_shape_plan_t *plan = calloc(1, sizeof(*plan) + count * sizeof(json_plan_entry_t));
+  if (!plan) return NULL;
+
+  json_out_t quoted = {0};
+  plan->has_tojson = tojson_key && ant_shape_lookup_interned(shape, tojson_key) >= 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    const ant_shape_prop_t *prop = ant_shape_prop_at(shape, i);
+    if (!prop || prop->type != ANT_SHAPE_KEY_STRING) continue;
+    if (!(prop->attrs & ANT_PROP_ATTR_ENUMERABLE)) continue;
+
+    if (json_key_is_index(prop->key.interned)) {
+      plan->has_index_key = true;
+      break;
+    }
+
+    json_plan_entry_t *entry = &plan->entries[plan->count++];
+    entry->key = prop->key.interned;
+    entry->slot = i;
+    entry->accessor = prop->has_getter || prop->has_setter;
+    entry->quoted_off = (uint32_t)quoted.len;
+
+    if (
+      !json_out_quoted_raw(&quoted, entry->key, intern_length(entry->key)) ||
+      !json_out_char(&quoted, ':')
+    ) {
+      free(quoted.buf);
+      free(plan);
+      return NULL;
+    }
+    entry->quoted_len = (uint32_t)(quoted.len - entry->quoted_off);
+  }
+
+  ant_shape_retain(shape);
+  plan->shape = shape;
+  plan->quoted = quoted.buf;
+  plan->refs = 1;
+  
+  return plan;
+}
+
+static inline json_shape_plan_t *json_plan_peek(ant_value_t val) {
+  if (vtype(val) != T_OBJ) return NULL;
+  ant_object_t *ptr = js_obj_ptr(val);
+  if (!ptr || !ptr->shape || ptr->flags.is_exotic) return NULL;
+  json_shape_plan_t *plan = json_plan_cache[json_plan_hash(ptr->shape)];
+  return plan && plan->shape == ptr->shape ? plan : NULL;
+}
+
+static json_shape_plan_t *json_plan_for(ant_t *js, ant_value_t val, const char *tojson_key) {
+  if (vtype(val) != T_OBJ || is_proxy(val)) return NULL;
+  js_obj_materialize(js, val);
+
+  ant_object_t *ptr = js_obj_ptr(val);
+  if (!ptr || !ptr->shape || ptr->flags.is_exotic) return NULL;
+
+  json_shape_plan_t **slot = &json_plan_cache[json_plan_hash(ptr->shape)];
+  if (*slot && (*slot)->shape == ptr->shape) return *slot;
+
+  json_shape_plan_t *plan = json_plan_build(ptr->shape, tojson_key);
+  if (!plan) return NULL;
+  if (*slot) json_plan_release(*slot);
+  
+  *slot = plan;
+  return plan;
+}
+
+void cleanup_json_module(void) {
+  for (size_t i = 0; i < JSON_PLAN_CACHE_SIZE; i++) {
+    json_plan_release(json_plan_cache[i]);
+    json_plan_cache[i] = NULL;
+  }
+}
+
 static int json_cycle_check(json_cycle_ctx *ctx, ant_value_t val, const char *key) {
   for (int i = 0; i < ctx->stack_size; i++) if (ctx->stack[i] == val) {
     ctx->has_cycle = 1;
@@ -413,7 +612,8 @@ static ant_value_t json_apply_tojson(
   ant_prop_loc_t found = ANT_PROP_LOC_NONE;
 
   if (!needs_generic) {
-    found = lkp_interned(val, ctx->tojson_key);
+    json_shape_plan_t *plan = json_plan_peek(val);
+    if (!plan || plan->has_tojson) found = lkp_interned(val, ctx->tojson_key);
 
     if (!found.obj) {
       ant_value_t proto = js_get_proto(js, val);
@@ -559,88 +759,51 @@ abort:
   return JSON_W_ABORT;
 }
 
-static bool json_key_is_index(const char *key) {
-  if (!key || !*key) return false;
-  if (key[0] == '0') return key[1] == '\0';
-  for (const char *p = key; *p; p++) if (*p < '0' || *p > '9') return false;
-  return true;
-}
-
-static bool json_collect_own_keys(
-  ant_t *js, ant_value_t val, const char ***out_keys, size_t *out_count,
-  const char **inline_keys, size_t inline_cap
-) {
-  if (vtype(val) != T_OBJ || is_proxy(val)) return false;
-
-  ant_object_t *ptr = js_obj_ptr(js_as_obj(val));
-  if (!ptr || !ptr->shape || ptr->flags.is_exotic) return false;
-
-  uint32_t count = ant_shape_count(ptr->shape);
-  const char **keys = inline_keys;
-  size_t n = 0;
-
-  if (count > inline_cap) {
-    keys = malloc(sizeof(*keys) * count);
-    if (!keys) return false;
-  }
-
-  for (uint32_t i = 0; i < count; i++) {
-    const ant_shape_prop_t *prop = ant_shape_prop_at(ptr->shape, i);
-    if (!prop || prop->type != ANT_SHAPE_KEY_STRING) continue;
-    if (!(prop->attrs & ANT_PROP_ATTR_ENUMERABLE)) continue;
-
-    if (json_key_is_index(prop->key.interned)) {
-      if (keys != inline_keys) free(keys);
-      return false;
-    }
-    keys[n++] = prop->key.interned;
-  }
-
-  *out_keys = keys;
-  *out_count = n;
-  return true;
-}
-
-static json_write_t json_write_object_fast(
+static json_write_t json_write_object_planned(
   json_cycle_ctx *ctx, json_out_t *out, ant_value_t val, int depth,
-  const char **keys, size_t key_count
+  json_shape_plan_t *plan
 ) {
   ant_t *js = ctx->js;
+  ant_object_t *ptr = js_obj_ptr(val);
   ant_value_t saved_holder = ctx->holder;
   bool wrote_any = false;
 
-  if (!json_out_char(out, '{')) return JSON_W_ABORT;
+  // nested writes may evict this plan from the cache
+  plan->refs++;
+  if (!json_out_char(out, '{')) goto abort;
   json_set_holder(ctx, val);
 
-  for (size_t i = 0; i < key_count; i++) {
-    const char *key = keys[i];
-    size_t key_len = intern_length(key);
-    if (!is_key_in_replacer_arr(js, ctx, key, key_len)) continue;
-
-    ant_prop_loc_t loc = lkp_interned(val, key);
-    if (!loc.obj) continue;
+  for (uint32_t i = 0; i < plan->count; i++) {
+    const json_plan_entry_t *entry = &plan->entries[i];
+    if (!is_key_in_replacer_arr(js, ctx, entry->key, intern_length(entry->key))) continue;
 
     ant_value_t prop;
-    const ant_shape_prop_t *meta = ant_shape_prop_at(loc.obj->shape, loc.slot);
-
-    if (meta && (meta->has_getter || meta->has_setter)) {
-      prop = js_get(js, val, key);
-      if (is_err(prop)) {
-        json_capture_error(ctx, prop);
-        goto abort;
-      }
-    } else prop = js_prop_load(loc);
+    if (ptr->shape == plan->shape && !entry->accessor) {
+      prop = js_prop_load((ant_prop_loc_t){ptr, entry->slot});
+    } else {
+      // a getter or toJSON has reshaped the object since the plan was taken
+      ant_prop_loc_t loc = lkp_interned(val, entry->key);
+      if (!loc.obj) continue;
+      const ant_shape_prop_t *meta = ant_shape_prop_at(loc.obj->shape, loc.slot);
+
+      if (meta && (meta->has_getter || meta->has_setter)) {
+        prop = js_get(js, val, entry->key);
+        if (is_err(prop)) {
+          json_capture_error(ctx, prop);
+          goto abort;
+        }
+      } else prop = js_prop_load(loc);
+    }
 
     if (!json_ctx_pin_value(ctx, prop)) goto abort;
     size_t mark = out->len;
 
     if (wrote_any && !json_out_char(out, ',')) goto abort;
     if (!json_write_indent(ctx, out, depth + 1)) goto abort;
-    if (!json_out_quoted_raw(out, key, key_len)) goto abort;
-    if (!json_out_char(out, ':')) goto abort;
+    if (!json_out_write(out, plan->quoted + entry->quoted_off, entry->quoted_len)) goto abort;
     if (ctx->indent_len && !json_out_char(out, ' ')) goto abort;
 
-    json_write_t w = json_write_with_key(ctx, out, key, prop, 0, depth + 1);
+    json_write_t w = json_write_with_key(ctx, out, entry->key, prop, 0, depth + 1);
     if (w == JSON_W_ABORT) goto abort;
     if (w == JSON_W_SKIP) { out->len = mark; continue; }
 
@@ -651,10 +814,12 @@ static json_write_t json_write_object_fast(
   if (!json_out_char(out, '}')) goto abort;
 
   json_set_holder(ctx, saved_holder);
+  json_plan_release(plan);
   return JSON_W_OK;
 
 abort:
   json_set_holder(ctx, saved_holder);
+  json_plan_release(plan);
   return JSON_W_ABORT;
 }
 
@@ -663,15 +828,9 @@ static json_write_t json_write_object(
 ) {
   ant_t *js = ctx->js;
 
-  const char *inline_keys[24];
-  const char **fast_keys = NULL;
-  size_t fast_count = 0;
-
-  if (json_collect_own_keys(js, val, &fast_keys, &fast_count, inline_keys, 24)) {
-    json_write_t w = json_write_object_fast(ctx, out, val, depth, fast_keys, fast_count);
-    if (fast_keys != inline_keys) free((void *)fast_keys);
-    return w;
-  }
+  json_shape_plan_t *plan = json_plan_for(js, val, ctx->tojson_key);
+  if (plan && !plan->has_index_key)
+    return json_write_object_planned(ctx, out, val, depth, plan);
 
   ant_value_t keys = json_snapshot_keys(js, val);
   ant_value_t saved_holder = ctx->holder;
@@ -882,6 +1041,13 @@ static ant_value_t apply_reviver(
   return apply_reviver_call(js, holder, key, reviver, roots);
 }
 
+// JSON.parse(text, { lazy: true }) defers building nested objects until
+// they are first touched; a callable second argument is still a reviver
+static bool json_parse_wants_lazy(ant_t *js, ant_value_t *args, int nargs) {
+  if (nargs < 2 || vtype(args[1]) != T_OBJ || is_callable(args[1])) return false;
+  return js_truthy(js, js_get(js, args[1], "lazy"));
+}
+
 ant_value_t js_json_parse(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 1) return js_mkerr(js, "JSON.parse() requires at least 1 argument");
   if (vtype(args[0]) != T_STR) return js_mkerr(js, "JSON.parse() argument must be a string");
@@ -898,8 +1064,21 @@ ant_value_t js_json_parse(ant_t *js, ant_value_t *args, int nargs) {
     return js_mkerr_typed(js, JS_ERR_SYNTAX, "JSON.parse: unexpected character");
   }
   
-  ant_value_t result = yyjson_to_jsval(js, yyjson_doc_get_root(doc), &temp_roots);
-  yyjson_doc_free(doc);
+  json_lazy_doc_t *lazy = NULL;
+  if (json_parse_wants_lazy(js, args, nargs)) {
+    lazy = malloc(sizeof(*lazy));
+    if (!lazy) {
+      yyjson_doc_free(doc);
+      gc_temp_root_scope_end(&temp_roots);
+      return json_parse_oom(js);
+    }
+    lazy->doc = doc;
+    lazy->refs = 1;
+  }
+  
+  ant_value_t result = yyjson_to_jsval(js, yyjson_doc_get_root(doc), lazy, &temp_roots);
+  if (lazy) json_lazy_doc_release(lazy);
+  else yyjson_doc_free(doc);
   if (is_err(result)) {
     gc_temp_root_scope_end(&temp_roots);
     return result;
@@ -7,22 +7,36 @@
 #include "modules/lmdb.h"
 #include "modules/buffer.h"
 #include "modules/symbol.h"
+#include "modules/timer.h"
 #include "descriptors.h"
 #include "gc/modules.h"
+#include "gc/roots.h"
 
 #include <lmdb.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <uv.h>
+
+#define LMDB_BATCH_MAX_OPS   1024
+#define LMDB_BATCH_MAX_BYTES (16u * 1024u * 1024u)
+#define LMDB_RANGE_BATCH     64
 
 struct lmdb_env_handle {
   MDB_env *env;
   bool closed;
   bool read_only;
+  bool write_map;
   char *path;
+  size_t batch_max_ops;
+  size_t batch_max_bytes;
+  lmdb_writer_t *writer;
   lmdb_db_handle_t *db_head;
   lmdb_txn_handle_t *txn_head;
+  lmdb_range_handle_t *range_head;
   lmdb_env_handle_t *next_global;
 };
 
@@ -44,6 +58,77 @@ struct lmdb_txn_handle {
   lmdb_txn_handle_t *next_global;
 };
 
+// one read transaction and cursor per getRange() iterator; entries are
+// pulled from the cursor batch_size at a time into a js array
+struct lmdb_range_handle {
+  MDB_txn *txn;
+  MDB_cursor *cursor;
+  bool closed;
+  bool started;
+  bool done;
+  bool reverse;
+  bool keys_as_string;
+  bool values_as_string;
+  bool batch_buffer;
+  MDB_val start;
+  MDB_val end;
+  size_t limit;
+  size_t count;
+  size_t batch_size;
+  size_t batch_pos;
+  lmdb_db_handle_t *db;
+  lmdb_env_handle_t *env;
+  lmdb_range_handle_t *next_in_env;
+  lmdb_range_handle_t *next_global;
+};
+
+enum {
+  LMDB_WRITE_PUT = 0,
+  LMDB_WRITE_DEL,
+  LMDB_WRITE_FLUSH
+};
+
+struct lmdb_write_op {
+  uint8_t kind;
+  bool has_value;
+  int rc;
+  unsigned int flags;
+  MDB_dbi dbi;
+  MDB_val key;
+  MDB_val value;
+  ant_value_t promise;
+  ant_value_t owner;
+  lmdb_write_op_t *next;
+  char data[];
+};
+
+// putAsync/delAsync are staged on the js thread for one loop turn (or until
+// a size threshold), then handed to a per-env writer thread that applies
+// everything it has in one transaction and commits it off the event loop
+struct lmdb_writer {
+  ant_t *js;
+  MDB_env *env;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uv_async_t async;
+  uv_timer_t timer;
+  lmdb_write_op_t *stage_head;
+  lmdb_write_op_t *stage_tail;
+  lmdb_write_op_t *queue_head;
+  lmdb_write_op_t *queue_tail;
+  lmdb_write_op_t *inflight;
+  lmdb_write_op_t *done_head;
+  lmdb_write_op_t *done_tail;
+  size_t stage_ops;
+  size_t stage_bytes;
+  size_t max_ops;
+  size_t max_bytes;
+  size_t pending;
+  uint8_t open_handles;
+  bool stopping;
+};
+
 struct lmdb_env_ref {
   ant_value_t obj;
   lmdb_env_handle_t *env;
@@ -62,23 +147,33 @@ struct lmdb_txn_ref {
   lmdb_txn_ref_t *next;
 };
 
+struct lmdb_range_ref {
+  ant_value_t obj;
+  lmdb_range_handle_t *range;
+  lmdb_range_ref_t *next;
+};
+
 static lmdb_js_types_t lmdb_types = {0};
 static lmdb_env_handle_t *env_handles = NULL;
 static lmdb_db_handle_t *db_handles = NULL;
 static lmdb_txn_handle_t *txn_handles = NULL;
+static lmdb_range_handle_t *range_handles = NULL;
 static lmdb_env_ref_t *env_refs = NULL;
 static lmdb_db_ref_t *db_refs = NULL;
 static lmdb_txn_ref_t *txn_refs = NULL;
+static lmdb_range_ref_t *range_refs = NULL;
 
 enum {
   LMDB_ENV_NATIVE_TAG = 0x4c454e56u, // LENV
   LMDB_DB_NATIVE_TAG = 0x4c444242u,  // LDBB
-  LMDB_TXN_NATIVE_TAG = 0x4c54584eu  // LTXN
+  LMDB_TXN_NATIVE_TAG = 0x4c54584eu, // LTXN
+  LMDB_RANGE_NATIVE_TAG = 0x4c524e47u // LRNG
 };
 
 static ant_value_t make_env_obj(ant_t *js, lmdb_env_handle_t *env);
 static ant_value_t make_db_obj(ant_t *js, lmdb_db_handle_t *db, ant_value_t env_obj);
 static ant_value_t make_txn_obj(ant_t *js, lmdb_txn_handle_t *txn, ant_value_t env_obj);
+static ant_value_t make_range_obj(ant_t *js, lmdb_range_handle_t *range, ant_value_t db_obj);
 
 static void list_remove_db(lmdb_env_handle_t *env, lmdb_db_handle_t *target) {
   if (!env || !target) return;
@@ -106,6 +201,19 @@ static void list_remove_txn(lmdb_env_handle_t *env, lmdb_txn_handle_t *target) {
   }
 }
 
+static void list_remove_range(lmdb_env_handle_t *env, lmdb_range_handle_t *target) {
+  if (!env || !target) return;
+  lmdb_range_handle_t **cur = &env->range_head;
+  while (*cur) {
+    if (*cur == target) {
+      *cur = target->next_in_env;
+      target->next_in_env = NULL;
+      return;
+    }
+    cur = &(*cur)->next_in_env;
+  }
+}
+
 static void register_env_ref(ant_value_t obj, lmdb_env_handle_t *env) {
   lmdb_env_ref_t *ref = ant_calloc(sizeof(lmdb_env_ref_t));
   if (!ref) return;
@@ -133,6 +241,15 @@ static void register_txn_ref(ant_value_t obj, lmdb_txn_handle_t *txn) {
   txn_refs = ref;
 }
 
+static void register_range_ref(ant_value_t obj, lmdb_range_handle_t *range) {
+  lmdb_range_ref_t *ref = ant_calloc(sizeof(lmdb_range_ref_t));
+  if (!ref) return;
+  ref->obj = obj;
+  ref->range = range;
+  ref->next = range_refs;
+  range_refs = ref;
+}
+
 static void unregister_env_ref_by_obj(ant_value_t obj) {
   lmdb_env_ref_t **cur = &env_refs;
   while (*cur) {
@@ -175,6 +292,20 @@ static void unregister_txn_ref_by_obj(ant_value_t obj) {
   }
 }
 
+static void unregister_range_ref_by_obj(ant_value_t obj) {
+  lmdb_range_ref_t **cur = &range_refs;
+  while (*cur) {
+    if ((*cur)->obj == obj) {
+      lmdb_range_ref_t *next = (*cur)->next;
+      js_clear_native((*cur)->obj, LMDB_RANGE_NATIVE_TAG);
+      free(*cur);
+      *cur = next;
+      return;
+    }
+    cur = &(*cur)->next;
+  }
+}
+
 static void unregister_db_refs_by_env(lmdb_env_handle_t *env) {
   lmdb_db_ref_t **cur = &db_refs;
   while (*cur) {
@@ -203,9 +334,276 @@ static void unregister_txn_refs_by_env(lmdb_env_handle_t *env) {
   }
 }
 
+static void unregister_range_refs_by_env(lmdb_env_handle_t *env) {
+  lmdb_range_ref_t **cur = &range_refs;
+  while (*cur) {
+    if ((*cur)->range && (*cur)->range->env == env) {
+      lmdb_range_ref_t *next = (*cur)->next;
+      js_clear_native((*cur)->obj, LMDB_RANGE_NATIVE_TAG);
+      free(*cur);
+      *cur = next;
+      continue;
+    }
+    cur = &(*cur)->next;
+  }
+}
+
+static void range_handle_release(lmdb_range_handle_t *range) {
+  if (!range) return;
+  if (range->cursor) {
+    mdb_cursor_close(range->cursor);
+    range->cursor = NULL;
+  }
+  if (range->txn) {
+    mdb_txn_abort(range->txn);
+    range->txn = NULL;
+  }
+  range->done = true;
+}
+
+static void range_handle_close(lmdb_range_handle_t *range) {
+  if (!range || range->closed) return;
+  range_handle_release(range);
+  free(range->start.mv_data);
+  free(range->end.mv_data);
+  range->start = (MDB_val){0};
+  range->end = (MDB_val){0};
+  range->closed = true;
+}
+
+static void close_ranges_for_db(lmdb_db_handle_t *db) {
+  if (!db || !db->env) return;
+  for (lmdb_range_handle_t *range = db->env->range_head; range; range = range->next_in_env)
+    if (range->db == db) range_handle_close(range);
+}
+
+static void write_ops_append(
+  lmdb_write_op_t **head, lmdb_write_op_t **tail,
+  lmdb_write_op_t *first, lmdb_write_op_t *last
+) {
+  if (!first) return;
+  if (*tail) (*tail)->next = first;
+  else *head = first;
+  *tail = last;
+}
+
+static void write_ops_free(lmdb_write_op_t *op) {
+  while (op) {
+    lmdb_write_op_t *next = op->next;
+    free(op);
+    op = next;
+  }
+}
+
+static void lmdb_writer_apply(lmdb_writer_t *w, lmdb_write_op_t *batch) {
+  MDB_txn *txn = NULL;
+  int fatal = mdb_txn_begin(w->env, NULL, 0, &txn);
+
+  for (lmdb_write_op_t *op = batch; op && fatal == 0; op = op->next) {
+    switch (op->kind) {
+      case LMDB_WRITE_PUT:
+        op->rc = mdb_put(txn, op->dbi, &op->key, &op->value, op->flags);
+        break;
+      case LMDB_WRITE_DEL:
+        op->rc = mdb_del(txn, op->dbi, &op->key, op->has_value ? &op->value : NULL);
+        break;
+      default:
+        op->rc = 0;
+        break;
+    }
+    if (op->rc != 0 && op->rc != MDB_KEYEXIST && op->rc != MDB_NOTFOUND) fatal = op->rc;
+  }
+
+  if (fatal == 0) fatal = mdb_txn_commit(txn);
+  else if (txn) mdb_txn_abort(txn);
+
+  // the whole group shares one transaction, so a failed op or commit fails all of it
+  if (fatal != 0) for (lmdb_write_op_t *op = batch; op; op = op->next) op->rc = fatal;
+}
+
+static void *lmdb_writer_main(void *arg) {
+  lmdb_writer_t *w = (lmdb_writer_t *)arg;
+
+  pthread_mutex_lock(&w->lock);
+  for (;;) {
+    while (!w->queue_head && !w->stopping) pthread_cond_wait(&w->cond, &w->lock);
+    if (!w->queue_head) break;
+
+    lmdb_write_op_t *batch = w->queue_head;
+    lmdb_write_op_t *last = batch;
+    size_t count = 1;
+    while (last->next && count < w->max_ops) {
+      last = last->next;
+      count++;
+    }
+
+    w->queue_head = last->next;
+    if (!w->queue_head) w->queue_tail = NULL;
+    last->next = NULL;
+    // stays reachable for gc_mark_lmdb while the transaction runs unlocked
+    w->inflight = batch;
+    pthread_mutex_unlock(&w->lock);
+
+    lmdb_writer_apply(w, batch);
+
+    pthread_mutex_lock(&w->lock);
+    w->inflight = NULL;
+    write_ops_append(&w->done_head, &w->done_tail, batch, last);
+    uv_async_send(&w->async);
+  }
+  pthread_mutex_unlock(&w->lock);
+
+  return NULL;
+}
+
+static void lmdb_writer_handoff(lmdb_writer_t *w) {
+  if (!w->stage_head) return;
+
+  pthread_mutex_lock(&w->lock);
+  write_ops_append(&w->queue_head, &w->queue_tail, w->stage_head, w->stage_tail);
+  pthread_cond_signal(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+
+  w->stage_head = NULL;
+  w->stage_tail = NULL;
+  w->stage_ops = 0;
+  w->stage_bytes = 0;
+  uv_timer_stop(&w->timer);
+}
+
+static void lmdb_writer_settle(lmdb_writer_t *w) {
+  ant_t *js = w->js;
+
+  pthread_mutex_lock(&w->lock);
+  lmdb_write_op_t *op = w->done_head;
+  w->done_head = NULL;
+  w->done_tail = NULL;
+  pthread_mutex_unlock(&w->lock);
+
+  while (op) {
+    lmdb_write_op_t *next = op->next;
+    if (op->rc == 0) {
+      js_resolve_promise(js, op->promise, op->kind == LMDB_WRITE_FLUSH ? js_mkundef() : js_true);
+    } else if (op->rc == MDB_KEYEXIST || op->rc == MDB_NOTFOUND) {
+      js_resolve_promise(js, op->promise, js_false);
+    } else {
+      char message[256];
+      snprintf(message, sizeof(message), "lmdb batched commit failed: %s", mdb_strerror(op->rc));
+      js_reject_promise(js, op->promise, js_make_error_silent(js, JS_ERR_GENERIC, message));
+    }
+    free(op);
+    if (w->pending > 0) w->pending--;
+    op = next;
+  }
+
+  if (w->pending == 0) uv_unref((uv_handle_t *)&w->async);
+}
+
+static void lmdb_writer_async_cb(uv_async_t *handle) {
+  lmdb_writer_t *w = (lmdb_writer_t *)handle->data;
+  lmdb_writer_settle(w);
+  js_maybe_drain_microtasks_after_async_settle(w->js);
+}
+
+static void lmdb_writer_timer_cb(uv_timer_t *timer) {
+  lmdb_writer_handoff((lmdb_writer_t *)timer->data);
+}
+
+static void lmdb_writer_close_cb(uv_handle_t *handle) {
+  lmdb_writer_t *w = (lmdb_writer_t *)handle->data;
+  if (!w || --w->open_handles > 0) return;
+  pthread_cond_destroy(&w->cond);
+  pthread_mutex_destroy(&w->lock);
+  free(w);
+}
+
+static void lmdb_writer_close_handles(lmdb_writer_t *w) {
+  if (w->open_handles == 0) {
+    pthread_cond_destroy(&w->cond);
+    pthread_mutex_destroy(&w->lock);
+    free(w);
+    return;
+  }
+  if (w->open_handles > 1) {
+    uv_timer_stop(&w->timer);
+    uv_close((uv_handle_t *)&w->timer, lmdb_writer_close_cb);
+  }
+  uv_close((uv_handle_t *)&w->async, lmdb_writer_close_cb);
+}
+
+static lmdb_writer_t *lmdb_writer_get(ant_t *js, lmdb_env_handle_t *env) {
+  if (env->writer) return env->writer;
+
+  lmdb_writer_t *w = ant_calloc(sizeof(lmdb_writer_t));
+  if (!w) return NULL;
+
+  w->js = js;
+  w->env = env->env;
+  w->max_ops = env->batch_max_ops;
+  w->max_bytes = env->batch_max_bytes;
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->cond, NULL);
+
+  if (uv_async_init(uv_default_loop(), &w->async, lmdb_writer_async_cb) != 0) {
+    lmdb_writer_close_handles(w);
+    return NULL;
+  }
+  w->async.data = w;
+  w->open_handles++;
+  uv_unref((uv_handle_t *)&w->async);
+
+  if (uv_timer_init(uv_default_loop(), &w->timer) != 0) {
+    lmdb_writer_close_handles(w);
+    return NULL;
+  }
+  w->timer.data = w;
+  w->open_handles++;
+
+  if (pthread_create(&w->thread, NULL, lmdb_writer_main, w) != 0) {
+    lmdb_writer_close_handles(w);
+    return NULL;
+  }
+
+  env->writer = w;
+  return w;
+}
+
+// drains everything staged or queued, then joins the writer thread; when
+// settle is false the promises are dropped (finalizers, process teardown)
+static void lmdb_writer_stop(lmdb_env_handle_t *env, bool settle) {
+  lmdb_writer_t *w = env ? env->writer : NULL;
+  if (!w) return;
+  env->writer = NULL;
+
+  lmdb_writer_handoff(w);
+  pthread_mutex_lock(&w->lock);
+  w->stopping = true;
+  pthread_cond_signal(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+  pthread_join(w->thread, NULL);
+
+  if (settle) lmdb_writer_settle(w);
+  else {
+    write_ops_free(w->done_head);
+    w->done_head = NULL;
+    w->done_tail = NULL;
+  }
+
+  lmdb_writer_close_handles(w);
+}
+
+static bool env_has_open_write_txn(lmdb_env_handle_t *env) {
+  for (lmdb_txn_handle_t *txn = env ? env->txn_head : NULL; txn; txn = txn->next_in_env)
+    if (!txn->closed && txn->txn && !txn->read_only) return true;
+  return false;
+}
+
 static void env_handle_close(lmdb_env_handle_t *env) {
   if (!env || env->closed) return;
 
+  for (lmdb_range_handle_t *range = env->range_head; range; range = range->next_in_env)
+    range_handle_close(range);
+
   lmdb_txn_handle_t *txn = env->txn_head;
   while (txn) {
     if (!txn->closed && txn->txn) {
@@ -216,6 +614,8 @@ static void env_handle_close(lmdb_env_handle_t *env) {
     txn = txn->next_in_env;
   }
 
+  lmdb_writer_stop(env, false);
+
   lmdb_db_handle_t *db = env->db_head;
   while (db) {
     if (!db->closed) {
@@ -230,9 +630,11 @@ static void env_handle_close(lmdb_env_handle_t *env) {
   env->closed = true;
   env->db_head = NULL;
   env->txn_head = NULL;
+  env->range_head = NULL;
 
   unregister_db_refs_by_env(env);
   unregister_txn_refs_by_env(env);
+  unregister_range_refs_by_env(env);
 }
 
 static lmdb_env_handle_t *get_env_handle(ant_t *js, ant_value_t obj, bool open_required) {
@@ -256,6 +658,10 @@ static lmdb_txn_handle_t *get_txn_handle(ant_t *js, ant_value_t obj, bool open_r
   return txn;
 }
 
+static lmdb_range_handle_t *get_range_handle(ant_t *js, ant_value_t obj) {
+  return (lmdb_range_handle_t *)js_get_native(obj, LMDB_RANGE_NATIVE_TAG);
+}
+
 static void lmdb_env_finalize(ant_t *js, ant_object_t *obj) {
   ant_value_t value = js_obj_from_ptr(obj);
   lmdb_env_handle_t *env = 
@@ -272,6 +678,7 @@ static void lmdb_db_finalize(ant_t *js, ant_object_t *obj) {
 
   if (!db) return;
   if (!db->closed && db->env && !db->env->closed) {
+    close_ranges_for_db(db);
     mdb_dbi_close(db->env->env, db->dbi);
     list_remove_db(db->env, db);
   }
@@ -297,6 +704,24 @@ static void lmdb_txn_finalize(ant_t *js, ant_object_t *obj) {
   js_clear_native(value, LMDB_TXN_NATIVE_TAG);
 }
 
+static void lmdb_range_finalize(ant_t *js, ant_object_t *obj) {
+  ant_value_t value = js_obj_from_ptr(obj);
+  lmdb_range_handle_t *range = get_range_handle(js, value);
+
+  if (!range) return;
+  range_handle_close(range);
+  if (range->env) list_remove_range(range->env, range);
+  unregister_range_ref_by_obj(value);
+  js_clear_native(value, LMDB_RANGE_NATIVE_TAG);
+
+  for (lmdb_range_handle_t **cur = &range_handles; *cur; cur = &(*cur)->next_global) {
+    if (*cur != range) continue;
+    *cur = range->next_global;
+    break;
+  }
+  free(range);
+}
+
 static bool option_bool(ant_t *js, ant_value_t options, const char *key, bool fallback) {
   if (vtype(options) != T_OBJ) return fallback;
   ant_value_t val = js_get(js, options, key);
@@ -416,6 +841,8 @@ static ant_value_t lmdb_open(ant_t *js, ant_value_t *args, int nargs) {
   unsigned int max_readers = option_uint(js, options, "maxReaders", 0);
   unsigned int max_dbs = option_uint(js, options, "maxDbs", 0);
   unsigned int mode = option_uint(js, options, "mode", 0644U);
+  size_t batch_max_ops = option_size(js, options, "batchMaxOps", LMDB_BATCH_MAX_OPS);
+  size_t batch_max_bytes = option_size(js, options, "batchMaxBytes", LMDB_BATCH_MAX_BYTES);
 
   unsigned int flags = 0;
   if (read_only) flags |= MDB_RDONLY;
@@ -427,6 +854,10 @@ static ant_value_t lmdb_open(ant_t *js, ant_value_t *args, int nargs) {
   if (write_map) flags |= MDB_WRITEMAP;
   if (map_async) flags |= MDB_MAPASYNC;
 
+  // range iterators hold a read txn open while db.get() and friends open
+  // their own, so reader slots must be tied to the txn rather than the thread
+  flags |= MDB_NOTLS;
+
   MDB_env *env = NULL;
   int rc = mdb_env_create(&env);
   if (rc != 0) return js_mkerr(js, "lmdb_env_create failed: %s", mdb_strerror(rc));
@@ -470,7 +901,10 @@ static ant_value_t lmdb_open(ant_t *js, ant_value_t *args, int nargs) {
   handle->env = env;
   handle->closed = false;
   handle->read_only = read_only;
+  handle->write_map = write_map;
   handle->path = strndup(path, path_len);
+  handle->batch_max_ops = batch_max_ops > 0 ? batch_max_ops : 1;
+  handle->batch_max_bytes = batch_max_bytes;
   handle->next_global = env_handles;
   env_handles = handle;
 
@@ -587,7 +1021,11 @@ static ant_value_t lmdb_env_close_method(ant_t *js, ant_value_t *args, int nargs
   ant_value_t self = js_getthis(js);
   lmdb_env_handle_t *env = get_env_handle(js, self, false);
   if (!env) return js_mkerr(js, "Invalid LMDB env");
+  if (env->writer && env_has_open_write_txn(env)) {
+    return js_mkerr(js, "Cannot close LMDB env with batched writes pending while a write transaction is open");
+  }
 
+  lmdb_writer_stop(env, true);
   env_handle_close(env);
   unregister_env_ref_by_obj(self);
   return js_mkundef();
@@ -605,6 +1043,78 @@ static ant_value_t lmdb_env_sync_method(ant_t *js, ant_value_t *args, int nargs)
   return js_mkundef();
 }
 
+static ant_value_t lmdb_env_set_flags_method(ant_t *js, ant_value_t *args, int nargs) {
+  lmdb_env_handle_t *env = get_env_handle(js, js_getthis(js), true);
+  if (!env) return js_mkerr(js, "Invalid or closed LMDB env");
+  if (nargs < 1 || vtype(args[0]) != T_OBJ) return js_mkerr(js, "env.setFlags(options) requires an options object");
+
+  static const struct { const char *key; unsigned int flag; } durability[] = {
+    { "noSync", MDB_NOSYNC },
+    { "noMetaSync", MDB_NOMETASYNC },
+    { "mapAsync", MDB_MAPASYNC },
+  };
+
+  for (size_t i = 0; i < sizeof(durability) / sizeof(durability[0]); i++) {
+    ant_value_t val = js_get(js, args[0], durability[i].key);
+    if (vtype(val) == T_UNDEF) continue;
+    int rc = mdb_env_set_flags(env->env, durability[i].flag, js_truthy(js, val) ? 1 : 0);
+    if (rc != 0) return js_mkerr(js, "lmdb_env_set_flags(%s) failed: %s", durability[i].key, mdb_strerror(rc));
+  }
+
+  return js_mkundef();
+}
+
+static ant_value_t lmdb_writer_enqueue(
+  ant_t *js, lmdb_env_handle_t *env, ant_value_t owner, uint8_t kind,
+  MDB_dbi dbi, unsigned int flags, const MDB_val *key, const MDB_val *value
+) {
+  lmdb_writer_t *w = lmdb_writer_get(js, env);
+  if (!w) return js_mkerr(js, "Failed to start LMDB writer thread");
+
+  size_t key_len = key ? key->mv_size : 0;
+  size_t value_len = value ? value->mv_size : 0;
+  lmdb_write_op_t *op = ant_calloc(sizeof(lmdb_write_op_t) + key_len + value_len);
+  if (!op) return js_mkerr(js, "Out of memory");
+
+  op->kind = kind;
+  op->dbi = dbi;
+  op->flags = flags;
+  op->has_value = value != NULL;
+  op->key.mv_data = op->data;
+  op->key.mv_size = key_len;
+  op->value.mv_data = op->data + key_len;
+  op->value.mv_size = value_len;
+  if (key_len > 0) memcpy(op->key.mv_data, key->mv_data, key_len);
+  if (value_len > 0) memcpy(op->value.mv_data, value->mv_data, value_len);
+
+  op->promise = js_mkpromise(js);
+  op->owner = owner;
+
+  write_ops_append(&w->stage_head, &w->stage_tail, op, op);
+  w->stage_ops++;
+  w->stage_bytes += key_len + value_len;
+  if (w->pending++ == 0) uv_ref((uv_handle_t *)&w->async);
+
+  if (w->stage_ops >= w->max_ops || w->stage_bytes >= w->max_bytes) lmdb_writer_handoff(w);
+  else if (!uv_is_active((uv_handle_t *)&w->timer)) uv_timer_start(&w->timer, lmdb_writer_timer_cb, 0, 0);
+
+  return op->promise;
+}
+
+static ant_value_t lmdb_env_flush_method(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t self = js_getthis(js);
+  lmdb_env_handle_t *env = get_env_handle(js, self, true);
+  if (!env) return js_mkerr(js, "Invalid or closed LMDB env");
+
+  if (!env->writer) {
+    ant_value_t promise = js_mkpromise(js);
+    js_resolve_promise(js, promise, js_mkundef());
+    return promise;
+  }
+
+  return lmdb_writer_enqueue(js, env, self, LMDB_WRITE_FLUSH, 0, 0, NULL, NULL);
+}
+
 static ant_value_t lmdb_env_stat_method(ant_t *js, ant_value_t *args, int nargs) {
   lmdb_env_handle_t *env = get_env_handle(js, js_getthis(js), true);
   if (!env) return js_mkerr(js, "Invalid or closed LMDB env");
@@ -825,6 +1335,284 @@ static ant_value_t lmdb_db_get_string(ant_t *js, ant_value_t *args, int nargs) {
   return lmdb_db_get_impl(js, args, nargs, true);
 }
 
+static bool range_copy_bound(ant_t *js, ant_value_t options, const char *name, MDB_val *out) {
+  ant_value_t val = js_get(js, options, name);
+  if (vtype(val) == T_UNDEF) return true;
+
+  MDB_val src;
+  if (!js_to_mdb_val(js, val, &src)) return false;
+
+  out->mv_data = malloc(src.mv_size > 0 ? src.mv_size : 1);
+  if (!out->mv_data) return false;
+  if (src.mv_size > 0) memcpy(out->mv_data, src.mv_data, src.mv_size);
+  out->mv_size = src.mv_size;
+  return true;
+}
+
+static int range_position(lmdb_range_handle_t *range, MDB_val *key, MDB_val *value) {
+  if (!range->start.mv_data) return mdb_cursor_get(range->cursor, key, value, range->reverse ? MDB_LAST : MDB_FIRST);
+
+  *key = range->start;
+  int rc = mdb_cursor_get(range->cursor, key, value, MDB_SET_RANGE);
+  if (!range->reverse) return rc;
+
+  // reverse scans start at the last key <= start
+  if (rc == MDB_NOTFOUND) return mdb_cursor_get(range->cursor, key, value, MDB_LAST);
+  if (rc == 0 && mdb_cmp(range->txn, range->db->dbi, key, &range->start) > 0)
+    return mdb_cursor_get(range->cursor, key, value, MDB_PREV);
+  return rc;
+}
+
+static int range_step(lmdb_range_handle_t *range, MDB_val *key, MDB_val *value) {
+  int rc;
+  if (!range->started) {
+    range->started = true;
+    rc = range_position(range, key, value);
+  } else rc = mdb_cursor_get(range->cursor, key, value, range->reverse ? MDB_PREV : MDB_NEXT);
+  if (rc != 0 || !range->end.mv_data) return rc;
+
+  int cmp = mdb_cmp(range->txn, range->db->dbi, key, &range->end);
+  if (range->reverse ? cmp <= 0 : cmp >= 0) return MDB_NOTFOUND;
+  return 0;
+}
+
+// batchBuffer copies every value of a batch into one ArrayBuffer and hands
+// out Uint8Array slices of it; the map itself is mapped read-only, so these
+// are copies, just one allocation per batch instead of one per value
+static ant_value_t range_attach_batch_buffer(
+  ant_t *js, ant_value_t batch, const MDB_val *values, size_t count, size_t total
+) {
+  ArrayBufferData *arena = create_array_buffer_data(total);
+  if (!arena) return js_mkerr(js, "Out of memory");
+
+  ant_value_t arena_obj = create_arraybuffer_obj(js, arena);
+  free_array_buffer_data(arena);
+  GC_ROOT_SAVE(root_mark, js);
+  GC_ROOT_PIN(js, arena_obj);
+
+  size_t offset = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (values[i].mv_size) memcpy(arena->data + offset, values[i].mv_data, values[i].mv_size);
+    ant_value_t view = create_typed_array_with_buffer(
+      js, TYPED_ARRAY_UINT8, arena, offset, values[i].mv_size, "Uint8Array", arena_obj
+    );
+    if (is_err(view)) {
+      GC_ROOT_RESTORE(js, root_mark);
+      return view;
+    }
+    js_set(js, js_arr_get(js, batch, (ant_offset_t)i), "value", view);
+    offset += values[i].mv_size;
+  }
+
+  GC_ROOT_RESTORE(js, root_mark);
+  return js_mkundef();
+}
+
+static void range_close_obj(ant_t *js, ant_value_t self, lmdb_range_handle_t *range) {
+  range_handle_close(range);
+  js_set_slot_wb(js, self, SLOT_ENTRIES, js_mkundef());
+}
+
+static ant_value_t range_fill_batch(ant_t *js, ant_value_t self, lmdb_range_handle_t *range) {
+  GC_ROOT_SAVE(root_mark, js);
+  ant_value_t batch = js_mkarr(js);
+  GC_ROOT_PIN(js, batch);
+
+  // with batchBuffer the values are copied once the batch is known, the
+  // cursor pointers stay valid until the snapshot is released below
+  MDB_val *values = NULL;
+  size_t values_cap = 0;
+  size_t values_bytes = 0;
+
+  size_t filled = 0;
+  while (!range->done && filled < range->batch_size) {
+    if (range->count >= range->limit) {
+      range->done = true;
+      break;
+    }
+
+    MDB_val key;
+    MDB_val value;
+    int rc = range_step(range, &key, &value);
+    if (rc == MDB_NOTFOUND) {
+      range->done = true;
+      break;
+    }
+    if (rc != 0) {
+      free(values);
+      range_close_obj(js, self, range);
+      GC_ROOT_RESTORE(js, root_mark);
+      return js_mkerr(js, "lmdb_cursor_get failed: %s", mdb_strerror(rc));
+    }
+
+    ant_value_t entry = js_mkobj(js);
+    GC_ROOT_PIN(js, entry);
+    js_set(js, entry, "key", mdb_val_to_js(js, &key, range->keys_as_string));
+    if (range->batch_buffer) {
+      if (filled == values_cap) {
+        size_t cap = values_cap ? values_cap * 2 : 16;
+        MDB_val *grown = realloc(values, cap * sizeof(*values));
+        if (!grown) {
+          free(values);
+          GC_ROOT_RESTORE(js, root_mark);
+          return js_mkerr(js, "Out of memory");
+        }
+        values = grown;
+        values_cap = cap;
+      }
+      values[filled] = value;
+      values_bytes += value.mv_size;
+    } else js_set(js, entry, "value", mdb_val_to_js(js, &value, range->values_as_string));
+    js_arr_push(js, batch, entry);
+
+    range->count++;
+    filled++;
+  }
+
+  if (range->batch_buffer && filled > 0) {
+    ant_value_t attached = range_attach_batch_buffer(js, batch, values, filled, values_bytes);
+    if (is_err(attached)) batch = attached;
+  }
+  free(values);
+  if (range->done) range_handle_release(range);
+
+  GC_ROOT_RESTORE(js, root_mark);
+  return batch;
+}
+
+static bool range_advance(ant_t *js, lmdb_range_handle_t *range, ant_value_t self, ant_value_t *out) {
+  if (range->closed) return false;
+
+  ant_value_t batch = js_get_slot(self, SLOT_ENTRIES);
+  if (vtype(batch) != T_ARR || range->batch_pos >= (size_t)js_arr_len(js, batch)) {
+    if (range->done) return false;
+    batch = range_fill_batch(js, self, range);
+    if (is_err(batch)) {
+      *out = batch;
+      return false;
+    }
+    js_set_slot_wb(js, self, SLOT_ENTRIES, batch);
+    range->batch_pos = 0;
+    if (js_arr_len(js, batch) == 0) return false;
+  }
+
+  *out = js_arr_get(js, batch, (ant_offset_t)range->batch_pos++);
+  return true;
+}
+
+static bool advance_lmdb_range(ant_t *js, js_iter_t *it, ant_value_t *out) {
+  lmdb_range_handle_t *range = get_range_handle(js, it->iterator);
+  if (!range) return false;
+  return range_advance(js, range, it->iterator, out);
+}
+
+static ant_value_t lmdb_range_next(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t self = js_getthis(js);
+  lmdb_range_handle_t *range = get_range_handle(js, self);
+  if (!range) return js_mkerr(js, "Invalid LMDB range iterator");
+
+  ant_value_t value = js_mkundef();
+  bool has_value = range_advance(js, range, self, &value);
+  if (is_err(value)) return value;
+  return js_iter_result(js, has_value, value);
+}
+
+static ant_value_t lmdb_range_next_batch(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t self = js_getthis(js);
+  lmdb_range_handle_t *range = get_range_handle(js, self);
+  if (!range) return js_mkerr(js, "Invalid LMDB range iterator");
+  if (range->closed) return js_mkarr(js);
+
+  ant_value_t cached = js_get_slot(self, SLOT_ENTRIES);
+  size_t cached_len = vtype(cached) == T_ARR ? (size_t)js_arr_len(js, cached) : 0;
+  js_set_slot_wb(js, self, SLOT_ENTRIES, js_mkundef());
+
+  if (range->batch_pos < cached_len) {
+    ant_value_t rest = js_mkarr(js);
+    for (size_t i = range->batch_pos; i < cached_len; i++) js_arr_push(js, rest, js_arr_get(js, cached, (ant_offset_t)i));
+    range->batch_pos = 0;
+    return rest;
+  }
+
+  range->batch_pos = 0;
+  if (range->done) return js_mkarr(js);
+  return range_fill_batch(js, self, range);
+}
+
+static ant_value_t lmdb_range_return(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t self = js_getthis(js);
+  lmdb_range_handle_t *range = get_range_handle(js, self);
+  if (range) range_close_obj(js, self, range);
+  return js_iter_result(js, false, js_mkundef());
+}
+
+static ant_value_t lmdb_range_close(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t self = js_getthis(js);
+  lmdb_range_handle_t *range = get_range_handle(js, self);
+  if (range) range_close_obj(js, self, range);
+  return js_mkundef();
+}
+
+static ant_value_t lmdb_db_get_range(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t self = js_getthis(js);
+  lmdb_db_handle_t *db = get_db_handle(js, self, true);
+  if (!db) return js_mkerr(js, "Invalid or closed LMDB database handle");
+
+  ant_value_t options = nargs > 0 ? args[0] : js_mkundef();
+  if (vtype(options) != T_UNDEF && vtype(options) != T_OBJ) {
+    return js_mkerr(js, "db.getRange(options?) options must be an object");
+  }
+
+  bool keys_as_string = true;
+  bool values_as_string = false;
+  if (vtype(options) == T_OBJ) {
+    if (!parse_get_encoding(js, js_get(js, options, "keyEncoding"), &keys_as_string)) {
+      return js_mkerr(js, "db.getRange keyEncoding must be 'utf8' or 'bytes'");
+    }
+    if (!parse_get_encoding(js, js_get(js, options, "encoding"), &values_as_string)) {
+      return js_mkerr(js, "db.getRange encoding must be 'utf8' or 'bytes'");
+    }
+  }
+
+  bool batch_buffer = option_bool(js, options, "batchBuffer", false);
+
+  lmdb_range_handle_t *range = ant_calloc(sizeof(lmdb_range_handle_t));
+  if (!range) return js_mkerr(js, "Out of memory");
+
+  range->db = db;
+  range->env = db->env;
+  range->reverse = option_bool(js, options, "reverse", false);
+  range->keys_as_string = keys_as_string;
+  range->values_as_string = values_as_string && !batch_buffer;
+  range->batch_buffer = batch_buffer;
+  range->limit = option_size(js, options, "limit", SIZE_MAX);
+  range->batch_size = option_size(js, options, "batchSize", LMDB_RANGE_BATCH);
+  if (range->batch_size == 0) range->batch_size = 1;
+
+  if (vtype(options) == T_OBJ && (
+    !range_copy_bound(js, options, "start", &range->start) ||
+    !range_copy_bound(js, options, "end", &range->end))) {
+    range_handle_close(range);
+    free(range);
+    return js_mkerr(js, "LMDB range bounds must be string, ArrayBuffer, or TypedArray");
+  }
+
+  int rc = mdb_txn_begin(db->env->env, NULL, MDB_RDONLY, &range->txn);
+  if (rc == 0) rc = mdb_cursor_open(range->txn, db->dbi, &range->cursor);
+  if (rc != 0) {
+    range_handle_close(range);
+    free(range);
+    return js_mkerr(js, "lmdb_cursor_open failed: %s", mdb_strerror(rc));
+  }
+
+  range->next_in_env = db->env->range_head;
+  db->env->range_head = range;
+  range->next_global = range_handles;
+  range_handles = range;
+
+  return make_range_obj(js, range, self);
+}
+
 static ant_value_t lmdb_db_put(ant_t *js, ant_value_t *args, int nargs) {
   if (nargs < 2) return js_mkerr(js, "db.put(key, value, options?) requires key and value");
   lmdb_db_handle_t *db = get_db_handle(js, js_getthis(js), true);
@@ -905,6 +1693,53 @@ static ant_value_t lmdb_db_del(ant_t *js, ant_value_t *args, int nargs) {
   return js_true;
 }
 
+static bool lmdb_key_fits(lmdb_db_handle_t *db, const MDB_val *key) {
+  return key->mv_size > 0 && key->mv_size <= (size_t)mdb_env_get_maxkeysize(db->env->env);
+}
+
+static ant_value_t lmdb_db_put_async(ant_t *js, ant_value_t *args, int nargs) {
+  if (nargs < 2) return js_mkerr(js, "db.putAsync(key, value, options?) requires key and value");
+  ant_value_t self = js_getthis(js);
+  lmdb_db_handle_t *db = get_db_handle(js, self, true);
+  if (!db) return js_mkerr(js, "Invalid or closed LMDB database handle");
+  if (db->env->read_only) return js_mkerr(js, "Cannot write on read-only LMDB env");
+
+  MDB_val key;
+  MDB_val value;
+  if (!js_to_mdb_val(js, args[0], &key) || !js_to_mdb_val(js, args[1], &value)) {
+    return js_mkerr(js, "LMDB key/value must be string, ArrayBuffer, or TypedArray");
+  }
+  if (!lmdb_key_fits(db, &key)) return js_mkerr(js, "LMDB key must be non-empty and at most %d bytes", mdb_env_get_maxkeysize(db->env->env));
+
+  ant_value_t options = nargs > 2 ? args[2] : js_mkundef();
+  unsigned int flags = 0;
+  if (option_bool(js, options, "noOverwrite", false)) flags |= MDB_NOOVERWRITE;
+  if (option_bool(js, options, "noDupData", false)) flags |= MDB_NODUPDATA;
+
+  return lmdb_writer_enqueue(js, db->env, self, LMDB_WRITE_PUT, db->dbi, flags, &key, &value);
+}
+
+static ant_value_t lmdb_db_del_async(ant_t *js, ant_value_t *args, int nargs) {
+  if (nargs < 1) return js_mkerr(js, "db.delAsync(key, value?) requires key");
+  ant_value_t self = js_getthis(js);
+  lmdb_db_handle_t *db = get_db_handle(js, self, true);
+  if (!db) return js_mkerr(js, "Invalid or closed LMDB database handle");
+  if (db->env->read_only) return js_mkerr(js, "Cannot delete on read-only LMDB env");
+
+  MDB_val key;
+  if (!js_to_mdb_val(js, args[0], &key)) return js_mkerr(js, "LMDB key must be string, ArrayBuffer, or TypedArray");
+  if (!lmdb_key_fits(db, &key)) return js_mkerr(js, "LMDB key must be non-empty and at most %d bytes", mdb_env_get_maxkeysize(db->env->env));
+
+  MDB_val value;
+  MDB_val *value_ptr = NULL;
+  if (nargs > 1 && vtype(args[1]) != T_UNDEF) {
+    if (!js_to_mdb_val(js, args[1], &value)) return js_mkerr(js, "LMDB value must be string, ArrayBuffer, or TypedArray");
+    value_ptr = &value;
+  }
+
+  return lmdb_writer_enqueue(js, db->env, self, LMDB_WRITE_DEL, db->dbi, 0, &key, value_ptr);
+}
+
 static ant_value_t lmdb_db_clear(ant_t *js, ant_value_t *args, int nargs) {
   lmdb_db_handle_t *db = get_db_handle(js, js_getthis(js), true);
   if (!db) return js_mkerr(js, "Invalid or closed LMDB database handle");
@@ -930,6 +1765,9 @@ static ant_value_t lmdb_db_drop(ant_t *js, ant_value_t *args, int nargs) {
   lmdb_db_handle_t *db = get_db_handle(js, self, true);
   if (!db) return js_mkerr(js, "Invalid or closed LMDB database handle");
   if (db->env->read_only) return js_mkerr(js, "Cannot drop on read-only LMDB env");
+  if (db->env->writer && env_has_open_write_txn(db->env)) {
+    return js_mkerr(js, "Cannot drop LMDB database with batched writes pending while a write transaction is open");
+  }
 
   bool del_db = true;
   if (nargs > 0 && vtype(args[0]) == T_OBJ) {
@@ -938,6 +1776,9 @@ static ant_value_t lmdb_db_drop(ant_t *js, ant_value_t *args, int nargs) {
     del_db = js_truthy(js, args[0]);
   }
 
+  lmdb_writer_stop(db->env, true);
+  close_ranges_for_db(db);
+
   MDB_txn *txn = NULL;
   int rc = mdb_txn_begin(db->env->env, NULL, 0, &txn);
   if (rc != 0) return js_mkerr(js, "lmdb_txn_begin failed: %s", mdb_strerror(rc));
@@ -971,6 +1812,11 @@ static ant_value_t lmdb_db_close(ant_t *js, ant_value_t *args, int nargs) {
   }
 
   if (db->env && !db->env->closed) {
+    if (db->env->writer && env_has_open_write_txn(db->env)) {
+      return js_mkerr(js, "Cannot close LMDB database with batched writes pending while a write transaction is open");
+    }
+    lmdb_writer_stop(db->env, true);
+    close_ranges_for_db(db);
     mdb_dbi_close(db->env->env, db->dbi);
     list_remove_db(db->env, db);
   }
@@ -1013,6 +1859,8 @@ static void ensure_lmdb_prototypes(ant_t *js) {
   js_set(js, env_proto, "beginTxn", js_mkfun(lmdb_env_begin_txn));
   js_set(js, env_proto, "close", js_mkfun(lmdb_env_close_method));
   js_set(js, env_proto, "sync", js_mkfun(lmdb_env_sync_method));
+  js_set(js, env_proto, "flush", js_mkfun(lmdb_env_flush_method));
+  js_set(js, env_proto, "setFlags", js_mkfun(lmdb_env_set_flags_method));
   js_set(js, env_proto, "stat", js_mkfun(lmdb_env_stat_method));
   js_set(js, env_proto, "info", js_mkfun(lmdb_env_info_method));
   js_set_sym(js, env_proto, get_toStringTag_sym(), js_mkstr(js, "LMDBEnv", 7));
@@ -1030,6 +1878,9 @@ static void ensure_lmdb_prototypes(ant_t *js) {
   js_set(js, db_proto, "getString", js_mkfun(lmdb_db_get_string));
   js_set(js, db_proto, "put", js_mkfun(lmdb_db_put));
   js_set(js, db_proto, "del", js_mkfun(lmdb_db_del));
+  js_set(js, db_proto, "getRange", js_mkfun(lmdb_db_get_range));
+  js_set(js, db_proto, "putAsync", js_mkfun(lmdb_db_put_async));
+  js_set(js, db_proto, "delAsync", js_mkfun(lmdb_db_del_async));
   js_set(js, db_proto, "clear", js_mkfun(lmdb_db_clear));
   js_set(js, db_proto, "drop", js_mkfun(lmdb_db_drop));
   js_set(js, db_proto, "close", js_mkfun(lmdb_db_close));
@@ -1056,12 +1907,24 @@ static void ensure_lmdb_prototypes(ant_t *js) {
   js_mkprop_fast(js, txn_ctor_obj, "name", 4, ANT_STRING("LMDBTxn"));
   js_set_descriptor(js, txn_ctor_obj, "name", 4, 0);
 
+  ant_value_t range_proto = js_mkobj(js);
+
+  js_set_proto_init(range_proto, js->sym.iterator_proto);
+  js_set(js, range_proto, "next", js_mkfun(lmdb_range_next));
+  js_set(js, range_proto, "nextBatch", js_mkfun(lmdb_range_next_batch));
+  js_set(js, range_proto, "return", js_mkfun(lmdb_range_return));
+  js_set(js, range_proto, "close", js_mkfun(lmdb_range_close));
+  js_set_sym(js, range_proto, get_iterator_sym(), js_mkfun(sym_this_cb));
+  js_set_sym(js, range_proto, get_toStringTag_sym(), js_mkstr(js, "LMDBRangeIterator", 17));
+  js_iter_register_advance(range_proto, advance_lmdb_range);
+
   lmdb_types.env_ctor = js_obj_to_func(js, env_ctor_obj);
   lmdb_types.db_ctor = js_obj_to_func(js, db_ctor_obj);
   lmdb_types.txn_ctor = js_obj_to_func(js, txn_ctor_obj);
   lmdb_types.env_proto = env_proto;
   lmdb_types.db_proto = db_proto;
   lmdb_types.txn_proto = txn_proto;
+  lmdb_types.range_proto = range_proto;
   lmdb_types.ready = true;
 }
 
@@ -1097,6 +1960,17 @@ static ant_value_t make_txn_obj(ant_t *js, lmdb_txn_handle_t *txn, ant_value_t e
   return obj;
 }
 
+static ant_value_t make_range_obj(ant_t *js, lmdb_range_handle_t *range, ant_value_t db_obj) {
+  ensure_lmdb_prototypes(js);
+  ant_value_t obj = js_mkobj(js);
+  js_set_native(obj, range, LMDB_RANGE_NATIVE_TAG);
+  js_set_finalizer(obj, lmdb_range_finalize);
+  js_set_slot_wb(js, obj, SLOT_DATA, db_obj);
+  register_range_ref(obj, range);
+  if (is_special_object(lmdb_types.range_proto)) js_set_proto_init(obj, lmdb_types.range_proto);
+  return obj;
+}
+
 ant_value_t lmdb_library(ant_t *js) {
   ensure_lmdb_prototypes(js);
   ant_value_t lib = js_mkobj(js);
@@ -1142,10 +2016,32 @@ void gc_mark_lmdb(ant_t *js, gc_mark_fn mark) {
     mark(js, lmdb_types.env_proto);
     mark(js, lmdb_types.db_proto);
     mark(js, lmdb_types.txn_proto);
+    mark(js, lmdb_types.range_proto);
+  }
+
+  for (lmdb_env_handle_t *env = env_handles; env; env = env->next_global) {
+    lmdb_writer_t *w = env->writer;
+    if (!w) continue;
+
+    for (lmdb_write_op_t *op = w->stage_head; op; op = op->next) {
+      mark(js, op->promise);
+      mark(js, op->owner);
+    }
+
+    pthread_mutex_lock(&w->lock);
+    lmdb_write_op_t *lists[] = { w->queue_head, w->inflight, w->done_head };
+    for (int i = 0; i < 3; i++) for (lmdb_write_op_t *op = lists[i]; op; op = op->next) {
+      mark(js, op->promise);
+      mark(js, op->owner);
+    }
+    pthread_mutex_unlock(&w->lock);
   }
 }
 
 void cleanup_lmdb_module(void) {
+  for (lmdb_range_handle_t *range = range_handles; range; range = range->next_global)
+    range_handle_close(range);
+
   lmdb_txn_handle_t *txn = txn_handles;
   while (txn) {
     if (!txn->closed && txn->txn) {
@@ -1156,6 +2052,9 @@ void cleanup_lmdb_module(void) {
     txn = txn->next_global;
   }
 
+  for (lmdb_env_handle_t *env = env_handles; env; env = env->next_global)
+    lmdb_writer_stop(env, false);
+
   lmdb_db_handle_t *db = db_handles;
   while (db) {
     if (!db->closed && db->env && !db->env->closed) {
@@ -1171,6 +2070,15 @@ void cleanup_lmdb_module(void) {
     env = env->next_global;
   }
 
+  lmdb_range_handle_t *range = range_handles;
+  while (range) {
+    lmdb_range_handle_t *next = range->next_global;
+    range_handle_close(range);
+    free(range);
+    range = next;
+  }
+  range_handles = NULL;
+
   txn = txn_handles;
   while (txn) {
     lmdb_txn_handle_t *next = txn->next_global;
@@ -1218,5 +2126,12 @@ void cleanup_lmdb_module(void) {
     txn_refs = next;
   }
 
+  while (range_refs) {
+    lmdb_range_ref_t *next = range_refs->next;
+    js_clear_native(range_refs->obj, LMDB_RANGE_NATIVE_TAG);
+    free(range_refs);
+    range_refs = next;
+  }
+
   lmdb_types = (lmdb_js_types_t){0};
 }
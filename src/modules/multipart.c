@@ -6,10 +6,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <uv.h>
 
 #include "ant.h"
+#include "ptr.h"
 #include "errors.h"
 #include "internal.h"
+#include "gc/roots.h"
+#include "gc/modules.h"
 
 #include "modules/blob.h"
 #include "modules/formdata.h"
@@ -254,9 +258,7 @@ static void multipart_part_info_clear(multipart_part_info_t *info) {
   info->content_type = NULL;
 }
 
-static bool multipart_parse_headers(
-  ant_t *js, char *headers, multipart_part_info_t *info, ant_value_t *err_out
-) {
+static bool multipart_parse_headers(char *headers, multipart_part_info_t *info, bool *oom) {
   char *saveptr = NULL;
 
   for (
@@ -286,161 +288,601 @@ static bool multipart_parse_headers(
     free(info->content_type);
     info->content_type = strdup(value);
     if (!info->content_type) {
-      *err_out = js_mkerr(js, "out of memory");
+      *oom = true;
       return false;
     }}
   }
 
-  if (info->name) return true;
-  *err_out = multipart_invalid(js);
-  
-  return false;
+  return info->name != NULL;
 }
 
-static const uint8_t *multipart_find_part_end(
-  const uint8_t *p, const uint8_t *end, const char *delim, size_t delim_len
-) {
-  char *marker = malloc(delim_len + 3);
-  const uint8_t *part_end = NULL;
-  if (!marker) return NULL;
-
-  snprintf(marker, delim_len + 3, "\r\n%s", delim);
-  part_end = find_bytes(
-    p, (size_t)(end - p), 
-    (const uint8_t *)marker, delim_len + 2
-  );
+#define MULTIPART_MAX_HEADER_BYTES (16 * 1024)
+typedef enum {
+  MP_PREAMBLE = 0,
+  MP_DELIM_TAIL,
+  MP_HEADERS,
+  MP_BODY,
+  MP_DONE,
+  MP_FAILED
+} mp_state_t;
+
+typedef struct {
+  multipart_part_info_t info;
+  uint8_t *data;
+  size_t size;
+  size_t cap;
+  char *spill_path;
+  uv_file spill_fd;
+  uint32_t spill_pending;
+  bool ended;
+} mp_part_t;
+
+struct multipart_parser {
+  mp_state_t state;
+  bool oom;
   
-  free(marker);
-  return part_end;
+  // "\r\n--boundary", the leading CRLF belongs to the delimiter so
+  // part bodies never have to be trimmed after the fact
+  uint8_t *delim;
+  size_t delim_len;
+  size_t skip[256];
+
+  // bytes that could not be classified yet, a possible delimiter prefix
+  // in a body or an incomplete header block
+  uint8_t *carry;
+  size_t carry_len;
+  size_t carry_cap;
+
+  mp_part_t *parts;
+  size_t nparts;
+  size_t parts_cap;
+  size_t spill_threshold;
+
+  // spill writes run on the threadpool; the parser stays alive until the
+  // last one is back, even when its owner lets go of it first
+  uint32_t writes_pending;
+  bool write_failed;
+  bool orphaned;
+
+  // set while a result waits for writes still in flight
+  ant_t *js;
+  ant_value_t promise;
+  struct multipart_parser *next_waiting;
+};
+
+typedef struct {
+  uv_fs_t req;
+  multipart_parser_t *mp;
+  size_t part;
+  size_t len;
+  uint8_t data[];
+} mp_spill_write_t;
+
+static multipart_parser_t *waiting_parsers = NULL;
+
+static ssize_t mp_search(const multipart_parser_t *mp, const uint8_t *hay, size_t len) {
+  size_t n = mp->delim_len;
+  size_t i = 0;
+  uint8_t last = mp->delim[n - 1];
+
+  while (i + n <= len) {
+    uint8_t c = hay[i + n - 1];
+    if (c == last && memcmp(hay + i, mp->delim, n - 1) == 0) return (ssize_t)i;
+    i += mp->skip[c];
+  }
+
+  return -1;
 }
 
-static ant_value_t multipart_append_part(
-  ant_t *js, ant_value_t fd, const multipart_part_info_t *info,
-  const uint8_t *data, size_t size
-) {
-  if (info->filename) {
-    ant_value_t blob = blob_create(
-      js, data, size, info->content_type 
-      ? info->content_type : ""
+static bool mp_carry_append(multipart_parser_t *mp, const uint8_t *data, size_t len) {
+  if (len == 0) return true;
+  if (mp->carry_len + len > mp->carry_cap) {
+    size_t nc = mp->carry_cap ? mp->carry_cap * 2 : 256;
+    while (nc < mp->carry_len + len) nc *= 2;
+    uint8_t *nb = realloc(mp->carry, nc);
+    if (!nb) return false;
+    mp->carry = nb;
+    mp->carry_cap = nc;
+  }
+  memcpy(mp->carry + mp->carry_len, data, len);
+  mp->carry_len += len;
+  return true;
+}
+
+static int mp_file_close(uv_file fd) {
+  uv_fs_t req;
+  int rc = uv_fs_close(NULL, &req, fd, NULL);
+  uv_fs_req_cleanup(&req);
+  return rc;
+}
+
+static void mp_part_clear(mp_part_t *part) {
+  multipart_part_info_clear(&part->info);
+  free(part->data);
+  if (part->spill_fd >= 0) mp_file_close(part->spill_fd);
+  if (part->spill_path) {
+    uv_fs_t req;
+    uv_fs_unlink(NULL, &req, part->spill_path, NULL);
+    uv_fs_req_cleanup(&req);
+  }
+  free(part->spill_path);
+}
+
+static void mp_settle(multipart_parser_t *mp);
+
+static void mp_part_close_spill(multipart_parser_t *mp, mp_part_t *part) {
+  if (mp_file_close(part->spill_fd) != 0) mp->write_failed = true;
+  part->spill_fd = -1;
+}
+
+static void mp_on_spill_written(uv_fs_t *req) {
+  mp_spill_write_t *w = (mp_spill_write_t *)req->data;
+  multipart_parser_t *mp = w->mp;
+  mp_part_t *part = &mp->parts[w->part];
+
+  if (req->result < 0 || (size_t)req->result != w->len) mp->write_failed = true;
+  uv_fs_req_cleanup(req);
+  free(w);
+
+  mp->writes_pending--;
+  if (--part->spill_pending == 0 && part->ended && part->spill_fd >= 0)
+    mp_part_close_spill(mp, part);
+
+  if (mp->writes_pending > 0) return;
+  if (mp->orphaned) multipart_parser_free(mp);
+  else if (mp->js) mp_settle(mp);
+}
+
+// queues the bytes at their final offset, so writes finishing out of
+// order still leave the file in order
+static bool mp_spill_write(multipart_parser_t *mp, size_t index, const uint8_t *data, size_t len) {
+  mp_part_t *part = &mp->parts[index];
+
+  while (len > 0) {
+    size_t want = len > (1u << 30) ? (1u << 30) : len;
+    mp_spill_write_t *w = malloc(sizeof(*w) + want);
+    if (!w) return false;
+
+    w->mp = mp;
+    w->part = index;
+    w->len = want;
+    w->req.data = w;
+    memcpy(w->data, data, want);
+
+    uv_buf_t buf = uv_buf_init((char *)w->data, (unsigned int)want);
+    int rc = uv_fs_write(
+      uv_default_loop(), &w->req, part->spill_fd,
+      &buf, 1, (int64_t)part->size, mp_on_spill_written
     );
     
-    if (is_err(blob)) return blob;
-    
-    return formdata_append_file(
-      js, fd, js_mkstr(js, info->name, strlen(info->name)),
-      blob, js_mkstr(js, info->filename, strlen(info->filename))
-    );
+    if (rc < 0) {
+      free(w);
+      return false;
+    }
+
+    mp->writes_pending++;
+    part->spill_pending++;
+    part->size += want;
+    data += want;
+    len -= want;
   }
 
-  return formdata_append_string(
-    js, fd,
-    js_mkstr(js, info->name, strlen(info->name)),
-    js_mkstr(js, data, size)
-  );
+  return true;
 }
 
-static ant_value_t parse_formdata_multipart(
-  ant_t *js, const uint8_t *data, size_t size, const char *body_type
-) {
-  ant_value_t fd = 0;
-  char *boundary = NULL;
-  char *delim = NULL;
+// moves a file part that outgrew the threshold into a temp file, the rest
+// of its bytes are appended there as they arrive
+static bool mp_part_spill(multipart_parser_t *mp, size_t index) {
+  mp_part_t *part = &mp->parts[index];
+  char dir[1024];
+  size_t dir_len = sizeof(dir);
   
-  const uint8_t *p = data;
-  const uint8_t *end = data + size;
-  size_t delim_len = 0;
+  if (uv_os_tmpdir(dir, &dir_len) != 0) snprintf(dir, sizeof(dir), "/tmp");
+  size_t tpl_len = strlen(dir) + sizeof("/ant-upload-XXXXXX");
+  
+  char *tpl = malloc(tpl_len);
+  if (!tpl) return false;
+  snprintf(tpl, tpl_len, "%s/ant-upload-XXXXXX", dir);
+
+  uv_fs_t req;
+  int fd = uv_fs_mkstemp(NULL, &req, tpl, NULL);
+  free(tpl);
+  if (fd >= 0 && !(part->spill_path = strdup(req.path))) {
+    uv_fs_t unlink_req;
+    uv_fs_unlink(NULL, &unlink_req, req.path, NULL);
+    uv_fs_req_cleanup(&unlink_req);
+    mp_file_close(fd);
+    fd = -1;
+  }
+  uv_fs_req_cleanup(&req);
+  if (fd < 0) return false;
+  part->spill_fd = fd;
+
+  uint8_t *buffered = part->data;
+  size_t buffered_len = part->size;
+  part->data = NULL;
+  part->size = 0;
+  part->cap = 0;
+  
+  bool ok = mp_spill_write(mp, index, buffered, buffered_len);
+  free(buffered);
+  
+  return ok;
+}
 
-  if (!data || size == 0) return multipart_invalid(js);
-  boundary = ct_get_param_dup(body_type, "boundary");
-  if (!boundary || boundary[0] == '\0') goto invalid;
+static bool mp_part_write(multipart_parser_t *mp, const uint8_t *data, size_t len) {
+  size_t index = mp->nparts - 1;
+  mp_part_t *part = &mp->parts[index];
+  if (len == 0) return true;
 
-  fd = formdata_create_empty(js);
-  if (is_err(fd)) goto done;
+  if (part->spill_fd >= 0) return mp_spill_write(mp, index, data, len);
 
-  delim_len = strlen(boundary) + 2;
-  delim = malloc(delim_len + 1);
-  if (!delim) {
-    fd = js_mkerr(js, "out of memory");
-    goto done;
+  if (
+    part->info.filename && mp->spill_threshold > 0 &&
+    part->size + len > mp->spill_threshold
+  ) {
+    if (!mp_part_spill(mp, index)) return false;
+    return mp_part_write(mp, data, len);
   }
-  snprintf(delim, delim_len + 1, "--%s", boundary);
 
-  if ((size_t)(end - p) < delim_len || memcmp(p, delim, delim_len) != 0) goto invalid;
-  p += delim_len;
+  if (part->size + len > part->cap) {
+    size_t nc = part->cap ? part->cap * 2 : 4096;
+    while (nc < part->size + len) nc *= 2;
+    uint8_t *nb = realloc(part->data, nc);
+    if (!nb) return false;
+    part->data = nb;
+    part->cap = nc;
+  }
 
-next_part:
-  if (p > end) goto done;
-  if ((size_t)(end - p) >= 2 && memcmp(p, "--", 2) == 0) goto done;
-  if ((size_t)(end - p) < 2 || memcmp(p, "\r\n", 2) != 0) goto invalid;
-  p += 2;
+  memcpy(part->data + part->size, data, len);
+  part->size += len;
+  
+  return true;
+}
 
-  {
-    ant_value_t r = 0;
-    ant_value_t hdr_err = js_mkundef();
-    const uint8_t *hdr_end = find_bytes(
-      p, (size_t)(end - p), (const uint8_t *)"\r\n\r\n", 4
-    );
-    
-    char *headers = NULL;
-    multipart_part_info_t info = {0};
-    const uint8_t *part_end = NULL;
+// a spilled part's file is closed once its last write is back
+static void mp_part_end(multipart_parser_t *mp) {
+  mp_part_t *part = &mp->parts[mp->nparts - 1];
+  part->ended = true;
+  if (part->spill_fd >= 0 && part->spill_pending == 0) mp_part_close_spill(mp, part);
+}
 
-    if (!hdr_end) goto invalid;
+static bool mp_start_part(multipart_parser_t *mp, const uint8_t *hdr, size_t len) {
+  multipart_part_info_t info = {0};
+  char *headers = strndup((const char *)hdr, len);
 
-    headers = strndup((const char *)p, (size_t)(hdr_end - p));
-    if (!headers) {
-      fd = js_mkerr(js, "out of memory");
-      goto done;
-    }
-    p = hdr_end + 4;
+  if (!headers) { mp->oom = true; return false; }
+  bool ok = multipart_parse_headers(headers, &info, &mp->oom);
+  free(headers);
+  
+  if (!ok) {
+    multipart_part_info_clear(&info);
+    return false;
+  }
 
-    if (!multipart_parse_headers(js, headers, &info, &hdr_err)) {
-      free(headers);
+  if (mp->nparts == mp->parts_cap) {
+    size_t nc = mp->parts_cap ? mp->parts_cap * 2 : 8;
+    mp_part_t *np = realloc(mp->parts, nc * sizeof(*np));
+    if (!np) {
       multipart_part_info_clear(&info);
-      if (is_err(hdr_err)) { fd = hdr_err; goto done; }
-      goto invalid;
+      mp->oom = true;
+      return false;
     }
-    free(headers);
+    mp->parts = np;
+    mp->parts_cap = nc;
+  }
 
-    part_end = multipart_find_part_end(p, end, delim, delim_len);
-    if (!part_end) {
-      multipart_part_info_clear(&info);
-      goto invalid;
+  mp->parts[mp->nparts++] = (mp_part_t){ .info = info, .spill_fd = -1 };
+  return true;
+}
+
+// consumes as much of p as can be classified and returns the byte count,
+// whatever is left over needs more input
+static size_t mp_process(multipart_parser_t *mp, const uint8_t *p, size_t len) {
+  size_t i = 0;
+
+next:
+  switch (mp->state) {
+  case MP_PREAMBLE: {
+    ssize_t at = mp_search(mp, p + i, len - i);
+    if (at < 0) {
+      if (len - i >= mp->delim_len) i = len - (mp->delim_len - 1);
+      return i;
     }
+    i += (size_t)at + mp->delim_len;
+    mp->state = MP_DELIM_TAIL;
+    goto next;
+  }
 
-    r = multipart_append_part(js, fd, &info, p, (size_t)(part_end - p));
-    multipart_part_info_clear(&info);
-    if (is_err(r)) { fd = r; goto done; }
+  case MP_DELIM_TAIL:
+    if (len - i < 2) return i;
+    if (memcmp(p + i, "--", 2) == 0) {
+      mp->state = MP_DONE;
+      return len;
+    }
+    if (memcmp(p + i, "\r\n", 2) != 0) goto fail;
+    i += 2;
+    mp->state = MP_HEADERS;
+    goto next;
+
+  case MP_HEADERS: {
+    const uint8_t *hdr_end = find_bytes(p + i, len - i, (const uint8_t *)"\r\n\r\n", 4);
+    if (!hdr_end) {
+      if (len - i > MULTIPART_MAX_HEADER_BYTES) goto fail;
+      return i;
+    }
+    if (!mp_start_part(mp, p + i, (size_t)(hdr_end - (p + i)))) goto fail;
+    i = (size_t)(hdr_end - p) + 4;
+    mp->state = MP_BODY;
+    goto next;
+  }
 
-    p = part_end + 2 + delim_len;
-    if ((size_t)(end - p) >= 2 && memcmp(p, "--", 2) == 0) goto done;
+  case MP_BODY: {
+    ssize_t at = mp_search(mp, p + i, len - i);
+    if (at < 0) {
+      size_t keep = mp->delim_len - 1;
+      if (len - i <= keep) return i;
+      if (!mp_part_write(mp, p + i, len - i - keep)) goto oom;
+      return len - keep;
+    }
+    if (!mp_part_write(mp, p + i, (size_t)at)) goto oom;
+    mp_part_end(mp);
+    i += (size_t)at + mp->delim_len;
+    mp->state = MP_DELIM_TAIL;
+    goto next;
   }
 
-  goto next_part;
+  case MP_DONE:
+    return len;
 
-invalid:
-  fd = multipart_invalid(js);
+  case MP_FAILED:
+    return 0;
+  }
 
-done:
+oom:
+  mp->oom = true;
+fail:
+  mp->state = MP_FAILED;
+  return 0;
+}
+
+multipart_parser_t *multipart_parser_new(const char *body_type, size_t spill_threshold) {
+  char *boundary = NULL;
+  multipart_parser_t *mp = NULL;
+
+  if (!ct_is_type(body_type, "multipart/form-data")) return NULL;
+  boundary = ct_get_param_dup(body_type, "boundary");
+  if (!boundary || boundary[0] == '\0') goto fail;
+
+  mp = calloc(1, sizeof(*mp));
+  if (!mp) goto fail;
+  mp->spill_threshold = spill_threshold;
+
+  mp->delim_len = strlen(boundary) + 4;
+  mp->delim = malloc(mp->delim_len + 1);
+  if (!mp->delim) goto fail;
+  snprintf((char *)mp->delim, mp->delim_len + 1, "\r\n--%s", boundary);
+  free(boundary);
+
+  for (size_t c = 0; c < 256; c++) mp->skip[c] = mp->delim_len;
+  for (size_t k = 0; k + 1 < mp->delim_len; k++) mp->skip[mp->delim[k]] = mp->delim_len - 1 - k;
+
+  // the first delimiter has no CRLF in front of it
+  if (!mp_carry_append(mp, (const uint8_t *)"\r\n", 2)) goto fail;
+  return mp;
+
+fail:
   free(boundary);
-  free(delim);
+  multipart_parser_free(mp);
+  return NULL;
+}
+
+bool multipart_parser_feed(multipart_parser_t *mp, const uint8_t *data, size_t len) {
+  size_t off = 0;
+
+  if (mp->state == MP_FAILED) return false;
+  if (len == 0) return true;
+
+  if (mp->carry_len > 0) {
+    size_t old = mp->carry_len;
+    // a body only ever carries a partial delimiter, so a delimiter's worth
+    // of new bytes settles it and the rest is scanned in place
+    size_t take = mp->state == MP_BODY && len > mp->delim_len ? mp->delim_len : len;
+    
+    if (!mp_carry_append(mp, data, take)) goto oom;
+    size_t used = mp_process(mp, mp->carry, mp->carry_len);
+    if (mp->state == MP_FAILED) return false;
+
+    if (used < old) {
+      memmove(mp->carry, mp->carry + used, mp->carry_len - used);
+      mp->carry_len -= used;
+      if (!mp_carry_append(mp, data + take, len - take)) goto oom;
+      used = mp_process(mp, mp->carry, mp->carry_len);
+      if (mp->state == MP_FAILED) return false;
+      memmove(mp->carry, mp->carry + used, mp->carry_len - used);
+      mp->carry_len -= used;
+      return true;
+    }
+
+    mp->carry_len = 0;
+    off = used - old;
+  }
+
+  off += mp_process(mp, data + off, len - off);
+  if (mp->state == MP_FAILED) return false;
+  if (!mp_carry_append(mp, data + off, len - off)) goto oom;
+  
+  return true;
+
+oom:
+  mp->oom = true;
+  mp->state = MP_FAILED;
+  return false;
+}
+
+static ant_value_t mp_finish(ant_t *js, multipart_parser_t *mp) {
+  if (mp->oom) return js_mkerr(js, "out of memory");
+  if (mp->write_failed) return js_mkerr(js, "Failed to write multipart file part to disk");
+  if (mp->state != MP_DONE) return multipart_invalid(js);
+
+  ant_value_t fd = formdata_create_empty(js);
+  ant_value_t name = js_mkundef();
+  ant_value_t blob = js_mkundef();
+  if (is_err(fd)) return fd;
+
+  GC_ROOT_SAVE(root_mark, js);
+  GC_ROOT_PIN(js, fd);
+  GC_ROOT_PIN(js, name);
+  GC_ROOT_PIN(js, blob);
+
+  for (size_t i = 0; i < mp->nparts; i++) {
+    mp_part_t *part = &mp->parts[i];
+    const multipart_part_info_t *info = &part->info;
+    ant_value_t r = 0;
+    name = js_mkstr(js, info->name, strlen(info->name));
+
+    if (!info->filename) {
+      r = formdata_append_string(js, fd, name, js_mkstr(js, part->size ? (const char *)part->data : "", part->size));
+      if (is_err(r)) { fd = r; break; }
+      continue;
+    }
+
+    blob = blob_create(
+      js, part->spill_path ? NULL : part->data, part->size,
+      info->content_type ? info->content_type : ""
+    );
+    if (is_err(blob)) { fd = blob; break; }
+
+    // the temp file now belongs to the blob and goes away with it
+    if (part->spill_path) {
+      blob_data_t *bd = blob_get_data(blob);
+      if (!blob_path_own_temp(part->spill_path) || !(bd->path = blob_path_dup(part->spill_path))) {
+        fd = js_mkerr(js, "out of memory");
+        break;
+      }
+      free(part->spill_path);
+      part->spill_path = NULL;
+    }
+
+    r = formdata_append_file(js, fd, name, blob, js_mkstr(js, info->filename, strlen(info->filename)));
+    if (is_err(r)) { fd = r; break; }
+  }
+
+  GC_ROOT_RESTORE(js, root_mark);
   return fd;
 }
 
-ant_value_t formdata_parse_body(
-  ant_t *js, const uint8_t *data, size_t size,
-  const char *body_type, bool has_body
+void multipart_parser_free(multipart_parser_t *mp) {
+  if (!mp) return;
+  if (mp->writes_pending > 0) {
+    mp->orphaned = true;
+    return;
+  }
+  
+  for (size_t i = 0; i < mp->nparts; i++) mp_part_clear(&mp->parts[i]);
+  free(mp->parts);
+  free(mp->delim);
+  free(mp->carry);
+  free(mp);
+}
+
+enum { MULTIPART_NATIVE_TAG = 0x4d505052u }; // MPPR
+
+static void multipart_parser_finalize(ant_t *js, ant_object_t *obj) {
+  ant_value_t value = js_obj_from_ptr(obj);
+  multipart_parser_free((multipart_parser_t *)js_get_native(value, MULTIPART_NATIVE_TAG));
+  js_clear_native(value, MULTIPART_NATIVE_TAG);
+}
+
+void multipart_parser_bind(ant_value_t owner, multipart_parser_t *mp) {
+  js_set_native(owner, mp, MULTIPART_NATIVE_TAG);
+  js_set_finalizer(owner, multipart_parser_finalize);
+}
+
+multipart_parser_t *multipart_parser_bound(ant_value_t owner) {
+  return (multipart_parser_t *)js_get_native(owner, MULTIPART_NATIVE_TAG);
+}
+
+multipart_parser_t *multipart_parser_take(ant_value_t owner) {
+  multipart_parser_t *mp = multipart_parser_bound(owner);
+  js_clear_native(owner, MULTIPART_NATIVE_TAG);
+  return mp;
+}
+
+static ant_value_t multipart_rejection_reason(ant_t *js, ant_value_t value) {
+  if (!is_err(value)) return value;
+  ant_value_t reason = js->thrown_exists ? js->thrown_value : value;
+  js->thrown_exists = false;
+  js->thrown_value = js_mkundef();
+  js->thrown_stack = js_mkundef();
+  return reason;
+}
+
+static void mp_settle(multipart_parser_t *mp) {
+  ant_t *js = mp->js;
+  ant_value_t promise = mp->promise;
+
+  for (multipart_parser_t **it = &waiting_parsers; *it; it = &(*it)->next_waiting) {
+    if (*it != mp) continue;
+    *it = mp->next_waiting;
+    break;
+  }
+
+  GC_ROOT_SAVE(root_mark, js);
+  GC_ROOT_PIN(js, promise);
+  ant_value_t fd = mp_finish(js, mp);
+  if (is_err(fd)) js_reject_promise(js, promise, multipart_rejection_reason(js, fd));
+  else js_resolve_promise(js, promise, fd);
+  GC_ROOT_RESTORE(js, root_mark);
+  
+  multipart_parser_free(mp);
+}
+
+void multipart_parser_resolve(ant_t *js, multipart_parser_t *mp, ant_value_t promise) {
+  if (!mp) {
+    js_reject_promise(js, promise, multipart_rejection_reason(js, multipart_invalid(js)));
+    return;
+  }
+
+  mp->js = js;
+  mp->promise = promise;
+  if (mp->writes_pending == 0) {
+    mp_settle(mp);
+    return;
+  }
+
+  mp->next_waiting = waiting_parsers;
+  waiting_parsers = mp;
+}
+
+void gc_mark_multipart(ant_t *js, gc_mark_fn mark) {
+  for (multipart_parser_t *mp = waiting_parsers; mp; mp = mp->next_waiting)
+    mark(js, mp->promise);
+}
+
+void formdata_resolve_body(
+  ant_t *js, ant_value_t promise,
+  const uint8_t *data, size_t size,
+  const char *body_type, bool has_body, size_t spill_threshold
 ) {
   if (body_type && ct_is_type(body_type, "application/x-www-form-urlencoded")) {
-    return parse_formdata_urlencoded(js, data, size);
+    ant_value_t fd = parse_formdata_urlencoded(js, data, size);
+    if (is_err(fd)) js_reject_promise(js, promise, multipart_rejection_reason(js, fd));
+    else js_resolve_promise(js, promise, fd);
+    return;
   }
 
-  if (body_type && ct_is_type(body_type, "multipart/form-data")) {
-    if (!has_body || !data || size == 0) return js_mkerr_typed(js, JS_ERR_TYPE, "Failed to parse body as FormData");
-    return parse_formdata_multipart(js, data, size, body_type);
+  multipart_parser_t *mp = NULL;
+  if (body_type && has_body && data && size > 0)
+    mp = multipart_parser_new(body_type, spill_threshold);
+  
+  if (!mp) {
+    js_reject_promise(js, promise, multipart_rejection_reason(js, multipart_invalid(js)));
+    return;
   }
 
-  return js_mkerr_typed(js, JS_ERR_TYPE, "Failed to parse body as FormData");
+  multipart_parser_feed(mp, data, size);
+  multipart_parser_resolve(js, mp, promise);
 }
 
 typedef struct {
@@ -521,6 +963,7 @@ static bool mp_append_file_part(ant_t *js, mp_buf_t *b, ant_value_t values_arr,
   if (!mp_append_str(b, "\r\nContent-Type: ")) return false;
   if (!mp_append_str(b, mime)) return false;
   if (!mp_append_str(b, "\r\n\r\n")) return false;
+  if (bd && !blob_load(bd)) return false;
   if (!bd || !bd->data || bd->size == 0) return true;
   
   return mp_append(b, bd->data, bd->size);
@@ -36,6 +36,7 @@
 #include "descriptors.h"
 #include "silver/engine.h"
 #include "gc/modules.h"
+#include "esm/loader.h"
 
 #include "modules/events.h"
 #include "modules/process.h"
@@ -1317,6 +1318,7 @@ static ant_value_t process_exit(ant_t *js, ant_value_t *args, int nargs) {
     code = (int)js_getnum(args[0]);
   }
   
+  js_esm_flush_resolve_index(js);
   exit(code);
   return js_mkundef();
 }
@@ -1332,7 +1332,8 @@ static compiled_regex_cache_entry_t *regex_get_or_compile(
     return NULL;
   }
 
-  if (obj_ptr->finalizer && obj_ptr->finalizer != regexp_object_finalize) {
+  ant_object_finalizer_fn finalizer = ant_object_finalizer(obj_ptr);
+  if (finalizer && finalizer != regexp_object_finalize) {
     compiled->object_refs--;
     compiled_regex_entry_maybe_free(compiled);
     return NULL;
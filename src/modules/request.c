@@ -67,6 +67,7 @@ static void data_free(request_data_t *d) {
   free(d->integrity);
   free(d->body_data);
   free(d->body_type);
+  multipart_parser_free(d->multipart);
   free(d);
 }
 
@@ -94,6 +95,7 @@ static request_data_t *data_new_with(const char *method, const char *mode) {
   d->cache = strdup("default");
   d->redirect = strdup("follow");
   d->integrity = strdup("");
+  d->multipart_spill = MULTIPART_SPILL_DEFAULT;
   
   if (!d->method
     || !d->referrer
@@ -139,18 +141,19 @@ static ant_value_t request_create_object(ant_t *js, request_data_t *req, ant_val
   return obj;
 }
 
-static char *request_build_server_base_url(const char *host, const char *server_hostname, int server_port) {
+static char *request_build_server_base_url(const char *host, const char *server_hostname, int server_port, bool secure) {
   const char *authority = (host && host[0]) ? host : server_hostname;
+  const char *scheme = secure ? "https" : "http";
   size_t authority_len = authority ? strlen(authority) : 0;
-  bool include_port = (!host || !host[0]) && server_port > 0 && server_port != 80;
-  size_t cap = sizeof("http://") - 1 + authority_len + 1 + 16 + 1;
+  bool include_port = (!host || !host[0]) && server_port > 0 && server_port != (secure ? 443 : 80);
+  size_t cap = sizeof("https://") - 1 + authority_len + 1 + 16 + 1;
   
   char *base = malloc(cap);
   int written = 0;
 
   if (!base) return NULL;
-  if (include_port) written = snprintf(base, cap, "http://%s:%d/", authority ? authority : "", server_port);
-  else written = snprintf(base, cap, "http://%s/", authority ? authority : "");
+  if (include_port) written = snprintf(base, cap, "%s://%s:%d/", scheme, authority ? authority : "", server_port);
+  else written = snprintf(base, cap, "%s://%s/", scheme, authority ? authority : "");
   
   if (written < 0 || (size_t)written >= cap) {
     free(base);
@@ -166,6 +169,7 @@ static int request_parse_server_url(
   const char *host,
   const char *server_hostname,
   int server_port,
+  bool secure,
   url_state_t *out
 ) {
   char *base = NULL;
@@ -174,7 +178,7 @@ static int request_parse_server_url(
   if (absolute_target)
     return parse_url_to_state(target, NULL, out);
 
-  base = request_build_server_base_url(host, server_hostname, server_port);
+  base = request_build_server_base_url(host, server_hostname, server_port, secure);
   if (!base) return -1;
   
   rc = parse_url_to_state(target, base, out);
@@ -209,6 +213,7 @@ static request_data_t *data_dup(const request_data_t *src) {
   d->reload_navigation = src->reload_navigation;
   d->history_navigation = src->history_navigation;
   d->has_body          = src->has_body;
+  d->multipart_spill   = src->multipart_spill;
   d->body_is_stream    = src->body_is_stream;
   d->body_used         = src->body_used;
   d->body_size         = src->body_size;
@@ -336,6 +341,11 @@ static bool extract_blob_body(
   blob_data_t *bd = blob_is_blob(js, body_val) ? blob_get_data(body_val) : NULL;
   if (!bd) return false;
 
+  if (!blob_load(bd)) {
+    *err_out = js_mkerr(js, "Failed to read '%s'", bd->path);
+    return false;
+  }
+  
   if (!copy_body_bytes(js, bd->data, bd->size, out_data, out_size, err_out)) return false;
   if (bd->type && bd->type[0]) *out_type = strdup(bd->type);
   
@@ -453,7 +463,8 @@ enum {
 static void resolve_body_promise(
   ant_t *js, ant_value_t promise,
   const uint8_t *data, size_t size,
-  const char *body_type, int mode, bool has_body
+  const char *body_type, int mode, bool has_body,
+  size_t multipart_spill
 ) {
   switch (mode) {
   case BODY_TEXT: {
@@ -492,12 +503,10 @@ static void resolve_body_promise(
       create_typed_array(js, TYPED_ARRAY_UINT8, ab, 0, size, "Uint8Array"));
     break;
   }
-  case BODY_FORMDATA: {
-    ant_value_t fd = formdata_parse_body(js, data, size, body_type, has_body);
-    if (is_err(fd)) js_reject_promise(js, promise, request_rejection_reason(js, fd));
-    else js_resolve_promise(js, promise, fd);
+  case BODY_FORMDATA:
+    formdata_resolve_body(js, promise, data, size, body_type, has_body, multipart_spill);
     break;
-  }}
+  }
 }
 
 static uint8_t *concat_chunks(ant_t *js, ant_value_t chunks, size_t *out_size) {
@@ -558,17 +567,27 @@ static ant_value_t stream_body_read(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t done_val = js_get(js, result, "done");
   ant_value_t value    = js_get(js, result, "value");
 
+  multipart_parser_t *mp = multipart_parser_bound(state);
+  if (mp && vtype(done_val) == T_BOOL && done_val == js_true) {
+    multipart_parser_resolve(js, multipart_parser_take(state), promise);
+    return js_mkundef();
+  }
+
   if (vtype(done_val) == T_BOOL && done_val == js_true) {
     size_t size = 0;
     uint8_t *data = concat_chunks(js, chunks, &size);
     ant_value_t type_v = js_get(js, state, "type");
     const char *body_type = (vtype(type_v) == T_STR) ? js_getstr(js, type_v, NULL) : NULL;
-    resolve_body_promise(js, promise, data, size, body_type, mode, true);
+    resolve_body_promise(js, promise, data, size, body_type, mode, true, MULTIPART_SPILL_DEFAULT);
     free(data);
     return js_mkundef();
   }
 
-  if (vtype(value) != T_UNDEF && vtype(value) != T_NULL)
+  if (mp && vtype(value) == T_TYPEDARRAY) {
+    TypedArrayData *ta = (TypedArrayData *)js_gettypedarray(value);
+    if (ta && ta->buffer && !ta->buffer->is_detached && ta->byte_length > 0)
+      multipart_parser_feed(mp, ta->buffer->data + ta->byte_offset, ta->byte_length);
+  } else if (!mp && vtype(value) != T_UNDEF && vtype(value) != T_NULL)
     js_arr_push(js, chunks, value);
 
   stream_schedule_next_read(js, state, js_mkundef(), reader);
@@ -578,7 +597,7 @@ static ant_value_t stream_body_read(ant_t *js, ant_value_t *args, int nargs) {
 static ant_value_t consume_body_from_stream(
   ant_t *js, ant_value_t stream,
   ant_value_t promise, int mode,
-  const char *body_type
+  const char *body_type, size_t multipart_spill
 ) {
   ant_value_t reader_args[1] = { stream };
   ant_value_t reader = js_construct_native(js, js_rs_reader_ctor, reader_args, 1);
@@ -595,6 +614,10 @@ static ant_value_t consume_body_from_stream(
   js_set(js, state, "mode",    js_mknum(mode));
   js_set(js, state, "type",    body_type ? js_mkstr(js, body_type, strlen(body_type)) : js_mkundef());
 
+  // multipart bodies are parsed as chunks arrive instead of being gathered
+  multipart_parser_t *mp = mode == BODY_FORMDATA ? multipart_parser_new(body_type, multipart_spill) : NULL;
+  if (mp) multipart_parser_bind(state, mp);
+
   stream_schedule_next_read(js, state, js_mkundef(), reader);
   return promise;
 }
@@ -611,7 +634,7 @@ static ant_value_t consume_body(ant_t *js, int mode) {
   }
   
   if (!d->has_body) {
-    resolve_body_promise(js, promise, NULL, 0, request_effective_body_type(js, this, d), mode, false);
+    resolve_body_promise(js, promise, NULL, 0, request_effective_body_type(js, this, d), mode, false, d->multipart_spill);
     return promise;
   }
   
@@ -622,10 +645,22 @@ static ant_value_t consume_body(ant_t *js, int mode) {
   }
   
   d->body_used = true;
+  if (d->multipart) {
+    multipart_parser_t *mp = d->multipart;
+    d->multipart = NULL;
+    if (mode == BODY_FORMDATA) multipart_parser_resolve(js, mp, promise);
+    else {
+      multipart_parser_free(mp);
+      js_reject_promise(js, promise, request_rejection_reason(js, js_mkerr_typed(js, JS_ERR_TYPE,
+        "multipart body was parsed while it arrived and can only be read with formData()")));
+    }
+    return promise;
+  }
+  
   ant_value_t stream = js_get_slot(this, SLOT_REQUEST_BODY_STREAM);
   if (rs_is_stream(stream) && d->body_is_stream)
-    return consume_body_from_stream(js, stream, promise, mode, request_effective_body_type(js, this, d));
-  resolve_body_promise(js, promise, d->body_data, d->body_size, request_effective_body_type(js, this, d), mode, true);
+    return consume_body_from_stream(js, stream, promise, mode, request_effective_body_type(js, this, d), d->multipart_spill);
+  resolve_body_promise(js, promise, d->body_data, d->body_size, request_effective_body_type(js, this, d), mode, true, d->multipart_spill);
   
   return promise;
 }
@@ -837,7 +872,7 @@ static ant_value_t req_body_pull(ant_t *js, ant_value_t *args, int nargs) {
 }
 
 REQ_GETTER_START(body)
-  if (!d->has_body) return js_mknull();
+  if (!d->has_body || d->multipart) return js_mknull();
   ant_value_t stored_stream = js_get_slot(this, SLOT_REQUEST_BODY_STREAM);
   if (rs_is_stream(stored_stream)) return stored_stream;
   if (d->body_used) return js_mknull();
@@ -1441,15 +1476,18 @@ ant_value_t request_create_server(
   const char *host,
   const char *server_hostname,
   int server_port,
+  bool secure,
   ant_value_t headers_obj,
   const uint8_t *body,
   size_t body_len,
-  const char *body_type
+  const char *body_type,
+  size_t multipart_spill
 ) {
   request_data_t *req = data_new_server(method);
   if (!req) return js_mkerr(js, "out of memory");
+  req->multipart_spill = multipart_spill;
 
-  if (!target || request_parse_server_url(target, absolute_target, host, server_hostname, server_port, &req->url) != 0) {
+  if (!target || request_parse_server_url(target, absolute_target, host, server_hostname, server_port, secure, &req->url) != 0) {
     data_free(req);
     return js_mkerr_typed(js, JS_ERR_TYPE, "Failed to construct 'Request': Invalid URL");
   }
@@ -1468,6 +1506,17 @@ ant_value_t request_create_server(
   return request_create_object(js, req, headers_obj, false);
 }
 
+void request_set_multipart_body(ant_value_t req_obj, multipart_parser_t *mp) {
+  request_data_t *req = get_data(req_obj);
+  if (!req) {
+    multipart_parser_free(mp);
+    return;
+  }
+  
+  req->has_body = true;
+  req->multipart = mp;
+}
+
 void init_request_module(ant_t *js) {
   ant_value_t g = js_glob(js);
   js->builtins.request_proto = js_mkobj(js);
@@ -56,6 +56,7 @@ static void data_free(response_data_t *d) {
   free(d->status_text);
   free(d->body_data);
   free(d->body_type);
+  blob_path_free(d->body_file);
   free(d);
 }
 
@@ -96,6 +97,8 @@ static response_data_t *data_dup(const response_data_t *src) {
   d->body_used = src->body_used;
   d->body_size = src->body_size;
   d->body_type = src->body_type ? strdup(src->body_type) : NULL;
+  d->body_file = blob_path_dup(src->body_file);
+  d->body_file_offset = src->body_file_offset;
   d->websocket = js_mkundef();
 
   su = (url_state_t *)&src->url;
@@ -124,6 +127,18 @@ static response_data_t *data_dup(const response_data_t *src) {
   return d;
 }
 
+// a body taken from a file-backed Blob is only read into memory when script
+// asks for it, the server sends it straight from the file
+static bool response_load_file_body(response_data_t *d) {
+  blob_data_t file = { .size = d->body_size, .path = d->body_file, .offset = d->body_file_offset };
+  
+  if (!d->body_file || d->body_data || d->body_size == 0) return true;
+  if (!blob_load(&file)) return false;
+  d->body_data = file.data;
+  
+  return true;
+}
+
 static ant_value_t response_rejection_reason(ant_t *js, ant_value_t value) {
   if (!is_err(value)) return value;
   ant_value_t reason = js->thrown_exists ? js->thrown_value : value;
@@ -185,11 +200,15 @@ static bool extract_stream_body(
 
 static bool extract_blob_body(
   ant_t *js, ant_value_t body_val,
-  uint8_t **out_data, size_t *out_size, char **out_type, ant_value_t *err_out
+  uint8_t **out_data, size_t *out_size, char **out_type,
+  const blob_data_t **out_file, ant_value_t *err_out
 ) {
   blob_data_t *bd = blob_is_blob(js, body_val) ? blob_get_data(body_val) : NULL;
   if (!bd) return false;
-  if (!copy_body_bytes(js, bd->data, bd->size, out_data, out_size, err_out)) return false;
+  if (bd->path) {
+    *out_file = bd;
+    *out_size = bd->size;
+  } else if (!copy_body_bytes(js, bd->data, bd->size, out_data, out_size, err_out)) return false;
   if (bd->type && bd->type[0]) *out_type = strdup(bd->type);
   return true;
 }
@@ -273,18 +292,19 @@ static bool extract_string_body(
 static bool extract_body(
   ant_t *js, ant_value_t body_val,
   uint8_t **out_data, size_t *out_size, char **out_type,
-  ant_value_t *out_stream, ant_value_t *err_out
+  ant_value_t *out_stream, const blob_data_t **out_file, ant_value_t *err_out
 ) {
   *out_data = NULL;
   *out_size = 0;
   *out_type = NULL;
   *out_stream = js_mkundef();
+  *out_file = NULL;
   *err_out = js_mkundef();
 
   if (vtype(body_val) == T_NULL || vtype(body_val) == T_UNDEF) return true;
   if (extract_buffer_source_body(js, body_val, out_data, out_size, err_out)) return true;
   if (vtype(body_val) == T_OBJ && rs_is_stream(body_val)) return extract_stream_body(js, body_val, out_stream, err_out);
-  if (vtype(body_val) == T_OBJ && extract_blob_body(js, body_val, out_data, out_size, out_type, err_out)) return true;
+  if (vtype(body_val) == T_OBJ && extract_blob_body(js, body_val, out_data, out_size, out_type, out_file, err_out)) return true;
   if (vtype(body_val) == T_OBJ && extract_urlsearchparams_body(js, body_val, out_data, out_size, out_type)) return true;
   if (vtype(body_val) == T_OBJ && extract_formdata_body(js, body_val, out_data, out_size, out_type, err_out)) return true;
   
@@ -421,12 +441,10 @@ static void resolve_body_promise(
       create_typed_array(js, TYPED_ARRAY_UINT8, ab, 0, size, "Uint8Array"));
     break;
   }
-  case BODY_FORMDATA: {
-    ant_value_t fd = formdata_parse_body(js, data, size, body_type, has_body);
-    if (is_err(fd)) js_reject_promise(js, promise, response_rejection_reason(js, fd));
-    else js_resolve_promise(js, promise, fd);
+  case BODY_FORMDATA:
+    formdata_resolve_body(js, promise, data, size, body_type, has_body, MULTIPART_SPILL_DEFAULT);
     break;
-  }}
+  }
 }
 
 static bool response_chunk_is_uint8_array(ant_value_t chunk, TypedArrayData **out_ta) {
@@ -510,6 +528,12 @@ static ant_value_t stream_body_read(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t done_val = js_get(js, result, "done");
   ant_value_t value = js_get(js, result, "value");
 
+  multipart_parser_t *mp = multipart_parser_bound(state);
+  if (mp && vtype(done_val) == T_BOOL && done_val == js_true) {
+    multipart_parser_resolve(js, multipart_parser_take(state), promise);
+    return js_mkundef();
+  }
+
   if (vtype(done_val) == T_BOOL && done_val == js_true) {
     size_t size = 0;
     ant_value_t chunk_err = js_mkundef();
@@ -525,7 +549,15 @@ static ant_value_t stream_body_read(ant_t *js, ant_value_t *args, int nargs) {
     return js_mkundef();
   }
 
-  if (vtype(value) != T_UNDEF && vtype(value) != T_NULL) js_arr_push(js, chunks, value);
+  if (mp && vtype(value) != T_UNDEF && vtype(value) != T_NULL) {
+    TypedArrayData *ta = NULL;
+    if (!response_chunk_is_uint8_array(value, &ta)) {
+      js_reject_promise(js, promise, response_rejection_reason(js,
+        js_mkerr_typed(js, JS_ERR_TYPE, "Response body stream chunk must be a Uint8Array")));
+      return js_mkundef();
+    }
+    if (ta->byte_length > 0) multipart_parser_feed(mp, ta->buffer->data + ta->byte_offset, ta->byte_length);
+  } else if (vtype(value) != T_UNDEF && vtype(value) != T_NULL) js_arr_push(js, chunks, value);
   stream_schedule_next_read(js, state, reader);
   return js_mkundef();
 }
@@ -550,6 +582,10 @@ static ant_value_t consume_body_from_stream(
   js_set(js, state, "mode", js_mknum(mode));
   js_set(js, state, "type", body_type ? js_mkstr(js, body_type, strlen(body_type)) : js_mkundef());
 
+  // multipart bodies are parsed as chunks arrive instead of being gathered
+  multipart_parser_t *mp = mode == BODY_FORMDATA ? multipart_parser_new(body_type, MULTIPART_SPILL_DEFAULT) : NULL;
+  if (mp) multipart_parser_bind(state, mp);
+
   stream_schedule_next_read(js, state, reader);
   return promise;
 }
@@ -582,6 +618,11 @@ static ant_value_t consume_body(ant_t *js, int mode) {
   if (rs_is_stream(stream))
     return consume_body_from_stream(js, stream, promise, mode, response_effective_body_type(js, this, d));
 
+  if (!response_load_file_body(d)) {
+    js_reject_promise(js, promise, js_mkerr(js, "Failed to read '%s'", d->body_file));
+    return promise;
+  }
+
   resolve_body_promise(js, promise, d->body_data, d->body_size, response_effective_body_type(js, this, d), mode, true);
   return promise;
 }
@@ -683,13 +724,14 @@ static ant_value_t response_apply_body(
 ) {
   ant_value_t body_err = js_mkundef();
   ant_value_t body_stream = js_mkundef();
+  const blob_data_t *body_file = NULL;
   uint8_t *body_data = NULL;
   size_t body_size = 0;
   char *body_type = NULL;
 
   if (vtype(body_val) == T_NULL || vtype(body_val) == T_UNDEF) return js_mkundef();
 
-  if (!extract_body(js, body_val, &body_data, &body_size, &body_type, &body_stream, &body_err)) {
+  if (!extract_body(js, body_val, &body_data, &body_size, &body_type, &body_stream, &body_file, &body_err)) {
     return is_err(body_err) ? body_err : js_mkerr(js, "Failed to extract body");
   }
 
@@ -701,9 +743,12 @@ static ant_value_t response_apply_body(
 
   free(resp->body_data);
   free(resp->body_type);
+  blob_path_free(resp->body_file);
   resp->body_data = body_data;
   resp->body_size = body_size;
   resp->body_type = body_type;
+  resp->body_file = body_file ? blob_path_dup(body_file->path) : NULL;
+  resp->body_file_offset = body_file ? body_file->offset : 0;
   resp->body_is_stream = rs_is_stream(body_stream);
   resp->has_body = true;
 
@@ -913,6 +958,7 @@ static ant_value_t res_body_pull(ant_t *js, ant_value_t *args, int nargs) {
   response_data_t *d = get_data(resp_obj);
   ant_value_t ctrl = (nargs > 0) ? args[0] : js_mkundef();
 
+  if (d && !response_load_file_body(d)) return js_mkerr(js, "Failed to read '%s'", d->body_file);
   if (d && d->body_data && d->body_size > 0) {
     ArrayBufferData *ab = create_array_buffer_data(d->body_size);
     if (ab) {
@@ -8,6 +8,8 @@
 #include <string.h>
 #include <strings.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <uv.h>
 
 #include "ant.h"
@@ -20,6 +22,7 @@
 #include "gc/modules.h"
 #include "net/connection.h"
 #include "net/listener.h"
+#include "net/tls_server.h"
 #include "sandbox/policy.h"
 #include "streams/readable.h"
 
@@ -33,6 +36,7 @@
 #include "modules/blob.h"
 #include "modules/buffer.h"
 #include "modules/headers.h"
+#include "modules/multipart.h"
 #include "modules/request.h"
 #include "modules/response.h"
 #include "modules/server.h"
@@ -64,12 +68,14 @@ typedef enum {
   SERVER_WRITE_STREAM_READ,
   SERVER_WRITE_KEEP_ALIVE,
   SERVER_WRITE_WEBSOCKET_UPGRADE,
+  SERVER_WRITE_SEND_FILE,
 } server_write_action_t;
 
 typedef struct {
   server_request_t *request;
   ant_conn_t *conn;
   server_write_action_t action;
+  char frame[24];
 } server_write_req_t;
 
 struct server_request_s {
@@ -82,6 +88,7 @@ struct server_request_s {
   ant_value_t response_promise;
   ant_value_t response_reader;
   ant_value_t response_read_promise;
+  ant_value_t response_chunk;
   ant_http_header_t *raw_headers;
   
   struct server_request_s *next;
@@ -91,9 +98,14 @@ struct server_request_s {
   uint64_t network_request_id;
   size_t network_encoded_length;
   
+  uv_file body_file;
+  uint64_t body_offset;
+  size_t body_len;
+  
   bool keep_alive;
   bool response_started;
   bool network_finished;
+  bool body_file_open;
 };
 
 struct server_conn_state_s {
@@ -101,6 +113,7 @@ struct server_conn_state_s {
   ant_conn_t *conn;
   
   ant_http1_conn_parser_t parser;
+  multipart_parser_t *multipart;
   uv_timer_t drain_timer;
   server_request_t request;
   server_request_t *active_req;
@@ -119,6 +132,7 @@ struct server_runtime_s {
   uv_loop_t *loop;
   
   ant_listener_t listener;
+  ant_tls_server_t *tls;
   uv_signal_t sigint_handle;
   uv_signal_t sigterm_handle;
   stop_waiter_t *stop_waiters;
@@ -131,6 +145,8 @@ struct server_runtime_s {
   uint64_t idle_timeout_ms;
   uint64_t websocket_idle_timeout_ms;
   size_t websocket_max_payload_len;
+  size_t websocket_backpressure_limit;
+  size_t multipart_spill_threshold;
   
   int port;
   bool websocket_per_message_deflate;
@@ -240,11 +256,21 @@ static void server_remove_request(server_runtime_t *server, server_request_t *re
   }}
 }
 
+static void server_request_close_file(server_request_t *req) {
+  uv_fs_t fs_req;
+
+  if (!req || !req->body_file_open) return;
+  uv_fs_close(NULL, &fs_req, req->body_file, NULL);
+  uv_fs_req_cleanup(&fs_req);
+  req->body_file_open = false;
+}
+
 static void server_request_reset(server_request_t *req) {
   server_runtime_t *server = NULL;
   server_conn_state_t *conn_state = NULL;
 
   if (!req) return;
+  server_request_close_file(req);
   server = req->server;
   conn_state = req->conn_state;
   ant_http_headers_free(req->raw_headers);
@@ -258,6 +284,7 @@ static void server_request_reset(server_request_t *req) {
     .response_promise = js_mkundef(),
     .response_reader = js_mkundef(),
     .response_read_promise = js_mkundef(),
+    .response_chunk = js_mkundef(),
     .raw_headers = NULL,
   };
 }
@@ -370,6 +397,8 @@ static void server_maybe_finish_stop(server_runtime_t *server) {
   if (!server || !server->stopping) return;
   if (ant_listener_has_connections(&server->listener)) return;
   if (!ant_listener_is_closed(&server->listener) || !server->sigint_closed || !server->sigterm_closed) return;
+  ant_tls_server_release(server->tls);
+  server->tls = NULL;
   if (g_server == server) g_server = NULL;
   stop_waiters_resolve(server);
 }
@@ -700,6 +729,7 @@ static ant_value_t server_upgrade_websocket(ant_t *js, ant_value_t *args, int na
   per_message_deflate = server->websocket_per_message_deflate &&
     ant_ws_header_contains_extension(extensions, "permessage-deflate");
   ws_options.max_payload_len = server->websocket_max_payload_len;
+  ws_options.backpressure_limit = server->websocket_backpressure_limit;
   ws_options.per_message_deflate = per_message_deflate;
   socket = ant_websocket_accept_server(js, req->conn, request_obj, NULL, &ws_options);
   if (is_err(socket)) { free(accept); return socket; }
@@ -788,6 +818,7 @@ static bool server_response_chunk(server_request_t *req, ant_value_t value, cons
 
   if (is_object_type(value) && blob_is_blob(req->server->js, value)) {
     blob = blob_get_data(value);
+    if (blob && !blob_load(blob)) return false;
     *out = blob ? blob->data : NULL;
     *len = blob ? blob->size : 0;
     return true;
@@ -853,29 +884,35 @@ static void server_schedule_drain(server_conn_state_t *cs) {
     cs->drain_scheduled = false;
 }
 
-static bool server_queue_write(ant_conn_t *conn, server_request_t *req, char *data, size_t len, server_write_action_t action) {
-  server_write_req_t *wr = calloc(1, sizeof(*wr));
-  int rc = 0;
+static server_write_req_t *server_write_req_new(ant_conn_t *conn, server_request_t *req, server_write_action_t action) {
+  server_write_req_t *wr = NULL;
 
   if (!conn || ant_conn_is_closing(conn)) {
     if (req) server_network_fail(req, "connection closed");
-    free(data);
-    return false;
+    return NULL;
   }
 
-  if (!wr) {
-    free(data);
-    return false;
-  }
+  wr = calloc(1, sizeof(*wr));
+  if (!wr) return NULL;
 
   wr->request = req;
   wr->conn = conn;
   wr->action = action;
   
+  return wr;
+}
+
+// bufs marked in owned are freed by the connection, the rest are borrowed
+// from values the request keeps alive until server_write_cb runs
+static bool server_submit_write(server_write_req_t *wr, const uv_buf_t *bufs, unsigned int nbufs, unsigned int owned) {
+  server_request_t *req = wr->request;
+  ant_conn_t *conn = wr->conn;
+  int rc = 0;
+
   if (req) server_request_retain(req);
-  if (req) req->network_encoded_length += len;
+  if (req) for (unsigned int i = 0; i < nbufs; i++) req->network_encoded_length += bufs[i].len;
 
-  rc = ant_conn_write(conn, data, len, server_write_cb, wr);
+  rc = ant_conn_writev(conn, bufs, nbufs, owned, server_write_cb, wr);
   if (rc != 0) {
     if (req) server_network_fail(req, uv_strerror(rc));
     if (req) server_request_release(req);
@@ -887,6 +924,35 @@ static bool server_queue_write(ant_conn_t *conn, server_request_t *req, char *da
   return true;
 }
 
+static bool server_queue_write(ant_conn_t *conn, server_request_t *req, char *data, size_t len, server_write_action_t action) {
+  server_write_req_t *wr = server_write_req_new(conn, req, action);
+  uv_buf_t buf = uv_buf_init(data, (unsigned int)len);
+
+  if (!wr) {
+    free(data);
+    return false;
+  }
+
+  return server_submit_write(wr, &buf, 1, 1u);
+}
+
+// the chunk bytes are borrowed, response_chunk keeps their owner reachable
+static bool server_queue_chunk(server_request_t *req, ant_value_t value, const uint8_t *chunk, size_t len) {
+  server_write_req_t *wr = server_write_req_new(req->conn, req, SERVER_WRITE_STREAM_READ);
+  uv_buf_t bufs[3];
+  int prefix_len = 0;
+
+  if (!wr) return false;
+  prefix_len = snprintf(wr->frame, sizeof(wr->frame), "%zx\r\n", len);
+  req->response_chunk = value;
+
+  bufs[0] = uv_buf_init(wr->frame, (unsigned int)prefix_len);
+  bufs[1] = uv_buf_init((char *)chunk, (unsigned int)len);
+  bufs[2] = uv_buf_init((char *)"\r\n", 2);
+
+  return server_submit_write(wr, bufs, 3, 0);
+}
+
 static bool server_queue_final_chunk(server_request_t *req, server_write_action_t action) {
   ant_http1_buffer_t buf;
   char *out = NULL;
@@ -1023,6 +1089,107 @@ static void server_send_request_internal_error(server_request_t *req, const char
   server_queue_write(req->conn, req, out, out_len, SERVER_WRITE_CLOSE_CLIENT);
 }
 
+// only a single "bytes=" range is honoured, anything else serves the whole body
+static int server_parse_range(const char *value, uint64_t size, uint64_t *out_start, uint64_t *out_len) {
+  const char *p = value;
+  char *end = NULL;
+  uint64_t first = 0;
+  uint64_t last = 0;
+
+  if (!value || strncasecmp(p, "bytes=", 6) != 0) return 0;
+  p += 6;
+  while (*p == ' ' || *p == '\t') p++;
+  if (strchr(p, ',')) return 0;
+
+  if (*p == '-') {
+    last = strtoull(p + 1, &end, 10);
+    if (end == p + 1 || *end) return 0;
+    if (last == 0 || size == 0) return -1;
+    if (last > size) last = size;
+    *out_start = size - last;
+    *out_len = last;
+    return 1;
+  }
+
+  if (*p < '0' || *p > '9') return 0;
+  first = strtoull(p, &end, 10);
+  if (*end != '-') return 0;
+  p = end + 1;
+  
+  if (*p) {
+    last = strtoull(p, &end, 10);
+    if (end == p || *end) return 0;
+    if (last < first) return 0;
+  } else last = UINT64_MAX;
+
+  if (first >= size) return -1;
+  if (last >= size) last = size - 1;
+  
+  *out_start = first;
+  *out_len = last - first + 1;
+  
+  return 1;
+}
+
+// file bodies advertise byte ranges, a satisfiable Range becomes a 206 and
+// an unsatisfiable one a 416, the handler's headers are copied, never edited
+static ant_value_t server_file_response_headers(
+  server_request_t *req, ant_value_t headers,
+  int *status, uint64_t *offset, size_t *len
+) {
+  ant_t *js = req->server->js;
+  ant_value_t out = 0;
+  const char *range = NULL;
+  
+  uint64_t size = *len;
+  uint64_t start = 0;
+  uint64_t count = 0;
+  
+  char value[96];
+  int rc = 0;
+
+  if (*status != 200 || headers_find_literal(headers, "content-range", NULL) > 0) return headers;
+  out = headers_create_empty(js);
+  if (is_err(out) || !headers_copy_from(js, out, headers)) return headers;
+  headers_set_literal(js, out, "accept-ranges", "bytes");
+
+  range = ant_ws_find_header(req->raw_headers, "range");
+  if (!range || ant_ws_find_header(req->raw_headers, "if-range")) return out;
+  
+  rc = server_parse_range(range, size, &start, &count);
+  if (rc == 0) return out;
+
+  if (rc < 0) {
+    snprintf(value, sizeof(value), "bytes */%" PRIu64, size);
+    *status = 416;
+    *len = 0;
+  } else {
+    snprintf(value, sizeof(value), "bytes %" PRIu64 "-%" PRIu64 "/%" PRIu64, start, start + count - 1, size);
+    *status = 206;
+    *offset = start;
+    *len = (size_t)count;
+  }
+
+  headers_set_literal(js, out, "content-range", value);
+  return out;
+}
+
+static bool server_request_open_file(server_request_t *req, const char *path, uint64_t offset, size_t len) {
+  uv_fs_t fs_req;
+  int rc = uv_fs_open(NULL, &fs_req, path, O_RDONLY, 0, NULL);
+
+  uv_fs_req_cleanup(&fs_req);
+  if (rc < 0) return false;
+
+  server_request_close_file(req);
+  req->body_file = rc;
+  req->body_offset = offset;
+  req->body_len = len;
+  req->body_file_open = true;
+  
+  return true;
+}
+
 static void server_finish_with_response(server_request_t *req, ant_value_t response_obj) {
   response_data_t *resp = response_get_data(response_obj);
   ant_value_t headers = response_get_headers(response_obj);
@@ -1030,6 +1197,7 @@ static void server_finish_with_response(server_request_t *req, ant_value_t respo
   
   ant_value_t stream = js_get_slot(response_obj, SLOT_RESPONSE_BODY_STREAM);
   bool body_is_stream = resp && resp->body_is_stream && rs_is_stream(stream);
+  bool from_file = resp && !body_is_stream && resp->body_file;
   bool head_only = false;
   
   ant_http_header_t *network_headers = NULL;
@@ -1038,6 +1206,11 @@ static void server_finish_with_response(server_request_t *req, ant_value_t respo
   
   char *out = NULL;
   size_t out_len = 0;
+  
+  int status = 0;
+  uint64_t body_offset = 0;
+  size_t body_size = 0;
+  server_write_action_t done_action = SERVER_WRITE_NONE;
 
   if (!req->conn || ant_conn_is_closing(req->conn)) return;
   if (!resp) {
@@ -1055,31 +1228,37 @@ static void server_finish_with_response(server_request_t *req, ant_value_t respo
   req->response_started = true;
   
   head_only = strcasecmp(request_get_data(req->request_obj)->method, "HEAD") == 0;
-  status_text = (resp->status_text && resp->status_text[0]) ? resp->status_text : ant_http1_default_status_text(resp->status);
+  status = resp->status;
+  body_size = resp->body_size;
+  
+  if (from_file) {
+    headers = server_file_response_headers(req, headers, &status, &body_offset, &body_size);
+    body_offset += resp->body_file_offset;
+  }
+  
+  if (from_file && !head_only && body_size > 0 && !server_request_open_file(req, resp->body_file, body_offset, body_size)) {
+    server_send_request_internal_error(req, "Failed to open response body file");
+    return;
+  }
+  
+  status_text = (status == resp->status && resp->status_text && resp->status_text[0])
+    ? resp->status_text 
+    : ant_http1_default_status_text(status);
   
-  network_headers = server_capture_response_headers(headers, body_is_stream && !head_only, resp->body_size, req->keep_alive);
-  server_network_response(req, resp->status, status_text, resp->body_type, network_headers);
+  network_headers = server_capture_response_headers(headers, body_is_stream && !head_only, body_size, req->keep_alive);
+  server_network_response(req, status, status_text, resp->body_type, network_headers);
   ant_http_headers_free(network_headers);
   
-  if (!body_is_stream && !head_only && resp->body_data && resp->body_size > 0)
+  if (!from_file && !body_is_stream && !head_only && resp->body_data && resp->body_size > 0)
     ant_inspector_network_append_response_body(req->network_request_id, resp->body_data, resp->body_size);
 
   ant_http1_buffer_init(&buf);
-  if (!ant_http1_write_response_head(&buf, resp->status, status_text, headers, body_is_stream, resp->body_size, req->keep_alive)) {
+  if (!ant_http1_write_response_head(&buf, status, status_text, headers, body_is_stream, body_size, req->keep_alive)) {
     ant_http1_buffer_free(&buf);
     ant_conn_close(req->conn);
     return;
   }
   
-  if (!body_is_stream && !head_only && resp->body_size > 0) 
-    ant_http1_buffer_append(&buf, resp->body_data, resp->body_size);
-  
-  if (buf.failed) {
-    ant_http1_buffer_free(&buf);
-    ant_conn_close(req->conn);
-    return;
-  }
-
   out = ant_http1_buffer_take(&buf, &out_len);
   ant_conn_set_timeout_ms(req->conn, req->server->idle_timeout_ms);
   
@@ -1087,13 +1266,78 @@ static void server_finish_with_response(server_request_t *req, ant_value_t respo
     req, "The response body was canceled for a HEAD request"
   );
   
-  server_queue_write(
-    req->conn,
-    req, out, out_len,
-    body_is_stream && !head_only
-      ? SERVER_WRITE_STREAM_READ
-      : (req->keep_alive ? SERVER_WRITE_KEEP_ALIVE : SERVER_WRITE_CLOSE_CLIENT)
-  );
+  done_action = req->keep_alive ? SERVER_WRITE_KEEP_ALIVE : SERVER_WRITE_CLOSE_CLIENT;
+  if (body_is_stream && !head_only) done_action = SERVER_WRITE_STREAM_READ;
+  else if (req->body_file_open) done_action = SERVER_WRITE_SEND_FILE;
+  
+  // the body goes out as a second buffer straight from the response,
+  // which req->response_obj keeps alive until the write completes
+  if (!from_file && !body_is_stream && !head_only && resp->body_data && resp->body_size > 0) {
+    server_write_req_t *wr = server_write_req_new(req->conn, req, done_action);
+    uv_buf_t bufs[2] = {
+      uv_buf_init(out, (unsigned int)out_len),
+      uv_buf_init((char *)resp->body_data, (unsigned int)resp->body_size),
+    };
+    
+    if (!wr) {
+      free(out);
+      ant_conn_close(req->conn);
+      return;
+    }
+    
+    server_submit_write(wr, bufs, 2, 1u);
+    return;
+  }
+  
+  server_queue_write(req->conn, req, out, out_len, done_action);
+}
+
+static void server_send_file_cb(ant_conn_t *conn, int status, void *user_data) {
+  server_write_req_t *wr = (server_write_req_t *)user_data;
+  server_request_close_file(wr->request);
+  server_write_cb(conn, status, user_data);
+}
+
+// the file goes from the page cache to the socket, only platforms without
+// a usable sendfile and tls connections the kernel does not encrypt for
+// fall back to reading the range into memory
+static void server_start_send_file(server_request_t *req) {
+  response_data_t *resp = response_get_data(req->response_obj);
+  server_write_req_t *wr = calloc(1, sizeof(*wr));
+  server_write_action_t action = req->keep_alive ? SERVER_WRITE_KEEP_ALIVE : SERVER_WRITE_CLOSE_CLIENT;
+  int rc = 0;
+
+  if (!wr) {
+    ant_conn_close(req->conn);
+    return;
+  }
+
+  wr->request = req;
+  wr->conn = req->conn;
+  wr->action = action;
+  
+  server_request_retain(req);
+  req->network_encoded_length += req->body_len;
+
+  rc = ant_conn_sendfile(req->conn, req->body_file, (int64_t)req->body_offset, req->body_len, server_send_file_cb, wr);
+  if (rc == 0) return;
+
+  req->network_encoded_length -= req->body_len;
+  server_request_release(req);
+  free(wr);
+
+  if (rc == UV_ENOTSUP && resp && resp->body_file) {
+    blob_data_t file = { .size = req->body_len, .path = resp->body_file, .offset = req->body_offset };
+    server_request_close_file(req);
+    if (blob_load(&file)) {
+      server_queue_write(req->conn, req, (char *)file.data, file.size, action);
+      return;
+    }
+  }
+
+  server_network_fail(req, uv_strerror(rc));
+  server_request_close_file(req);
+  ant_conn_close(req->conn);
 }
 
 static ant_value_t server_on_response_reject(ant_t *js, ant_value_t *args, int nargs) {
@@ -1179,10 +1423,6 @@ static ant_value_t server_stream_read_fulfill(ant_t *js, ant_value_t *args, int
   
   const uint8_t *chunk = NULL;
   size_t chunk_len = 0;
-  
-  ant_http1_buffer_t buf;
-  char *out = NULL;
-  size_t out_len = 0;
 
   if (!req) return js_mkundef();
   req->response_read_promise = js_mkundef();
@@ -1214,21 +1454,13 @@ static ant_value_t server_stream_read_fulfill(ant_t *js, ant_value_t *args, int
     return js_mkundef();
   }
   ant_inspector_network_append_response_body(req->network_request_id, chunk, chunk_len);
-
-  ant_http1_buffer_init(&buf);
-  if (!ant_http1_write_chunk(&buf, chunk, chunk_len)) {
-    ant_http1_buffer_free(&buf);
-    ant_conn_close(req->conn);
-    server_request_release(req);
-    return js_mkundef();
-  }
-
-  out = ant_http1_buffer_take(&buf, &out_len);
   ant_conn_set_timeout_ms(req->conn, req->server->idle_timeout_ms);
+
+  // a zero-size chunk would terminate the chunked body early
+  if (chunk_len == 0) server_start_stream_read(req);
+  else if (!server_queue_chunk(req, value, chunk, chunk_len)) ant_conn_close(req->conn);
   
-  server_queue_write(req->conn, req, out, out_len, SERVER_WRITE_STREAM_READ);
   server_request_release(req);
-  
   return js_mkundef();
 }
 
@@ -1272,6 +1504,8 @@ static void server_write_cb(ant_conn_t *conn, int status, void *user_data) {
   server_request_t *req = wr->request;
   server_conn_state_t *cs = conn ? (server_conn_state_t *)ant_conn_get_user_data(conn) : NULL;
 
+  if (req) req->response_chunk = js_mkundef();
+
   if (status < 0 && conn && !ant_conn_is_closing(conn)) ant_conn_close(conn);
   if (status < 0 && req) server_network_fail(req, uv_strerror(status));
 
@@ -1320,6 +1554,10 @@ static void server_write_cb(ant_conn_t *conn, int status, void *user_data) {
     ant_conn_close(conn);
     break;
     
+  case SERVER_WRITE_SEND_FILE:
+    if (req) server_start_send_file(req);
+    break;
+    
   default: break;
   }}
 
@@ -1357,6 +1595,17 @@ static ant_value_t server_timeout(ant_t *js, ant_value_t *args, int nargs) {
   return js_mkundef();
 }
 
+static ant_value_t server_publish(ant_t *js, ant_value_t *args, int nargs) {
+  return ant_websocket_publish(
+    js, nargs > 0 ? args[0] : js_mkundef(),
+    nargs > 1 ? args[1] : js_mkundef(), js_mkundef()
+  );
+}
+
+static ant_value_t server_subscriber_count(ant_t *js, ant_value_t *args, int nargs) {
+  return ant_websocket_subscriber_count(js, nargs > 0 ? args[0] : js_mkundef());
+}
+
 static ant_value_t server_stop(ant_t *js, ant_value_t *args, int nargs) {
   server_runtime_t *server = server_current_runtime(js);
   stop_waiter_t *waiter = NULL;
@@ -1395,6 +1644,7 @@ static void server_process_client_request(
   ant_value_t request_obj = 0;
   ant_value_t result = 0;
   ant_http_header_t *raw_headers = NULL;
+  multipart_parser_t *multipart = NULL;
   bool keep_alive = false;
 
   if (!server || !cs) {
@@ -1406,8 +1656,11 @@ static void server_process_client_request(
   js = server->js;
   req = &cs->request;
   keep_alive = parsed->keep_alive;
+  multipart = cs->multipart;
+  cs->multipart = NULL;
   raw_headers = server_copy_raw_headers(parsed->headers);
   if (parsed->headers && !raw_headers) {
+    multipart_parser_free(multipart);
     ant_http1_free_parsed_request(parsed);
     server_send_internal_error(conn, NULL);
     return;
@@ -1416,6 +1669,7 @@ static void server_process_client_request(
   headers = server_headers_from_parsed(js, parsed);
   
   if (is_err(headers)) {
+    multipart_parser_free(multipart);
     ant_http_headers_free(raw_headers);
     ant_http1_free_parsed_request(parsed);
     server_send_internal_error(conn, NULL);
@@ -1430,18 +1684,22 @@ static void server_process_client_request(
     parsed->host,
     server->hostname,
     server->port,
+    ant_conn_is_secure(conn),
     headers,
     parsed->body,
     parsed->body_len,
-    parsed->content_type
+    parsed->content_type,
+    server->multipart_spill_threshold
   );
   ant_http1_free_parsed_request(parsed);
 
   if (is_err(request_obj)) {
+    multipart_parser_free(multipart);
     ant_http_headers_free(raw_headers);
     server_send_internal_error(conn, NULL);
     return;
   }
+  if (multipart) request_set_multipart_body(request_obj, multipart);
 
   server_request_reset(req);
   req->server = server;
@@ -1463,6 +1721,31 @@ static void server_process_client_request(
   server_handle_fetch_result(req, result);
 }
 
+static bool server_multipart_sink(void *data, const uint8_t *chunk, size_t len) {
+  // a malformed body is reported by formData(), not as a bad request
+  multipart_parser_feed((multipart_parser_t *)data, chunk, len);
+  return true;
+}
+
+// a multipart upload larger than the spill threshold goes straight into the
+// multipart parser as it arrives, so its file parts land on disk instead of
+// the whole body collecting in the connection buffer first
+static void server_on_request_headers(llhttp_t *parser, ant_http1_parser_ctx_t *ctx, void *data) {
+  server_conn_state_t *cs = (server_conn_state_t *)data;
+  size_t threshold = cs->server->multipart_spill_threshold;
+  
+  if (threshold == 0 || !ctx->req.content_type) return;
+  if (!(parser->flags & F_CHUNKED) && ctx->req.content_length <= threshold) return;
+
+  multipart_parser_t *mp = multipart_parser_new(ctx->req.content_type, threshold);
+  if (!mp) return;
+
+  multipart_parser_free(cs->multipart);
+  cs->multipart = mp;
+  ctx->body_sink = server_multipart_sink;
+  ctx->body_sink_data = mp;
+}
+
 static void server_on_read(ant_conn_t *conn, ssize_t nread, void *user_data) {
   server_conn_state_t *cs = (server_conn_state_t *)ant_conn_get_user_data(conn);
   ant_http1_parsed_request_t parsed = {0};
@@ -1487,11 +1770,18 @@ static void server_on_read(ant_conn_t *conn, ssize_t nread, void *user_data) {
   );
   
   if (parse_result == ANT_HTTP1_PARSE_ERROR) {
+    multipart_parser_free(cs->multipart);
+    cs->multipart = NULL;
     ant_http1_free_parsed_request(&parsed);
     server_send_text_response(conn, 400, "Bad Request", "Bad Request");
     return;
   }
 
+  // a streamed body has already gone into the parser, keeping it in the
+  // connection buffer would hold the whole upload in memory again
+  if (parse_result == ANT_HTTP1_PARSE_INCOMPLETE && cs->multipart)
+    ant_conn_consume(conn, ant_http1_conn_parser_drop_fed(&cs->parser));
+
   if (parse_result != ANT_HTTP1_PARSE_OK) return;
   server_process_client_request(conn, &parsed, consumed);
 }
@@ -1511,6 +1801,8 @@ static void server_on_conn_close(ant_conn_t *conn, void *user_data) {
       ant_websocket_server_on_close(server ? server->js : NULL, cs->websocket_obj);
       cs->websocket_obj = js_mkundef();
     } else ant_http1_conn_parser_free(&cs->parser);
+    multipart_parser_free(cs->multipart);
+    cs->multipart = NULL;
     if (!uv_is_closing((uv_handle_t *)&cs->drain_timer))
       uv_close((uv_handle_t *)&cs->drain_timer, server_on_drain_timer_close);
     if (cs->active_req) {
@@ -1532,6 +1824,7 @@ static void server_on_listener_close(ant_listener_t *listener, void *user_data)
 }
 
 static char *server_make_url(const server_runtime_t *server) {
+  const char *scheme = NULL;
   const char *hostname = NULL;
   
   size_t hostname_len = 0;
@@ -1542,16 +1835,17 @@ static char *server_make_url(const server_runtime_t *server) {
   int written = 0;
 
   if (!server || server->unix_path) return NULL;
+  scheme = server->tls ? "https" : "http";
   hostname = server->hostname ? server->hostname : "0.0.0.0";
   hostname_len = strlen(hostname);
   bracket_host = strchr(hostname, ':') != NULL && hostname[0] != '[';
-  cap = sizeof("http://") - 1 + hostname_len + (bracket_host ? 2 : 0) + 1 + 16 + 1;
+  cap = sizeof("https://") - 1 + hostname_len + (bracket_host ? 2 : 0) + 1 + 16 + 1;
 
   url = malloc(cap);
   if (!url) return NULL;
 
-  if (bracket_host) written = snprintf(url, cap, "http://[%s]:%d", hostname, server->port);
-  else written = snprintf(url, cap, "http://%s:%d", hostname, server->port);
+  if (bracket_host) written = snprintf(url, cap, "%s://[%s]:%d", scheme, hostname, server->port);
+  else written = snprintf(url, cap, "%s://%s:%d", scheme, hostname, server->port);
 
   if (written < 0 || (size_t)written >= cap) {
     free(url);
@@ -1591,6 +1885,8 @@ static void server_on_accept(ant_listener_t *listener, ant_conn_t *conn, void *u
   cs->drain_timer.data = cs;
   cs->drain_timer_closed = false;
   ant_http1_conn_parser_init(&cs->parser);
+  cs->parser.ctx.on_headers = server_on_request_headers;
+  cs->parser.ctx.on_headers_data = cs;
   ant_conn_set_user_data(conn, cs);
   ant_conn_set_no_delay(conn, true);
 }
@@ -1655,12 +1951,90 @@ fail:
   return EXIT_FAILURE;
 }
 
+static ant_value_t server_tls_bytes(
+  ant_t *js, ant_value_t value, const char *name,
+  const char **out, size_t *len
+) {
+  const uint8_t *bytes = NULL;
+
+  if (vtype(value) == T_STR) {
+    *out = js_getstr(js, value, len);
+    return js_mkundef();
+  }
+
+  if (buffer_source_get_bytes(js, value, &bytes, len)) {
+    *out = (const char *)bytes;
+    return js_mkundef();
+  }
+
+  return js_mkerr_typed(js, JS_ERR_TYPE, "server tls.%s must be a string or BufferSource", name);
+}
+
+// cert and key are pem, the cert may carry the rest of the chain after the leaf
+static ant_value_t server_tls_from_options(ant_t *js, ant_value_t tls_v, ant_tls_server_t **out) {
+  ant_tls_server_options_t opts = { .session_tickets = true, .kernel_tx = true };
+  ant_value_t passphrase_v = 0;
+  ant_value_t timeout_v = 0;
+  ant_value_t tickets_v = 0;
+  ant_value_t ktls_v = 0;
+  ant_value_t error = 0;
+  const char *message = NULL;
+
+  if (!is_object_type(tls_v))
+    return js_mkerr_typed(js, JS_ERR_TYPE, "server tls must be an object");
+
+  error = server_tls_bytes(js, js_get(js, tls_v, "cert"), "cert", &opts.cert, &opts.cert_len);
+  if (is_err(error)) return error;
+  
+  error = server_tls_bytes(js, js_get(js, tls_v, "key"), "key", &opts.key, &opts.key_len);
+  if (is_err(error)) return error;
+
+  passphrase_v = js_get(js, tls_v, "passphrase");
+  timeout_v = js_get(js, tls_v, "sessionTimeout");
+  tickets_v = js_get(js, tls_v, "sessionTickets");
+  ktls_v = js_get(js, tls_v, "kernelTLS");
+
+  if (vtype(passphrase_v) != T_UNDEF && vtype(passphrase_v) != T_NULL) {
+    if (vtype(passphrase_v) != T_STR)
+      return js_mkerr_typed(js, JS_ERR_TYPE, "server tls.passphrase must be a string");
+    opts.passphrase = js_getstr(js, passphrase_v, NULL);
+  }
+
+  if (vtype(timeout_v) != T_UNDEF && vtype(timeout_v) != T_NULL) {
+    double timeout = 0;
+    if (vtype(timeout_v) != T_NUM)
+      return js_mkerr_typed(js, JS_ERR_TYPE, "server tls.sessionTimeout must be a number");
+    timeout = js_getnum(timeout_v);
+    if (!isfinite(timeout) || timeout < 1 || timeout > UINT32_MAX)
+      return js_mkerr_typed(js, JS_ERR_RANGE, "server tls.sessionTimeout must be > 0");
+    opts.session_timeout_secs = (uint32_t)timeout;
+  }
+
+  if (vtype(tickets_v) != T_UNDEF && vtype(tickets_v) != T_NULL) {
+    if (vtype(tickets_v) != T_BOOL)
+      return js_mkerr_typed(js, JS_ERR_TYPE, "server tls.sessionTickets must be a boolean");
+    opts.session_tickets = js_truthy(js, tickets_v);
+  }
+
+  if (vtype(ktls_v) != T_UNDEF && vtype(ktls_v) != T_NULL) {
+    if (vtype(ktls_v) != T_BOOL)
+      return js_mkerr_typed(js, JS_ERR_TYPE, "server tls.kernelTLS must be a boolean");
+    opts.kernel_tx = js_truthy(js, ktls_v);
+  }
+
+  if (ant_tls_server_new(&opts, out, &message) != 0)
+    return js_mkerr_typed(js, JS_ERR_TYPE, "server %s", message ? message : "tls config is invalid");
+
+  return js_mkundef();
+}
+
 ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
   server_runtime_t *server = NULL;
   
   ant_value_t port_v = 0;
   ant_value_t hostname_v = 0;
   ant_value_t idle_timeout_v = 0;
+  ant_value_t spill_threshold_v = 0;
   ant_value_t request_timeout_v = 0;
   ant_value_t websocket_v = 0;
   ant_value_t unix_v = 0;
@@ -1686,6 +2060,8 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
     .idle_timeout_ms = 30000,
     .websocket_idle_timeout_ms = 120000,
     .websocket_max_payload_len = 16u * 1024u * 1024u,
+    .websocket_backpressure_limit = 16u * 1024u * 1024u,
+    .multipart_spill_threshold = MULTIPART_SPILL_DEFAULT,
     .loop = uv_default_loop(),
   };
 
@@ -1712,17 +2088,11 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
     }
   }
   
-  if (vtype(tls_v) != T_UNDEF && vtype(tls_v) != T_NULL) {
-    free(server->unix_path);
-    free(server->hostname);
-    free(server);
-    return js_mkerr_typed(js, JS_ERR_TYPE, "tls server config is not implemented yet");
-  }
-
   port_v = js_get(js, default_export, "port");
   hostname_v = js_get(js, default_export, "hostname");
   idle_timeout_v = js_get(js, default_export, "idleTimeout");
   request_timeout_v = js_get(js, default_export, "requestTimeout");
+  spill_threshold_v = js_get(js, default_export, "multipartSpillThreshold");
   websocket_v = js_get(js, default_export, "websocket");
 
   if (vtype(port_v) != T_UNDEF && vtype(port_v) != T_NULL) {
@@ -1798,9 +2168,32 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
     server->request_timeout_ms = (uint64_t)(timeout * 1000.0);
   }
 
+  // multipart uploads above the threshold are parsed while they arrive and
+  // their file parts kept on disk; smaller bodies are buffered as before
+  if (vtype(spill_threshold_v) != T_UNDEF && vtype(spill_threshold_v) != T_NULL) {
+    double threshold = 0;
+    if (vtype(spill_threshold_v) != T_NUM) {
+      free(server->unix_path);
+      free(server->hostname);
+      free(server);
+      return js_mkerr_typed(js, JS_ERR_TYPE, "server multipartSpillThreshold must be a number");
+    }
+    
+    threshold = js_getnum(spill_threshold_v);
+    if (threshold < 0) {
+      free(server->unix_path);
+      free(server->hostname);
+      free(server);
+      return js_mkerr_typed(js, JS_ERR_RANGE, "server multipartSpillThreshold must be >= 0");
+    }
+    
+    server->multipart_spill_threshold = (size_t)threshold;
+  }
+
   if (vtype(websocket_v) != T_UNDEF && vtype(websocket_v) != T_NULL) {
     ant_value_t ws_idle_timeout_v = 0;
     ant_value_t ws_max_payload_v = 0;
+    ant_value_t ws_backpressure_v = 0;
     ant_value_t ws_deflate_v = 0;
 
     if (!is_object_type(websocket_v)) {
@@ -1812,6 +2205,7 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
 
     ws_idle_timeout_v = js_get(js, websocket_v, "idleTimeout");
     ws_max_payload_v = js_get(js, websocket_v, "maxPayloadLength");
+    ws_backpressure_v = js_get(js, websocket_v, "backpressureLimit");
     ws_deflate_v = js_get(js, websocket_v, "perMessageDeflate");
 
     if (vtype(ws_idle_timeout_v) != T_UNDEF && vtype(ws_idle_timeout_v) != T_NULL) {
@@ -1850,6 +2244,24 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
       server->websocket_max_payload_len = (size_t)max_payload;
     }
 
+    if (vtype(ws_backpressure_v) != T_UNDEF && vtype(ws_backpressure_v) != T_NULL) {
+      double limit = 0;
+      if (vtype(ws_backpressure_v) != T_NUM) {
+        free(server->unix_path);
+        free(server->hostname);
+        free(server);
+        return js_mkerr_typed(js, JS_ERR_TYPE, "server websocket.backpressureLimit must be a number");
+      }
+      limit = js_getnum(ws_backpressure_v);
+      if (!isfinite(limit) || limit < 0 || limit > (double)SIZE_MAX) {
+        free(server->unix_path);
+        free(server->hostname);
+        free(server);
+        return js_mkerr_typed(js, JS_ERR_RANGE, "server websocket.backpressureLimit must be >= 0");
+      }
+      server->websocket_backpressure_limit = (size_t)limit;
+    }
+
     if (vtype(ws_deflate_v) != T_UNDEF && vtype(ws_deflate_v) != T_NULL) {
       if (vtype(ws_deflate_v) != T_BOOL && !is_object_type(ws_deflate_v)) {
         free(server->unix_path);
@@ -1861,6 +2273,16 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
     }
   }
 
+  if (vtype(tls_v) != T_UNDEF && vtype(tls_v) != T_NULL) {
+    ant_value_t error = server_tls_from_options(js, tls_v, &server->tls);
+    if (is_err(error)) {
+      free(server->unix_path);
+      free(server->hostname);
+      free(server);
+      return error;
+    }
+  }
+
   uv_signal_init(server->loop, &server->sigint_handle);
   uv_signal_init(server->loop, &server->sigterm_handle);
   server->sigint_handle.data = server;
@@ -1881,6 +2303,7 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
   } else {
     if (!ant_sandbox_policy_port_forwarded(server->port)) {
       int port = server->port;
+      ant_tls_server_release(server->tls);
       free(server->unix_path);
       free(server->hostname);
       free(server);
@@ -1900,6 +2323,7 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
   
   if (rc != 0) {
     ant_value_t error = server_mk_listen_error(js, rc, server);
+    ant_tls_server_release(server->tls);
     free(server->unix_path);
     free(server->hostname);
     free(server);
@@ -1907,6 +2331,7 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
   }
 
   server->port = ant_listener_port(&server->listener);
+  ant_listener_set_tls(&server->listener, server->tls);
   uv_signal_start(&server->sigint_handle, server_signal_cb, SIGINT);
   uv_signal_start(&server->sigterm_handle, server_signal_cb, SIGTERM);
 
@@ -1933,6 +2358,8 @@ ant_value_t server_start_from_export(ant_t *js, ant_value_t default_export) {
   js_set(js, server->server_ctx, "timeout", server_mkruntimefun(js, server_timeout, server));
   js_set(js, server->server_ctx, "stop", server_mkruntimefun(js, server_stop, server));
   js_set(js, server->server_ctx, "upgradeWebSocket", server_mkruntimefun(js, server_upgrade_websocket, server));
+  js_set(js, server->server_ctx, "publish", js_mkfun(server_publish));
+  js_set(js, server->server_ctx, "subscriberCount", js_mkfun(server_subscriber_count));
   js_set(js, server->server_ctx, "eventSource", js_mkfun(server_event_source));
 
   g_server = server;
@@ -1954,6 +2381,7 @@ void gc_mark_server(ant_t *js, gc_mark_fn mark) {
     mark(js, req->response_promise);
     mark(js, req->response_reader);
     mark(js, req->response_read_promise);
+    mark(js, req->response_chunk);
   }
 
   for (ant_conn_t *conn = g_server->listener.connections; conn; conn = conn->next) {
@@ -286,6 +286,10 @@ static ant_value_t sc_clone_rec(ant_t *js, ant_value_t val, sc_entry_t **seen, s
     ant_value_t clone = blob_create(js, bd->data, bd->size, bd->type);
     if (is_err(clone)) return clone;
     sc_add(seen, val, clone);
+    if (bd->path) {
+      blob_data_t *nbd = blob_get_data(clone);
+      if (nbd) { nbd->path = blob_path_dup(bd->path); nbd->offset = bd->offset; }
+    }
     if (bd->name) {
       blob_data_t *nbd = blob_get_data(clone);
       if (nbd) {
@@ -250,9 +250,9 @@ static ant_value_t v8_get_heap_statistics(ant_t *js, ant_value_t *args, int narg
   size_t rss = 0;
   uv_resident_set_memory(&rss);
 
-  size_t arena_committed  = js->obj_arena.committed;
-  size_t arena_reserved   = js->obj_arena.reserved;
-  size_t arena_live_bytes = js->obj_arena.live_count * js->obj_arena.elem_size;
+  size_t arena_committed  = js_obj_committed_bytes(js);
+  size_t arena_reserved   = js_obj_reserved_bytes(js);
+  size_t arena_live_bytes = js_obj_live_bytes(js);
 
   size_t closure_committed = js->closure_arena.committed;
   size_t closure_reserved  = js->closure_arena.reserved;
@@ -289,8 +289,9 @@ static ant_value_t v8_get_heap_statistics(ant_t *js, ant_value_t *args, int narg
 
 static ant_value_t v8_get_heap_space_statistics(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t nursery = js_mkobj(js);
-  size_t arena_committed  = js->obj_arena.committed;
-  size_t arena_live_bytes = js->obj_arena.live_count * js->obj_arena.elem_size;
+  size_t arena_committed  = js_obj_committed_bytes(js);
+  size_t arena_live_bytes = js_obj_live_bytes(js);
+  size_t arena_live_count = js_obj_live_count(js);
   double arena_available = (double)(arena_committed / 2 > arena_live_bytes / 2 ? arena_committed / 2 - arena_live_bytes / 2 : 0);
 
   js_set(js, nursery, "space_name",            js_mkstr(js, "new_space", 9));
@@ -300,7 +301,7 @@ static ant_value_t v8_get_heap_space_statistics(ant_t *js, ant_value_t *args, in
   js_set(js, nursery, "physical_space_size",   js_mknum((double)arena_committed / 2));
 
   ant_value_t oldspace = js_mkobj(js);
-  size_t old_live = js->old_live_count * js->obj_arena.elem_size;
+  size_t old_live = arena_live_count ? js->old_live_count * (arena_live_bytes / arena_live_count) : 0;
   double old_size = (double)(arena_committed / 2 > old_live ? arena_committed / 2 - old_live : 0);
   
   js_set(js, oldspace, "space_name",           js_mkstr(js, "old_space", 9));
@@ -7,11 +7,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <tlsuv/websocket.h>
+#include <uthash.h>
 #include <uv.h>
 #include <zlib.h>
 
 #include "ant.h"
 #include "common.h"
+#include "descriptors.h"
 #include "errors.h"
 #include "inspector.h"
 #include "internal.h"
@@ -37,6 +39,10 @@ typedef struct websocket_state_s {
   size_t fragment_len;
   size_t fragment_cap;
   size_t max_payload_len;
+  size_t backpressure_limit;
+  struct websocket_topic_s **topics;
+  size_t topic_count;
+  size_t topic_cap;
   ant_ws_opcode_t fragment_opcode;
   uint16_t client_close_code;
   uint8_t ready_state;
@@ -50,6 +56,23 @@ typedef struct websocket_state_s {
   bool per_message_deflate : 1;
 } websocket_state_t;
 
+typedef struct websocket_topic_s {
+  char *name;
+  size_t name_len;
+  websocket_state_t **subscribers;
+  size_t count;
+  size_t cap;
+  UT_hash_handle hh;
+} websocket_topic_t;
+
+// one encoded frame shared by every socket a message is published to,
+// each pending write holds a reference
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  size_t refs;
+} websocket_shared_frame_t;
+
 enum {
   WS_CONNECTING = 0,
   WS_OPEN = 1,
@@ -58,9 +81,11 @@ enum {
 };
 
 static websocket_state_t *g_active_websockets = NULL;
+static websocket_topic_t *g_websocket_topics = NULL;
 
 static constexpr uint32_t WS_NATIVE_TAG = 0x57534f42u; // WSOB
 static constexpr uint32_t WS_DEFAULT_MAX_PAYLOAD_LEN = 16u * 1024u * 1024u;
+static constexpr uint32_t WS_DEFAULT_BACKPRESSURE_LIMIT = 16u * 1024u * 1024u;
 
 static websocket_state_t *websocket_data(ant_value_t value) {
   return (websocket_state_t *)js_get_native(value, WS_NATIVE_TAG);
@@ -123,9 +148,98 @@ static bool websocket_fragment_append(websocket_state_t *ws, const uint8_t *data
   return true;
 }
 
+static bool websocket_reserve(void **items, size_t *cap, size_t need, size_t size) {
+  size_t next_cap = *cap ? *cap : 4;
+  void *next = NULL;
+
+  if (need <= *cap) return true;
+  while (next_cap < need) next_cap *= 2;
+  
+  next = realloc(*items, next_cap * size);
+  if (!next) return false;
+  
+  *items = next;
+  *cap = next_cap;
+  
+  return true;
+}
+
+static websocket_topic_t *websocket_topic_find(const char *name, size_t name_len) {
+  websocket_topic_t *topic = NULL;
+  HASH_FIND(hh, g_websocket_topics, name, name_len, topic);
+  return topic;
+}
+
+static bool websocket_is_subscribed(websocket_state_t *ws, websocket_topic_t *topic) {
+  for (size_t i = 0; topic && i < ws->topic_count; i++)
+    if (ws->topics[i] == topic) return true;
+  return false;
+}
+
+static void websocket_topic_free(websocket_topic_t *topic) {
+  HASH_DEL(g_websocket_topics, topic);
+  free(topic->subscribers);
+  free(topic->name);
+  free(topic);
+}
+
+static bool websocket_subscribe(websocket_state_t *ws, const char *name, size_t name_len) {
+  websocket_topic_t *topic = websocket_topic_find(name, name_len);
+  if (websocket_is_subscribed(ws, topic)) return true;
+
+  if (!topic) {
+    topic = calloc(1, sizeof(*topic));
+    if (!topic) return false;
+    topic->name = malloc(name_len + 1);
+    if (!topic->name) {
+      free(topic);
+      return false;
+    }
+    memcpy(topic->name, name, name_len);
+    topic->name[name_len] = '\0';
+    topic->name_len = name_len;
+    HASH_ADD_KEYPTR(hh, g_websocket_topics, topic->name, topic->name_len, topic);
+  }
+
+  if (
+    !websocket_reserve((void **)&topic->subscribers, &topic->cap, topic->count + 1, sizeof(*topic->subscribers)) ||
+    !websocket_reserve((void **)&ws->topics, &ws->topic_cap, ws->topic_count + 1, sizeof(*ws->topics))
+  ) {
+    if (topic->count == 0) websocket_topic_free(topic);
+    return false;
+  }
+
+  topic->subscribers[topic->count++] = ws;
+  ws->topics[ws->topic_count++] = topic;
+  
+  return true;
+}
+
+static void websocket_unsubscribe(websocket_state_t *ws, websocket_topic_t *topic) {
+  for (size_t i = 0; i < topic->count; i++) if (topic->subscribers[i] == ws) {
+    topic->subscribers[i] = topic->subscribers[--topic->count];
+    break;
+  }
+
+  for (size_t i = 0; i < ws->topic_count; i++) if (ws->topics[i] == topic) {
+    ws->topics[i] = ws->topics[--ws->topic_count];
+    break;
+  }
+
+  if (topic->count == 0) websocket_topic_free(topic);
+}
+
+static void websocket_unsubscribe_all(websocket_state_t *ws) {
+  while (ws->topic_count > 0) websocket_unsubscribe(ws, ws->topics[ws->topic_count - 1]);
+  free(ws->topics);
+  ws->topics = NULL;
+  ws->topic_cap = 0;
+}
+
 static void websocket_free_state(websocket_state_t *ws) {
   if (!ws) return;
   websocket_remove_active(ws);
+  websocket_unsubscribe_all(ws);
   websocket_fragment_clear(ws);
   free(ws);
 }
@@ -144,7 +258,6 @@ static ant_value_t websocket_call(ant_t *js, ant_value_t fn, ant_value_t this_va
 static void websocket_sync_state(websocket_state_t *ws) {
   if (!ws || !is_object_type(ws->obj)) return;
   js_set(ws->js, ws->obj, "readyState", js_mknum(ws->ready_state));
-  js_set(ws->js, ws->obj, "bufferedAmount", js_mknum(0));
 }
 
 static ant_value_t websocket_make_event(ant_t *js, ant_value_t proto, const char *type) {
@@ -329,6 +442,7 @@ static void websocket_emit_close(websocket_state_t *ws, uint16_t code, const cha
   
   ws->close_emitted = true;
   ws->ready_state = WS_CLOSED;
+  websocket_unsubscribe_all(ws);
   websocket_fragment_clear(ws);
   websocket_sync_state(ws);
 
@@ -436,6 +550,56 @@ static void websocket_server_close_with_code(websocket_state_t *ws, ant_conn_t *
   if (conn) ant_conn_shutdown(conn);
 }
 
+static websocket_shared_frame_t *websocket_shared_frame_new(
+  ant_ws_opcode_t opcode, const uint8_t *bytes, size_t len, bool deflate
+) {
+  websocket_shared_frame_t *sf = calloc(1, sizeof(*sf));
+  uint8_t *compressed = NULL;
+  size_t compressed_len = 0;
+
+  if (!sf) return NULL;
+  if (deflate) {
+    if (!websocket_deflate_message(bytes, len, &compressed, &compressed_len)) {
+      free(sf);
+      return NULL;
+    }
+    bytes = compressed;
+    len = compressed_len;
+  }
+
+  sf->data = ant_ws_encode_frame(opcode, bytes, len, false, deflate, &sf->len);
+  free(compressed);
+  if (!sf->data) {
+    free(sf);
+    return NULL;
+  }
+
+  sf->refs = 1;
+  return sf;
+}
+
+static void websocket_shared_frame_release(websocket_shared_frame_t *sf) {
+  if (!sf || --sf->refs > 0) return;
+  free(sf->data);
+  free(sf);
+}
+
+static void websocket_shared_write_cb(ant_conn_t *conn, int status, void *user_data) {
+  websocket_shared_frame_release((websocket_shared_frame_t *)user_data);
+}
+
+static bool websocket_shared_frame_write(websocket_shared_frame_t *sf, ant_conn_t *conn) {
+  uv_buf_t buf = uv_buf_init((char *)sf->data, (unsigned int)sf->len);
+  
+  sf->refs++;
+  if (ant_conn_writev(conn, &buf, 1, 0, websocket_shared_write_cb, sf) != 0) {
+    sf->refs--;
+    return false;
+  }
+  
+  return true;
+}
+
 static void websocket_finalize(ant_t *js, ant_object_t *obj) {
   (void)js;
   ant_value_t value = js_obj_from_ptr(obj);
@@ -452,6 +616,7 @@ static websocket_state_t *websocket_state_new(ant_t *js, ant_value_t obj) {
   ws->obj = obj;
   ws->ready_state = WS_CONNECTING;
   ws->max_payload_len = WS_DEFAULT_MAX_PAYLOAD_LEN;
+  ws->backpressure_limit = WS_DEFAULT_BACKPRESSURE_LIMIT;
   websocket_add_active(ws);
   return ws;
 }
@@ -462,7 +627,6 @@ static ant_value_t websocket_create_object(ant_t *js) {
   js_set_slot(obj, SLOT_BRAND, js_mknum(BRAND_EVENTTARGET));
   js_set(js, obj, "binaryType", js_mkstr(js, "arraybuffer", 11));
   js_set_descriptor(js, obj, "binaryType", 10, JS_DESC_W | JS_DESC_C);
-  js_set(js, obj, "bufferedAmount", js_mknum(0));
   js_set(js, obj, "extensions", js_mkstr(js, "", 0));
   js_set(js, obj, "protocol", js_mkstr(js, "", 0));
   js_set(js, obj, "onopen", js_mknull());
@@ -608,6 +772,153 @@ static ant_value_t js_websocket_close(ant_t *js, ant_value_t *args, int nargs) {
   return js_mkundef();
 }
 
+static ant_value_t js_websocket_buffered_amount(ant_t *js, ant_value_t *args, int nargs) {
+  websocket_state_t *ws = websocket_data(js_getthis(js));
+  if (!ws || !ws->server_conn) return js_mknum(0);
+  return js_mknum((double)ant_conn_write_queue_size(ws->server_conn));
+}
+
+static websocket_state_t *websocket_server_this(ant_t *js, const char *method, ant_value_t *err) {
+  websocket_state_t *ws = websocket_data(js_getthis(js));
+  *err = js_mkundef();
+  if (!ws) *err = js_mkerr_typed(js, JS_ERR_TYPE, "Invalid WebSocket");
+  else if (ws->is_client) *err = js_mkerr_typed(js, JS_ERR_TYPE, "WebSocket.%s() is only available on server sockets", method);
+  return is_err(*err) ? NULL : ws;
+}
+
+static ant_value_t websocket_topic_arg(ant_t *js, ant_value_t *args, int nargs, const char **name, size_t *name_len) {
+  ant_value_t topic = js_tostring_val(js, nargs > 0 ? args[0] : js_mkundef());
+  if (is_err(topic)) return topic;
+  *name = js_getstr(js, topic, name_len);
+  return topic;
+}
+
+static ant_value_t js_websocket_subscribe(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t err = 0;
+  websocket_state_t *ws = websocket_server_this(js, "subscribe", &err);
+  const char *name = NULL;
+  size_t name_len = 0;
+
+  if (!ws) return err;
+  ant_value_t topic = websocket_topic_arg(js, args, nargs, &name, &name_len);
+  if (is_err(topic)) return topic;
+  if (ws->ready_state >= WS_CLOSING) return js_mkundef();
+  if (!websocket_subscribe(ws, name, name_len)) return js_mkerr_typed(js, JS_ERR_TYPE, "Out of memory");
+  
+  return js_mkundef();
+}
+
+static ant_value_t js_websocket_unsubscribe(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t err = 0;
+  websocket_state_t *ws = websocket_server_this(js, "unsubscribe", &err);
+  const char *name = NULL;
+  size_t name_len = 0;
+
+  if (!ws) return err;
+  ant_value_t topic = websocket_topic_arg(js, args, nargs, &name, &name_len);
+  if (is_err(topic)) return topic;
+  
+  websocket_topic_t *entry = websocket_topic_find(name, name_len);
+  if (websocket_is_subscribed(ws, entry)) websocket_unsubscribe(ws, entry);
+  
+  return js_mkundef();
+}
+
+static ant_value_t js_websocket_is_subscribed(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t err = 0;
+  websocket_state_t *ws = websocket_server_this(js, "isSubscribed", &err);
+  const char *name = NULL;
+  size_t name_len = 0;
+
+  if (!ws) return err;
+  ant_value_t topic = websocket_topic_arg(js, args, nargs, &name, &name_len);
+  if (is_err(topic)) return topic;
+  
+  return js_bool(websocket_is_subscribed(ws, websocket_topic_find(name, name_len)));
+}
+
+static ant_value_t js_websocket_publish(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t err = 0;
+  ant_value_t self = js_getthis(js);
+  
+  if (!websocket_server_this(js, "publish", &err)) return err;
+  return ant_websocket_publish(
+    js, nargs > 0 ? args[0] : js_mkundef(),
+    nargs > 1 ? args[1] : js_mkundef(), self
+  );
+}
+
+// the frame is encoded (and deflated) at most once per variant and the
+// same buffer is queued on every subscriber; sockets whose write queue is
+// over their backpressure limit are skipped
+ant_value_t ant_websocket_publish(ant_t *js, ant_value_t topic, ant_value_t data, ant_value_t exclude) {
+  websocket_state_t *skip = is_object_type(exclude) ? websocket_data(exclude) : NULL;
+  websocket_shared_frame_t *plain = NULL;
+  websocket_shared_frame_t *deflated = NULL;
+  websocket_topic_t *entry = NULL;
+  ant_value_t keepalive = js_mkundef();
+  
+  const char *name = NULL;
+  const uint8_t *bytes = NULL;
+  
+  size_t name_len = 0;
+  size_t len = 0;
+  size_t sent = 0;
+  
+  bool binary = false;
+  bool failed = false;
+
+  topic = js_tostring_val(js, topic);
+  if (is_err(topic)) return topic;
+  name = js_getstr(js, topic, &name_len);
+
+  binary = buffer_source_get_bytes(js, data, &bytes, &len);
+  if (!binary && !websocket_bytes_from_value(js, data, &bytes, &len, &keepalive))
+    return js_mkerr_typed(js, JS_ERR_TYPE, "Invalid WebSocket message");
+
+  entry = websocket_topic_find(name, name_len);
+  for (size_t i = 0; entry && i < entry->count; i++) {
+    websocket_state_t *ws = entry->subscribers[i];
+    websocket_shared_frame_t **frame = ws->per_message_deflate ? &deflated : &plain;
+
+    if (ws == skip || ws->ready_state != WS_OPEN) continue;
+    if (!ws->server_conn || ant_conn_is_closing(ws->server_conn)) continue;
+    if (ws->backpressure_limit > 0 && ant_conn_write_queue_size(ws->server_conn) > ws->backpressure_limit) continue;
+
+    if (!*frame) *frame = websocket_shared_frame_new(
+      binary ? ANT_WS_OPCODE_BINARY : ANT_WS_OPCODE_TEXT,
+      bytes, len, ws->per_message_deflate
+    );
+    
+    if (!*frame) {
+      failed = true;
+      break;
+    }
+    
+    if (websocket_shared_frame_write(*frame, ws->server_conn)) sent++;
+  }
+
+  websocket_shared_frame_release(plain);
+  websocket_shared_frame_release(deflated);
+  
+  if (failed) return js_mkerr_typed(js, JS_ERR_TYPE, "Out of memory");
+  return js_mknum((double)sent);
+}
+
+ant_value_t ant_websocket_subscriber_count(ant_t *js, ant_value_t topic) {
+  websocket_topic_t *entry = NULL;
+  const char *name = NULL;
+  size_t name_len = 0;
+
+  topic = js_tostring_val(js, topic);
+  if (is_err(topic)) return topic;
+  
+  name = js_getstr(js, topic, &name_len);
+  entry = websocket_topic_find(name, name_len);
+  
+  return js_mknum(entry ? (double)entry->count : 0);
+}
+
 static ant_value_t js_message_event_ctor(ant_t *js, ant_value_t *args, int nargs) {
   if (vtype(js->new_target) == T_UNDEF)
     return js_mkerr_typed(js, JS_ERR_TYPE, "MessageEvent constructor requires 'new'");
@@ -663,6 +974,7 @@ ant_value_t ant_websocket_accept_server(
   ws->ready_state = WS_CONNECTING;
   if (options) {
     ws->max_payload_len = options->max_payload_len;
+    ws->backpressure_limit = options->backpressure_limit;
     ws->per_message_deflate = options->per_message_deflate;
   }
   js_set_native(obj, ws, WS_NATIVE_TAG);
@@ -813,6 +1125,11 @@ void init_websocket_module(ant_t *js) {
   if (is_object_type(eventtarget_proto)) js_set_proto_init(js->builtins.websocket_proto, eventtarget_proto);
   js_set(js, js->builtins.websocket_proto, "send", js_mkfun(js_websocket_send));
   js_set(js, js->builtins.websocket_proto, "close", js_mkfun(js_websocket_close));
+  js_set(js, js->builtins.websocket_proto, "subscribe", js_mkfun(js_websocket_subscribe));
+  js_set(js, js->builtins.websocket_proto, "unsubscribe", js_mkfun(js_websocket_unsubscribe));
+  js_set(js, js->builtins.websocket_proto, "isSubscribed", js_mkfun(js_websocket_is_subscribed));
+  js_set(js, js->builtins.websocket_proto, "publish", js_mkfun(js_websocket_publish));
+  js_set_getter_desc(js, js->builtins.websocket_proto, "bufferedAmount", 14, js_mkfun(js_websocket_buffered_amount), JS_DESC_C);
   js_set(js, js->builtins.websocket_proto, "CONNECTING", js_mknum(WS_CONNECTING));
   js_set(js, js->builtins.websocket_proto, "OPEN", js_mknum(WS_OPEN));
   js_set(js, js->builtins.websocket_proto, "CLOSING", js_mknum(WS_CLOSING));
@@ -1,9 +1,18 @@
 #include <compat.h> // IWYU pragma: keep
 
 #ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#elif defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/uio.h>
+#endif
 #else
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -13,12 +22,23 @@
 
 #include "net/connection.h"
 #include "net/listener.h"
+#include "net/resolver.h"
+#include "net/tls_server.h"
 
 #define ANT_CONN_READ_BUFFER_SIZE (16 * 1024)
+#define ANT_CONN_SENDFILE_SLICE   (1024 * 1024)
+#define ANT_CONN_SENDFILE_CHUNK   (64 * 1024)
+#define ANT_CONN_ATTEMPT_DELAY_MS 250
+#define ANT_CONN_TLS_RECORD_SIZE  (16 * 1024)
 
+// bit i of owned marks bufs[i] as malloc'd and freed once the write completes,
+// the other buffers are borrowed and must outlive the callback
 typedef struct {
   uv_write_t req;
-  uv_buf_t buf;
+  uv_buf_t bufs[ANT_CONN_WRITEV_MAX];
+  unsigned int nbufs;
+  unsigned int owned;
+  size_t len;
   ant_conn_t *conn;
   ant_conn_write_cb cb;
   void *user_data;
@@ -29,9 +49,30 @@ typedef struct {
   ant_conn_t *conn;
 } ant_conn_shutdown_req_t;
 
+// the poll watches a dup of the socket, libuv refuses a second watcher on
+// the fd it already owns for the stream. without kernel sendfile the file
+// is read a chunk at a time on the threadpool and written from the poll
+struct ant_conn_sendfile_s {
+  uv_poll_t poll;
+  uv_fs_t read_req;
+  ant_conn_t *conn;
+  ant_conn_write_cb cb;
+  void *user_data;
+  uv_file file;
+  int sock;
+  int status;
+  int64_t offset;
+  size_t remaining;
+  char *chunk;
+  size_t chunk_len;
+  size_t chunk_off;
+  bool emulated;
+  bool reading;
+  bool poll_closed;
+};
+
 typedef struct {
   uv_connect_t connect_req;
-  uv_getaddrinfo_t resolver_req;
   ant_conn_t *conn;
   ant_conn_connect_cb cb;
   void *user_data;
@@ -41,6 +82,7 @@ typedef struct {
 static void ant_conn_restart_timer(ant_conn_t *conn);
 static void ant_conn_close_cb(uv_handle_t *handle);
 static void ant_conn_finish_close(ant_conn_t *conn);
+static void ant_conn_sendfile_close_cb(uv_handle_t *handle);
 
 static void ant_listener_remove_conn(ant_listener_t *listener, ant_conn_t *conn) {
   ant_conn_t **it = NULL;
@@ -131,79 +173,212 @@ static void ant_conn_restart_timer(ant_conn_t *conn) {
   uv_timer_start(&conn->timer, ant_conn_timeout_cb, conn->timeout_ms, 0);
 }
 
-static void ant_conn_alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
-  ant_conn_t *conn = (ant_conn_t *)handle->data;
+// makes room for at least want bytes after the buffered data
+static bool ant_conn_reserve(ant_conn_t *conn, size_t want) {
   size_t next_cap = 0;
   char *next = NULL;
 
-  if (!conn) {
-    buf->base = NULL;
-    buf->len = 0;
-    return;
-  }
-
-  if (conn->buffer_len + suggested_size > conn->buffer_cap - conn->buffer_offset) {
+  if (conn->buffer_len + want <= conn->buffer_cap - conn->buffer_offset) return true;
   if (conn->buffer_offset > 0 && conn->buffer_len > 0) memmove(conn->buffer, conn->buffer + conn->buffer_offset, conn->buffer_len);
   else if (conn->buffer_offset > 0) conn->buffer_len = 0;
   conn->buffer_offset = 0;
 
-  if (conn->buffer_len + suggested_size > conn->buffer_cap) {
+  if (conn->buffer_len + want > conn->buffer_cap) {
     next_cap = conn->buffer_cap ? conn->buffer_cap * 2 : ANT_CONN_READ_BUFFER_SIZE;
-    while (next_cap < conn->buffer_len + suggested_size) next_cap *= 2;
+    while (next_cap < conn->buffer_len + want) next_cap *= 2;
     next = realloc(conn->buffer, next_cap);
-    if (!next) {
-      buf->base = NULL;
-      buf->len = 0;
-      return;
-    }
+    if (!next) return false;
     conn->buffer = next;
     conn->buffer_cap = next_cap;
-  }}
+  }
+
+  return true;
+}
+
+static void ant_conn_alloc_cb(uv_handle_t *handle, size_t suggested_size, uv_buf_t *buf) {
+  ant_conn_t *conn = (ant_conn_t *)handle->data;
+
+  if (!conn || !ant_conn_reserve(conn, suggested_size)) {
+    buf->base = NULL;
+    buf->len = 0;
+    return;
+  }
 
   buf->base = conn->buffer + conn->buffer_offset + conn->buffer_len;
   buf->len = conn->buffer_cap - conn->buffer_offset - conn->buffer_len;
 }
 
+static void ant_conn_read_end(ant_conn_t *conn) {
+  ant_listener_t *listener = conn->listener;
+
+  conn->read_eof = true;
+  uv_read_stop(ant_conn_stream(conn));
+  if (listener->callbacks.on_end)
+    listener->callbacks.on_end(conn, listener->user_data);
+}
+
+static void ant_conn_read_error(ant_conn_t *conn, int status) {
+  ant_listener_t *listener = conn->listener;
+
+  if (listener->callbacks.on_error)
+    listener->callbacks.on_error(conn, status, listener->user_data);
+  ant_conn_close(conn);
+}
+
+static int ant_conn_submit(
+  ant_conn_t *conn, const uv_buf_t *bufs, unsigned int nbufs,
+  unsigned int owned, size_t len, ant_conn_write_cb cb, void *user_data
+);
+
+// handshake records and alerts do not count towards bytes_written
+static int ant_conn_tls_flush(ant_conn_t *conn) {
+  char *out = NULL;
+  size_t len = 0;
+  uv_buf_t buf;
+  int rc = ant_tls_conn_take_output(conn->tls, &out, &len);
+
+  if (rc != 0 || !out) return rc;
+  buf = uv_buf_init(out, (unsigned int)len);
+
+  return ant_conn_submit(conn, &buf, 1, 1u, 0, NULL, NULL);
+}
+
+static void ant_conn_shutdown_cb(uv_shutdown_t *req, int status);
+static void ant_conn_tls_try_kernel(ant_conn_t *conn);
+
+// a failed handshake or a bad record leaves an alert behind, it goes out
+// ahead of the fin instead of being dropped by an abortive close
+static void ant_conn_tls_fail(ant_conn_t *conn, int status) {
+  ant_listener_t *listener = conn->listener;
+  ant_conn_shutdown_req_t *req = NULL;
+
+  uv_read_stop(ant_conn_stream(conn));
+  if (listener->callbacks.on_error)
+    listener->callbacks.on_error(conn, status, listener->user_data);
+  if (conn->closing) return;
+
+  if (status == UV_ENOMEM || ant_conn_tls_flush(conn) != 0 || !(req = calloc(1, sizeof(*req)))) {
+    ant_conn_close(conn);
+    return;
+  }
+
+  req->conn = conn;
+  if (uv_shutdown(&req->req, ant_conn_stream(conn), ant_conn_shutdown_cb) != 0) {
+    free(req);
+    ant_conn_close(conn);
+  }
+}
+
+// the raw read already went into the bio, everything decryptable lands in
+// the connection buffer so on_read sees the same plaintext a tcp read would
+static void ant_conn_tls_pump(ant_conn_t *conn) {
+  ant_listener_t *listener = conn->listener;
+  bool was_established = conn->tls_established;
+  size_t total = 0;
+  size_t n = 0;
+  int rc = 0;
+
+  if (conn->closing) return;
+
+  rc = ant_tls_conn_handshake(conn->tls);
+  if (rc == 0) conn->tls_established = true;
+  while (rc == 0) {
+    if (!ant_conn_reserve(conn, ANT_CONN_TLS_RECORD_SIZE)) { rc = UV_ENOMEM; break; }
+    rc = ant_tls_conn_read(
+      conn->tls,
+      conn->buffer + conn->buffer_offset + conn->buffer_len,
+      conn->buffer_cap - conn->buffer_offset - conn->buffer_len, &n
+    );
+    if (rc == 0) { conn->buffer_len += n; total += n; }
+  }
+
+  if (rc != UV_EAGAIN && rc != UV_EOF) {
+    ant_conn_tls_fail(conn, rc);
+    return;
+  }
+
+  int flush = ant_conn_tls_flush(conn);
+  if (flush != 0) {
+    ant_conn_read_error(conn, flush);
+    return;
+  }
+
+  // with nothing left to flush the kernel can take over before the first
+  // response, otherwise the write callback retries once the flight is out
+  if (!was_established && conn->tls_established) ant_conn_tls_try_kernel(conn);
+
+  if (total > 0 && listener->callbacks.on_read)
+    listener->callbacks.on_read(conn, (ssize_t)total, listener->user_data);
+  if (rc == UV_EOF && !conn->closing && !conn->read_eof) ant_conn_read_end(conn);
+}
+
+static void ant_conn_tls_resume(void *user_data) {
+  ant_conn_tls_pump((ant_conn_t *)user_data);
+}
+
+// the kernel can only take over once every record sealed in userspace has
+// reached the socket, its sequence number continues from there
+static void ant_conn_tls_try_kernel(ant_conn_t *conn) {
+#ifndef _WIN32
+  uv_os_fd_t fd;
+
+  if (!conn->tls || conn->closing || conn->writes_in_flight > 0) return;
+  if (!ant_tls_conn_wants_kernel_tx(conn->tls)) return;
+  if (uv_fileno((uv_handle_t *)ant_conn_stream(conn), &fd) == 0)
+    ant_tls_conn_enable_kernel_tx(conn->tls, fd);
+#endif
+}
+
 static void ant_conn_read_cb(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
   ant_conn_t *conn = (ant_conn_t *)stream->data;
   ant_listener_t *listener = conn ? conn->listener : NULL;
+  int rc = 0;
+
   if (!conn || !listener) return;
 
   if (nread < 0) {
     if (nread == UV_EOF) {
-      conn->read_eof = true;
-      uv_read_stop(ant_conn_stream(conn));
-      if (listener->callbacks.on_end)
-        listener->callbacks.on_end(conn, listener->user_data);
+      ant_conn_read_end(conn);
       return;
     }
 
-    if (listener->callbacks.on_error) listener->callbacks.on_error(
-      conn, (int)nread, listener->user_data
-    );
-    
-    ant_conn_close(conn);
+    ant_conn_read_error(conn, (int)nread);
     return;
   }
 
   if (nread == 0) return;
 
   conn->bytes_read += (uint64_t)nread;
-  conn->buffer_len += (size_t)nread;
   ant_conn_restart_timer(conn);
 
+  if (conn->tls) {
+    rc = ant_tls_conn_input(conn->tls, buf->base, (size_t)nread);
+    if (rc != 0) ant_conn_read_error(conn, rc);
+    else ant_conn_tls_pump(conn);
+    return;
+  }
+
+  conn->buffer_len += (size_t)nread;
   if (listener->callbacks.on_read)
     listener->callbacks.on_read(conn, nread, listener->user_data);
 }
 
+static void ant_conn_free_owned(const uv_buf_t *bufs, unsigned int nbufs, unsigned int owned) {
+  for (unsigned int i = 0; i < nbufs; i++)
+    if (owned & (1u << i)) free(bufs[i].base);
+}
+
 static void ant_conn_write_cb_impl(uv_write_t *req, int status) {
   ant_conn_write_req_t *wr = (ant_conn_write_req_t *)req;
 
-  if (status >= 0 && wr->conn)
-    wr->conn->bytes_written += (uint64_t)wr->buf.len;
+  wr->conn->writes_in_flight--;
+  if (status >= 0) {
+    wr->conn->bytes_written += (uint64_t)wr->len;
+    ant_conn_tls_try_kernel(wr->conn);
+  }
   if (wr->cb) wr->cb(wr->conn, status, wr->user_data);
   
-  free(wr->buf.base);
+  ant_conn_free_owned(wr->bufs, wr->nbufs, wr->owned);
   free(wr);
 }
 
@@ -223,6 +398,7 @@ static void ant_conn_finish_close(ant_conn_t *conn) {
   if (listener->callbacks.on_conn_close)
     listener->callbacks.on_conn_close(conn, listener->user_data);
 
+  ant_tls_conn_free(conn->tls);
   free(conn->buffer);
   free(conn);
 }
@@ -318,68 +494,214 @@ static void ant_conn_connect_cb_impl(uv_connect_t *req, int status) {
   free(cr);
 }
 
-static int sockaddr_from_addrinfo(const struct addrinfo *res, int port, struct sockaddr_storage *out) {
-  if (!res || !out) return UV_EINVAL;
+static int sockaddr_from_ip_literal(const char *hostname, int port, struct sockaddr_storage *out) {
+  int rc = 0;
 
+  if (!hostname || !out) return UV_EINVAL;
   memset(out, 0, sizeof(*out));
-  if (res->ai_family == AF_INET) {
-    struct sockaddr_in sa;
-    memcpy(&sa, res->ai_addr, sizeof(sa));
-    sa.sin_port = htons((uint16_t)port);
-    memcpy(out, &sa, sizeof(sa));
-    return 0;
+
+  rc = uv_ip4_addr(hostname, port, (struct sockaddr_in *)out);
+  if (rc == 0) return 0;
+
+  rc = uv_ip6_addr(hostname, port, (struct sockaddr_in6 *)out);
+  return rc;
+}
+
+#ifndef _WIN32
+// each address gets its own socket, the first one to connect is handed to
+// the connection and the rest are closed (rfc 8305)
+typedef struct {
+  uv_tcp_t tcp;
+  uv_connect_t req;
+  ant_conn_race_t *race;
+  bool open;
+} ant_conn_attempt_t;
+
+struct ant_conn_race_s {
+  uv_timer_t timer;
+  ant_conn_t *conn;
+  ant_conn_connect_cb cb;
+  void *user_data;
+  ant_addr_list_t addrs;
+  ant_conn_attempt_t attempts[ANT_RESOLVE_MAX_ADDRS];
+  size_t next;
+  int pending;
+  int open_handles;
+  int last_status;
+  bool done;
+};
+
+static void ant_conn_race_connect_cb(uv_connect_t *req, int status);
+
+static void ant_conn_race_handle_close_cb(uv_handle_t *handle) {
+  ant_conn_race_t *race = (ant_conn_race_t *)handle->data;
+  if (--race->open_handles == 0) free(race);
+}
+
+static void ant_conn_race_close_attempt(ant_conn_attempt_t *a) {
+  if (!a->open || uv_is_closing((uv_handle_t *)&a->tcp)) return;
+  uv_close((uv_handle_t *)&a->tcp, ant_conn_race_handle_close_cb);
+}
+
+static void ant_conn_race_finish(ant_conn_race_t *race, int status) {
+  ant_conn_t *conn = race->conn;
+
+  race->done = true;
+  race->conn = NULL;
+  uv_timer_stop(&race->timer);
+  if (!uv_is_closing((uv_handle_t *)&race->timer))
+    uv_close((uv_handle_t *)&race->timer, ant_conn_race_handle_close_cb);
+  for (size_t i = 0; i < race->next; i++) ant_conn_race_close_attempt(&race->attempts[i]);
+
+  if (!conn) return;
+  conn->race = NULL;
+
+  if (status == 0) {
+    ant_conn_store_peer_addr(conn);
+    ant_conn_store_local_addr(conn);
   }
 
-  if (res->ai_family == AF_INET6) {
-    struct sockaddr_in6 sa6;
-    memcpy(&sa6, res->ai_addr, sizeof(sa6));
-    sa6.sin6_port = htons((uint16_t)port);
-    memcpy(out, &sa6, sizeof(sa6));
-    return 0;
+  if (race->cb) race->cb(conn, status, race->user_data);
+}
+
+static void ant_conn_race_timer_cb(uv_timer_t *handle);
+
+// returns false once every address has been tried
+static bool ant_conn_race_start_next(ant_conn_race_t *race) {
+  while (race->next < race->addrs.count) {
+    const struct sockaddr *addr = (const struct sockaddr *)&race->addrs.addrs[race->next];
+    ant_conn_attempt_t *a = &race->attempts[race->next++];
+    int rc = uv_tcp_init(race->timer.loop, &a->tcp);
+
+    if (rc != 0) { race->last_status = rc; continue; }
+    a->open = true;
+    a->race = race;
+    a->tcp.data = race;
+    a->req.data = a;
+    race->open_handles++;
+
+    rc = uv_tcp_connect(&a->req, &a->tcp, addr, ant_conn_race_connect_cb);
+    if (rc != 0) {
+      race->last_status = rc;
+      ant_conn_race_close_attempt(a);
+      continue;
+    }
+
+    race->pending++;
+    uv_timer_start(&race->timer, ant_conn_race_timer_cb, ANT_CONN_ATTEMPT_DELAY_MS, 0);
+    return true;
   }
-  
-  return UV_ENOENT;
+
+  return false;
 }
 
-static int sockaddr_from_ip_literal(const char *hostname, int port, struct sockaddr_storage *out) {
+static void ant_conn_race_timer_cb(uv_timer_t *handle) {
+  ant_conn_race_start_next((ant_conn_race_t *)handle->data);
+}
+
+// the winning socket is dup'd into the connection's own handle so the
+// pointers callers already hold stay valid; the copy keeps close-on-exec
+// like every socket libuv opens
+static int ant_conn_race_adopt(ant_conn_race_t *race, ant_conn_attempt_t *a) {
+  uv_os_fd_t fd;
+  int sock = -1;
+  int rc = uv_fileno((uv_handle_t *)&a->tcp, &fd);
+
+  if (rc != 0) return rc;
+  sock = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (sock < 0) return uv_translate_sys_error(errno);
+
+  rc = uv_tcp_open(&race->conn->handle.tcp, sock);
+  if (rc != 0) close(sock);
+
+  return rc;
+}
+
+static void ant_conn_race_connect_cb(uv_connect_t *req, int status) {
+  ant_conn_attempt_t *a = (ant_conn_attempt_t *)req->data;
+  ant_conn_race_t *race = a->race;
+
+  race->pending--;
+  if (race->done) return;
+
+  if (status == 0) status = ant_conn_race_adopt(race, a);
+  if (status == 0) {
+    ant_conn_race_finish(race, 0);
+    return;
+  }
+
+  race->last_status = status;
+  ant_conn_race_close_attempt(a);
+  if (ant_conn_race_start_next(race) || race->pending > 0) return;
+  ant_conn_race_finish(race, race->last_status);
+}
+
+static int ant_conn_race_start(ant_conn_t *conn, const ant_addr_list_t *addrs, ant_conn_connect_cb cb, void *user_data) {
+  ant_conn_race_t *race = calloc(1, sizeof(*race));
   int rc = 0;
 
-  if (!hostname || !out) return UV_EINVAL;
-  memset(out, 0, sizeof(*out));
+  if (!race) return UV_ENOMEM;
 
-  rc = uv_ip4_addr(hostname, port, (struct sockaddr_in *)out);
-  if (rc == 0) return 0;
+  rc = uv_timer_init(conn->handle.tcp.loop, &race->timer);
+  if (rc != 0) {
+    free(race);
+    return rc;
+  }
+
+  race->timer.data = race;
+  race->open_handles = 1;
+  race->conn = conn;
+  race->cb = cb;
+  race->user_data = user_data;
+  race->addrs = *addrs;
+  race->last_status = UV_ECONNREFUSED;
+  conn->race = race;
+
+  if (ant_conn_race_start_next(race)) return 0;
+
+  rc = race->last_status;
+  race->cb = NULL;
+  ant_conn_race_finish(race, rc);
 
-  rc = uv_ip6_addr(hostname, port, (struct sockaddr_in6 *)out);
   return rc;
 }
+#endif
 
-static void ant_conn_resolved_cb(uv_getaddrinfo_t *resolver, int status, struct addrinfo *res) {
-  ant_conn_connect_req_t *cr = resolver ? (ant_conn_connect_req_t *)resolver->data : NULL;
-  ant_conn_t *conn = cr ? cr->conn : NULL;
-  struct sockaddr_storage addr;
+static int ant_conn_connect_addrs(ant_conn_connect_req_t *cr, const ant_addr_list_t *resolved) {
+  ant_addr_list_t addrs = *resolved;
+  int rc = 0;
+
+  ant_resolve_set_port(&addrs, cr->port);
+
+#ifndef _WIN32
+  if (addrs.count > 1) {
+    ant_resolve_interleave(&addrs);
+    rc = ant_conn_race_start(cr->conn, &addrs, cr->cb, cr->user_data);
+    if (rc == 0) free(cr);
+    return rc;
+  }
+#endif
+
+  cr->connect_req.data = cr;
+  return uv_tcp_connect(&cr->connect_req, &cr->conn->handle.tcp, (const struct sockaddr *)&addrs.addrs[0], ant_conn_connect_cb_impl);
+}
+
+static void ant_conn_resolved_cb(int status, const ant_addr_list_t *addrs, void *user_data) {
+  ant_conn_connect_req_t *cr = (ant_conn_connect_req_t *)user_data;
+  ant_conn_t *conn = cr->conn;
   int rc = status;
 
-  if (conn) conn->resolving = false;
+  conn->resolving = false;
 
-  if (conn && conn->closing) {
-    if (res) uv_freeaddrinfo(res);
+  if (conn->closing) {
     free(cr);
     if (--conn->close_handles == 0) ant_conn_finish_close(conn);
     return;
   }
 
-  if (status == 0) {
-    rc = sockaddr_from_addrinfo(res, cr ? cr->port : 0, &addr);
-    if (rc == 0) {
-      cr->connect_req.data = cr;
-      rc = uv_tcp_connect(&cr->connect_req, &conn->handle.tcp, (const struct sockaddr *)&addr, ant_conn_connect_cb_impl);
-    }
-  }
-
-  if (res) uv_freeaddrinfo(res);
+  if (status == 0) rc = ant_conn_connect_addrs(cr, addrs);
   if (rc != 0) {
-    if (cr && cr->cb) cr->cb(conn, rc, cr->user_data);
+    if (cr->cb) cr->cb(conn, rc, cr->user_data);
     free(cr);
   }
 }
@@ -393,7 +715,8 @@ int ant_conn_connect_tcp(
 ) {
   ant_conn_connect_req_t *req = NULL;
   struct sockaddr_storage addr;
-  struct addrinfo hints = {0};
+  ant_addr_list_t cached;
+  uv_loop_t *loop = NULL;
   int rc = 0;
 
   if (!conn || conn->kind != ANT_CONN_KIND_TCP || !hostname || port <= 0 || port > 65535) return UV_EINVAL;
@@ -417,11 +740,17 @@ int ant_conn_connect_tcp(
     return 0;
   }
 
-  hints.ai_family = AF_UNSPEC;
-  hints.ai_socktype = SOCK_STREAM;
+  // a cached answer connects right away, a cached failure is reported synchronously
+  loop = conn->listener ? conn->listener->loop : uv_default_loop();
+  rc = ant_resolve_lookup_cached(loop, hostname, AF_UNSPEC, &cached);
+  if (rc == 0) rc = ant_conn_connect_addrs(req, &cached);
+  if (rc != UV_EAGAIN) {
+    if (rc != 0) free(req);
+    return rc;
+  }
+
   conn->resolving = true;
-  req->resolver_req.data = req;
-  rc = uv_getaddrinfo(conn->listener ? conn->listener->loop : uv_default_loop(), &req->resolver_req, ant_conn_resolved_cb, hostname, NULL, &hints);
+  rc = ant_resolve_lookup(loop, hostname, AF_UNSPEC, ant_conn_resolved_cb, req);
   if (rc != 0) {
     conn->resolving = false;
     free(req);
@@ -454,6 +783,13 @@ int ant_conn_connect_pipe(
   return rc;
 }
 
+// must run before ant_conn_start, the handshake is driven by the first reads
+int ant_conn_start_tls(ant_conn_t *conn, ant_tls_server_t *server) {
+  if (!conn || !server || conn->tls) return UV_EINVAL;
+  conn->tls = ant_tls_conn_new(server, ant_conn_stream(conn)->loop, ant_conn_tls_resume, conn);
+  return conn->tls ? 0 : UV_ENOMEM;
+}
+
 void ant_conn_start(ant_conn_t *conn) {
   if (!conn || conn->closing) return;
   conn->read_paused = false;
@@ -503,6 +839,10 @@ bool ant_conn_has_remote_addr(const ant_conn_t *conn) {
   return conn && conn->has_remote_addr;
 }
 
+bool ant_conn_is_secure(const ant_conn_t *conn) {
+  return conn && conn->tls;
+}
+
 const char *ant_conn_local_addr(const ant_conn_t *conn) {
   return conn ? conn->local_addr : NULL;
 }
@@ -552,6 +892,16 @@ void ant_conn_shutdown(ant_conn_t *conn) {
     return;
   }
 
+  // close_notify is queued ahead of the fin, uv_shutdown waits for it
+  if (conn->tls) {
+    char *out = NULL;
+    size_t len = 0;
+    if (ant_tls_conn_close_notify(conn->tls, &out, &len) == 0 && out) {
+      uv_buf_t buf = uv_buf_init(out, (unsigned int)len);
+      ant_conn_submit(conn, &buf, 1, 1u, 0, NULL, NULL);
+    }
+  }
+
   req->conn = conn;
   rc = uv_shutdown(&req->req, ant_conn_stream(conn), ant_conn_shutdown_cb);
   if (rc != 0) { free(req); ant_conn_close(conn); }
@@ -598,6 +948,16 @@ void ant_conn_close(ant_conn_t *conn) {
   conn->closing = true;
 
   conn->close_handles = 0;
+  if (conn->sendfile) {
+    uv_handle_t *poll = (uv_handle_t *)&conn->sendfile->poll;
+    if (!uv_is_closing(poll)) {
+      conn->sendfile->status = UV_ECANCELED;
+      uv_close(poll, ant_conn_sendfile_close_cb);
+    }
+    if (conn->sendfile->reading) uv_cancel((uv_req_t *)&conn->sendfile->read_req);
+    conn->close_handles++;
+  }
+
   if (!uv_is_closing((uv_handle_t *)&conn->timer)) {
     uv_timer_stop(&conn->timer);
     uv_close((uv_handle_t *)&conn->timer, ant_conn_close_cb);
@@ -609,41 +969,274 @@ void ant_conn_close(ant_conn_t *conn) {
     conn->close_handles++;
   }
 
+#ifndef _WIN32
+  if (conn->race) {
+    conn->race->cb = NULL;
+    ant_conn_race_finish(conn->race, UV_ECANCELED);
+  }
+#endif
+
   if (conn->resolving) conn->close_handles++;
   if (conn->close_handles == 0) ant_conn_finish_close(conn);
 }
 
-int ant_conn_write(ant_conn_t *conn, char *data, size_t len, ant_conn_write_cb cb, void *user_data) {
-  ant_conn_write_req_t *wr = NULL;
+// len is what the write counts towards bytes_written, the plaintext size
+// when bufs hold sealed records
+static int ant_conn_submit(
+  ant_conn_t *conn, const uv_buf_t *bufs, unsigned int nbufs,
+  unsigned int owned, size_t len, ant_conn_write_cb cb, void *user_data
+) {
+  ant_conn_write_req_t *wr = calloc(1, sizeof(*wr));
   int rc = 0;
 
-  if (!conn || conn->closing) {
-    free(data);
-    return UV_EPIPE;
-  }
-
-  wr = calloc(1, sizeof(*wr));
   if (!wr) {
-    free(data);
+    ant_conn_free_owned(bufs, nbufs, owned);
     return UV_ENOMEM;
   }
 
-  wr->buf = uv_buf_init(data, (unsigned int)len);
+  memcpy(wr->bufs, bufs, nbufs * sizeof(*bufs));
+  wr->nbufs = nbufs;
+  wr->owned = owned;
+  wr->len = len;
   wr->conn = conn;
   wr->cb = cb;
   wr->user_data = user_data;
 
   ant_conn_restart_timer(conn);
-  rc = uv_write(&wr->req, ant_conn_stream(conn), &wr->buf, 1, ant_conn_write_cb_impl);
+  rc = uv_write(&wr->req, ant_conn_stream(conn), wr->bufs, nbufs, ant_conn_write_cb_impl);
   if (rc != 0) {
-    free(wr->buf.base);
+    ant_conn_free_owned(wr->bufs, wr->nbufs, wr->owned);
     free(wr);
     return rc;
   }
 
+  conn->writes_in_flight++;
   return 0;
 }
 
+int ant_conn_writev(
+  ant_conn_t *conn, const uv_buf_t *bufs, unsigned int nbufs,
+  unsigned int owned, ant_conn_write_cb cb, void *user_data
+) {
+  char *sealed = NULL;
+  size_t sealed_len = 0;
+  size_t len = 0;
+  uv_buf_t out;
+  int rc = 0;
+
+  if (!conn || conn->closing || nbufs == 0 || nbufs > ANT_CONN_WRITEV_MAX) {
+    ant_conn_free_owned(bufs, nbufs > ANT_CONN_WRITEV_MAX ? ANT_CONN_WRITEV_MAX : nbufs, owned);
+    return (!conn || conn->closing) ? UV_EPIPE : UV_EINVAL;
+  }
+
+  for (unsigned int i = 0; i < nbufs; i++) len += bufs[i].len;
+  if (!conn->tls || ant_tls_conn_kernel_tx(conn->tls))
+    return ant_conn_submit(conn, bufs, nbufs, owned, len, cb, user_data);
+
+  // records are sealed into one buffer, the plaintext is released right away
+  rc = ant_tls_conn_seal(conn->tls, bufs, nbufs, &sealed, &sealed_len);
+  ant_conn_free_owned(bufs, nbufs, owned);
+  if (rc != 0) return rc;
+
+  out = uv_buf_init(sealed, (unsigned int)sealed_len);
+  return ant_conn_submit(conn, &out, 1, sealed ? 1u : 0u, len, cb, user_data);
+}
+
+int ant_conn_write(ant_conn_t *conn, char *data, size_t len, ant_conn_write_cb cb, void *user_data) {
+  uv_buf_t buf = uv_buf_init(data, (unsigned int)len);
+  return ant_conn_writev(conn, &buf, 1, 1u, cb, user_data);
+}
+
+#ifndef _WIN32
+// -1 with errno set to ENOSYS when the kernel cannot send this file itself
+static ssize_t ant_conn_sendfile_once(int sock, uv_file file, int64_t offset, size_t len) {
+#if defined(__linux__)
+  off_t off = (off_t)offset;
+  ssize_t n = sendfile(sock, file, &off, len);
+  if (n >= 0 || (errno != EINVAL && errno != ENOSYS)) return n;
+#elif defined(__APPLE__)
+  off_t sent = (off_t)len;
+  if (sendfile(file, sock, (off_t)offset, &sent, NULL, 0) == 0 || sent > 0) return (ssize_t)sent;
+  if (errno != ENOTSOCK && errno != ENOTSUP && errno != EOPNOTSUPP) return -1;
+#endif
+  errno = ENOSYS;
+  return -1;
+}
+
+static void ant_conn_sendfile_release(ant_conn_sendfile_t *sf) {
+  ant_conn_t *conn = sf->conn;
+  bool counted = conn->closing;
+
+  conn->sendfile = NULL;
+  close(sf->sock);
+  if (sf->cb) sf->cb(conn, sf->status, sf->user_data);
+  free(sf->chunk);
+  free(sf);
+
+  if (counted && --conn->close_handles == 0) ant_conn_finish_close(conn);
+}
+
+// a read still on the threadpool owns the buffer, the release waits for it
+static void ant_conn_sendfile_close_cb(uv_handle_t *handle) {
+  ant_conn_sendfile_t *sf = (ant_conn_sendfile_t *)handle->data;
+  sf->poll_closed = true;
+  if (!sf->reading) ant_conn_sendfile_release(sf);
+}
+
+static void ant_conn_sendfile_finish(ant_conn_sendfile_t *sf, int status) {
+  sf->status = status;
+  uv_poll_stop(&sf->poll);
+  if (!uv_is_closing((uv_handle_t *)&sf->poll))
+    uv_close((uv_handle_t *)&sf->poll, ant_conn_sendfile_close_cb);
+}
+
+static void ant_conn_sendfile_poll_cb(uv_poll_t *handle, int status, int events);
+static void ant_conn_sendfile_pump_emulated(ant_conn_sendfile_t *sf);
+
+static void ant_conn_sendfile_wait_writable(ant_conn_sendfile_t *sf) {
+  int rc = uv_poll_start(&sf->poll, UV_WRITABLE, ant_conn_sendfile_poll_cb);
+  if (rc != 0) ant_conn_sendfile_finish(sf, rc);
+}
+
+static void ant_conn_sendfile_read_cb(uv_fs_t *req) {
+  ant_conn_sendfile_t *sf = (ant_conn_sendfile_t *)req->data;
+  ssize_t n = req->result;
+
+  uv_fs_req_cleanup(req);
+  sf->reading = false;
+  if (sf->poll_closed) { ant_conn_sendfile_release(sf); return; }
+  if (uv_is_closing((uv_handle_t *)&sf->poll)) return;
+
+  if (n < 0) { ant_conn_sendfile_finish(sf, (int)n); return; }
+  if (n == 0) { ant_conn_sendfile_finish(sf, UV_EIO); return; }
+
+  sf->offset += n;
+  sf->chunk_len = (size_t)n;
+  sf->chunk_off = 0;
+  ant_conn_sendfile_pump_emulated(sf);
+}
+
+// writes what was read, then queues the next read, never both at once
+static void ant_conn_sendfile_pump_emulated(ant_conn_sendfile_t *sf) {
+  uv_buf_t buf;
+  int rc = 0;
+
+  while (sf->chunk_off < sf->chunk_len) {
+    ssize_t n = write(sf->sock, sf->chunk + sf->chunk_off, sf->chunk_len - sf->chunk_off);
+    
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) { ant_conn_sendfile_wait_writable(sf); return; }
+    if (n < 0) { ant_conn_sendfile_finish(sf, uv_translate_sys_error(errno)); return; }
+    
+    sf->chunk_off += (size_t)n;
+    sf->remaining -= (size_t)n;
+    sf->conn->bytes_written += (uint64_t)n;
+  }
+
+  ant_conn_restart_timer(sf->conn);
+  if (sf->remaining == 0) { ant_conn_sendfile_finish(sf, 0); return; }
+
+  if (!sf->chunk) sf->chunk = malloc(ANT_CONN_SENDFILE_CHUNK);
+  if (!sf->chunk) { ant_conn_sendfile_finish(sf, UV_ENOMEM); return; }
+
+  uv_poll_stop(&sf->poll);
+  buf = uv_buf_init(sf->chunk, (unsigned int)(sf->remaining < ANT_CONN_SENDFILE_CHUNK ? sf->remaining : ANT_CONN_SENDFILE_CHUNK));
+  sf->read_req.data = sf;
+  
+  rc = uv_fs_read(ant_conn_stream(sf->conn)->loop, &sf->read_req, sf->file, &buf, 1, sf->offset, ant_conn_sendfile_read_cb);
+  if (rc != 0) { ant_conn_sendfile_finish(sf, rc); return; }
+  sf->reading = true;
+}
+
+// at most one slice per loop turn so a large file does not starve other connections
+static void ant_conn_sendfile_pump(ant_conn_sendfile_t *sf) {
+  size_t budget = ANT_CONN_SENDFILE_SLICE;
+
+  if (sf->emulated) { ant_conn_sendfile_pump_emulated(sf); return; }
+
+  while (sf->remaining > 0 && budget > 0) {
+    size_t want = sf->remaining < budget ? sf->remaining : budget;
+    ssize_t n = ant_conn_sendfile_once(sf->sock, sf->file, sf->offset, want);
+
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+    if (n < 0 && errno == ENOSYS) { sf->emulated = true; ant_conn_sendfile_pump_emulated(sf); return; }
+    if (n < 0) { ant_conn_sendfile_finish(sf, uv_translate_sys_error(errno)); return; }
+    if (n == 0) { ant_conn_sendfile_finish(sf, UV_EIO); return; }
+
+    sf->offset += n;
+    sf->remaining -= (size_t)n;
+    budget -= (size_t)n < budget ? (size_t)n : budget;
+    sf->conn->bytes_written += (uint64_t)n;
+  }
+
+  ant_conn_restart_timer(sf->conn);
+  if (sf->remaining == 0) { ant_conn_sendfile_finish(sf, 0); return; }
+  ant_conn_sendfile_wait_writable(sf);
+}
+
+static void ant_conn_sendfile_poll_cb(uv_poll_t *handle, int status, int events) {
+  ant_conn_sendfile_t *sf = (ant_conn_sendfile_t *)handle->data;
+  if (status < 0) { ant_conn_sendfile_finish(sf, status); return; }
+  ant_conn_sendfile_pump(sf);
+}
+#else
+static void ant_conn_sendfile_close_cb(uv_handle_t *handle) {
+  (void)handle;
+}
+#endif
+
+// the caller must not queue other writes on the connection until cb runs
+int ant_conn_sendfile(ant_conn_t *conn, uv_file file, int64_t offset, size_t len, ant_conn_write_cb cb, void *user_data) {
+#ifdef _WIN32
+  return UV_ENOTSUP;
+#else
+  ant_conn_sendfile_t *sf = NULL;
+  uv_os_fd_t fd;
+  int rc = 0;
+
+  if (!conn || conn->closing) return UV_EPIPE;
+  if (conn->sendfile) return UV_EBUSY;
+  if (conn->tls && !ant_tls_conn_kernel_tx(conn->tls)) return UV_ENOTSUP;
+
+  rc = uv_fileno((uv_handle_t *)ant_conn_stream(conn), &fd);
+  if (rc != 0) return rc;
+
+  sf = calloc(1, sizeof(*sf));
+  if (!sf) return UV_ENOMEM;
+
+  sf->sock = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (sf->sock < 0) {
+    rc = uv_translate_sys_error(errno);
+    free(sf);
+    return rc;
+  }
+
+  rc = uv_poll_init(ant_conn_stream(conn)->loop, &sf->poll, sf->sock);
+  if (rc != 0) {
+    close(sf->sock);
+    free(sf);
+    return rc;
+  }
+
+  sf->poll.data = sf;
+  sf->conn = conn;
+  sf->cb = cb;
+  sf->user_data = user_data;
+  sf->file = file;
+  sf->offset = offset;
+  sf->remaining = len;
+  conn->sendfile = sf;
+
+  ant_conn_sendfile_pump(sf);
+  return 0;
+#endif
+}
+
+size_t ant_conn_write_queue_size(ant_conn_t *conn) {
+  return conn ? uv_stream_get_write_queue_size(ant_conn_stream(conn)) : 0;
+}
+
 uint64_t ant_conn_bytes_read(const ant_conn_t *conn) {
   return conn ? conn->bytes_read : 0;
 }
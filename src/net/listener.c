@@ -78,6 +78,11 @@ static void ant_listener_accept_cb(uv_stream_t *server_stream, int status) {
     return;
   }
 
+  if (listener->tls && ant_conn_start_tls(conn, listener->tls) != 0) {
+    ant_conn_close(conn);
+    return;
+  }
+
   if (listener->callbacks.on_accept)
     listener->callbacks.on_accept(listener, conn, listener->user_data);
 
@@ -180,6 +185,10 @@ int ant_listener_listen_pipe(
   return 0;
 }
 
+void ant_listener_set_tls(ant_listener_t *listener, ant_tls_server_t *server) {
+  if (listener) listener->tls = server;
+}
+
 void ant_listener_stop(ant_listener_t *listener, bool force) {
   ant_conn_t *conn = NULL;
   ant_conn_t *next = NULL;
@@ -0,0 +1,518 @@
+#include <compat.h> // IWYU pragma: keep
+
+#ifndef _WIN32
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include <ares.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uthash.h>
+
+#include "net/resolver.h"
+
+// getaddrinfo does not report ttls, system lookups get a fixed one
+#define RESOLVE_LOOKUP_TTL_MS   30000
+#define RESOLVE_NEGATIVE_TTL_MS 5000
+#define RESOLVE_STALE_MS        60000
+#define RESOLVE_QUERY_TTL_MAX   3600
+#define RESOLVE_CACHE_MAX       512
+#define RESOLVE_KEY_MAX         300
+
+typedef enum {
+  RESOLVE_LOOKUP = 0,
+  RESOLVE_QUERY,
+} resolve_kind_t;
+
+typedef struct resolve_waiter_s {
+  union {
+    ant_resolve_lookup_cb lookup;
+    ant_resolve_query_cb query;
+  } cb;
+  void *user_data;
+  struct resolve_waiter_s *next;
+} resolve_waiter_t;
+
+// one entry per name and family (or rrtype), holding both the cached
+// answer and the request currently refreshing it
+typedef struct resolve_entry_s {
+  char *key;
+  char *name;
+  uv_loop_t *loop;
+  resolve_kind_t kind;
+  int type;
+  int status;
+  int settling;
+  bool cached;
+  bool in_flight;
+  ant_addr_list_t list;
+  unsigned char *abuf;
+  int alen;
+  uint64_t expires_at;
+  uint64_t stale_until;
+  resolve_waiter_t *waiters;
+  resolve_waiter_t **waiters_tail;
+  UT_hash_handle hh;
+} resolve_entry_t;
+
+typedef struct resolve_poll_s {
+  uv_poll_t poll;
+  ares_socket_t fd;
+  UT_hash_handle hh;
+} resolve_poll_t;
+
+static resolve_entry_t *resolve_cache = NULL;
+static unsigned int resolve_cache_count = 0;
+static ant_resolve_stats_t resolve_stats = {0};
+
+static ares_channel_t *resolve_channel = NULL;
+static uv_loop_t *resolve_ares_loop = NULL;
+static uv_timer_t resolve_ares_timer;
+static resolve_poll_t *resolve_polls = NULL;
+static size_t resolve_ares_active = 0;
+
+static int resolve_key(resolve_kind_t kind, int type, const char *name, char *out, size_t out_len) {
+  size_t name_len = strlen(name);
+  int n = snprintf(out, out_len, "%c%d:", kind == RESOLVE_LOOKUP ? 'l' : 'q', type);
+
+  if (n < 0 || name_len == 0 || (size_t)n + name_len >= out_len) return -1;
+  for (size_t i = 0; i < name_len; i++) out[n + i] = (char)tolower((unsigned char)name[i]);
+  out[n + name_len] = '\0';
+
+  return n + (int)name_len;
+}
+
+static void resolve_entry_free(resolve_entry_t *e) {
+  free(e->key);
+  free(e->name);
+  free(e->abuf);
+  free(e);
+}
+
+// oldest settled entry goes first, entries with callers attached stay
+static void resolve_evict(void) {
+  resolve_entry_t *e = NULL, *tmp = NULL;
+
+  HASH_ITER(hh, resolve_cache, e, tmp) {
+    if (e->in_flight || e->settling || e->waiters) continue;
+    HASH_DEL(resolve_cache, e);
+    resolve_cache_count--;
+    resolve_entry_free(e);
+    return;
+  }
+}
+
+static resolve_entry_t *resolve_find(resolve_kind_t kind, int type, const char *name) {
+  resolve_entry_t *e = NULL;
+  char key[RESOLVE_KEY_MAX];
+  int len = resolve_key(kind, type, name, key, sizeof(key));
+
+  if (len < 0) return NULL;
+  HASH_FIND(hh, resolve_cache, key, (unsigned)len, e);
+
+  return e;
+}
+
+static resolve_entry_t *resolve_get(uv_loop_t *loop, resolve_kind_t kind, int type, const char *name) {
+  resolve_entry_t *e = NULL;
+  char key[RESOLVE_KEY_MAX];
+  int len = resolve_key(kind, type, name, key, sizeof(key));
+
+  if (len < 0) return NULL;
+  HASH_FIND(hh, resolve_cache, key, (unsigned)len, e);
+  if (e) return e;
+
+  if (resolve_cache_count >= RESOLVE_CACHE_MAX) resolve_evict();
+  e = calloc(1, sizeof(*e));
+  if (!e) return NULL;
+
+  e->key = strdup(key);
+  e->name = strdup(key + len - strlen(name));
+
+  if (!e->key || !e->name) {
+    resolve_entry_free(e);
+    return NULL;
+  }
+
+  e->loop = loop;
+  e->kind = kind;
+  e->type = type;
+  e->waiters_tail = &e->waiters;
+  HASH_ADD_KEYPTR(hh, resolve_cache, e->key, (unsigned)len, e);
+  resolve_cache_count++;
+
+  return e;
+}
+
+static bool resolve_add_waiter(resolve_entry_t *e, void *cb, void *user_data) {
+  resolve_waiter_t *w = calloc(1, sizeof(*w));
+  if (!w) return false;
+
+  if (e->kind == RESOLVE_LOOKUP) w->cb.lookup = (ant_resolve_lookup_cb)cb;
+  else w->cb.query = (ant_resolve_query_cb)cb;
+
+  w->user_data = user_data;
+  *e->waiters_tail = w;
+  e->waiters_tail = &w->next;
+
+  return true;
+}
+
+static void resolve_notify(resolve_entry_t *e, resolve_waiter_t *w) {
+  if (e->kind == RESOLVE_LOOKUP)
+    w->cb.lookup(e->status, e->status == 0 ? &e->list : NULL, w->user_data);
+  else w->cb.query(e->status, e->status == 0 ? e->abuf : NULL, e->status == 0 ? e->alen : 0, w->user_data);
+}
+
+// a failed refresh keeps serving the previous answer until the stale window
+// closes, only definite negative answers are remembered
+static void resolve_settle(resolve_entry_t *e, int status, bool negative, uint64_t now, uint64_t ttl_ms) {
+  resolve_waiter_t *w = NULL;
+  bool keep_stale = status != 0 && e->cached && e->status == 0 && now < e->stale_until;
+
+  if (!keep_stale) {
+    e->status = status;
+    e->cached = status == 0 || negative;
+    e->expires_at = now + (status == 0 ? ttl_ms : RESOLVE_NEGATIVE_TTL_MS);
+    e->stale_until = status == 0 ? e->expires_at + RESOLVE_STALE_MS : e->expires_at;
+  }
+
+  w = e->waiters;
+  e->waiters = NULL;
+  e->waiters_tail = &e->waiters;
+  e->settling++;
+
+  while (w) {
+    resolve_waiter_t *next = w->next;
+    resolve_notify(e, w);
+    free(w);
+    w = next;
+  }
+
+  e->settling--;
+}
+
+static void resolve_list_from_addrinfo(const struct addrinfo *res, ant_addr_list_t *out) {
+  out->count = 0;
+  for (const struct addrinfo *ai = res; ai && out->count < ANT_RESOLVE_MAX_ADDRS; ai = ai->ai_next) {
+    if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6) continue;
+    if ((size_t)ai->ai_addrlen > sizeof(out->addrs[0])) continue;
+    memset(&out->addrs[out->count], 0, sizeof(out->addrs[0]));
+    memcpy(&out->addrs[out->count], ai->ai_addr, (size_t)ai->ai_addrlen);
+    out->count++;
+  }
+}
+
+static void resolve_gai_cb(uv_getaddrinfo_t *req, int status, struct addrinfo *res) {
+  resolve_entry_t *e = (resolve_entry_t *)req->data;
+  uint64_t now = uv_now(req->loop);
+  ant_addr_list_t list;
+
+  free(req);
+  e->in_flight = false;
+
+  if (status == 0) {
+    resolve_list_from_addrinfo(res, &list);
+    if (list.count == 0) status = UV_EAI_NODATA;
+    else e->list = list;
+  }
+
+  if (res) uv_freeaddrinfo(res);
+  resolve_settle(e, status, status == UV_EAI_NONAME || status == UV_EAI_NODATA, now, RESOLVE_LOOKUP_TTL_MS);
+}
+
+static int resolve_start_lookup(resolve_entry_t *e) {
+  struct addrinfo hints = {0};
+  uv_getaddrinfo_t *req = NULL;
+  int rc = 0;
+
+  req = calloc(1, sizeof(*req));
+  if (!req) return UV_ENOMEM;
+
+  hints.ai_family = e->type;
+  hints.ai_socktype = SOCK_STREAM;
+  req->data = e;
+
+  rc = uv_getaddrinfo(e->loop, req, resolve_gai_cb, e->name, NULL, &hints);
+  if (rc != 0) {
+    free(req);
+    return rc;
+  }
+
+  e->in_flight = true;
+  return 0;
+}
+
+int ant_resolve_lookup_cached(uv_loop_t *loop, const char *host, int family, ant_addr_list_t *out) {
+  resolve_entry_t *e = NULL;
+  uint64_t now = 0;
+
+  if (!loop || !host || !out) return UV_EINVAL;
+  e = resolve_find(RESOLVE_LOOKUP, family, host);
+  if (!e || !e->cached) return UV_EAGAIN;
+
+  now = uv_now(loop);
+  if (now < e->expires_at) {
+    if (e->status == 0) *out = e->list;
+    resolve_stats.hits++;
+    return e->status;
+  }
+
+  if (e->status != 0 || now >= e->stale_until) return UV_EAGAIN;
+  if (!e->in_flight) resolve_start_lookup(e);
+  *out = e->list;
+  resolve_stats.hits++;
+
+  return 0;
+}
+
+int ant_resolve_lookup(uv_loop_t *loop, const char *host, int family, ant_resolve_lookup_cb cb, void *user_data) {
+  resolve_entry_t *e = NULL;
+  int rc = 0;
+
+  if (!loop || !host || !cb) return UV_EINVAL;
+  if (family != AF_UNSPEC && family != AF_INET && family != AF_INET6) return UV_EAI_FAMILY;
+
+  e = resolve_get(loop, RESOLVE_LOOKUP, family, host);
+  if (!e) return *host ? UV_ENOMEM : UV_EINVAL;
+  if (!resolve_add_waiter(e, (void *)cb, user_data)) return UV_ENOMEM;
+  if (e->in_flight) {
+    resolve_stats.shared++;
+    return 0;
+  }
+
+  rc = resolve_start_lookup(e);
+  if (rc == 0) {
+    resolve_stats.misses++;
+    return 0;
+  }
+
+  // only this caller was waiting, a request would be in flight otherwise
+  free(e->waiters);
+  e->waiters = NULL;
+  e->waiters_tail = &e->waiters;
+
+  return rc;
+}
+
+static void resolve_ares_timer_cb(uv_timer_t *handle);
+
+// while queries are outstanding the timer keeps the loop alive, the socket
+// polls are unref'd so idle sockets c-ares keeps open do not
+static void resolve_ares_schedule(void) {
+  struct timeval tv;
+  uint64_t ms = 0;
+
+  if (resolve_ares_active == 0 || !ares_timeout(resolve_channel, NULL, &tv)) {
+    uv_timer_stop(&resolve_ares_timer);
+    return;
+  }
+
+  ms = (uint64_t)tv.tv_sec * 1000 + ((uint64_t)tv.tv_usec + 999) / 1000;
+  uv_timer_start(&resolve_ares_timer, resolve_ares_timer_cb, ms ? ms : 1, 0);
+}
+
+static void resolve_ares_timer_cb(uv_timer_t *handle) {
+  (void)handle;
+  ares_process_fd(resolve_channel, ARES_SOCKET_BAD, ARES_SOCKET_BAD);
+  resolve_ares_schedule();
+}
+
+static void resolve_poll_close_cb(uv_handle_t *handle) {
+  free(handle->data);
+}
+
+static void resolve_poll_cb(uv_poll_t *handle, int status, int events) {
+  resolve_poll_t *p = (resolve_poll_t *)handle->data;
+  ares_socket_t fd = p->fd;
+
+  if (status < 0) events = UV_READABLE | UV_WRITABLE;
+  ares_process_fd(
+    resolve_channel,
+    (events & UV_READABLE) ? fd : ARES_SOCKET_BAD,
+    (events & UV_WRITABLE) ? fd : ARES_SOCKET_BAD
+  );
+
+  resolve_ares_schedule();
+}
+
+static void resolve_ares_sock_cb(void *data, ares_socket_t fd, int readable, int writable) {
+  resolve_poll_t *p = NULL;
+  int events = (readable ? UV_READABLE : 0) | (writable ? UV_WRITABLE : 0);
+
+  (void)data;
+  HASH_FIND(hh, resolve_polls, &fd, sizeof(fd), p);
+
+  if (!events) {
+    if (!p) return;
+    HASH_DEL(resolve_polls, p);
+    uv_close((uv_handle_t *)&p->poll, resolve_poll_close_cb);
+    return;
+  }
+
+  if (!p) {
+    p = calloc(1, sizeof(*p));
+    if (!p) return;
+    p->fd = fd;
+    if (uv_poll_init_socket(resolve_ares_loop, &p->poll, fd) != 0) {
+      free(p);
+      return;
+    }
+    p->poll.data = p;
+    uv_unref((uv_handle_t *)&p->poll);
+    HASH_ADD(hh, resolve_polls, fd, sizeof(fd), p);
+  }
+
+  uv_poll_start(&p->poll, events, resolve_poll_cb);
+}
+
+static int resolve_ares_init(uv_loop_t *loop) {
+  struct ares_options opts;
+  int rc = 0;
+
+  if (resolve_channel) return ARES_SUCCESS;
+  rc = ares_library_init(ARES_LIB_INIT_ALL);
+  if (rc != ARES_SUCCESS) return rc;
+
+  // answers are cached here alongside system lookups, not inside c-ares
+  memset(&opts, 0, sizeof(opts));
+  opts.sock_state_cb = resolve_ares_sock_cb;
+  opts.qcache_max_ttl = 0;
+
+  rc = ares_init_options(&resolve_channel, &opts, ARES_OPT_SOCK_STATE_CB | ARES_OPT_QUERY_CACHE);
+  if (rc != ARES_SUCCESS) {
+    resolve_channel = NULL;
+    ares_library_cleanup();
+    return rc;
+  }
+
+  resolve_ares_loop = loop;
+  uv_timer_init(loop, &resolve_ares_timer);
+
+  return ARES_SUCCESS;
+}
+
+static uint64_t resolve_answer_ttl_ms(const unsigned char *abuf, int alen) {
+  ares_dns_record_t *rec = NULL;
+  unsigned int ttl = RESOLVE_QUERY_TTL_MAX;
+  size_t count = 0;
+
+  if (ares_dns_parse(abuf, (size_t)alen, 0, &rec) != ARES_SUCCESS) return 0;
+  count = ares_dns_record_rr_cnt(rec, ARES_SECTION_ANSWER);
+
+  for (size_t i = 0; i < count; i++) {
+    unsigned int rr_ttl = ares_dns_rr_get_ttl(ares_dns_record_rr_get_const(rec, ARES_SECTION_ANSWER, i));
+    if (rr_ttl < ttl) ttl = rr_ttl;
+  }
+
+  ares_dns_record_destroy(rec);
+  return (uint64_t)ttl * 1000;
+}
+
+static void resolve_query_cb(void *arg, int status, int timeouts, unsigned char *abuf, int alen) {
+  resolve_entry_t *e = (resolve_entry_t *)arg;
+  uint64_t ttl_ms = 0;
+  unsigned char *copy = NULL;
+
+  (void)timeouts;
+  resolve_ares_active--;
+  e->in_flight = false;
+
+  if (status == ARES_SUCCESS) {
+    copy = abuf && alen > 0 ? malloc((size_t)alen) : NULL;
+    if (!copy) status = abuf && alen > 0 ? ARES_ENOMEM : ARES_EBADRESP;
+    else {
+      memcpy(copy, abuf, (size_t)alen);
+      free(e->abuf);
+      e->abuf = copy;
+      e->alen = alen;
+      ttl_ms = resolve_answer_ttl_ms(abuf, alen);
+    }
+  }
+
+  resolve_settle(
+    e, status, status == ARES_ENOTFOUND || status == ARES_ENODATA,
+    uv_now(resolve_ares_loop), ttl_ms
+  );
+}
+
+static void resolve_start_query(resolve_entry_t *e) {
+  e->in_flight = true;
+  resolve_ares_active++;
+  ares_query(resolve_channel, e->name, ARES_CLASS_IN, e->type, resolve_query_cb, e);
+  resolve_ares_schedule();
+}
+
+int ant_resolve_query(uv_loop_t *loop, const char *name, int rrtype, ant_resolve_query_cb cb, void *user_data) {
+  resolve_entry_t *e = NULL;
+  resolve_waiter_t w = {0};
+  uint64_t now = 0;
+  int rc = 0;
+
+  if (!loop || !name || !cb) return ARES_EFORMERR;
+  rc = resolve_ares_init(loop);
+  if (rc != ARES_SUCCESS) return rc;
+
+  e = resolve_get(loop, RESOLVE_QUERY, rrtype, name);
+  if (!e) return *name ? ARES_ENOMEM : ARES_EBADNAME;
+
+  now = uv_now(loop);
+  if (e->cached && (now < e->expires_at || (e->status == 0 && now < e->stale_until))) {
+    if (now >= e->expires_at && !e->in_flight) resolve_start_query(e);
+    w.cb.query = cb;
+    w.user_data = user_data;
+    e->settling++;
+    resolve_stats.hits++;
+    resolve_notify(e, &w);
+    e->settling--;
+    return ARES_SUCCESS;
+  }
+
+  if (!resolve_add_waiter(e, (void *)cb, user_data)) return ARES_ENOMEM;
+  if (e->in_flight) resolve_stats.shared++;
+  else {
+    resolve_stats.misses++;
+    resolve_start_query(e);
+  }
+
+  return ARES_SUCCESS;
+}
+
+ant_resolve_stats_t ant_resolve_stats(void) {
+  ant_resolve_stats_t stats = resolve_stats;
+  stats.entries = resolve_cache_count;
+  return stats;
+}
+
+void ant_resolve_set_port(ant_addr_list_t *list, int port) {
+  for (size_t i = 0; list && i < list->count; i++) {
+    struct sockaddr_storage *ss = &list->addrs[i];
+    if (ss->ss_family == AF_INET) ((struct sockaddr_in *)ss)->sin_port = htons((uint16_t)port);
+    else if (ss->ss_family == AF_INET6) ((struct sockaddr_in6 *)ss)->sin6_port = htons((uint16_t)port);
+  }
+}
+
+void ant_resolve_interleave(ant_addr_list_t *list) {
+  struct sockaddr_storage primary[ANT_RESOLVE_MAX_ADDRS];
+  struct sockaddr_storage secondary[ANT_RESOLVE_MAX_ADDRS];
+  size_t np = 0, ns = 0, out = 0;
+
+  if (!list || list->count < 3) return;
+
+  for (size_t i = 0; i < list->count; i++) {
+    if (list->addrs[i].ss_family == list->addrs[0].ss_family) primary[np++] = list->addrs[i];
+    else secondary[ns++] = list->addrs[i];
+  }
+
+  for (size_t i = 0; i < np || i < ns; i++) {
+    if (i < np) list->addrs[out++] = primary[i];
+    if (i < ns) list->addrs[out++] = secondary[i];
+  }
+}
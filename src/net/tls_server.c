@@ -0,0 +1,684 @@
+#include <compat.h> // IWYU pragma: keep
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/hkdf.h>
+#include <openssl/mem.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#endif
+
+#include "net/tls_server.h"
+
+#define TLS_SERVER_SESSION_CACHE_SIZE 4096
+#define TLS_SERVER_SESSION_TIMEOUT    300
+#define TLS_SERVER_SECRET_MAX         EVP_MAX_MD_SIZE
+
+struct ant_tls_server_s {
+  SSL_CTX *ctx;
+  EVP_PKEY *key;
+  unsigned refs;
+  bool kernel_tx;
+};
+
+// conn is cleared when the connection goes away first, the done callback
+// then frees the op on its own
+typedef struct {
+  uv_work_t work;
+  ant_tls_conn_t *conn;
+  EVP_PKEY *key;
+  uint8_t *in;
+  uint8_t *out;
+  size_t in_len;
+  size_t out_len;
+  size_t max_out;
+  uint16_t alg;
+  bool ok;
+  bool done;
+} tls_key_op_t;
+
+struct ant_tls_conn_s {
+  ant_tls_server_t *server;
+  uv_loop_t *loop;
+  SSL *ssl;
+  BIO *rbio;
+  BIO *wbio;
+  tls_key_op_t *op;
+  ant_tls_resume_cb resume;
+  void *user_data;
+  uint8_t tx_secret[TLS_SERVER_SECRET_MAX];
+  size_t tx_secret_len;
+  bool established;
+  bool kernel_tx;
+  bool kernel_tried;
+};
+
+static void tls_key_op_free(tls_key_op_t *op) {
+  EVP_PKEY_free(op->key);
+  free(op->in);
+  free(op->out);
+  free(op);
+}
+
+static void tls_key_op_work(uv_work_t *req) {
+  tls_key_op_t *op = (tls_key_op_t *)req->data;
+  EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+  EVP_PKEY_CTX *pctx = NULL;
+
+  op->out_len = op->max_out;
+  op->ok = md_ctx
+    && EVP_DigestSignInit(md_ctx, &pctx, SSL_get_signature_algorithm_digest(op->alg), NULL, op->key)
+    && (!SSL_is_signature_algorithm_rsa_pss(op->alg)
+      || (EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING)
+      && EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1)))
+    && EVP_DigestSign(md_ctx, op->out, &op->out_len, op->in, op->in_len);
+
+  EVP_MD_CTX_free(md_ctx);
+  ERR_clear_error();
+}
+
+static void tls_key_op_done(uv_work_t *req, int status) {
+  tls_key_op_t *op = (tls_key_op_t *)req->data;
+  ant_tls_conn_t *tls = op->conn;
+
+  op->done = true;
+  if (status != 0) op->ok = false;
+  if (!tls) { tls_key_op_free(op); return; }
+  if (tls->resume) tls->resume(tls->user_data);
+}
+
+// signing is the expensive half of a full handshake, it runs on the
+// threadpool and the handshake resumes from complete() once it is done
+static enum ssl_private_key_result_t tls_key_sign(
+  SSL *ssl, uint8_t *out, size_t *out_len, size_t max_out,
+  uint16_t alg, const uint8_t *in, size_t in_len
+) {
+  ant_tls_conn_t *tls = (ant_tls_conn_t *)SSL_get_app_data(ssl);
+  tls_key_op_t *op = NULL;
+
+  (void)out;
+  (void)out_len;
+
+  if (!tls || tls->op) return ssl_private_key_failure;
+  op = calloc(1, sizeof(*op));
+  if (!op) return ssl_private_key_failure;
+
+  op->in = malloc(in_len ? in_len : 1);
+  op->out = malloc(max_out ? max_out : 1);
+  if (!op->in || !op->out) {
+    tls_key_op_free(op);
+    return ssl_private_key_failure;
+  }
+
+  memcpy(op->in, in, in_len);
+  op->in_len = in_len;
+  op->max_out = max_out;
+  op->alg = alg;
+  op->conn = tls;
+  op->key = tls->server->key;
+  op->work.data = op;
+  EVP_PKEY_up_ref(op->key);
+
+  if (uv_queue_work(tls->loop, &op->work, tls_key_op_work, tls_key_op_done) != 0) {
+    tls_key_op_free(op);
+    return ssl_private_key_failure;
+  }
+
+  tls->op = op;
+  return ssl_private_key_retry;
+}
+
+// only ecdhe suites are enabled, so the key is never used for decryption
+static enum ssl_private_key_result_t tls_key_decrypt(
+  SSL *ssl, uint8_t *out, size_t *out_len, size_t max_out,
+  const uint8_t *in, size_t in_len
+) {
+  (void)ssl; (void)out; (void)out_len;
+  (void)max_out; (void)in; (void)in_len;
+  return ssl_private_key_failure;
+}
+
+static enum ssl_private_key_result_t tls_key_complete(
+  SSL *ssl, uint8_t *out, size_t *out_len, size_t max_out
+) {
+  ant_tls_conn_t *tls = (ant_tls_conn_t *)SSL_get_app_data(ssl);
+  tls_key_op_t *op = tls ? tls->op : NULL;
+  enum ssl_private_key_result_t result = ssl_private_key_failure;
+
+  if (!op) return ssl_private_key_failure;
+  if (!op->done) return ssl_private_key_retry;
+
+  tls->op = NULL;
+  if (op->ok && op->out_len <= max_out) {
+    memcpy(out, op->out, op->out_len);
+    *out_len = op->out_len;
+    result = ssl_private_key_success;
+  }
+
+  tls_key_op_free(op);
+  return result;
+}
+
+static const SSL_PRIVATE_KEY_METHOD tls_key_method = {
+  tls_key_sign,
+  tls_key_decrypt,
+  tls_key_complete,
+};
+
+// the server only speaks http/1.1, advertising it keeps h2 clients from
+// assuming anything else
+static int tls_alpn_select(
+  SSL *ssl, const uint8_t **out, uint8_t *out_len,
+  const uint8_t *in, unsigned int in_len, void *arg
+) {
+  static const uint8_t protos[] = "\x08http/1.1";
+  uint8_t *selected = NULL;
+
+  (void)ssl;
+  (void)arg;
+
+  if (SSL_select_next_proto(&selected, out_len, in, in_len, protos, sizeof(protos) - 1) != OPENSSL_NPN_NEGOTIATED)
+    return SSL_TLSEXT_ERR_NOACK;
+
+  *out = selected;
+  return SSL_TLSEXT_ERR_OK;
+}
+
+#if defined(__linux__)
+static int tls_hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// tls 1.3 traffic secrets are not exported any other way, the keylog line is
+// the only place the kernel tx keys can be derived from
+static void tls_keylog(const SSL *ssl, const char *line) {
+  static const char prefix[] = "SERVER_TRAFFIC_SECRET_0 ";
+  ant_tls_conn_t *tls = (ant_tls_conn_t *)SSL_get_app_data(ssl);
+  const char *hex = NULL;
+  size_t hex_len = 0;
+
+  if (!tls || strncmp(line, prefix, sizeof(prefix) - 1) != 0) return;
+  hex = strrchr(line, ' ');
+  if (!hex) return;
+
+  hex++;
+  hex_len = strlen(hex);
+  if (hex_len % 2 != 0 || hex_len / 2 > sizeof(tls->tx_secret)) return;
+
+  for (size_t i = 0; i < hex_len / 2; i++) {
+    int hi = tls_hex_value(hex[i * 2]);
+    int lo = tls_hex_value(hex[i * 2 + 1]);
+    if (hi < 0 || lo < 0) { tls->tx_secret_len = 0; return; }
+    tls->tx_secret[i] = (uint8_t)(hi << 4 | lo);
+  }
+
+  tls->tx_secret_len = hex_len / 2;
+}
+#endif
+
+static int tls_load_chain(SSL_CTX *ctx, const ant_tls_server_options_t *opts, X509 **leaf_out) {
+  BIO *bio = BIO_new_mem_buf(opts->cert, (ossl_ssize_t)opts->cert_len);
+  X509 *leaf = NULL;
+  X509 *extra = NULL;
+
+  if (!bio) return 0;
+  leaf = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+  if (!leaf || !SSL_CTX_use_certificate(ctx, leaf)) {
+    X509_free(leaf);
+    BIO_free(bio);
+    return 0;
+  }
+
+  while ((extra = PEM_read_bio_X509(bio, NULL, NULL, NULL))) {
+    if (!SSL_CTX_add0_chain_cert(ctx, extra)) {
+      X509_free(extra);
+      X509_free(leaf);
+      BIO_free(bio);
+      return 0;
+    }
+  }
+
+  ERR_clear_error();
+  BIO_free(bio);
+  *leaf_out = leaf;
+
+  return 1;
+}
+
+static EVP_PKEY *tls_load_key(const ant_tls_server_options_t *opts) {
+  BIO *bio = BIO_new_mem_buf(opts->key, (ossl_ssize_t)opts->key_len);
+  EVP_PKEY *key = NULL;
+
+  if (!bio) return NULL;
+  key = PEM_read_bio_PrivateKey(bio, NULL, NULL, (void *)opts->passphrase);
+  BIO_free(bio);
+
+  return key;
+}
+
+int ant_tls_server_new(
+  const ant_tls_server_options_t *opts,
+  ant_tls_server_t **out,
+  const char **error
+) {
+  static const uint8_t session_id_context[] = "ant";
+  ant_tls_server_t *server = NULL;
+  X509 *leaf = NULL;
+
+  *out = NULL;
+  *error = NULL;
+
+  if (!opts || !opts->cert || !opts->key) {
+    *error = "tls requires both cert and key";
+    return UV_EINVAL;
+  }
+
+  server = calloc(1, sizeof(*server));
+  if (!server) { *error = "tls context could not be allocated"; return UV_ENOMEM; }
+
+  server->refs = 1;
+  server->kernel_tx = opts->kernel_tx;
+  server->ctx = SSL_CTX_new(TLS_method());
+
+  if (!server->ctx
+    || !SSL_CTX_set_min_proto_version(server->ctx, TLS1_2_VERSION)
+    || !SSL_CTX_set_strict_cipher_list(server->ctx, "ECDHE+AESGCM:ECDHE+CHACHA20")) {
+    *error = "tls context could not be created";
+    goto fail;
+  }
+
+  if (!tls_load_chain(server->ctx, opts, &leaf)) {
+    *error = "tls.cert must contain a PEM certificate";
+    goto fail;
+  }
+
+  server->key = tls_load_key(opts);
+  if (!server->key) {
+    *error = opts->passphrase
+      ? "tls.key could not be decrypted with tls.passphrase"
+      : "tls.key must contain an unencrypted PEM private key";
+    goto fail;
+  }
+
+  if (!X509_check_private_key(leaf, server->key)) {
+    *error = "tls.key does not match tls.cert";
+    goto fail;
+  }
+
+  SSL_CTX_set_private_key_method(server->ctx, &tls_key_method);
+  SSL_CTX_set_alpn_select_cb(server->ctx, tls_alpn_select, NULL);
+
+  // tickets are encrypted with keys boringssl rotates on its own, the cache
+  // covers tls 1.2 clients that resume by session id
+  SSL_CTX_set_session_cache_mode(server->ctx, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size(server->ctx, TLS_SERVER_SESSION_CACHE_SIZE);
+  SSL_CTX_set_timeout(server->ctx, opts->session_timeout_secs ? opts->session_timeout_secs : TLS_SERVER_SESSION_TIMEOUT);
+  SSL_CTX_set_session_id_context(server->ctx, session_id_context, sizeof(session_id_context) - 1);
+  if (!opts->session_tickets) SSL_CTX_set_options(server->ctx, SSL_OP_NO_TICKET);
+
+#if defined(__linux__)
+  if (server->kernel_tx) SSL_CTX_set_keylog_callback(server->ctx, tls_keylog);
+#else
+  server->kernel_tx = false;
+#endif
+
+  X509_free(leaf);
+  ERR_clear_error();
+  *out = server;
+
+  return 0;
+
+fail:
+  X509_free(leaf);
+  ERR_clear_error();
+  ant_tls_server_release(server);
+  return UV_EINVAL;
+}
+
+void ant_tls_server_retain(ant_tls_server_t *server) {
+  if (server) server->refs++;
+}
+
+void ant_tls_server_release(ant_tls_server_t *server) {
+  if (!server || --server->refs > 0) return;
+  SSL_CTX_free(server->ctx);
+  EVP_PKEY_free(server->key);
+  free(server);
+}
+
+ant_tls_conn_t *ant_tls_conn_new(
+  ant_tls_server_t *server,
+  uv_loop_t *loop,
+  ant_tls_resume_cb resume,
+  void *user_data
+) {
+  ant_tls_conn_t *tls = NULL;
+
+  if (!server || !loop) return NULL;
+  tls = calloc(1, sizeof(*tls));
+  if (!tls) return NULL;
+
+  tls->ssl = SSL_new(server->ctx);
+  tls->rbio = BIO_new(BIO_s_mem());
+  tls->wbio = BIO_new(BIO_s_mem());
+
+  if (!tls->ssl || !tls->rbio || !tls->wbio) {
+    BIO_free(tls->rbio);
+    BIO_free(tls->wbio);
+    SSL_free(tls->ssl);
+    free(tls);
+    ERR_clear_error();
+    return NULL;
+  }
+
+  BIO_set_mem_eof_return(tls->rbio, -1);
+  SSL_set_bio(tls->ssl, tls->rbio, tls->wbio);
+  SSL_set_accept_state(tls->ssl);
+  SSL_set_app_data(tls->ssl, tls);
+
+  tls->server = server;
+  tls->loop = loop;
+  tls->resume = resume;
+  tls->user_data = user_data;
+  ant_tls_server_retain(server);
+
+  return tls;
+}
+
+void ant_tls_conn_free(ant_tls_conn_t *tls) {
+  if (!tls) return;
+
+  if (tls->op) {
+    tls->op->conn = NULL;
+    if (tls->op->done) tls_key_op_free(tls->op);
+  }
+
+  SSL_free(tls->ssl);
+  OPENSSL_cleanse(tls->tx_secret, sizeof(tls->tx_secret));
+  ant_tls_server_release(tls->server);
+  free(tls);
+}
+
+int ant_tls_conn_input(ant_tls_conn_t *tls, const char *data, size_t len) {
+  while (len > 0) {
+    int chunk = len > INT_MAX ? INT_MAX : (int)len;
+    if (BIO_write(tls->rbio, data, chunk) != chunk) return UV_ENOMEM;
+    data += chunk;
+    len -= (size_t)chunk;
+  }
+  return 0;
+}
+
+static int tls_status(ant_tls_conn_t *tls, int rc) {
+  int err = SSL_get_error(tls->ssl, rc);
+  ERR_clear_error();
+
+  switch (err) {
+    case SSL_ERROR_WANT_READ:
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION: return UV_EAGAIN;
+    case SSL_ERROR_ZERO_RETURN: return UV_EOF;
+    default: return UV_EPROTO;
+  }
+}
+
+int ant_tls_conn_handshake(ant_tls_conn_t *tls) {
+  int rc = 0;
+
+  if (tls->established) return 0;
+  rc = SSL_do_handshake(tls->ssl);
+  if (rc == 1) {
+    tls->established = true;
+    return 0;
+  }
+
+  rc = tls_status(tls, rc);
+  return rc == UV_EOF ? UV_EPROTO : rc;
+}
+
+int ant_tls_conn_read(ant_tls_conn_t *tls, char *out, size_t cap, size_t *nread) {
+  int rc = SSL_read(tls->ssl, out, cap > INT_MAX ? INT_MAX : (int)cap);
+
+  *nread = 0;
+  if (rc > 0) {
+    *nread = (size_t)rc;
+    return 0;
+  }
+
+  return tls_status(tls, rc);
+}
+
+// with the kernel owning the write side any record boringssl still wants
+// to send (key update, alert) would go out with a stale sequence number
+int ant_tls_conn_take_output(ant_tls_conn_t *tls, char **out, size_t *len) {
+  size_t pending = BIO_pending(tls->wbio);
+  char *data = NULL;
+
+  *out = NULL;
+  *len = 0;
+
+  if (pending == 0) return 0;
+  if (tls->kernel_tx) return UV_EPROTO;
+
+  data = malloc(pending);
+  if (!data) return UV_ENOMEM;
+
+  if (BIO_read(tls->wbio, data, (int)pending) != (int)pending) {
+    free(data);
+    return UV_EIO;
+  }
+
+  *out = data;
+  *len = pending;
+
+  return 0;
+}
+
+int ant_tls_conn_seal(
+  ant_tls_conn_t *tls,
+  const uv_buf_t *bufs,
+  unsigned int nbufs,
+  char **out,
+  size_t *len
+) {
+  *out = NULL;
+  *len = 0;
+
+  if (!tls->established) return UV_ENOTCONN;
+  if (tls->kernel_tx) return UV_EINVAL;
+
+  for (unsigned int i = 0; i < nbufs; i++) {
+    if (bufs[i].len == 0) continue;
+    if (SSL_write(tls->ssl, bufs[i].base, (int)bufs[i].len) != (int)bufs[i].len) {
+      ERR_clear_error();
+      return UV_EPROTO;
+    }
+  }
+
+  return ant_tls_conn_take_output(tls, out, len);
+}
+
+int ant_tls_conn_close_notify(ant_tls_conn_t *tls, char **out, size_t *len) {
+  *out = NULL;
+  *len = 0;
+
+  if (!tls->established || tls->kernel_tx) return 0;
+  SSL_shutdown(tls->ssl);
+  ERR_clear_error();
+
+  return ant_tls_conn_take_output(tls, out, len);
+}
+
+bool ant_tls_conn_kernel_tx(const ant_tls_conn_t *tls) {
+  return tls && tls->kernel_tx;
+}
+
+bool ant_tls_conn_wants_kernel_tx(const ant_tls_conn_t *tls) {
+  return tls
+    && tls->server->kernel_tx
+    && tls->established
+    && !tls->kernel_tried
+    && BIO_pending(tls->wbio) == 0;
+}
+
+#if defined(__linux__) && defined(TLS_TX)
+static bool tls_expand_label(
+  const EVP_MD *md, const uint8_t *secret, size_t secret_len,
+  const char *label, uint8_t *out, size_t out_len
+) {
+  uint8_t info[2 + 1 + 6 + 8 + 1];
+  size_t label_len = strlen(label);
+  size_t n = 0;
+
+  if (label_len > 8) return false;
+  info[n++] = (uint8_t)(out_len >> 8);
+  info[n++] = (uint8_t)out_len;
+  info[n++] = (uint8_t)(6 + label_len);
+  memcpy(info + n, "tls13 ", 6);
+  n += 6;
+  memcpy(info + n, label, label_len);
+  n += label_len;
+  info[n++] = 0;
+
+  return HKDF_expand(out, out_len, md, secret, secret_len, info, n) == 1;
+}
+
+// key is the server write key, iv is the 4 byte salt followed by the
+// 8 byte explicit nonce the kernel counts up from
+static int tls_export_tx_keys(ant_tls_conn_t *tls, size_t key_len, uint8_t *key, uint8_t *iv) {
+  const SSL_CIPHER *cipher = SSL_get_current_cipher(tls->ssl);
+  int version = SSL_version(tls->ssl);
+
+#ifdef TLS_1_3_VERSION
+  if (version == TLS1_3_VERSION) {
+    const EVP_MD *md = SSL_CIPHER_get_handshake_digest(cipher);
+    if (!md || tls->tx_secret_len == 0) return UV_ENOTSUP;
+    if (!tls_expand_label(md, tls->tx_secret, tls->tx_secret_len, "key", key, key_len)
+      || !tls_expand_label(md, tls->tx_secret, tls->tx_secret_len, "iv", iv, 12)) return UV_EPROTO;
+    return 0;
+  }
+#endif
+
+  if (version == TLS1_2_VERSION) {
+    uint8_t block[2 * 32 + 8];
+    uint64_t seq = SSL_get_write_sequence(tls->ssl);
+    size_t block_len = SSL_get_key_block_len(tls->ssl);
+
+    if (block_len != 2 * key_len + 8 || !SSL_generate_key_block(tls->ssl, block, block_len)) return UV_ENOTSUP;
+    memcpy(key, block + key_len, key_len);
+    memcpy(iv, block + 2 * key_len + 4, 4);
+    for (int i = 0; i < 8; i++) iv[4 + i] = (uint8_t)(seq >> (56 - 8 * i));
+
+    OPENSSL_cleanse(block, sizeof(block));
+    return 0;
+  }
+
+  return UV_ENOTSUP;
+}
+
+static int tls_install_tx(int fd, int version, size_t key_len, const uint8_t *key, const uint8_t *iv, const uint8_t *seq) {
+  int rc = 0;
+  uint16_t kernel_version = TLS_1_2_VERSION;
+
+#ifdef TLS_1_3_VERSION
+  if (version == TLS1_3_VERSION) kernel_version = TLS_1_3_VERSION;
+#endif
+
+  if (key_len == 16) {
+    struct tls12_crypto_info_aes_gcm_128 info;
+    memset(&info, 0, sizeof(info));
+    info.info.version = kernel_version;
+    info.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+    memcpy(info.key, key, sizeof(info.key));
+    memcpy(info.salt, iv, sizeof(info.salt));
+    memcpy(info.iv, iv + 4, sizeof(info.iv));
+    memcpy(info.rec_seq, seq, sizeof(info.rec_seq));
+    rc = setsockopt(fd, SOL_TLS, TLS_TX, &info, sizeof(info));
+    OPENSSL_cleanse(&info, sizeof(info));
+  } else {
+    struct tls12_crypto_info_aes_gcm_256 info;
+    memset(&info, 0, sizeof(info));
+    info.info.version = kernel_version;
+    info.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+    memcpy(info.key, key, sizeof(info.key));
+    memcpy(info.salt, iv, sizeof(info.salt));
+    memcpy(info.iv, iv + 4, sizeof(info.iv));
+    memcpy(info.rec_seq, seq, sizeof(info.rec_seq));
+    rc = setsockopt(fd, SOL_TLS, TLS_TX, &info, sizeof(info));
+    OPENSSL_cleanse(&info, sizeof(info));
+  }
+
+  return rc == 0 ? 0 : uv_translate_sys_error(errno);
+}
+#endif
+
+// the read side stays in userspace, boringssl keeps decrypting records and
+// the kernel only encrypts what the server writes
+int ant_tls_conn_enable_kernel_tx(ant_tls_conn_t *tls, int fd) {
+#if defined(__linux__) && defined(TLS_TX)
+  const SSL_CIPHER *cipher = NULL;
+  uint64_t write_seq = 0;
+  uint8_t key[32];
+  uint8_t iv[12];
+  uint8_t seq[8];
+  size_t key_len = 0;
+  int rc = 0;
+
+  if (!ant_tls_conn_wants_kernel_tx(tls)) return UV_EINVAL;
+  tls->kernel_tried = true;
+
+  cipher = SSL_get_current_cipher(tls->ssl);
+  switch (cipher ? SSL_CIPHER_get_cipher_nid(cipher) : NID_undef) {
+    case NID_aes_128_gcm: key_len = 16; break;
+    case NID_aes_256_gcm: key_len = 32; break;
+    default: return UV_ENOTSUP;
+  }
+
+  rc = tls_export_tx_keys(tls, key_len, key, iv);
+  OPENSSL_cleanse(tls->tx_secret, sizeof(tls->tx_secret));
+  tls->tx_secret_len = 0;
+  if (rc != 0) goto done;
+
+  write_seq = SSL_get_write_sequence(tls->ssl);
+  for (int i = 0; i < 8; i++) seq[i] = (uint8_t)(write_seq >> (56 - 8 * i));
+
+  if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) != 0) {
+    rc = uv_translate_sys_error(errno);
+    goto done;
+  }
+
+  rc = tls_install_tx(fd, SSL_version(tls->ssl), key_len, key, iv, seq);
+  if (rc == 0) tls->kernel_tx = true;
+
+done:
+  OPENSSL_cleanse(key, sizeof(key));
+  OPENSSL_cleanse(iv, sizeof(iv));
+  return rc;
+#else
+  (void)fd;
+  if (tls) tls->kernel_tried = true;
+  return UV_ENOTSUP;
+#endif
+}
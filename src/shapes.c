@@ -335,7 +335,7 @@ ant_shape_t *ant_shape_new_with_inobj_limit(uint8_t inobj_limit) {
 }
 
 ant_shape_t *ant_shape_new(void) {
-  return ant_shape_new_with_inobj_limit((uint8_t)ANT_INOBJ_MAX_SLOTS);
+  return ant_shape_new_with_inobj_limit((uint8_t)ANT_INOBJ_DEFAULT_SLOTS);
 }
 
 ant_shape_t *ant_shape_clone(const ant_shape_t *shape) {
@@ -455,7 +455,7 @@ bool ant_gc_shapes_sweep(void) {
 }
 
 uint8_t ant_shape_get_inobj_limit(const ant_shape_t *shape) {
-  if (!shape) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  if (!shape) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
   return shape_clamp_inobj_limit(shape->inobj_limit);
 }
 
@@ -1,6 +1,8 @@
 #include "silver/ast.h"
 #include "silver/lexer.h"
 #include "silver/directives.h"
+#include "silver/preparse.h"
+#include "silver/vm.h"
 
 #include "escape.h"
 #include "debug.h"
@@ -60,6 +62,12 @@ typedef struct {
   ant_t *js;
   sv_lexer_t lx;
   bool no_in;
+  bool lazy;
+  bool eager_children;
+  int fn_depth;
+  int class_depth;
+  int with_depth;
+  uint32_t paren_off;
 } sv_parser_t;
 
 #define P            sv_parser_t *p
@@ -98,13 +106,13 @@ static sv_ast_t *parse_postfix(P);
 static sv_ast_t *parse_call(P);
 static sv_ast_t *parse_primary(P);
 static sv_ast_t *parse_block(P, bool directive_ctx);
-static sv_ast_t *parse_func(P);
+static sv_ast_t *parse_func(P, bool deferrable);
 static sv_ast_t *parse_class(P);
 static sv_ast_t *parse_object(P);
 static sv_ast_t *parse_array(P);
 static sv_ast_t *parse_import_stmt(P);
 static sv_ast_t *parse_export_stmt(P);
-static sv_ast_t *parse_arrow_body(P);
+static sv_ast_t *parse_arrow_body(P, uint32_t fn_off);
 static sv_ast_t *parse_binding_pattern(P);
 
 #define SV_SYNC_ERR() ((void)sv_lexer_set_error_site(&p->lx))
@@ -345,9 +353,17 @@ static sv_ast_t *parse_member_suffix(P, sv_ast_t *left, uint8_t la) {
   return NULL;
 }
 
-static sv_ast_t *parse_arrow_body(P) {
-  if (NEXT() == TOK_LBRACE) return parse_block(p, true);
-  return parse_assign(p);
+// mirrors compile_function_body: a parenthesized function compiles its own
+// children eagerly, so nothing directly inside one is worth skimming
+static sv_ast_t *parse_arrow_body(P, uint32_t fn_off) {
+  bool outer_eager = p->eager_children;
+  p->eager_children = fn_off == p->paren_off;
+  p->fn_depth++;
+
+  sv_ast_t *body = NEXT() == TOK_LBRACE ? parse_block(p, true) : parse_assign(p);
+  p->fn_depth--;
+  p->eager_children = outer_eager;
+  return body;
 }
 
 static inline uint32_t node_src_end(P, sv_ast_t *node) {
@@ -500,7 +516,7 @@ static sv_ast_t *try_parse_async_arrow(P) {
         NEXT(); CONSUME();
         sv_ast_t *fn = mk(N_FUNC);
         fn->flags = FN_ARROW | FN_ASYNC;
-        fn->body = parse_arrow_body(p);
+        fn->body = parse_arrow_body(p, async_off);
         fn->src_off = async_off;
         fn->src_end = node_src_end(p, fn->body);
         return fn;
@@ -515,7 +531,7 @@ static sv_ast_t *try_parse_async_arrow(P) {
       sv_ast_t *fn = mk(N_FUNC);
       fn->flags = FN_ARROW | FN_ASYNC;
       push_arrow_params_from_expr(fn, expr);
-      fn->body = parse_arrow_body(p);
+      fn->body = parse_arrow_body(p, async_off);
       fn->src_off = async_off;
       fn->src_end = node_src_end(p, fn->body);
       return fn;
@@ -534,7 +550,7 @@ static sv_ast_t *try_parse_async_arrow(P) {
       sv_ast_t *fn = mk(N_FUNC);
       fn->flags = FN_ARROW | FN_ASYNC;
       sv_ast_list_push(&fn->args, id);
-      fn->body = parse_arrow_body(p);
+      fn->body = parse_arrow_body(p, async_off);
       fn->src_off = async_off;
       fn->src_end = node_src_end(p, fn->body);
       return fn;
@@ -637,9 +653,12 @@ static sv_ast_t *parse_primary(P) {
       return n;
     }
     bool outer_no_in = p->no_in;
+    uint32_t outer_paren_off = p->paren_off;
     p->no_in = false;
+    p->paren_off = (uint32_t)TOFF;
     sv_ast_t *expr = parse_paren_expr(p);
     p->no_in = outer_no_in;
+    p->paren_off = outer_paren_off;
     expect(p, TOK_RPAREN);
     expr->flags |= FN_PAREN;
     if (expr->type != N_FUNC && expr->type != N_CLASS) expr->src_off = paren_off;
@@ -649,7 +668,7 @@ static sv_ast_t *parse_primary(P) {
 
   l_array:  return parse_array(p);
   l_object: return parse_object(p);
-  l_func:   { CONSUME(); return parse_func(p); }
+  l_func:   { CONSUME(); return parse_func(p, true); }
 
   l_class: {
     uint32_t class_off = (uint32_t)TOFF;
@@ -665,7 +684,10 @@ static sv_ast_t *parse_primary(P) {
     bool has_line_term = lookahead_crosses_line_terminator(p);
     if (!has_line_term && LA() == TOK_FUNC) {
       NEXT(); CONSUME();
-      sv_ast_t *fn = parse_func(p);
+      uint32_t outer_paren_off = p->paren_off;
+      if (async_off == p->paren_off) p->paren_off = (uint32_t)TOFF;
+      sv_ast_t *fn = parse_func(p, true);
+      p->paren_off = outer_paren_off;
       fn->flags |= FN_ASYNC;
       fn->src_off = async_off;
       return fn;
@@ -998,7 +1020,7 @@ static sv_ast_t *parse_object(P) {
         CONSUME();
       }
 
-      prop->right = parse_func(p);
+      prop->right = parse_func(p, false);
       prop->right->flags |= FN_GENERATOR | FN_METHOD;
       prop->right->src_off = prop->src_off;
       sv_ast_list_push(&n->args, prop);
@@ -1034,7 +1056,7 @@ static sv_ast_t *parse_object(P) {
           CONSUME();
         }
 
-        prop->right = parse_func(p);
+        prop->right = parse_func(p, false);
         if (!validate_accessor_params(p, prop->right, prop->flags)) return n;
         prop->right->flags |= FN_METHOD;
         prop->right->src_off = prop->src_off;
@@ -1076,7 +1098,7 @@ static sv_ast_t *parse_object(P) {
           CONSUME();
         }
 
-        prop->right = parse_func(p);
+        prop->right = parse_func(p, false);
         prop->right->flags |= FN_ASYNC | FN_METHOD;
         if (prop->flags & FN_GENERATOR)
           prop->right->flags |= FN_GENERATOR;
@@ -1114,7 +1136,7 @@ static sv_ast_t *parse_object(P) {
       }
       prop->right = parse_assign(p);
     } else if (TOK == TOK_LPAREN) {
-      prop->right = parse_func(p);
+      prop->right = parse_func(p, false);
       prop->right->flags |= FN_METHOD;
       prop->right->src_off = prop->src_off;
     } else {
@@ -1350,7 +1372,7 @@ static sv_ast_t *parse_assign(P) {
       SV_MKERR_TYPED(JS, JS_ERR_SYNTAX, "Malformed arrow function parameter list");
       return mk(N_EMPTY);
     }
-    fn->body = parse_arrow_body(p);
+    fn->body = parse_arrow_body(p, fn->src_off);
     fn->src_end = node_src_end(p, fn->body);
     return fn;
   }
@@ -1523,8 +1545,73 @@ static bool ast_references_new_target(const sv_ast_t *node) {
   return ast_references_new_target_impl(node, false);
 }
 
-static sv_ast_t *parse_func(P) {
+// skims a function body that compile_function_body will defer: the block
+// keeps the directive prologue and one identifier per free name, and the
+// full body is only parsed once the closure is first created. returns NULL
+// with the lexer back at the opening brace when the skim gives up
+static sv_ast_t *parse_preparsed_body(P, sv_ast_t *fn, const sv_lexer_state_t *params) {
+  sv_lexer_state_t body_state;
+  sv_lexer_save_state(&p->lx, &body_state);
+  
+  bool saved_strict = p->lx.strict;
+  bool saved_thrown_exists = JS->thrown_exists;
+  ant_value_t saved_thrown_value = JS->thrown_value;
+  ant_value_t saved_thrown_stack = JS->thrown_stack;
+
+  sv_preparse_t pp;
+  sv_lexer_restore_state(&p->lx, params);
+  sv_preparse_init(&pp, &p->lx, !!(fn->flags & FN_GENERATOR));
+
+  sv_ast_t *block = NULL;
+  if (!sv_preparse_params(&pp)) goto fail;
+
+  block = mk(N_BLOCK);
+  CONSUME();
+
+  while (NEXT() == TOK_STRING) {
+    sv_lexer_state_t stmt_state;
+    sv_lexer_save_state(&p->lx, &stmt_state);
+    sv_ast_t *stmt = parse_stmt(p);
+    if (JS->thrown_exists) goto fail;
+    if (!stmt || stmt->type != N_STRING) {
+      sv_lexer_restore_state(&p->lx, &stmt_state);
+      break;
+    }
+    sv_ast_list_push(&block->args, stmt);
+    if (sv_ast_is_use_strict(JS, stmt)) p->lx.strict = true;
+  }
+
+  if (!sv_preparse_body(&pp) || JS->thrown_exists) goto fail;
+  block->src_end = (uint32_t)(TOFF + TLEN);
+  if (block->src_end - fn->src_off < SV_LAZY_MIN_SOURCE_BYTES) goto fail;
+
+  for (int i = 0; i < pp.ref_count; i++)
+    sv_ast_list_push(&block->args, mk_ident(pp.refs[i].str, pp.refs[i].len));
+  
+  block->flags |= FN_PREPARSED;
+  if (pp.uses_arguments) fn->flags |= FN_USES_ARGS;
+  if (pp.uses_new_target) fn->flags |= FN_USES_NEW_TARGET;
+  
+  p->lx.strict = saved_strict;
+  sv_preparse_free(&pp);
+  return block;
+
+fail:
+  sv_preparse_free(&pp);
+  sv_lexer_restore_state(&p->lx, &body_state);
+  p->lx.strict = saved_strict;
+  JS->thrown_exists = saved_thrown_exists;
+  JS->thrown_value = saved_thrown_value;
+  JS->thrown_stack = saved_thrown_stack;
+  return NULL;
+}
+
+static sv_ast_t *parse_func(P, bool deferrable) {
   sv_ast_t *fn = mk(N_FUNC);
+  bool paren = fn->src_off == p->paren_off;
+  bool skim =
+    deferrable && !paren && p->lazy && p->fn_depth > 0 &&
+    !p->eager_children && p->class_depth == 0 && p->with_depth == 0;
 
   if (NEXT() == TOK_MUL) {
     CONSUME();
@@ -1537,6 +1624,10 @@ static sv_ast_t *parse_func(P) {
     CONSUME();
   }
 
+  sv_lexer_state_t params;
+  NEXT();
+  sv_lexer_save_state(&p->lx, &params);
+
   expect(p, TOK_LPAREN);
   while (NEXT() != TOK_RPAREN && TOK != TOK_EOF) {
     if (TOK == TOK_REST) {
@@ -1562,8 +1653,20 @@ static sv_ast_t *parse_func(P) {
   }
   expect(p, TOK_RPAREN);
 
-  fn->body = parse_block(p, true);
+  bool outer_eager = p->eager_children;
+  p->eager_children = paren;
+  p->fn_depth++;
+
+  fn->body = NULL;
+  if (skim && !JS->thrown_exists && NEXT() == TOK_LBRACE)
+    fn->body = parse_preparsed_body(p, fn, &params);
+  if (!fn->body) fn->body = parse_block(p, true);
+  
+  p->fn_depth--;
+  p->eager_children = outer_eager;
+
   fn->src_end = (uint32_t)(TOFF + TLEN);
+  if (fn->body->flags & FN_PREPARSED) return fn;
   if (!(fn->flags & FN_ARROW) && ast_references_arguments(fn->body))
     fn->flags |= FN_USES_ARGS;
   if (!(fn->flags & FN_ARROW) && ast_references_new_target(fn->body))
@@ -1571,7 +1674,7 @@ static sv_ast_t *parse_func(P) {
   return fn;
 }
 
-static sv_ast_t *parse_class(P) {
+static sv_ast_t *parse_class_def(P) {
   sv_ast_t *cls = mk(N_CLASS);
 
   if (is_ident_like_tok(NEXT()) &&
@@ -1671,7 +1774,7 @@ static sv_ast_t *parse_class(P) {
     if (NEXT() == TOK_LPAREN) {
       bool saved_strict = p->lx.strict;
       p->lx.strict = true;
-      method->right = parse_func(p);
+      method->right = parse_func(p, false);
       p->lx.strict = saved_strict;
       if (!validate_accessor_params(p, method->right, method->flags)) return cls;
       method->right->flags |= (flags & (FN_ASYNC | FN_GENERATOR)) | FN_METHOD | FN_CLASS_BODY;
@@ -1692,6 +1795,15 @@ static sv_ast_t *parse_class(P) {
   return cls;
 }
 
+// functions nested in a class see its private names and field initializers,
+// which the compiler never defers, so the class is parsed in full
+static sv_ast_t *parse_class(P) {
+  p->class_depth++;
+  sv_ast_t *cls = parse_class_def(p);
+  p->class_depth--;
+  return cls;
+}
+
 static sv_ast_t *parse_block(P, bool directive_ctx) {
   expect(p, TOK_LBRACE);
   sv_ast_t *block = mk(N_BLOCK);
@@ -1893,7 +2005,7 @@ static sv_ast_t *parse_export_stmt(P) {
       uint32_t async_off = (uint32_t)TOFF;
       CONSUME();
       NEXT(); CONSUME();
-      decl->left = parse_func(p);
+      decl->left = parse_func(p, true);
       decl->left->flags |= FN_ASYNC;
       decl->left->src_off = async_off;
       if (NEXT() == TOK_SEMICOLON) CONSUME();
@@ -1901,7 +2013,7 @@ static sv_ast_t *parse_export_stmt(P) {
     }
     if (TOK == TOK_FUNC) {
       CONSUME();
-      decl->left = parse_func(p);
+      decl->left = parse_func(p, true);
       if (NEXT() == TOK_SEMICOLON) CONSUME();
       return decl;
     }
@@ -1925,7 +2037,7 @@ static sv_ast_t *parse_export_stmt(P) {
     uint32_t async_off = (uint32_t)TOFF;
     CONSUME();
     NEXT(); CONSUME();
-    decl->left = parse_func(p);
+    decl->left = parse_func(p, true);
     decl->left->flags |= FN_ASYNC;
     decl->left->src_off = async_off;
     if (!decl->left->str || decl->left->len == 0)
@@ -1936,7 +2048,7 @@ static sv_ast_t *parse_export_stmt(P) {
   if (TOK == TOK_FUNC) {
     decl->flags |= EX_DECL;
     CONSUME();
-    decl->left = parse_func(p);
+    decl->left = parse_func(p, true);
     if (!decl->left->str || decl->left->len == 0)
       SV_MKERR_TYPED(JS, JS_ERR_SYNTAX, "exported function declarations require a name");
     return decl;
@@ -2366,13 +2478,15 @@ static sv_ast_t *parse_stmt(P) {
     expect(p, TOK_LPAREN);
     n->left = parse_expr(p);
     expect(p, TOK_RPAREN);
+    p->with_depth++;
     n->body = parse_stmt(p);
+    p->with_depth--;
     return n;
   }
 
   l_func: {
     CONSUME();
-    return parse_func(p);
+    return parse_func(p, true);
   }
 
   l_class: {
@@ -2390,7 +2504,7 @@ static sv_ast_t *parse_stmt(P) {
     if (la == TOK_FUNC && !lookahead_crosses_line_terminator(p)) {
       CONSUME();
       NEXT(); CONSUME();
-      sv_ast_t *fn = parse_func(p);
+      sv_ast_t *fn = parse_func(p, true);
       fn->flags |= FN_ASYNC;
       fn->src_off = async_off;
       return fn;
@@ -2430,12 +2544,12 @@ static sv_ast_t *parse_stmt(P) {
   }
 }
 
-sv_ast_t *sv_parse(ant_t *js, const char *code, ant_offset_t clen, bool strict){
+static sv_ast_t *parse_program(ant_t *js, const char *code, ant_offset_t clen, bool strict, bool lazy) {
   if (sv_parse_trace_unlikely) {
     fprintf(stderr, "[parse] start len=%u strict=%d\n", (unsigned)clen, strict ? 1 : 0);
   }
 
-  sv_parser_t parser = { .js = js };
+  sv_parser_t parser = { .js = js, .lazy = lazy, .paren_off = UINT32_MAX };
   sv_parser_t *p = &parser;
   sv_lexer_init(&p->lx, js, code, clen, strict);
 
@@ -2462,3 +2576,28 @@ sv_ast_t *sv_parse(ant_t *js, const char *code, ant_offset_t clen, bool strict){
 
   return program;
 }
+
+sv_ast_t *sv_parse(ant_t *js, const char *code, ant_offset_t clen, bool strict) {
+  return parse_program(js, code, clen, strict, false);
+}
+
+// for code that is compiled and run as a whole; function bodies the compiler
+// will defer are skimmed instead of parsed
+sv_ast_t *sv_parse_lazy(ant_t *js, const char *code, ant_offset_t clen, bool strict) {
+  return parse_program(js, code, clen, strict, sv_lazy_functions);
+}
+
+sv_ast_t *sv_parse_function_at(
+  ant_t *js, const char *code, ant_offset_t clen,
+  ant_offset_t off, bool strict, bool lazy
+) {
+  sv_parser_t parser = { .js = js, .lazy = lazy, .paren_off = UINT32_MAX };
+  sv_parser_t *p = &parser;
+  sv_lexer_init(&p->lx, js, code, clen, strict);
+  POS = off;
+
+  sv_ast_t *fn = parse_primary(p);
+  if (js->thrown_exists || !fn || fn->type != N_FUNC) return NULL;
+  
+  return fn;
+}
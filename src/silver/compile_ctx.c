@@ -114,6 +114,7 @@ sv_line_table_t *sv_compile_ctx_build_line_table(const char *source, ant_offset_
   int cap = (int)(source_len / 32) + 64;
   lt->offsets = malloc((size_t)cap * sizeof(uint32_t));
   lt->count = 0;
+  lt->retained = false;
   lt->offsets[lt->count++] = 0;
 
   for (ant_offset_t i = 0; i < source_len; i++) {
@@ -129,7 +130,7 @@ sv_line_table_t *sv_compile_ctx_build_line_table(const char *source, ant_offset_
 }
 
 void sv_compile_ctx_free_line_table(sv_line_table_t *lt) {
-  if (!lt) return;
+  if (!lt || lt->retained) return;
   free(lt->offsets);
   free(lt);
 }
@@ -3,6 +3,7 @@
 #include "silver/engine.h"
 #include "silver/compiler.h"
 #include "silver/directives.h"
+#include "silver/preparse.h"
 
 #include "internal.h"
 #include "debug.h"
@@ -6519,6 +6520,239 @@ static bool sv_func_compute_curried_step(sv_func_t *func) {
   return child->is_fusable_leaf;
 }
 
+typedef struct {
+  uint8_t head;
+  uint8_t next;
+  uint8_t fused;
+} sv_superinstruction_t;
+
+static const sv_superinstruction_t sv_superinstructions[] = {
+#define OP_FUSED(name, head, next) { OP_##head, OP_##next, OP_##name },
+#include "silver/opcode.h"
+};
+
+static void sv_func_fuse_superinstructions(sv_func_t *func) {
+  if (sv_profile_opcodes || !func->code || func->code_len <= 0) return;
+
+  int count = 0;
+  for (int pc = 0; pc < func->code_len; count++) {
+    int size = sv_op_size[func->code[pc]];
+    if (size <= 0) return;
+    pc += size;
+  }
+  if (count < 2) return;
+
+  int *starts = malloc((size_t)count * sizeof(int));
+  if (!starts) return;
+
+  for (int pc = 0, i = 0; i < count; i++) {
+    starts[i] = pc;
+    pc += sv_op_size[func->code[pc]];
+  }
+
+  // back to front, so a head sees its successor already fused and can chain
+  for (int i = count - 2; i >= 0; i--) {
+    uint8_t *ip = func->code + starts[i];
+    uint8_t next = func->code[starts[i + 1]];
+    for (size_t k = 0; k < sizeof(sv_superinstructions) / sizeof(sv_superinstructions[0]); k++) {
+      const sv_superinstruction_t *si = &sv_superinstructions[k];
+      if (si->head != *ip || si->next != next) continue;
+      *ip = si->fused;
+      break;
+    }
+  }
+
+  free(starts);
+}
+
+static const char *code_arena_strndup(const char *str, uint32_t len) {
+  if (!str) return NULL;
+  char *out = code_arena_bump(len + 1);
+  memcpy(out, str, len);
+  out[len] = '\0';
+  return out;
+}
+
+static void func_debug_init(sv_func_t *func, sv_compiler_t *enclosing, sv_ast_t *node) {
+  if (enclosing->source && enclosing->source_len > 0) {
+    func->debug->source = enclosing->source;
+    func->debug->source_len = (int)enclosing->source_len;
+    func->debug->source_start = (int)node->src_off;
+    func->debug->source_end   = (node->src_end > node->src_off)
+      ? (int)node->src_end : func->debug->source_len;
+  }
+
+  func->debug->filename = enclosing->filename ? enclosing->filename : enclosing->js->filename;
+  func->debug->source_line = (int)node->line;
+
+  if (node->str && node->len > 0)
+    func->debug->name = code_arena_strndup(node->str, node->len);
+  else if (enclosing->inferred_name && enclosing->inferred_name_len > 0)
+    func->debug->name = code_arena_strndup(enclosing->inferred_name, enclosing->inferred_name_len);
+}
+
+static sv_lazy_stats_t lazy_stats;
+
+sv_lazy_stats_t sv_lazy_stats(void) {
+  return lazy_stats;
+}
+
+static bool lazy_root_allows(const sv_compiler_t *c) {
+  for (; c; c = c->enclosing) {
+    if (c->with_depth > 0 || c->inherits_eval_env) return false;
+    if (!c->enclosing) return c->allow_lazy;
+  }
+  return false;
+}
+
+static bool lazy_function_candidate(sv_compiler_t *enclosing, const sv_ast_t *node) {
+  if (!sv_lazy_functions || node->type != N_FUNC) return false;
+  if (node->flags & (
+    FN_ARROW | FN_METHOD | FN_GETTER | FN_SETTER | FN_STATIC | FN_COMPUTED |
+    FN_PAREN | FN_CLASS_BODY | FN_CLASS_CTOR | FN_DERIVED_CTOR
+  )) return false;
+
+  if (!node->body || node->body->type != N_BLOCK) return false;
+  if (!(node->body->flags & FN_PREPARSED)) return false;
+  if (node->src_end <= node->src_off) return false;
+  if (node->src_end - node->src_off < SV_LAZY_MIN_SOURCE_BYTES) return false;
+
+  if (!enclosing->enclosing || !enclosing->enclosing->enclosing) return false;
+  if (enclosing->eager_children || enclosing->private_scope) return false;
+  if (enclosing->field_init_count > 0) return false;
+  if (!enclosing->source || !enclosing->line_table) return false;
+
+  return lazy_root_allows(enclosing);
+}
+
+static sv_binding_meta_t lazy_copy_binding(const sv_binding_meta_t *src) {
+  sv_binding_meta_t out = {
+    .import_kind = src->import_kind,
+    .import_name = code_arena_strndup(src->import_name, src->import_name_len),
+    .import_name_len = src->import_name_len,
+  };
+
+  sv_export_name_t **tail = &out.exports;
+  for (const sv_export_name_t *e = src->exports; e; e = e->next) {
+    sv_export_name_t *copy = code_arena_bump(sizeof(*copy));
+    copy->name = code_arena_strndup(e->name, e->len);
+    copy->len = e->len;
+    copy->next = NULL;
+    *tail = copy;
+    tail = &copy->next;
+  }
+
+  return out;
+}
+
+// resolving the free names adds upvalues all the way out; when the stub is
+// abandoned those must not leak into the eager compile
+static int *lazy_upvalue_marks(sv_compiler_t *comp) {
+  int depth = 0;
+  for (sv_compiler_t *c = comp; c; c = c->enclosing) depth++;
+
+  int *marks = malloc((size_t)depth * sizeof(int));
+  if (!marks) return NULL;
+
+  int i = 0;
+  for (sv_compiler_t *c = comp; c; c = c->enclosing) marks[i++] = c->upvalue_count;
+  return marks;
+}
+
+static void lazy_upvalue_rollback(sv_compiler_t *comp, int *marks) {
+  int i = 0;
+  for (sv_compiler_t *c = comp; c; c = c->enclosing) c->upvalue_count = marks[i++];
+  free(marks);
+}
+
+static sv_func_t *compile_lazy_stub(
+  sv_compiler_t *comp, sv_compiler_t *enclosing, sv_ast_t *node
+) {
+  // the preparsed block holds the directive prologue followed by one
+  // identifier per name the body reads from outside itself
+  const sv_ast_list_t *names = &node->body->args;
+  int first = 0;
+  while (first < names->count && names->items[first]->type == N_STRING) first++;
+
+  int *marks = lazy_upvalue_marks(comp);
+  if (!marks) return NULL;
+
+  for (int i = first; i < names->count; i++)
+    resolve_upvalue(comp, names->items[i]->str, names->items[i]->len);
+
+  sv_lazy_capture_t *captures = NULL;
+  if (comp->upvalue_count > 0) {
+    captures = code_arena_bump((size_t)comp->upvalue_count * sizeof(*captures));
+    memset(captures, 0, (size_t)comp->upvalue_count * sizeof(*captures));
+  }
+
+  for (int i = first; i < names->count; i++) {
+    const sv_ast_t *ident = names->items[i];
+    int upval = resolve_upvalue(comp, ident->str, ident->len);
+    if (upval < 0) continue;
+    
+    sv_lazy_capture_t *cap = &captures[upval];
+    if (cap->name) {
+      if (cap->len == ident->len && memcmp(cap->name, ident->str, ident->len) == 0) continue;
+      lazy_upvalue_rollback(comp, marks);
+      return NULL;
+    }
+    
+    cap->name = code_arena_strndup(ident->str, ident->len);
+    cap->len = ident->len;
+    cap->is_const = comp->upval_descs[upval].is_const;
+    cap->binding = lazy_copy_binding(&comp->upval_bindings[upval]);
+  }
+  
+  for (int i = 0; i < comp->upvalue_count; i++) if (!captures[i].name) {
+    lazy_upvalue_rollback(comp, marks);
+    return NULL;
+  }
+  free(marks);
+
+  sv_func_t *func = code_arena_bump(sizeof(sv_func_t));
+  memset(func, 0, sizeof(sv_func_t));
+  func->debug = code_arena_bump(sizeof(sv_func_debug_t));
+  memset(func->debug, 0, sizeof(sv_func_debug_t));
+
+  if (comp->upvalue_count > 0) {
+    func->upval_descs = code_arena_bump(
+      (size_t)comp->upvalue_count * sizeof(sv_upval_desc_t));
+    memcpy(func->upval_descs, comp->upval_descs,
+      (size_t)comp->upvalue_count * sizeof(sv_upval_desc_t));
+    func->upvalue_count = comp->upvalue_count;
+  }
+
+  func_debug_init(func, enclosing, node);
+  func->param_count = (uint16_t)comp->param_count;
+  func->function_length = function_length_from_params(node);
+  func->is_strict = comp->is_strict;
+  func->is_async = !!(node->flags & FN_ASYNC);
+  func->is_generator = !!(node->flags & FN_GENERATOR);
+
+  sv_lazy_func_t *lazy = code_arena_bump(sizeof(sv_lazy_func_t));
+  *lazy = (sv_lazy_func_t){
+    .source = enclosing->source,
+    .filename = func->debug->filename,
+    .line_table = enclosing->line_table,
+    .captures = captures,
+    .source_len = enclosing->source_len,
+    .src_off = node->src_off,
+    .src_end = node->src_end,
+    .capture_count = comp->upvalue_count,
+    .is_strict = enclosing->is_strict,
+    .in_module = has_module_import_binding(enclosing),
+  };
+
+  enclosing->line_table->retained = true;
+  func->lazy = lazy;
+  
+  lazy_stats.deferred++;
+  lazy_stats.deferred_bytes += node->src_end - node->src_off;
+  
+  return func;
+}
+
 sv_func_t *compile_function_body(
   sv_compiler_t *enclosing,
   sv_ast_t *node,
@@ -6526,6 +6760,7 @@ sv_func_t *compile_function_body(
 ) {
   sv_compiler_t comp;
   sv_compile_ctx_init_child(&comp, enclosing, node, mode);
+  comp.eager_children = !!(node->flags & FN_PAREN);
 
   bool has_own_use_strict = false;
   bool has_non_simple_params = false;
@@ -6547,6 +6782,31 @@ sv_func_t *compile_function_body(
   }
 
   if (has_own_use_strict) comp.is_strict = true;
+  if (lazy_function_candidate(enclosing, node)) {
+    sv_func_t *stub = compile_lazy_stub(&comp, enclosing, node);
+    if (stub) {
+      sv_compile_ctx_cleanup(&comp);
+      return stub;
+    }
+  }
+
+  // the parser skimmed a body the compiler ended up keeping eager
+  if (node->body && (node->body->flags & FN_PREPARSED)) {
+    sv_ast_t *full = sv_parse_function_at(
+      comp.js, enclosing->source, enclosing->source_len,
+      (ant_offset_t)node->src_off, enclosing->is_strict, true
+    );
+    if (!full || full->src_end != node->src_end) {
+      if (!comp.js->thrown_exists) js_mkerr_typed(
+        comp.js, JS_ERR_INTERNAL | JS_ERR_NO_STACK,
+        "preparsed function source does not match its node");
+      sv_compile_ctx_cleanup(&comp);
+      return NULL;
+    }
+    full->flags |= node->flags & ~(FN_USES_ARGS | FN_USES_NEW_TARGET);
+    node = full;
+  }
+
   for (int i = 0; i < node->args.count; i++) {
     sv_ast_t *p = node->args.items[i];
     if (p->type == N_IDENT) {
@@ -6879,14 +7139,7 @@ sv_func_t *compile_function_body(
     func->debug->srcpos_count = comp.srcpos_count;
   }
 
-  if (enclosing->source && enclosing->source_len > 0) {
-    func->debug->source = enclosing->source;
-    func->debug->source_len = (int)enclosing->source_len;
-    func->debug->source_start = (int)node->src_off;
-    func->debug->source_end   = (node->src_end > node->src_off)
-      ? (int)node->src_end : func->debug->source_len;
-  }
-
+  func_debug_init(func, enclosing, node);
   func->max_locals = max_locals;
   func->max_stack = max_locals + 64;
   sv_func_finalize_type_data(func, &comp, max_locals);
@@ -6903,20 +7156,6 @@ sv_func_t *compile_function_body(
   func->is_derived_ctor = !!(node->flags & FN_DERIVED_CTOR);
   func->is_static = !!(node->flags & FN_STATIC);
   func->is_tla = comp.is_tla;
-  func->debug->filename = enclosing->filename ? enclosing->filename : enclosing->js->filename;
-  func->debug->source_line = (int)node->line;
-  
-  if (node->str && node->len > 0) {
-    char *name = code_arena_bump(node->len + 1);
-    memcpy(name, node->str, node->len);
-    name[node->len] = '\0';
-    func->debug->name = name;
-  } else if (enclosing->inferred_name && enclosing->inferred_name_len > 0) {
-    char *name = code_arena_bump(enclosing->inferred_name_len + 1);
-    memcpy(name, enclosing->inferred_name, enclosing->inferred_name_len);
-    name[enclosing->inferred_name_len] = '\0';
-    func->debug->name = name;
-  }
 
   if (func->is_async || func->is_tla) {
   const uint8_t *ip = func->code;
@@ -6934,14 +7173,95 @@ sv_func_t *compile_function_body(
 
   func->is_fusable_leaf = sv_func_compute_fusable_leaf(func);
   func->is_curried_step = sv_func_compute_curried_step(func);
+  sv_func_fuse_superinstructions(func);
 
   sv_compile_ctx_cleanup(&comp);
   return func;
 }
 
+bool sv_func_compile_lazy(ant_t *js, sv_func_t *func) {
+  sv_lazy_func_t *lazy = func->lazy;
+  if (!lazy) return true;
+
+  code_arena_mark_t parse_mark = parse_arena_mark();
+  sv_ast_t *node = sv_parse_function_at(
+    js, lazy->source, lazy->source_len,
+    (ant_offset_t)lazy->src_off, lazy->is_strict, true
+  );
+
+  if (!node || node->src_end != lazy->src_end) {
+    parse_arena_rewind(parse_mark);
+    if (!js->thrown_exists) js_mkerr_typed(
+      js, JS_ERR_INTERNAL | JS_ERR_NO_STACK,
+      "lazy function source does not match its stub");
+    return false;
+  }
+
+  sv_compiler_t root;
+  sv_compile_ctx_init_root(
+    &root, js, lazy->filename,
+    lazy->source, lazy->source_len,
+    lazy->in_module ? SV_COMPILE_MODULE : SV_COMPILE_SCRIPT,
+    lazy->is_strict, lazy->line_table
+  );
+  root.allow_lazy = true;
+
+  sv_compiler_t scope;
+  sv_compile_ctx_init_child(&scope, &root, NULL, SV_COMPILE_SCRIPT);
+  scope.is_strict = lazy->is_strict;
+  
+  for (int i = 0; i < lazy->capture_count; i++) {
+    const sv_lazy_capture_t *cap = &lazy->captures[i];
+    int local = add_local(&scope, cap->name, cap->len, cap->is_const, 0);
+    scope.locals[local].binding = cap->binding;
+  }
+
+  sv_func_t *compiled = compile_function_body(&scope, node, SV_COMPILE_SCRIPT);
+  sv_compile_ctx_cleanup(&scope);
+  parse_arena_rewind(parse_mark);
+
+  if (js->thrown_exists || !compiled) return false;
+  if (compiled->upvalue_count > func->upvalue_count) {
+    js_mkerr_typed(js, JS_ERR_INTERNAL | JS_ERR_NO_STACK,
+      "lazy function captured %d bindings, expected at most %d",
+      compiled->upvalue_count, func->upvalue_count);
+    return false;
+  }
+
+  // the stub captured every name its body mentions, the body only resolved
+  // the ones it really reads; scope local i stands for stub upvalue i, so
+  // the compiled layout maps straight back onto the parent's slots and no
+  // closure has been built from the stub yet
+  for (int i = 0; i < compiled->upvalue_count; i++) {
+    sv_upval_desc_t *desc = &compiled->upval_descs[i];
+    if (!desc->is_local || desc->index >= func->upvalue_count) {
+      js_mkerr_typed(js, JS_ERR_INTERNAL | JS_ERR_NO_STACK,
+        "lazy function captured a binding outside its stub");
+      return false;
+    }
+    *desc = func->upval_descs[desc->index];
+  }
+
+  // parents and constants point at the stub, so the compiled body moves into it
+  compiled->parent = func->parent;
+  compiled->gc_epoch = func->gc_epoch;
+  compiled->debug->source_line = func->debug->source_line;
+  if (!compiled->debug->name) compiled->debug->name = func->debug->name;
+  *func = *compiled;
+  for (int i = 0; i < func->child_func_count; i++)
+    func->child_funcs[i]->parent = func;
+
+  lazy_stats.compiled++;
+  lazy_stats.compiled_bytes += lazy->src_end - lazy->src_off;
+  
+  return true;
+}
+
 const char *const sv_op_names[OP__COUNT] = {
 #define OP_DEF(name, size, n_pop, n_push, f) [OP_##name] = #name,
 #include "silver/opcode.h"
+#define OP_FUSED(name, head, next) [OP_##name] = #name,
+#include "silver/opcode.h"
 };
 
 enum {
@@ -6970,7 +7290,7 @@ void sv_disasm(ant_t *js, sv_func_t *func, const char *label) {
     uint8_t op = func->code[pc];
     const char *name = (op < OP__COUNT) ? sv_op_names[op] : "???";
     uint8_t size = (op < OP__COUNT) ? sv_op_size[op] : 1;
-    uint8_t fmt = (op < OP__COUNT) ? sv_op_fmts[op] : SVF_none;
+    uint8_t fmt = (op < OP__COUNT) ? sv_op_fmts[sv_op_base((sv_op_t)op)] : SVF_none;
 
     uint32_t line, col;
     if (sv_lookup_srcpos(func, pc, &line, &col))
@@ -7166,13 +7486,16 @@ sv_func_t *sv_compile(ant_t *js, sv_ast_t *program, sv_compile_mode_t mode, cons
   top_fn.body->args = program->args;
 
   sv_compiler_t root;
+  const char *pinned = pin_source_text(source, source_len);
   sv_compile_ctx_init_root(
     &root, js, js->filename,
-    pin_source_text(source, source_len),
-    source_len, mode,
+    pinned, source_len, mode,
     (program->flags & FN_PARSE_STRICT) != 0,  NULL
   );
   
+  root.allow_lazy = pinned != source &&
+    (mode == SV_COMPILE_SCRIPT || mode == SV_COMPILE_MODULE);
+  
   root.line_table = sv_compile_ctx_build_line_table(root.source, source_len);
   sv_func_t *func = compile_function_body(&root, &top_fn, mode);
   sv_compile_ctx_free_line_table(root.line_table);
@@ -7273,7 +7596,7 @@ sv_func_t *sv_compile_function_with_params(
 
   bool parse_strict = sv_vm_is_strict(js->vm);
   code_arena_mark_t parse_mark = parse_arena_mark();
-  sv_ast_t *program = sv_parse(js, body, (ant_offset_t)body_len, parse_strict);
+  sv_ast_t *program = sv_parse_lazy(js, body, (ant_offset_t)body_len, parse_strict);
   
   if (!program) {
     parse_arena_rewind(parse_mark);
@@ -7329,14 +7652,16 @@ sv_func_t *sv_compile_function_with_params(
   
   top_fn.body->args = program->args;
   sv_compiler_t root;
+  const char *pinned = pin_source_text(body, (ant_offset_t)body_len);
   
   sv_compile_ctx_init_root(
     &root, js, js->filename,
-    pin_source_text(body, (ant_offset_t)body_len),
-    (ant_offset_t)body_len, SV_COMPILE_SCRIPT,
+    pinned, (ant_offset_t)body_len, SV_COMPILE_SCRIPT,
     (program->flags & FN_PARSE_STRICT) != 0, NULL
   );
   
+  root.allow_lazy = pinned != body;
+  
   root.line_table = sv_compile_ctx_build_line_table(root.source, (ant_offset_t)body_len);
   sv_func_t *func = compile_function_body(&root, &top_fn, SV_COMPILE_SCRIPT);
   
@@ -77,6 +77,166 @@ void sv_ic_shape_refs_cleanup(ant_t *js) {
   js->ic_shape_ref_len = js->ic_shape_ref_cap = 0;
 }
 
+enum {
+  SV_OPPROF_TRIPLE_CAP = 1 << 16,
+  SV_OPPROF_TOP        = 32,
+  SV_OPPROF_CANDIDATES = 8,
+};
+
+static const uint8_t sv_opprof_fused_next[OP__COUNT] = {
+#define OP_FUSED(name, head, next) [OP_##name] = OP_##next,
+#include "silver/opcode.h"
+};
+
+typedef struct {
+  uint32_t key;
+  uint64_t count;
+} sv_opprof_entry_t;
+
+static struct {
+  uint64_t total;
+  uint64_t *pairs;
+  sv_opprof_entry_t *triples;
+  uint32_t triple_count;
+  uint64_t triples_dropped;
+  int prev1, prev2;
+} sv_opprof = { .prev1 = -1, .prev2 = -1 };
+
+static void sv_opprof_record(uint8_t op) {
+  sv_opprof.total++;
+  int a = sv_opprof.prev2, b = sv_opprof.prev1;
+  sv_opprof.prev2 = b;
+  sv_opprof.prev1 = op;
+  if (b < 0) return;
+
+  if (!sv_opprof.pairs) sv_opprof.pairs = calloc((size_t)OP__COUNT * OP__COUNT, sizeof(uint64_t));
+  if (sv_opprof.pairs) sv_opprof.pairs[(size_t)b * OP__COUNT + op]++;
+  if (a < 0) return;
+
+  if (!sv_opprof.triples) sv_opprof.triples = calloc(SV_OPPROF_TRIPLE_CAP, sizeof(sv_opprof_entry_t));
+  if (!sv_opprof.triples) return;
+
+  uint32_t key = ((uint32_t)a << 16 | (uint32_t)b << 8 | op) + 1u;
+  uint32_t h = (key * 2654435761u) & (SV_OPPROF_TRIPLE_CAP - 1);
+  for (;;) {
+    sv_opprof_entry_t *e = &sv_opprof.triples[h];
+    if (e->key == key) { e->count++; return; }
+    if (e->key == 0) {
+      if (sv_opprof.triple_count >= SV_OPPROF_TRIPLE_CAP / 4 * 3) { sv_opprof.triples_dropped++; return; }
+      e->key = key;
+      e->count = 1;
+      sv_opprof.triple_count++;
+      return;
+    }
+    h = (h + 1) & (SV_OPPROF_TRIPLE_CAP - 1);
+  }
+}
+
+static int sv_opprof_entry_cmp(const void *a, const void *b) {
+  uint64_t ca = ((const sv_opprof_entry_t *)a)->count;
+  uint64_t cb = ((const sv_opprof_entry_t *)b)->count;
+  return (ca < cb) - (ca > cb);
+}
+
+// the superinstruction whose chain executes the n-gram packed in `key`, so
+// the report shows which hot sequences the OP_FUSED set already covers
+static const char *sv_opprof_fused_name(uint32_t key, int arity) {
+  for (int f = 0; f < OP__COUNT; f++) {
+    if (sv_op_base((sv_op_t)f) == (sv_op_t)f) continue;
+
+    int cur = f;
+    bool match = true;
+    for (int k = arity - 1; k >= 0 && match; k--) {
+      if (k < arity - 1) {
+        if (sv_op_base((sv_op_t)cur) == (sv_op_t)cur) { match = false; break; }
+        cur = sv_opprof_fused_next[cur];
+      }
+      match = sv_op_base((sv_op_t)cur) == (sv_op_t)((key >> (8 * k)) & 0xFF);
+    }
+    if (match) return sv_op_names[f];
+  }
+  return NULL;
+}
+
+// a fused head jumps straight into its successor, so it has to be an op
+// that always finishes by falling through to the next instruction
+static bool sv_opprof_fusable_head(uint8_t op) {
+  static const char *const control[] = {
+    "CALL", "NEW", "RETURN", "THROW", "YIELD", "AWAIT", "JMP", "TRY", "CATCH", "FINALLY", "ITER", NULL
+  };
+  if (sv_op_flags[op] & (SV_OPF_JIT_BRANCH32 | SV_OPF_JIT_BRANCH8)) return false;
+  for (const char *const *c = control; *c; c++)
+    if (strstr(sv_op_names[op], *c)) return false;
+  return true;
+}
+
+static void sv_opprof_print_top(const char *title, sv_opprof_entry_t *entries, size_t n, int arity) {
+  qsort(entries, n, sizeof(*entries), sv_opprof_entry_cmp);
+  fprintf(stderr, "  %s:\n", title);
+
+  for (size_t i = 0; i < n && i < SV_OPPROF_TOP; i++) {
+    uint32_t key = entries[i].key;
+    fprintf(stderr, "    %6.2f%% %12llu ",
+      100.0 * (double)entries[i].count / (double)sv_opprof.total,
+      (unsigned long long)entries[i].count);
+    for (int k = arity - 1; k >= 0; k--)
+      fprintf(stderr, " %s", sv_op_names[(key >> (8 * k)) & 0xFF]);
+    const char *fused = sv_opprof_fused_name(key, arity);
+    if (fused) fprintf(stderr, "  <- %s", fused);
+    fputc('\n', stderr);
+  }
+}
+
+// ready-made opcode.h lines for the hottest pairs nothing covers yet; each
+// still needs an interpreter handler next to the existing L_*_* ones
+static void sv_opprof_print_candidates(const sv_opprof_entry_t *pairs, size_t n) {
+  size_t shown = 0;
+  for (size_t i = 0; i < n && shown < SV_OPPROF_CANDIDATES; i++) {
+    uint8_t head = (uint8_t)(pairs[i].key >> 8);
+    uint8_t next = (uint8_t)(pairs[i].key & 0xFF);
+    if (sv_opprof_fused_name(pairs[i].key, 2) || !sv_opprof_fusable_head(head)) continue;
+    if (shown++ == 0) fprintf(stderr, "  fusion candidates:\n");
+    fprintf(stderr, "    OP_FUSED(  %s_%s, %s, %s)\n",
+      sv_op_names[head], sv_op_names[next], sv_op_names[head], sv_op_names[next]);
+  }
+}
+
+void sv_opcode_profile_report(void) {
+  if (sv_opprof.total == 0) return;
+  fprintf(stderr, "opcode profile: %llu instructions\n", (unsigned long long)sv_opprof.total);
+
+  size_t n = 0;
+  sv_opprof_entry_t *pairs = sv_opprof.pairs
+    ? malloc((size_t)OP__COUNT * OP__COUNT * sizeof(sv_opprof_entry_t)) : NULL;
+  if (pairs) {
+    for (uint32_t i = 0; i < (uint32_t)OP__COUNT * OP__COUNT; i++) {
+      if (sv_opprof.pairs[i] == 0) continue;
+      uint32_t key = (i / OP__COUNT) << 8 | (i % OP__COUNT);
+      pairs[n++] = (sv_opprof_entry_t){ .key = key, .count = sv_opprof.pairs[i] };
+    }
+    sv_opprof_print_top("pairs", pairs, n, 2);
+    sv_opprof_print_candidates(pairs, n);
+    free(pairs);
+  }
+
+  if (sv_opprof.triples) {
+    n = 0;
+    for (uint32_t i = 0; i < SV_OPPROF_TRIPLE_CAP; i++) {
+      sv_opprof_entry_t *e = &sv_opprof.triples[i];
+      if (e->key) sv_opprof.triples[n++] = (sv_opprof_entry_t){ .key = e->key - 1u, .count = e->count };
+    }
+    sv_opprof_print_top("triples", sv_opprof.triples, n, 3);
+    if (sv_opprof.triples_dropped)
+      fprintf(stderr, "  (%llu triples not tracked, table full)\n", (unsigned long long)sv_opprof.triples_dropped);
+  }
+
+  free(sv_opprof.pairs);
+  free(sv_opprof.triples);
+  sv_opprof.pairs = NULL;
+  sv_opprof.triples = NULL;
+  sv_opprof.total = 0;
+}
+
 static void *sv_vm_reserve_storage(void) {
 #ifdef _WIN32
   return VirtualAlloc(NULL, SV_VM_RESERVE, MEM_RESERVE, PAGE_READWRITE);
@@ -481,8 +641,7 @@ void js_set_error_site_from_vm_top(ant_t *js) {
 }
 
 static inline ant_flat_string_t *sv_string_builder_flat_ptr(ant_value_t value) {
-  if (vtype(value) != T_STR || str_is_heap_rope(value) || str_is_heap_builder(value)) return NULL;
-  return (ant_flat_string_t *)(uintptr_t)vdata(value);
+  return ant_str_flat_ptr(value);
 }
 
 static inline ant_string_builder_t *sv_string_builder_heap_ptr(ant_value_t value) {
@@ -601,8 +760,7 @@ static ant_value_t sv_string_builder_snapshot(ant_t *js, ant_value_t value) {
     if (vtype(snapshot) == T_STR) return snapshot;
 
     ant_value_t cached = builder->cached;
-    if (vtype(cached) == T_STR &&
-        !str_is_heap_rope(cached) && !str_is_heap_builder(cached))
+    if (vtype(cached) == T_STR && ant_str_flat_ptr(cached))
       return cached;
   }
 
@@ -648,7 +806,7 @@ static ant_value_t sv_string_builder_snapshot(ant_t *js, ant_value_t value) {
   builder->head = NULL;
   builder->chunk_tail = NULL;
   builder->tail_len = 0;
-  if (!str_is_heap_rope(result)) builder->cached = result;
+  if (ant_str_flat_ptr(result)) builder->cached = result;
 
   GC_ROOT_RESTORE(js, root_mark);
   return result;
@@ -1059,6 +1217,7 @@ static inline ant_value_t sv_try_direct_closure_jit(
   if (caller_func && sv_func_type_feedback(caller_func) && caller_ip)
     sv_tfb_record_call_target(caller_func, (int)(caller_ip - caller_func->code), callee);
 
+  if (__builtin_expect(callee->jit_compiling, 0)) sv_jit_install_ready(js);
   if (callee->jit_code) {
     if (caller_frame && caller_ip) caller_frame->ip = caller_ip + 3;
     sv_jit_enter(js);
@@ -1084,8 +1243,12 @@ static inline ant_value_t sv_try_direct_closure_jit(
 
   sv_jit_func_t jit_fn = sv_jit_compile(js, callee, closure);
   if (!jit_fn) {
-    callee->call_count = 0;
-    callee->back_edge_count = 0;
+    // a function queued on the compiler thread stays hot so the next call
+    // picks its code up instead of waiting out another threshold
+    if (!callee->jit_compiling) {
+      callee->call_count = 0;
+      callee->back_edge_count = 0;
+    }
     return SV_JIT_RETRY_INTERP;
   }
 
@@ -1327,10 +1490,21 @@ ant_value_t sv_execute_frame(sv_vm_t *vm, sv_func_t *func, ant_value_t this, ant
   }
   #endif
 
-  static const void *dispatch[OP__COUNT] = {
+  static const void *dispatch_table[OP__COUNT] = {
     #define OP_DEF(name, size, n_pop, n_push, f) [OP_##name] = &&L_##name,
     #include "silver/opcode.h"
+    #define OP_FUSED(name, head, next) [OP_##name] = &&L_##name,
+    #include "silver/opcode.h"
+  };
+
+  static const void *profile_table[OP__COUNT] = {
+    #define OP_DEF(name, size, n_pop, n_push, f) [OP_##name] = &&L__PROFILE,
+    #include "silver/opcode.h"
+    #define OP_FUSED(name, head, next) [OP_##name] = &&L__PROFILE,
+    #include "silver/opcode.h"
   };
+
+  const void *const *dispatch = sv_profile_opcodes ? profile_table : dispatch_table;
   
   ant_value_t sv_err;
   ant_value_t  tc_this = js_mkundef();
@@ -1343,15 +1517,25 @@ ant_value_t sv_execute_frame(sv_vm_t *vm, sv_func_t *func, ant_value_t this, ant
 
   #define DISPATCH() goto *dispatch[*ip]
   #define NEXT(n)    ({ ip += (n); DISPATCH(); })
+  #define NEXT_FUSED(n, next) ({ ip += (n); goto L_##next; })
 
   #ifdef ANT_JIT
   #define JIT_OSR_BACK_EDGE() do {                                          \
-    if (!func->jit_compile_failed) {                                        \
+    if (!func->jit_compile_failed || !func->jit_loop_failed) {              \
       if (!sv_func_type_feedback(func)) sv_tfb_ensure(func);                \
+      if (func->jit_compiling) sv_jit_install_ready(js);                    \
       if (++func->back_edge_count >= SV_JIT_OSR_THRESHOLD) {                \
       ant_value_t osr_r = sv_jit_try_osr(                                   \
         vm, js, frame, func,                                                \
          (int)(ip - func->code));                                           \
+      if (osr_r == SV_JIT_LOOP_EXIT) {                                      \
+        frame = &vm->frames[vm->fp];                                        \
+        bp = frame->bp;                                                     \
+        lp = frame->lp;                                                     \
+        ip = func->code + vm->jit_osr.bc_offset;                            \
+        frame->ip = ip;                                                     \
+        DISPATCH();                                                         \
+      }                                                                     \
       if (osr_r != SV_JIT_RETRY_INTERP) {                                   \
         if (is_err(osr_r)) { sv_err = osr_r; goto sv_throw; }               \
         vm->sp = frame->prev_sp;                                            \
@@ -1392,6 +1576,8 @@ ant_value_t sv_execute_frame(sv_vm_t *vm, sv_func_t *func, ant_value_t this, ant
   }
   DISPATCH();
 
+  L__PROFILE: { sv_opprof_record(*ip); goto *dispatch_table[*ip]; }
+
   L_CONST:     { sv_op_const(vm, func, ip);       NEXT(5); }
   L_CONST_I8:  { sv_op_const_i8(vm, ip);          NEXT(2); }
   L_CONST8:    { sv_op_const8(vm, func, ip);      NEXT(2); }
@@ -1454,7 +1640,7 @@ ant_value_t sv_execute_frame(sv_vm_t *vm, sv_func_t *func, ant_value_t this, ant
   L_PUT_FIELD:     { VM_CHECK(sv_op_put_field(vm, js, func, ip));   NEXT(7); }
   L_GET_ELEM:      { VM_CHECK(sv_op_get_elem(vm, js, func, ip));    NEXT(1); }
   L_GET_ELEM2:     { VM_CHECK(sv_op_get_elem2(vm, js, func, ip));   NEXT(1); }
-  L_PUT_ELEM:      { VM_CHECK(sv_op_put_elem(vm, js));              NEXT(1); }
+  L_PUT_ELEM:      { VM_CHECK(sv_op_put_elem(vm, js, func, ip));    NEXT(1); }
   L_DEFINE_FIELD:  { sv_op_define_field(vm, js, func, ip);          NEXT(5); }
   L_DEFINE_SLOT:   { sv_op_define_slot(vm, js, func, ip);           NEXT(7); }
   L_GET_LENGTH:    { VM_CHECK(sv_op_get_length(vm, js));            NEXT(1); }
@@ -2392,6 +2578,38 @@ ant_value_t sv_execute_frame(sv_vm_t *vm, sv_func_t *func, ant_value_t this, ant
   L_DEBUGGER:  { NEXT(1); }
   L_NOP:       { NEXT(1); }
 
+  L_LT_JMP_FALSE: {
+    ant_value_t r = vm->stack[vm->sp - 1], l = vm->stack[vm->sp - 2];
+    sv_tfb_record2(func, ip, l, r);
+    if (__builtin_expect(vtype(l) == T_NUM && vtype(r) == T_NUM, 1)) {
+      vm->sp--; vm->stack[vm->sp - 1] = mkval(T_BOOL, tod(l) < tod(r)); NEXT_FUSED(1, JMP_FALSE);
+    }
+    VM_CHECK(sv_op_lt(vm, js)); NEXT_FUSED(1, JMP_FALSE);
+  }
+
+  L_LT_JMP_FALSE8: {
+    ant_value_t r = vm->stack[vm->sp - 1], l = vm->stack[vm->sp - 2];
+    sv_tfb_record2(func, ip, l, r);
+    if (__builtin_expect(vtype(l) == T_NUM && vtype(r) == T_NUM, 1)) {
+      vm->sp--; vm->stack[vm->sp - 1] = mkval(T_BOOL, tod(l) < tod(r)); NEXT_FUSED(1, JMP_FALSE8);
+    }
+    VM_CHECK(sv_op_lt(vm, js)); NEXT_FUSED(1, JMP_FALSE8);
+  }
+
+  L_CONST_I8_LT_JMP_FALSE:   { sv_op_const_i8(vm, ip);  NEXT_FUSED(2, LT_JMP_FALSE); }
+  L_CONST_I8_LT_JMP_FALSE8:  { sv_op_const_i8(vm, ip);  NEXT_FUSED(2, LT_JMP_FALSE8); }
+
+  L_GET_LOCAL8_LT_JMP_FALSE:           { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, LT_JMP_FALSE); }
+  L_GET_LOCAL8_LT_JMP_FALSE8:          { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, LT_JMP_FALSE8); }
+  L_GET_LOCAL8_CONST_I8_LT_JMP_FALSE:  { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, CONST_I8_LT_JMP_FALSE); }
+  L_GET_LOCAL8_CONST_I8_LT_JMP_FALSE8: { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, CONST_I8_LT_JMP_FALSE8); }
+  L_GET_LOCAL8_GET_FIELD:              { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, GET_FIELD); }
+  L_GET_LOCAL8_GET_LENGTH:             { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, GET_LENGTH); }
+  L_GET_LOCAL8_GET_LOCAL8:             { VM_CHECK(sv_op_get_local8(vm, lp, js, frame, ip));  NEXT_FUSED(2, GET_LOCAL8); }
+
+  L_GET_ARG_GET_FIELD:  { VM_CHECK(sv_op_get_arg(vm, js, frame, ip));  NEXT_FUSED(3, GET_FIELD); }
+  L_THIS_GET_FIELD:     { sv_op_this(vm, frame);                       NEXT_FUSED(1, GET_FIELD); }
+
   L_LABEL:
   L_LINE_NUM:
   L_COL_NUM:
@@ -2439,6 +2657,7 @@ ant_value_t sv_execute_frame(sv_vm_t *vm, sv_func_t *func, ant_value_t this, ant
 
   #undef DISPATCH
   #undef NEXT
+  #undef NEXT_FUSED
   #undef VM_CHECK
 
   // TODO: use entry_bp/frame->bp
@@ -520,7 +520,7 @@ ant_value_t jit_helper_for_of(
   }
 
   if (vtype(iterable) == T_STR) {
-    if (str_is_heap_rope(iterable) || str_is_heap_builder(iterable)) {
+    if (str_is_heap_rope(iterable) || str_is_heap_builder(iterable) || str_is_heap_slice(iterable)) {
       iterable = str_materialize(js, iterable);
       if (is_err(iterable)) {
         GC_ROOT_RESTORE(js, root_mark);
@@ -917,6 +917,51 @@ ant_value_t jit_helper_bailout_resume(
   );
 }
 
+static void jit_move_open_upvalues(
+  sv_vm_t *vm, ant_value_t *src, ant_value_t *dst, int64_t count
+) {
+  sv_upvalue_t *moved = NULL;
+  jit_helper_take_open_upvalues_rebase(vm, &moved, src, dst, (int)count);
+  jit_helper_adopt_open_upvalues(vm, &moved);
+}
+
+// a loop unit hands its state back to the interpreter frame it was entered
+// from, which then carries on at bc_offset; leaving through a loop exit is
+// the normal way out, only offsets inside the loop count as bailouts
+ant_value_t jit_helper_loop_exit(
+  sv_vm_t *vm, sv_closure_t *closure,
+  ant_value_t *vstack, int64_t vstack_sp,
+  ant_value_t *params, int64_t n_params,
+  ant_value_t *locals, int64_t n_locals,
+  int64_t bc_offset, int64_t loop_start, int64_t loop_end
+) {
+  if (!closure || !closure->func) return mkval(T_ERR, 0);
+  sv_func_t *fn = closure->func;
+  if (bc_offset >= loop_start && bc_offset < loop_end)
+    sv_jit_on_loop_bailout(fn, (int)loop_start, (int)bc_offset);
+
+  ant_value_t *bp = vm->jit_osr.bp;
+  ant_value_t *lp = vm->jit_osr.lp;
+  
+  int64_t rp = n_params < fn->param_count ? n_params : fn->param_count;
+  if (params && bp && params != bp && rp > 0) {
+    for (int64_t i = 0; i < rp; i++) bp[i] = params[i];
+    jit_move_open_upvalues(vm, params, bp, rp);
+  }
+
+  int64_t rl = n_locals < fn->max_locals ? n_locals : fn->max_locals;
+  if (locals && lp && locals != lp && rl > 0) {
+    for (int64_t i = 0; i < rl; i++) lp[i] = locals[i];
+    jit_move_open_upvalues(vm, locals, lp, rl);
+  }
+
+  for (int64_t i = 0; i < vstack_sp; i++)
+    vm->stack[vm->sp++] = vstack[i];
+  
+  vm->jit_osr.bc_offset = (int)bc_offset;
+  return SV_JIT_LOOP_EXIT;
+}
+
 void jit_helper_define_field(
   sv_vm_t *vm, ant_t *js, ant_value_t obj,
   ant_value_t val, const char *str, uint32_t len
@@ -987,6 +1032,9 @@ ant_value_t jit_helper_get_elem(
     if (d >= 0 && d == (uint32_t)d)
       return js_arr_get(js, obj, (uint32_t)d);
   }
+  ant_value_t typed_elem = js_mkundef();
+  if (sv_try_typed_index_get(js, obj, key, NULL, NULL, &typed_elem))
+    return typed_elem;
   ant_value_t str_elem = js_mkundef();
   if (sv_try_string_index_get(js, obj, key, &str_elem))
     return str_elem;
@@ -1010,6 +1058,9 @@ ant_value_t jit_helper_put_elem(
   sv_vm_t *vm, ant_t *js,
   ant_value_t obj, ant_value_t key, ant_value_t val
 ) {
+  ant_value_t typed_res = js_mkundef();
+  if (sv_try_typed_index_put(js, obj, key, val, NULL, NULL, &typed_res))
+    return is_err(typed_res) ? typed_res : val;
   if (vtype(key) == T_SYMBOL) return js_setprop(js, obj, key, val);
   ant_value_t key_jv = sv_key_to_propstr(js, key);
   return js_setprop(js, obj, key_jv, val);
@@ -1031,7 +1082,7 @@ ant_value_t jit_helper_object(
   sv_func_t *func,
   sv_obj_site_cache_t *site
 ) {
-  ant_value_t obj = mkobj(js, 0);
+  ant_value_t obj = js_mkobj_with_inobj_limit(js, sv_obj_site_inobj_limit(site));
   ant_object_t *ptr = js_obj_ptr(js_as_obj(obj));
   
   sv_obj_site_apply(js, func, site, ptr);
@@ -1079,6 +1130,9 @@ ant_value_t jit_helper_get_elem2(sv_vm_t *vm, ant_t *js, ant_value_t obj, ant_va
     if (d >= 0 && d == (uint32_t)d)
       return js_arr_get(js, obj, (uint32_t)d);
   }
+  ant_value_t typed_elem = js_mkundef();
+  if (sv_try_typed_index_get(js, obj, key, NULL, NULL, &typed_elem))
+    return typed_elem;
   ant_value_t str_elem = js_mkundef();
   if (sv_try_string_index_get(js, obj, key, &str_elem))
     return str_elem;
@@ -1106,6 +1160,9 @@ ant_value_t jit_helper_get_elem_inline(
     }
   }
 
+  ant_value_t typed_elem = js_mkundef();
+  if (sv_try_typed_index_get(js, obj, key, NULL, NULL, &typed_elem)) return typed_elem;
+
   ant_value_t str_elem = js_mkundef();
   if (sv_try_string_index_get(js, obj, key, &str_elem)) return str_elem;
 
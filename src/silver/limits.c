@@ -19,6 +19,9 @@
 #define SV_BYTES_PER_SLOT    ((int)sizeof(uint64_t))
 
 int sv_user_stack_size_kb = 0;
+int sv_jit_code_budget_kb = 0;
+bool sv_lazy_functions = true;
+bool sv_profile_opcodes = false;
 
 size_t os_thread_stack_size(void) {
 #ifdef _WIN32
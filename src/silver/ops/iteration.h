@@ -78,7 +78,7 @@ static inline ant_value_t sv_op_for_of(sv_vm_t *vm, ant_t *js) {
   }
 
   if (vtype(iterable) == T_STR) {
-    if (str_is_heap_rope(iterable) || str_is_heap_builder(iterable)) {
+    if (str_is_heap_rope(iterable) || str_is_heap_builder(iterable) || str_is_heap_slice(iterable)) {
       GC_ROOT_SAVE(str_root_mark, js);
       GC_ROOT_PIN(js, iterable);
       iterable = str_materialize(js, iterable);
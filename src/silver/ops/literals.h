@@ -49,6 +49,12 @@ static inline sv_obj_site_cache_t *sv_obj_site_for_ip(sv_func_t *func, uint8_t *
   return sv_obj_site_for_offset(func, off);
 }
 
+static inline uint8_t sv_obj_site_inobj_limit(const sv_obj_site_cache_t *site) {
+  if (!site || site->key_count <= ANT_INOBJ_DEFAULT_SLOTS) return (uint8_t)ANT_INOBJ_DEFAULT_SLOTS;
+  if (site->key_count >= ANT_INOBJ_MAX_SLOTS) return (uint8_t)ANT_INOBJ_MAX_SLOTS;
+  return (uint8_t)site->key_count;
+}
+
 static inline void sv_obj_site_apply(
   ant_t *js, sv_func_t *func,
   sv_obj_site_cache_t *site, ant_object_t *ptr
@@ -91,9 +97,9 @@ static inline void sv_obj_site_apply(
 }
 
 static inline void sv_op_object(sv_vm_t *vm, ant_t *js, sv_func_t *func, uint8_t *ip) {
-  ant_value_t obj = mkobj(js, 0);
-  ant_object_t *ptr = js_obj_ptr(js_as_obj(obj));
   sv_obj_site_cache_t *site = sv_obj_site_for_ip(func, ip);
+  ant_value_t obj = js_mkobj_with_inobj_limit(js, sv_obj_site_inobj_limit(site));
+  ant_object_t *ptr = js_obj_ptr(js_as_obj(obj));
   sv_obj_site_apply(js, func, site, ptr);
 
   ant_value_t proto = js->sym.object_proto;
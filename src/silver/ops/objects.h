@@ -207,7 +207,7 @@ static inline ant_value_t sv_op_spread(sv_vm_t *vm, ant_t *js) {
   }
 
   if (vtype(iterable) == T_STR) {
-    if (str_is_heap_rope(iterable) || str_is_heap_builder(iterable)) {
+    if (str_is_heap_rope(iterable) || str_is_heap_builder(iterable) || str_is_heap_slice(iterable)) {
       iterable = str_materialize(js, iterable);
       if (is_err(iterable)) return iterable;
     }
@@ -6,6 +6,7 @@
 #include "utf8.h"
 
 #include "modules/regex.h"
+#include "modules/buffer.h"
 #include "silver/engine.h"
 
 #include <math.h>
@@ -667,6 +668,65 @@ static inline bool sv_try_string_index_get(ant_t *js, ant_value_t obj, ant_value
   return true;
 }
 
+static inline TypedArrayData *sv_typed_elem_data(ant_value_t obj) {
+  if (vtype(obj) != T_OBJ) return NULL;
+  ant_object_t *ptr = js_obj_ptr(obj);
+  if (!ptr || ptr->native.tag != BUFFER_TYPEDARRAY_NATIVE_TAG) return NULL;
+  return (TypedArrayData *)ptr->native.ptr;
+}
+
+static inline bool sv_typed_elem_index(const TypedArrayData *ta, ant_value_t key, size_t *out) {
+  if (!ta || vtype(key) != T_NUM) return false;
+  if (!ta->buffer || ta->buffer->is_detached) return false;
+
+  double d = tod(key);
+  if (!(d >= 0 && d < (double)ta->length)) return false;
+  size_t idx = (size_t)d;
+  if ((double)idx != d) return false;
+
+  *out = idx;
+  return true;
+}
+
+static inline void sv_record_elem_site(sv_func_t *func, uint8_t *ip, const TypedArrayData *ta) {
+#ifdef ANT_JIT
+  if (func && ip) sv_tfb_record_elem_kind(
+    func, ip, ta ? (uint8_t)(ta->type + 1) : SV_TFB_ELEM_GENERIC
+  );
+#else
+  (void)func; (void)ip; (void)ta;
+#endif
+}
+
+// in-range integer index on an attached typed array; everything else
+// (holes past length, string keys, detached buffers) takes the generic path
+static inline bool sv_try_typed_index_get(
+  ant_t *js, ant_value_t obj, ant_value_t key,
+  sv_func_t *func, uint8_t *ip, ant_value_t *out
+) {
+  TypedArrayData *ta = sv_typed_elem_data(obj);
+  if (!ta) return false;
+  sv_record_elem_site(func, ip, ta);
+
+  size_t idx = 0;
+  if (!sv_typed_elem_index(ta, key, &idx)) return false;
+  return buffer_typedarray_data_read_index(js, ta, idx, out);
+}
+
+static inline bool sv_try_typed_index_put(
+  ant_t *js, ant_value_t obj, ant_value_t key, ant_value_t val,
+  sv_func_t *func, uint8_t *ip, ant_value_t *out
+) {
+  TypedArrayData *ta = sv_typed_elem_data(obj);
+  if (!ta) return false;
+  sv_record_elem_site(func, ip, ta);
+
+  size_t idx = 0;
+  if (!sv_typed_elem_index(ta, key, &idx)) return false;
+  *out = buffer_typedarray_data_write_index(js, ta, idx, val);
+  return true;
+}
+
 static inline bool sv_prim_ic_lookup(
   ant_t *js,
   ant_value_t obj,
@@ -1013,12 +1073,19 @@ static inline ant_value_t sv_op_get_elem(
     }
   }
 
+  ant_value_t typed_elem = js_mkundef();
+  if (sv_try_typed_index_get(js, obj, key, func, ip, &typed_elem)) {
+    vm->stack[vm->sp++] = typed_elem;
+    return js_mkundef();
+  }
+
   ant_value_t str_elem = js_mkundef();
   if (sv_try_string_index_get(js, obj, key, &str_elem)) {
     vm->stack[vm->sp++] = str_elem;
     return js_mkundef();
   }
 
+  if (!sv_typed_elem_data(obj)) sv_record_elem_site(func, ip, NULL);
   ant_value_t res = sv_getprop_by_key(js, obj, key);
   if (is_err(res)) return res;
   vm->stack[vm->sp++] = res;
@@ -1046,22 +1113,37 @@ static inline ant_value_t sv_op_get_elem2(
     }
   }
 
+  ant_value_t typed_elem = js_mkundef();
+  if (sv_try_typed_index_get(js, obj, key, func, ip, &typed_elem)) {
+    vm->stack[vm->sp++] = typed_elem;
+    return js_mkundef();
+  }
+
   ant_value_t str_elem = js_mkundef();
   if (sv_try_string_index_get(js, obj, key, &str_elem)) {
     vm->stack[vm->sp++] = str_elem;
     return js_mkundef();
   }
 
+  if (!sv_typed_elem_data(obj)) sv_record_elem_site(func, ip, NULL);
   ant_value_t res = sv_getprop_by_key(js, obj, key);
   if (is_err(res)) return res;
   vm->stack[vm->sp++] = res;
   return js_mkundef();
 }
 
-static inline ant_value_t sv_op_put_elem(sv_vm_t *vm, ant_t *js) {
+static inline ant_value_t sv_op_put_elem(
+  sv_vm_t *vm, ant_t *js,
+  sv_func_t *func, uint8_t *ip
+) {
   ant_value_t val = vm->stack[--vm->sp];
   ant_value_t key = vm->stack[--vm->sp];
   ant_value_t obj = vm->stack[--vm->sp];
+
+  ant_value_t typed_res = js_mkundef();
+  if (sv_try_typed_index_put(js, obj, key, val, func, ip, &typed_res)) return typed_res;
+  if (!sv_typed_elem_data(obj)) sv_record_elem_site(func, ip, NULL);
+
   ant_value_t prop_key = sv_key_to_property_key(js, key);
   if (is_err(prop_key)) return prop_key;
   return js_setprop(js, obj, prop_key, val);
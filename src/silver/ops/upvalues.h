@@ -184,6 +184,7 @@ static inline sv_upvalue_t *sv_capture_upvalue(sv_vm_t *vm, ant_value_t *slot) {
 static inline sv_closure_t *sv_closure_init(
   ant_t *js, sv_func_t *child, ant_value_t this_val
 ) {
+  if (!sv_func_ensure_compiled(js, child)) return NULL;
   sv_closure_t *closure = js_closure_alloc_hot(js);
   if (!closure) return NULL;
 
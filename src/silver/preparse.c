@@ -0,0 +1,850 @@
+#include "silver/preparse.h"
+#include "tokens.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+  PP_SCOPE_FUNC      = 1 << 0,
+  PP_SCOPE_ARROW     = 1 << 1,
+  PP_SCOPE_GENERATOR = 1 << 2,
+};
+
+// what the previous token leaves the skim expecting next
+enum {
+  PP_STMT,
+  PP_OPER,
+  PP_VALUE,
+  PP_DOT,
+};
+
+// the construct a run of tokens belongs to; PP_EXPR ends before a stop token
+// instead of at a closing bracket of its own
+enum {
+  PP_BODY,
+  PP_BLOCK,
+  PP_OBJECT,
+  PP_PAREN,
+  PP_BRACKET,
+  PP_SUBST,
+  PP_EXPR,
+};
+
+enum {
+  PP_STOP_COMMA = 1 << 0,
+  PP_STOP_SEMI  = 1 << 1,
+  PP_STOP_COLON = 1 << 2,
+  PP_STOP_ASI   = 1 << 3,
+};
+
+#define SV_PREPARSE_MAX_DEPTH 256
+
+static void pp_seq(sv_preparse_t *pp, uint8_t kind, uint8_t stops);
+static void pp_binding(sv_preparse_t *pp, int scope, bool is_param);
+static void pp_function(sv_preparse_t *pp, uint8_t flags, const sv_preparse_name_t *self);
+
+static inline uint8_t pp_next(sv_preparse_t *pp) {
+  return sv_lexer_next(pp->lx);
+}
+
+static inline uint8_t pp_peek(sv_preparse_t *pp) {
+  return sv_lexer_lookahead(pp->lx);
+}
+
+static inline void pp_consume(sv_preparse_t *pp) {
+  pp->lx->st.consumed = 1;
+}
+
+static inline void pp_expr(sv_preparse_t *pp, uint8_t stops) {
+  pp_seq(pp, PP_EXPR, stops);
+}
+
+static inline sv_preparse_name_t pp_tok_name(const sv_preparse_t *pp) {
+  return (sv_preparse_name_t){
+    .str = pp->lx->code + pp->lx->st.toff,
+    .len = (uint32_t)pp->lx->st.tlen,
+  };
+}
+
+static inline bool pp_name_is(sv_preparse_name_t name, const char *str, uint32_t len) {
+  return name.len == len && memcmp(name.str, str, len) == 0;
+}
+
+static inline bool pp_name_eq(sv_preparse_name_t a, sv_preparse_name_t b) {
+  return a.len == b.len && memcmp(a.str, b.str, a.len) == 0;
+}
+
+static inline bool pp_is_word_tok(uint8_t tok) {
+  return tok >= TOK_IDENTIFIER && tok < TOK_IDENT_LIKE_END;
+}
+
+// the tokens parse_primary reads as an identifier reference
+static inline bool pp_is_ref_tok(uint8_t tok) {
+  return
+    tok == TOK_IDENTIFIER || tok == TOK_AS    ||
+    tok == TOK_FROM       || tok == TOK_OF    ||
+    tok == TOK_USING      || tok == TOK_ASYNC ||
+    tok == TOK_WINDOW;
+}
+
+// the tokens parse_binding_pattern accepts as a name
+static inline bool pp_is_binding_tok(uint8_t tok) {
+  return
+    tok == TOK_IDENTIFIER || tok == TOK_DEFAULT ||
+    tok == TOK_AS         || tok == TOK_FROM    ||
+    tok == TOK_OF         || tok == TOK_ASYNC   ||
+    tok == TOK_USING;
+}
+
+static inline bool pp_starts_statement(uint8_t tok) {
+  if (pp_is_word_tok(tok))
+    return tok != TOK_IN && tok != TOK_INSTANCEOF && tok != TOK_OF;
+  return
+    tok == TOK_NUMBER  || tok == TOK_STRING  ||
+    tok == TOK_BIGINT  || tok == TOK_LBRACE  ||
+    tok == TOK_POSTINC || tok == TOK_POSTDEC ||
+    tok == TOK_NOT     || tok == TOK_TILDA;
+}
+
+static inline uint8_t pp_closer(uint8_t kind) {
+  switch (kind) {
+    case PP_PAREN:   return TOK_RPAREN;
+    case PP_BRACKET: return TOK_RBRACKET;
+    default:         return TOK_RBRACE;
+  }
+}
+
+static bool pp_grow(void **items, int *cap, int count, size_t size) {
+  if (count < *cap) return true;
+  int next_cap = *cap ? *cap * 2 : 32;
+  void *next = realloc(*items, (size_t)next_cap * size);
+  if (!next) return false;
+  *items = next;
+  *cap = next_cap;
+  return true;
+}
+
+// escaped names compare by their decoded text, which the skim never builds,
+// and direct eval can reach any binding in scope, so both fall back
+static bool pp_name_ok(sv_preparse_t *pp, sv_preparse_name_t name) {
+  if (memchr(name.str, '\\', name.len) || pp_name_is(name, "eval", 4)) {
+    pp->failed = true;
+    return false;
+  }
+  return true;
+}
+
+static int pp_scope_open(sv_preparse_t *pp, uint8_t flags) {
+  if (!pp_grow((void **)&pp->scopes, &pp->scope_cap, pp->scope_count, sizeof(*pp->scopes))) {
+    pp->failed = true;
+    return 0;
+  }
+  pp->scopes[pp->scope_count] = (sv_preparse_scope_t){
+    .ref_start = pp->ref_count,
+    .decl_start = pp->decl_count,
+    .flags = flags,
+  };
+  return pp->scope_count++;
+}
+
+static int pp_function_scope(const sv_preparse_t *pp) {
+  for (int i = pp->scope_count - 1; i > 0; i--)
+    if (pp->scopes[i].flags & PP_SCOPE_FUNC) return i;
+  return 0;
+}
+
+// the function `arguments` and `new.target` belong to; arrows have neither
+static int pp_own_function_scope(const sv_preparse_t *pp) {
+  for (int i = pp->scope_count - 1; i > 0; i--)
+    if ((pp->scopes[i].flags & PP_SCOPE_FUNC) && !(pp->scopes[i].flags & PP_SCOPE_ARROW)) return i;
+  return 0;
+}
+
+static bool pp_declared(const sv_preparse_t *pp, int scope, sv_preparse_name_t name) {
+  for (int i = pp->scopes[scope].decl_start; i < pp->decl_count; i++)
+    if (pp->decls[i].scope == scope && pp_name_eq(pp->decls[i].name, name)) return true;
+  return false;
+}
+
+static void pp_declare_name(sv_preparse_t *pp, int scope, sv_preparse_name_t name, bool is_param) {
+  if (!pp_name_ok(pp, name)) return;
+
+  // duplicate parameters and strict-mode `arguments` bindings are early
+  // errors, which the full parse reports
+  if (
+    (is_param && pp_declared(pp, scope, name)) ||
+    (pp->lx->strict && pp_name_is(name, "arguments", 9))
+  ) { pp->failed = true; return; }
+
+  if (!pp_grow((void **)&pp->decls, &pp->decl_cap, pp->decl_count, sizeof(*pp->decls))) {
+    pp->failed = true;
+    return;
+  }
+  pp->decls[pp->decl_count++] = (sv_preparse_decl_t){ .name = name, .scope = scope };
+}
+
+static inline void pp_declare(sv_preparse_t *pp, int scope, bool is_param) {
+  pp_declare_name(pp, scope, pp_tok_name(pp), is_param);
+}
+
+static void pp_ref(sv_preparse_t *pp) {
+  sv_preparse_name_t name = pp_tok_name(pp);
+  if (!pp_name_ok(pp, name)) return;
+
+  int start = pp->scopes[pp->scope_count - 1].ref_start;
+  int from = pp->ref_count - 8 > start ? pp->ref_count - 8 : start;
+  for (int i = from; i < pp->ref_count; i++)
+    if (pp_name_eq(pp->refs[i], name)) return;
+
+  if (!pp_grow((void **)&pp->refs, &pp->ref_cap, pp->ref_count, sizeof(*pp->refs))) {
+    pp->failed = true;
+    return;
+  }
+  pp->refs[pp->ref_count++] = name;
+}
+
+// names this scope declares are dropped, the rest move out to the parent;
+// declarations hoisted past this scope stay for their owner to resolve
+static void pp_scope_close(sv_preparse_t *pp) {
+  int scope = pp->scope_count - 1;
+  const sv_preparse_scope_t *s = &pp->scopes[scope];
+  bool own_arguments = (s->flags & PP_SCOPE_FUNC) && !(s->flags & PP_SCOPE_ARROW);
+
+  int out = s->ref_start;
+  for (int i = s->ref_start; i < pp->ref_count; i++) {
+    sv_preparse_name_t name = pp->refs[i];
+    if (pp_declared(pp, scope, name)) continue;
+    if (own_arguments && pp_name_is(name, "arguments", 9)) {
+      if (scope == 0) pp->uses_arguments = true;
+      continue;
+    }
+    pp->refs[out++] = name;
+  }
+  pp->ref_count = out;
+
+  out = s->decl_start;
+  for (int i = s->decl_start; i < pp->decl_count; i++)
+    if (pp->decls[i].scope != scope) pp->decls[out++] = pp->decls[i];
+  pp->decl_count = out;
+  pp->scope_count--;
+}
+
+static void pp_regex(sv_preparse_t *pp) {
+  sv_lexer_t *lx = pp->lx;
+  ant_offset_t pos = lx->st.toff + 1;
+  bool in_class = false;
+
+  for (;;) {
+    if (pos >= lx->clen) { pp->failed = true; return; }
+    char c = lx->code[pos];
+    if (c == '\n' || c == '\r') { pp->failed = true; return; }
+    if (c == '\\') { pos += 2; continue; }
+    if (c == '[') in_class = true;
+    else if (c == ']') in_class = false;
+    else if (c == '/' && !in_class) break;
+    pos++;
+  }
+
+  pos++;
+  while (pos < lx->clen && IS_IDENT(lx->code[pos])) pos++;
+  lx->st.pos = pos;
+  lx->st.consumed = 1;
+}
+
+// the lexer hands a template over as one token; its substitutions are
+// skimmed by pointing the lexer into them one at a time
+static void pp_template(sv_preparse_t *pp) {
+  sv_lexer_t *lx = pp->lx;
+  ant_offset_t end = lx->st.toff + lx->st.tlen;
+  ant_offset_t i = lx->st.toff + 1;
+
+  while (!pp->failed && i + 1 < end) {
+    char c = lx->code[i];
+    if (c == '\\') { i += 2; continue; }
+    if (c != '$' || lx->code[i + 1] != '{') { i++; continue; }
+
+    lx->st.pos = i + 2;
+    lx->st.consumed = 1;
+    pp_seq(pp, PP_SUBST, 0);
+    i = lx->st.pos;
+    if (i > end) pp->failed = true;
+  }
+
+  lx->st.pos = end;
+  lx->st.consumed = 1;
+}
+
+static void pp_params(sv_preparse_t *pp, int scope) {
+  pp_consume(pp);
+  while (!pp->failed) {
+    uint8_t tok = pp_next(pp);
+    if (tok == TOK_RPAREN) { pp_consume(pp); return; }
+    if (tok == TOK_REST) pp_consume(pp);
+
+    pp_binding(pp, scope, true);
+    if (pp_next(pp) == TOK_ASSIGN) {
+      pp_consume(pp);
+      pp_expr(pp, PP_STOP_COMMA);
+    }
+
+    tok = pp_next(pp);
+    if (tok == TOK_COMMA) pp_consume(pp);
+    else if (tok != TOK_RPAREN) pp->failed = true;
+  }
+}
+
+static void pp_binding_default(sv_preparse_t *pp, uint8_t closer) {
+  if (pp_next(pp) == TOK_ASSIGN) {
+    pp_consume(pp);
+    pp_expr(pp, PP_STOP_COMMA);
+  }
+
+  uint8_t tok = pp_next(pp);
+  if (tok == TOK_COMMA) pp_consume(pp);
+  else if (tok != closer) pp->failed = true;
+}
+
+static void pp_binding(sv_preparse_t *pp, int scope, bool is_param) {
+  uint8_t tok = pp_next(pp);
+
+  if (pp_is_binding_tok(tok)) {
+    pp_declare(pp, scope, is_param);
+    pp_consume(pp);
+    return;
+  }
+
+  if (tok == TOK_LBRACKET) {
+    pp_consume(pp);
+    while (!pp->failed) {
+      tok = pp_next(pp);
+      if (tok == TOK_RBRACKET) { pp_consume(pp); return; }
+      if (tok == TOK_COMMA) { pp_consume(pp); continue; }
+      if (tok == TOK_REST) pp_consume(pp);
+      pp_binding(pp, scope, is_param);
+      pp_binding_default(pp, TOK_RBRACKET);
+    }
+    return;
+  }
+
+  if (tok != TOK_LBRACE) {
+    pp->failed = true;
+    return;
+  }
+
+  pp_consume(pp);
+  while (!pp->failed) {
+    tok = pp_next(pp);
+    if (tok == TOK_RBRACE) { pp_consume(pp); return; }
+
+    if (tok == TOK_REST) {
+      pp_consume(pp);
+      pp_binding(pp, scope, is_param);
+    } else if (tok == TOK_LBRACKET) {
+      pp_consume(pp);
+      pp_seq(pp, PP_BRACKET, 0);
+      if (pp_next(pp) != TOK_COLON) { pp->failed = true; return; }
+      pp_consume(pp);
+      pp_binding(pp, scope, is_param);
+    } else if (pp_peek(pp) == TOK_COLON && (
+      pp_is_word_tok(tok) || tok == TOK_STRING ||
+      tok == TOK_NUMBER || tok == TOK_BIGINT
+    )) {
+      pp_consume(pp);
+      pp_next(pp);
+      pp_consume(pp);
+      pp_binding(pp, scope, is_param);
+    } else pp_binding(pp, scope, is_param);
+
+    pp_binding_default(pp, TOK_RBRACE);
+  }
+}
+
+static void pp_declarations(sv_preparse_t *pp, int scope) {
+  while (!pp->failed) {
+    pp_binding(pp, scope, false);
+    if (pp_next(pp) == TOK_ASSIGN) {
+      pp_consume(pp);
+      pp_expr(pp, PP_STOP_COMMA | PP_STOP_SEMI | PP_STOP_ASI);
+    }
+    if (pp_next(pp) != TOK_COMMA) return;
+    pp_consume(pp);
+  }
+}
+
+static void pp_function(sv_preparse_t *pp, uint8_t flags, const sv_preparse_name_t *self) {
+  if (pp_next(pp) != TOK_LPAREN) {
+    pp->failed = true;
+    return;
+  }
+
+  int scope = pp_scope_open(pp, PP_SCOPE_FUNC | flags);
+  if (self) pp_declare_name(pp, scope, *self, false);
+  pp_params(pp, scope);
+  if (pp->failed || pp_next(pp) != TOK_LBRACE) {
+    pp->failed = true;
+    return;
+  }
+
+  // a directive prologue can make the function strict, which changes what
+  // its parameters and body may contain; that is left to the full parse
+  pp_consume(pp);
+  if (pp_next(pp) == TOK_STRING) pp->failed = true;
+  else pp_seq(pp, PP_BODY, 0);
+  if (!pp->failed) pp_scope_close(pp);
+}
+
+static uint8_t pp_function_keyword(sv_preparse_t *pp, bool is_decl) {
+  uint8_t flags = 0;
+  pp_consume(pp);
+  if (pp_next(pp) == TOK_MUL) {
+    pp_consume(pp);
+    flags |= PP_SCOPE_GENERATOR;
+  }
+
+  sv_preparse_name_t name = {0};
+  if (pp_is_binding_tok(pp_next(pp))) {
+    name = pp_tok_name(pp);
+    pp_consume(pp);
+  }
+
+  // a declaration binds its name in the enclosing block, an expression
+  // only inside its own body
+  if (is_decl && name.len) pp_declare_name(pp, pp->scope_count - 1, name, false);
+  pp_function(pp, flags, !is_decl && name.len ? &name : NULL);
+  return is_decl ? PP_STMT : PP_VALUE;
+}
+
+// the current token is `=>` and the open scope holds the parameters
+static void pp_arrow_body(sv_preparse_t *pp) {
+  pp_consume(pp);
+  if (pp_next(pp) == TOK_LBRACE) {
+    pp_consume(pp);
+    if (pp_next(pp) == TOK_STRING) pp->failed = true;
+    else pp_seq(pp, PP_BODY, 0);
+  } else pp_expr(pp, PP_STOP_COMMA | PP_STOP_SEMI | PP_STOP_COLON | PP_STOP_ASI);
+  if (!pp->failed) pp_scope_close(pp);
+}
+
+// a parenthesized group turns out to be an arrow's parameter list only at
+// the `=>` after it; what it recorded as references is dropped and the
+// group is read again as bindings
+static void pp_paren(sv_preparse_t *pp) {
+  sv_lexer_state_t start;
+  sv_lexer_save_state(pp->lx, &start);
+  int ref_count = pp->ref_count;
+  int decl_count = pp->decl_count;
+
+  pp_consume(pp);
+  pp_seq(pp, PP_PAREN, 0);
+  if (pp->failed || pp_next(pp) != TOK_ARROW) return;
+
+  pp->ref_count = ref_count;
+  pp->decl_count = decl_count;
+  sv_lexer_restore_state(pp->lx, &start);
+
+  int scope = pp_scope_open(pp, PP_SCOPE_FUNC | PP_SCOPE_ARROW);
+  pp_params(pp, scope);
+  if (!pp->failed && pp_next(pp) == TOK_ARROW) pp_arrow_body(pp);
+  else pp->failed = true;
+}
+
+static void pp_head_scope(sv_preparse_t *pp, uint8_t owner) {
+  pp_scope_open(pp, 0);
+  pp_consume(pp);
+
+  if (owner == TOK_CATCH) {
+    pp_binding(pp, pp->scope_count - 1, false);
+    if (pp->failed || pp_next(pp) != TOK_RPAREN) { pp->failed = true; return; }
+    pp_consume(pp);
+    if (pp_next(pp) != TOK_LBRACE) { pp->failed = true; return; }
+    pp_consume(pp);
+    pp_seq(pp, PP_BLOCK, 0);
+    if (!pp->failed) pp_scope_close(pp);
+    return;
+  }
+
+  // a for head's bindings stay visible in a braced body; a body without
+  // braces is read outside them, which only ever adds references
+  pp_seq(pp, PP_PAREN, 0);
+  if (!pp->failed && pp_next(pp) == TOK_LBRACE) {
+    pp_consume(pp);
+    pp_scope_open(pp, 0);
+    pp_seq(pp, PP_BLOCK, 0);
+    if (!pp->failed) pp_scope_close(pp);
+  }
+  if (!pp->failed) pp_scope_close(pp);
+}
+
+static uint8_t pp_property(sv_preparse_t *pp) {
+  uint8_t tok = pp_next(pp);
+  if (tok == TOK_REST) {
+    pp_consume(pp);
+    return PP_OPER;
+  }
+
+  uint8_t flags = 0;
+  sv_preparse_name_t word = pp_tok_name(pp);
+  bool modifier = tok == TOK_ASYNC || (
+    tok == TOK_IDENTIFIER &&
+    (pp_name_is(word, "get", 3) || pp_name_is(word, "set", 3))
+  );
+
+  if (modifier) {
+    uint8_t la = pp_peek(pp);
+    if (
+      la != TOK_COLON && la != TOK_LPAREN && la != TOK_COMMA &&
+      la != TOK_RBRACE && la != TOK_ASSIGN
+    ) { pp_consume(pp); tok = pp_next(pp); }
+  }
+
+  if (tok == TOK_MUL) {
+    pp_consume(pp);
+    flags |= PP_SCOPE_GENERATOR;
+    tok = pp_next(pp);
+  }
+
+  if (tok == TOK_LBRACKET) {
+    pp_consume(pp);
+    pp_seq(pp, PP_BRACKET, 0);
+  } else if (tok == TOK_STRING || tok == TOK_NUMBER || tok == TOK_BIGINT) {
+    pp_consume(pp);
+  } else if (pp_is_word_tok(tok)) {
+    uint8_t la = pp_peek(pp);
+    if (la != TOK_COLON && la != TOK_LPAREN) {
+      if (!pp_is_ref_tok(tok)) { pp->failed = true; return PP_VALUE; }
+      pp_ref(pp);
+      pp_consume(pp);
+      return PP_VALUE;
+    }
+    pp_consume(pp);
+  } else {
+    pp->failed = true;
+    return PP_VALUE;
+  }
+
+  if (pp->failed) return PP_VALUE;
+  tok = pp_next(pp);
+  if (tok == TOK_LPAREN) {
+    pp_function(pp, flags, NULL);
+    return PP_VALUE;
+  }
+
+  if (tok != TOK_COLON) pp->failed = true;
+  pp_consume(pp);
+  return PP_OPER;
+}
+
+static uint8_t pp_word(sv_preparse_t *pp, uint8_t tok, uint8_t prev, bool stmts, uint8_t *head) {
+  // after a complete value a function keyword can only start a new statement
+  bool is_decl = stmts && (prev == PP_STMT || prev == PP_VALUE);
+
+  switch (tok) {
+    case TOK_FUNC:
+      return pp_function_keyword(pp, is_decl);
+
+    case TOK_ASYNC:
+      if (pp_peek(pp) != TOK_FUNC) break;
+      pp_consume(pp);
+      pp_next(pp);
+      if (pp->lx->st.had_newline) { pp->failed = true; return PP_VALUE; }
+      return pp_function_keyword(pp, is_decl);
+
+    case TOK_VAR:
+      pp_consume(pp);
+      pp_declarations(pp, pp_function_scope(pp));
+      return PP_VALUE;
+
+    case TOK_LET:
+    case TOK_CONST:
+      pp_consume(pp);
+      pp_declarations(pp, pp->scope_count - 1);
+      return PP_VALUE;
+
+    case TOK_USING:
+      if (!stmts || !pp_is_binding_tok(pp_peek(pp))) break;
+      pp_consume(pp);
+      pp_declarations(pp, pp->scope_count - 1);
+      return PP_VALUE;
+
+    case TOK_FOR:
+      pp_consume(pp);
+      if (pp_next(pp) == TOK_AWAIT) pp_consume(pp);
+      *head = TOK_FOR;
+      return PP_OPER;
+
+    case TOK_IF:
+    case TOK_WHILE:
+    case TOK_SWITCH:
+    case TOK_CATCH:
+      pp_consume(pp);
+      *head = tok;
+      return PP_OPER;
+
+    case TOK_ELSE:
+    case TOK_DO:
+    case TOK_TRY:
+    case TOK_FINALLY:
+    case TOK_DEBUGGER:
+      pp_consume(pp);
+      return PP_STMT;
+
+    case TOK_BREAK:
+    case TOK_CONTINUE:
+      pp_consume(pp);
+      if (pp_is_ref_tok(pp_next(pp)) && !pp->lx->st.had_newline) pp_consume(pp);
+      return PP_VALUE;
+
+    case TOK_NEW:
+      pp_consume(pp);
+      if (pp_next(pp) != TOK_DOT) return PP_OPER;
+      pp_consume(pp);
+      if (pp_is_word_tok(pp_next(pp))) pp_consume(pp);
+      if (pp_own_function_scope(pp) == 0) pp->uses_new_target = true;
+      return PP_VALUE;
+
+    case TOK_YIELD:
+      if (!(pp->scopes[pp_function_scope(pp)].flags & PP_SCOPE_GENERATOR)) {
+        pp->failed = true;
+        return PP_VALUE;
+      }
+      pp_consume(pp);
+      return PP_OPER;
+
+    case TOK_OF:
+      if (prev != PP_VALUE) break;
+      pp_consume(pp);
+      return PP_OPER;
+
+    case TOK_THIS:
+    case TOK_NULL:
+    case TOK_TRUE:
+    case TOK_FALSE:
+    case TOK_UNDEF:
+    case TOK_GLOBAL_THIS:
+    case TOK_IMPORT:
+      pp_consume(pp);
+      return PP_VALUE;
+
+    case TOK_CLASS:
+    case TOK_SUPER:
+    case TOK_WITH:
+    case TOK_EXPORT:
+    case TOK_STATIC:
+      pp->failed = true;
+      return PP_VALUE;
+
+    default:
+      if (pp_is_ref_tok(tok)) break;
+      pp_consume(pp);
+      return PP_OPER;
+  }
+
+  // a statement label is not a reference
+  if (stmts && prev == PP_STMT && pp_peek(pp) == TOK_COLON) {
+    pp_consume(pp);
+    return PP_OPER;
+  }
+
+  if (pp_peek(pp) == TOK_ARROW) {
+    int scope = pp_scope_open(pp, PP_SCOPE_FUNC | PP_SCOPE_ARROW);
+    pp_declare(pp, scope, true);
+    pp_consume(pp);
+    pp_next(pp);
+    pp_arrow_body(pp);
+    return PP_VALUE;
+  }
+
+  pp_ref(pp);
+  pp_consume(pp);
+  return PP_VALUE;
+}
+
+static void pp_seq(sv_preparse_t *pp, uint8_t kind, uint8_t stops) {
+  if (++pp->depth > SV_PREPARSE_MAX_DEPTH) pp->failed = true;
+
+  bool stmts = kind == PP_BODY || kind == PP_BLOCK;
+  uint8_t prev = stmts ? PP_STMT : PP_OPER;
+  uint8_t last = 0;
+  uint8_t head = 0;
+  bool key = kind == PP_OBJECT;
+  int ternary = 0;
+
+  while (!pp->failed) {
+    uint8_t tok = pp_next(pp);
+    bool newline = pp->lx->st.had_newline;
+    uint8_t owner = head;
+    head = 0;
+
+    if (
+      kind == PP_EXPR && (stops & PP_STOP_ASI) &&
+      newline && prev == PP_VALUE && pp_starts_statement(tok)
+    ) break;
+
+    if (key && tok != TOK_RBRACE) {
+      key = false;
+      prev = pp_property(pp);
+      last = tok;
+      continue;
+    }
+
+    if (prev == PP_DOT && pp_is_word_tok(tok)) {
+      pp_consume(pp);
+      prev = PP_VALUE;
+      last = tok;
+      continue;
+    }
+
+    if (pp_is_word_tok(tok)) {
+      prev = pp_word(pp, tok, prev, stmts, &head);
+      last = tok;
+      continue;
+    }
+
+    switch (tok) {
+      case TOK_RBRACE:
+      case TOK_RPAREN:
+      case TOK_RBRACKET:
+        if (kind == PP_EXPR) goto done;
+        if (tok != pp_closer(kind)) pp->failed = true;
+        pp_consume(pp);
+        goto done;
+
+      case TOK_COMMA:
+        if (kind == PP_EXPR && (stops & PP_STOP_COMMA)) goto done;
+        pp_consume(pp);
+        key = kind == PP_OBJECT;
+        prev = PP_OPER;
+        break;
+
+      case TOK_SEMICOLON:
+        if (kind == PP_EXPR && (stops & PP_STOP_SEMI)) goto done;
+        pp_consume(pp);
+        prev = stmts ? PP_STMT : PP_OPER;
+        break;
+
+      case TOK_Q:
+        pp_consume(pp);
+        ternary++;
+        prev = PP_OPER;
+        break;
+
+      case TOK_COLON:
+        if (ternary > 0) {
+          ternary--;
+          prev = PP_OPER;
+        } else if (kind == PP_EXPR && (stops & PP_STOP_COLON)) goto done;
+        else prev = stmts ? PP_STMT : PP_OPER;
+        pp_consume(pp);
+        break;
+
+      case TOK_LBRACE:
+        pp_consume(pp);
+        if (prev == PP_OPER && owner != TOK_CATCH && !(newline && last == TOK_RETURN)) {
+          pp_seq(pp, PP_OBJECT, 0);
+          prev = PP_VALUE;
+        } else {
+          pp_scope_open(pp, 0);
+          pp_seq(pp, PP_BLOCK, 0);
+          if (!pp->failed) pp_scope_close(pp);
+          prev = PP_STMT;
+        }
+        break;
+
+      case TOK_LPAREN:
+        if (owner == TOK_FOR || owner == TOK_CATCH) {
+          pp_head_scope(pp, owner);
+          prev = PP_STMT;
+        } else if (owner) {
+          pp_consume(pp);
+          pp_seq(pp, PP_PAREN, 0);
+          prev = PP_STMT;
+        } else {
+          pp_paren(pp);
+          prev = PP_VALUE;
+        }
+        break;
+
+      case TOK_LBRACKET:
+        pp_consume(pp);
+        pp_seq(pp, PP_BRACKET, 0);
+        prev = PP_VALUE;
+        break;
+
+      case TOK_TEMPLATE:
+        pp_template(pp);
+        prev = PP_VALUE;
+        break;
+
+      case TOK_DIV:
+      case TOK_DIV_ASSIGN:
+        if (prev == PP_VALUE) {
+          pp_consume(pp);
+          prev = PP_OPER;
+        } else {
+          pp_regex(pp);
+          prev = PP_VALUE;
+        }
+        break;
+
+      case TOK_DOT:
+      case TOK_OPTIONAL_CHAIN:
+        pp_consume(pp);
+        prev = PP_DOT;
+        break;
+
+      case TOK_POSTINC:
+      case TOK_POSTDEC:
+        pp_consume(pp);
+        if (prev != PP_VALUE) prev = PP_OPER;
+        break;
+
+      case TOK_NUMBER:
+      case TOK_STRING:
+      case TOK_BIGINT:
+        pp_consume(pp);
+        prev = PP_VALUE;
+        break;
+
+      case TOK_EOF:
+      case TOK_ERR:
+      case TOK_ARROW:
+      case TOK_HASH:
+        pp->failed = true;
+        break;
+
+      default:
+        pp_consume(pp);
+        prev = PP_OPER;
+        break;
+    }
+    last = tok;
+  }
+
+done:
+  pp->depth--;
+}
+
+void sv_preparse_init(sv_preparse_t *pp, sv_lexer_t *lx, bool is_generator) {
+  memset(pp, 0, sizeof(*pp));
+  pp->lx = lx;
+  pp_scope_open(pp, PP_SCOPE_FUNC | (is_generator ? PP_SCOPE_GENERATOR : 0));
+}
+
+void sv_preparse_free(sv_preparse_t *pp) {
+  free(pp->refs);
+  free(pp->decls);
+  free(pp->scopes);
+  memset(pp, 0, sizeof(*pp));
+}
+
+bool sv_preparse_params(sv_preparse_t *pp) {
+  if (pp->failed || pp_next(pp) != TOK_LPAREN) return false;
+  pp_params(pp, 0);
+  return !pp->failed && pp_next(pp) == TOK_LBRACE;
+}
+
+bool sv_preparse_body(sv_preparse_t *pp) {
+  if (!pp->failed) pp_seq(pp, PP_BODY, 0);
+  if (!pp->failed) pp_scope_close(pp);
+  return !pp->failed;
+}
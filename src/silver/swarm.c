@@ -5,6 +5,7 @@
 #include "silver/engine.h"
 #include "silver/opcode.h"
 #include "ops/globals.h"
+#include "modules/buffer.h"
 
 #include "internal.h"
 #include "debug.h"
@@ -15,6 +16,8 @@
 #include <mir.h>
 #include <mir-gen.h>
 #pragma GCC diagnostic pop
+#include <uv.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -23,19 +26,91 @@
 
 static constexpr int JIT_PARAM_HOIST_CAP = 8;
 static constexpr uint32_t JIT_HOT_COMPILE_BACKEDGE_THRESHOLD = SV_JIT_OSR_THRESHOLD / 8;
+static constexpr int JIT_OSR_WHOLE_FUNC_MAX_BYTES = 512;
+
+static constexpr size_t JIT_CODE_BYTES_PER_INSN = 16;
+static constexpr size_t JIT_SPACE_MIN_SEAL_BYTES = 256 * 1024;
+static constexpr size_t JIT_DEFAULT_CODE_BUDGET_KB = 64 * 1024;
+static constexpr uint32_t JIT_BUILDER_RECYCLE_MODULES = 512;
+
+// MIR only gives machine code back when a whole context is finished, so
+// compiled functions are packed into code spaces that are filled until
+// they reach the seal size. a sealed space is finished once every function
+// compiled into it has been evicted, recompiled or collected
+typedef struct sv_jit_space {
+  struct sv_jit_space *next;
+  MIR_context_t ctx;
+  size_t code_bytes;
+  uint32_t live;
+  uint32_t inflight;
+  bool hot;
+  bool sealed;
+} sv_jit_space_t;
+
+// ownership record for one installed function; func->jit_owner points back
+// here while func->jit_code is the code this record accounts for. loop
+// units are accounted the same way through loop->owner and loop->code
+typedef struct sv_jit_code {
+  struct sv_jit_code *prev;
+  struct sv_jit_code *next;
+  sv_func_t *func;
+  sv_jit_loop_unit_t *loop;
+  sv_jit_space_t *space;
+  void *code;
+  size_t bytes;
+} sv_jit_code_t;
+
+// a finished MIR module handed to the compiler thread, and later the code
+// it produced, waiting for the JS thread to install it
+typedef struct sv_jit_job {
+  struct sv_jit_job *next;
+  sv_func_t *func;
+  sv_jit_space_t *space;
+  uint8_t *mir;
+  size_t mir_len;
+  size_t code_bytes;
+  sv_jit_func_t code;
+  uint64_t compile_ns;
+  uint32_t tfb_ver;
+  char fname[128];
+} sv_jit_job_t;
 
 typedef struct {
-  MIR_context_t ctx;
-  MIR_context_t ctx_hot;
-  bool externals_loaded;
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  
+  sv_jit_job_t *pending_head;
+  sv_jit_job_t *pending_tail;
+  sv_jit_job_t *done;
+  
+  uint32_t depth;
+  bool has_done;
+  bool stop;
+  
+  sv_jit_stats_t stats;
+} sv_jit_worker_t;
+
+typedef struct {
+  MIR_context_t builder;
+  MIR_context_t stub_ctx;
+  sv_jit_worker_t *worker;
+  
+  sv_jit_space_t *spaces;
+  sv_jit_space_t *open[3];
+  sv_jit_code_t *code_head;
+  sv_jit_code_t *code_tail;
+  
+  size_t code_bytes;
+  size_t budget;
+  size_t seal_bytes;
+  uint32_t builder_modules;
+  
+  sv_jit_code_stats_t stats;
 } sv_jit_ctx_t;
 
-static void jit_load_externals_once(sv_jit_ctx_t *jc) {
-  if (jc == NULL || jc->externals_loaded) return;
-#define LOAD_EXT(name) do { \
-    MIR_load_external(jc->ctx, #name, name); \
-    MIR_load_external(jc->ctx_hot, #name, name); \
-  } while (0)
+static void jit_load_externals(MIR_context_t ctx) {
+#define LOAD_EXT(name) MIR_load_external(ctx, #name, name)
   LOAD_EXT(jit_helper_add);
   LOAD_EXT(jit_helper_sub);
   LOAD_EXT(jit_helper_mul);
@@ -72,6 +147,7 @@ static void jit_load_externals_once(sv_jit_ctx_t *jc) {
   LOAD_EXT(jit_helper_to_propkey);
   LOAD_EXT(js_template_to_string);
   LOAD_EXT(jit_helper_bailout_resume);
+  LOAD_EXT(jit_helper_loop_exit);
   LOAD_EXT(jit_helper_close_upval);
   LOAD_EXT(jit_helper_upval_barrier);
   LOAD_EXT(jit_helper_adopt_open_upvalues);
@@ -123,7 +199,459 @@ static void jit_load_externals_once(sv_jit_ctx_t *jc) {
   LOAD_EXT(jit_helper_stack_overflow_error);
   LOAD_EXT(jit_helper_normalize_sloppy_this);
 #undef LOAD_EXT
-  jc->externals_loaded = true;
+}
+
+static MIR_context_t jit_new_context(int optimize_level) {
+  MIR_context_t ctx = MIR_init();
+  MIR_gen_init(ctx);
+  MIR_gen_set_optimize_level(ctx, optimize_level);
+  jit_load_externals(ctx);
+  return ctx;
+}
+
+static void jit_free_context(MIR_context_t ctx) {
+  if (!ctx) return;
+  MIR_gen_finish(ctx);
+  MIR_finish(ctx);
+}
+
+// MIR's binary writer and reader take a bare byte callback, so each thread
+// streams through its own buffer
+static _Thread_local struct {
+  uint8_t *buf;
+  size_t len;
+  size_t cap;
+  bool oom;
+} jit_mir_out;
+
+static _Thread_local struct {
+  const uint8_t *buf;
+  size_t len;
+  size_t pos;
+} jit_mir_in;
+
+static int jit_mir_write_byte(MIR_context_t ctx, uint8_t byte) {
+  (void)ctx;
+  if (jit_mir_out.oom) return 0;
+  if (jit_mir_out.len == jit_mir_out.cap) {
+    size_t cap = jit_mir_out.cap ? jit_mir_out.cap * 2 : 4096;
+    uint8_t *buf = realloc(jit_mir_out.buf, cap);
+    if (!buf) { jit_mir_out.oom = true; return 0; }
+    jit_mir_out.buf = buf;
+    jit_mir_out.cap = cap;
+  }
+  jit_mir_out.buf[jit_mir_out.len++] = byte;
+  return 1;
+}
+
+static int jit_mir_read_byte(MIR_context_t ctx) {
+  (void)ctx;
+  if (jit_mir_in.pos >= jit_mir_in.len) return EOF;
+  return jit_mir_in.buf[jit_mir_in.pos++];
+}
+
+static MIR_item_t jit_find_func_item(MIR_module_t mod, const char *name) {
+  for (
+    MIR_item_t item = DLIST_HEAD(MIR_item_t, mod->items);
+    item; item = DLIST_NEXT(MIR_item_t, item)
+  ) if (item->item_type == MIR_func_item && strcmp(item->u.func->name, name) == 0) return item;
+  return NULL;
+}
+
+static void jit_worker_compile(sv_jit_job_t *job) {
+  MIR_context_t ctx = job->space->ctx;
+  uint64_t start = uv_hrtime();
+
+  jit_mir_in.buf = job->mir;
+  jit_mir_in.len = job->mir_len;
+  jit_mir_in.pos = 0;
+  MIR_read_with_func(ctx, jit_mir_read_byte);
+
+  MIR_module_t mod = DLIST_TAIL(MIR_module_t, *MIR_get_module_list(ctx));
+  MIR_item_t item = mod ? jit_find_func_item(mod, job->fname) : NULL;
+  
+  if (item) {
+    MIR_load_module(ctx, mod);
+    MIR_link(ctx, MIR_set_gen_interface, NULL);
+    job->code = MIR_gen(ctx, item);
+  }
+
+  job->compile_ns = uv_hrtime() - start;
+  free(job->mir);
+  job->mir = NULL;
+}
+
+static void *jit_worker_main(void *arg) {
+  sv_jit_worker_t *w = arg;
+  pthread_mutex_lock(&w->lock);
+
+  for (;;) {
+    while (!w->stop && !w->pending_head) pthread_cond_wait(&w->wake, &w->lock);
+    if (w->stop) break;
+
+    sv_jit_job_t *job = w->pending_head;
+    w->pending_head = job->next;
+    if (!w->pending_head) w->pending_tail = NULL;
+    pthread_mutex_unlock(&w->lock);
+
+    jit_worker_compile(job);
+
+    pthread_mutex_lock(&w->lock);
+    job->next = w->done;
+    w->done = job;
+    w->stats.compile_ns += job->compile_ns;
+    if (job->compile_ns > w->stats.max_compile_ns) w->stats.max_compile_ns = job->compile_ns;
+    __atomic_store_n(&w->has_done, true, __ATOMIC_RELEASE);
+  }
+
+  pthread_mutex_unlock(&w->lock);
+  free(jit_mir_out.buf);
+  return NULL;
+}
+
+static void jit_worker_free_jobs(sv_jit_job_t *job) {
+  while (job) {
+    sv_jit_job_t *next = job->next;
+    free(job->mir);
+    free(job);
+    job = next;
+  }
+}
+
+static void jit_worker_release(sv_jit_worker_t *w) {
+  jit_worker_free_jobs(w->pending_head);
+  jit_worker_free_jobs(w->done);
+  
+  pthread_cond_destroy(&w->wake);
+  pthread_mutex_destroy(&w->lock);
+  free(w);
+}
+
+static sv_jit_worker_t *jit_worker_start(void) {
+  if (sv_debug_enabled(SV_DEBUG_JIT_SYNC)) return NULL;
+  
+  sv_jit_worker_t *w = calloc(1, sizeof(*w));
+  if (!w) return NULL;
+
+  pthread_mutex_init(&w->lock, NULL);
+  pthread_cond_init(&w->wake, NULL);
+  w->stats.background = true;
+  
+  if (pthread_create(&w->thread, NULL, jit_worker_main, w) != 0) {
+    jit_worker_release(w);
+    return NULL;
+  }
+  
+  return w;
+}
+
+static void jit_worker_stop(sv_jit_worker_t *w) {
+  if (!w) return;
+  
+  pthread_mutex_lock(&w->lock);
+  w->stop = true;
+  pthread_cond_signal(&w->wake);
+  pthread_mutex_unlock(&w->lock);
+  
+  pthread_join(w->thread, NULL);
+  jit_worker_release(w);
+}
+
+// open[JIT_SPACE_LOOP] holds loop units compiled on the JS thread while the
+// worker owns the other open spaces, a MIR context is never shared between
+// the two threads
+enum { JIT_SPACE_WARM = 0, JIT_SPACE_HOT = 1, JIT_SPACE_LOOP = 2 };
+
+static sv_jit_space_t *jit_space_open(sv_jit_ctx_t *jc, int slot, bool hot) {
+  sv_jit_space_t *space = jc->open[slot];
+  if (space && space->code_bytes < jc->seal_bytes) return space;
+  if (space) space->sealed = true;
+
+  space = calloc(1, sizeof(*space));
+  if (!space) return NULL;
+
+  space->ctx = jit_new_context(hot ? 3 : 1);
+  space->hot = hot;
+  space->next = jc->spaces;
+  
+  jc->spaces = space;
+  jc->open[slot] = space;
+  
+  return space;
+}
+
+static sv_jit_space_t *jit_space_for(sv_jit_ctx_t *jc, bool hot) {
+  return jit_space_open(jc, hot ? JIT_SPACE_HOT : JIT_SPACE_WARM, hot);
+}
+
+// finishing a context unmaps its code, so this only runs with no JIT frame
+// on the native stack
+static void jit_spaces_reclaim(ant_t *js, sv_jit_ctx_t *jc) {
+  if (js->jit_active_depth > 0) return;
+  
+  for (sv_jit_space_t **pp = &jc->spaces; *pp;) {
+    sv_jit_space_t *space = *pp;
+    if (!space->sealed || space->live || space->inflight) {
+      pp = &space->next;
+      continue;
+    }
+    
+    *pp = space->next;
+    jc->stats.reclaimed_spaces++;
+    jc->stats.reclaimed_bytes += space->code_bytes;
+    
+    jit_free_context(space->ctx);
+    free(space);
+  }
+}
+
+static void jit_code_drop(sv_jit_ctx_t *jc, sv_jit_code_t *rec) {
+  if (rec->prev) rec->prev->next = rec->next;
+  else jc->code_head = rec->next;
+  
+  if (rec->next) rec->next->prev = rec->prev;
+  else jc->code_tail = rec->prev;
+  
+  if (rec->loop && rec->loop->owner == rec) rec->loop->owner = NULL;
+  else if (!rec->loop && rec->func->jit_owner == rec) rec->func->jit_owner = NULL;
+  rec->space->live--;
+  jc->code_bytes -= rec->bytes;
+  free(rec);
+}
+
+// sends a function back to the interpreter; it compiles again, into
+// whichever space is open by then, if it gets hot again
+static void jit_code_evict(sv_jit_ctx_t *jc, sv_jit_code_t *rec) {
+  sv_func_t *func = rec->func;
+  
+  if (rec->loop) {
+    if (rec->loop->code == rec->code) {
+      rec->loop->code = NULL;
+      rec->loop->start = -1;
+    }
+  } else if (func->jit_code == rec->code) {
+    func->jit_code = NULL;
+    func->jit_compiled_tfb_ver = 0;
+    func->call_count = 0;
+    func->back_edge_count = 0;
+  }
+  
+  jit_code_drop(jc, rec);
+}
+
+static inline bool jit_code_current(const sv_jit_code_t *rec) {
+  if (rec->loop) return rec->loop->code == rec->code;
+  return rec->func->jit_code == rec->code;
+}
+
+static bool jit_code_install(
+  sv_jit_ctx_t *jc, sv_func_t *func, sv_jit_loop_unit_t *loop,
+  sv_jit_space_t *space, void *code, size_t bytes
+) {
+  sv_jit_code_t *rec = calloc(1, sizeof(*rec));
+  if (!rec) return false;
+  
+  void *owner = loop ? loop->owner : func->jit_owner;
+  if (owner) jit_code_drop(jc, owner);
+
+  rec->func = func;
+  rec->loop = loop;
+  rec->space = space;
+  rec->code = code;
+  rec->bytes = bytes;
+  rec->prev = jc->code_tail;
+  
+  if (jc->code_tail) jc->code_tail->next = rec;
+  else jc->code_head = rec;
+  jc->code_tail = rec;
+  
+  if (loop) {
+    loop->owner = rec;
+    loop->code = code;
+  } else {
+    func->jit_owner = rec;
+    func->jit_code = code;
+  }
+  func->jit_used = 1;
+  
+  space->live++;
+  jc->code_bytes += bytes;
+  if (jc->code_bytes > jc->stats.peak_code_bytes) jc->stats.peak_code_bytes = jc->code_bytes;
+  
+  return true;
+}
+
+// second-chance sweep in install order: compiled code sets func->jit_used
+// on every entry, the first pass clears it and evicts what was not entered
+// since the last sweep, the second evicts oldest-first. `keep` is code a
+// caller is about to run
+static void jit_code_enforce_budget(ant_t *js, sv_jit_ctx_t *jc, sv_func_t *keep) {
+  if (jc->code_bytes <= jc->budget) return;
+  size_t target = jc->budget - jc->budget / 4;
+
+  for (int pass = 0; pass < 2 && jc->code_bytes > target; pass++) {
+  for (sv_jit_code_t *rec = jc->code_head, *next; rec && jc->code_bytes > target; rec = next) {
+    next = rec->next;
+    sv_func_t *func = rec->func;
+    
+    if (!jit_code_current(rec)) jit_code_drop(jc, rec);
+    else if (func == keep) continue;
+    else if (pass == 0 && func->jit_used) func->jit_used = 0;
+    else {
+      jc->stats.evicted++;
+      jit_code_evict(jc, rec);
+    }
+  }}
+
+  jit_spaces_reclaim(js, jc);
+}
+
+void sv_jit_gc_sweep(ant_t *js, uint64_t gc_epoch) {
+  sv_jit_ctx_t *jc = js ? js->jit_ctx : NULL;
+  if (!jc) return;
+
+  for (sv_jit_code_t *rec = jc->code_head, *next; rec; rec = next) {
+    next = rec->next;
+    sv_func_t *func = rec->func;
+    
+    if (!jit_code_current(rec)) jit_code_drop(jc, rec);
+    else if (func->gc_epoch != gc_epoch) {
+      jc->stats.collected++;
+      jit_code_evict(jc, rec);
+    }
+  }
+
+  jit_spaces_reclaim(js, jc);
+}
+
+// runs on the JS thread wherever compiled code may be picked up (sv_jit_compile
+// and the call and back-edge paths of a queued function), so a function
+// only ever switches to its new code between bytecode ops
+static void jit_install_ready(ant_t *js, sv_jit_ctx_t *jc) {
+  sv_jit_worker_t *w = jc ? jc->worker : NULL;
+  if (!w || !__atomic_load_n(&w->has_done, __ATOMIC_ACQUIRE)) return;
+
+  pthread_mutex_lock(&w->lock);
+  sv_jit_job_t *job = w->done;
+  w->done = NULL;
+  __atomic_store_n(&w->has_done, false, __ATOMIC_RELAXED);
+  
+  for (sv_jit_job_t *it = job; it; it = it->next) {
+    w->depth--;
+    if (it->code) w->stats.installed++;
+    else w->stats.failed++;
+  }
+  pthread_mutex_unlock(&w->lock);
+
+  while (job) {
+    sv_jit_job_t *next = job->next;
+    sv_func_t *func = job->func;
+    
+    func->jit_compiling = false;
+    job->space->inflight--;
+    
+    if (job->code && jit_code_install(jc, func, NULL, job->space, (void *)job->code, job->code_bytes))
+      func->jit_compiled_tfb_ver = job->tfb_ver;
+    else func->jit_compile_failed = true;
+    
+    free(job);
+    job = next;
+  }
+
+  jit_code_enforce_budget(js, jc, NULL);
+}
+
+static bool jit_enqueue(
+  sv_jit_ctx_t *jc, MIR_context_t ctx, MIR_module_t mod,
+  sv_func_t *func, const char *fname, bool hot, size_t code_bytes
+) {
+  sv_jit_worker_t *w = jc->worker;
+  sv_jit_space_t *space = jit_space_for(jc, hot);
+  if (!space) return false;
+  
+  sv_jit_job_t *job = calloc(1, sizeof(*job));
+  if (!job) return false;
+
+  jit_mir_out.len = 0;
+  jit_mir_out.oom = false;
+  MIR_write_module_with_func(ctx, jit_mir_write_byte, mod);
+  
+  if (jit_mir_out.oom || !(job->mir = malloc(jit_mir_out.len))) {
+    free(job);
+    return false;
+  }
+
+  memcpy(job->mir, jit_mir_out.buf, jit_mir_out.len);
+  job->mir_len = jit_mir_out.len;
+  job->func = func;
+  job->space = space;
+  job->code_bytes = code_bytes;
+  job->tfb_ver = func->tfb_version;
+  snprintf(job->fname, sizeof(job->fname), "%s", fname);
+  
+  space->inflight++;
+  space->code_bytes += code_bytes;
+
+  pthread_mutex_lock(&w->lock);
+  if (w->pending_tail) w->pending_tail->next = job;
+  else w->pending_head = job;
+  
+  w->pending_tail = job;
+  w->depth++;
+  w->stats.queued++;
+  
+  pthread_cond_signal(&w->wake);
+  pthread_mutex_unlock(&w->lock);
+  
+  return true;
+}
+
+// in background mode modules are only built here and then serialized, so
+// the builder context is recycled now and then to drop the names and
+// prototypes MIR keeps interning
+static MIR_context_t jit_builder_context(sv_jit_ctx_t *jc) {
+  if (jc->builder && jc->builder_modules >= JIT_BUILDER_RECYCLE_MODULES) {
+    jit_free_context(jc->builder);
+    jc->builder = NULL;
+  }
+  
+  if (!jc->builder) {
+    jc->builder = jit_new_context(1);
+    jc->builder_modules = 0;
+  }
+  
+  jc->builder_modules++;
+  return jc->builder;
+}
+
+sv_jit_stats_t sv_jit_stats(ant_t *js) {
+  sv_jit_ctx_t *jc = js ? js->jit_ctx : NULL;
+  sv_jit_worker_t *w = jc ? jc->worker : NULL;
+  if (!w) return (sv_jit_stats_t){0};
+
+  pthread_mutex_lock(&w->lock);
+  sv_jit_stats_t stats = w->stats;
+  stats.depth = w->depth;
+  pthread_mutex_unlock(&w->lock);
+  
+  return stats;
+}
+
+sv_jit_code_stats_t sv_jit_code_stats(ant_t *js) {
+  sv_jit_ctx_t *jc = js ? js->jit_ctx : NULL;
+  if (!jc) return (sv_jit_code_stats_t){0};
+
+  sv_jit_code_stats_t stats = jc->stats;
+  stats.code_bytes = jc->code_bytes;
+  stats.budget = jc->budget;
+  
+  for (sv_jit_code_t *rec = jc->code_head; rec; rec = rec->next) stats.functions++;
+  for (sv_jit_space_t *space = jc->spaces; space; space = space->next) {
+    stats.spaces++;
+    stats.resident_bytes += space->code_bytes;
+  }
+  
+  return stats;
 }
 
 void sv_jit_init(ant_t *js) {
@@ -132,15 +660,15 @@ void sv_jit_init(ant_t *js) {
   sv_jit_ctx_t *jc = calloc(1, sizeof(*jc));
   if (!jc) return;
 
-  jc->ctx = MIR_init();
-  MIR_gen_init(jc->ctx);
-  MIR_gen_set_optimize_level(jc->ctx, 1);
-
-  jc->ctx_hot = MIR_init();
-  MIR_gen_init(jc->ctx_hot);
-  MIR_gen_set_optimize_level(jc->ctx_hot, 3);
-
-  jit_load_externals_once(jc);
+  size_t budget_kb = sv_jit_code_budget_kb > 0 
+    ? (size_t)sv_jit_code_budget_kb 
+    : JIT_DEFAULT_CODE_BUDGET_KB;
+  
+  jc->budget = budget_kb * 1024;
+  jc->seal_bytes = jc->budget / 16;
+  if (jc->seal_bytes < JIT_SPACE_MIN_SEAL_BYTES) jc->seal_bytes = JIT_SPACE_MIN_SEAL_BYTES;
+  
+  jc->worker = jit_worker_start();
   js->jit_ctx = jc;
 }
 
@@ -148,15 +676,49 @@ void sv_jit_destroy(ant_t *js) {
   sv_jit_ctx_t *jc = js->jit_ctx;
   if (!jc) return;
   
-  MIR_gen_finish(jc->ctx);
-  MIR_finish(jc->ctx);
-  MIR_gen_finish(jc->ctx_hot);
-  MIR_finish(jc->ctx_hot);
+  jit_worker_stop(jc->worker);
+  
+  for (sv_jit_code_t *rec = jc->code_head, *next; rec; rec = next) {
+    next = rec->next;
+    if (rec->loop) {
+      rec->loop->code = NULL;
+      rec->loop->owner = NULL;
+      rec->loop->start = -1;
+    } else {
+      rec->func->jit_code = NULL;
+      rec->func->jit_owner = NULL;
+    }
+    free(rec);
+  }
+  
+  for (sv_jit_space_t *space = jc->spaces, *next; space; space = next) {
+    next = space->next;
+    jit_free_context(space->ctx);
+    free(space);
+  }
+  
+  jit_free_context(jc->builder);
+  jit_free_context(jc->stub_ctx);
+  
+  free(jit_mir_out.buf);
+  jit_mir_out.buf = NULL;
+  jit_mir_out.cap = 0;
   
   free(jc);
   js->jit_ctx = NULL;
 }
 
+// FFI stubs live as long as their FFIFunction, so they get a context of
+// their own outside the code budget
+MIR_context_t sv_jit_stub_context(ant_t *js) {
+  sv_jit_init(js);
+  sv_jit_ctx_t *jc = js->jit_ctx;
+  if (!jc) return NULL;
+  
+  if (!jc->stub_ctx) jc->stub_ctx = jit_new_context(3);
+  return jc->stub_ctx;
+}
+
 typedef struct {
   MIR_reg_t *regs;        
   MIR_reg_t *d_regs;      
@@ -1055,7 +1617,7 @@ static bool jit_upvalue_is_builder_target(sv_func_t *func, uint32_t idx) {
       uint8_t *ip = p->code;
       uint8_t *end = p->code + p->code_len;
       while (ip < end) {
-        sv_op_t op = (sv_op_t)*ip;
+        sv_op_t op = sv_op_base((sv_op_t)*ip);
         int sz = sv_op_size[op];
         if (sz == 0) return true;
         if (ip + sz > end) return true;
@@ -1351,6 +1913,374 @@ static void mir_emit_get_closure(MIR_context_t ctx, MIR_item_t fn,
       MIR_new_uint_op(ctx, NANBOX_DATA_MASK)));
 }
 
+static_assert(sizeof(TypedArrayType) == sizeof(uint32_t), "typed array kind is loaded as a u32");
+
+// Float16 and the BigInt kinds need a conversion call either way, so they and
+// DataView accessors stay on the C element fast path. The detached check in
+// mir_emit_typed_elem_addr runs per access: detaching zeroes the buffer, not
+// the view length, and nothing hoists it out of loops
+static bool jit_typed_elem_inlinable(uint8_t elem_kind) {
+  if (elem_kind == SV_TFB_ELEM_NONE || elem_kind >= SV_TFB_ELEM_GENERIC) return false;
+  switch ((TypedArrayType)(elem_kind - 1)) {
+    case TYPED_ARRAY_INT8:
+    case TYPED_ARRAY_UINT8:
+    case TYPED_ARRAY_INT16:
+    case TYPED_ARRAY_UINT16:
+    case TYPED_ARRAY_INT32:
+    case TYPED_ARRAY_UINT32:
+    case TYPED_ARRAY_UINT8_CLAMPED:
+    case TYPED_ARRAY_FLOAT32:
+    case TYPED_ARRAY_FLOAT64:       return true;
+    default:                        return false;
+  }
+}
+
+static MIR_type_t jit_typed_elem_mem_type(TypedArrayType type, int *scale) {
+  switch (type) {
+    case TYPED_ARRAY_INT8:          *scale = 1; return MIR_T_I8;
+    case TYPED_ARRAY_UINT8:
+    case TYPED_ARRAY_UINT8_CLAMPED: *scale = 1; return MIR_T_U8;
+    case TYPED_ARRAY_INT16:         *scale = 2; return MIR_T_I16;
+    case TYPED_ARRAY_UINT16:        *scale = 2; return MIR_T_U16;
+    case TYPED_ARRAY_INT32:         *scale = 4; return MIR_T_I32;
+    case TYPED_ARRAY_UINT32:        *scale = 4; return MIR_T_U32;
+    case TYPED_ARRAY_FLOAT32:       *scale = 4; return MIR_T_F;
+    default:                        *scale = 8; return MIR_T_D;
+  }
+}
+
+static void mir_emit_typed_elem_addr(
+  MIR_context_t ctx, MIR_item_t fn,
+  MIR_reg_t obj, MIR_reg_t key, MIR_reg_t key_d, bool key_is_num,
+  TypedArrayType type, MIR_reg_t base, MIR_reg_t idx,
+  MIR_label_t slow, MIR_reg_t r_d_slot, int owner_id, int bc_off
+) {
+  char tag_name[48], off_name[48], kd_name[48], chk_name[48];
+  snprintf(tag_name, sizeof(tag_name), "te_tag_%d_%d", owner_id, bc_off);
+  snprintf(off_name, sizeof(off_name), "te_off_%d_%d", owner_id, bc_off);
+  snprintf(kd_name, sizeof(kd_name), "te_kd_%d_%d", owner_id, bc_off);
+  snprintf(chk_name, sizeof(chk_name), "te_chk_%d_%d", owner_id, bc_off);
+  MIR_reg_t tag = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, tag_name);
+  MIR_reg_t off = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, off_name);
+  MIR_reg_t chk = MIR_new_func_reg(ctx, fn->u.func, MIR_T_D, chk_name);
+  MIR_reg_t kd = key_d;
+
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_URSH,
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_reg_op(ctx, obj),
+      MIR_new_uint_op(ctx, NANBOX_TYPE_SHIFT)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_BNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_uint_op(ctx, NANBOX_TOBJ_TAG)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_AND,
+      MIR_new_reg_op(ctx, base),
+      MIR_new_reg_op(ctx, obj),
+      MIR_new_uint_op(ctx, NANBOX_DATA_MASK)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_mem_op(ctx, MIR_T_U32,
+        (MIR_disp_t)offsetof(ant_object_t, native.tag), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_BNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_uint_op(ctx, BUFFER_TYPEDARRAY_NATIVE_TAG)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, base),
+      MIR_new_mem_op(ctx, MIR_T_I64,
+        (MIR_disp_t)offsetof(ant_object_t, native.ptr), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_mem_op(ctx, MIR_T_U32,
+        (MIR_disp_t)offsetof(TypedArrayData, type), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_BNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_uint_op(ctx, (uint64_t)type)));
+
+  if (!key_is_num) {
+    kd = MIR_new_func_reg(ctx, fn->u.func, MIR_T_D, kd_name);
+    mir_emit_is_num_guard(ctx, fn, tag, key, slow);
+    mir_i64_to_d(ctx, fn, kd, key, r_d_slot);
+  }
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_D2I,
+      MIR_new_reg_op(ctx, idx),
+      MIR_new_reg_op(ctx, kd)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_I2D,
+      MIR_new_reg_op(ctx, chk),
+      MIR_new_reg_op(ctx, idx)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_DBNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, chk),
+      MIR_new_reg_op(ctx, kd)));
+
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_mem_op(ctx, MIR_T_U64,
+        (MIR_disp_t)offsetof(TypedArrayData, length), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_UBGE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, idx),
+      MIR_new_reg_op(ctx, tag)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, off),
+      MIR_new_mem_op(ctx, MIR_T_U64,
+        (MIR_disp_t)offsetof(TypedArrayData, byte_offset), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, base),
+      MIR_new_mem_op(ctx, MIR_T_I64,
+        (MIR_disp_t)offsetof(TypedArrayData, buffer), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_BEQ,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, base),
+      MIR_new_uint_op(ctx, 0)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_mem_op(ctx, MIR_T_I32,
+        (MIR_disp_t)offsetof(ArrayBufferData, is_detached), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_BNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, tag),
+      MIR_new_uint_op(ctx, 0)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, base),
+      MIR_new_mem_op(ctx, MIR_T_I64,
+        (MIR_disp_t)offsetof(ArrayBufferData, data), base, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_ADD,
+      MIR_new_reg_op(ctx, base),
+      MIR_new_reg_op(ctx, base),
+      MIR_new_reg_op(ctx, off)));
+}
+
+static void mir_emit_typed_elem_load(
+  MIR_context_t ctx, MIR_item_t fn,
+  MIR_reg_t obj, MIR_reg_t key, MIR_reg_t key_d, bool key_is_num,
+  TypedArrayType type, MIR_reg_t dst,
+  MIR_label_t slow, MIR_reg_t r_d_slot, int owner_id, int bc_off
+) {
+  char base_name[48], idx_name[48], val_name[48], vd_name[48], vf_name[48];
+  snprintf(base_name, sizeof(base_name), "te_base_%d_%d", owner_id, bc_off);
+  snprintf(idx_name, sizeof(idx_name), "te_idx_%d_%d", owner_id, bc_off);
+  snprintf(val_name, sizeof(val_name), "te_val_%d_%d", owner_id, bc_off);
+  snprintf(vd_name, sizeof(vd_name), "te_vd_%d_%d", owner_id, bc_off);
+  snprintf(vf_name, sizeof(vf_name), "te_vf_%d_%d", owner_id, bc_off);
+  MIR_reg_t base = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, base_name);
+  MIR_reg_t idx = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, idx_name);
+  MIR_reg_t vd = MIR_new_func_reg(ctx, fn->u.func, MIR_T_D, vd_name);
+
+  mir_emit_typed_elem_addr(ctx, fn, obj, key, key_d, key_is_num,
+    type, base, idx, slow, r_d_slot, owner_id, bc_off);
+
+  int scale = 1;
+  MIR_type_t mtype = jit_typed_elem_mem_type(type, &scale);
+  MIR_op_t elem = MIR_new_mem_op(ctx, mtype, 0, base, idx, (uint8_t)scale);
+
+  if (type == TYPED_ARRAY_FLOAT64 || type == TYPED_ARRAY_FLOAT32) {
+    MIR_label_t ordered = MIR_new_label(ctx);
+    if (type == TYPED_ARRAY_FLOAT64) {
+      MIR_append_insn(ctx, fn,
+        MIR_new_insn(ctx, MIR_DMOV, MIR_new_reg_op(ctx, vd), elem));
+    } else {
+      MIR_reg_t vf = MIR_new_func_reg(ctx, fn->u.func, MIR_T_F, vf_name);
+      MIR_append_insn(ctx, fn,
+        MIR_new_insn(ctx, MIR_FMOV, MIR_new_reg_op(ctx, vf), elem));
+      MIR_append_insn(ctx, fn,
+        MIR_new_insn(ctx, MIR_F2D,
+          MIR_new_reg_op(ctx, vd),
+          MIR_new_reg_op(ctx, vf)));
+    }
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DBEQ,
+        MIR_new_label_op(ctx, ordered),
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_reg_op(ctx, vd)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DMOV,
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_double_op(ctx, JS_NAN)));
+    MIR_append_insn(ctx, fn, ordered);
+  } else {
+    MIR_reg_t val = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, val_name);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV, MIR_new_reg_op(ctx, val), elem));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_I2D,
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_reg_op(ctx, val)));
+  }
+
+  mir_d_to_i64(ctx, fn, dst, vd, r_d_slot);
+}
+
+static void mir_emit_typed_elem_store(
+  MIR_context_t ctx, MIR_item_t fn,
+  MIR_reg_t obj, MIR_reg_t key, MIR_reg_t key_d, bool key_is_num,
+  MIR_reg_t val, MIR_reg_t val_d, bool val_is_num,
+  TypedArrayType type, MIR_label_t slow,
+  MIR_reg_t r_d_slot, int owner_id, int bc_off
+) {
+  char base_name[48], idx_name[48], iv_name[48], vd_name[48], vf_name[48];
+  char frac_name[48], odd_name[48];
+  snprintf(base_name, sizeof(base_name), "te_base_%d_%d", owner_id, bc_off);
+  snprintf(idx_name, sizeof(idx_name), "te_idx_%d_%d", owner_id, bc_off);
+  snprintf(iv_name, sizeof(iv_name), "te_iv_%d_%d", owner_id, bc_off);
+  snprintf(frac_name, sizeof(frac_name), "te_frac_%d_%d", owner_id, bc_off);
+  snprintf(odd_name, sizeof(odd_name), "te_odd_%d_%d", owner_id, bc_off);
+  snprintf(vd_name, sizeof(vd_name), "te_vd_%d_%d", owner_id, bc_off);
+  snprintf(vf_name, sizeof(vf_name), "te_vf_%d_%d", owner_id, bc_off);
+  MIR_reg_t base = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, base_name);
+  MIR_reg_t idx = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, idx_name);
+  MIR_reg_t vd = val_d;
+
+  if (!val_is_num) {
+    vd = MIR_new_func_reg(ctx, fn->u.func, MIR_T_D, vd_name);
+    mir_emit_is_num_guard(ctx, fn, base, val, slow);
+    mir_i64_to_d(ctx, fn, vd, val, r_d_slot);
+  }
+
+  mir_emit_typed_elem_addr(ctx, fn, obj, key, key_d, key_is_num,
+    type, base, idx, slow, r_d_slot, owner_id, bc_off);
+
+  int scale = 1;
+  MIR_type_t mtype = jit_typed_elem_mem_type(type, &scale);
+  MIR_op_t elem = MIR_new_mem_op(ctx, mtype, 0, base, idx, (uint8_t)scale);
+
+  if (type == TYPED_ARRAY_FLOAT64) {
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DMOV, elem, MIR_new_reg_op(ctx, vd)));
+    return;
+  }
+
+  if (type == TYPED_ARRAY_FLOAT32) {
+    MIR_reg_t vf = MIR_new_func_reg(ctx, fn->u.func, MIR_T_F, vf_name);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_D2F,
+        MIR_new_reg_op(ctx, vf),
+        MIR_new_reg_op(ctx, vd)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_FMOV, elem, MIR_new_reg_op(ctx, vf)));
+    return;
+  }
+
+  MIR_reg_t iv = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, iv_name);
+
+  // same as typedarray_to_uint8_clamped: NaN and non-positive values store 0,
+  // 255 and above store 255, the rest round half to even
+  if (type == TYPED_ARRAY_UINT8_CLAMPED) {
+    MIR_reg_t frac = MIR_new_func_reg(ctx, fn->u.func, MIR_T_D, frac_name);
+    MIR_reg_t odd = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, odd_name);
+    MIR_label_t round_up = MIR_new_label(ctx);
+    MIR_label_t store = MIR_new_label(ctx);
+
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV, MIR_new_reg_op(ctx, iv), MIR_new_int_op(ctx, 0)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DBNE,
+        MIR_new_label_op(ctx, store),
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_reg_op(ctx, vd)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DBLE,
+        MIR_new_label_op(ctx, store),
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_double_op(ctx, 0.0)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV, MIR_new_reg_op(ctx, iv), MIR_new_int_op(ctx, 255)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DBGE,
+        MIR_new_label_op(ctx, store),
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_double_op(ctx, 255.0)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_D2I,
+        MIR_new_reg_op(ctx, iv),
+        MIR_new_reg_op(ctx, vd)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_I2D,
+        MIR_new_reg_op(ctx, frac),
+        MIR_new_reg_op(ctx, iv)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DSUB,
+        MIR_new_reg_op(ctx, frac),
+        MIR_new_reg_op(ctx, vd),
+        MIR_new_reg_op(ctx, frac)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DBLT,
+        MIR_new_label_op(ctx, store),
+        MIR_new_reg_op(ctx, frac),
+        MIR_new_double_op(ctx, 0.5)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_DBGT,
+        MIR_new_label_op(ctx, round_up),
+        MIR_new_reg_op(ctx, frac),
+        MIR_new_double_op(ctx, 0.5)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_AND,
+        MIR_new_reg_op(ctx, odd),
+        MIR_new_reg_op(ctx, iv),
+        MIR_new_int_op(ctx, 1)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_BEQ,
+        MIR_new_label_op(ctx, store),
+        MIR_new_reg_op(ctx, odd),
+        MIR_new_int_op(ctx, 0)));
+    MIR_append_insn(ctx, fn, round_up);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_ADD,
+        MIR_new_reg_op(ctx, iv),
+        MIR_new_reg_op(ctx, iv),
+        MIR_new_int_op(ctx, 1)));
+    MIR_append_insn(ctx, fn, store);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV, elem, MIR_new_reg_op(ctx, iv)));
+    return;
+  }
+
+  // integer kinds store the low bits of ToInt32; NaN, infinities and values
+  // outside +-2^53 need the exact modulo in js_to_int32, so leave them to C
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_DBNE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, vd),
+      MIR_new_reg_op(ctx, vd)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_DBGE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, vd),
+      MIR_new_double_op(ctx, 9007199254740992.0)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_DBLE,
+      MIR_new_label_op(ctx, slow),
+      MIR_new_reg_op(ctx, vd),
+      MIR_new_double_op(ctx, -9007199254740992.0)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_D2I,
+      MIR_new_reg_op(ctx, iv),
+      MIR_new_reg_op(ctx, vd)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV, elem, MIR_new_reg_op(ctx, iv)));
+}
+
 static void mir_emit_resolve_call_this(MIR_context_t ctx, MIR_item_t fn,
                                        MIR_reg_t dst, MIR_reg_t r_closure,
                                        MIR_reg_t fallback_this,
@@ -1395,6 +2325,80 @@ static void mir_emit_resolve_call_this(MIR_context_t ctx, MIR_item_t fn,
   MIR_append_insn(ctx, fn, done);
 }
 
+static void mir_emit_native_stub_call(
+  MIR_context_t ctx, MIR_item_t fn, MIR_item_t stub_proto,
+  MIR_reg_t r_js, MIR_reg_t r_closure, MIR_reg_t r_func_val,
+  MIR_reg_t r_this_val, MIR_reg_t r_args, int argc, MIR_reg_t dst,
+  MIR_reg_t r_stub, MIR_reg_t r_saved_fn, MIR_reg_t r_saved_this,
+  MIR_label_t fallback, MIR_label_t done
+) {
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_stub),
+      MIR_new_mem_op(ctx, MIR_T_U32,
+        (MIR_disp_t)offsetof(sv_closure_t, call_flags),
+        r_closure, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_AND,
+      MIR_new_reg_op(ctx, r_stub),
+      MIR_new_reg_op(ctx, r_stub),
+      MIR_new_uint_op(ctx, SV_CALL_HAS_NATIVE_STUB)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_BEQ,
+      MIR_new_label_op(ctx, fallback),
+      MIR_new_reg_op(ctx, r_stub),
+      MIR_new_uint_op(ctx, 0)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_stub),
+      MIR_new_mem_op(ctx, MIR_T_P,
+        (MIR_disp_t)offsetof(sv_closure_t, native_stub),
+        r_closure, 0, 1)));
+
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_saved_fn),
+      MIR_new_mem_op(ctx, MIR_JSVAL,
+        (MIR_disp_t)offsetof(ant_t, current_func), r_js, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_saved_this),
+      MIR_new_mem_op(ctx, MIR_JSVAL,
+        (MIR_disp_t)offsetof(ant_t, this_val), r_js, 0, 1)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_mem_op(ctx, MIR_JSVAL,
+        (MIR_disp_t)offsetof(ant_t, current_func), r_js, 0, 1),
+      MIR_new_reg_op(ctx, r_func_val)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_mem_op(ctx, MIR_JSVAL,
+        (MIR_disp_t)offsetof(ant_t, this_val), r_js, 0, 1),
+      MIR_new_reg_op(ctx, r_this_val)));
+
+  MIR_append_insn(ctx, fn,
+    MIR_new_call_insn(ctx, 6,
+      MIR_new_ref_op(ctx, stub_proto),
+      MIR_new_reg_op(ctx, r_stub),
+      MIR_new_reg_op(ctx, dst),
+      MIR_new_reg_op(ctx, r_js),
+      MIR_new_reg_op(ctx, r_args),
+      MIR_new_int_op(ctx, (int64_t)argc)));
+
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_mem_op(ctx, MIR_JSVAL,
+        (MIR_disp_t)offsetof(ant_t, current_func), r_js, 0, 1),
+      MIR_new_reg_op(ctx, r_saved_fn)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_mem_op(ctx, MIR_JSVAL,
+        (MIR_disp_t)offsetof(ant_t, this_val), r_js, 0, 1),
+      MIR_new_reg_op(ctx, r_saved_this)));
+  MIR_append_insn(ctx, fn,
+    MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, done)));
+}
+
 static void mir_emit_value_to_objptr_or_jmp(
   MIR_context_t ctx, MIR_item_t fn,
   MIR_reg_t v, MIR_reg_t out_ptr,
@@ -2379,7 +3383,7 @@ static void scan_osr_entries(sv_func_t *func, osr_entry_map_t *osr) {
   uint8_t *ip  = func->code;
   uint8_t *end = func->code + func->code_len;
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) break;
     int src = (int)(ip - func->code);
@@ -2408,7 +3412,7 @@ static bool func_writes_params(sv_func_t *func) {
   uint8_t *end = func->code + func->code_len;
 
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) break;
     if (ip + sz > end) break;
@@ -2423,7 +3427,7 @@ static bool func_writes_params(sv_func_t *func) {
 }
 
 static sv_func_t *scan_closure_child(sv_func_t *func, uint8_t *ip) {
-  if ((sv_op_t)*ip != OP_CLOSURE) return NULL;
+  if (sv_op_base((sv_op_t)*ip) != OP_CLOSURE) return NULL;
 
   uint32_t idx = sv_get_u32(ip + 1);
   if (idx >= (uint32_t)func->const_count) return NULL;
@@ -2472,7 +3476,38 @@ static bool *scan_captured_locals(sv_func_t *func, int n_locals) {
   uint8_t *ip  = func->code;
   uint8_t *end = func->code + func->code_len;
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
+    int sz = sv_op_size[op];
+    if (sz == 0) break;
+    sv_func_t *child = scan_closure_child(func, ip);
+    if (!child) {
+      ip += sz;
+      continue;
+    }
+
+    for (int i = 0; i < child->upvalue_count; i++) {
+      sv_upval_desc_t *desc = &child->upval_descs[i];
+      if (!desc->is_local) continue;
+
+      int li = (int)desc->index - func->param_count;
+      if (li < 0 || li >= n_locals) continue;
+      captured[li] = true;
+    }
+    ip += sz;
+  }
+  return captured;
+}
+
+static bool *scan_captured_params(sv_func_t *func) {
+  int param_count = func ? func->param_count : 0;
+  if (param_count <= 0) return NULL;
+  bool *captured = calloc((size_t)param_count, sizeof(bool));
+  if (!captured) return NULL;
+
+  uint8_t *ip = func->code;
+  uint8_t *end = func->code + func->code_len;
+  while (ip < end) {
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) break;
     sv_func_t *child = scan_closure_child(func, ip);
@@ -2481,47 +3516,471 @@ static bool *scan_captured_locals(sv_func_t *func, int n_locals) {
       continue;
     }
 
-    for (int i = 0; i < child->upvalue_count; i++) {
-      sv_upval_desc_t *desc = &child->upval_descs[i];
-      if (!desc->is_local) continue;
+    for (int i = 0; i < child->upvalue_count; i++) {
+      sv_upval_desc_t *desc = &child->upval_descs[i];
+      if (!desc->is_local) continue;
+      if (desc->index >= (uint16_t)param_count) continue;
+      captured[desc->index] = true;
+    }
+    ip += sz;
+  }
+
+  return captured;
+}
+
+#define JIT_SR_MAX_OBJECTS 8
+#define JIT_SR_MAX_FIELDS  8
+
+#define JIT_SR_PENDING(o)   (SV_JIT_SCALAR_OBJ + (ant_value_t)(o) * 2)
+#define JIT_SR_COMMITTED(o) (SV_JIT_SCALAR_OBJ + (ant_value_t)(o) * 2 + 1)
+
+// object literals stored into a local that is only ever read back as
+// `local.field` never escape the frame; their fields live in registers and
+// the local holds a sentinel until a bailout forces a real object
+typedef struct {
+  uint16_t local;
+  uint8_t field_count;
+  bool slots;
+  uint32_t site_off;
+  uint32_t atoms[JIT_SR_MAX_FIELDS];
+  MIR_reg_t fields[JIT_SR_MAX_FIELDS];
+  MIR_reg_t pending[JIT_SR_MAX_FIELDS];
+} jit_sr_object_t;
+
+typedef struct {
+  int count;
+  jit_sr_object_t objs[JIT_SR_MAX_OBJECTS];
+  uint8_t *at;
+} jit_sr_plan_t;
+
+typedef struct {
+  uint32_t obj_off;
+  uint32_t put_off;
+  uint16_t local;
+  uint8_t field_count;
+  bool slots;
+  uint32_t atoms[JIT_SR_MAX_FIELDS];
+  uint32_t define_off[JIT_SR_MAX_FIELDS];
+} jit_sr_site_t;
+
+typedef struct {
+  uint32_t field_off;
+  uint32_t atom;
+  uint16_t local;
+} jit_sr_read_t;
+
+static inline uint8_t jit_sr_mark(int obj, int field) {
+  return (uint8_t)((obj + 1) | (field << 4));
+}
+
+static inline int jit_sr_at(const jit_sr_plan_t *sr, int bc_off, int *field) {
+  if (!sr || !sr->at[bc_off]) return -1;
+  *field = sr->at[bc_off] >> 4;
+  return (sr->at[bc_off] & 0x0f) - 1;
+}
+
+static bool jit_sr_same_atom(sv_func_t *func, uint32_t a, uint32_t b) {
+  if (a == b) return true;
+  sv_atom_t *x = &func->atoms[a], *y = &func->atoms[b];
+  return x->len == y->len && memcmp(x->str, y->str, x->len) == 0;
+}
+
+static bool jit_sr_value_op(sv_op_t op, int *pop, int *push) {
+  *push = 1;
+  switch (op) {
+    case OP_CONST: case OP_CONST_I8: case OP_CONST8:
+    case OP_UNDEF: case OP_NULL: case OP_TRUE: case OP_FALSE: case OP_THIS:
+    case OP_GET_LOCAL: case OP_GET_LOCAL8: case OP_GET_ARG: case OP_GET_UPVAL:
+    case OP_GET_GLOBAL: case OP_GET_GLOBAL_UNDEF:
+      *pop = 0; return true;
+    case OP_GET_FIELD: case OP_GET_LENGTH:
+    case OP_NEG: case OP_UPLUS: case OP_INC: case OP_DEC:
+    case OP_BNOT: case OP_NOT: case OP_TYPEOF:
+      *pop = 1; return true;
+    case OP_GET_ELEM:
+    case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_MOD: case OP_EXP:
+    case OP_ADD_NUM: case OP_SUB_NUM: case OP_MUL_NUM: case OP_DIV_NUM:
+    case OP_EQ: case OP_NE: case OP_SEQ: case OP_SNE:
+    case OP_LT: case OP_LE: case OP_GT: case OP_GE:
+    case OP_BAND: case OP_BOR: case OP_BXOR: case OP_SHL: case OP_SHR: case OP_USHR:
+      *pop = 2; return true;
+    default:
+      return false;
+  }
+}
+
+// OBJECT, then straight-line field values each closed by DEFINE_FIELD or
+// DEFINE_SLOT, then PUT_LOCAL; anything else lets the object escape
+static bool jit_sr_match_site(sv_func_t *func, uint8_t *ip, uint8_t *end,
+                              jit_sr_site_t *site) {
+  memset(site, 0, sizeof(*site));
+  site->obj_off = (uint32_t)(ip - func->code);
+  int depth = 0;
+  ip += sv_op_size[OP_OBJECT];
+
+  while (ip < end) {
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
+    int sz = sv_op_size[op];
+    if (sz == 0 || ip + sz > end) return false;
+    int pop = 0, push = 0;
+
+    if (depth == 0 && (op == OP_PUT_LOCAL || op == OP_PUT_LOCAL8)) {
+      site->local = op == OP_PUT_LOCAL ? sv_get_u16(ip + 1) : sv_get_u8(ip + 1);
+      site->put_off = (uint32_t)(ip - func->code);
+      return site->field_count > 0;
+    }
+
+    if (depth == 1 && (op == OP_DEFINE_FIELD || op == OP_DEFINE_SLOT)) {
+      uint32_t atom = sv_get_u32(ip + 1);
+      int n = site->field_count;
+      bool slots = op == OP_DEFINE_SLOT;
+      if (n == JIT_SR_MAX_FIELDS || atom >= (uint32_t)func->atom_count) return false;
+      if (n > 0 && slots != site->slots) return false;
+      if (slots && sv_get_u16(ip + 5) != (uint16_t)n) return false;
+      for (int i = 0; i < n; i++)
+        if (jit_sr_same_atom(func, site->atoms[i], atom)) return false;
+      site->slots = slots;
+      site->atoms[n] = atom;
+      site->define_off[n] = (uint32_t)(ip - func->code);
+      site->field_count++;
+      depth = 0;
+    } else if (jit_sr_value_op(op, &pop, &push) && pop <= depth) {
+      depth += push - pop;
+    } else return false;
+
+    ip += sz;
+  }
+
+  return false;
+}
+
+static void jit_sr_plan_free(jit_sr_plan_t *sr) {
+  if (!sr) return;
+  free(sr->at);
+  free(sr);
+}
+
+static jit_sr_plan_t *scan_scalar_objects(
+  sv_func_t *func, int n_locals,
+  const bool *captured_locals, const uint8_t *known_type_locals
+) {
+  if (n_locals <= 0) return NULL;
+
+  int param_count = func->param_count;
+  int site_count = 0, site_cap = 0, read_count = 0, read_cap = 0;
+  jit_sr_site_t *sites = NULL;
+  jit_sr_read_t *reads = NULL;
+  jit_sr_plan_t *sr = NULL;
+  int *owner = NULL;
+  bool *bad = calloc((size_t)n_locals, sizeof(bool));
+  if (!bad) return NULL;
+
+  uint8_t *ip = func->code;
+  uint8_t *end = func->code + func->code_len;
+  while (ip < end) {
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
+    int sz = sv_op_size[op];
+    if (sz == 0 || ip + sz > end) goto fail;
+
+    switch (op) {
+      case OP_ENTER_WITH:
+      case OP_EVAL:
+        goto fail;
+
+      case OP_OBJECT: {
+        jit_sr_site_t site;
+        if (!jit_sr_match_site(func, ip, end, &site)) break;
+        if (site_count == site_cap) {
+          int cap = site_cap ? site_cap * 2 : 8;
+          jit_sr_site_t *next = realloc(sites, (size_t)cap * sizeof(*sites));
+          if (!next) goto fail;
+          sites = next;
+          site_cap = cap;
+        }
+        sites[site_count++] = site;
+        break;
+      }
+
+      case OP_GET_LOCAL:
+      case OP_GET_LOCAL8: {
+        uint16_t idx = op == OP_GET_LOCAL ? sv_get_u16(ip + 1) : sv_get_u8(ip + 1);
+        if (idx >= (uint16_t)n_locals) break;
+        uint8_t *next = ip + sz;
+        if (next >= end || sv_op_base((sv_op_t)*next) != OP_GET_FIELD ||
+            next + sv_op_size[OP_GET_FIELD] > end ||
+            sv_get_u32(next + 1) >= (uint32_t)func->atom_count) {
+          bad[idx] = true;
+          break;
+        }
+        if (read_count == read_cap) {
+          int cap = read_cap ? read_cap * 2 : 16;
+          jit_sr_read_t *grown = realloc(reads, (size_t)cap * sizeof(*reads));
+          if (!grown) goto fail;
+          reads = grown;
+          read_cap = cap;
+        }
+        reads[read_count++] = (jit_sr_read_t){
+          .field_off = (uint32_t)(next - func->code),
+          .atom = sv_get_u32(next + 1),
+          .local = idx,
+        };
+        break;
+      }
+
+      case OP_PUT_LOCAL:
+      case OP_PUT_LOCAL8:
+      case OP_SET_LOCAL_UNDEF:
+        break;
+
+      case OP_SET_LOCAL:
+      case OP_GET_LOCAL_CHK:
+      case OP_PUT_LOCAL_CHK: {
+        uint16_t idx = sv_get_u16(ip + 1);
+        if (idx < (uint16_t)n_locals) bad[idx] = true;
+        break;
+      }
+
+      case OP_SET_LOCAL8:
+      case OP_INC_LOCAL:
+      case OP_DEC_LOCAL:
+      case OP_ADD_LOCAL: {
+        uint8_t idx = sv_get_u8(ip + 1);
+        if (idx < (uint8_t)n_locals) bad[idx] = true;
+        break;
+      }
 
-      int li = (int)desc->index - func->param_count;
-      if (li < 0 || li >= n_locals) continue;
-      captured[li] = true;
+      case OP_GET_SLOT_RAW:
+      case OP_STR_APPEND_LOCAL:
+      case OP_STR_ALC_SNAPSHOT:
+      case OP_STR_FLUSH_LOCAL:
+      case OP_CALL_CALL_SLOT:
+      case OP_YIELD_STAR_INIT:
+      case OP_YIELD_STAR_NEXT:
+      case OP_YIELD_STAR_THROW:
+      case OP_YIELD_STAR_RETURN: {
+        int slot = sv_get_u16(ip + 1);
+        if (slot < n_locals) bad[slot] = true;
+        if (slot >= param_count && slot - param_count < n_locals)
+          bad[slot - param_count] = true;
+        break;
+      }
+
+      default:
+        break;
     }
     ip += sz;
   }
-  return captured;
-}
-
-static bool *scan_captured_params(sv_func_t *func) {
-  int param_count = func ? func->param_count : 0;
-  if (param_count <= 0) return NULL;
-  bool *captured = calloc((size_t)param_count, sizeof(bool));
-  if (!captured) return NULL;
 
-  uint8_t *ip = func->code;
-  uint8_t *end = func->code + func->code_len;
+  // every store into a candidate must be one of its literal sites
+  ip = func->code;
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
-    if (sz == 0) break;
-    sv_func_t *child = scan_closure_child(func, ip);
-    if (!child) {
-      ip += sz;
-      continue;
+    if (op == OP_PUT_LOCAL || op == OP_PUT_LOCAL8) {
+      uint16_t idx = op == OP_PUT_LOCAL ? sv_get_u16(ip + 1) : sv_get_u8(ip + 1);
+      uint32_t off = (uint32_t)(ip - func->code);
+      bool from_site = false;
+      for (int i = 0; i < site_count && !from_site; i++)
+        from_site = sites[i].put_off == off;
+      if (!from_site && idx < (uint16_t)n_locals) bad[idx] = true;
     }
+    ip += sz;
+  }
 
-    for (int i = 0; i < child->upvalue_count; i++) {
-      sv_upval_desc_t *desc = &child->upval_descs[i];
-      if (!desc->is_local) continue;
-      if (desc->index >= (uint16_t)param_count) continue;
-      captured[desc->index] = true;
+  owner = malloc((size_t)n_locals * sizeof(int));
+  if (!owner) goto fail;
+  for (int i = 0; i < n_locals; i++) {
+    if ((captured_locals && captured_locals[i]) ||
+        (known_type_locals && known_type_locals[i] == SV_TI_NUM))
+      bad[i] = true;
+    owner[i] = -1;
+  }
+
+  for (int i = 0; i < site_count; i++) {
+    jit_sr_site_t *s = &sites[i];
+    if (s->local >= (uint16_t)n_locals || bad[s->local]) continue;
+    int first = owner[s->local];
+    if (first < 0) { owner[s->local] = i; continue; }
+    jit_sr_site_t *f = &sites[first];
+    bool same = f->field_count == s->field_count && f->slots == s->slots;
+    for (int k = 0; same && k < f->field_count; k++)
+      same = jit_sr_same_atom(func, f->atoms[k], s->atoms[k]);
+    if (!same) bad[s->local] = true;
+  }
+
+  for (int i = 0; i < read_count; i++) {
+    jit_sr_read_t *r = &reads[i];
+    int first = owner[r->local];
+    if (first < 0 || bad[r->local]) continue;
+    bool known = false;
+    for (int k = 0; k < sites[first].field_count && !known; k++)
+      known = jit_sr_same_atom(func, sites[first].atoms[k], r->atom);
+    if (!known) bad[r->local] = true;
+  }
+
+  sr = calloc(1, sizeof(*sr));
+  if (!sr || !(sr->at = calloc((size_t)func->code_len, 1))) goto fail;
+
+  for (int l = 0; l < n_locals && sr->count < JIT_SR_MAX_OBJECTS; l++) {
+    if (bad[l] || owner[l] < 0) continue;
+    int o = sr->count++;
+    jit_sr_site_t *f = &sites[owner[l]];
+    jit_sr_object_t *so = &sr->objs[o];
+    so->local = (uint16_t)l;
+    so->field_count = f->field_count;
+    so->slots = f->slots;
+    so->site_off = f->obj_off;
+    memcpy(so->atoms, f->atoms, sizeof(so->atoms));
+
+    for (int i = 0; i < site_count; i++) {
+      jit_sr_site_t *s = &sites[i];
+      if (s->local != (uint16_t)l) continue;
+      sr->at[s->obj_off] = jit_sr_mark(o, 0);
+      sr->at[s->put_off] = jit_sr_mark(o, 0);
+      for (int k = 0; k < s->field_count; k++)
+        sr->at[s->define_off[k]] = jit_sr_mark(o, k);
+    }
+    for (int i = 0; i < read_count; i++) {
+      if (reads[i].local != (uint16_t)l) continue;
+      for (int k = 0; k < so->field_count; k++)
+        if (jit_sr_same_atom(func, so->atoms[k], reads[i].atom))
+          sr->at[reads[i].field_off] = jit_sr_mark(o, k);
     }
-    ip += sz;
   }
 
-  return captured;
+  free(bad);
+  free(owner);
+  free(sites);
+  free(reads);
+  if (sr->count == 0) { jit_sr_plan_free(sr); return NULL; }
+  return sr;
+
+fail:
+  free(bad);
+  free(owner);
+  free(sites);
+  free(reads);
+  jit_sr_plan_free(sr);
+  return NULL;
+}
+
+typedef struct {
+  MIR_item_t object_proto, imp_object;
+  MIR_item_t define_field_proto, imp_define_field;
+  MIR_item_t define_slot_proto, imp_define_slot;
+  MIR_reg_t r_vm, r_js;
+} jit_sr_emit_t;
+
+static void mir_emit_sr_build(MIR_context_t ctx, MIR_item_t fn,
+                              sv_func_t *func, const jit_sr_object_t *so,
+                              const MIR_reg_t *vals, MIR_reg_t dst,
+                              const jit_sr_emit_t *e) {
+  sv_obj_site_cache_t *site = sv_obj_site_for_offset(func, so->site_off);
+  MIR_append_insn(ctx, fn,
+    MIR_new_call_insn(ctx, 7,
+      MIR_new_ref_op(ctx, e->object_proto),
+      MIR_new_ref_op(ctx, e->imp_object),
+      MIR_new_reg_op(ctx, dst),
+      MIR_new_reg_op(ctx, e->r_vm),
+      MIR_new_reg_op(ctx, e->r_js),
+      MIR_new_uint_op(ctx, (uint64_t)(uintptr_t)func),
+      MIR_new_uint_op(ctx, (uint64_t)(uintptr_t)site)));
+
+  for (int k = 0; k < so->field_count; k++) {
+    sv_atom_t *atom = &func->atoms[so->atoms[k]];
+    if (so->slots) MIR_append_insn(ctx, fn,
+      MIR_new_call_insn(ctx, 9,
+        MIR_new_ref_op(ctx, e->define_slot_proto),
+        MIR_new_ref_op(ctx, e->imp_define_slot),
+        MIR_new_reg_op(ctx, e->r_vm),
+        MIR_new_reg_op(ctx, e->r_js),
+        MIR_new_reg_op(ctx, dst),
+        MIR_new_reg_op(ctx, vals[k]),
+        MIR_new_uint_op(ctx, (uint64_t)(uintptr_t)atom->str),
+        MIR_new_uint_op(ctx, (uint64_t)atom->len),
+        MIR_new_int_op(ctx, (int64_t)k)));
+    else MIR_append_insn(ctx, fn,
+      MIR_new_call_insn(ctx, 8,
+        MIR_new_ref_op(ctx, e->define_field_proto),
+        MIR_new_ref_op(ctx, e->imp_define_field),
+        MIR_new_reg_op(ctx, e->r_vm),
+        MIR_new_reg_op(ctx, e->r_js),
+        MIR_new_reg_op(ctx, dst),
+        MIR_new_reg_op(ctx, vals[k]),
+        MIR_new_uint_op(ctx, (uint64_t)(uintptr_t)atom->str),
+        MIR_new_uint_op(ctx, (uint64_t)atom->len)));
+  }
+}
+
+// runs at the top of the bailout trampoline, after every local and stack
+// slot has been spilled: swap each sentinel for a real object so the
+// interpreter never sees one
+static void mir_emit_sr_materialize(MIR_context_t ctx, MIR_item_t fn,
+                                    sv_func_t *func, const jit_sr_plan_t *sr,
+                                    MIR_reg_t lbuf, MIR_reg_t args_buf,
+                                    MIR_reg_t sp, const jit_sr_emit_t *e) {
+  if (!sr) return;
+  MIR_reg_t r_obj = MIR_new_func_reg(ctx, fn->u.func, MIR_JSVAL, "sr_obj");
+  MIR_reg_t r_cur = MIR_new_func_reg(ctx, fn->u.func, MIR_JSVAL, "sr_cur");
+  MIR_reg_t r_i = MIR_new_func_reg(ctx, fn->u.func, MIR_T_I64, "sr_i");
+
+  for (int o = 0; o < sr->count; o++) {
+    const jit_sr_object_t *so = &sr->objs[o];
+    MIR_disp_t local_disp = (MIR_disp_t)(so->local * (int)sizeof(ant_value_t));
+    MIR_label_t committed_done = MIR_new_label(ctx);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV,
+        MIR_new_reg_op(ctx, r_cur),
+        MIR_new_mem_op(ctx, MIR_T_I64, local_disp, lbuf, 0, 1)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_BNE,
+        MIR_new_label_op(ctx, committed_done),
+        MIR_new_reg_op(ctx, r_cur),
+        MIR_new_uint_op(ctx, JIT_SR_COMMITTED(o))));
+    mir_emit_sr_build(ctx, fn, func, so, so->fields, r_obj, e);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV,
+        MIR_new_mem_op(ctx, MIR_T_I64, local_disp, lbuf, 0, 1),
+        MIR_new_reg_op(ctx, r_obj)));
+    MIR_append_insn(ctx, fn, committed_done);
+
+    // a bailout while the literal's fields are still being evaluated leaves
+    // it on the operand stack; every field is defined up front, the
+    // interpreter redefines the rest in the same order as it resumes
+    MIR_label_t loop = MIR_new_label(ctx);
+    MIR_label_t next = MIR_new_label(ctx);
+    MIR_label_t done = MIR_new_label(ctx);
+    mir_load_imm(ctx, fn, r_i, 0);
+    MIR_append_insn(ctx, fn, loop);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_BGE,
+        MIR_new_label_op(ctx, done),
+        MIR_new_reg_op(ctx, r_i),
+        MIR_new_reg_op(ctx, sp)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV,
+        MIR_new_reg_op(ctx, r_cur),
+        MIR_new_mem_op(ctx, MIR_T_I64, 0, args_buf, r_i, sizeof(ant_value_t))));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_BNE,
+        MIR_new_label_op(ctx, next),
+        MIR_new_reg_op(ctx, r_cur),
+        MIR_new_uint_op(ctx, JIT_SR_PENDING(o))));
+    mir_emit_sr_build(ctx, fn, func, so, so->pending, r_obj, e);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_MOV,
+        MIR_new_mem_op(ctx, MIR_T_I64, 0, args_buf, r_i, sizeof(ant_value_t)),
+        MIR_new_reg_op(ctx, r_obj)));
+    MIR_append_insn(ctx, fn, next);
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_ADD,
+        MIR_new_reg_op(ctx, r_i),
+        MIR_new_reg_op(ctx, r_i),
+        MIR_new_int_op(ctx, 1)));
+    MIR_append_insn(ctx, fn,
+      MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, loop)));
+    MIR_append_insn(ctx, fn, done);
+  }
 }
 
 
@@ -2585,7 +4044,7 @@ static bool jit_inlineable(sv_func_t *f) {
   bool seen_effect = false;
   
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) return false;
 
@@ -2689,7 +4148,7 @@ static MIR_label_t inl_label_lookup(inl_label_map_t *lm, int bc_off, int *out_sp
 
 static bool jit_starts_numeric_const(sv_func_t *func, uint8_t *ip, uint8_t *end, int *out_size) {
   if (!func || !ip || ip >= end) return false;
-  sv_op_t op = (sv_op_t)*ip;
+  sv_op_t op = sv_op_base((sv_op_t)*ip);
   int sz = sv_op_size[op];
   if (sz == 0 || ip + sz > end) return false;
   if (out_size) *out_size = sz;
@@ -2718,7 +4177,7 @@ static bool jit_has_immediate_numeric_local_init(sv_func_t *func, uint8_t *ip, u
   uint8_t *put_ip = ip + const_size;
   if (put_ip >= end) return false;
 
-  sv_op_t put_op = (sv_op_t)*put_ip;
+  sv_op_t put_op = sv_op_base((sv_op_t)*put_ip);
   int put_size = sv_op_size[put_op];
   if (put_size == 0 || put_ip + put_size > end) return false;
 
@@ -2797,7 +4256,7 @@ static void jit_emit_inline_body(
     const uint8_t *scan = callee->code;
     const uint8_t *scan_end = callee->code + callee->code_len;
     while (scan < scan_end) {
-      sv_op_t sop = (sv_op_t)*scan;
+      sv_op_t sop = sv_op_base((sv_op_t)*scan);
       if (sop == OP_CALL || sop == OP_CALL_METHOD ||
           sop == OP_TAIL_CALL || sop == OP_TAIL_CALL_METHOD) {
         char rn[32]; snprintf(rn, sizeof(rn), "inl%d_undef", id);
@@ -2821,7 +4280,7 @@ static void jit_emit_inline_body(
   uint8_t *end = callee->code + callee->code_len;
 
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     int inl_bc_off = (int)(ip - code_base);
 
@@ -4020,11 +5479,14 @@ static void jit_emit_inline_body(
   }
 }
 
-static void scan_branch_targets(sv_func_t *func, jit_label_map_t *lm,  MIR_context_t ctx) {
-  uint8_t *ip   = func->code;
-  uint8_t *end  = func->code + func->code_len;
+static void scan_branch_targets(
+  sv_func_t *func, jit_label_map_t *lm,
+  MIR_context_t ctx, const sv_jit_loop_unit_t *loop
+) {
+  uint8_t *ip   = func->code + (loop ? loop->start : 0);
+  uint8_t *end  = func->code + (loop ? loop->end : func->code_len);
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) break;
     uint16_t flags = sv_op_flags[op];
@@ -4073,7 +5535,7 @@ static jit_features_t jit_prescan_features(sv_func_t *func, int n_slots) {
   uint8_t *ip  = func->code;
   uint8_t *end = func->code + func->code_len;
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) break;
     uint16_t flags = sv_op_flags[op];
@@ -4134,7 +5596,7 @@ static bool jit_mark_self_binding_guards(
   uint8_t *ip = func->code;
   uint8_t *end = func->code + func->code_len;
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) break;
 
@@ -4172,7 +5634,7 @@ static bool jit_is_eligible(sv_func_t *func) {
   uint8_t *ip  = func->code;
   uint8_t *end = func->code + func->code_len;
   while (ip < end) {
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) return false;
     if ((sv_op_flags[op] & SV_OPF_JIT_ELIGIBLE) == 0) {
@@ -4204,19 +5666,73 @@ static bool jit_is_eligible(sv_func_t *func) {
   return eligible;
 }
 
-sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_closure) {
-  if (func->jit_compile_failed || func->jit_compiling) return NULL;
-  if (func->jit_code == NULL && func->jit_compiled_tfb_ver != 0 &&
-      func->tfb_version == func->jit_compiled_tfb_ver) {
-    func->jit_compile_failed = true;
-    return NULL;
+// the loop region of an OSR header runs up to the furthest back edge that
+// jumps to it, so `continue` from anywhere in the body stays inside
+static int jit_loop_region_end(sv_func_t *func, int header) {
+  int region_end = -1;
+  uint8_t *ip  = func->code + header;
+  uint8_t *end = func->code + func->code_len;
+  while (ip < end) {
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
+    int sz = sv_op_size[op];
+    if (sz == 0) return -1;
+    int src = (int)(ip - func->code);
+    uint16_t flags = sv_op_flags[op];
+    if ((flags & SV_OPF_JIT_OSR_BACKEDGE) != 0) {
+      int target = -1;
+      if ((flags & SV_OPF_JIT_BRANCH32) != 0)
+        target = src + sz + sv_get_i32(ip + 1);
+      else if ((flags & SV_OPF_JIT_BRANCH8) != 0)
+        target = src + sz + (int8_t)sv_get_i8(ip + 1);
+      if (target == header) region_end = src + sz;
+    }
+    ip += sz;
   }
+  return region_end;
+}
 
-  if (!jit_is_eligible(func)) {
-    func->jit_compile_failed = true;
-    return NULL;
+// only the loop body has to be compilable; try blocks are kept out of loop
+// units (and loops inside a try) since the interpreter frame would not have
+// the matching handlers when the unit hands back mid-body or throws
+static bool jit_loop_is_eligible(sv_func_t *func, int start, int end) {
+  if (func->is_async || func->is_generator) return false;
+  if (start < 0 || end <= start || end > func->code_len) return false;
+
+  uint8_t *ip = func->code;
+  while (ip < func->code + end) {
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
+    int sz = sv_op_size[op];
+    if (sz == 0) return false;
+    int off = (int)(ip - func->code);
+    
+    if (op == OP_TRY_PUSH || op == OP_TRY_PUSH_FINALLY) {
+      int handler = off + sz + sv_get_i32(ip + 1);
+      if (off >= start || handler > start) return false;
+    }
+    
+    if (off < start) { ip += sz; continue; }
+    if ((sv_op_flags[op] & SV_OPF_JIT_ELIGIBLE) == 0) return false;
+    if (op == OP_TAIL_CALL || op == OP_TAIL_CALL_METHOD) return false;
+    
+    if (op == OP_CLOSURE) {
+      uint32_t idx = sv_get_u32(ip + 1);
+      if (idx >= (uint32_t)func->const_count) return false;
+      if (vtype(func->constants[idx]) != T_NTARG) return false;
+    } else if (op == OP_SPECIAL_OBJ && sv_get_u8(ip + 1) == 0) return false;
+    
+    ip += sz;
   }
+  
+  return true;
+}
 
+// compiles the whole function, or with `loop` set only the loop region
+// [loop->start, loop->end): that unit is entered through OSR at the loop
+// header alone and hands every exit back to the interpreter frame
+static sv_jit_func_t jit_compile_unit(
+  ant_t *js, sv_func_t *func,
+  sv_closure_t *hint_closure, sv_jit_loop_unit_t *loop
+) {
   func->jit_compiling = true;
   sv_jit_ctx_t *jc = js->jit_ctx;
 
@@ -4230,13 +5746,26 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     return NULL;
   }
 
-  jit_load_externals_once(jc);
   bool jit_compile_hot = func->jit_loop_hot ||
                          func->back_edge_count >= JIT_HOT_COMPILE_BACKEDGE_THRESHOLD;
-  MIR_context_t ctx = jit_compile_hot ? jc->ctx_hot : jc->ctx;
+  
+  // a loop unit is wanted by the frame that is spinning in it right now
+  bool background = jc->worker && !loop;
+  sv_jit_space_t *space = background ? NULL
+    : (loop && jc->worker) ? jit_space_open(jc, JIT_SPACE_LOOP, true)
+    : jit_space_for(jc, jit_compile_hot);
+  
+  if (!background && !space) {
+    func->jit_compiling = false;
+    return NULL;
+  }
+  
+  MIR_context_t ctx = space ? space->ctx : jit_builder_context(jc);
 
   char fname[128];
-  snprintf(fname, sizeof(fname), "jit_%s_%p",
+  if (loop) snprintf(fname, sizeof(fname), "jit_%s_L%d_%p",
+           func->debug->name ? func->debug->name : "anon", loop->start, (void *)func);
+  else snprintf(fname, sizeof(fname), "jit_%s_%p",
            func->debug->name ? func->debug->name : "anon", (void *)func);
 
   MIR_module_t mod = MIR_new_module(ctx, fname);
@@ -4282,6 +5811,14 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     MIR_T_P,    "args",
     MIR_T_I32,  "argc");
 
+  MIR_type_t native_stub_ret = MIR_JSVAL;
+  MIR_item_t native_stub_proto = MIR_new_proto(ctx, "native_stub_proto",
+    1, &native_stub_ret,
+    3,
+    MIR_T_I64, "js_p",
+    MIR_T_P,   "args",
+    MIR_T_I32, "argc");
+
   MIR_type_t call_call_ret = MIR_JSVAL;
   MIR_item_t call_call_proto = MIR_new_proto(ctx, "call_call_proto",
     1, &call_call_ret,
@@ -4487,6 +6024,20 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     MIR_T_I64,  "n_locals",
     MIR_T_I64,  "bc_offset");
 
+  MIR_item_t loop_exit_proto = MIR_new_proto(ctx, "loop_exit_proto",
+    1, &br_ret, 11,
+    MIR_T_I64,  "vm",
+    MIR_T_P,    "closure",
+    MIR_T_P,    "vstack",
+    MIR_T_I64,  "vstack_sp",
+    MIR_T_P,    "params",
+    MIR_T_I64,  "n_params",
+    MIR_T_P,    "locals",
+    MIR_T_I64,  "n_locals",
+    MIR_T_I64,  "bc_offset",
+    MIR_T_I64,  "loop_start",
+    MIR_T_I64,  "loop_end");
+
   MIR_type_t cl_ret = MIR_JSVAL;
   MIR_item_t closure_proto = MIR_new_proto(ctx, "closure_proto",
     1, &cl_ret, 11,
@@ -4735,6 +6286,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
   MIR_item_t imp_to_propkey = MIR_new_import(ctx, "jit_helper_to_propkey");
   MIR_item_t imp_to_string = MIR_new_import(ctx, "js_template_to_string");
   MIR_item_t imp_resume     = MIR_new_import(ctx, "jit_helper_bailout_resume");
+  MIR_item_t imp_loop_exit  = MIR_new_import(ctx, "jit_helper_loop_exit");
   MIR_item_t imp_close_upval = MIR_new_import(ctx, "jit_helper_close_upval");
   MIR_item_t imp_upval_barrier = MIR_new_import(ctx, "jit_helper_upval_barrier");
   MIR_item_t imp_adopt_open_upvalues = MIR_new_import(ctx, "jit_helper_adopt_open_upvalues");
@@ -4818,6 +6370,16 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       MIR_new_reg_op(ctx, r_js),
       MIR_new_mem_op(ctx, MIR_T_I64, 0, r_vm, 0, 1)));
 
+  MIR_reg_t r_used = MIR_new_func_reg(ctx, jit_func->u.func, MIR_T_I64, "used_p");
+  MIR_append_insn(ctx, jit_func,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_reg_op(ctx, r_used),
+      MIR_new_uint_op(ctx, (uint64_t)(uintptr_t)&func->jit_used)));
+  MIR_append_insn(ctx, jit_func,
+    MIR_new_insn(ctx, MIR_MOV,
+      MIR_new_mem_op(ctx, MIR_T_U8, 0, r_used, 0, 1),
+      MIR_new_int_op(ctx, 1)));
+
   {
     MIR_reg_t r_stk_probe = MIR_new_func_reg(ctx, jit_func->u.func, MIR_T_I64, "stk_probe");
     MIR_reg_t r_stk_floor = MIR_new_func_reg(ctx, jit_func->u.func, MIR_T_I64, "stk_floor");
@@ -4947,6 +6509,9 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
   MIR_reg_t r_tmp2 = MIR_new_func_reg(ctx, jit_func->u.func, MIR_JSVAL, "tmp2");
   MIR_reg_t r_bool = MIR_new_func_reg(ctx, jit_func->u.func, MIR_T_I64, "bool_tmp");
   MIR_reg_t r_err_tmp = MIR_new_func_reg(ctx, jit_func->u.func, MIR_JSVAL, "err_tmp");
+  MIR_reg_t r_nat_stub = MIR_new_func_reg(ctx, jit_func->u.func, MIR_T_I64, "nat_stub");
+  MIR_reg_t r_nat_sfn = MIR_new_func_reg(ctx, jit_func->u.func, MIR_JSVAL, "nat_saved_fn");
+  MIR_reg_t r_nat_sthis = MIR_new_func_reg(ctx, jit_func->u.func, MIR_JSVAL, "nat_saved_this");
   mir_load_imm(ctx, jit_func, r_tmp2, 0);
 
   uint8_t *self_binding_guards = calloc(
@@ -4958,6 +6523,12 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     feat.needs_bailout = true;
     feat.needs_args_buf = true;
   }
+  
+  // every exit from a loop unit leaves through the bailout trampoline
+  if (loop) {
+    feat.needs_bailout = true;
+    feat.needs_args_buf = true;
+  }
 
 
   MIR_reg_t r_d_slot = MIR_new_func_reg(ctx, jit_func->u.func, MIR_T_I64, "d_slot");
@@ -5082,7 +6653,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
                          !(captured_locals && captured_locals[i]);
       uint8_t *dp = func->code, *de = func->code + func->code_len;
       while (dp < de) {
-        sv_op_t dop = (sv_op_t)*dp;
+        sv_op_t dop = sv_op_base((sv_op_t)*dp);
         int dsz = sv_op_size[dop];
         if (dsz == 0) break;
         if (dop == OP_SET_LOCAL_UNDEF) {
@@ -5205,7 +6776,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         MIR_new_uint_op(ctx, (uint64_t)param_count * sizeof(ant_value_t))));
   } else mir_load_imm(ctx, jit_func, r_tco_args, 0);
   jit_label_map_t lm = {0};
-  scan_branch_targets(func, &lm, ctx);
+  scan_branch_targets(func, &lm, ctx, loop);
   MIR_label_t self_tail_entry = MIR_new_label(ctx);
   MIR_append_insn(ctx, jit_func, self_tail_entry);
 
@@ -5214,7 +6785,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     uint8_t read_mask = 0;
     uint8_t *pscan = func->code, *pend = func->code + func->code_len;
     while (pscan < pend) {
-      sv_op_t pop_ = (sv_op_t)*pscan;
+      sv_op_t pop_ = sv_op_base((sv_op_t)*pscan);
       int psz = sv_op_size[pop_];
       if (psz == 0) break;
       if (pop_ == OP_GET_ARG) {
@@ -5249,8 +6820,27 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     }
   }
 
+  jit_sr_plan_t *sr = scan_scalar_objects(
+    func, n_locals, captured_locals, known_type_locals);
+  if (sr) {
+    for (int o = 0; o < sr->count; o++) {
+      jit_sr_object_t *so = &sr->objs[o];
+      for (int k = 0; k < so->field_count; k++) {
+        char srn[32];
+        snprintf(srn, sizeof(srn), "sr%d_f%d", o, k);
+        so->fields[k] = MIR_new_func_reg(ctx, jit_func->u.func, MIR_JSVAL, srn);
+        snprintf(srn, sizeof(srn), "sr%d_p%d", o, k);
+        so->pending[k] = MIR_new_func_reg(ctx, jit_func->u.func, MIR_JSVAL, srn);
+        mir_load_imm(ctx, jit_func, so->fields[k], mkval(T_UNDEF, 0));
+        mir_load_imm(ctx, jit_func, so->pending[k], mkval(T_UNDEF, 0));
+      }
+    }
+  }
+
   osr_entry_map_t osr_map = {0};
-  scan_osr_entries(func, &osr_map);
+  if (loop) osr_map.offsets[osr_map.count++] = loop->start;
+  else scan_osr_entries(func, &osr_map);
+  
   if (osr_map.count > 0) {
     MIR_label_t normal_entry = MIR_new_label(ctx);
 
@@ -5402,6 +6992,12 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     }
 
     MIR_append_insn(ctx, jit_func, normal_entry);
+    if (loop) {
+      mir_load_imm(ctx, jit_func, r_bailout_val,
+                   (uint64_t)SV_JIT_RETRY_INTERP);
+      MIR_append_insn(ctx, jit_func,
+        MIR_new_ret_insn(ctx, 1, MIR_new_reg_op(ctx, r_bailout_val)));
+    }
   }
 
 #define JIT_TRY_MAX 16
@@ -5533,10 +7129,19 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
 
   while (ip < end) {
     int bc_off = (int)(ip - func->code);
-    sv_op_t op = (sv_op_t)*ip;
+    sv_op_t op = sv_op_base((sv_op_t)*ip);
     int sz = sv_op_size[op];
     if (sz == 0) { ok = false; break; }
 
+    if (loop && bc_off < loop->start) { ip += sz; continue; }
+    if (loop && bc_off >= loop->end) {
+      MIR_label_t fallthrough = label_for_branch(ctx, &lm, bc_off, vs.sp);
+      if (!fallthrough) { ok = false; break; }
+      MIR_append_insn(ctx, jit_func,
+        MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, fallthrough)));
+      break;
+    }
+
     for (int i = 0; i < lm.count; i++) {
       if (lm.entries[i].bc_off == bc_off) {
         MIR_append_insn(ctx, jit_func, lm.entries[i].label);
@@ -5892,6 +7497,20 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       case OP_PUT_LOCAL: {
         uint16_t idx = sv_get_u16(ip + 1);
         if (idx >= (uint16_t)n_locals) { ok = false; break; }
+        int sr_field;
+        int sr_obj = jit_sr_at(sr, bc_off, &sr_field);
+        if (sr_obj >= 0) {
+          jit_sr_object_t *so = &sr->objs[sr_obj];
+          vstack_pop(&vs);
+          for (int k = 0; k < so->field_count; k++)
+            MIR_append_insn(ctx, jit_func,
+              MIR_new_insn(ctx, MIR_MOV,
+                MIR_new_reg_op(ctx, so->fields[k]),
+                MIR_new_reg_op(ctx, so->pending[k])));
+          mir_load_imm(ctx, jit_func, local_regs[idx], JIT_SR_COMMITTED(sr_obj));
+          if (known_func_locals) known_func_locals[idx] = NULL;
+          break;
+        }
         sv_func_t *kf = vs.known_func[vs.sp - 1];
         bool src_is_num = vs.slot_type && vs.slot_type[vs.sp - 1] == SLOT_NUM;
         MIR_reg_t src_d = src_is_num ? vs.d_regs[vs.sp - 1] : 0;
@@ -5928,6 +7547,20 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       case OP_PUT_LOCAL8: {
         uint8_t idx = sv_get_u8(ip + 1);
         if (idx >= (uint8_t)n_locals) { ok = false; break; }
+        int sr_field;
+        int sr_obj = jit_sr_at(sr, bc_off, &sr_field);
+        if (sr_obj >= 0) {
+          jit_sr_object_t *so = &sr->objs[sr_obj];
+          vstack_pop(&vs);
+          for (int k = 0; k < so->field_count; k++)
+            MIR_append_insn(ctx, jit_func,
+              MIR_new_insn(ctx, MIR_MOV,
+                MIR_new_reg_op(ctx, so->fields[k]),
+                MIR_new_reg_op(ctx, so->pending[k])));
+          mir_load_imm(ctx, jit_func, local_regs[idx], JIT_SR_COMMITTED(sr_obj));
+          if (known_func_locals) known_func_locals[idx] = NULL;
+          break;
+        }
         sv_func_t *kf = vs.known_func[vs.sp - 1];
         bool src_is_num = vs.slot_type && vs.slot_type[vs.sp - 1] == SLOT_NUM;
         MIR_reg_t src_d = src_is_num ? vs.d_regs[vs.sp - 1] : 0;
@@ -7517,7 +9150,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
               uint8_t *tscan = inline_callee->code;
               uint8_t *tend = inline_callee->code + inline_callee->code_len;
               while (tscan < tend) {
-                sv_op_t top_ = (sv_op_t)*tscan;
+                sv_op_t top_ = sv_op_base((sv_op_t)*tscan);
                 int tsz = sv_op_size[top_];
                 if (tsz == 0) { inl_uses_this = true; break; }
                 if (top_ == OP_THIS) { inl_uses_this = true; break; }
@@ -7687,6 +9320,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         MIR_label_t lbl_self_call   = MIR_new_label(ctx);
         MIR_label_t lbl_super_call  = MIR_new_label(ctx);
         MIR_label_t lbl_interp_call = MIR_new_label(ctx);
+        MIR_label_t lbl_native_call = MIR_new_label(ctx);
         MIR_label_t lbl_call_done   = MIR_new_label(ctx);
 
         MIR_append_insn(ctx, jit_func,
@@ -7735,7 +9369,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
 
         MIR_append_insn(ctx, jit_func,
           MIR_new_insn(ctx, MIR_BEQ,
-            MIR_new_label_op(ctx, lbl_interp_call),
+            MIR_new_label_op(ctx, lbl_native_call),
             MIR_new_reg_op(ctx, r_callee_fn),
             MIR_new_int_op(ctx, 0)));
 
@@ -7825,6 +9459,13 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         MIR_append_insn(ctx, jit_func,
           MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, lbl_call_done)));
 
+        MIR_append_insn(ctx, jit_func, lbl_native_call);
+        mir_emit_native_stub_call(ctx, jit_func, native_stub_proto,
+                                  r_js, r_callee_cl, r_call_func, r_call_this,
+                                  r_arg_arr, (int)call_argc, r_call_res,
+                                  r_nat_stub, r_nat_sfn, r_nat_sthis,
+                                  lbl_interp_call, lbl_call_done);
+
         MIR_append_insn(ctx, jit_func, lbl_interp_call);
         MIR_append_insn(ctx, jit_func,
           MIR_new_call_insn(ctx, 9,
@@ -8778,6 +10419,23 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         uint16_t ic_idx = sv_get_u16(ip + 5);
         MIR_label_t no_err = MIR_new_label(ctx);
         MIR_label_t slow = MIR_new_label(ctx);
+        int sr_field;
+        int sr_obj = jit_sr_at(sr, bc_off, &sr_field);
+        if (sr_obj >= 0) {
+          MIR_label_t sr_real = MIR_new_label(ctx);
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_BNE,
+              MIR_new_label_op(ctx, sr_real),
+              MIR_new_reg_op(ctx, obj),
+              MIR_new_uint_op(ctx, JIT_SR_COMMITTED(sr_obj))));
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_MOV,
+              MIR_new_reg_op(ctx, dst),
+              MIR_new_reg_op(ctx, sr->objs[sr_obj].fields[sr_field])));
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, no_err)));
+          MIR_append_insn(ctx, jit_func, sr_real);
+        }
         if (mir_emit_get_field_ic_fastpath(
           ctx, jit_func, func, bc_off, ic_idx, atom, obj, dst, slow,
           r_ic_epoch_val)) {
@@ -9066,6 +10724,16 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       }
 
       case OP_DEFINE_FIELD: {
+        int sr_field;
+        int sr_obj = jit_sr_at(sr, bc_off, &sr_field);
+        if (sr_obj >= 0) {
+          vstack_ensure_boxed(&vs, vs.sp - 1, ctx, jit_func, r_d_slot);
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_MOV,
+              MIR_new_reg_op(ctx, sr->objs[sr_obj].pending[sr_field]),
+              MIR_new_reg_op(ctx, vstack_pop(&vs))));
+          break;
+        }
         uint32_t idx = sv_get_u32(ip + 1);
         if (idx >= (uint32_t)func->atom_count) { ok = false; break; }
         sv_atom_t *atom = &func->atoms[idx];
@@ -9087,6 +10755,16 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       }
 
       case OP_DEFINE_SLOT: {
+        int sr_field;
+        int sr_obj = jit_sr_at(sr, bc_off, &sr_field);
+        if (sr_obj >= 0) {
+          vstack_ensure_boxed(&vs, vs.sp - 1, ctx, jit_func, r_d_slot);
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_MOV,
+              MIR_new_reg_op(ctx, sr->objs[sr_obj].pending[sr_field]),
+              MIR_new_reg_op(ctx, vstack_pop(&vs))));
+          break;
+        }
         uint32_t idx = sv_get_u32(ip + 1);
         uint16_t slot = sv_get_u16(ip + 5);
         if (idx >= (uint32_t)func->atom_count) { ok = false; break; }
@@ -9130,11 +10808,24 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       }
 
       case OP_GET_ELEM: {
+        uint8_t elem_kind = sv_tfb_elem_kind(func, bc_off);
+        bool key_num = vs.slot_type && vs.slot_type[vs.sp - 1] == SLOT_NUM;
+        MIR_reg_t key_d = key_num ? vs.d_regs[vs.sp - 1] : 0;
         vstack_ensure_boxed(&vs, vs.sp - 1, ctx, jit_func, r_d_slot);
         vstack_ensure_boxed(&vs, vs.sp - 2, ctx, jit_func, r_d_slot);
         MIR_reg_t key = vstack_pop(&vs);
         MIR_reg_t obj = vstack_pop(&vs);
         MIR_reg_t dst = vstack_push(&vs);
+        MIR_label_t ge_done = NULL;
+        if (jit_typed_elem_inlinable(elem_kind)) {
+          MIR_label_t ge_slow = MIR_new_label(ctx);
+          ge_done = MIR_new_label(ctx);
+          mir_emit_typed_elem_load(ctx, jit_func, obj, key, key_d, key_num,
+            (TypedArrayType)(elem_kind - 1), dst, ge_slow, r_d_slot, -1, bc_off);
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, ge_done)));
+          MIR_append_insn(ctx, jit_func, ge_slow);
+        }
         MIR_append_insn(ctx, jit_func,
           MIR_new_call_insn(ctx, 9,
             MIR_new_ref_op(ctx, ge_proto),
@@ -9147,6 +10838,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
             MIR_new_uint_op(ctx, (uint64_t)(uintptr_t)func),
             MIR_new_int_op(ctx, (int64_t)bc_off)));
         JIT_EMIT_THROW_IF_ERROR(dst);
+        if (ge_done) MIR_append_insn(ctx, jit_func, ge_done);
         break;
       }
 
@@ -9221,12 +10913,28 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       }
 
       case OP_PUT_ELEM: {
+        uint8_t elem_kind = sv_tfb_elem_kind(func, bc_off);
+        bool val_num = vs.slot_type && vs.slot_type[vs.sp - 1] == SLOT_NUM;
+        bool key_num = vs.slot_type && vs.slot_type[vs.sp - 2] == SLOT_NUM;
+        MIR_reg_t val_d = val_num ? vs.d_regs[vs.sp - 1] : 0;
+        MIR_reg_t key_d = key_num ? vs.d_regs[vs.sp - 2] : 0;
         vstack_ensure_boxed(&vs, vs.sp - 1, ctx, jit_func, r_d_slot);
         vstack_ensure_boxed(&vs, vs.sp - 2, ctx, jit_func, r_d_slot);
         vstack_ensure_boxed(&vs, vs.sp - 3, ctx, jit_func, r_d_slot);
         MIR_reg_t val = vstack_pop(&vs);
         MIR_reg_t key = vstack_pop(&vs);
         MIR_reg_t obj = vstack_pop(&vs);
+        MIR_label_t pe_done = NULL;
+        if (jit_typed_elem_inlinable(elem_kind)) {
+          MIR_label_t pe_slow = MIR_new_label(ctx);
+          pe_done = MIR_new_label(ctx);
+          mir_emit_typed_elem_store(ctx, jit_func, obj, key, key_d, key_num,
+            val, val_d, val_num, (TypedArrayType)(elem_kind - 1),
+            pe_slow, r_d_slot, -1, bc_off);
+          MIR_append_insn(ctx, jit_func,
+            MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, pe_done)));
+          MIR_append_insn(ctx, jit_func, pe_slow);
+        }
         MIR_append_insn(ctx, jit_func,
           MIR_new_call_insn(ctx, 8,
             MIR_new_ref_op(ctx, put_elem_proto),
@@ -9238,6 +10946,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
             MIR_new_reg_op(ctx, key),
             MIR_new_reg_op(ctx, val)));
         JIT_EMIT_THROW_IF_ERROR(r_err_tmp);
+        if (pe_done) MIR_append_insn(ctx, jit_func, pe_done);
         break;
       }
 
@@ -9412,6 +11121,12 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       }
 
       case OP_OBJECT: {
+        int sr_field;
+        int sr_obj = jit_sr_at(sr, bc_off, &sr_field);
+        if (sr_obj >= 0) {
+          mir_load_imm(ctx, jit_func, vstack_push(&vs), JIT_SR_PENDING(sr_obj));
+          break;
+        }
         sv_obj_site_cache_t *site = sv_obj_site_for_offset(
           func, (uint32_t)bc_off
         );
@@ -10890,6 +12605,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         MIR_label_t lbl_cm_self   = MIR_new_label(ctx);
         MIR_label_t lbl_cm_super  = MIR_new_label(ctx);
         MIR_label_t lbl_cm_interp = MIR_new_label(ctx);
+        MIR_label_t lbl_cm_native = MIR_new_label(ctx);
         MIR_label_t lbl_cm_done   = MIR_new_label(ctx);
 
         MIR_append_insn(ctx, jit_func,
@@ -10937,7 +12653,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
 
         MIR_append_insn(ctx, jit_func,
           MIR_new_insn(ctx, MIR_BEQ,
-            MIR_new_label_op(ctx, lbl_cm_interp),
+            MIR_new_label_op(ctx, lbl_cm_native),
             MIR_new_reg_op(ctx, r_callee_fn),
             MIR_new_int_op(ctx, 0)));
 
@@ -11017,6 +12733,13 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         MIR_append_insn(ctx, jit_func,
           MIR_new_insn(ctx, MIR_JMP, MIR_new_label_op(ctx, lbl_cm_done)));
 
+        MIR_append_insn(ctx, jit_func, lbl_cm_native);
+        mir_emit_native_stub_call(ctx, jit_func, native_stub_proto,
+                                  r_js, r_callee_cl, r_call_func, r_call_this,
+                                  r_arg_arr, (int)call_argc, r_call_res,
+                                  r_nat_stub, r_nat_sfn, r_nat_sthis,
+                                  lbl_cm_interp, lbl_cm_done);
+
         MIR_append_insn(ctx, jit_func, lbl_cm_interp);
         MIR_append_insn(ctx, jit_func,
           MIR_new_call_insn(ctx, 9,
@@ -11511,7 +13234,7 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
         uint32_t name_len = 0;
         int fused_set_name_size = 0;
         uint8_t *next_ip = ip + sz;
-        if (next_ip < end && (sv_op_t)*next_ip == OP_SET_NAME) {
+        if (next_ip < end && sv_op_base((sv_op_t)*next_ip) == OP_SET_NAME) {
           int next_sz = sv_op_size[OP_SET_NAME];
           bool next_has_label = false;
           int next_bc_off = (int)(next_ip - func->code);
@@ -11590,6 +13313,22 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
     ip += sz;
   }
 
+  // branches out of a loop unit land on stubs that hand the frame back to
+  // the interpreter at the branch target; the header has to be entered with
+  // an empty stack since OSR only carries the locals over
+  for (int i = 0; ok && loop && i < lm.count; i++) {
+    jit_label_t *e = &lm.entries[i];
+    if (e->bc_off == loop->start && e->sp != 0) ok = false;
+    if (e->bc_off >= loop->start && e->bc_off < loop->end) continue;
+    if (e->sp < 0) continue;
+    
+    MIR_append_insn(ctx, jit_func, e->label);
+    vs.sp = e->sp;
+    if (vs.slot_type) memset(vs.slot_type, SLOT_BOXED, (size_t)vs.max);
+    mir_emit_bailout_jump_typed(ctx, jit_func, e->bc_off, e->sp,
+      &bailout_ctx, -1, false, -1, false);
+  }
+
   if (!ok || vs.sp > 0) {
     JIT_EMIT_EXIT_RET(MIR_new_uint_op(ctx, mkval(T_UNDEF, 0)));
   }
@@ -11597,6 +13336,15 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
   if (needs_bailout) {
     MIR_append_insn(ctx, jit_func, bailout_tramp);
 
+    const jit_sr_emit_t sr_emit = {
+      .object_proto = object_proto, .imp_object = imp_object,
+      .define_field_proto = define_field_proto, .imp_define_field = imp_define_field,
+      .define_slot_proto = define_slot_proto, .imp_define_slot = imp_define_slot,
+      .r_vm = r_vm, .r_js = r_js,
+    };
+    mir_emit_sr_materialize(ctx, jit_func, func, sr,
+      r_lbuf, r_args_buf, r_bailout_sp, &sr_emit);
+
     if (r_jit_open_upvalues) {
       MIR_append_insn(ctx, jit_func,
         MIR_new_call_insn(ctx, 4,
@@ -11612,7 +13360,23 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
       mir_emit_fill_uncaptured_param_slots_from_args(
         ctx, jit_func, r_slotbuf, r_args, r_argc, captured_params, param_count);
     }
-    MIR_append_insn(ctx, jit_func,
+    if (loop) MIR_append_insn(ctx, jit_func,
+      MIR_new_call_insn(ctx, 14,
+        MIR_new_ref_op(ctx, loop_exit_proto),
+        MIR_new_ref_op(ctx, imp_loop_exit),
+        MIR_new_reg_op(ctx, r_resume_res),
+        MIR_new_reg_op(ctx, r_vm),
+        MIR_new_reg_op(ctx, r_closure),
+        MIR_new_reg_op(ctx, r_args_buf),
+        MIR_new_reg_op(ctx, r_bailout_sp),
+        params_in_slotbuf ? MIR_new_reg_op(ctx, r_slotbuf) : MIR_new_uint_op(ctx, 0),
+        MIR_new_int_op(ctx, params_in_slotbuf ? param_count : 0),
+        MIR_new_reg_op(ctx, r_lbuf),
+        MIR_new_int_op(ctx, n_locals),
+        MIR_new_reg_op(ctx, r_bailout_off),
+        MIR_new_int_op(ctx, loop->start),
+        MIR_new_int_op(ctx, loop->end)));
+    else MIR_append_insn(ctx, jit_func,
       MIR_new_call_insn(ctx, 15,
         MIR_new_ref_op(ctx, resume_proto),
         MIR_new_ref_op(ctx, imp_resume),
@@ -11656,28 +13420,69 @@ sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_clos
   free(captured_params);
   free(captured_locals);
   free(feat.builder_target_slots);
+  if (ok && sr) jc->stats.scalar_objects += (uint64_t)sr->count;
+  jit_sr_plan_free(sr);
 
   if (!ok) {
     MIR_remove_module(ctx, mod);
-    func->jit_compile_failed = true;
+    if (!loop) func->jit_compile_failed = true;
     func->jit_compiling = false;
     return NULL;
   }
 
+  // the module now holds everything codegen needs (constants, IC and
+  // feedback state are baked in), so the compiler thread can take it from
+  // here; jit_compiling stays set until the code is installed
+  size_t code_bytes = 
+    DLIST_LENGTH(MIR_insn_t, jit_func->u.func->insns) * JIT_CODE_BYTES_PER_INSN;
+  
+  if (background) {
+    bool queued = jit_enqueue(jc, ctx, mod, func, fname, jit_compile_hot, code_bytes);
+    MIR_remove_module(ctx, mod);
+    if (!queued) func->jit_compiling = false;
+    return NULL;
+  }
+
   MIR_load_module(ctx, mod);
   MIR_link(ctx, MIR_set_gen_interface, NULL);
 
   sv_jit_func_t generated = MIR_gen(ctx, jit_func);
   func->jit_compiling = false;
-  if (!generated) {
-    func->jit_compile_failed = true;
+  space->code_bytes += code_bytes;
+  
+  if (!generated || !jit_code_install(jc, func, loop, space, (void *)generated, code_bytes)) {
+    if (!loop) func->jit_compile_failed = true;
     return NULL;
   }
 
-  func->jit_compiled_tfb_ver = func->tfb_version;
+  if (!loop) func->jit_compiled_tfb_ver = func->tfb_version;
+  jit_code_enforce_budget(js, jc, func);
+  
   return generated;
 }
 
+void sv_jit_install_ready(ant_t *js) {
+  jit_install_ready(js, js->jit_ctx);
+}
+
+sv_jit_func_t sv_jit_compile(ant_t *js, sv_func_t *func, sv_closure_t *hint_closure) {
+  jit_install_ready(js, js->jit_ctx);
+  if (func->jit_code) return (sv_jit_func_t)func->jit_code;
+  if (func->jit_compile_failed || func->jit_compiling) return NULL;
+  if (func->jit_code == NULL && func->jit_compiled_tfb_ver != 0 &&
+      func->tfb_version == func->jit_compiled_tfb_ver) {
+    func->jit_compile_failed = true;
+    return NULL;
+  }
+
+  if (!jit_is_eligible(func)) {
+    func->jit_compile_failed = true;
+    return NULL;
+  }
+
+  return jit_compile_unit(js, func, hint_closure, NULL);
+}
+
 static void sv_jit_compile_callees(ant_t *js, sv_func_t *func) {
   sv_call_target_fb_t *fb = func->call_target_fb;
   int count = func->call_target_fb_count;
@@ -11701,8 +13506,10 @@ ant_value_t sv_jit_try_compile_and_call(
 
   sv_jit_func_t jit = sv_jit_compile(js, fn, closure);
   if (!jit) {
-    fn->call_count = 0;
-    fn->back_edge_count = 0;
+    if (!fn->jit_compiling) {
+      fn->call_count = 0;
+      fn->back_edge_count = 0;
+    }
     return SV_JIT_RETRY_INTERP;
   }
 
@@ -11722,6 +13529,61 @@ ant_value_t sv_jit_try_compile_and_call(
 }
 
 
+// whether the unit for the loop at `start`, or any unit for start < 0,
+// is compiled
+static bool jit_loop_has_code(sv_func_t *func, int start) {
+  for (int i = 0; func->jit_loops && i < SV_JIT_LOOP_UNITS; i++) {
+    sv_jit_loop_unit_t *unit = &func->jit_loops[i];
+    if (unit->code && (start < 0 || unit->start == start)) return true;
+  }
+  return false;
+}
+
+// finds or compiles the unit for the loop at `header`; a loop that cannot
+// be compiled keeps its slot marked failed so it is not scanned again
+static sv_jit_loop_unit_t *jit_loop_unit(
+  ant_t *js, sv_func_t *func,
+  sv_closure_t *closure, int header
+) {
+  if (!func->jit_loops) {
+    func->jit_loops = calloc(SV_JIT_LOOP_UNITS, sizeof(sv_jit_loop_unit_t));
+    if (!func->jit_loops) return NULL;
+    for (int i = 0; i < SV_JIT_LOOP_UNITS; i++) func->jit_loops[i].start = -1;
+  }
+
+  sv_jit_loop_unit_t *unit = NULL;
+  for (int i = 0; i < SV_JIT_LOOP_UNITS && !unit; i++)
+    if (func->jit_loops[i].start == header) unit = &func->jit_loops[i];
+  if (unit && (unit->code || unit->failed)) return unit;
+
+  for (int i = 0; i < SV_JIT_LOOP_UNITS && !unit; i++)
+    if (func->jit_loops[i].start < 0) unit = &func->jit_loops[i];
+  if (!unit) unit = &func->jit_loops[func->jit_loop_next++ % SV_JIT_LOOP_UNITS];
+
+  unit->code = NULL;
+  unit->start = header;
+  unit->end = jit_loop_region_end(func, header);
+  unit->failed = false;
+  
+  if (!jit_loop_is_eligible(func, unit->start, unit->end)) {
+    unit->failed = true;
+    return unit;
+  }
+
+  // with the whole function still on the compiler thread the loop is
+  // tried again later, anything else that leaves no code is final
+  jit_install_ready(js, js->jit_ctx);
+  if (func->jit_compiling) return unit;
+  jit_compile_unit(js, func, closure, unit);
+  if (unit->code) sv_jit_compile_callees(js, func);
+  else unit->failed = true;
+  
+  return unit;
+}
+
+// functions too large or not compilable as a whole still get their hot
+// loops compiled: the unit runs the loop and the interpreter frame picks
+// up again wherever the loop is left
 ant_value_t sv_jit_try_osr(
   sv_vm_t *vm, ant_t *js,
   sv_frame_t *frame, sv_func_t *func,
@@ -11738,20 +13600,35 @@ ant_value_t sv_jit_try_osr(
     closure = &osr_closure;
   }
 
-  sv_jit_func_t jit;
+  sv_jit_func_t jit = NULL;
+  int loop_start = -1;
   func->jit_loop_hot = true;
+  
   if (func->jit_code) {
     jit = (sv_jit_func_t)func->jit_code;
-  } else {
-    if (func->code_len > 512) {
-      func->call_count = SV_JIT_THRESHOLD + 1;
-      func->back_edge_count = 0;
+  } else if (!func->jit_compile_failed && func->code_len <= JIT_OSR_WHOLE_FUNC_MAX_BYTES) {
+    jit = sv_jit_compile(js, func, closure);
+    if (jit) {
+      func->jit_code = (void *)jit;
+      sv_jit_compile_callees(js, func);
+      // compiling the callees can push this function out of the code budget
+      jit = (sv_jit_func_t)func->jit_code;
+    }
+    if (!jit && !func->jit_compile_failed) return SV_JIT_RETRY_INTERP;
+  }
+
+  if (!jit) {
+    sv_jit_loop_unit_t *unit = func->jit_loop_failed ? NULL : jit_loop_unit(js, func, closure, bc_offset);
+    if (!unit || !unit->code) {
+      // a loop that failed to compile waits out a full threshold like any
+      // other back edge; a loop still waiting on the compiler thread keeps
+      // checking for its function's code or a sibling unit to enter
+      bool retry = unit && !unit->failed && (func->jit_compiling || jit_loop_has_code(func, -1));
+      func->back_edge_count = retry ? SV_JIT_OSR_THRESHOLD - 1 : 0;
       return SV_JIT_RETRY_INTERP;
     }
-    jit = sv_jit_compile(js, func, closure);
-    if (!jit) return SV_JIT_RETRY_INTERP;
-    func->jit_code = (void *)jit;
-    sv_jit_compile_callees(js, func);
+    jit = (sv_jit_func_t)unit->code;
+    loop_start = unit->start;
   }
 
   int nl = func->max_locals;
@@ -11759,11 +13636,15 @@ ant_value_t sv_jit_try_osr(
   for (int i = 0; i < nl; i++)
     osr_locals[i] = frame->lp[i];
 
+  // a callee, or this function recursing, can enter OSR from inside the
+  // unit; the outer state comes back before the unit reaches its exit
+  sv_jit_osr_t saved_osr = vm->jit_osr;
   vm->jit_osr.active    = true;
   vm->jit_osr.bc_offset = bc_offset;
   vm->jit_osr.locals    = osr_locals;
   vm->jit_osr.n_locals  = nl;
   vm->jit_osr.lp        = frame->lp;
+  vm->jit_osr.bp        = frame->bp;
 
   func->back_edge_count = 0;
   sv_jit_enter(js);
@@ -11772,11 +13653,22 @@ ant_value_t sv_jit_try_osr(
     frame->bp, frame->argc, closure);
   sv_jit_leave(js);
 
+  int exit_offset = vm->jit_osr.bc_offset;
+  vm->jit_osr = saved_osr;
+  vm->jit_osr.bc_offset = exit_offset;
+
   if (sv_is_jit_bailout(result)) {
-    sv_jit_on_bailout(func);
+    if (loop_start >= 0) sv_jit_on_loop_bailout(func, loop_start, bc_offset);
+    else sv_jit_on_bailout(func);
     return SV_JIT_RETRY_INTERP;
   }
 
+  // the next back edge checks again, so a loop nested in code the unit
+  // does not cover goes straight back into its unit; after a bailout the
+  // interpreter gathers feedback for a while first
+  if (result == SV_JIT_LOOP_EXIT && jit_loop_has_code(func, loop_start))
+    func->back_edge_count = SV_JIT_OSR_THRESHOLD - 1;
+
   return result;
 }
 
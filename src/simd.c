@@ -0,0 +1,327 @@
+#include "simd.h"
+
+#include <string.h>
+#include <simde/x86/sse2.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+typedef struct {
+  size_t (*ascii_prefix)(const uint8_t *s, size_t len);
+  size_t (*json_safe_prefix)(const uint8_t *s, size_t len);
+  const uint8_t *(*find)(const uint8_t *h, size_t hlen, const uint8_t *n, size_t nlen);
+} simd_kernels_t;
+
+static inline unsigned simd_ctz(uint32_t mask) {
+  return (unsigned)__builtin_ctz(mask);
+}
+
+static inline bool json_byte_is_safe(uint8_t c) {
+  return c >= 0x20 && c != '"' && c != '\\' && c != 0xED;
+}
+
+static size_t ascii_prefix_tail(const uint8_t *s, size_t i, size_t len) {
+  while (i < len && s[i] < 0x80) i++;
+  return i;
+}
+
+static size_t json_safe_prefix_tail(const uint8_t *s, size_t i, size_t len) {
+  while (i < len && json_byte_is_safe(s[i])) i++;
+  return i;
+}
+
+static const uint8_t *find_scalar(
+  const uint8_t *h, size_t hlen,
+  const uint8_t *n, size_t nlen
+) {
+  if (nlen > hlen) return NULL;
+  const uint8_t *p = h;
+  const uint8_t *last = h + hlen - nlen;
+
+  while (p <= last) {
+    p = memchr(p, n[0], (size_t)(last - p) + 1);
+    if (!p) return NULL;
+    if (memcmp(p + 1, n + 1, nlen - 1) == 0) return p;
+    p++;
+  }
+
+  return NULL;
+}
+
+static size_t ascii_prefix_v128(const uint8_t *s, size_t len) {
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    simde__m128i a = simde_mm_loadu_si128((const simde__m128i *)(s + i));
+    simde__m128i b = simde_mm_loadu_si128((const simde__m128i *)(s + i + 16));
+    if (!simde_mm_movemask_epi8(simde_mm_or_si128(a, b))) continue;
+    uint32_t mask = (uint32_t)simde_mm_movemask_epi8(a)
+      | ((uint32_t)simde_mm_movemask_epi8(b) << 16);
+    return i + simd_ctz(mask);
+  }
+
+  for (; i + 16 <= len; i += 16) {
+    simde__m128i v = simde_mm_loadu_si128((const simde__m128i *)(s + i));
+    uint32_t mask = (uint32_t)simde_mm_movemask_epi8(v);
+    if (mask) return i + simd_ctz(mask);
+  }
+
+  return ascii_prefix_tail(s, i, len);
+}
+
+static size_t json_safe_prefix_v128(const uint8_t *s, size_t len) {
+  const simde__m128i quote = simde_mm_set1_epi8('"');
+  const simde__m128i bslash = simde_mm_set1_epi8('\\');
+  const simde__m128i ctl = simde_mm_set1_epi8(0x1F);
+  const simde__m128i lead = simde_mm_set1_epi8((char)0xED);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    simde__m128i v = simde_mm_loadu_si128((const simde__m128i *)(s + i));
+    simde__m128i bad = simde_mm_or_si128(
+      simde_mm_or_si128(simde_mm_cmpeq_epi8(v, quote), simde_mm_cmpeq_epi8(v, bslash)),
+      simde_mm_or_si128(
+        simde_mm_cmpeq_epi8(simde_mm_max_epu8(v, ctl), ctl),
+        simde_mm_cmpeq_epi8(v, lead)
+      )
+    );
+    uint32_t mask = (uint32_t)simde_mm_movemask_epi8(bad);
+    if (mask) return i + simd_ctz(mask);
+  }
+
+  return json_safe_prefix_tail(s, i, len);
+}
+
+// compares the first and last needle byte at 16 candidate positions at once
+// and only runs memcmp on positions where both match
+static const uint8_t *find_v128(
+  const uint8_t *h, size_t hlen,
+  const uint8_t *n, size_t nlen
+) {
+  const simde__m128i first = simde_mm_set1_epi8((char)n[0]);
+  const simde__m128i last = simde_mm_set1_epi8((char)n[nlen - 1]);
+  size_t candidates = hlen - nlen + 1;
+  size_t i = 0;
+
+  for (; i + 16 <= candidates; i += 16) {
+    simde__m128i a = simde_mm_loadu_si128((const simde__m128i *)(h + i));
+    simde__m128i b = simde_mm_loadu_si128((const simde__m128i *)(h + i + nlen - 1));
+    uint32_t mask = (uint32_t)simde_mm_movemask_epi8(simde_mm_and_si128(
+      simde_mm_cmpeq_epi8(a, first), simde_mm_cmpeq_epi8(b, last)
+    ));
+
+    while (mask) {
+      size_t at = i + simd_ctz(mask);
+      if (nlen <= 2 || memcmp(h + at + 1, n + 1, nlen - 2) == 0) return h + at;
+      mask &= mask - 1;
+    }
+  }
+
+  return find_scalar(h + i, hlen - i, n, nlen);
+}
+
+static const simd_kernels_t simd_kernels_v128 = {
+  .ascii_prefix = ascii_prefix_v128,
+  .json_safe_prefix = json_safe_prefix_v128,
+  .find = find_v128,
+};
+
+#ifdef SIMD_HAVE_AVX2
+__attribute__((target("avx2")))
+static size_t ascii_prefix_avx2(const uint8_t *s, size_t len) {
+  size_t i = 0;
+
+  for (; i + 64 <= len; i += 64) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+    if (!_mm256_movemask_epi8(_mm256_or_si256(a, b))) continue;
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(a);
+    if (mask) return i + simd_ctz(mask);
+    return i + 32 + simd_ctz((uint32_t)_mm256_movemask_epi8(b));
+  }
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(v);
+    if (mask) return i + simd_ctz(mask);
+  }
+
+  return ascii_prefix_tail(s, i, len);
+}
+
+__attribute__((target("avx2")))
+static size_t json_safe_prefix_avx2(const uint8_t *s, size_t len) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i bslash = _mm256_set1_epi8('\\');
+  const __m256i ctl = _mm256_set1_epi8(0x1F);
+  const __m256i lead = _mm256_set1_epi8((char)0xED);
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+    __m256i bad = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, bslash)),
+      _mm256_or_si256(
+        _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctl), ctl),
+        _mm256_cmpeq_epi8(v, lead)
+      )
+    );
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(bad);
+    if (mask) return i + simd_ctz(mask);
+  }
+
+  return json_safe_prefix_tail(s, i, len);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t *find_avx2(
+  const uint8_t *h, size_t hlen,
+  const uint8_t *n, size_t nlen
+) {
+  const __m256i first = _mm256_set1_epi8((char)n[0]);
+  const __m256i last = _mm256_set1_epi8((char)n[nlen - 1]);
+  size_t candidates = hlen - nlen + 1;
+  size_t i = 0;
+
+  for (; i + 32 <= candidates; i += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(h + i));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(h + i + nlen - 1));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(
+      _mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)
+    ));
+
+    while (mask) {
+      size_t at = i + simd_ctz(mask);
+      if (nlen <= 2 || memcmp(h + at + 1, n + 1, nlen - 2) == 0) return h + at;
+      mask &= mask - 1;
+    }
+  }
+
+  return find_v128(h + i, hlen - i, n, nlen);
+}
+
+static const simd_kernels_t simd_kernels_avx2 = {
+  .ascii_prefix = ascii_prefix_avx2,
+  .json_safe_prefix = json_safe_prefix_avx2,
+  .find = find_avx2,
+};
+#endif
+
+static const simd_kernels_t *simd_active;
+
+static __attribute__((noinline, cold)) const simd_kernels_t *simd_select(void) {
+  const simd_kernels_t *kernels = &simd_kernels_v128;
+
+#ifdef SIMD_HAVE_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) kernels = &simd_kernels_avx2;
+#endif
+
+  __atomic_store_n(&simd_active, kernels, __ATOMIC_RELEASE);
+  return kernels;
+}
+
+static inline const simd_kernels_t *simd_kernels(void) {
+  const simd_kernels_t *kernels = __atomic_load_n(&simd_active, __ATOMIC_ACQUIRE);
+  return kernels ? kernels : simd_select();
+}
+
+size_t simd_ascii_prefix(const void *data, size_t len) {
+  if (len < 16) return ascii_prefix_tail((const uint8_t *)data, 0, len);
+  return simd_kernels()->ascii_prefix((const uint8_t *)data, len);
+}
+
+size_t simd_json_safe_prefix(const void *data, size_t len) {
+  if (len < 16) return json_safe_prefix_tail((const uint8_t *)data, 0, len);
+  return simd_kernels()->json_safe_prefix((const uint8_t *)data, len);
+}
+
+const void *simd_find(
+  const void *haystack, size_t haystack_len,
+  const void *needle, size_t needle_len
+) {
+  if (needle_len == 0) return haystack;
+  if (needle_len > haystack_len) return NULL;
+  if (needle_len == 1) return memchr(haystack, *(const uint8_t *)needle, haystack_len);
+
+  const uint8_t *h = (const uint8_t *)haystack;
+  const uint8_t *n = (const uint8_t *)needle;
+  if (haystack_len - needle_len < 16) return find_scalar(h, haystack_len, n, needle_len);
+
+  return simd_kernels()->find(h, haystack_len, n, needle_len);
+}
+
+void simd_hex_encode(const uint8_t *src, size_t len, char *dst) {
+  static const char digits[] = "0123456789abcdef";
+  const simde__m128i nibble = simde_mm_set1_epi8(0x0F);
+  const simde__m128i nine = simde_mm_set1_epi8(9);
+  const simde__m128i zero = simde_mm_set1_epi8('0');
+  const simde__m128i alpha = simde_mm_set1_epi8('a' - '0' - 10);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    simde__m128i v = simde_mm_loadu_si128((const simde__m128i *)(src + i));
+    simde__m128i hi = simde_mm_and_si128(simde_mm_srli_epi16(v, 4), nibble);
+    simde__m128i lo = simde_mm_and_si128(v, nibble);
+
+    hi = simde_mm_add_epi8(
+      simde_mm_add_epi8(hi, zero),
+      simde_mm_and_si128(simde_mm_cmpgt_epi8(hi, nine), alpha)
+    );
+    lo = simde_mm_add_epi8(
+      simde_mm_add_epi8(lo, zero),
+      simde_mm_and_si128(simde_mm_cmpgt_epi8(lo, nine), alpha)
+    );
+
+    simde_mm_storeu_si128((simde__m128i *)(dst + i * 2), simde_mm_unpacklo_epi8(hi, lo));
+    simde_mm_storeu_si128((simde__m128i *)(dst + i * 2 + 16), simde_mm_unpackhi_epi8(hi, lo));
+  }
+
+  for (; i < len; i++) {
+    dst[i * 2] = digits[src[i] >> 4];
+    dst[i * 2 + 1] = digits[src[i] & 0x0F];
+  }
+}
+
+// table entries are digit + 1 so that zero marks an invalid character
+static inline int32_t hex_value(uint8_t c) {
+  static const uint8_t lookup[256] = {
+    ['0'] = 1, ['1'] = 2, ['2'] = 3, ['3'] = 4, ['4'] = 5,
+    ['5'] = 6, ['6'] = 7, ['7'] = 8, ['8'] = 9, ['9'] = 10,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+  };
+  return (int32_t)lookup[c] - 1;
+}
+
+static inline int32_t hex_pair(const uint8_t *s) {
+  return hex_value(s[0]) * 16 | hex_value(s[1]);
+}
+
+size_t simd_hex_decode(const char *src, size_t len, uint8_t *dst) {
+  const uint8_t *s = (const uint8_t *)src;
+  size_t count = len / 2;
+  size_t i = 0;
+
+  for (; i + 4 <= count; i += 4) {
+    int32_t a = hex_pair(s + i * 2);
+    int32_t b = hex_pair(s + i * 2 + 2);
+    int32_t c = hex_pair(s + i * 2 + 4);
+    int32_t d = hex_pair(s + i * 2 + 6);
+    if ((a | b | c | d) < 0) break;
+    dst[i + 0] = (uint8_t)a;
+    dst[i + 1] = (uint8_t)b;
+    dst[i + 2] = (uint8_t)c;
+    dst[i + 3] = (uint8_t)d;
+  }
+
+  for (; i < count; i++) {
+    int32_t v = hex_pair(s + i * 2);
+    if (v < 0) break;
+    dst[i] = (uint8_t)v;
+  }
+
+  return i;
+}
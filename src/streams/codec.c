@@ -225,6 +225,7 @@ static ant_value_t js_tes_ctor(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t ts_obj = js_construct_native(js, js_ts_ctor, ctor_args, 1);
 
   if (is_err(ts_obj)) { free(st); return ts_obj; }
+  ts_mark_native(js, ts_obj);
   js_set_slot(obj, SLOT_ENTRIES, ts_obj);
   js_set_slot_wb(js, transform_fn, SLOT_ENTRIES, obj);
   js_set_slot_wb(js, flush_fn, SLOT_ENTRIES, obj);
@@ -394,6 +395,7 @@ static ant_value_t js_tds_ctor(ant_t *js, ant_value_t *args, int nargs) {
   ant_value_t ts_obj = js_construct_native(js, js_ts_ctor, ctor_args, 1);
 
   if (is_err(ts_obj)) { free(st); return ts_obj; }
+  ts_mark_native(js, ts_obj);
   js_set_slot(obj, SLOT_ENTRIES, ts_obj);
   js_set_slot_wb(js, transform_fn, SLOT_ENTRIES, obj);
   js_set_slot_wb(js, flush_fn, SLOT_ENTRIES, obj);
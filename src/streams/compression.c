@@ -261,6 +261,7 @@ static ant_value_t js_cs_ctor(ant_t *js, ant_value_t *args, int nargs) {
     else { deflateEnd(&st->strm); free(st); }
     return ts_obj;
   }
+  ts_mark_native(js, ts_obj);
   js_set_slot(obj, SLOT_ENTRIES, ts_obj);
   js_set_slot_wb(js, transform_fn, SLOT_ENTRIES, obj);
   js_set_slot_wb(js, flush_fn, SLOT_ENTRIES, obj);
@@ -382,6 +383,7 @@ static ant_value_t js_ds_ctor(ant_t *js, ant_value_t *args, int nargs) {
     else { inflateEnd(&st->strm); free(st); }
     return ts_obj;
   }
+  ts_mark_native(js, ts_obj);
 
   js_set_slot(obj, SLOT_ENTRIES, ts_obj);
   js_set_slot_wb(js, transform_fn, SLOT_ENTRIES, obj);
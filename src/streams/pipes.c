@@ -21,8 +21,14 @@ typedef struct {
   bool prevent_close;
   bool prevent_abort;
   bool prevent_cancel;
+  bool native;
+  bool settle_pending;
+  bool settle_ok;
 } pipe_state_t;
 
+// chunks moved synchronously per turn before yielding back to the loop
+#define PIPE_NATIVE_BATCH 64
+
 enum {
   PIPE_STATE_NATIVE_TAG = 0x50495045u, // PIPE
   TEE_STATE_NATIVE_TAG = 0x54454553u   // TEES
@@ -81,6 +87,11 @@ static ant_value_t pipe_state_promise(ant_value_t state) {
   return js_get_slot(state, SLOT_RS_PULL);
 }
 
+// the last write handed to a native sink, which the pipe does not wait on
+static ant_value_t pipe_state_last_write(ant_value_t state) {
+  return js_get_slot(state, SLOT_WS_WRITE);
+}
+
 static void pipes_release_reader(ant_t *js, ant_value_t reader_obj) {
   ant_value_t stream_obj = rs_reader_stream(reader_obj);
   if (!rs_is_stream(stream_obj)) return;
@@ -141,12 +152,9 @@ static void pipes_release_locks(ant_t *js, ant_value_t state) {
   }
 }
 
-static void pipes_settle(ant_t *js, ant_value_t state, bool ok, ant_value_t value) {
+static void pipes_finish(ant_t *js, ant_value_t state, bool ok, ant_value_t value) {
   pipe_state_t *pst = pipe_get_state(state);
-  if (!pst || pst->settled) return;
-
   pst->settled = true;
-  pst->shutting_down = true;
   pipes_release_locks(js, state);
 
   ant_value_t promise = pipe_state_promise(state);
@@ -154,6 +162,35 @@ static void pipes_settle(ant_t *js, ant_value_t state, bool ok, ant_value_t valu
   else js_reject_promise(js, promise, value);
 }
 
+static ant_value_t pipe_last_write_settled(ant_t *js, ant_value_t *args, int nargs) {
+  ant_value_t state = js_get_slot(js->current_func, SLOT_DATA);
+  pipe_state_t *pst = pipe_get_state(state);
+  if (!pst || pst->settled) return js_mkundef();
+  pipes_finish(js, state, pst->settle_ok, js_get_slot(state, SLOT_WS_CLOSE));
+  return js_mkundef();
+}
+
+static void pipes_settle(ant_t *js, ant_value_t state, bool ok, ant_value_t value) {
+  pipe_state_t *pst = pipe_get_state(state);
+  if (!pst || pst->settled || pst->settle_pending) return;
+  pst->shutting_down = true;
+
+  // writes to a native sink go out without being awaited, so the locks
+  // stay held and the result waits until the last of them has finished
+  ant_value_t last_write = pipe_state_last_write(state);
+  if (vtype(last_write) == T_PROMISE) {
+    pst->settle_pending = true;
+    pst->settle_ok = ok;
+    js_set_slot_wb(js, state, SLOT_WS_CLOSE, value);
+    js_set_slot(state, SLOT_WS_WRITE, js_mkundef());
+    ant_value_t on_settled = js_heavy_mkfun(js, pipe_last_write_settled, state);
+    pipes_chain_promise(js, last_write, on_settled, on_settled);
+    return;
+  }
+
+  pipes_finish(js, state, ok, value);
+}
+
 static void pipes_shutdown_from_source_error(ant_t *js, ant_value_t state, ant_value_t error) {
   pipe_state_t *pst = pipe_get_state(state);
   if (!pst || pst->settled || pst->shutting_down) return;
@@ -268,6 +305,18 @@ static ant_value_t pipe_read_resolve(ant_t *js, ant_value_t *args, int nargs) {
 
   ant_value_t value = js_get(js, result, "value");
   ant_value_t write_promise = ws_writer_write(js, pipe_state_writer(state), value);
+  
+  // a native sink reports failures through the writer's closed promise,
+  // so there is no need to wait for this write before reading again; only
+  // settling the pipe waits for it
+  if (pst->native) {
+    promise_mark_handled(write_promise);
+    js_set_slot_wb(js, state, SLOT_WS_WRITE, write_promise);
+    pst->in_flight = false;
+    pipes_pump(js, state);
+    return js_mkundef();
+  }
+  
   ant_value_t on_resolve = js_heavy_mkfun(js, pipe_write_resolve, state);
   ant_value_t on_reject = js_heavy_mkfun(js, pipe_dest_error, state);
   pipes_chain_promise(js, write_promise, on_resolve, on_reject);
@@ -307,10 +356,43 @@ static ant_value_t pipe_abort_listener(ant_t *js, ant_value_t *args, int nargs)
   return js_mkundef();
 }
 
+// moves whatever the source already has queued straight into the sink
+// while the sink has no backpressure, without read or ready promises
+static void pipes_pump_native(ant_t *js, ant_value_t state) {
+  pipe_state_t *pst = pipe_get_state(state);
+  ant_value_t reader = pipe_state_reader(state);
+  ant_value_t writer = pipe_state_writer(state);
+  ant_value_t dest = pipe_state_dest(state);
+
+  for (int i = 0; i < PIPE_NATIVE_BATCH; i++) {
+    ws_stream_t *ws = ws_get_stream(dest);
+    ant_value_t chunk = js_mkundef();
+    
+    if (pst->settled || pst->shutting_down) return;
+    if (!ws || ws->state != WS_STATE_WRITABLE || ws->backpressure) return;
+    if (writable_stream_close_queued_or_in_flight(dest)) return;
+    if (!rs_default_reader_take(js, reader, &chunk)) return;
+
+    GC_ROOT_SAVE(root_mark, js);
+    GC_ROOT_PIN(js, chunk);
+    ant_value_t write_promise = ws_writer_write(js, writer, chunk);
+    promise_mark_handled(write_promise);
+    js_set_slot_wb(js, state, SLOT_WS_WRITE, write_promise);
+    GC_ROOT_RESTORE(js, root_mark);
+  }
+}
+
 static void pipes_pump(ant_t *js, ant_value_t state) {
   pipe_state_t *pst = pipe_get_state(state);
   if (!pst || pst->settled || pst->shutting_down || pst->in_flight) return;
 
+  if (pst->native) {
+    pst->in_flight = true;
+    pipes_pump_native(js, state);
+    pst->in_flight = false;
+    if (pst->settled || pst->shutting_down) return;
+  }
+
   pst->in_flight = true;
 
   ant_value_t writer = pipe_state_writer(state);
@@ -387,6 +469,7 @@ ant_value_t readable_stream_pipe_to(
   pst->prevent_close = prevent_close;
   pst->prevent_abort = prevent_abort;
   pst->prevent_cancel = prevent_cancel;
+  pst->native = rs_stream_has_native_source(js, source) && ws_stream_has_native_sink(dest);
 
   ant_value_t promise = js_mkpromise(js);
   ant_value_t state = js_mkobj(js);
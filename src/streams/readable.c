@@ -7,6 +7,7 @@
 #include "internal.h"
 #include "descriptors.h"
 
+#include "gc/roots.h"
 #include "silver/engine.h"
 #include "modules/symbol.h"
 #include "modules/assert.h"
@@ -357,6 +358,58 @@ void rs_default_controller_call_pull_if_needed(ant_t *js, ant_value_t controller
   } else ctrl->pulling = false;
 }
 
+static ant_value_t rs_ctrl_dequeue(ant_t *js, ant_value_t stream_obj, ant_value_t ctrl_obj, rs_controller_t *ctrl) {
+  ant_value_t chunk = rs_ctrl_queue_shift(js, ctrl_obj);
+  double chunk_size = 1;
+  
+  if (ctrl->queue_sizes_len > 0) {
+    chunk_size = ctrl->queue_sizes[0];
+    ctrl->queue_sizes_len--;
+    memmove(ctrl->queue_sizes, ctrl->queue_sizes + 1, ctrl->queue_sizes_len * sizeof(double));
+  }
+  
+  ctrl->queue_total_size -= chunk_size;
+  if (ctrl->queue_total_size < 0) ctrl->queue_total_size = 0;
+  
+  return chunk;
+}
+
+static void rs_ctrl_after_dequeue(ant_t *js, ant_value_t stream_obj, ant_value_t ctrl_obj, rs_controller_t *ctrl) {
+  if (ctrl->close_requested && rs_ctrl_queue_len(js, ctrl_obj) == 0) {
+    rs_default_controller_clear_algorithms(ctrl_obj);
+    readable_stream_close(js, stream_obj);
+  } else rs_default_controller_call_pull_if_needed(js, ctrl_obj);
+}
+
+// a source is native when its chunks come from C (pull algorithm and size
+// are ours), so reading it synchronously can't reorder user callbacks
+bool rs_stream_has_native_source(ant_t *js, ant_value_t stream_obj) {
+  rs_controller_t *ctrl = rs_get_controller(rs_stream_controller(js, stream_obj));
+  return ctrl && ctrl->native;
+}
+
+// takes a queued chunk for the reader without creating a read promise,
+// returns false when nothing is queued and the caller has to read()
+bool rs_default_reader_take(ant_t *js, ant_value_t reader_obj, ant_value_t *chunk_out) {
+  ant_value_t stream_obj = rs_reader_stream(reader_obj);
+  rs_stream_t *stream = rs_get_stream(stream_obj);
+  if (!stream || stream->state != RS_STATE_READABLE) return false;
+
+  ant_value_t ctrl_obj = rs_stream_controller(js, stream_obj);
+  rs_controller_t *ctrl = rs_get_controller(ctrl_obj);
+  if (!ctrl || rs_ctrl_queue_len(js, ctrl_obj) == 0) return false;
+
+  stream->disturbed = true;
+  *chunk_out = rs_ctrl_dequeue(js, stream_obj, ctrl_obj, ctrl);
+  
+  GC_ROOT_SAVE(root_mark, js);
+  GC_ROOT_PIN(js, *chunk_out);
+  rs_ctrl_after_dequeue(js, stream_obj, ctrl_obj, ctrl);
+  GC_ROOT_RESTORE(js, root_mark);
+  
+  return true;
+}
+
 ant_value_t rs_default_reader_read(ant_t *js, ant_value_t reader_obj) {
   ant_value_t stream_obj = rs_reader_stream(reader_obj);
   rs_stream_t *stream = rs_get_stream(stream_obj);
@@ -378,23 +431,9 @@ ant_value_t rs_default_reader_read(ant_t *js, ant_value_t reader_obj) {
   ant_value_t ctrl_obj = rs_stream_controller(js, stream_obj);
   rs_controller_t *ctrl = rs_get_controller(ctrl_obj);
   if (ctrl && rs_ctrl_queue_len(js, ctrl_obj) > 0) {
-    ant_value_t chunk = rs_ctrl_queue_shift(js, ctrl_obj);
-    double chunk_size = 1;
-    if (ctrl->queue_sizes_len > 0) {
-      chunk_size = ctrl->queue_sizes[0];
-      ctrl->queue_sizes_len--;
-      memmove(ctrl->queue_sizes, ctrl->queue_sizes + 1, ctrl->queue_sizes_len * sizeof(double));
-    }
-    ctrl->queue_total_size -= chunk_size;
-    if (ctrl->queue_total_size < 0) ctrl->queue_total_size = 0;
-    bool should_close = ctrl->close_requested && rs_ctrl_queue_len(js, ctrl_obj) == 0;
     ant_value_t p = js_mkpromise(js);
-    js_resolve_promise(js, p, js_iter_result(js, true, chunk));
-    if (should_close) {
-      rs_default_controller_clear_algorithms(ctrl_obj);
-      readable_stream_close(js, stream_obj);
-    } else rs_default_controller_call_pull_if_needed(js, ctrl_obj);
-
+    js_resolve_promise(js, p, js_iter_result(js, true, rs_ctrl_dequeue(js, stream_obj, ctrl_obj, ctrl)));
+    rs_ctrl_after_dequeue(js, stream_obj, ctrl_obj, ctrl);
     return p;
   }
 
@@ -942,6 +981,7 @@ ant_value_t rs_create_stream(ant_t *js, ant_value_t pull_fn, ant_value_t cancel_
 
   ant_value_t ctrl_obj = setup_default_controller(js, obj, pull_fn, cancel_fn, js_mkundef(), hwm);
   if (is_err(ctrl_obj)) return ctrl_obj;
+  rs_get_controller(ctrl_obj)->native = true;
 
   ant_value_t resolved = js_mkpromise(js);
   js_resolve_promise(js, resolved, js_mkundef());
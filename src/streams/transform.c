@@ -1034,6 +1034,16 @@ ant_value_t js_ts_ctor(ant_t *js, ant_value_t *args, int nargs) {
   return ts_obj;
 }
 
+// only transforms whose algorithms are ours (TextEncoderStream,
+// CompressionStream, ...) are native; a user transformer may depend on the
+// pipe waiting for each write before the next read
+void ts_mark_native(ant_t *js, ant_value_t ts_obj) {
+  rs_controller_t *rcc = rs_get_controller(rs_stream_controller(js, ts_stream_readable(ts_obj)));
+  ws_controller_t *wc = ws_get_controller(ws_stream_controller(ts_stream_writable(ts_obj)));
+  if (rcc) rcc->native = true;
+  if (wc) wc->native = true;
+}
+
 static ant_value_t js_ts_ctrl_ctor(ant_t *js, ant_value_t *args, int nargs) {
   return js_mkerr_typed(js, JS_ERR_TYPE, "TransformStreamDefaultController cannot be constructed directly");
 }
@@ -216,6 +216,11 @@ static bool ws_default_controller_get_backpressure(ws_controller_t *ctrl) {
   return ws_default_controller_get_desired_size(ctrl) <= 0;
 }
 
+bool ws_stream_has_native_sink(ant_value_t stream_obj) {
+  ws_controller_t *ctrl = ws_get_controller(ws_stream_controller(stream_obj));
+  return ctrl && ctrl->native;
+}
+
 bool writable_stream_close_queued_or_in_flight(ant_value_t stream_obj) {
   ant_value_t cr = ws_stream_close_request(stream_obj);
   ant_value_t icr = ws_stream_in_flight_close(stream_obj);
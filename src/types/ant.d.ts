@@ -65,6 +65,12 @@ interface AntExternalMemory {
   total: number;
 }
 
+interface AntObjectClassStats {
+  slots: number;
+  live: number;
+  committed: number;
+}
+
 interface AntAllocStats {
   objectCount: number;
   objects: number;
@@ -74,6 +80,7 @@ interface AntAllocStats {
   proxies: number;
   exotic: number;
   arrays: number;
+  objectClasses: AntObjectClassStats[];
   shapes: number;
   closures: number;
   upvalues: number;
@@ -181,9 +188,19 @@ interface AntGcMarkProfile {
 interface AntWebSocketOptions {
   idleTimeout?: number;
   maxPayloadLength?: number;
+  backpressureLimit?: number;
   perMessageDeflate?: boolean | object;
 }
 
+interface AntTLSOptions {
+  cert: string | BufferSource;
+  key: string | BufferSource;
+  passphrase?: string;
+  sessionTimeout?: number;
+  sessionTickets?: boolean;
+  kernelTLS?: boolean;
+}
+
 interface AntServeOptions {
   fetch(request: Request, server: AntServer): Response | Promise<Response>;
   port?: number;
@@ -191,8 +208,9 @@ interface AntServeOptions {
   unix?: string;
   idleTimeout?: number;
   requestTimeout?: number;
+  multipartSpillThreshold?: number;
   websocket?: AntWebSocketOptions;
-  tls?: unknown;
+  tls?: AntTLSOptions;
 }
 
 interface AntRequestIP {
@@ -200,8 +218,15 @@ interface AntRequestIP {
   port: number;
 }
 
+interface AntServerWebSocket extends WebSocket {
+  subscribe(topic: string): void;
+  unsubscribe(topic: string): void;
+  isSubscribed(topic: string): boolean;
+  publish(topic: string, data: string | BufferSource): number;
+}
+
 interface AntWebSocketUpgrade {
-  socket: WebSocket;
+  socket: AntServerWebSocket;
   response: Response;
 }
 
@@ -222,6 +247,8 @@ interface AntServer {
   stop(force?: boolean): Promise<void>;
   upgradeWebSocket(request: Request): AntWebSocketUpgrade;
   eventSource(): AntEventSourceStream;
+  publish(topic: string, data: string | BufferSource): number;
+  subscriberCount(topic: string): number;
 }
 
 interface AntCronOptions {
@@ -294,6 +321,7 @@ interface AntStatic {
   usleep(microseconds: number): void;
 
   signal(signum: number, handler: (signum: number) => void): void;
+  file(path: string, options?: { type?: string }): File;
   serve(options: AntServeOptions): AntServer;
   cron: AntCron;
 }
@@ -1,4 +1,5 @@
 #include "utf8.h"
+#include "simd.h"
 #include "utils.h"
 #include "internal.h"
 #include "gc/strings.h"
@@ -198,6 +199,17 @@ const utf16_index_entry_t *utf16_index_build(
 
   while (p < end) {
     size_t slen, units;
+    if (*p < 0x80) {
+      size_t room = point_count * UTF16_INDEX_CHUNK - utf16_pos;
+      size_t avail = (size_t)(end - p);
+      size_t run = simd_ascii_prefix(p, room < avail ? room : avail);
+      if (run > 0) {
+        p += run;
+        utf16_pos += run;
+        continue;
+      }
+    }
+
     utf16_scan_decode(p, end, &slen, &units, NULL);
 
     if (
@@ -300,6 +312,21 @@ static inline bool utf16_scan_cursor_advance(
   return true;
 }
 
+// consumes a run of ASCII bytes, at most max_units of them, in one step
+static inline bool utf16_scan_cursor_skip_ascii(
+  utf16_scan_cursor_t *cursor,
+  size_t max_units
+) {
+  size_t avail = (size_t)(cursor->end - cursor->p);
+  if (max_units < avail) avail = max_units;
+  if (avail == 0 || *cursor->p >= 0x80) return false;
+
+  size_t run = simd_ascii_prefix(cursor->p, avail);
+  cursor->p += run;
+  cursor->utf16_pos += run;
+  return true;
+}
+
 static bool utf8_json_quote_reserve(char **buf, size_t *cap, size_t need) {
   if (need <= *cap) return true;
 
@@ -388,6 +415,13 @@ char *utf8_json_quote(const char *str, size_t byte_len, size_t *out_len) {
 
   size_t i = 0;
   while (i < byte_len) {
+    size_t run = simd_json_safe_prefix(str + i, byte_len - i);
+    if (run > 0) {
+      if (!utf8_json_quote_append(&raw, &raw_len, &raw_cap, &str[i], run)) goto oom;
+      i += run;
+      continue;
+    }
+
     unsigned char c = (unsigned char)str[i];
 
     if (c < 0x80) {
@@ -515,6 +549,11 @@ size_t utf8_strlen(const char *str, size_t byte_len) {
   const unsigned char *p = (const unsigned char *)str;
   const unsigned char *end = p + byte_len;
   while (p < end) {
+    if (*p < 0x80) {
+      size_t run = simd_ascii_prefix(p, (size_t)(end - p));
+      count += run; p += run;
+      continue;
+    }
     int seq_len = utf8_sequence_length(*p);
     if (seq_len <= 0 || (size_t)seq_len > (size_t)(end - p)) {
       count++; p++;
@@ -527,8 +566,10 @@ size_t utf16_strlen(const char *str, size_t byte_len) {
   utf16_scan_cursor_t cursor;
   utf16_scan_cursor_init(&cursor, str, byte_len);
 
-  while (cursor.p < cursor.end)
+  while (cursor.p < cursor.end) {
+    if (utf16_scan_cursor_skip_ascii(&cursor, SIZE_MAX)) continue;
     utf16_scan_cursor_advance(&cursor, cursor.end);
+  }
 
   return cursor.utf16_pos;
 }
@@ -540,7 +581,7 @@ bool utf8_validate_bytes(const char *str, size_t len) {
   while (s < end) {
     unsigned char c = *s;
     if (c < 0x80) {
-      s++;
+      s += simd_ascii_prefix(s, (size_t)(end - s));
       continue;
     }
 
@@ -702,6 +743,7 @@ int utf16_index_to_byte_offset(
   utf16_scan_cursor_resume_indexed(&cursor, utf16_idx);
   
   while (cursor.p < cursor.end && cursor.utf16_pos < utf16_idx) {
+    if (utf16_scan_cursor_skip_ascii(&cursor, utf16_idx - cursor.utf16_pos)) continue;
     utf16_scan_cursor_advance(&cursor, cursor.end);
   }
   
@@ -738,6 +780,7 @@ size_t utf16_index_to_byte_offset_floor(
   utf16_scan_cursor_resume_utf16(&cursor, utf16_idx);
 
   while (cursor.p < cursor.end && cursor.utf16_pos < utf16_idx) {
+    if (utf16_scan_cursor_skip_ascii(&cursor, utf16_idx - cursor.utf16_pos)) continue;
     size_t slen, units;
     utf16_scan_decode(cursor.p, cursor.end, &slen, &units, NULL);
     if (cursor.utf16_pos + units > utf16_idx) break;
@@ -775,6 +818,7 @@ utf16_range_splits_t utf16_range_to_byte_range(
   utf16_scan_cursor_resume_indexed(&cursor, utf16_start);
 
   while (cursor.p < cursor.end && cursor.utf16_pos < utf16_start) {
+    if (utf16_scan_cursor_skip_ascii(&cursor, utf16_start - cursor.utf16_pos)) continue;
     size_t slen, units;
     utf16_scan_decode(cursor.p, cursor.end, &slen, &units, NULL);
 
@@ -793,6 +837,7 @@ utf16_range_splits_t utf16_range_to_byte_range(
 
   *byte_start = (size_t)(cursor.p - cursor.start);
   while (cursor.p < cursor.end && cursor.utf16_pos < utf16_end) {
+    if (utf16_scan_cursor_skip_ascii(&cursor, utf16_end - cursor.utf16_pos)) continue;
     size_t slen, units;
     utf16_scan_decode(cursor.p, cursor.end, &slen, &units, NULL);
 
@@ -825,6 +870,7 @@ size_t byte_offset_to_utf16(const char *str, size_t byte_off) {
   bound_end = cursor.start + byte_off;
 
   while (cursor.p < bound_end) {
+    if (utf16_scan_cursor_skip_ascii(&cursor, (size_t)(bound_end - cursor.p))) continue;
     if (!utf16_scan_cursor_advance(&cursor, bound_end)) {
       ended_on_boundary = false;
       break;
@@ -854,6 +900,11 @@ uint32_t utf16_code_unit_at(const char *str, size_t byte_len, size_t utf16_idx)
     size_t slen, units;
     uint32_t cp;
     
+    if (
+      cursor.utf16_pos < utf16_idx &&
+      utf16_scan_cursor_skip_ascii(&cursor, utf16_idx - cursor.utf16_pos)
+    ) continue;
+    
     utf16_scan_decode(cursor.p, cursor.end, &slen, &units, &cp);
     
     if (cursor.utf16_pos == utf16_idx) {
@@ -905,10 +956,14 @@ utf8proc_ssize_t utf8_whatwg_decode(
   if (!len) goto done;
   goto *tbl[src[0]];
 
-L_ASCII:
+L_ASCII: {
   dec->bom_seen = true;
-  out[o++] = (char)src[i];
-  NEXT();
+  size_t run = simd_ascii_prefix(src + i, len - i);
+  memcpy(out + o, src + i, run);
+  o += run; i += run;
+  if (i < len) goto *tbl[src[i]];
+  goto done;
+}
 
 L_LONE:
 L_BAD:
@@ -972,6 +1027,11 @@ uint32_t utf16_codepoint_at(const char *str, size_t byte_len, size_t utf16_idx)
     size_t slen, units;
     uint32_t cp;
     
+    if (
+      cursor.utf16_pos < utf16_idx &&
+      utf16_scan_cursor_skip_ascii(&cursor, utf16_idx - cursor.utf16_pos)
+    ) continue;
+    
     utf16_scan_decode(cursor.p, cursor.end, &slen, &units, &cp);
     
     if (cursor.utf16_pos == utf16_idx) {
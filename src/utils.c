@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <uv.h>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -14,6 +15,7 @@
 #define ANT_MKDIR(path) _mkdir(path)
 #else
 #include <limits.h>
+#include <pthread.h>
 #include <unistd.h>
 #define ANT_MKDIR(path) mkdir(path, 0755)
 #endif
@@ -31,6 +33,41 @@ const char *const module_resolve_extensions[] = {
 static _Thread_local skim_context_t ts_strip_context;
 static _Thread_local bool ts_strip_context_ready;
 
+// threadpool workers strip module sources too, so each thread's context is
+// registered with a key whose destructor frees it when the thread exits
+static uv_once_t ts_strip_key_once = UV_ONCE_INIT;
+
+#ifdef _WIN32
+static DWORD ts_strip_key = FLS_OUT_OF_INDEXES;
+
+static void WINAPI free_ts_strip_context(void *context) {
+  if (context) skim_context_free((skim_context_t *)context);
+}
+
+static void create_ts_strip_key(void) {
+  ts_strip_key = FlsAlloc(free_ts_strip_context);
+}
+
+static void register_ts_strip_context(void) {
+  if (ts_strip_key != FLS_OUT_OF_INDEXES) FlsSetValue(ts_strip_key, &ts_strip_context);
+}
+#else
+static pthread_key_t ts_strip_key;
+static bool ts_strip_key_ready;
+
+static void free_ts_strip_context(void *context) {
+  skim_context_free((skim_context_t *)context);
+}
+
+static void create_ts_strip_key(void) {
+  ts_strip_key_ready = pthread_key_create(&ts_strip_key, free_ts_strip_context) == 0;
+}
+
+static void register_ts_strip_context(void) {
+  if (ts_strip_key_ready) pthread_setspecific(ts_strip_key, &ts_strip_context);
+}
+#endif
+
 static int ensure_ts_strip_context(const char **error_detail) {
   if (ts_strip_context_ready) return 0;
 
@@ -39,6 +76,9 @@ static int ensure_ts_strip_context(const char **error_detail) {
     return SKIM_ERR_TRANSFORM_FAILED;
   }
 
+  uv_once(&ts_strip_key_once, create_ts_strip_key);
+  register_ts_strip_context();
+
   ts_strip_context_ready = true;
   return 0;
 }
@@ -0,0 +1,97 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ant-esm-load-'));
+const write = (name, body) => fs.writeFileSync(path.join(dir, name), body);
+
+const fanout = 60;
+const imports = [];
+for (let i = 0; i < fanout; i++) {
+  const ts = i % 3 === 0;
+  const file = `leaf${i}.${ts ? 'mts' : 'mjs'}`;
+  const value = ts ? `const v: number = ${i};\nexport const value = v;` : `export const value = ${i};`;
+  write(file, `globalThis.__order.push(${i});\n${value}\n`);
+  imports.push(`import { value as v${i} } from './${file}';`);
+}
+
+// a chain only the workers see past its first link, with a TypeScript file
+// and a re-export in the middle
+const depth = 12;
+for (let i = 0; i < depth; i++) {
+  const next = i + 1 < depth ? `import { level as below } from './deep${i + 1}.${(i + 1) % 4 === 0 ? 'mts' : 'mjs'}';\n` : '';
+  const body = i + 1 < depth ? 'export const level = below + 1;' : 'export const level = 1;';
+  write(`deep${i}.${i % 4 === 0 ? 'mts' : 'mjs'}`, `${next}globalThis.__order.push("deep${i}");\n${body}\n`);
+}
+write('deep_entry.mjs', 'export { level } from "./deep0.mts";\n');
+
+write('shared.mjs', 'globalThis.__order.push("shared");\nexport let hits = 0;\nexport function hit() { return ++hits; }\n');
+write('cycle_a.mjs', 'import { b } from "./cycle_b.mjs";\nexport const a = "a";\nexport const ab = () => a + b;\n');
+write('cycle_b.mjs', 'import { ab } from "./cycle_a.mjs";\nexport const b = "b";\nexport const ba = () => ab();\n');
+
+const sum = Array.from({ length: fanout }, (_, i) => `v${i}`).join(' + ');
+write('main.mjs', [
+  'globalThis.__order.push("main-start");',
+  'import { hit } from "./shared.mjs";',
+  ...imports,
+  'import { hit as hitAgain } from "./shared.mjs";',
+  'import { ba } from "./cycle_b.mjs";',
+  'import { level } from "./deep_entry.mjs";',
+  `export const total = ${sum};`,
+  'export const hits = [hit(), hitAgain()];',
+  'export const cycle = ba();',
+  'export const deep = level;',
+].join('\n'));
+
+write('broken.mjs', 'import "./leaf0.mjs";\nimport "./missing.mjs";\n');
+write('late.mjs', 'export const version = "prefetched";\n');
+write('broken_late.mjs', 'import "./missing.mjs";\nimport "./late.mjs";\n');
+write('bad_ts.mts', 'import "./leaf1.mjs";\nexport const x: = 1;\n');
+
+globalThis.__order = [];
+
+(async () => {
+  const main = await import(path.join(dir, 'main.mjs'));
+  equal(main.total, (fanout * (fanout - 1)) / 2, 'all leaves loaded, TypeScript ones stripped');
+  equal(main.hits.join(','), '1,2', 'a module imported twice is evaluated once');
+  equal(main.cycle, 'ab', 'cyclic imports link');
+
+  const order = globalThis.__order;
+  equal(order[0], 'shared', 'first import evaluates first');
+  for (let i = 0; i < fanout; i++) equal(order[i + 1], i, `evaluation order stays in source order at ${i}`);
+  equal(order[order.length - 1], 'main-start', 'importer body runs after its dependencies');
+  equal(main.deep, depth, 'a deep import chain links through every level');
+  const deepOrder = order.filter(entry => String(entry).startsWith('deep'));
+  equal(deepOrder.join(','), Array.from({ length: depth }, (_, i) => `deep${depth - 1 - i}`).join(','), 'deepest module evaluates first');
+
+  let missing = null;
+  try { await import(path.join(dir, 'broken.mjs')); } catch (e) { missing = e; }
+  assert(missing && /missing\.mjs/.test(String(missing.message)), 'missing dependency still reports its specifier');
+
+  // the link loop stops at the missing import, so the source queued for
+  // late.mjs is dropped instead of being served to a later import
+  let stopped = null;
+  try { await import(path.join(dir, 'broken_late.mjs')); } catch (e) { stopped = e; }
+  assert(stopped !== null, 'link stops at the missing dependency');
+  write('late.mjs', 'export const version = "current";\n');
+  const late = await import(path.join(dir, 'late.mjs'));
+  equal(late.version, 'current', 'an untaken prefetch is not reused later');
+
+  let syntax = null;
+  try { await import(path.join(dir, 'bad_ts.mts')); } catch (e) { syntax = e; }
+  assert(syntax !== null, 'TypeScript strip errors still surface');
+
+  fs.rmSync(dir, { recursive: true, force: true });
+  console.log('PASS');
+})();
@@ -30,6 +30,12 @@ assert(abs.address() > 0, 'FFIFunction.address() should expose a native address'
 assert(abs(-7) === 7, 'FFIFunction should be callable directly');
 assert(libc.call('abs', -9) === 9, 'FFILibrary.call() should dispatch through defined wrappers');
 
+let hotSum = 0;
+for (let i = 0; i < 200; i++) hotSum += abs(-i);
+assert(hotSum === 19900, 'hot FFIFunction calls should keep returning native results');
+assert(abs(-2.75) === 2, 'hot FFIFunction calls should truncate doubles like the generic path');
+expectThrow(() => abs(), 'hot FFIFunctions should still validate argument counts');
+
 const strlen = libc.define('strlen', {
   args: [FFIType.string],
   returns: FFIType.int
@@ -91,6 +97,7 @@ const closableAbs = closable.define('abs', {
   args: [FFIType.int],
   returns: FFIType.int
 });
+for (let i = 0; i < 64; i++) closableAbs(-i);
 closable.close();
 expectThrow(() => closableAbs(-1), 'FFIFunctions should fail once their library is closed');
 
@@ -0,0 +1,46 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+function add(a, b) {
+  return a + b;
+}
+
+let total = 0;
+for (let i = 0; i < 20000; i++) total = add(total, i);
+equal(total, (19999 * 20000) / 2, 'hot call stays correct while compiling');
+
+function loop(n) {
+  let s = 0;
+  for (let i = 0; i < n; i++) s += i & 7;
+  return s;
+}
+
+for (let round = 0; round < 50; round++) {
+  equal(loop(1000), 3500, `back-edge hot loop round ${round}`);
+}
+
+function mixed(x) {
+  return typeof x === 'number' ? x * 2 : String(x) + '!';
+}
+
+for (let i = 0; i < 5000; i++) mixed(i);
+equal(mixed(21), 42, 'number feedback');
+equal(mixed('a'), 'a!', 'string after number feedback');
+
+if (typeof Ant !== 'undefined' && Ant.stats().jit) {
+  const jit = Ant.stats().jit;
+  equal(typeof jit.background, 'boolean', 'background flag');
+  assert(jit.installed + jit.failed <= jit.queued || !jit.background, 'installs never exceed queued jobs');
+  assert(jit.queueDepth >= 0, 'queue depth');
+  assert(jit.maxCompileMs <= jit.compileMs || jit.installed === 0, 'max compile time within total');
+}
+
+console.log('PASS');
@@ -0,0 +1,42 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+function makeKernel(k) {
+  return new Function('x', `return (x * ${k} + ${k}) | 0;`);
+}
+
+for (let round = 0; round < 3; round++) {
+  for (let k = 0; k < 200; k++) {
+    const kernel = makeKernel(k);
+    let acc = 0;
+    for (let i = 0; i < 300; i++) acc = (acc + kernel(i)) | 0;
+    equal(acc, (k * (299 * 300) / 2 + k * 300) | 0, `kernel ${k} round ${round}`);
+  }
+  if (typeof gc === 'function') gc();
+}
+
+function survivor(a, b) {
+  return a * b + 1;
+}
+
+let total = 0;
+for (let i = 0; i < 5000; i++) total += survivor(i, 2);
+equal(total, 2 * (4999 * 5000) / 2 + 5000, 'long-lived function after churn');
+
+if (typeof Ant !== 'undefined' && Ant.stats().jit && 'codeBytes' in Ant.stats().jit) {
+  const jit = Ant.stats().jit;
+  assert(jit.codeBytes <= jit.peakCodeBytes, 'live code within peak');
+  assert(jit.peakCodeBytes <= jit.budget + jit.budget / 4 || jit.functions <= 1, 'peak bounded by budget');
+  assert(jit.residentBytes >= jit.codeBytes, 'resident spaces cover live code');
+  assert(jit.reclaimedSpaces >= 0 && jit.evicted >= 0 && jit.collected >= 0, 'counters');
+}
+
+console.log('PASS');
@@ -0,0 +1,215 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(Object.is(actual, expected), `${message}: expected ${expected}, got ${actual}`);
+}
+
+let cleanups = 0;
+
+// try/finally keeps the function as a whole in the interpreter, the loop
+// after it is compiled on its own
+function sumAfterFinally(n) {
+  let setup = 0;
+  try { setup = n * 2; } finally { cleanups++; }
+  let s = 0;
+  for (let i = 0; i < n; i++) s += i;
+  const after = s + setup;
+  return after;
+}
+equal(sumAfterFinally(2000), 1999000 + 4000, 'locals written by the loop are seen after it');
+equal(cleanups, 1, 'finally ran once');
+
+function large(n) {
+  const parts = [];
+  try { parts.push('a'); } finally { parts.push('b'); }
+  let acc = 0;
+  for (let i = 0; i < n; i++) {
+    acc = (acc + i * 3) % 1000003;
+    if (i % 7 === 0) acc = acc ^ 5;
+    if (i % 11 === 0) acc = acc + (i >> 2);
+    if (i % 13 === 0) acc = acc - (i & 15);
+    if (i % 17 === 0) acc = acc * 2 % 1000003;
+  }
+  parts.push(String(acc));
+  const a = parts.join('-');
+  const b = a.length + parts.length;
+  const c = `${a}:${b}`;
+  const d = c.split(':').map((x) => x.length);
+  const e = d.reduce((x, y) => x + y, 0);
+  const f = { a, b, c, d, e };
+  const g = Object.keys(f).length + Object.values(f).length;
+  return `${c}/${g}/${e}`;
+}
+function largeRef(n) {
+  let acc = 0;
+  for (let i = 0; i < n; i++) {
+    acc = (acc + i * 3) % 1000003;
+    if (i % 7 === 0) acc = acc ^ 5;
+    if (i % 11 === 0) acc = acc + (i >> 2);
+    if (i % 13 === 0) acc = acc - (i & 15);
+    if (i % 17 === 0) acc = acc * 2 % 1000003;
+  }
+  const a = `a-b-${acc}`;
+  const c = `${a}:${a.length + 3}`;
+  const e = c.split(':').map((x) => x.length).reduce((x, y) => x + y, 0);
+  return `${c}/10/${e}`;
+}
+for (let n = 1000; n <= 3000; n += 1000) equal(large(n), largeRef(n), `large function n=${n}`);
+
+function nested(rows, cols) {
+  let total = 0;
+  for (let r = 0; r < rows; r++) {
+    try { total += 1; } finally { cleanups++; }
+    for (let c = 0; c < cols; c++) total += r * c;
+  }
+  return total;
+}
+equal(nested(200, 30), 200 + 19900 * 435, 'inner loop re-entered from an interpreted outer loop');
+
+function findFirst(arr, want) {
+  try { cleanups++; } finally { cleanups++; }
+  let found = -1;
+  for (let i = 0; i < arr.length; i++) {
+    if (arr[i] === want) { found = i; break; }
+  }
+  const after = found * 2;
+  return after;
+}
+const arr = Array.from({ length: 3000 }, (_, i) => i * 3);
+equal(findFirst(arr, 2700 * 3), 5400, 'break out of the loop');
+equal(findFirst(arr, -1), -2, 'loop runs to the end');
+
+function earlyReturn(limit) {
+  try { cleanups++; } finally { cleanups++; }
+  for (let i = 0; ; i++) {
+    if (i * i > limit) return i;
+  }
+}
+equal(earlyReturn(4000000), 2001, 'return from inside the loop');
+
+function throwsInside(n) {
+  try { cleanups++; } finally { cleanups++; }
+  let s = 0;
+  for (let i = 0; i < n; i++) {
+    if (i === n - 1) throw new RangeError(`at ${i} with ${s}`);
+    s += 1;
+  }
+  return s;
+}
+let caught = null;
+try { throwsInside(2000); } catch (e) { caught = e; }
+assert(caught instanceof RangeError, 'exception from the loop reaches the caller');
+equal(caught.message, 'at 1999 with 1999', 'exception message built inside the loop');
+
+function captured(n) {
+  let count = 0;
+  const read = () => count;
+  try { cleanups++; } finally { cleanups++; }
+  for (let i = 0; i < n; i++) count += 2;
+  const direct = count;
+  count += 1;
+  return [direct, read()];
+}
+const pair = captured(2000);
+equal(pair[0], 4000, 'captured local after the loop');
+equal(pair[1], 4001, 'closure sees writes made by and after the loop');
+
+function typeChange(n) {
+  try { cleanups++; } finally { cleanups++; }
+  let s = 0;
+  for (let i = 0; i < n; i++) s = i < n - 5 ? s + 1 : s + 'x';
+  return s;
+}
+equal(typeChange(3000), '2995xxxxx', 'bailout inside the loop resumes in the same frame');
+
+function sequential(n) {
+  try { cleanups++; } finally { cleanups++; }
+  let a = 0, b = 0, c = 0;
+  for (let i = 0; i < n; i++) a += i;
+  for (let i = 0; i < n; i++) b += a - i;
+  for (let i = 0; i < n; i++) c += b % 7;
+  return a + b + c;
+}
+for (let round = 0; round < 5; round++) {
+  const n = 1000 + round;
+  let a = (n * (n - 1)) / 2, b = a * n - a, c = (b % 7) * n;
+  equal(sequential(n), a + b + c, `sequential loops round ${round}`);
+}
+
+// the inner function enters its own unit from inside the caller's unit,
+// the caller's locals must still be written back to its own frame
+function innerHot(k) {
+  try { cleanups++; } finally { cleanups++; }
+  let t = 0;
+  for (let j = 0; j < 1500; j++) t += j ^ k;
+  return t;
+}
+function innerHotRef(k) {
+  let t = 0;
+  for (let j = 0; j < 1500; j++) t += j ^ k;
+  return t;
+}
+function outerHot(n) {
+  try { cleanups++; } finally { cleanups++; }
+  let s = 0, calls = 0;
+  for (let i = 0; i < n; i++) {
+    if (i % 500 === 0) { s += innerHot(i); calls++; }
+    else s += 1;
+  }
+  const after = s * 2 + calls;
+  return after;
+}
+let expectOuter = 0, expectCalls = 0;
+for (let i = 0; i < 3000; i++) {
+  if (i % 500 === 0) { expectOuter += innerHotRef(i); expectCalls++; }
+  else expectOuter += 1;
+}
+equal(outerHot(3000), expectOuter * 2 + expectCalls, 'nested OSR from a callee');
+
+function recurse(depth, n) {
+  try { cleanups++; } finally { cleanups++; }
+  let s = depth;
+  for (let i = 0; i < n; i++) {
+    s += i & 7;
+    if (i === n >> 1 && depth > 0) s += recurse(depth - 1, n);
+  }
+  const after = s + depth * 1000;
+  return after;
+}
+function recurseRef(depth, n) {
+  let s = depth;
+  for (let i = 0; i < n; i++) {
+    s += i & 7;
+    if (i === n >> 1 && depth > 0) s += recurseRef(depth - 1, n);
+  }
+  return s + depth * 1000;
+}
+equal(recurse(4, 2000), recurseRef(4, 2000), 'recursive OSR writes back to each frame');
+
+// the second loop holds a try and never gets a unit; its back edges keep
+// running in the interpreter next to the compiled first loop
+function mixedUnits(n) {
+  try { cleanups++; } finally { cleanups++; }
+  let a = 0;
+  for (let i = 0; i < n; i++) a += i & 15;
+  let b = 0;
+  for (let i = 0; i < n; i++) {
+    try { b += i % 3; } catch { b = -1; }
+  }
+  for (let i = 0; i < n; i++) a += i & 1;
+  return a * 7 + b;
+}
+for (let round = 0; round < 3; round++)
+  equal(mixedUnits(6000), (6000 / 16 * 120 + 3000) * 7 + 2000 * 3, `failed loop next to a unit ${round}`);
+
+let top = 0;
+try { top = 1; } finally { cleanups++; }
+for (let i = 0; i < 5000; i++) top += i & 3;
+equal(top, 1 + 1250 * 6, 'top-level loop');
+
+console.log('PASS');
@@ -0,0 +1,111 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(Object.is(actual, expected), `${message}: expected ${expected}, got ${actual}`);
+}
+
+// null when the build has no JIT stats to report
+function scalarObjects() {
+  if (typeof Ant === 'undefined' || !Ant.stats().jit) return null;
+  return Ant.stats().jit.scalarObjects;
+}
+
+function fired(before, message) {
+  const after = scalarObjects();
+  if (before !== null) assert(after > before, `${message}: scalarObjects stayed at ${before}`);
+  return after;
+}
+
+let seen = scalarObjects();
+
+function dist2(n) {
+  let s = 0;
+  for (let i = 0; i < n; i++) {
+    const p = { x: i, y: i + 1 };
+    s += p.x * p.x + p.y * p.y;
+  }
+  return s;
+}
+for (let round = 0; round < 300; round++) equal(dist2(10), 670, `tuple in a loop round ${round}`);
+seen = fired(seen, 'tuple in a loop is kept in registers');
+
+function swap(n) {
+  let p = { x: 1, y: 2 };
+  for (let i = 0; i < n; i++) p = { x: p.y, y: p.x };
+  return p.x * 10 + p.y;
+}
+for (let round = 0; round < 300; round++) {
+  equal(swap(3), 21, `fields read while the next literal is built (odd) ${round}`);
+  equal(swap(4), 12, `fields read while the next literal is built (even) ${round}`);
+}
+seen = fired(seen, 'swapped literal is kept in registers');
+
+function scaled(a, b) {
+  let s = 0;
+  for (let i = 0; i < 4; i++) {
+    const p = { x: a + i, y: b };
+    s = s + p.x * p.y;
+  }
+  return s;
+}
+for (let round = 0; round < 300; round++) equal(scaled(1, 2), 20, `numeric warm-up ${round}`);
+seen = fired(seen, 'numeric literal is kept in registers');
+equal(scaled(1, '2'), 20, 'bailout after the literal is stored');
+equal(scaled('1', 2), 92, 'bailout while the literal is being built');
+equal(scaled(1, { valueOf() { return 3; } }), 30, 'valueOf on a field value');
+
+function partial(k) {
+  let last = 0;
+  for (let i = 0; i < 3; i++) {
+    const q = { a: i, b: k * i, c: i - k };
+    last = q.a + q.b + q.c;
+  }
+  return last;
+}
+for (let round = 0; round < 300; round++) equal(partial(2), 6, `three fields ${round}`);
+seen = fired(seen, 'three field literal is kept in registers');
+let threw = null;
+try { partial(2n); } catch (e) { threw = e; }
+assert(threw instanceof TypeError, 'mixing bigint inside a field value throws');
+
+function beforeInit(flag) {
+  let p;
+  if (flag) p = { v: 1 };
+  try { return p.v; } catch (e) { return e instanceof TypeError; }
+}
+for (let round = 0; round < 300; round++) equal(beforeInit(true), 1, `initialized ${round}`);
+equal(beforeInit(false), true, 'reading a field of undefined still throws');
+
+seen = scalarObjects();
+function escapes(n) {
+  const out = [];
+  for (let i = 0; i < n; i++) {
+    const p = { i };
+    out.push(p);
+  }
+  return out;
+}
+for (let round = 0; round < 300; round++) {
+  const got = escapes(3);
+  equal(got.length, 3, 'escaping literal kept');
+  equal(got[2].i, 2, 'escaping literal field');
+  equal(Object.keys(got[0]).join(), 'i', 'escaping literal keys');
+}
+if (seen !== null) equal(scalarObjects(), seen, 'escaping literal is still allocated');
+
+function keyed(n) {
+  let s = '';
+  for (let i = 0; i < n; i++) {
+    const p = { first: 'a', second: i };
+    s = s + p.first + p.second;
+  }
+  return s;
+}
+for (let round = 0; round < 300; round++) equal(keyed(3), 'a0a1a2', `string fields ${round}`);
+
+console.log('PASS');
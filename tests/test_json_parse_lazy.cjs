@@ -0,0 +1,90 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+const text = JSON.stringify({
+  id: 7,
+  name: 'widget',
+  tags: ['a', 'b', { deep: true }],
+  owner: { name: 'ada', address: { city: 'london', zip: null } },
+  empty: {},
+  list: [],
+});
+
+const lazy = JSON.parse(text, { lazy: true });
+equal(lazy.id, 7, 'top-level number');
+equal(lazy.name, 'widget', 'top-level string');
+equal(lazy.owner.address.city, 'london', 'nested access');
+equal(lazy.owner.address.zip, null, 'nested null');
+equal(lazy.tags[2].deep, true, 'object inside array');
+equal(Array.isArray(lazy.tags), true, 'arrays stay arrays');
+equal(Object.keys(lazy.empty).length, 0, 'empty object');
+equal(lazy.list.length, 0, 'empty array');
+
+const keys = Object.keys(JSON.parse(text, { lazy: true }));
+equal(keys.join(','), 'id,name,tags,owner,empty,list', 'key order matches document');
+
+const probe = JSON.parse(text, { lazy: true });
+equal('owner' in probe, true, 'in operator');
+equal(probe.hasOwnProperty('missing'), false, 'hasOwnProperty miss');
+equal(Object.prototype.hasOwnProperty.call(probe.owner, 'address'), true, 'hasOwnProperty nested');
+equal(Object.getOwnPropertyDescriptor(JSON.parse(text, { lazy: true }), 'id').value, 7, 'descriptor before access');
+
+const written = JSON.parse(text, { lazy: true });
+written.name = 'gadget';
+written.extra = 1;
+equal(written.name, 'gadget', 'assignment before access wins');
+equal(Object.keys(written).join(','), 'id,name,tags,owner,empty,list,extra', 'assignment keeps document keys');
+
+const deleted = JSON.parse(text, { lazy: true });
+equal(delete deleted.owner, true, 'delete before access');
+equal(deleted.owner, undefined, 'deleted key is gone');
+equal(deleted.id, 7, 'siblings survive delete');
+
+equal(JSON.stringify(JSON.parse(text, { lazy: true })), text, 'stringify round trip');
+equal(JSON.stringify({ ...JSON.parse(text, { lazy: true }).owner }), '{"name":"ada","address":{"city":"london","zip":null}}', 'spread');
+equal(JSON.stringify(Object.assign({}, JSON.parse(text, { lazy: true }).owner.address)), '{"city":"london","zip":null}', 'Object.assign');
+
+const seen = [];
+for (const k in JSON.parse(text, { lazy: true }).owner) seen.push(k);
+equal(seen.join(','), 'name,address', 'for-in');
+equal(Object.entries(JSON.parse(text, { lazy: true }).owner.address).length, 2, 'Object.entries');
+
+const dup = JSON.parse('{"a":1,"b":2,"a":3}', { lazy: true });
+equal(dup.a, 3, 'duplicate keys keep the last value');
+equal(Object.keys(dup).join(','), 'a,b', 'duplicate keys keep first position');
+
+equal(JSON.parse('[1,{"x":2}]', { lazy: true })[1].x, 2, 'array root');
+equal(JSON.parse('"str"', { lazy: true }), 'str', 'primitive root');
+equal(JSON.parse('{"x":1}', (k, v) => (k === 'x' ? v + 1 : v)).x, 2, 'reviver still applies');
+
+const frozen = Object.freeze(JSON.parse(text, { lazy: true }));
+equal(Object.isFrozen(frozen), true, 'freeze before access');
+equal(Object.getOwnPropertyDescriptor(frozen, 'id').writable, false, 'frozen document keys are read-only');
+frozen.id = 8;
+equal(frozen.id, 7, 'frozen document value kept');
+
+const sealed = Object.seal(JSON.parse(text, { lazy: true }));
+equal(Object.getOwnPropertyDescriptor(sealed, 'name').configurable, false, 'sealed document keys are non-configurable');
+equal(delete sealed.name, false, 'sealed document key survives delete');
+
+const fixed = Object.preventExtensions(JSON.parse(text, { lazy: true }));
+equal(fixed.owner.name, 'ada', 'document keys readable after preventExtensions');
+equal(Object.keys(fixed).length, 6, 'preventExtensions keeps document keys');
+
+const many = [];
+for (let i = 0; i < 2000; i++) many.push({ i, child: { value: `v${i}` } });
+const big = JSON.parse(JSON.stringify(many), { lazy: true });
+let sum = 0;
+for (let i = 0; i < big.length; i += 3) sum += big[i].i;
+equal(big[1999].child.value, 'v1999', 'deep access in large document');
+equal(sum, 667 * 999, 'sparse access in large document');
+
+console.log('PASS');
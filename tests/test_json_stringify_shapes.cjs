@@ -0,0 +1,61 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+const rows = [];
+for (let i = 0; i < 500; i++) rows.push({ id: i, name: `n${i}`, ok: i % 2 === 0 });
+const out = JSON.stringify(rows);
+equal(out.slice(0, 41), '[{"id":0,"name":"n0","ok":true},{"id":1,"', 'same-shape prefix');
+equal(JSON.parse(out)[499].name, 'n499', 'same-shape round trip');
+
+equal(JSON.stringify({ 'quo"te': 1, 'new\nline': 2, 'é': 3 }), '{"quo\\"te":1,"new\\nline":2,"é":3}', 'escaped keys');
+equal(JSON.stringify({ b: 1, 2: 'x', a: 2, 1: 'y' }), '{"1":"y","2":"x","b":1,"a":2}', 'index keys first');
+equal(JSON.stringify({ a: 1, b: 2, c: 3 }, ['c', 'a']), '{"c":3,"a":1}', 'replacer array');
+equal(JSON.stringify({ a: 1, b: [2] }, null, 2), '{\n  "a": 1,\n  "b": [\n    2\n  ]\n}', 'indent');
+equal(JSON.stringify({ a: undefined, b: () => 1, c: 1 }), '{"c":1}', 'skipped values');
+
+const hidden = { a: 1, b: 2 };
+JSON.stringify(hidden);
+Object.defineProperty(hidden, 'b', { enumerable: false });
+equal(JSON.stringify(hidden), '{"a":1}', 'enumerability change after caching');
+
+const shrinking = { first: 1, get second() { delete this.third; return 2; }, third: 3 };
+equal(JSON.stringify(shrinking), '{"first":1,"second":2}', 'getter deletes later key');
+
+const growing = { a: 1, get b() { this.c = 9; return 2; } };
+equal(JSON.stringify(growing), '{"a":1,"b":2}', 'getter adds key mid-write');
+equal(JSON.stringify(growing), '{"a":1,"b":2,"c":9}', 'added key appears next time');
+
+class Point { constructor(x, y) { this.x = x; this.y = y; } }
+const pts = [new Point(1, 2), new Point(3, 4)];
+equal(JSON.stringify(pts), '[{"x":1,"y":2},{"x":3,"y":4}]', 'class instances');
+Point.prototype.toJSON = function () { return [this.x, this.y]; };
+equal(JSON.stringify(pts), '[[1,2],[3,4]]', 'toJSON added to prototype later');
+delete Point.prototype.toJSON;
+equal(JSON.stringify(pts), '[{"x":1,"y":2},{"x":3,"y":4}]', 'toJSON removed again');
+
+const own = { v: 1 };
+JSON.stringify(own);
+const withOwn = { v: 1 };
+withOwn.toJSON = () => 'own';
+equal(JSON.stringify([own, withOwn]), '[{"v":1},"own"]', 'own toJSON on a sibling shape');
+
+const deleted = { a: 1, b: 2, c: 3 };
+JSON.stringify(deleted);
+delete deleted.b;
+equal(JSON.stringify(deleted), '{"a":1,"c":3}', 'delete after caching');
+
+const shapes = [];
+for (let i = 0; i < 600; i++) shapes.push({ [`k${i}`]: i, tail: { [`t${i % 7}`]: i } });
+const wide = JSON.parse(JSON.stringify(shapes));
+equal(wide[599].k599, 599, 'many shapes');
+equal(wide[598].tail.t3, 598, 'nested shapes under eviction');
+
+console.log('PASS');
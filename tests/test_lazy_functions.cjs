@@ -0,0 +1,243 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+function outer(seed) {
+  const base = seed * 10;
+  let counter = 0;
+
+  function bump(step) {
+    // bodies over a few hundred bytes are deferred until their closure is
+    // created, so these helpers are padded out past that threshold........
+    // ......................................................................
+    counter += step;
+    return base + counter;
+  }
+
+  function unused() {
+    // never instantiated twice, never called: only its stub should exist...
+    // ......................................................................
+    // ......................................................................
+    return base + counter + seed;
+  }
+
+  return { bump, unused };
+}
+
+const o = outer(4);
+equal(o.bump(1), 41, 'captures parameter-derived const and mutable local');
+equal(o.bump(2), 43, 'mutation through the captured upvalue persists');
+equal(o.unused(), 47, 'second lazy sibling sees the same bindings');
+equal(o.bump.length, 1, 'length comes from the stub');
+equal(o.bump.name, 'bump', 'name comes from the stub');
+assert(o.bump.toString().startsWith('function bump(step)'), 'toString uses the original source span');
+
+function levels(a) {
+  const b = a + 1;
+  return function middle(c) {
+    const d = c * 2;
+    return function inner(e) {
+      // reaches across two enclosing functions and a named function expression
+      // ......................................................................
+      // ......................................................................
+      return typeof middle === 'function' ? a + b + c + d + e : -1;
+    };
+  };
+}
+
+equal(levels(1)(2)(3), 1 + 2 + 2 + 4 + 3, 'captures resolved through several levels');
+
+function constWrite() {
+  const fixed = 1;
+  return function write() {
+    // assigning to a captured const must still throw once compiled lazily..
+    // ......................................................................
+    // ......................................................................
+    fixed = 2;
+  };
+}
+
+let threw = false;
+try { constWrite()(); } catch (e) { threw = e instanceof TypeError; }
+assert(threw, 'const capture stays const');
+
+function loops() {
+  const fns = [];
+  for (let i = 0; i < 3; i++) {
+    fns.push(function get() {
+      // per-iteration bindings must be captured per closure, not per stub...
+      // ......................................................................
+      // ......................................................................
+      return i;
+    });
+  }
+  return fns.map((f) => f()).join(',');
+}
+
+equal(loops(), '0,1,2', 'per-iteration let captures');
+
+function recursion() {
+  return function fact(n) {
+    // the function's own name is a binding in the scope that created it.....
+    // ......................................................................
+    // ......................................................................
+    return n <= 1 ? 1 : n * fact(n - 1);
+  };
+}
+
+equal(recursion()(6), 720, 'named function expression recursion');
+
+function kinds() {
+  const scale = 3;
+
+  function* gen(n) {
+    // generators keep their flags on the stub and compile on first closure..
+    // ......................................................................
+    // ......................................................................
+    for (let i = 0; i < n; i++) yield i * scale;
+  }
+
+  async function later(x) {
+    // async functions defer the same way; awaiting must still work.........
+    // ......................................................................
+    // ......................................................................
+    return (await x) * scale;
+  }
+
+  function args() {
+    // arguments and default parameters behave as in an eager compile.......
+    // ......................................................................
+    // ......................................................................
+    return arguments.length + scale;
+  }
+
+  function defaults(a = scale, b = a * 2) {
+    // default parameter initializers close over the enclosing scope too.....
+    // ......................................................................
+    // ......................................................................
+    return a + b;
+  }
+
+  return { gen, later, args, defaults };
+}
+
+const k = kinds();
+equal([...k.gen(3)].join(','), '0,3,6', 'generator');
+equal(k.args(1, 2, 3), 6, 'arguments object');
+equal(k.defaults(), 9, 'default parameters');
+equal(k.defaults(1), 3, 'default parameter referencing earlier parameter');
+
+function sloppy() {
+  return function () {
+    // strictness is inherited from the enclosing function at parse time....
+    // ......................................................................
+    // ......................................................................
+    return this === undefined;
+  };
+}
+
+function strict() {
+  'use strict';
+  return function () {
+    // ...and a nested function of a strict function is strict as well......
+    // ......................................................................
+    // ......................................................................
+    return this === undefined;
+  };
+}
+
+equal(sloppy()(), false, 'sloppy nested function');
+equal(strict()(), true, 'strict nested function');
+
+function shadowed() {
+  let payload = { bytes: new Array(10000).fill(7) };
+  const ref = new WeakRef(payload);
+
+  function reader(n) {
+    // the stub sees `payload` mentioned, but this body declares its own......
+    // so the compiled function must not keep the outer object alive.......
+    // ......................................................................
+    const payload = n * 2;
+    return payload;
+  }
+
+  const base = 100;
+  function scopes(list) {
+    // every `payload` below is bound inside this body, so none of them may
+    // capture the outer one; `base` is read after all of those scopes close
+    let total = 0;
+    for (const payload of list) { total += payload; }
+    { let payload = 1; total += payload; }
+    try { throw 2; } catch (payload) { total += payload; }
+    const box = { payload: 3 };
+    total += box.payload;
+    total += ((payload) => payload * 2)(4);
+    return total + base;
+  }
+
+  return { reader, scopes, ref };
+}
+
+const sh = shadowed();
+equal(sh.reader(4), 8, 'shadowed name reads the inner binding');
+equal(sh.scopes([5, 6]), 5 + 6 + 1 + 2 + 3 + 8 + 100, 'block, loop, catch and arrow bindings shadow the outer name');
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ant-lazy-'));
+const pad = '// ' + '.'.repeat(300) + '\n';
+
+function loadError(body) {
+  const file = path.join(dir, `case${Math.random().toString(36).slice(2)}.cjs`);
+  fs.writeFileSync(file, `function outer() {\n  function inner() {\n${pad}${body}\n  }\n  return inner;\n}\nmodule.exports = 1;\n`);
+  try {
+    require(file);
+    return null;
+  } catch (e) {
+    return e;
+  }
+}
+
+const dupParams = loadError("function dup(a, a) { 'use strict'; }");
+assert(dupParams instanceof SyntaxError, 'early errors in a deferred body are reported at load');
+const yieldErr = loadError('function plain() { yield 1; }');
+assert(yieldErr instanceof SyntaxError, 'yield outside a generator in a deferred body is an early error');
+equal(loadError('return 1;'), null, 'valid deferred body loads');
+
+const deferredFile = path.join(dir, 'deferred.cjs');
+fs.writeFileSync(deferredFile, `module.exports = function outer() {\n  return function inner() {\n${pad}const x = ;\n  };\n};\n`);
+let deferredErr = null;
+try { require(deferredFile)(); } catch (e) { deferredErr = e; }
+assert(deferredErr instanceof SyntaxError, 'a syntax error inside a skimmed body is still reported');
+
+fs.rmSync(dir, { recursive: true, force: true });
+
+k.later(Promise.resolve(5)).then((v) => {
+  equal(v, 15, 'async function');
+
+  if (typeof Ant !== 'undefined' && Ant.stats().lazy) {
+    const lazy = Ant.stats().lazy;
+    assert(lazy.deferred > 0, 'functions were deferred');
+    assert(lazy.compiled <= lazy.deferred, 'never compile more than deferred');
+    assert(lazy.compiledBytes <= lazy.deferredBytes, 'compiled bytes within deferred bytes');
+  }
+
+  setTimeout(() => {
+    for (let i = 0; i < 200000; i++) ({ i, value: `lazy-gc-${i}` });
+    if (typeof gc === 'function') {
+      gc();
+      equal(sh.ref.deref(), undefined, 'a binding only shadowed in a deferred body is not captured');
+    }
+    equal(sh.reader(5), 10, 'closure still works after the outer binding is collected');
+    console.log('PASS');
+  }, 10);
+});
@@ -0,0 +1,83 @@
+const assert = require('node:assert');
+const { spawn, spawnSync } = require('node:child_process');
+const fs = require('node:fs');
+const net = require('node:net');
+const os = require('node:os');
+const path = require('node:path');
+
+// a name resolving to a blackholed address ahead of 127.0.0.1 needs its own
+// /etc/hosts and /etc/gai.conf, which an unprivileged mount namespace gives
+if (process.platform !== 'linux') {
+  console.log('net connect race test skipped outside Linux');
+  process.exit(0);
+}
+
+if (spawnSync('unshare', ['-rm', 'true']).status !== 0) {
+  console.log('net connect race test skipped without user namespaces');
+  process.exit(0);
+}
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'ant-connect-race-'));
+const hostsPath = path.join(dir, 'hosts');
+const gaiPath = path.join(dir, 'gai.conf');
+const clientPath = path.join(dir, 'client.cjs');
+
+// 192.0.2.0/24 is TEST-NET-1: nothing answers there, the attempt either
+// hangs or fails and the race has to move on to the loopback address
+fs.writeFileSync(hostsPath, '192.0.2.1 ant-race.test\n127.0.0.1 ant-race.test\n');
+fs.writeFileSync(gaiPath, 'precedence ::ffff:192.0.2.0/120 100\nprecedence ::ffff:127.0.0.0/104 5\n');
+
+const server = net.createServer(socket => socket.end('hello'));
+
+server.listen(0, '127.0.0.1', () => {
+  const { port } = server.address();
+  fs.writeFileSync(clientPath, `
+const net = require('node:net');
+const started = Date.now();
+const socket = net.connect({ host: 'ant-race.test', port: ${port} });
+let data = '';
+socket.setEncoding('utf8');
+socket.on('connect', () => { socket.remote = socket.remoteAddress; });
+socket.on('data', chunk => { data += chunk; });
+socket.on('end', () => {
+  console.log(JSON.stringify({ remote: socket.remote, data, ms: Date.now() - started }));
+});
+socket.on('error', error => {
+  console.log(JSON.stringify({ error: error.message }));
+  process.exit(1);
+});
+`);
+
+  const script = 'mount --bind "$1" /etc/hosts && mount --bind "$2" /etc/gai.conf || exit 77; exec "$3" "$4"';
+  const child = spawn('unshare', ['-rm', 'sh', '-c', script, 'sh', hostsPath, gaiPath, process.execPath, clientPath], {
+    stdio: ['ignore', 'pipe', 'pipe'],
+  });
+
+  let stdout = '';
+  let stderr = '';
+  child.stdout.on('data', chunk => { stdout += String(chunk); });
+  child.stderr.on('data', chunk => { stderr += String(chunk); });
+
+  const timeout = setTimeout(() => {
+    child.kill('SIGKILL');
+    throw new Error('connect race timed out');
+  }, 10000);
+
+  child.on('exit', code => {
+    clearTimeout(timeout);
+    server.close();
+    fs.rmSync(dir, { recursive: true, force: true });
+
+    if (code === 77) {
+      console.log('net connect race test skipped, hosts could not be replaced');
+      return;
+    }
+
+    assert.strictEqual(code, 0, `client failed: ${stdout}${stderr}`);
+    const result = JSON.parse(stdout.trim());
+    assert.strictEqual(result.remote, '127.0.0.1');
+    assert.strictEqual(result.data, 'hello');
+    assert.ok(result.ms < 5000, `fallback took ${result.ms}ms`);
+    console.log('net:connect-race:ok');
+  });
+});
@@ -0,0 +1,78 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+function Wide(i) {
+  this.a = i;
+  this.b = i + 1;
+  this.c = i + 2;
+  this.d = i + 3;
+  this.e = i + 4;
+  this.f = i + 5;
+  this.g = i + 6;
+}
+
+const wides = [];
+for (let i = 0; i < 200; i++) wides.push(new Wide(i));
+equal(wides[199].g, 205, 'last property of a wide constructor instance');
+equal(Object.keys(wides[0]).join(','), 'a,b,c,d,e,f,g', 'key order for wide instances');
+
+const grown = new Wide(0);
+grown.h = 1;
+grown.i = 2;
+delete grown.b;
+equal(Object.keys(grown).join(','), 'a,c,d,e,f,g,h,i', 'growth and delete past the inline slots');
+equal(grown.i, 2, 'property added after the inline slots');
+
+function Huge() {
+  for (let i = 0; i < 24; i++) this['p' + i] = i;
+}
+
+let sum = 0;
+for (let i = 0; i < 100; i++) {
+  const h = new Huge();
+  sum += h.p0 + h.p15 + h.p23;
+}
+equal(sum, 100 * (0 + 15 + 23), 'instances larger than the biggest class spill to overflow');
+
+function literal(i) {
+  return { k0: i, k1: i, k2: i, k3: i, k4: i, k5: i, k6: i, k7: i, k8: i, k9: i };
+}
+
+let lit = 0;
+for (let i = 0; i < 500; i++) lit += literal(i).k9;
+equal(lit, (499 * 500) / 2, 'wide object literal sites');
+equal(JSON.stringify(literal(1)), '{"k0":1,"k1":1,"k2":1,"k3":1,"k4":1,"k5":1,"k6":1,"k7":1,"k8":1,"k9":1}', 'literal round trip');
+
+const small = { x: 1 };
+small.y = 2;
+equal(small.x + small.y, 3, 'default-sized literal');
+
+class Point {
+  constructor(x, y, z, w, v) {
+    this.x = x; this.y = y; this.z = z; this.w = w; this.v = v;
+  }
+}
+const pts = [];
+for (let i = 0; i < 100; i++) pts.push(new Point(i, i, i, i, i));
+equal(pts.reduce((acc, p) => acc + p.v, 0), (99 * 100) / 2, 'class instances after slack tracking');
+
+const re = /a(b)/;
+for (let i = 0; i < 10; i++) equal(re.exec('xab').index, 1, 'regexp objects keep their finalizer');
+
+if (typeof Ant !== 'undefined' && Ant.stats().alloc.objectClasses) {
+  const classes = Ant.stats().alloc.objectClasses;
+  equal(classes.length, 3, 'three object size classes');
+  equal(classes[0].slots, 4, 'base class slots');
+  assert(classes[1].slots > classes[0].slots && classes[2].slots > classes[1].slots, 'classes grow');
+  assert(classes[1].live > 0 || classes[2].live > 0, 'feedback moved objects into larger classes');
+}
+
+console.log('PASS');
@@ -0,0 +1,79 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { spawnSync } = require('child_process');
+
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+const ant = path.resolve(process.execPath);
+const root = fs.mkdtempSync(path.join(os.tmpdir(), 'ant-resolve-index-'));
+const cache = path.join(root, 'cache');
+const app = path.join(root, 'app');
+
+const write = (name, body) => {
+  const file = path.join(app, name);
+  fs.mkdirSync(path.dirname(file), { recursive: true });
+  fs.writeFileSync(file, body);
+};
+
+write('main.mjs', 'import { v } from "./lib/entry.mjs";\nimport { w } from "./lib/w.mjs";\nconsole.log(v + "," + w);\n');
+write('lib/entry.mjs', 'export { v } from "pkg";\n');
+write('lib/w.mjs', 'export const w = "w";\n');
+write('node_modules/pkg/package.json', JSON.stringify({ name: 'pkg', exports: './a.mjs' }));
+write('node_modules/pkg/a.mjs', 'export const v = "a";\n');
+write('node_modules/pkg/b.mjs', 'export const v = "b";\n');
+
+function run(label, flags = ['--resolve-cache']) {
+  const result = spawnSync(ant, [...flags, 'main.mjs'], {
+    cwd: app,
+    encoding: 'utf8',
+    env: { ...process.env, XDG_CACHE_HOME: cache },
+  });
+  equal(result.status, 0, `${label} exit status (${result.stderr})`);
+  return result.stdout.trim();
+}
+
+function indexFiles() {
+  const dir = path.join(cache, 'ant', 'resolve');
+  if (!fs.existsSync(dir)) return [];
+  return fs.readdirSync(dir, { recursive: true }).filter(name => String(name).endsWith('.idx'));
+}
+
+equal(run('without the flag', []), 'a,w', 'plain run');
+equal(indexFiles().length, 0, 'no index is written unless asked for');
+
+equal(run('cold'), 'a,w', 'cold run');
+equal(indexFiles().length, 1, 'index written after the first run');
+equal(run('warm'), 'a,w', 'warm run answers from the index');
+
+write('node_modules/pkg/package.json', JSON.stringify({ name: 'pkg', exports: './b.mjs' }, null, 2));
+equal(run('package.json edited'), 'b,w', 'changed exports invalidate the index');
+
+const pkgJson = path.join(app, 'node_modules/pkg/package.json');
+const later = new Date(Date.now() + 5000);
+fs.utimesSync(pkgJson, later, later);
+equal(run('package.json touched'), 'b,w', 'a touched but unchanged package.json keeps the index');
+
+write('lib/node_modules/pkg/package.json', JSON.stringify({ name: 'pkg', exports: './c.mjs' }));
+write('lib/node_modules/pkg/c.mjs', 'export const v = "c";\n');
+equal(run('closer package added'), 'c,w', 'a new node_modules directory shadows the cached answer');
+
+fs.rmSync(path.join(app, 'lib/node_modules'), { recursive: true, force: true });
+equal(run('closer package removed'), 'b,w', 'removing it falls back again');
+
+fs.renameSync(path.join(app, 'lib/w.mjs'), path.join(app, 'lib/w2.mjs'));
+write('lib/w2.mjs', 'export const w = "w2";\n');
+write('main.mjs', 'import { v } from "./lib/entry.mjs";\nimport { w } from "./lib/w2.mjs";\nconsole.log(v + "," + w);\n');
+equal(run('renamed file'), 'b,w2', 'renamed files resolve');
+
+fs.rmSync(root, { recursive: true, force: true });
+console.log('PASS');
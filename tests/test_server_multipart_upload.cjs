@@ -0,0 +1,154 @@
+const assert = require('node:assert');
+const { spawn } = require('node:child_process');
+const fs = require('node:fs');
+const http = require('node:http');
+const net = require('node:net');
+const os = require('node:os');
+const path = require('node:path');
+
+const BOUNDARY = 'ant-upload-boundary';
+
+async function reservePort() {
+  return await new Promise((resolve, reject) => {
+    const server = net.createServer();
+    server.on('error', reject);
+    server.listen(0, '127.0.0.1', () => {
+      const { port } = server.address();
+      server.close(() => resolve(port));
+    });
+  });
+}
+
+async function waitForServer(port, child) {
+  const startedAt = Date.now();
+  while (Date.now() - startedAt < 2000) {
+    assert.equal(child.exitCode, null, 'server exited before accepting connections');
+    try {
+      await new Promise((resolve, reject) => {
+        const socket = net.createConnection({ host: '127.0.0.1', port }, () => {
+          socket.end();
+          resolve();
+        });
+        socket.once('error', reject);
+      });
+      return;
+    } catch {
+      await new Promise(resolve => setTimeout(resolve, 10));
+    }
+  }
+  throw new Error('server did not start');
+}
+
+function multipartBody(fileBytes) {
+  return Buffer.concat([
+    Buffer.from(
+      `--${BOUNDARY}\r\nContent-Disposition: form-data; name="name"\r\n\r\nupload\r\n` +
+      `--${BOUNDARY}\r\nContent-Disposition: form-data; name="file"; filename="data.bin"\r\n` +
+      'Content-Type: application/octet-stream\r\n\r\n'
+    ),
+    fileBytes,
+    Buffer.from(`\r\n--${BOUNDARY}--\r\n`),
+  ]);
+}
+
+// the body goes out in small pieces with pauses in between, so the server
+// sees it arrive over many reads
+async function upload(port, target, body, chunked) {
+  return await new Promise((resolve, reject) => {
+    const headers = { 'content-type': `multipart/form-data; boundary=${BOUNDARY}` };
+    if (!chunked) headers['content-length'] = body.length;
+
+    const req = http.request({ host: '127.0.0.1', port, path: target, method: 'POST', headers }, res => {
+      let data = '';
+      res.setEncoding('utf8');
+      res.on('data', chunk => { data += chunk; });
+      res.on('end', () => resolve({ status: res.statusCode, body: data }));
+    });
+    req.on('error', reject);
+
+    let offset = 0;
+    const step = () => {
+      if (offset >= body.length) return req.end();
+      req.write(body.subarray(offset, offset + 16384));
+      offset += 16384;
+      setTimeout(step, 1);
+    };
+    step();
+  });
+}
+
+async function main() {
+  const port = await reservePort();
+  const tmpDir = fs.mkdtempSync(path.join(os.tmpdir(), 'ant-server-multipart-'));
+  const serverPath = path.join(tmpDir, 'server.mjs');
+
+  fs.writeFileSync(serverPath, `
+export default {
+  hostname: '127.0.0.1',
+  port: ${port},
+  multipartSpillThreshold: 64 * 1024,
+  async fetch(request) {
+    const { pathname } = new URL(request.url);
+    const streamed = request.body === null;
+    if (pathname === '/text') {
+      try {
+        return new Response('text ' + (await request.text()).length);
+      } catch (error) {
+        return new Response('rejected ' + error.message);
+      }
+    }
+    const form = await request.formData();
+    const file = form.get('file');
+    const bytes = new Uint8Array(await file.arrayBuffer());
+    let sum = 0;
+    for (const b of bytes) sum = (sum + b) % 65521;
+    return Response.json({ name: form.get('name'), size: file.size, sum, streamed });
+  },
+};
+`);
+
+  const child = spawn(process.execPath, [serverPath], {
+    stdio: ['ignore', 'pipe', 'pipe'],
+  });
+
+  let stderr = '';
+  child.stderr.on('data', chunk => { stderr += String(chunk); });
+
+  try {
+    await waitForServer(port, child);
+
+    const big = Buffer.alloc(512 * 1024);
+    for (let i = 0; i < big.length; i++) big[i] = (i * 31) & 0xff;
+    let sum = 0;
+    for (const b of big) sum = (sum + b) % 65521;
+
+    for (const chunked of [false, true]) {
+      const res = await upload(port, '/', multipartBody(big), chunked);
+      assert.equal(res.status, 200, res.body);
+      const result = JSON.parse(res.body);
+      assert.equal(result.name, 'upload');
+      assert.equal(result.size, big.length);
+      assert.equal(result.sum, sum, 'file part bytes arrive intact');
+      assert.equal(result.streamed, true, 'a large upload is parsed while it arrives');
+    }
+
+    const small = await upload(port, '/', multipartBody(Buffer.from('tiny')), false);
+    const smallResult = JSON.parse(small.body);
+    assert.equal(smallResult.size, 4);
+    assert.equal(smallResult.streamed, false, 'a small upload is buffered');
+
+    const text = await upload(port, '/text', multipartBody(big), false);
+    assert.match(text.body, /^rejected .*formData\(\)/);
+
+    assert.equal(child.exitCode, null, `server crashed: ${stderr}`);
+    console.log('server:multipart-upload:ok');
+  } finally {
+    child.kill('SIGTERM');
+    fs.rmSync(tmpDir, { recursive: true, force: true });
+  }
+}
+
+main().catch(error => {
+  console.error(error && error.stack ? error.stack : error);
+  process.exit(1);
+});
@@ -0,0 +1,81 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+function naiveIndexOf(hay, needle, from) {
+  for (let i = from; i + needle.length <= hay.length; i++) {
+    let ok = true;
+    for (let j = 0; j < needle.length; j++) {
+      if (hay.charCodeAt(i + j) !== needle.charCodeAt(j)) { ok = false; break; }
+    }
+    if (ok) return i;
+  }
+  return -1;
+}
+
+const filler = 'abcabcabdabcabce'.repeat(12);
+for (let pos = 0; pos < 150; pos += 7) {
+  const hay = filler.slice(0, pos) + 'NEEDLE' + filler.slice(pos);
+  equal(hay.indexOf('NEEDLE'), pos, `indexOf at ${pos}`);
+  equal(hay.includes('NEEDLE'), true, `includes at ${pos}`);
+  equal(hay.indexOf('NEEDLE', pos + 1), -1, `indexOf past ${pos}`);
+}
+for (const needle of ['ab', 'abd', 'bce', 'cabcabd', 'zz', 'e']) {
+  for (const from of [0, 3, 17, 100]) {
+    equal(filler.indexOf(needle, from), naiveIndexOf(filler, needle, from), `indexOf ${needle} from ${from}`);
+  }
+}
+
+const mixed = 'ä'.repeat(40) + 'x'.repeat(100) + '😀' + 'y'.repeat(50) + 'hit';
+equal(mixed.length, 40 + 100 + 2 + 50 + 3, 'mixed utf16 length');
+equal(mixed.indexOf('hit'), 192, 'indexOf after non-ascii');
+equal(mixed.charCodeAt(140), 0xd83d, 'high surrogate after ascii run');
+equal(mixed.charCodeAt(141), 0xde00, 'low surrogate after ascii run');
+equal(mixed.slice(130, 145), 'x'.repeat(10) + '😀' + 'yyy', 'slice across ascii run');
+equal(mixed.codePointAt(140), 0x1f600, 'codePointAt after ascii run');
+
+const parts = ('field'.repeat(8) + '::').repeat(20).split('::');
+equal(parts.length, 21, 'split count with multi-byte separator');
+equal(parts[19], 'field'.repeat(8), 'split segment');
+equal(parts[20], '', 'split trailing segment');
+
+const quoted = 'plain text '.repeat(5) + '"q"\\\n\t\u0001' + 'é'.repeat(20) + 'tail'.repeat(10);
+equal(JSON.parse(JSON.stringify(quoted)), quoted, 'JSON round trip with escapes');
+equal(JSON.stringify('x'.repeat(40) + '\u0000'), `"${'x'.repeat(40)}\\u0000"`, 'control escape after safe run');
+equal(JSON.stringify('a'.repeat(33) + '\ud800'), `"${'a'.repeat(33)}\\ud800"`, 'lone surrogate after safe run');
+equal(JSON.stringify({ key: 'v'.repeat(64) }), `{"key":"${'v'.repeat(64)}"}`, 'safe string fast path');
+
+const bytes = Buffer.alloc(300);
+for (let i = 0; i < bytes.length; i++) bytes[i] = (i * 37) & 0xff;
+const hex = bytes.toString('hex');
+equal(hex.length, 600, 'hex length');
+equal(hex.slice(0, 8), '00254a6f', 'hex prefix');
+equal(Buffer.from(hex, 'hex').equals(bytes), true, 'hex round trip');
+equal(Buffer.from(hex.toUpperCase(), 'hex').equals(bytes), true, 'uppercase hex round trip');
+equal(Buffer.from('abcdzz12', 'hex').length, 2, 'hex decode stops at invalid digit');
+equal(new Uint8Array([1, 171, 255]).toHex(), '01abff', 'Uint8Array toHex');
+
+const big = Buffer.from('-'.repeat(500) + 'marker' + '-'.repeat(20));
+equal(big.indexOf('marker'), 500, 'Buffer indexOf string');
+equal(big.indexOf(Buffer.from('ker-')), 503, 'Buffer indexOf buffer');
+equal(big.indexOf(0x6d), 500, 'Buffer indexOf byte');
+equal(big.indexOf('missing'), -1, 'Buffer indexOf miss');
+
+const text = 'ascii prefix '.repeat(10) + 'naïve café ' + 'done';
+const decoded = new TextDecoder().decode(new TextEncoder().encode(text));
+equal(decoded, text, 'TextDecoder mixed round trip');
+equal(Buffer.from(text).toString('utf8'), text, 'Buffer utf8 round trip');
+equal(
+  new TextDecoder().decode(Buffer.from([0x61, 0x62, 0xff, 0x63])),
+  'ab�c',
+  'TextDecoder replacement after ascii'
+);
+
+console.log('PASS');
@@ -0,0 +1,74 @@
+const { spawnSync } = require('child_process');
+
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(actual === expected, `${message}: expected ${expected}, got ${actual}`);
+}
+
+const base = 'abcdefghijklmnopqrstuvwxyz0123456789'.repeat(64);
+const mid = base.slice(100, 1100);
+
+equal(mid.length, 1000, 'slice keeps its length');
+equal(mid[0], base[100], 'slice indexes from its offset');
+equal(mid.charCodeAt(999), base.charCodeAt(1099), 'slice reads its last unit');
+equal(mid, base.substring(100, 1100), 'slice equals substring');
+equal(mid, base.substr(100, 1000), 'slice equals substr');
+
+const nested = mid.slice(10, 500).slice(5, 400);
+equal(nested, base.slice(115, 510), 'slice of slice resolves to the root');
+equal(nested.length, 395, 'slice of slice length');
+
+const joined = mid + nested;
+equal(joined.length, 1395, 'concat with slices');
+equal(joined.slice(1000), nested, 'concat keeps slice bytes');
+equal(`${nested}!`.endsWith('!'), true, 'template with slice');
+
+let count = 0;
+for (const ch of nested) {
+  if (ch === nested[count]) count++;
+}
+equal(count, nested.length, 'iteration over slice');
+
+const digits = ('1234567890'.repeat(4) + ' tail').slice(0, 35);
+equal(Number(digits), 12345678901234567890123456789012345, 'number parsing from slice');
+
+const csv = ['alpha'.repeat(10), 'beta'.repeat(10), 'gamma'.repeat(10)].join(',');
+const parts = csv.split(',');
+equal(parts.length, 3, 'split count');
+equal(parts[1], 'beta'.repeat(10), 'split segment equals copy');
+equal(parts[2].toUpperCase(), 'GAMMA'.repeat(10), 'methods on split segment');
+
+const keyed = {};
+keyed[mid] = 7;
+equal(keyed[base.slice(100, 1100)], 7, 'slice as property key');
+
+const unicode = ('ä€😀x'.repeat(40)).slice(4, 120);
+equal(unicode.length, 116, 'non-ascii slice length');
+equal(unicode.codePointAt(0), 'x'.codePointAt(0), 'non-ascii slice offset');
+equal(unicode, ('ä€😀x'.repeat(40)).substring(4, 120), 'non-ascii slice equals substring');
+
+const retained = [];
+for (let i = 0; i < 200; i++) {
+  const big = String(i).padStart(4, '0').repeat(4096);
+  retained.push(big.slice(8, 48));
+}
+for (let i = 0; i < 200; i++) {
+  equal(retained[i], String(i).padStart(4, '0').repeat(10), `retained slice ${i} survives GC`);
+}
+
+const probe = spawnSync(
+  process.execPath,
+  ['-e', 'console.inspect("0123456789".repeat(20).slice(5, 150))'],
+  { encoding: 'utf8' }
+);
+equal(probe.status, 0, 'inspect probe exits cleanly');
+assert(probe.stdout.includes('<String slice '), `expected slice internals, got ${JSON.stringify(probe.stdout)}`);
+assert(probe.stdout.includes('offset=5'), `expected slice offset, got ${JSON.stringify(probe.stdout)}`);
+
+console.log('PASS');
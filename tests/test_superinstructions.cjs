@@ -0,0 +1,140 @@
+const path = require('path');
+const { spawnSync } = require('child_process');
+
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(Object.is(actual, expected), `${message}: expected ${expected}, got ${actual}`);
+}
+
+function countUp(n) {
+  let s = 0;
+  for (let i = 0; i < n; i++) s += i;
+  return s;
+}
+equal(countUp(100), 4950, 'local < local loop');
+
+function countConst() {
+  let s = 0;
+  for (let i = 0; i < 100; i++) s += i;
+  return s;
+}
+equal(countConst(), 4950, 'local < small constant loop');
+
+function compareMixed(a, b) {
+  let hits = 0;
+  let i = a;
+  while (i < b) { hits++; i++; }
+  return hits;
+}
+equal(compareMixed('3', 6), 3, 'string < number');
+equal(compareMixed(0, { valueOf() { return 4; } }), 4, 'valueOf on the right');
+equal(compareMixed(undefined, 5), 0, 'undefined < number is false');
+equal(compareMixed(NaN, 5), 0, 'NaN < number is false');
+equal(compareMixed(1n, 4), 3, 'bigint < number');
+
+function lessThanString(s) {
+  let n = 0;
+  for (let i = 0; i < 3; i++) if (s < 'm') n++;
+  return n;
+}
+equal(lessThanString('a'), 3, 'string compare');
+equal(lessThanString('z'), 0, 'string compare false');
+
+function sumField(items) {
+  let s = 0;
+  for (let i = 0; i < items.length; i++) {
+    const item = items[i];
+    s += item.value;
+  }
+  return s;
+}
+const items = Array.from({ length: 50 }, (_, i) => ({ value: i }));
+equal(sumField(items), 1225, 'local.field and local.length');
+
+let getterCalls = 0;
+const withGetter = { get value() { getterCalls++; return 2; } };
+equal(sumField([withGetter, { value: 1 }, withGetter]), 5, 'getter through fused field read');
+equal(getterCalls, 2, 'getter called once per read');
+
+function argField(o) { return o.x; }
+for (let i = 0; i < 300; i++) equal(argField({ x: i }), i, 'arg.field');
+
+let threw = null;
+try { argField(undefined); } catch (e) { threw = e; }
+assert(threw instanceof TypeError, 'field of undefined argument still throws');
+
+class Point {
+  constructor(x, y) { this.x = x; this.y = y; }
+  norm2() { return this.x * this.x + this.y * this.y; }
+}
+equal(new Point(3, 4).norm2(), 25, 'this.field');
+
+function tdz() {
+  try { return early.value; } catch (e) { return e instanceof ReferenceError; }
+  // eslint-disable-next-line no-unreachable
+  let early = { value: 1 };
+}
+equal(tdz(), true, 'TDZ still checked');
+
+function pairs(a, b) { const x = a; const y = b; return x - y; }
+equal(pairs(10, 4), 6, 'local, local');
+
+function breakInside() {
+  let i = 0;
+  for (;;) {
+    if (!(i < 10)) break;
+    i++;
+  }
+  return i;
+}
+equal(breakInside(), 10, 'comparison feeding a negated branch');
+
+function nested() {
+  let total = 0;
+  for (let i = 0; i < 20; i++)
+    for (let j = 0; j < i; j++) total++;
+  return total;
+}
+for (let round = 0; round < 200; round++) equal(nested(), 190, `nested loops round ${round}`);
+
+const script = 'function run() { let s = 0; for (let i = 0; i < 1000; i++) s += i; return s; } console.log(run());';
+const prof = spawnSync(path.resolve(process.execPath), ['--profile-opcodes', '-e', script], { encoding: 'utf8' });
+equal(prof.status, 0, `--profile-opcodes run (${prof.stderr})`);
+equal(prof.stdout.trim(), '499500', 'profiled run output');
+assert(/opcode profile: \d+ instructions/.test(prof.stderr), 'profile header printed');
+assert(/pairs:/.test(prof.stderr) && /triples:/.test(prof.stderr), 'pair and triple tables printed');
+assert(/ LT JMP_FALSE8?\s+<- \w*LT_JMP_FALSE8?\b/.test(prof.stderr), `hot loop condition is covered by a fused op:\n${prof.stderr}`);
+
+// the compiled bytecode, not just the results above, has to carry the fused
+// heads: dump it and look for one from each family
+const shapes = [
+  'function loop() { let s = 0; for (let i = 0; i < 100; i++) s += i; return s; }',
+  'function arg(o) { return o.x; }',
+  'function thisField() { return this.x; }',
+  'function len(a) { const b = a; return b.length; }',
+  'console.log(loop() + arg({ x: 1 }) + thisField.call({ x: 2 }) + len([1, 2]));',
+].join('\n');
+const dump = spawnSync(path.resolve(process.execPath), ['-e', shapes], {
+  encoding: 'utf8',
+  env: { ...process.env, ANT_DEBUG: 'dump/vm:bytecode' },
+});
+equal(dump.status, 0, `bytecode dump run (${dump.stderr})`);
+equal(dump.stdout.trim(), '4955', 'dumped run output');
+assert(/\b(GET_LOCAL8_)?(CONST_I8_)?LT_JMP_FALSE8?\b/.test(dump.stderr), 'loop condition compiles to a fused compare-and-branch');
+assert(/\b(GET_ARG|GET_LOCAL8)_GET_FIELD\b/.test(dump.stderr), 'argument field read is fused');
+assert(/\bTHIS_GET_FIELD\b/.test(dump.stderr), 'this field read is fused');
+assert(/\bGET_LOCAL8_GET_LENGTH\b/.test(dump.stderr), 'local length read is fused');
+
+const plain = spawnSync(path.resolve(process.execPath), ['--profile-opcodes', '-e', shapes], {
+  encoding: 'utf8',
+  env: { ...process.env, ANT_DEBUG: 'dump/vm:bytecode' },
+});
+assert(!/LT_JMP_FALSE/.test(plain.stderr.split('opcode profile:')[0]), 'profiling compiles without fusion so the n-grams stay raw');
+
+console.log('PASS');
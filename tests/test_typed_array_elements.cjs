@@ -0,0 +1,119 @@
+function assert(condition, message) {
+  if (!condition) {
+    console.log('FAIL:', message);
+    process.exit(1);
+  }
+}
+
+function equal(actual, expected, message) {
+  assert(Object.is(actual, expected), `${message}: expected ${expected}, got ${actual}`);
+}
+
+function fill(ta, n) {
+  for (let i = 0; i < n; i++) ta[i] = i * 3 - 7;
+  return ta;
+}
+
+function sum(ta) {
+  let s = 0;
+  for (let i = 0; i < ta.length; i++) s += ta[i];
+  return s;
+}
+
+const kinds = [
+  [Int8Array, [-128, 127, 128, -129, 300.7], [-128, 127, -128, 127, 44]],
+  [Uint8Array, [0, 255, 256, -1, 3.9], [0, 255, 0, 255, 3]],
+  [Uint8ClampedArray, [0, 255, 256, -1, 2.5], [0, 255, 255, 0, 2]],
+  [Int16Array, [32767, 32768, -32769], [32767, -32768, 32767]],
+  [Uint16Array, [65535, 65536, -1], [65535, 0, 65535]],
+  [Int32Array, [2147483647, 2147483648, -2147483649, 2 ** 53 + 2], [2147483647, -2147483648, 2147483647, 2]],
+  [Uint32Array, [4294967295, 4294967296, -1], [4294967295, 0, 4294967295]],
+  [Float32Array, [1.5, 0.1, 1e40], [1.5, Math.fround(0.1), Infinity]],
+  [Float64Array, [1.5, 0.1, -0], [1.5, 0.1, -0]],
+];
+
+for (const [Ctor, input, expected] of kinds) {
+  const ta = new Ctor(input.length);
+  for (let round = 0; round < 300; round++) {
+    for (let i = 0; i < input.length; i++) ta[i] = input[i];
+  }
+  for (let i = 0; i < expected.length; i++) equal(ta[i], expected[i], `${Ctor.name}[${i}] conversion`);
+
+  const big = fill(new Ctor(1000), 1000);
+  let expect = 0;
+  for (let i = 0; i < 1000; i++) expect += new Ctor([i * 3 - 7])[0];
+  for (let round = 0; round < 20; round++) equal(sum(big), expect, `${Ctor.name} hot sum round ${round}`);
+
+  equal(big[1000], undefined, `${Ctor.name} past length`);
+  equal(big[-1], undefined, `${Ctor.name} negative index`);
+  equal(big[1.5], undefined, `${Ctor.name} fractional index`);
+  big[1000] = 1;
+  equal(big.length, 1000, `${Ctor.name} store past length is ignored`);
+  big['2'] = 9;
+  equal(big[2], 9, `${Ctor.name} string key store`);
+}
+
+const nan32 = new Float32Array(4);
+const nan64 = new Float64Array(4);
+for (let i = 0; i < 500; i++) {
+  nan32[i & 3] = NaN;
+  nan64[i & 3] = NaN;
+}
+assert(Number.isNaN(nan32[1]) && Number.isNaN(nan64[2]), 'NaN round trips through float arrays');
+const ints = new Int32Array(2);
+for (let i = 0; i < 500; i++) { ints[0] = NaN; ints[1] = -Infinity; }
+equal(ints[0], 0, 'NaN stores as 0');
+equal(ints[1], 0, '-Infinity stores as 0');
+
+const clamped = new Uint8ClampedArray(8);
+const clampIn = [NaN, 0.5, 1.5, 2.4999, 254.5, 253.5, 1e300, -0.4];
+const clampOut = [0, 0, 2, 2, 254, 254, 255, 0];
+for (let round = 0; round < 500; round++) {
+  for (let i = 0; i < clampIn.length; i++) clamped[i] = clampIn[i];
+}
+for (let i = 0; i < clampOut.length; i++) equal(clamped[i], clampOut[i], `clamped rounding of ${clampIn[i]}`);
+
+const u8 = new Uint8Array(4);
+const obj = { valueOf() { return 42; } };
+for (let i = 0; i < 300; i++) u8[i & 3] = i & 1 ? obj : '7';
+equal(u8[1], 42, 'valueOf on store');
+equal(u8[0], 7, 'string on store');
+
+const bi = new BigInt64Array(2);
+for (let i = 0; i < 300; i++) bi[i & 1] = BigInt(i);
+equal(bi[1], 299n, 'bigint elements');
+let threw = false;
+try { bi[0] = 1; } catch (e) { threw = e instanceof TypeError; }
+assert(threw, 'number into BigInt64Array throws');
+
+const backing = new Float64Array(16);
+for (let i = 0; i < 16; i++) backing[i] = i;
+const view = backing.subarray(4, 8);
+for (let round = 0; round < 300; round++) view[round & 3] = view[round & 3] + 0;
+equal(view[0], 4, 'subarray honours byte offset');
+view[3] = 100;
+equal(backing[7], 100, 'subarray stores land in the parent buffer');
+equal(view[4], undefined, 'subarray bounds');
+
+function read(x, i) { return x[i]; }
+const plain = [1, 2, 3];
+const typed = new Int16Array([4, 5, 6]);
+let poly = 0;
+for (let i = 0; i < 3000; i++) poly += read(i & 1 ? plain : typed, i % 3);
+equal(poly, 1500 * (4 + 5 + 6) / 3 + 1500 * (1 + 2 + 3) / 3, 'site alternating between Array and TypedArray');
+equal(read('abc', 1), 'b', 'string after typed feedback');
+equal(read({ 0: 'x' }, 0), 'x', 'plain object after typed feedback');
+equal(read(new Float32Array([0.5]), 0), 0.5, 'different kind after feedback');
+
+if (typeof ArrayBuffer.prototype.transfer === 'function') {
+  const buf = new ArrayBuffer(32);
+  const d = new Float64Array(buf);
+  for (let i = 0; i < 500; i++) d[i & 3] = i;
+  buf.transfer();
+  equal(d[0], undefined, 'read after detach');
+  d[0] = 1;
+  equal(d[0], undefined, 'write after detach');
+  equal(d.length, 0, 'detached length');
+}
+
+console.log('PASS');